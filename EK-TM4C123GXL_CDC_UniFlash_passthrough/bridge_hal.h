@@ -0,0 +1,290 @@
+/*
+ * @file bridge_hal.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Thin hardware abstraction over the UART, GPIO and timer functions used by the bridge
+ * @details
+ *  The interrupt and USB event handlers which perform the bridging between USB and the CC3100BOOST only
+ *  access the hardware through these functions. For the target each function maps directly onto the
+ *  TivaWare driverlib or usblib function, so there is no run time overhead. Hardware initialisation in
+ *  main(), and the uDMA transfers, remain specific to the TM4C123.
+ *
+ *  The UART functions are passed the UART base, or interrupt number, from the uart_channel_t being serviced,
+ *  so that the same handlers bridge each UART channel.
+ */
+
+#ifndef BRIDGE_HAL_H_
+#define BRIDGE_HAL_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_uart.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/uart.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/timer.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+
+/** The error flags returned with a character read from a UART receive FIFO */
+#define UART_DR_ERRORS (UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE)
+
+/** The UART used to communicate with the CC3100BOOST */
+#define CC3100_UART_BASE UART1_BASE
+#define CC3100_UART_INT  INT_UART1
+
+/** The GPIO used for the CC3100BOOST nHIB signal */
+#define CC3100_NHIB_PORT_BASE GPIO_PORTE_BASE
+#define CC3100_NHIB_PIN       GPIO_PIN_4
+
+/** The GPIO used for the CC3100BOOST nRESET signal, which is driven open-drain.
+ *  The CC3100BOOST doesn't connect nRESET to the LaunchPad, so this needs a wire to be fitted. */
+#define CC3100_NRESET_PORT_BASE GPIO_PORTE_BASE
+#define CC3100_NRESET_PIN       GPIO_PIN_1
+
+/** The SSI used for the CC3100BOOST SPI host interface, when SPI_PASSTHROUGH is enabled */
+#define CC3100_SPI_BASE      SSI2_BASE
+#define CC3100_SPI_INT       INT_SSI2
+#define CC3100_SPI_PORT_BASE GPIO_PORTB_BASE
+#define CC3100_SPI_CLK_PIN   GPIO_PIN_4
+#define CC3100_SPI_MISO_PIN  GPIO_PIN_6
+#define CC3100_SPI_MOSI_PIN  GPIO_PIN_7
+
+/** The GPIO used for the CC3100BOOST SPI chip select, which is active low */
+#define CC3100_SPI_CS_PORT_BASE GPIO_PORTE_BASE
+#define CC3100_SPI_CS_PIN       GPIO_PIN_0
+
+/** The GPIO used for the CC3100BOOST host interrupt request, which is active high */
+#define CC3100_IRQ_PORT_BASE GPIO_PORTB_BASE
+#define CC3100_IRQ_PIN       GPIO_PIN_2
+#define CC3100_IRQ_INT_PIN   GPIO_INT_PIN_2
+#define CC3100_IRQ_INT       INT_GPIOB
+
+/** The one-shot timer used to time the steps of the CC3100BOOST control line sequences */
+#define NHIB_TIMER_BASE TIMER0_BASE
+#define NHIB_TIMER_INT  INT_TIMER0A
+
+/** The one-shot timer used to time the USB IN flush latency */
+#define USB_IN_FLUSH_TIMER_BASE TIMER1_BASE
+#define USB_IN_FLUSH_TIMER_INT  INT_TIMER1A
+
+/** The pair of 32-bit one-shot timers used to time the steps of the sequences of the extra UART channels, when
+ *  UART_EXTRA_CHANNELS is non-zero. Subtimer A is used for channel 1 and subtimer B for channel 2.
+ *  The USB IN flush latency of channels 1 and 2 is timed by TIMER2 and TIMER3 respectively. */
+#define UART_CHANNEL_NHIB_TIMER_BASE   WTIMER1_BASE
+#define UART_CHANNEL_NHIB_TIMER_PERIPH SYSCTL_PERIPH_WTIMER1
+
+/** The free running 64-bit timer used to timestamp the traffic capture, when TRAFFIC_CAPTURE is enabled */
+#define CAPTURE_TIMER_BASE   WTIMER0_BASE
+#define CAPTURE_TIMER_PERIPH SYSCTL_PERIPH_WTIMER0
+
+/* The interrupt priorities. Servicing the UART has the highest priority, to prevent the receive FIFO overrunning.
+   The USB, timer, SPI passthrough and deferred work handlers share a lower priority, so that they don't pre-empt
+   each other. Building with UART_INT_PRIORITY defined as USB_INT_PRIORITY gives the flat priorities used before
+   the UART was given the highest priority, to compare the UART interrupt latency of the two schemes. */
+#ifndef UART_INT_PRIORITY
+#define UART_INT_PRIORITY 0x00
+#endif
+#define USB_INT_PRIORITY  0x20
+
+/** The GPIOs used for the status LEDs */
+#define LED_PORT_BASE GPIO_PORTF_BASE
+#define LED_RED       GPIO_PIN_1
+#define LED_BLUE      GPIO_PIN_2
+#define LED_GREEN     GPIO_PIN_3
+
+/** The GPIO for the SW1 push button, which is active low. Holding SW1 at reset selects the raw bulk UART
+ *  interface in place of the CDC interface. */
+#define MODE_SWITCH_PORT_BASE GPIO_PORTF_BASE
+#define MODE_SWITCH_PIN       GPIO_PIN_4
+
+/** The GPIO for the SW2 push button, which is active low. Holding SW2 at reset starts a standalone programming run
+ *  of the CC3100 from the image stored in flash. PF0 is locked as an NMI input, so must be unlocked. */
+#define PROGRAMMER_SWITCH_PORT_BASE GPIO_PORTF_BASE
+#define PROGRAMMER_SWITCH_PIN       GPIO_PIN_0
+
+/* Cortex-M4 debug registers used to access the DWT cycle counter, which aren't defined by TivaWare */
+#define CORE_DEBUG_DEMCR 0xE000EDFC
+#define CORE_DEBUG_DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+
+static inline uint32_t hal_system_clock_hz (void)
+{
+    return MAP_SysCtlClockGet ();
+}
+
+static inline uint32_t hal_uart_int_status (const uint32_t uart_base)
+{
+    return UARTIntStatus (uart_base, true);
+}
+
+static inline void hal_uart_int_clear (const uint32_t uart_base, const uint32_t int_flags)
+{
+    UARTIntClear (uart_base, int_flags);
+}
+
+static inline void hal_uart_int_enable (const uint32_t uart_base, const uint32_t int_flags)
+{
+    UARTIntEnable (uart_base, int_flags);
+}
+
+static inline void hal_uart_int_disable (const uint32_t uart_base, const uint32_t int_flags)
+{
+    UARTIntDisable (uart_base, int_flags);
+}
+
+/** Cause the deferred work handler to be run, at the USB interrupt priority */
+static inline void hal_deferred_work_trigger (void)
+{
+    IntPendSet (FAULT_PENDSV);
+}
+
+/** Prevent the UART interrupt handler from running, from a lower priority, while the CDC buffers are changed */
+static inline void hal_uart_int_mask (const uint32_t uart_int)
+{
+    IntDisable (uart_int);
+}
+
+static inline void hal_uart_int_unmask (const uint32_t uart_int)
+{
+    IntEnable (uart_int);
+}
+
+/** Cause the UART interrupt handler to be run, even if no UART interrupt is active */
+static inline void hal_uart_int_trigger (const uint32_t uart_int)
+{
+    IntPendSet (uart_int);
+}
+
+static inline void hal_uart_tx_int_mode_set (const uint32_t uart_base, const uint32_t mode)
+{
+    UARTTxIntModeSet (uart_base, mode);
+}
+
+static inline bool hal_uart_chars_avail (const uint32_t uart_base)
+{
+    return UARTCharsAvail (uart_base);
+}
+
+static inline int32_t hal_uart_char_get_non_blocking (const uint32_t uart_base)
+{
+    return UARTCharGetNonBlocking (uart_base);
+}
+
+static inline bool hal_uart_char_put_non_blocking (const uint32_t uart_base, const uint8_t tx_character)
+{
+    return UARTCharPutNonBlocking (uart_base, tx_character);
+}
+
+static inline bool hal_uart_busy (const uint32_t uart_base)
+{
+    return UARTBusy (uart_base);
+}
+
+static inline void hal_uart_config_set (const uint32_t uart_base, const uint32_t baud, const uint32_t config)
+{
+    UARTConfigSetExpClk (uart_base, hal_system_clock_hz (), baud, config);
+}
+
+static inline void hal_uart_config_get (const uint32_t uart_base, uint32_t *const baud, uint32_t *const config)
+{
+    UARTConfigGetExpClk (uart_base, hal_system_clock_hz (), baud, config);
+}
+
+static inline void hal_uart_modem_control_set (const uint32_t uart_base, const uint32_t control)
+{
+    UARTModemControlSet (uart_base, control);
+}
+
+static inline void hal_uart_modem_control_clear (const uint32_t uart_base, const uint32_t control)
+{
+    UARTModemControlClear (uart_base, control);
+}
+
+static inline void hal_uart_flow_control_set (const uint32_t uart_base, const uint32_t mode)
+{
+    UARTFlowControlSet (uart_base, mode);
+}
+
+static inline void hal_uart_break_ctl (const uint32_t uart_base, const bool break_state)
+{
+    UARTBreakCtl (uart_base, break_state);
+}
+
+static inline void hal_gpio_pin_write (const uint32_t port_base, const uint8_t pins, const uint8_t value)
+{
+    GPIOPinWrite (port_base, pins, value);
+}
+
+/** Enable the DWT cycle counter, which is used as a free running time base */
+static inline void hal_cycle_counter_enable (void)
+{
+    HWREG (CORE_DEBUG_DEMCR) |= CORE_DEBUG_DEMCR_TRCENA;
+    HWREG (DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+/** Read the DWT cycle counter, which wraps every 2^32 CPU cycles */
+static inline uint32_t hal_cycle_count (void)
+{
+    return HWREG (DWT_CYCCNT);
+}
+
+/** Read the free running timer used to timestamp the traffic capture, which counts at the CPU clock */
+static inline uint64_t hal_capture_timestamp (void)
+{
+    return TimerValueGet64 (CAPTURE_TIMER_BASE);
+}
+
+/** Start a one-shot timer, which interrupts once after the specified number of milliseconds.
+ *  Starting a timer which is already running restarts the timeout. */
+static inline void hal_oneshot_timer_start_ms (const uint32_t timer_base, const uint32_t timeout_ms)
+{
+    TimerDisable (timer_base, TIMER_A);
+    TimerLoadSet (timer_base, TIMER_A, (hal_system_clock_hz () / 1000) * timeout_ms);
+    TimerEnable (timer_base, TIMER_A);
+}
+
+/** The timeout interrupt flag of a subtimer, TIMER_A or TIMER_B */
+static inline uint32_t hal_subtimer_timeout (const uint32_t timer)
+{
+    return (timer == TIMER_B) ? TIMER_TIMB_TIMEOUT : TIMER_TIMA_TIMEOUT;
+}
+
+/** Start a one-shot subtimer, which interrupts once after the specified number of microseconds.
+ *  Starting a timer which is already running restarts the timeout. */
+static inline void hal_oneshot_subtimer_start_us (const uint32_t timer_base, const uint32_t timer,
+                                                  const uint32_t timeout_us)
+{
+    TimerDisable (timer_base, timer);
+    TimerLoadSet (timer_base, timer, (hal_system_clock_hz () / 1000000) * timeout_us);
+    TimerEnable (timer_base, timer);
+}
+
+/** Stop a one-shot subtimer, discarding any timeout which hasn't yet been handled */
+static inline void hal_oneshot_subtimer_stop (const uint32_t timer_base, const uint32_t timer)
+{
+    TimerDisable (timer_base, timer);
+    TimerIntClear (timer_base, hal_subtimer_timeout (timer));
+}
+
+/** Clear the timeout of a one-shot subtimer, from its interrupt handler */
+static inline void hal_oneshot_subtimer_int_clear (const uint32_t timer_base, const uint32_t timer)
+{
+    TimerIntClear (timer_base, hal_subtimer_timeout (timer));
+}
+
+/** Clear the timeout of a one-shot timer, from its interrupt handler */
+static inline void hal_oneshot_timer_int_clear (const uint32_t timer_base)
+{
+    hal_oneshot_subtimer_int_clear (timer_base, TIMER_A);
+}
+
+#endif /* BRIDGE_HAL_H_ */
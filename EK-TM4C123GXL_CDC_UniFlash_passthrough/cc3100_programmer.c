@@ -0,0 +1,609 @@
+/*
+ * @file cc3100_programmer.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Standalone programming of the CC3100 from an image of bootloader commands stored in the TM4C flash
+ * @details
+ *  When UniFlash programs the CC3100 each bootloader command and its acknowledgement makes a round trip through
+ *  the USB host. To program without the host latency, or without a host at all, the USB host first writes an
+ *  image to the unused upper part of the TM4C flash. The image is the sequence of bootloader commands which
+ *  UniFlash would send for a service pack or file set, each with the expected response, so the TM4C doesn't
+ *  need to understand the CC3100 file system. The image is composed on the USB host from the UniFlash session.
+ *
+ *  A programming run is requested either by the USB host, or by holding SW2 at reset. The run:
+ *  - Takes the UART from the bridge, which must have no data from the USB host queued.
+ *  - Sets the UART to the baud rate of the CC3100 bootloader.
+ *  - Runs the CDC SEND_BREAK sequence of cc3100_sequence.c, and waits for the bootloader to acknowledge the break.
+ *  - Sends each command framed as a bootloader packet, waits for the acknowledgement, then checks the response.
+ *  - Returns the UART to the bridge.
+ *
+ *  The run is performed from the main loop in thread mode, busy-waiting on the UART, so that the USB interrupt
+ *  handler continues to run and the USB host can poll the status. The result is shown on the LEDs as well as
+ *  in the status; blue while running, then green for pass or red for fail.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_uart.h>
+#include <driverlib/flash.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "traffic_capture.h"
+#include "cc3100_sequence.h"
+#include "uart_flow_control.h"
+#include "cc3100_programmer.h"
+
+/** The maximum time to wait for the bootloader to acknowledge the break, which includes the break sequence */
+#ifndef CC3100_PROGRAMMER_ENTRY_TIMEOUT_MS
+#define CC3100_PROGRAMMER_ENTRY_TIMEOUT_MS 2000
+#endif
+
+/** The maximum timeout of a record. Limited so that the timeout can't exceed the wrap of the cycle counter. */
+#define CC3100_PROGRAMMER_MAX_TIMEOUT_MS 50000
+
+/** The largest command which fits in the 16-bit length of a bootloader packet, which includes the length */
+#define CC3100_PROGRAMMER_MAX_COMMAND_LENGTH (0xFFFF - 2)
+
+/** The acknowledgement sent by the CC3100 bootloader, and sent to it for a response packet */
+#define BOOTLOADER_ACK_0 0x00
+#define BOOTLOADER_ACK_1 0xCC
+
+/** The status of the most recent programming run */
+static cc3100_programmer_status_t status;
+
+/** A copy of the status, which is sent to the USB host */
+static cc3100_programmer_status_t status_snapshot;
+
+/** The cycle counter is only 32 bits, so the time taken by a run is accumulated into elapsed_cycles each time
+ *  the time is checked */
+static uint64_t elapsed_cycles;
+static uint32_t last_cycles;
+static uint32_t cycles_per_ms;
+
+/**
+ * @brief Update elapsed_cycles with the time since it was last updated
+ */
+static void update_elapsed (void)
+{
+    const uint32_t now = hal_cycle_count ();
+
+    elapsed_cycles += now - last_cycles;
+    last_cycles = now;
+}
+
+/**
+ * @return Returns the value of elapsed_cycles at which a timeout expires
+ */
+static uint64_t deadline_after (const uint32_t timeout_ms)
+{
+    update_elapsed ();
+    return elapsed_cycles + ((uint64_t) timeout_ms * cycles_per_ms);
+}
+
+/**
+ * @return Returns true if the deadline has passed
+ */
+static bool timed_out (const uint64_t deadline)
+{
+    update_elapsed ();
+    return elapsed_cycles >= deadline;
+}
+
+/**
+ * @brief Calculate the IEEE 802.3 CRC-32 of the image records
+ * @details Calculated bit-wise to avoid a table in flash, which takes about 100 ms for the largest image. This is
+ *          insignificant compared to the time taken to program the CC3100.
+ */
+static uint32_t image_crc (const uint8_t *const data, const uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t byte_index;
+    uint32_t bit_index;
+
+    for (byte_index = 0; byte_index < length; byte_index++)
+    {
+        crc ^= data[byte_index];
+        for (bit_index = 0; bit_index < 8; bit_index++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+/**
+ * @return Returns the number of bytes which a record occupies in the image, including the padding
+ */
+static uint32_t record_size (const cc3100_programmer_record_t *const record)
+{
+    return sizeof (*record) + ((record->command_length + record->expected_length + 3u) & ~3u);
+}
+
+/**
+ * @brief Check the image header, CRC and the framing of all the records before communicating with the CC3100,
+ *        so that an invalid image can't leave the CC3100 partly programmed.
+ * @return Returns true if the image is valid
+ */
+static bool image_valid (void)
+{
+    const cc3100_programmer_image_header_t *const header =
+            (const cc3100_programmer_image_header_t *) CC3100_PROGRAMMER_IMAGE_BASE;
+    const uint8_t *const records = (const uint8_t *) (header + 1);
+    const cc3100_programmer_record_t *record;
+    uint32_t record_index;
+    uint32_t offset;
+    bool valid;
+
+    valid = (header->magic == CC3100_PROGRAMMER_IMAGE_MAGIC) && (header->num_records > 0) &&
+            (header->records_length <= (CC3100_PROGRAMMER_IMAGE_SIZE - sizeof (*header))) &&
+            ((header->records_length % 4) == 0);
+    if (valid)
+    {
+        valid = image_crc (records, header->records_length) == header->records_crc;
+    }
+
+    offset = 0;
+    for (record_index = 0; valid && (record_index < header->num_records); record_index++)
+    {
+        record = (const cc3100_programmer_record_t *) &records[offset];
+        valid = ((header->records_length - offset) >= sizeof (*record)) &&
+                (record->command_length > 0) &&
+                (record->command_length <= CC3100_PROGRAMMER_MAX_COMMAND_LENGTH) &&
+                (record->response <= CC3100_PROGRAMMER_RESPONSE_PACKET) &&
+                (record->timeout_ms <= CC3100_PROGRAMMER_MAX_TIMEOUT_MS) &&
+                ((record->response != CC3100_PROGRAMMER_RESPONSE_ACK) || (record->expected_length == 0)) &&
+                (record->expected_length <= record->response_length);
+        if (valid)
+        {
+            valid = (header->records_length - offset) >= record_size (record);
+            offset += record_size (record);
+        }
+    }
+
+    return valid && (offset == header->records_length);
+}
+
+/**
+ * @brief Receive one character from the CC3100
+ * @param[out] rx_byte The character received
+ * @param[in] deadline When to give up waiting
+ * @param[in] timeout_error The error returned on a timeout
+ * @param[in] ignore_errors When true characters received with an error are discarded, rather than failing
+ * @return Returns CC3100_PROGRAMMER_ERROR_NONE if a character was received
+ */
+static cc3100_programmer_error_t receive_byte (uint8_t *const rx_byte, const uint64_t deadline,
+                                               const cc3100_programmer_error_t timeout_error,
+                                               const bool ignore_errors)
+{
+    int32_t rx_data;
+
+    for (;;)
+    {
+        if (hal_uart_chars_avail (CC3100_UART_BASE))
+        {
+            rx_data = hal_uart_char_get_non_blocking (CC3100_UART_BASE);
+            if ((rx_data & UART_DR_ERRORS) == 0)
+            {
+                *rx_byte = (uint8_t) rx_data;
+                TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_UART_RX, rx_byte, 1);
+                return CC3100_PROGRAMMER_ERROR_NONE;
+            }
+            else if (!ignore_errors)
+            {
+                return CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+            }
+        }
+        else if (timed_out (deadline))
+        {
+            return timeout_error;
+        }
+    }
+}
+
+/**
+ * @brief Send characters to the CC3100, which may be delayed by the CC3100 deasserting CTS
+ * @return Returns CC3100_PROGRAMMER_ERROR_NONE if all the characters were sent before the deadline
+ */
+static cc3100_programmer_error_t send_bytes (const uint8_t *const data, const uint32_t length,
+                                             const uint64_t deadline)
+{
+    uint32_t num_sent = 0;
+
+    while (num_sent < length)
+    {
+        if (hal_uart_char_put_non_blocking (CC3100_UART_BASE, data[num_sent]))
+        {
+            num_sent++;
+        }
+        else if (timed_out (deadline))
+        {
+            return CC3100_PROGRAMMER_ERROR_NO_ACK;
+        }
+    }
+    TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_UART_TX, data, length);
+
+    return CC3100_PROGRAMMER_ERROR_NONE;
+}
+
+/**
+ * @brief Wait for the bootloader acknowledgement, skipping any other characters which precede it
+ */
+static cc3100_programmer_error_t wait_for_ack (const uint64_t deadline, const cc3100_programmer_error_t timeout_error,
+                                               const bool ignore_errors)
+{
+    cc3100_programmer_error_t error;
+    uint8_t previous = ~BOOTLOADER_ACK_0;
+    uint8_t rx_byte;
+
+    error = receive_byte (&rx_byte, deadline, timeout_error, ignore_errors);
+    while ((error == CC3100_PROGRAMMER_ERROR_NONE) &&
+           ((previous != BOOTLOADER_ACK_0) || (rx_byte != BOOTLOADER_ACK_1)))
+    {
+        previous = rx_byte;
+        error = receive_byte (&rx_byte, deadline, timeout_error, ignore_errors);
+    }
+
+    return error;
+}
+
+/**
+ * @brief Record a character of the response to a command, and compare it against the expected response
+ * @return Returns false if the character doesn't match the expected response
+ */
+static bool record_response_byte (const cc3100_programmer_record_t *const record, const uint8_t *const expected,
+                                  const uint8_t rx_byte)
+{
+    const uint32_t response_index = status.response_length;
+
+    if (response_index < CC3100_PROGRAMMER_MAX_REPORTED_RESPONSE)
+    {
+        status.response[response_index] = rx_byte;
+    }
+    status.response_length++;
+
+    return (response_index >= record->expected_length) || (rx_byte == expected[response_index]);
+}
+
+/**
+ * @brief Send the command in one record to the bootloader, and check the response
+ * @param[in] record The record to run
+ * @return Returns CC3100_PROGRAMMER_ERROR_NONE if the command completed as expected
+ */
+static cc3100_programmer_error_t run_record (const cc3100_programmer_record_t *const record)
+{
+    const uint8_t *const command = (const uint8_t *) (record + 1);
+    const uint8_t *const expected = &command[record->command_length];
+    uint64_t deadline = deadline_after (record->timeout_ms);
+    cc3100_programmer_error_t error;
+    uint8_t header[3];
+    uint8_t checksum;
+    uint32_t packet_length;
+    uint32_t byte_index;
+    uint8_t rx_byte;
+    bool matched = true;
+
+    /* Send the command framed as a packet of the big-endian length including the length itself, the checksum of
+     * the command, then the command */
+    checksum = 0;
+    for (byte_index = 0; byte_index < record->command_length; byte_index++)
+    {
+        checksum += command[byte_index];
+    }
+    header[0] = (uint8_t) ((record->command_length + 2) >> 8);
+    header[1] = (uint8_t) (record->command_length + 2);
+    header[2] = checksum;
+    error = send_bytes (header, sizeof (header), deadline);
+    if (error == CC3100_PROGRAMMER_ERROR_NONE)
+    {
+        error = send_bytes (command, record->command_length, deadline);
+    }
+    if (error == CC3100_PROGRAMMER_ERROR_NONE)
+    {
+        error = wait_for_ack (deadline, CC3100_PROGRAMMER_ERROR_NO_ACK, false);
+    }
+
+    status.response_length = 0;
+    switch (record->response)
+    {
+    case CC3100_PROGRAMMER_RESPONSE_RAW:
+        deadline = deadline_after (record->timeout_ms);
+        for (byte_index = 0; (error == CC3100_PROGRAMMER_ERROR_NONE) && (byte_index < record->response_length);
+             byte_index++)
+        {
+            error = receive_byte (&rx_byte, deadline, CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT, false);
+            if (error == CC3100_PROGRAMMER_ERROR_NONE)
+            {
+                matched &= record_response_byte (record, expected, rx_byte);
+            }
+        }
+        break;
+
+    case CC3100_PROGRAMMER_RESPONSE_PACKET:
+        deadline = deadline_after (record->timeout_ms);
+        for (byte_index = 0; (error == CC3100_PROGRAMMER_ERROR_NONE) && (byte_index < sizeof (header));
+             byte_index++)
+        {
+            error = receive_byte (&header[byte_index], deadline, CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT, false);
+        }
+
+        packet_length = ((uint32_t) header[0] << 8) | header[1];
+        if ((error == CC3100_PROGRAMMER_ERROR_NONE) &&
+            ((packet_length < 2) || ((packet_length - 2) > record->response_length)))
+        {
+            error = CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID;
+        }
+
+        checksum = 0;
+        for (byte_index = 2; (error == CC3100_PROGRAMMER_ERROR_NONE) && (byte_index < packet_length); byte_index++)
+        {
+            error = receive_byte (&rx_byte, deadline, CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT, false);
+            if (error == CC3100_PROGRAMMER_ERROR_NONE)
+            {
+                checksum += rx_byte;
+                matched &= record_response_byte (record, expected, rx_byte);
+            }
+        }
+        if ((error == CC3100_PROGRAMMER_ERROR_NONE) && (checksum != header[2]))
+        {
+            error = CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID;
+        }
+
+        if (error == CC3100_PROGRAMMER_ERROR_NONE)
+        {
+            header[0] = BOOTLOADER_ACK_0;
+            header[1] = BOOTLOADER_ACK_1;
+            error = send_bytes (header, 2, deadline);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if ((error == CC3100_PROGRAMMER_ERROR_NONE) && (!matched || (status.response_length < record->expected_length)))
+    {
+        error = CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH;
+    }
+
+    return error;
+}
+
+/**
+ * @brief Enter the CC3100 bootloader, by running the CDC SEND_BREAK sequence and waiting for the acknowledgement
+ * @details Characters received with errors while the CC3100 boots are ignored. The sequence functions are
+ *          called with interrupts disabled, since they are otherwise called at the USB interrupt priority.
+ */
+static cc3100_programmer_error_t enter_bootloader (void)
+{
+    const uint64_t deadline = deadline_after (CC3100_PROGRAMMER_ENTRY_TIMEOUT_MS);
+    cc3100_programmer_error_t error;
+    bool interrupts_were_disabled;
+
+    while (hal_uart_chars_avail (CC3100_UART_BASE))
+    {
+        (void) hal_uart_char_get_non_blocking (CC3100_UART_BASE);
+    }
+
+    interrupts_were_disabled = IntMasterDisable ();
+    cc3100_sequence_run_break (&uart_channels[UART_CHANNEL_CC3100]);
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    error = wait_for_ack (deadline, CC3100_PROGRAMMER_ERROR_NO_BOOTLOADER, true);
+
+    interrupts_were_disabled = IntMasterDisable ();
+    cc3100_sequence_abort (&uart_channels[UART_CHANNEL_CC3100]);
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    return error;
+}
+
+/**
+ * @brief Set the state of the run, and show it on the LEDs
+ */
+static void set_state (const cc3100_programmer_state_t state, const cc3100_programmer_error_t error)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    status.state = state;
+    status.error = error;
+    status.elapsed_ms = (uint32_t) (elapsed_cycles / cycles_per_ms);
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    switch (state)
+    {
+    case CC3100_PROGRAMMER_RUNNING:
+        hal_gpio_pin_write (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN, LED_BLUE);
+        break;
+
+    case CC3100_PROGRAMMER_PASSED:
+        hal_gpio_pin_write (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN, LED_GREEN);
+        break;
+
+    case CC3100_PROGRAMMER_FAILED:
+        hal_gpio_pin_write (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN, LED_RED);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Write part of the image into the TM4C flash
+ * @details Called at the USB interrupt priority. The image must be written in ascending order, since each erase
+ *          block is erased when the first write into it is made. The CPU stalls while the flash is erased or
+ *          programmed, so the image should only be written while the bridge is idle.
+ * @param[in] offset The byte offset into the image, which must be a multiple of 4
+ * @param[in] data The data to write
+ * @param[in] length The number of bytes to write, which must be a multiple of 4
+ * @return Returns true if the data was written
+ */
+bool cc3100_programmer_write_image (const uint32_t offset, const uint32_t *const data, const uint32_t length)
+{
+    uint32_t erase_offset;
+    bool success = !cc3100_programmer_active () && ((offset % 4) == 0) && ((length % 4) == 0) &&
+            (offset < CC3100_PROGRAMMER_IMAGE_SIZE) && (length <= (CC3100_PROGRAMMER_IMAGE_SIZE - offset));
+
+    for (erase_offset = (offset + CC3100_PROGRAMMER_ERASE_SIZE - 1) & ~(CC3100_PROGRAMMER_ERASE_SIZE - 1);
+         success && (erase_offset < (offset + length));
+         erase_offset += CC3100_PROGRAMMER_ERASE_SIZE)
+    {
+        success = FlashErase (CC3100_PROGRAMMER_IMAGE_BASE + erase_offset) == 0;
+    }
+    if (success && (length > 0))
+    {
+        success = FlashProgram ((uint32_t *) data, CC3100_PROGRAMMER_IMAGE_BASE + offset, length) == 0;
+    }
+    if (!success)
+    {
+        status.num_image_write_failures++;
+    }
+
+    return success;
+}
+
+/**
+ * @brief Request a programming run, which is performed from the main loop
+ * @return Returns true if the run was requested, or false if a run is already pending or running
+ */
+bool cc3100_programmer_request_run (void)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+    const bool requested = !cc3100_programmer_active ();
+
+    if (requested)
+    {
+        status.state = CC3100_PROGRAMMER_PENDING;
+        status.error = CC3100_PROGRAMMER_ERROR_NONE;
+        status.num_records = 0;
+        status.records_completed = 0;
+        status.elapsed_ms = 0;
+        status.response_length = 0;
+    }
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    return requested;
+}
+
+/**
+ * @return Returns true if a programming run has been requested, but not started
+ */
+bool cc3100_programmer_run_pending (void)
+{
+    return status.state == CC3100_PROGRAMMER_PENDING;
+}
+
+/**
+ * @return Returns true if a programming run is pending or running, during which the UART is used by the programmer
+ */
+bool cc3100_programmer_active (void)
+{
+    return (status.state == CC3100_PROGRAMMER_PENDING) || (status.state == CC3100_PROGRAMMER_RUNNING);
+}
+
+/**
+ * @brief Perform a requested programming run
+ * @details Called from the main loop in thread mode, with the UART interrupt masked so the bridge doesn't access
+ *          the UART. The caller restores the UART configuration used by the bridge afterwards.
+ * @param[in] uart_available When false the bridge still had data from the USB host queued for the CC3100, so
+ *            the run fails without using the UART.
+ */
+void cc3100_programmer_run (const bool uart_available)
+{
+    const cc3100_programmer_image_header_t *const header =
+            (const cc3100_programmer_image_header_t *) CC3100_PROGRAMMER_IMAGE_BASE;
+    const uint8_t *record_address = (const uint8_t *) (header + 1);
+    const cc3100_programmer_record_t *record;
+    cc3100_programmer_error_t error = CC3100_PROGRAMMER_ERROR_NONE;
+
+    cycles_per_ms = hal_system_clock_hz () / 1000;
+    elapsed_cycles = 0;
+    last_cycles = hal_cycle_count ();
+    set_state (CC3100_PROGRAMMER_RUNNING, CC3100_PROGRAMMER_ERROR_NONE);
+
+    if (!uart_available)
+    {
+        error = CC3100_PROGRAMMER_ERROR_BRIDGE_BUSY;
+    }
+    else if (!image_valid ())
+    {
+        error = CC3100_PROGRAMMER_ERROR_INVALID_IMAGE;
+    }
+    else
+    {
+        status.num_records = header->num_records;
+
+        /* The bootloader has a fixed baud rate, and the programmer relies upon RTS to receive the responses */
+        hal_uart_config_set (CC3100_UART_BASE, CC3100_PROGRAMMER_BAUD,
+                             UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+#if UART_RX_FLOW_CONTROL != UART_RX_FLOW_CONTROL_HARDWARE
+        hal_uart_modem_control_set (CC3100_UART_BASE, UART_OUTPUT_RTS);
+#endif
+
+        error = enter_bootloader ();
+        while ((error == CC3100_PROGRAMMER_ERROR_NONE) && (status.records_completed < status.num_records))
+        {
+            record = (const cc3100_programmer_record_t *) record_address;
+            error = run_record (record);
+            if (error == CC3100_PROGRAMMER_ERROR_NONE)
+            {
+                record_address += record_size (record);
+                status.records_completed++;
+                update_elapsed ();
+                status.elapsed_ms = (uint32_t) (elapsed_cycles / cycles_per_ms);
+            }
+        }
+
+        /* Wait for the final characters to be sent before the caller reconfigures the UART */
+        while (hal_uart_busy (CC3100_UART_BASE))
+        {
+        }
+        uart_flow_control_restore (&uart_channels[UART_CHANNEL_CC3100]);
+    }
+
+    update_elapsed ();
+    set_state ((error == CC3100_PROGRAMMER_ERROR_NONE) ? CC3100_PROGRAMMER_PASSED : CC3100_PROGRAMMER_FAILED,
+               error);
+}
+
+/**
+ * @brief Take a consistent copy of the status of the most recent programming run
+ * @param[out] snapshot Set to point at the copy of the status
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t cc3100_programmer_status_get (const cc3100_programmer_status_t **const snapshot)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    status_snapshot = status;
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    *snapshot = &status_snapshot;
+    return sizeof (status_snapshot);
+}
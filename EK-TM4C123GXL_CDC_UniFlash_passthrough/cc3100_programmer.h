@@ -0,0 +1,136 @@
+/*
+ * @file cc3100_programmer.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Standalone programming of the CC3100 from an image of bootloader commands stored in the TM4C flash
+ */
+
+#ifndef CC3100_PROGRAMMER_H_
+#define CC3100_PROGRAMMER_H_
+
+/** The region of the TM4C flash which holds the image, which the linker command file excludes from the program */
+#define CC3100_PROGRAMMER_IMAGE_BASE 0x00010000
+#define CC3100_PROGRAMMER_IMAGE_SIZE 0x00030000
+
+/** The size of the flash erase blocks, in which the image region is erased as it is written */
+#define CC3100_PROGRAMMER_ERASE_SIZE 1024
+
+/** The baud rate used by the CC3100 bootloader, which doesn't support changing the baud rate */
+#define CC3100_PROGRAMMER_BAUD 921600
+
+/** The value of the magic field of a valid image header */
+#define CC3100_PROGRAMMER_IMAGE_MAGIC 0x50303133
+
+/** The maximum number of bytes of the most recent response which are reported in the status */
+#define CC3100_PROGRAMMER_MAX_REPORTED_RESPONSE 32
+
+/** The header at the start of the image region. The fields are little-endian. */
+typedef struct
+{
+    /** CC3100_PROGRAMMER_IMAGE_MAGIC */
+    uint32_t magic;
+    /** The number of cc3100_programmer_record_t which follow the header */
+    uint32_t num_records;
+    /** The total length in bytes of the records which follow the header */
+    uint32_t records_length;
+    /** The IEEE 802.3 CRC-32 of the records, as calculated by zlib crc32() */
+    uint32_t records_crc;
+} cc3100_programmer_image_header_t;
+
+/** How the CC3100 bootloader responds to the command in a record, after acknowledging the command */
+typedef enum
+{
+    /** The command is only acknowledged */
+    CC3100_PROGRAMMER_RESPONSE_ACK,
+    /** The bootloader sends response_length bytes which aren't framed as a packet */
+    CC3100_PROGRAMMER_RESPONSE_RAW,
+    /** The bootloader sends a packet of up to response_length bytes, which is acknowledged */
+    CC3100_PROGRAMMER_RESPONSE_PACKET
+} cc3100_programmer_response_t;
+
+/** A record in the image, which is one command sent to the CC3100 bootloader. The record header is followed by
+ *  command_length bytes of the command (the opcode and its data), then expected_length bytes which are compared
+ *  against the start of the response, then padding to a multiple of 4 bytes. The command is sent framed as a
+ *  bootloader packet. */
+typedef struct
+{
+    /** The number of bytes in the command */
+    uint16_t command_length;
+    /** The cc3100_programmer_response_t */
+    uint8_t response;
+    /** The number of bytes of the expected response */
+    uint8_t expected_length;
+    /** For CC3100_PROGRAMMER_RESPONSE_RAW the number of bytes in the response, and for
+     *  CC3100_PROGRAMMER_RESPONSE_PACKET the maximum number of bytes in the response */
+    uint16_t response_length;
+    /** The maximum time to wait for the acknowledgement and then the response, to allow for the CC3100 erasing
+     *  its serial flash */
+    uint16_t timeout_ms;
+} cc3100_programmer_record_t;
+
+/** The state of the most recent programming run */
+typedef enum
+{
+    /** No programming has been requested since reset */
+    CC3100_PROGRAMMER_IDLE,
+    /** Programming has been requested, but not yet started */
+    CC3100_PROGRAMMER_PENDING,
+    /** Sending the commands in the image */
+    CC3100_PROGRAMMER_RUNNING,
+    /** All the commands in the image were completed as expected */
+    CC3100_PROGRAMMER_PASSED,
+    /** Programming stopped on an error, given by the cc3100_programmer_error_t */
+    CC3100_PROGRAMMER_FAILED
+} cc3100_programmer_state_t;
+
+/** Why the most recent programming run failed */
+typedef enum
+{
+    CC3100_PROGRAMMER_ERROR_NONE,
+    /** The image header or record framing is invalid, or the CRC doesn't match */
+    CC3100_PROGRAMMER_ERROR_INVALID_IMAGE,
+    /** Data from the USB host was still queued for the CC3100, so the UART couldn't be taken from the bridge */
+    CC3100_PROGRAMMER_ERROR_BRIDGE_BUSY,
+    /** The bootloader didn't acknowledge the break after nHIB was pulsed */
+    CC3100_PROGRAMMER_ERROR_NO_BOOTLOADER,
+    /** A command wasn't sent, or wasn't acknowledged, before the timeout */
+    CC3100_PROGRAMMER_ERROR_NO_ACK,
+    /** The response to a command wasn't received in time */
+    CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT,
+    /** A response packet was too long, or had an invalid checksum */
+    CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID,
+    /** The response didn't start with the expected bytes */
+    CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH,
+    /** A character was received with a UART error */
+    CC3100_PROGRAMMER_ERROR_LINE_ERROR
+} cc3100_programmer_error_t;
+
+/** The status of the most recent programming run, which is sent to the USB host as little-endian 32-bit words */
+typedef struct
+{
+    /** The cc3100_programmer_state_t */
+    uint32_t state;
+    /** The cc3100_programmer_error_t */
+    uint32_t error;
+    /** The number of records in the image */
+    uint32_t num_records;
+    /** The number of records completed. On failure, the index of the record which failed. */
+    uint32_t records_completed;
+    /** The time taken to program, or the time so far while running */
+    uint32_t elapsed_ms;
+    /** The number of bytes received in the response to the most recent command */
+    uint32_t response_length;
+    /** The start of the response to the most recent command */
+    uint8_t response[CC3100_PROGRAMMER_MAX_REPORTED_RESPONSE];
+    /** The number of writes to the image which were rejected or failed to program the flash */
+    uint32_t num_image_write_failures;
+} cc3100_programmer_status_t;
+
+bool cc3100_programmer_write_image (const uint32_t offset, const uint32_t *const data, const uint32_t length);
+bool cc3100_programmer_request_run (void);
+bool cc3100_programmer_run_pending (void);
+bool cc3100_programmer_active (void);
+void cc3100_programmer_run (const bool uart_available);
+uint32_t cc3100_programmer_status_get (const cc3100_programmer_status_t **const snapshot);
+
+#endif /* CC3100_PROGRAMMER_H_ */
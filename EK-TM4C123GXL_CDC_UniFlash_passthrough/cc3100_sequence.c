@@ -0,0 +1,361 @@
+/*
+ * @file cc3100_sequence.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Timed sequences on the CC3100BOOST nHIB and nRESET signals and the UART break
+ * @details
+ *  UniFlash starts communicating with the CC3100 bootloader by sending a break, on which the CC3100BOOST nHIB
+ *  was asserted for a fixed 100 ms. To shorten the flash cycle on a production line the USB host can instead run
+ *  a sequence of up to CC3100_SEQUENCE_MAX_STEPS steps, in which each step changes any of nHIB, nRESET and break
+ *  at the same instant and is followed by a delay timed in microseconds by a one-shot timer. The sequence is run
+ *  on the device, so the timing doesn't depend upon the USB host scheduling.
+ *
+ *  The sequence run on a CDC SEND_BREAK can also be replaced, so that the timings used by UniFlash are changed
+ *  without changing UniFlash.
+ *
+ *  Each UART channel has its own sequences, timed by the one-shot timer of the channel, so the CDC SEND_BREAK of
+ *  every port runs the same sequence path. Only the CC3100BOOST channel has nRESET, which is ignored by the steps
+ *  run on the extra channels, and only its sequences can be changed by the USB host and are traffic captured.
+ *
+ *  So that the minimum safe timings can be measured, the status of a sequence reports the time from the first
+ *  step to the first character received from the CC3100. The character is detected when the UART interrupt
+ *  handler passes it to the USB stack, so with the receive uDMA the time may be late by up to the UART receive
+ *  timeout of 32 bit periods.
+ *
+ *  nRESET isn't connected by the CC3100BOOST to the EK-TM4C123GXL, so needs a wire from the CC3100BOOST nRESET
+ *  to CC3100_NRESET_PIN. nRESET is driven open-drain, so it only ever pulls the signal low.
+ *
+ *  Apart from cc3100_sequence_uart_rx() the functions are called at the USB interrupt priority, which is also the
+ *  priority of the timer interrupts.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/interrupt.h>
+
+#include "bridge_hal.h"
+#include "isr_profile.h"
+#include "traffic_capture.h"
+#include "uart_channels.h"
+#include "cc3100_sequence.h"
+
+/** The sequence run on a CDC SEND_BREAK by default, which asserts break and nHIB then deasserts nHIB after 100ms.
+ *  The deassertion of nHIB triggers the CC3100BOOST to communicate with UniFlash. Break is left asserted until
+ *  the USB host clears it. */
+static const cc3100_sequence_step_t default_break_steps[] =
+{
+    {CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, 0, 100000},
+    {CC3100_SEQUENCE_NHIB, 0, 0, 0}
+};
+
+/** The sequences of one UART channel */
+typedef struct
+{
+    /** The sequence run on a CDC SEND_BREAK */
+    cc3100_sequence_step_t break_steps[CC3100_SEQUENCE_MAX_STEPS];
+    uint32_t num_break_steps;
+    /** The sequence being run */
+    cc3100_sequence_step_t active_steps[CC3100_SEQUENCE_MAX_STEPS];
+    /** The cycle count at which the first step was applied */
+    uint32_t start_cycles;
+    /** The cycle count at which the final step was applied */
+    uint32_t completed_cycles;
+    /** Set when a sequence is started, and cleared by the UART interrupt handler when it records response_cycles */
+    volatile bool response_armed;
+    /** The cycle count at which the first character was received since the first step, valid when response_seen */
+    volatile uint32_t response_cycles;
+    volatile bool response_seen;
+    /** The status of the most recent sequence */
+    cc3100_sequence_status_t status;
+    /** A copy of the status, which is sent to the USB host */
+    cc3100_sequence_status_t status_snapshot;
+} channel_sequences_t;
+
+static channel_sequences_t channel_sequences[UART_NUM_CHANNELS];
+
+/**
+ * @brief Record a change to the signals in the traffic capture, which is only of the CC3100BOOST channel
+ */
+static void capture_event (const uart_channel_t *const channel, const traffic_capture_type_t type)
+{
+    if (channel->index == UART_CHANNEL_CC3100)
+    {
+        TRAFFIC_CAPTURE_EVENT (type);
+    }
+    (void) type;
+}
+
+/**
+ * @brief Change the signals to the CC3100 on a channel
+ * @param[in] channel The channel to change the signals of
+ * @param[in] mask The signals to change. nRESET is ignored other than for the CC3100BOOST channel.
+ * @param[in] asserted Which of the signals in mask to assert
+ */
+static void apply_signals (const uart_channel_t *const channel, const uint8_t mask, const uint8_t asserted)
+{
+    if (mask & CC3100_SEQUENCE_NHIB)
+    {
+        uart_channel_set_nhib (channel, (asserted & CC3100_SEQUENCE_NHIB) != 0);
+        capture_event (channel, (asserted & CC3100_SEQUENCE_NHIB) ?
+                       TRAFFIC_CAPTURE_NHIB_ASSERT : TRAFFIC_CAPTURE_NHIB_DEASSERT);
+    }
+    if ((mask & CC3100_SEQUENCE_NRESET) && (channel->index == UART_CHANNEL_CC3100))
+    {
+        hal_gpio_pin_write (CC3100_NRESET_PORT_BASE, CC3100_NRESET_PIN,
+                            (asserted & CC3100_SEQUENCE_NRESET) ? 0 : CC3100_NRESET_PIN);
+        capture_event (channel, (asserted & CC3100_SEQUENCE_NRESET) ?
+                       TRAFFIC_CAPTURE_NRESET_ASSERT : TRAFFIC_CAPTURE_NRESET_DEASSERT);
+    }
+    if (mask & CC3100_SEQUENCE_BREAK)
+    {
+        hal_uart_break_ctl (channel->uart_base, (asserted & CC3100_SEQUENCE_BREAK) != 0);
+        capture_event (channel, (asserted & CC3100_SEQUENCE_BREAK) ?
+                       TRAFFIC_CAPTURE_BREAK_SET : TRAFFIC_CAPTURE_BREAK_CLEAR);
+    }
+}
+
+/**
+ * @brief Apply the steps of the active sequence of a channel, until a step with a delay or the final step is reached
+ */
+static void apply_steps (const uart_channel_t *const channel)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+    const cc3100_sequence_step_t *step;
+
+    while (sequences->status.steps_applied < sequences->status.num_steps)
+    {
+        step = &sequences->active_steps[sequences->status.steps_applied];
+        apply_signals (channel, step->mask, step->asserted);
+        sequences->status.steps_applied++;
+
+        if ((sequences->status.steps_applied < sequences->status.num_steps) && (step->delay_us > 0))
+        {
+            hal_oneshot_subtimer_start_us (channel->sequence_timer_base, channel->sequence_timer, step->delay_us);
+            return;
+        }
+    }
+
+    sequences->completed_cycles = hal_cycle_count ();
+    sequences->status.state = CC3100_SEQUENCE_COMPLETE;
+}
+
+/**
+ * @return Returns true if the steps form a valid sequence
+ */
+static bool steps_valid (const cc3100_sequence_step_t *const steps, const uint32_t num_steps)
+{
+    bool valid = (num_steps > 0) && (num_steps <= CC3100_SEQUENCE_MAX_STEPS);
+    uint32_t step_index;
+
+    for (step_index = 0; valid && (step_index < num_steps); step_index++)
+    {
+        valid = ((steps[step_index].mask & ~CC3100_SEQUENCE_ALL) == 0) &&
+                ((steps[step_index].asserted & ~steps[step_index].mask) == 0) &&
+                (steps[step_index].reserved == 0) &&
+                (steps[step_index].delay_us <= CC3100_SEQUENCE_MAX_DELAY_US);
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Configure the signals to the CC3100BOOST, initially not asserted, and set the default break sequence of
+ *        every channel
+ * @details The nHIB of the extra channels is configured by uart_channels_init().
+ */
+void cc3100_sequence_init (void)
+{
+    uint32_t channel_index;
+    uint32_t step_index;
+    channel_sequences_t *sequences;
+
+    GPIOPinTypeGPIOOutput (CC3100_NHIB_PORT_BASE, CC3100_NHIB_PIN);
+    GPIOPinTypeGPIOOutputOD (CC3100_NRESET_PORT_BASE, CC3100_NRESET_PIN);
+    apply_signals (&uart_channels[UART_CHANNEL_CC3100], CC3100_SEQUENCE_NHIB | CC3100_SEQUENCE_NRESET, 0);
+
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        sequences = &channel_sequences[channel_index];
+        sequences->num_break_steps = sizeof (default_break_steps) / sizeof (default_break_steps[0]);
+        for (step_index = 0; step_index < sequences->num_break_steps; step_index++)
+        {
+            sequences->break_steps[step_index] = default_break_steps[step_index];
+        }
+        sequences->status.state = CC3100_SEQUENCE_IDLE;
+    }
+}
+
+/**
+ * @brief Start running a sequence on a channel, replacing any sequence which is still running
+ * @param[in] channel The channel to run the sequence on
+ * @param[in] steps The steps of the sequence
+ * @param[in] num_steps The number of steps
+ * @return Returns true if the sequence is valid and has been started
+ */
+bool cc3100_sequence_run (const uart_channel_t *const channel, const cc3100_sequence_step_t *const steps,
+                          const uint32_t num_steps)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+    uint32_t step_index;
+
+    hal_oneshot_subtimer_stop (channel->sequence_timer_base, channel->sequence_timer);
+    if (!steps_valid (steps, num_steps))
+    {
+        sequences->status.state = CC3100_SEQUENCE_REJECTED;
+        return false;
+    }
+
+    for (step_index = 0; step_index < num_steps; step_index++)
+    {
+        sequences->active_steps[step_index] = steps[step_index];
+    }
+    sequences->status.state = CC3100_SEQUENCE_RUNNING;
+    sequences->status.num_steps = num_steps;
+    sequences->status.steps_applied = 0;
+
+    sequences->response_seen = false;
+    sequences->start_cycles = hal_cycle_count ();
+    sequences->response_armed = true;
+    apply_steps (channel);
+
+    return true;
+}
+
+/**
+ * @brief Run the sequence for a CDC SEND_BREAK on a channel
+ */
+void cc3100_sequence_run_break (const uart_channel_t *const channel)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+
+    (void) cc3100_sequence_run (channel, sequences->break_steps, sequences->num_break_steps);
+}
+
+/**
+ * @brief Replace the sequence run for a CDC SEND_BREAK on a channel
+ * @param[in] channel The channel whose break sequence is replaced
+ * @param[in] steps The steps of the sequence, or NULL to restore the default sequence
+ * @param[in] num_steps The number of steps
+ * @return Returns true if the sequence is valid and has been stored
+ */
+bool cc3100_sequence_set_break (const uart_channel_t *const channel, const cc3100_sequence_step_t *const steps,
+                                const uint32_t num_steps)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+    const cc3100_sequence_step_t *const new_steps = (steps != NULL) ? steps : default_break_steps;
+    const uint32_t new_num_steps = (steps != NULL) ?
+            num_steps : (sizeof (default_break_steps) / sizeof (default_break_steps[0]));
+    uint32_t step_index;
+
+    if (!steps_valid (new_steps, new_num_steps))
+    {
+        return false;
+    }
+
+    for (step_index = 0; step_index < new_num_steps; step_index++)
+    {
+        sequences->break_steps[step_index] = new_steps[step_index];
+    }
+    sequences->num_break_steps = new_num_steps;
+
+    return true;
+}
+
+/**
+ * @brief Stop any sequence which is running on a channel, and deassert all the signals.
+ * @details Called on a CDC CLEAR_BREAK.
+ */
+void cc3100_sequence_abort (const uart_channel_t *const channel)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+
+    hal_oneshot_subtimer_stop (channel->sequence_timer_base, channel->sequence_timer);
+    if (sequences->status.state == CC3100_SEQUENCE_RUNNING)
+    {
+        sequences->status.state = CC3100_SEQUENCE_ABORTED;
+    }
+    apply_signals (channel, CC3100_SEQUENCE_ALL, 0);
+}
+
+/**
+ * @brief Called by the UART interrupt handler when characters from the CC3100 on a channel have been received,
+ *        to record the response time to the sequence.
+ */
+void cc3100_sequence_uart_rx (const uart_channel_t *const channel)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+
+    if (sequences->response_armed)
+    {
+        sequences->response_cycles = hal_cycle_count ();
+        sequences->response_seen = true;
+        sequences->response_armed = false;
+    }
+}
+
+/**
+ * @brief Handle the one-shot timer of a channel, which times the delay after a step
+ */
+static void sequence_timer_handler (const uart_channel_t *const channel)
+{
+    hal_oneshot_subtimer_int_clear (channel->sequence_timer_base, channel->sequence_timer);
+    apply_steps (channel);
+}
+
+/**
+ * @brief Interrupt handler for the one-shot timer of the CC3100BOOST channel
+ */
+void nhib_timer_handler (void)
+{
+    ISR_PROFILE_ENTRY (ISR_PROFILE_NHIB_TIMER);
+
+    sequence_timer_handler (&uart_channels[UART_CHANNEL_CC3100]);
+
+    ISR_PROFILE_EXIT (ISR_PROFILE_NHIB_TIMER);
+}
+
+#if UART_EXTRA_CHANNELS > 0
+void uart_channel_1_nhib_timer_handler (void)
+{
+    sequence_timer_handler (&uart_channels[1]);
+}
+#endif
+
+#if UART_EXTRA_CHANNELS > 1
+void uart_channel_2_nhib_timer_handler (void)
+{
+    sequence_timer_handler (&uart_channels[2]);
+}
+#endif
+
+/**
+ * @brief Take a consistent copy of the status of the most recent sequence on a channel
+ * @param[in] channel The channel to get the status of
+ * @param[out] snapshot Set to point at the copy of the status
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t cc3100_sequence_status_get (const uart_channel_t *const channel,
+                                     const cc3100_sequence_status_t **const snapshot)
+{
+    channel_sequences_t *const sequences = &channel_sequences[channel->index];
+    const uint32_t cycles_per_us = hal_system_clock_hz () / 1000000;
+    bool response_valid;
+    uint32_t response_delta;
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    sequences->status_snapshot = sequences->status;
+    response_valid = sequences->response_seen;
+    response_delta = sequences->response_cycles - sequences->start_cycles;
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    sequences->status_snapshot.completed_us = (sequences->status_snapshot.state == CC3100_SEQUENCE_COMPLETE) ?
+            ((sequences->completed_cycles - sequences->start_cycles) / cycles_per_us) : 0;
+    sequences->status_snapshot.response_us = response_valid ? (response_delta / cycles_per_us) : UINT32_MAX;
+    *snapshot = &sequences->status_snapshot;
+    return sizeof (sequences->status_snapshot);
+}
@@ -0,0 +1,88 @@
+/*
+ * @file cc3100_sequence.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Timed sequences on the CC3100BOOST nHIB and nRESET signals and the UART break
+ */
+
+#ifndef CC3100_SEQUENCE_H_
+#define CC3100_SEQUENCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** The maximum number of steps in a sequence, chosen so that a sequence fits in one endpoint zero packet */
+#define CC3100_SEQUENCE_MAX_STEPS 8
+
+/** The maximum delay after a step, which is within the range of the 32-bit one-shot timer at 80 MHz */
+#define CC3100_SEQUENCE_MAX_DELAY_US 50000000
+
+/** The signals which a step can change, as bits in the mask and asserted fields of cc3100_sequence_step_t */
+#define CC3100_SEQUENCE_NHIB   0x01
+#define CC3100_SEQUENCE_NRESET 0x02
+#define CC3100_SEQUENCE_BREAK  0x04
+#define CC3100_SEQUENCE_ALL    (CC3100_SEQUENCE_NHIB | CC3100_SEQUENCE_NRESET | CC3100_SEQUENCE_BREAK)
+
+/** One step of a sequence, which is received from the USB host as little-endian fields */
+typedef struct
+{
+    /** The signals changed by this step */
+    uint8_t mask;
+    /** For each signal in mask, set to assert the signal or clear to deassert it */
+    uint8_t asserted;
+    /** Must be zero */
+    uint16_t reserved;
+    /** The delay in microseconds from this step to the next. Ignored for the final step. */
+    uint32_t delay_us;
+} cc3100_sequence_step_t;
+
+/** The progress of the most recent sequence */
+typedef enum
+{
+    /** No sequence has been run */
+    CC3100_SEQUENCE_IDLE,
+    /** Waiting for the delay after a step */
+    CC3100_SEQUENCE_RUNNING,
+    /** All steps have been applied */
+    CC3100_SEQUENCE_COMPLETE,
+    /** The sequence was invalid, so no steps were applied */
+    CC3100_SEQUENCE_REJECTED,
+    /** The sequence was stopped before all steps were applied, by the USB host clearing break */
+    CC3100_SEQUENCE_ABORTED
+} cc3100_sequence_state_t;
+
+/** The status of the most recent sequence, which is sent to the USB host as little-endian 32-bit words.
+ *  The times are measured with the DWT cycle counter, so are only valid for 53 seconds from the first step. */
+typedef struct
+{
+    /** The cc3100_sequence_state_t */
+    uint32_t state;
+    /** The number of steps in the sequence */
+    uint32_t num_steps;
+    /** The number of steps applied */
+    uint32_t steps_applied;
+    /** The time in microseconds from the first step to the final step being applied */
+    uint32_t completed_us;
+    /** The time in microseconds from the first step to the first character being received from the CC3100,
+     *  or UINT32_MAX if no character has been received */
+    uint32_t response_us;
+} cc3100_sequence_status_t;
+
+void cc3100_sequence_init (void);
+bool cc3100_sequence_run (const uart_channel_t *const channel, const cc3100_sequence_step_t *const steps,
+                          const uint32_t num_steps);
+void cc3100_sequence_run_break (const uart_channel_t *const channel);
+bool cc3100_sequence_set_break (const uart_channel_t *const channel, const cc3100_sequence_step_t *const steps,
+                                const uint32_t num_steps);
+void cc3100_sequence_abort (const uart_channel_t *const channel);
+void cc3100_sequence_uart_rx (const uart_channel_t *const channel);
+uint32_t cc3100_sequence_status_get (const uart_channel_t *const channel,
+                                     const cc3100_sequence_status_t **const snapshot);
+
+void nhib_timer_handler (void);
+void uart_channel_1_nhib_timer_handler (void);
+void uart_channel_2_nhib_timer_handler (void);
+
+#endif /* CC3100_SEQUENCE_H_ */
@@ -0,0 +1,15 @@
+/*
+ * @file check_assert.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Program assertion checking, shared by the modules of the passthrough
+ */
+
+#ifndef CHECK_ASSERT_H_
+#define CHECK_ASSERT_H_
+
+#include <stdbool.h>
+
+void check_assert (const bool assertion);
+
+#endif /* CHECK_ASSERT_H_ */
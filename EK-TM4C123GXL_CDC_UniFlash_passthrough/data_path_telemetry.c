@@ -0,0 +1,180 @@
+/*
+ * @file data_path_telemetry.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Counters which show whether the data path is bound by the UART, the USB link or buffering
+ * @details
+ *  The counters are always maintained, and are read by the USB host with VENDOR_REQUEST_GET_TELEMETRY on
+ *  endpoint zero so can be sampled during a flash session without interrupting the data stream.
+ *
+ *  The byte counts, OUT NAK episodes and endpoint zero stalls are counted at the USB interrupt priority.
+ *  The cdc_tx_buffer full episodes and flow control state changes are counted by the UART interrupt handler.
+ *  The peak buffer occupancies are the high-water marks recorded by the ring buffers, and the interrupt handler
+ *  calls are counted by ISR_PROFILE_ENTRY().
+ *
+ *  The time for which flow control is asserted is measured with the DWT cycle counter, so a single episode
+ *  longer than the counter wrap time (53 seconds at 80 MHz) is under-counted.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/interrupt.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "uart_buffer_arena.h"
+#include "data_path_telemetry.h"
+
+/** The counters maintained by this module. The buffer and interrupt handler fields are filled in by the snapshot */
+static data_path_telemetry_t telemetry;
+
+/** A consistent copy of the telemetry, which is sent to the USB host */
+static data_path_telemetry_t telemetry_snapshot;
+
+/** When true RTS is currently deasserted to throttle the CC3100 */
+static bool flow_control_asserted;
+
+/** The cycle count when flow control was last asserted, valid when flow_control_asserted is true */
+static uint32_t flow_control_start_cycles;
+
+/** The total cycles for which flow control has been asserted, for completed episodes */
+static uint64_t flow_control_asserted_cycles;
+
+/**
+ * @brief Enable the cycle counter used to time flow control episodes
+ */
+void data_path_telemetry_init (void)
+{
+    hal_cycle_counter_enable ();
+}
+
+/**
+ * @brief Called when data from the USB host has been read into cdc_rx_buffer
+ * @param[in] num_bytes The number of bytes read
+ */
+void data_path_telemetry_count_host_to_uart (const uint32_t num_bytes)
+{
+    telemetry.num_host_to_uart_bytes += num_bytes;
+}
+
+/**
+ * @brief Called when data from cdc_tx_buffer has been written for the USB host
+ * @param[in] num_bytes The number of bytes written
+ */
+void data_path_telemetry_count_uart_to_host (const uint32_t num_bytes)
+{
+    telemetry.num_uart_to_host_bytes += num_bytes;
+}
+
+/**
+ * @brief Called when a packet from the USB host starts to be left in the OUT endpoint for lack of space
+ */
+void data_path_telemetry_count_out_nak (void)
+{
+    telemetry.num_out_nak_episodes++;
+}
+
+/**
+ * @brief Called by the UART interrupt handler when it has filled cdc_tx_buffer
+ */
+void data_path_telemetry_count_uart_to_host_full (void)
+{
+    telemetry.num_uart_to_host_full_episodes++;
+}
+
+/**
+ * @brief Called when a vendor request is stalled
+ */
+void data_path_telemetry_count_ep0_stall (void)
+{
+    telemetry.num_ep0_stalls++;
+}
+
+/**
+ * @brief Called by the UART interrupt handler when RTS is deasserted or re-asserted to throttle the CC3100
+ * @param[in] throttled When true RTS has been deasserted
+ */
+void data_path_telemetry_flow_control_changed (const bool throttled)
+{
+    const uint32_t now_cycles = hal_cycle_count ();
+
+    if (throttled && !flow_control_asserted)
+    {
+        flow_control_start_cycles = now_cycles;
+        telemetry.num_flow_control_episodes++;
+    }
+    else if (!throttled && flow_control_asserted)
+    {
+        flow_control_asserted_cycles += now_cycles - flow_control_start_cycles;
+    }
+    flow_control_asserted = throttled;
+}
+
+/**
+ * @brief Reset the telemetry, including the peak buffer occupancies and interrupt handler counts,
+ *        to start a measurement
+ */
+void data_path_telemetry_clear (void)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+    uint32_t handler;
+
+    telemetry.num_host_to_uart_bytes = 0;
+    telemetry.num_uart_to_host_bytes = 0;
+    telemetry.num_flow_control_episodes = 0;
+    telemetry.num_out_nak_episodes = 0;
+    telemetry.num_uart_to_host_full_episodes = 0;
+    telemetry.num_ep0_stalls = 0;
+    flow_control_asserted_cycles = 0;
+    flow_control_start_cycles = hal_cycle_count ();
+    for (handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        isr_call_counts[handler] = 0;
+    }
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    uart_buffer_arena_clear_high_water ();
+}
+
+/**
+ * @brief Take a consistent copy of the telemetry
+ * @details The time for which flow control is asserted includes any episode which is in progress.
+ * @param[out] snapshot Set to point at the copy of the telemetry
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t data_path_telemetry_snapshot (const data_path_telemetry_t **const snapshot)
+{
+    const uint32_t cycles_per_ms = hal_system_clock_hz () / 1000;
+    uint64_t asserted_cycles;
+    uint32_t handler;
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    telemetry_snapshot = telemetry;
+    telemetry_snapshot.host_to_uart_buffer_size = spsc_ring_size (&cdc_rx_buffer);
+    telemetry_snapshot.host_to_uart_peak = cdc_rx_buffer.high_water;
+    telemetry_snapshot.uart_to_host_buffer_size = spsc_ring_size (&cdc_tx_buffer);
+    telemetry_snapshot.uart_to_host_peak = cdc_tx_buffer.high_water;
+    for (handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        telemetry_snapshot.isr_counts[handler] = isr_call_counts[handler];
+    }
+    asserted_cycles = flow_control_asserted_cycles;
+    if (flow_control_asserted)
+    {
+        asserted_cycles += hal_cycle_count () - flow_control_start_cycles;
+    }
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    telemetry_snapshot.flow_control_asserted_ms = (uint32_t) (asserted_cycles / cycles_per_ms);
+    *snapshot = &telemetry_snapshot;
+    return sizeof (telemetry_snapshot);
+}
@@ -0,0 +1,55 @@
+/*
+ * @file data_path_telemetry.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Counters which show whether the data path is bound by the UART, the USB link or buffering
+ */
+
+#ifndef DATA_PATH_TELEMETRY_H_
+#define DATA_PATH_TELEMETRY_H_
+
+#include "isr_profile.h"
+
+/** The telemetry block, which is sent to the USB host as little-endian 32-bit words.
+ *  The counts wrap, so the USB host should use the difference between two reads. */
+typedef struct
+{
+    /** The number of bytes read from the USB host on the bulk OUT endpoint */
+    uint32_t num_host_to_uart_bytes;
+    /** The number of bytes written to the USB host on the bulk IN endpoint */
+    uint32_t num_uart_to_host_bytes;
+    /** The size of the buffer for data from the USB host to the UART (cdc_rx_buffer) */
+    uint32_t host_to_uart_buffer_size;
+    /** The peak occupancy of cdc_rx_buffer */
+    uint32_t host_to_uart_peak;
+    /** The size of the buffer for data from the UART to the USB host (cdc_tx_buffer) */
+    uint32_t uart_to_host_buffer_size;
+    /** The peak occupancy of cdc_tx_buffer */
+    uint32_t uart_to_host_peak;
+    /** The number of calls to each interrupt handler, indexed by isr_profile_handler_t */
+    uint32_t isr_counts[ISR_PROFILE_NUM_HANDLERS];
+    /** The number of times RTS has been deasserted to throttle the CC3100 */
+    uint32_t num_flow_control_episodes;
+    /** The total time in milliseconds for which RTS has been deasserted to throttle the CC3100 */
+    uint32_t flow_control_asserted_ms;
+    /** The number of times a packet from the USB host was left in the OUT endpoint, so the USB host was NAKed,
+     *  as there was no space in cdc_rx_buffer. A high count means the data path is bound by the UART. */
+    uint32_t num_out_nak_episodes;
+    /** The number of times cdc_tx_buffer filled because the USB host wasn't reading.
+     *  A high count means the data path is bound by the USB link. */
+    uint32_t num_uart_to_host_full_episodes;
+    /** The number of vendor requests stalled on endpoint zero */
+    uint32_t num_ep0_stalls;
+} data_path_telemetry_t;
+
+void data_path_telemetry_init (void);
+void data_path_telemetry_count_host_to_uart (const uint32_t num_bytes);
+void data_path_telemetry_count_uart_to_host (const uint32_t num_bytes);
+void data_path_telemetry_count_out_nak (void);
+void data_path_telemetry_count_uart_to_host_full (void);
+void data_path_telemetry_count_ep0_stall (void);
+void data_path_telemetry_flow_control_changed (const bool throttled);
+void data_path_telemetry_clear (void);
+uint32_t data_path_telemetry_snapshot (const data_path_telemetry_t **const snapshot);
+
+#endif /* DATA_PATH_TELEMETRY_H_ */
@@ -0,0 +1,170 @@
+/*
+ * @file bench_isr_latency.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Benchmark of the worst-case latency of servicing the UART interrupt, run in the host simulation
+ * @details A file is written from the host to the CC3100 while another is read from the CC3100 to the host, so that
+ *          the USB and deferred work handlers are busy while the UART receives. The program is built against an
+ *          ISR_PROFILING build with the interrupt priorities of bridge_hal.h, and with UART_INT_PRIORITY defined as
+ *          USB_INT_PRIORITY for the flat priorities used before, to compare the two schemes.
+ *
+ *          One JSON object is written to standard output for each baud rate, with the fields:
+ *  - config, uart_int_priority, usb_int_priority: The firmware build options.
+ *  - baud, bytes: What was measured.
+ *  - uart_worst_latency_us: The worst time from the UART interrupt becoming pending to its handler being entered,
+ *    measured by the simulation.
+ *  - uart_profiled_worst_latency_us, uart_unsampled_entries: The worst latency from VENDOR_REQUEST_GET_ISR_PROFILE,
+ *    which is only sampled when another profiled handler sees the UART interrupt pending.
+ *  - usb0_worst_execution_us, deferred_work_worst_execution_us: From VENDOR_REQUEST_GET_ISR_PROFILE.
+ *  - uart_service_budget_us: UART_FIFO_SERVICE_LATENCY_NS, the latency allowed for by the UART FIFO trigger levels.
+ *  - dropped_bytes, uart_overruns: Losses in either direction.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "bridge_hal.h"
+#include "isr_profile.h"
+#include "uart_fifo_levels.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The length of the files written and read at each baud rate */
+#define BENCH_FILE_LENGTH (64u * 1024u)
+
+/** How many bytes the host writes at once, as the file chunk size used by UniFlash */
+#define BENCH_WRITE_CHUNK 4096u
+
+static const uint32_t bench_bauds[] = {460800, 921600};
+
+/** The name of the firmware configuration, given on the command line */
+static const char *config_name = "default";
+
+
+static double cycles_to_us (const uint64_t cycles)
+{
+    return (double) cycles / (SIM_CPU_HZ / 1000000u);
+}
+
+
+/**
+ * @return The number of bytes which were sent but not received intact
+ */
+static size_t count_dropped (const uint8_t *const sent, const size_t sent_length,
+                             const uint8_t *const received, const size_t received_length)
+{
+    size_t dropped = sent_length - received_length;
+
+    for (size_t offset = 0; offset < received_length; offset++)
+    {
+        if (received[offset] != sent[offset])
+        {
+            dropped++;
+        }
+    }
+
+    return dropped;
+}
+
+
+static bool transfers_complete (void *arg)
+{
+    const size_t *const length = arg;
+
+    return (sim_cc3100_read_available () >= *length) && (sim_usb_host_read_available (0) >= *length);
+}
+
+
+/**
+ * @brief Write and read a file at the same time, and report the UART latency
+ */
+static size_t bench_baud (const uint32_t baud, uint8_t *const buffers[4])
+{
+    size_t length = BENCH_FILE_LENGTH;
+    uint8_t *const to_cc3100 = buffers[0];
+    uint8_t *const from_cc3100 = buffers[1];
+    uint8_t *const cc3100_received = buffers[2];
+    uint8_t *const host_received = buffers[3];
+    isr_profile_t profiles[ISR_PROFILE_NUM_HANDLERS];
+    size_t dropped;
+    size_t num_cc3100_received;
+    size_t num_host_received;
+    const isr_profile_t *const uart = &profiles[ISR_PROFILE_UART];
+
+    sim_test_set_line_coding (0, baud, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CLEAR_ISR_PROFILE, 0, NULL, 0) == 0,
+                    "CLEAR_ISR_PROFILE stalled");
+    sim_uart_stats_clear (UART1_BASE);
+    sim_cpu_stats.worst_latency_cycles[INT_UART1] = 0;
+
+    sim_test_fill_pattern (to_cc3100, length, baud);
+    sim_test_fill_pattern (from_cc3100, length, ~baud);
+    sim_cc3100_send (from_cc3100, length);
+    for (size_t offset = 0; offset < length; offset += BENCH_WRITE_CHUNK)
+    {
+        sim_usb_host_write (0, &to_cc3100[offset], BENCH_WRITE_CHUNK);
+    }
+    sim_run_until (transfers_complete, &length,
+                   4u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (100));
+
+    num_cc3100_received = sim_cc3100_read (cc3100_received, length);
+    num_host_received = sim_usb_host_read (0, host_received, length);
+    dropped = count_dropped (to_cc3100, length, cc3100_received, num_cc3100_received) +
+            count_dropped (from_cc3100, length, host_received, num_host_received);
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_ISR_PROFILE, 0, profiles, sizeof (profiles)) ==
+                    sizeof (profiles), "GET_ISR_PROFILE failed");
+
+    printf ("{\"config\": \"%s\", \"uart_int_priority\": %u, \"usb_int_priority\": %u, \"baud\": %u, "
+            "\"bytes\": %zu, \"uart_worst_latency_us\": %.2f, \"uart_profiled_worst_latency_us\": %.2f, "
+            "\"uart_unsampled_entries\": %u, \"usb0_worst_execution_us\": %.2f, "
+            "\"deferred_work_worst_execution_us\": %.2f, \"uart_service_budget_us\": %.2f, \"dropped_bytes\": %zu, "
+            "\"uart_overruns\": %llu}\n",
+            config_name, UART_INT_PRIORITY, USB_INT_PRIORITY, baud, num_cc3100_received + num_host_received,
+            cycles_to_us (sim_cpu_stats.worst_latency_cycles[INT_UART1]), cycles_to_us (uart->worst_latency_cycles),
+            uart->num_unsampled_entries, cycles_to_us (profiles[ISR_PROFILE_USB0].worst_execution_cycles),
+            cycles_to_us (profiles[ISR_PROFILE_DEFERRED_WORK].worst_execution_cycles),
+            UART_FIFO_SERVICE_LATENCY_NS / 1000.0,
+            dropped, (unsigned long long) sim_uart_stats (UART1_BASE)->rx_overruns);
+    fflush (stdout);
+
+    return dropped;
+}
+
+
+int main (int argc, char *argv[])
+{
+    uint8_t *buffers[4];
+    size_t total_dropped = 0;
+
+    if (argc > 1)
+    {
+        config_name = argv[1];
+    }
+
+    for (uint32_t buffer_index = 0; buffer_index < 4; buffer_index++)
+    {
+        buffers[buffer_index] = malloc (BENCH_FILE_LENGTH);
+        SIM_TEST_CHECK (buffers[buffer_index] != NULL, "out of memory");
+    }
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    for (uint32_t baud_index = 0; baud_index < (sizeof (bench_bauds) / sizeof (bench_bauds[0])); baud_index++)
+    {
+        total_dropped += bench_baud (bench_bauds[baud_index], buffers);
+    }
+
+    for (uint32_t buffer_index = 0; buffer_index < 4; buffer_index++)
+    {
+        free (buffers[buffer_index]);
+    }
+
+    /* The results are still reported when bytes are dropped, but the passthrough must be lossless */
+    return (total_dropped == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
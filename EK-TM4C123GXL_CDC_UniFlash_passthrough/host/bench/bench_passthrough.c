@@ -0,0 +1,297 @@
+/*
+ * @file bench_passthrough.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief End-to-end throughput and latency benchmark of the CDC passthrough, run in the host simulation
+ * @details Replays traffic shaped like a UniFlash session with the CC3100 bootloader at each baud rate:
+ *  - command: small command/response exchanges, which the CC3100 model echoes, timed from the host write until
+ *    the complete response has been read by the host.
+ *  - bulk_write: a file written from the host to the CC3100.
+ *  - bulk_read: a file read from the CC3100 to the host.
+ *
+ *  The program is built against each firmware configuration to be compared, and writes one JSON object per line
+ *  to standard output for each configuration, baud rate and workload, with the fields:
+ *  - config, uart_buffer_arena_size, uart_fifo_rx_level: The firmware build options.
+ *  - baud, workload, transactions, bytes: What was measured.
+ *  - mb_per_s: The bytes transferred in both directions, in units of 10^6 bytes per second of virtual time.
+ *  - rtt_p50_us, rtt_p90_us, rtt_p99_us, rtt_max_us: Percentiles of the time for each transaction.
+ *  - dropped_bytes: The bytes sent which didn't arrive, or arrived corrupted.
+ *  - uart_overruns: The characters lost as the UART1 receive FIFO was full.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "usb_serial_structs.h"
+#include "uart_fifo_levels.h"
+
+#include "sim_test.h"
+
+/** The number of command/response exchanges timed at each baud rate */
+#define BENCH_NUM_COMMANDS 400
+
+/** The length of the files written and read at each baud rate */
+#define BENCH_FILE_LENGTH (128u * 1024u)
+
+/** How many bytes the host writes at once for a bulk write, as the file chunk size used by UniFlash */
+#define BENCH_WRITE_CHUNK 4096u
+
+/** The command lengths cycled through, from short bootloader opcodes to a command carrying a flash chunk */
+static const size_t command_lengths[] = {3, 8, 12, 20, 64, 260, 4, 16};
+
+static const uint32_t bench_bauds[] = {115200, 460800, 921600};
+
+/** The result of one workload */
+typedef struct
+{
+    const char *workload;
+    uint32_t baud;
+    uint32_t transactions;
+    size_t bytes;
+    sim_time_t elapsed;
+    /** The time of each transaction, sorted to obtain the percentiles */
+    sim_time_t *rtts;
+    size_t dropped_bytes;
+    uint64_t uart_overruns;
+} bench_result_t;
+
+/** The name of the firmware configuration, given on the command line */
+static const char *config_name = "default";
+
+
+static int compare_times (const void *a, const void *b)
+{
+    const sim_time_t time_a = *(const sim_time_t *) a;
+    const sim_time_t time_b = *(const sim_time_t *) b;
+
+    return (time_a > time_b) - (time_a < time_b);
+}
+
+
+static double percentile_us (const bench_result_t *const result, const uint32_t percent)
+{
+    const size_t index = ((size_t) (result->transactions - 1) * percent) / 100u;
+
+    return (double) result->rtts[index] / (SIM_CPU_HZ / 1000000u);
+}
+
+
+static const char *fifo_rx_level_name (void)
+{
+    if (UART_FIFO_ADAPTIVE)
+    {
+        return "adaptive";
+    }
+
+    switch (UART_FIFO_RX_LEVEL)
+    {
+    case UART_FIFO_RX1_8:
+        return "1/8";
+
+    case UART_FIFO_RX2_8:
+        return "2/8";
+
+    case UART_FIFO_RX4_8:
+        return "4/8";
+
+    case UART_FIFO_RX6_8:
+        return "6/8";
+
+    default:
+        return "7/8";
+    }
+}
+
+
+/**
+ * @brief Write the result of one workload as a JSON object on one line
+ */
+static void report_result (bench_result_t *const result)
+{
+    const double seconds = (double) result->elapsed / SIM_CPU_HZ;
+
+    qsort (result->rtts, result->transactions, sizeof (result->rtts[0]), compare_times);
+    printf ("{\"config\": \"%s\", \"uart_buffer_arena_size\": %u, \"uart_fifo_rx_level\": \"%s\", "
+            "\"baud\": %u, \"workload\": \"%s\", \"transactions\": %u, \"bytes\": %zu, \"mb_per_s\": %.4f, "
+            "\"rtt_p50_us\": %.1f, \"rtt_p90_us\": %.1f, \"rtt_p99_us\": %.1f, \"rtt_max_us\": %.1f, "
+            "\"dropped_bytes\": %zu, \"uart_overruns\": %llu}\n",
+            config_name, UART_BUFFER_ARENA_SIZE, fifo_rx_level_name (),
+            result->baud, result->workload, result->transactions, result->bytes,
+            (double) result->bytes / seconds / 1e6,
+            percentile_us (result, 50), percentile_us (result, 90), percentile_us (result, 99),
+            percentile_us (result, 100), result->dropped_bytes, (unsigned long long) result->uart_overruns);
+    fflush (stdout);
+}
+
+
+/**
+ * @return The number of bytes which were sent but not received intact
+ */
+static size_t count_dropped (const uint8_t *const sent, const size_t sent_length,
+                             const uint8_t *const received, const size_t received_length)
+{
+    size_t dropped = sent_length - received_length;
+
+    for (size_t offset = 0; offset < received_length; offset++)
+    {
+        if (received[offset] != sent[offset])
+        {
+            dropped++;
+        }
+    }
+
+    return dropped;
+}
+
+
+static bool cc3100_received (void *arg)
+{
+    const size_t *const length = arg;
+
+    return sim_cc3100_read_available () >= *length;
+}
+
+
+/**
+ * @brief Time command/response exchanges, with the CC3100 echoing each command as its response
+ */
+static void bench_commands (bench_result_t *const result)
+{
+    uint8_t command[4096];
+    uint8_t response[4096];
+    const sim_time_t timeout = (sim_time_t) sim_uart_character_cycles (UART1_BASE) * 2u * sizeof (command) +
+            SIM_MS (100);
+
+    sim_cc3100_set_mode (SIM_CC3100_ECHO);
+    for (uint32_t index = 0; index < BENCH_NUM_COMMANDS; index++)
+    {
+        const size_t length = command_lengths[index % (sizeof (command_lengths) / sizeof (command_lengths[0]))];
+        const sim_time_t start = sim_now;
+        size_t num_received;
+
+        sim_test_fill_pattern (command, length, index);
+        sim_usb_host_write (0, command, length);
+        sim_test_wait_read_available (0, length, timeout);
+        result->rtts[index] = sim_now - start;
+        result->elapsed += sim_now - start;
+        num_received = sim_usb_host_read (0, response, length);
+        result->dropped_bytes += count_dropped (command, length, response, num_received);
+        result->bytes += length + num_received;
+    }
+    result->transactions = BENCH_NUM_COMMANDS;
+
+    /* Discard the commands, which the CC3100 model also keeps as received */
+    while (sim_cc3100_read (command, sizeof (command)) > 0)
+    {
+    }
+}
+
+
+/**
+ * @brief Time a file being written from the host to the CC3100
+ */
+static void bench_bulk_write (bench_result_t *const result, uint8_t *const sent, uint8_t *const received)
+{
+    size_t length = BENCH_FILE_LENGTH;
+    const sim_time_t start = sim_now;
+    size_t num_received;
+
+    sim_cc3100_set_mode (SIM_CC3100_SINK);
+    sim_test_fill_pattern (sent, length, result->baud);
+    for (size_t offset = 0; offset < length; offset += BENCH_WRITE_CHUNK)
+    {
+        sim_usb_host_write (0, &sent[offset], BENCH_WRITE_CHUNK);
+    }
+    sim_run_until (cc3100_received, &length,
+                   2u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (100));
+    result->elapsed = sim_now - start;
+    result->rtts[0] = result->elapsed;
+    result->transactions = 1;
+    num_received = sim_cc3100_read (received, length);
+    result->bytes = num_received;
+    result->dropped_bytes = count_dropped (sent, length, received, num_received);
+}
+
+
+/**
+ * @brief Time a file being read from the CC3100 to the host
+ */
+static void bench_bulk_read (bench_result_t *const result, uint8_t *const sent, uint8_t *const received)
+{
+    const size_t length = BENCH_FILE_LENGTH;
+    const sim_time_t start = sim_now;
+    size_t num_received;
+
+    sim_cc3100_set_mode (SIM_CC3100_SINK);
+    sim_test_fill_pattern (sent, length, ~result->baud);
+    sim_cc3100_send (sent, length);
+    sim_test_wait_read_available (0, length,
+                                  2u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (100));
+    result->elapsed = sim_now - start;
+    result->rtts[0] = result->elapsed;
+    result->transactions = 1;
+    num_received = sim_usb_host_read (0, received, length);
+    result->bytes = num_received;
+    result->dropped_bytes = count_dropped (sent, length, received, num_received);
+}
+
+
+int main (int argc, char *argv[])
+{
+    uint8_t *const sent = malloc (BENCH_FILE_LENGTH);
+    uint8_t *const received = malloc (BENCH_FILE_LENGTH);
+    sim_time_t rtts[BENCH_NUM_COMMANDS];
+    size_t total_dropped = 0;
+
+    if (argc > 1)
+    {
+        config_name = argv[1];
+    }
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    for (uint32_t baud_index = 0; baud_index < (sizeof (bench_bauds) / sizeof (bench_bauds[0])); baud_index++)
+    {
+        const uint32_t baud = bench_bauds[baud_index];
+        void (*const bulk_workloads[]) (bench_result_t *, uint8_t *, uint8_t *) = {bench_bulk_write, bench_bulk_read};
+        const char *const bulk_names[] = {"bulk_write", "bulk_read"};
+        bench_result_t result;
+
+        sim_test_set_line_coding (0, baud, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+
+        memset (&result, 0, sizeof (result));
+        result.workload = "command";
+        result.baud = baud;
+        result.rtts = rtts;
+        sim_uart_stats_clear (UART1_BASE);
+        bench_commands (&result);
+        result.uart_overruns = sim_uart_stats (UART1_BASE)->rx_overruns;
+        total_dropped += result.dropped_bytes;
+        report_result (&result);
+
+        for (uint32_t workload = 0; workload < 2; workload++)
+        {
+            memset (&result, 0, sizeof (result));
+            result.workload = bulk_names[workload];
+            result.baud = baud;
+            result.rtts = rtts;
+            sim_uart_stats_clear (UART1_BASE);
+            bulk_workloads[workload] (&result, sent, received);
+            result.uart_overruns = sim_uart_stats (UART1_BASE)->rx_overruns;
+            total_dropped += result.dropped_bytes;
+            report_result (&result);
+        }
+    }
+
+    free (sent);
+    free (received);
+
+    /* The results are still reported when bytes are dropped, but the passthrough must be lossless */
+    return (total_dropped == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
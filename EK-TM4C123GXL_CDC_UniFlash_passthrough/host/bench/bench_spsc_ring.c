@@ -0,0 +1,316 @@
+/*
+ * @file bench_spsc_ring.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Microbenchmark of the lock-free single-producer / single-consumer ring buffer, run on the Linux host
+ * @details Measures the cost of moving data through a ring in spans of a fixed length:
+ *  - single_thread: the producer and consumer alternate on one thread, as the firmware interrupt handlers do on
+ *    one core, so the time is that of the span bookkeeping and copies without cache line contention.
+ *  - two_threads: the producer and consumer run on separate threads, so the counts bounce between cores.
+ *
+ *  Each mode is measured for two rings:
+ *  - spsc_ring: the ring in spsc_ring.h, which the producer and consumer access a contiguous span at a time.
+ *  - usb_buffer: a model of the usblib USBBuffer ring which the ring in spsc_ring.h replaced. As the UART receive
+ *    handler used to, the producer checks USBBufferSpaceAvailable() once per span and then calls USBBufferWrite()
+ *    one character at a time, where the write index is updated modulo the ring size for each character. The
+ *    consumer reads contiguous data and advances the read index, as USBBuffer does when sending a packet.
+ *    The interrupt masking around the index updates isn't modelled, so this baseline is slightly optimistic.
+ *
+ *  The host CPU is much faster than the TM4C123, so the results are for comparing changes to the ring rather
+ *  than predicting the firmware. One JSON object per line is written for each ring, mode and span length, with the
+ *  fields ring, mode, ring_size, span, bytes, mb_per_s and ns_per_span.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "spsc_ring.h"
+
+/** The size of the ring, that of the default CDC buffers */
+#define BENCH_RING_SIZE 4096u
+
+/** The bytes moved through the ring for each measurement */
+#define BENCH_LENGTH (16u * 1024u * 1024u)
+
+/** The span lengths measured, from single bytes to a full USB packet and a uDMA block */
+static const uint32_t span_lengths[] = {1, 16, 64, 256, 1024};
+
+/** The source data copied into the ring, and the destination the data is copied out to */
+static uint8_t source[BENCH_RING_SIZE];
+static uint8_t destination[BENCH_RING_SIZE];
+
+/** The storage for the ring under test */
+static uint8_t buffer[BENCH_RING_SIZE];
+
+/** The spsc_ring.h ring under test */
+static spsc_ring_t spsc;
+
+/**
+ * @brief A model of the tUSBRingBufObject used by USBBuffer, which leaves one byte unused to tell full from empty
+ * @details Each index is only written by one side, so on the host the indices are accessed with acquire / release
+ *          ordering in place of the interrupt masking of usblib.
+ */
+typedef struct
+{
+    uint32_t size;
+    uint32_t write_index;
+    uint32_t read_index;
+    uint8_t *buf;
+} usb_ring_buf_t;
+
+/** The USBBuffer ring under test */
+static usb_ring_buf_t usb_ring;
+
+/** The operations on one of the rings being compared */
+typedef struct
+{
+    /** The name of the ring reported */
+    const char *name;
+    /** Empty the ring */
+    void (*init) (void);
+    /** Copy up to one span into the ring, returning the number of bytes written */
+    uint32_t (*produce) (uint32_t span, uint32_t sent);
+    /** Copy up to one span out of the ring, returning the number of bytes read */
+    uint32_t (*consume) (uint32_t span);
+} bench_ring_t;
+
+typedef struct
+{
+    const bench_ring_t *ring;
+    uint32_t span;
+} bench_thread_t;
+
+
+static double now_s (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+static void spsc_init (void)
+{
+    spsc_ring_init (&spsc, buffer, sizeof (buffer));
+}
+
+
+/**
+ * @brief Copy up to one span into the ring
+ * @return The number of bytes written, which is less than the span when the ring is full or at its end
+ */
+static uint32_t spsc_produce (const uint32_t span, const uint32_t sent)
+{
+    uint32_t length;
+    uint8_t *const data = spsc_ring_write_span (&spsc, &length);
+
+    if (length > span)
+    {
+        length = span;
+    }
+    memcpy (data, &source[sent & (BENCH_RING_SIZE - 1)], length);
+    spsc_ring_write_commit (&spsc, length);
+
+    return length;
+}
+
+
+/**
+ * @brief Copy up to one span out of the ring
+ * @return The number of bytes read
+ */
+static uint32_t spsc_consume (const uint32_t span)
+{
+    uint32_t length;
+    const uint8_t *const data = spsc_ring_read_span (&spsc, &length);
+
+    if (length > span)
+    {
+        length = span;
+    }
+    memcpy (destination, data, length);
+    spsc_ring_read_commit (&spsc, length);
+
+    return length;
+}
+
+
+static void usb_buffer_init (void)
+{
+    usb_ring.size = sizeof (buffer);
+    usb_ring.write_index = 0;
+    usb_ring.read_index = 0;
+    usb_ring.buf = buffer;
+}
+
+
+/**
+ * @brief The equivalent of USBRingBufUsed(), which reads each index once
+ */
+static uint32_t usb_ring_buf_used (void)
+{
+    const uint32_t write_index = __atomic_load_n (&usb_ring.write_index, __ATOMIC_ACQUIRE);
+    const uint32_t read_index = __atomic_load_n (&usb_ring.read_index, __ATOMIC_ACQUIRE);
+
+    return (write_index >= read_index) ? (write_index - read_index) : (usb_ring.size - (read_index - write_index));
+}
+
+
+/**
+ * @brief The equivalent of USBRingBufWriteOne(), called by USBRingBufWrite() for each character
+ */
+static void usb_ring_buf_write_one (const uint8_t data)
+{
+    const uint32_t write_index = usb_ring.write_index;
+
+    usb_ring.buf[write_index] = data;
+    __atomic_store_n (&usb_ring.write_index, (write_index + 1) % usb_ring.size, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Write up to one span a character at a time, as the UART receive handler did with USBBufferWrite()
+ * @return The number of bytes written, which is less than the span when the ring is full
+ */
+static uint32_t usb_buffer_produce (const uint32_t span, const uint32_t sent)
+{
+    const uint32_t space = usb_ring.size - usb_ring_buf_used () - 1;
+    const uint32_t length = (space > span) ? span : space;
+
+    for (uint32_t index = 0; index < length; index++)
+    {
+        usb_ring_buf_write_one (source[(sent + index) & (BENCH_RING_SIZE - 1)]);
+    }
+
+    return length;
+}
+
+
+/**
+ * @brief Copy up to one span of contiguous data out of the ring, as USBBuffer does when sending a packet
+ * @return The number of bytes read
+ */
+static uint32_t usb_buffer_consume (const uint32_t span)
+{
+    const uint32_t write_index = __atomic_load_n (&usb_ring.write_index, __ATOMIC_ACQUIRE);
+    const uint32_t read_index = usb_ring.read_index;
+    uint32_t length = (write_index >= read_index) ? (write_index - read_index) : (usb_ring.size - read_index);
+
+    if (length > span)
+    {
+        length = span;
+    }
+    memcpy (destination, &usb_ring.buf[read_index], length);
+    __atomic_store_n (&usb_ring.read_index, (read_index + length) % usb_ring.size, __ATOMIC_RELEASE);
+
+    return length;
+}
+
+
+/** The rings compared, with the usblib baseline first */
+static const bench_ring_t rings[] =
+{
+    {.name = "usb_buffer", .init = usb_buffer_init, .produce = usb_buffer_produce, .consume = usb_buffer_consume},
+    {.name = "spsc_ring", .init = spsc_init, .produce = spsc_produce, .consume = spsc_consume}
+};
+
+
+static void *producer_thread (void *arg)
+{
+    const bench_thread_t *const thread = arg;
+
+    for (uint32_t sent = 0; sent < BENCH_LENGTH; )
+    {
+        const uint32_t length = thread->ring->produce (thread->span, sent);
+
+        if (length == 0)
+        {
+            /* Let the consumer run when the host has fewer CPUs than threads */
+            sched_yield ();
+        }
+        sent += length;
+    }
+
+    return NULL;
+}
+
+
+static void *consumer_thread (void *arg)
+{
+    const bench_thread_t *const thread = arg;
+
+    for (uint32_t received = 0; received < BENCH_LENGTH; )
+    {
+        const uint32_t length = thread->ring->consume (thread->span);
+
+        if (length == 0)
+        {
+            sched_yield ();
+        }
+        received += length;
+    }
+
+    return NULL;
+}
+
+
+static void report (const bench_ring_t *const ring, const char *const mode, const uint32_t span,
+                    const double seconds)
+{
+    printf ("{\"benchmark\": \"spsc_ring\", \"ring\": \"%s\", \"mode\": \"%s\", \"ring_size\": %u, \"span\": %u, "
+            "\"bytes\": %u, \"mb_per_s\": %.1f, \"ns_per_span\": %.2f}\n",
+            ring->name, mode, BENCH_RING_SIZE, span, BENCH_LENGTH, BENCH_LENGTH / seconds / 1e6,
+            (seconds * 1e9) / ((double) BENCH_LENGTH / span));
+    fflush (stdout);
+}
+
+
+int main (void)
+{
+    for (uint32_t index = 0; index < BENCH_RING_SIZE; index++)
+    {
+        source[index] = (uint8_t) index;
+    }
+
+    for (uint32_t span_index = 0; span_index < (sizeof (span_lengths) / sizeof (span_lengths[0])); span_index++)
+    {
+        const uint32_t span = span_lengths[span_index];
+
+        for (uint32_t ring_index = 0; ring_index < (sizeof (rings) / sizeof (rings[0])); ring_index++)
+        {
+            const bench_ring_t *const ring = &rings[ring_index];
+            bench_thread_t thread = {.ring = ring, .span = span};
+            pthread_t producer;
+            pthread_t consumer;
+            double start;
+
+            ring->init ();
+            start = now_s ();
+            for (uint32_t sent = 0; sent < BENCH_LENGTH; )
+            {
+                sent += ring->produce (span, sent);
+                (void) ring->consume (span);
+            }
+            report (ring, "single_thread", span, now_s () - start);
+
+            ring->init ();
+            start = now_s ();
+            if ((pthread_create (&consumer, NULL, consumer_thread, &thread) != 0) ||
+                (pthread_create (&producer, NULL, producer_thread, &thread) != 0))
+            {
+                fprintf (stderr, "pthread_create failed\n");
+                return EXIT_FAILURE;
+            }
+            pthread_join (producer, NULL);
+            pthread_join (consumer, NULL);
+            report (ring, "two_threads", span, now_s () - start);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
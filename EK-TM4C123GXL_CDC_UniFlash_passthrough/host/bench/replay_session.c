@@ -0,0 +1,421 @@
+/*
+ * @file replay_session.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Replay a session recorded by the traffic capture against the firmware in the host simulation
+ * @details The input is the pcap read with VENDOR_REQUEST_GET_CAPTURE in session mode, either from a real bridge
+ *          during a UniFlash session or from test_session_record. The test program plays both sides of the session:
+ *          - As the USB host, the data from the host (TRAFFIC_CAPTURE_UART_TX) is written to the bulk OUT endpoint,
+ *            and the line coding, control line state and breaks are sent as CDC requests.
+ *          - As the CC3100, through the CC3100 model in sink mode, the data from the CC3100
+ *            (TRAFFIC_CAPTURE_UART_RX) is sent on the UART.
+ *          The nHIB, nRESET and line error records are the result of the firmware's actions, so are only counted.
+ *
+ *          Each record is replayed after the same time from the previous record as in the recording, which keeps
+ *          the inter-chunk timing and the think time of each side. A record also waits until the side replaying it
+ *          has received all the data the other side sent before it in the recording, and for the CC3100 to be
+ *          powered, so the replay follows the causality of the session if the firmware under test is slower.
+ *          A wait of more than the stall threshold past the recorded time counts as a stall. A record whose data
+ *          doesn't arrive within REPLAY_WAIT_TIMEOUT is replayed anyway, so lost data is reported as dropped bytes
+ *          rather than ending the replay.
+ *
+ *          The result is written as one JSON object on a line, with the recorded and replayed session times, the
+ *          stalls, and the dropped bytes in each direction. The exit status is failure if any bytes were dropped.
+ *
+ *          Usage: replay_session [-s <stall threshold ms>] <pcap file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "traffic_capture.h"
+
+#include "sim_test.h"
+
+/** The time a record waits for the data it depends upon, before it is replayed anyway */
+#define REPLAY_WAIT_TIMEOUT SIM_MS (2000)
+
+/** The pcap magic number, when written with the same byte order as the host */
+#define PCAP_MAGIC 0xa1b2c3d4u
+
+/** The pcap link type used by the traffic capture */
+#define LINKTYPE_USER0 147
+
+/** The pcap file header */
+typedef struct
+{
+    uint32_t magic_number;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+} pcap_file_header_t;
+
+/** The pcap header which precedes each packet */
+typedef struct
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+} pcap_record_header_t;
+
+/** One record of the recording */
+typedef struct
+{
+    /** The time of the record in the recording, relative to the first record */
+    sim_time_t when;
+    traffic_capture_type_t type;
+    const uint8_t *data;
+    uint32_t length;
+    /** The bytes sent by the USB host and by the CC3100 before this record in the recording */
+    size_t host_to_uart_before;
+    size_t uart_to_host_before;
+} replay_record_t;
+
+/** The recording, and the data in each direction concatenated from its records */
+typedef struct
+{
+    uint8_t *file_data;
+    replay_record_t *records;
+    size_t num_records;
+    uint8_t *host_to_uart;
+    size_t host_to_uart_length;
+    uint8_t *uart_to_host;
+    size_t uart_to_host_length;
+    uint32_t num_gaps;
+} recording_t;
+
+/** The data received by each side during the replay */
+static uint8_t *host_received;
+static size_t host_received_length;
+static uint8_t *cc3100_received;
+static size_t cc3100_received_length;
+
+/** The command line options */
+static const char *pcap_path;
+static uint32_t stall_threshold_ms = 50;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s [-s <stall threshold ms>] <pcap file>\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "s:")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            stall_threshold_ms = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    if (optind != (argc - 1))
+    {
+        usage (argv[0]);
+    }
+    pcap_path = argv[optind];
+}
+
+
+/**
+ * @brief Read the pcap into records, and concatenate the data sent in each direction
+ */
+static void read_recording (recording_t *const recording)
+{
+    FILE *const pcap_file = fopen (pcap_path, "rb");
+    pcap_file_header_t file_header;
+    long file_length;
+    size_t offset;
+    uint64_t first_us = 0;
+
+    SIM_TEST_CHECK (pcap_file != NULL, "can't open %s", pcap_path);
+    SIM_TEST_CHECK ((fseek (pcap_file, 0, SEEK_END) == 0) && ((file_length = ftell (pcap_file)) >= 0) &&
+                    (fseek (pcap_file, 0, SEEK_SET) == 0), "can't size %s", pcap_path);
+    memset (recording, 0, sizeof (*recording));
+    recording->file_data = malloc ((size_t) file_length + 1);
+    recording->records = calloc (((size_t) file_length / sizeof (pcap_record_header_t)) + 1,
+                                 sizeof (recording->records[0]));
+    recording->host_to_uart = malloc ((size_t) file_length + 1);
+    recording->uart_to_host = malloc ((size_t) file_length + 1);
+    SIM_TEST_CHECK ((recording->file_data != NULL) && (recording->records != NULL) &&
+                    (recording->host_to_uart != NULL) && (recording->uart_to_host != NULL), "out of memory");
+    SIM_TEST_CHECK (fread (recording->file_data, 1, (size_t) file_length, pcap_file) == (size_t) file_length,
+                    "can't read %s", pcap_path);
+    fclose (pcap_file);
+
+    SIM_TEST_CHECK ((size_t) file_length >= sizeof (file_header), "%s has no pcap file header", pcap_path);
+    memcpy (&file_header, recording->file_data, sizeof (file_header));
+    SIM_TEST_CHECK ((file_header.magic_number == PCAP_MAGIC) && (file_header.network == LINKTYPE_USER0),
+                    "%s isn't a traffic capture", pcap_path);
+
+    for (offset = sizeof (file_header); offset < (size_t) file_length; )
+    {
+        replay_record_t *const record = &recording->records[recording->num_records];
+        pcap_record_header_t record_header;
+        uint64_t record_us;
+
+        SIM_TEST_CHECK ((offset + sizeof (record_header)) <= (size_t) file_length, "truncated record header");
+        memcpy (&record_header, &recording->file_data[offset], sizeof (record_header));
+        offset += sizeof (record_header);
+        SIM_TEST_CHECK ((record_header.incl_len >= 1) && ((offset + record_header.incl_len) <= (size_t) file_length),
+                        "invalid record length %u", record_header.incl_len);
+        SIM_TEST_CHECK (record_header.incl_len == record_header.orig_len,
+                        "truncated record, so the recording wasn't made in session mode");
+
+        record_us = ((uint64_t) record_header.ts_sec * 1000000u) + record_header.ts_usec;
+        if (recording->num_records == 0)
+        {
+            first_us = record_us;
+        }
+        record->when = SIM_US (record_us - first_us);
+        record->type = (traffic_capture_type_t) recording->file_data[offset];
+        record->data = &recording->file_data[offset + 1];
+        record->length = record_header.incl_len - 1;
+        record->host_to_uart_before = recording->host_to_uart_length;
+        record->uart_to_host_before = recording->uart_to_host_length;
+        offset += record_header.incl_len;
+
+        switch (record->type)
+        {
+        case TRAFFIC_CAPTURE_UART_TX:
+            memcpy (&recording->host_to_uart[recording->host_to_uart_length], record->data, record->length);
+            recording->host_to_uart_length += record->length;
+            break;
+
+        case TRAFFIC_CAPTURE_UART_RX:
+            memcpy (&recording->uart_to_host[recording->uart_to_host_length], record->data, record->length);
+            recording->uart_to_host_length += record->length;
+            break;
+
+        case TRAFFIC_CAPTURE_DROPPED:
+            recording->num_gaps++;
+            break;
+
+        default:
+            break;
+        }
+        recording->num_records++;
+    }
+}
+
+
+/**
+ * @brief Collect the data which has arrived at each side of the bridge, up to the length in the recording
+ */
+static void collect_received (const recording_t *const recording)
+{
+    host_received_length += sim_usb_host_read (0, &host_received[host_received_length],
+                                               recording->uart_to_host_length - host_received_length);
+    cc3100_received_length += sim_cc3100_read (&cc3100_received[cc3100_received_length],
+                                               recording->host_to_uart_length - cc3100_received_length);
+}
+
+
+/** What a record waits for before it is replayed */
+typedef struct
+{
+    sim_time_t scheduled;
+    size_t host_to_uart_needed;
+    size_t uart_to_host_needed;
+    bool needs_power;
+} replay_wait_t;
+
+
+static bool record_due (void *arg)
+{
+    const replay_wait_t *const wait = arg;
+
+    return (sim_now >= wait->scheduled) &&
+            ((sim_cc3100_read_available () + cc3100_received_length) >= wait->host_to_uart_needed) &&
+            ((sim_usb_host_read_available (0) + host_received_length) >= wait->uart_to_host_needed) &&
+            (!wait->needs_power || sim_cc3100_powered ());
+}
+
+
+/**
+ * @brief Apply a recorded line coding as the USB host
+ * @param[in] line_coding The tLineCoding in the CDC format
+ */
+static void replay_line_coding (const uint8_t *const line_coding)
+{
+    static const uint32_t uart_parity[] =
+    {
+        [USB_CDC_PARITY_NONE] = UART_CONFIG_PAR_NONE,
+        [USB_CDC_PARITY_ODD] = UART_CONFIG_PAR_ODD,
+        [USB_CDC_PARITY_EVEN] = UART_CONFIG_PAR_EVEN,
+        [USB_CDC_PARITY_MARK] = UART_CONFIG_PAR_ONE,
+        [USB_CDC_PARITY_SPACE] = UART_CONFIG_PAR_ZERO
+    };
+    uint32_t baud;
+    const uint8_t stop = line_coding[4];
+    const uint8_t parity = line_coding[5];
+    const uint8_t data_bits = line_coding[6];
+
+    memcpy (&baud, line_coding, sizeof (baud));
+    SIM_TEST_CHECK ((parity <= USB_CDC_PARITY_SPACE) && (data_bits >= 5) && (data_bits <= 8),
+                    "invalid recorded line coding");
+    sim_test_set_line_coding (0, baud, ((uint32_t) (data_bits - 5) << 5) | uart_parity[parity] |
+                              ((stop == USB_CDC_STOP_BITS_2) ? UART_CONFIG_STOP_TWO : UART_CONFIG_STOP_ONE));
+}
+
+
+/**
+ * @return The number of bytes expected which didn't arrive, or arrived corrupted
+ */
+static size_t count_dropped (const uint8_t *const expected, const size_t expected_length,
+                             const uint8_t *const received, const size_t received_length)
+{
+    const size_t compared = (received_length < expected_length) ? received_length : expected_length;
+    size_t dropped = expected_length - compared;
+
+    for (size_t offset = 0; offset < compared; offset++)
+    {
+        if (received[offset] != expected[offset])
+        {
+            dropped++;
+        }
+    }
+
+    return dropped;
+}
+
+
+int main (int argc, char *argv[])
+{
+    recording_t recording;
+    replay_wait_t final_wait;
+    sim_time_t start;
+    sim_time_t previous_replayed;
+    sim_time_t max_stall = 0;
+    uint32_t num_stalls = 0;
+    size_t host_to_uart_dropped;
+    size_t uart_to_host_dropped;
+
+    parse_command_line (argc, argv);
+    read_recording (&recording);
+    host_received = malloc (recording.uart_to_host_length + 1);
+    cc3100_received = malloc (recording.host_to_uart_length + 1);
+    SIM_TEST_CHECK ((host_received != NULL) && (cc3100_received != NULL), "out of memory");
+
+    sim_test_boot (SIM_CC3100_SINK);
+    start = sim_now;
+    previous_replayed = sim_now;
+    for (size_t index = 0; index < recording.num_records; index++)
+    {
+        const replay_record_t *const record = &recording.records[index];
+        const bool host_record = (record->type == TRAFFIC_CAPTURE_UART_TX) ||
+                (record->type == TRAFFIC_CAPTURE_BREAK_SET) || (record->type == TRAFFIC_CAPTURE_BREAK_CLEAR) ||
+                (record->type == TRAFFIC_CAPTURE_LINE_CODING) || (record->type == TRAFFIC_CAPTURE_CONTROL_LINE_STATE);
+        const bool cc3100_record = record->type == TRAFFIC_CAPTURE_UART_RX;
+        const sim_time_t gap = (index > 0) ? (record->when - recording.records[index - 1].when) : 0;
+        replay_wait_t wait =
+        {
+            .scheduled = previous_replayed + gap,
+            .host_to_uart_needed = cc3100_record ? record->host_to_uart_before : 0,
+            .uart_to_host_needed = host_record ? record->uart_to_host_before : 0,
+            .needs_power = cc3100_record
+        };
+
+        if (sim_now < wait.scheduled)
+        {
+            sim_run_for (wait.scheduled - sim_now);
+        }
+        (void) sim_run_until (record_due, &wait, REPLAY_WAIT_TIMEOUT);
+        collect_received (&recording);
+        if ((sim_now - wait.scheduled) > SIM_MS (stall_threshold_ms))
+        {
+            num_stalls++;
+        }
+        if ((sim_now - wait.scheduled) > max_stall)
+        {
+            max_stall = sim_now - wait.scheduled;
+        }
+        previous_replayed = sim_now;
+
+        switch (record->type)
+        {
+        case TRAFFIC_CAPTURE_UART_TX:
+            sim_usb_host_write (0, record->data, record->length);
+            break;
+
+        case TRAFFIC_CAPTURE_UART_RX:
+            sim_cc3100_send (record->data, record->length);
+            break;
+
+        case TRAFFIC_CAPTURE_BREAK_SET:
+            sim_test_send_break (0, 0xFFFF);
+            break;
+
+        case TRAFFIC_CAPTURE_BREAK_CLEAR:
+            sim_test_send_break (0, 0);
+            break;
+
+        case TRAFFIC_CAPTURE_LINE_CODING:
+            SIM_TEST_CHECK (record->length >= 7, "short line coding record");
+            replay_line_coding (record->data);
+            break;
+
+        case TRAFFIC_CAPTURE_CONTROL_LINE_STATE:
+            SIM_TEST_CHECK (record->length >= 2, "short control line state record");
+            sim_test_set_control_line_state (0, (uint16_t) (record->data[0] | (record->data[1] << 8)));
+            break;
+
+        default:
+            /* The result of the firmware's actions, rather than of either side */
+            break;
+        }
+    }
+
+    /* Wait for all the data to arrive */
+    final_wait.scheduled = sim_now;
+    final_wait.host_to_uart_needed = recording.host_to_uart_length;
+    final_wait.uart_to_host_needed = recording.uart_to_host_length;
+    final_wait.needs_power = false;
+    (void) sim_run_until (record_due, &final_wait, REPLAY_WAIT_TIMEOUT);
+    collect_received (&recording);
+
+    host_to_uart_dropped = count_dropped (recording.host_to_uart, recording.host_to_uart_length,
+                                          cc3100_received, cc3100_received_length);
+    uart_to_host_dropped = count_dropped (recording.uart_to_host, recording.uart_to_host_length,
+                                          host_received, host_received_length);
+    printf ("{\"recording\": \"%s\", \"records\": %zu, \"recording_gaps\": %u, \"host_to_uart_bytes\": %zu, "
+            "\"uart_to_host_bytes\": %zu, \"recorded_s\": %.6f, \"replayed_s\": %.6f, \"stalls\": %u, "
+            "\"max_stall_ms\": %.3f, \"host_to_uart_dropped\": %zu, \"uart_to_host_dropped\": %zu, "
+            "\"uart_overruns\": %llu}\n",
+            pcap_path, recording.num_records, recording.num_gaps, recording.host_to_uart_length,
+            recording.uart_to_host_length,
+            (recording.num_records > 0) ?
+                    ((double) recording.records[recording.num_records - 1].when / SIM_CPU_HZ) : 0.0,
+            (double) (sim_now - start) / SIM_CPU_HZ, num_stalls, (double) max_stall / (SIM_CPU_HZ / 1000u),
+            host_to_uart_dropped, uart_to_host_dropped,
+            (unsigned long long) sim_uart_stats (UART1_BASE)->rx_overruns);
+
+    free (host_received);
+    free (cc3100_received);
+    free (recording.file_data);
+    free (recording.records);
+    free (recording.host_to_uart);
+    free (recording.uart_to_host);
+
+    return ((host_to_uart_dropped == 0) && (uart_to_host_dropped == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,890 @@
+/*
+ * @file sim.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Core of the host simulation of the bridge: virtual time, events, the NVIC, and running the firmware
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <execinfo.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include "sim.h"
+#include "sim_gpio.h"
+#include "sim_vectors.h"
+
+/** The number of exceptions supported by the TM4C123, the first 16 of which are system exceptions */
+#define SIM_NUM_EXCEPTIONS 155
+
+/** The exception number of PendSV, the only system exception used by the firmware */
+#define SIM_EXCEPTION_PENDSV 14
+
+/** The cycles taken to stack the context and fetch the vector on exception entry */
+#define SIM_EXCEPTION_ENTRY_CYCLES 12
+
+/** The maximum depth of nested exceptions, which is the number of distinct priority levels */
+#define SIM_MAX_NESTING 8
+
+/** The size of the stack on which the firmware runs */
+#define SIM_FIRMWARE_STACK_SIZE (1024 * 1024)
+
+/* Core debug registers which the firmware accesses directly, rather than through driverlib */
+#define SIM_DWT_CTRL           0xE0001000u
+#define SIM_DWT_CYCCNT         0xE0001004u
+#define SIM_DWT_CTRL_CYCCNTENA 0x00000001u
+#define SIM_NVIC_INT_CTRL      0xE000ED04u
+#define SIM_NVIC_PEND0         0xE000E200u
+#define SIM_NVIC_PENDSVSET     0x10000000u
+
+/* The number of 32-bit words of the exception bitmaps */
+#define SIM_EXCEPTION_WORDS ((SIM_NUM_EXCEPTIONS + 31) / 32)
+
+sim_time_t sim_now;
+sim_cpu_stats_t sim_cpu_stats;
+
+/* The event heap, ordered on the time of each event */
+static sim_event_t **event_heap;
+static size_t event_heap_length;
+static size_t event_heap_capacity;
+
+/* The state of the NVIC */
+static uint32_t exceptions_enabled[SIM_EXCEPTION_WORDS];
+static uint32_t exceptions_pending[SIM_EXCEPTION_WORDS];
+static bool exception_lines[SIM_NUM_EXCEPTIONS];
+static bool exceptions_active[SIM_NUM_EXCEPTIONS];
+static uint8_t exception_priorities[SIM_NUM_EXCEPTIONS];
+/* When each pending exception became pending, to measure the latency to entering its handler */
+static sim_time_t exception_pended_at[SIM_NUM_EXCEPTIONS];
+static uint32_t active_stack[SIM_MAX_NESTING];
+static uint32_t active_depth;
+static bool primask;
+
+/* The contexts of the test program and firmware, and the condition which ends the current run */
+static ucontext_t driver_context;
+static ucontext_t firmware_context;
+static bool firmware_started;
+static bool in_firmware;
+static sim_condition_t run_condition;
+static void *run_arg;
+static sim_time_t run_deadline;
+static bool run_result;
+
+/* Incremented each time the firmware calls into the simulation, to detect the firmware spinning forever */
+static volatile uint32_t progress_count;
+static uint32_t watchdog_progress_count;
+
+/* Storage for registers accessed with HWREG(), other than those which are modelled */
+typedef struct
+{
+    uint32_t address;
+    uint32_t value;
+} sim_register_t;
+
+#define SIM_MAX_REGISTERS 64
+static sim_register_t registers[SIM_MAX_REGISTERS];
+static uint32_t num_registers;
+
+
+/**
+ * @brief Report a failure of a check in the simulation, and exit
+ * @details The virtual time is included, as most failures are the result of the timing of the firmware, and the
+ *          call stack to identify the check. Test programs are linked with -rdynamic for the symbols.
+ */
+void sim_fail (const char *format, ...)
+{
+    va_list args;
+    void *frames[64];
+    int num_frames;
+
+    fprintf (stderr, "SIM FAIL at %.6f s: ", (double) sim_now / SIM_CPU_HZ);
+    va_start (args, format);
+    vfprintf (stderr, format, args);
+    va_end (args);
+    fprintf (stderr, "\n");
+    fflush (stderr);
+    num_frames = backtrace (frames, 64);
+    backtrace_symbols_fd (frames, num_frames, STDERR_FILENO);
+    exit (EXIT_FAILURE);
+}
+
+
+/*
+ * Event heap
+ */
+
+static void event_heap_place (sim_event_t *const event, const size_t index)
+{
+    event_heap[index] = event;
+    event->heap_index = (int32_t) index;
+}
+
+
+static void event_heap_sift_up (size_t index)
+{
+    sim_event_t *const event = event_heap[index];
+
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+
+        if (event_heap[parent]->when <= event->when)
+        {
+            break;
+        }
+        event_heap_place (event_heap[parent], index);
+        index = parent;
+    }
+    event_heap_place (event, index);
+}
+
+
+static void event_heap_sift_down (size_t index)
+{
+    sim_event_t *const event = event_heap[index];
+
+    for (;;)
+    {
+        size_t child = (2 * index) + 1;
+
+        if (child >= event_heap_length)
+        {
+            break;
+        }
+        if (((child + 1) < event_heap_length) && (event_heap[child + 1]->when < event_heap[child]->when))
+        {
+            child++;
+        }
+        if (event->when <= event_heap[child]->when)
+        {
+            break;
+        }
+        event_heap_place (event_heap[child], index);
+        index = child;
+    }
+    event_heap_place (event, index);
+}
+
+
+void sim_event_init (sim_event_t *const event, void (*handler) (void *context), void *const context)
+{
+    event->when = 0;
+    event->handler = handler;
+    event->context = context;
+    event->heap_index = -1;
+}
+
+
+/**
+ * @brief Schedule an event, or reschedule it if already scheduled
+ * @details A time in the past is treated as the current time.
+ */
+void sim_event_schedule (sim_event_t *const event, const sim_time_t when)
+{
+    sim_event_cancel (event);
+    if (event_heap_length == event_heap_capacity)
+    {
+        event_heap_capacity = (event_heap_capacity > 0) ? (2 * event_heap_capacity) : 64;
+        event_heap = realloc (event_heap, event_heap_capacity * sizeof (event_heap[0]));
+        if (event_heap == NULL)
+        {
+            sim_fail ("out of memory for events");
+        }
+    }
+    event->when = (when > sim_now) ? when : sim_now;
+    event_heap_place (event, event_heap_length);
+    event_heap_length++;
+    event_heap_sift_up (event_heap_length - 1);
+}
+
+
+void sim_event_cancel (sim_event_t *const event)
+{
+    if (event->heap_index >= 0)
+    {
+        const size_t index = (size_t) event->heap_index;
+
+        event->heap_index = -1;
+        event_heap_length--;
+        if (index < event_heap_length)
+        {
+            event_heap_place (event_heap[event_heap_length], index);
+            event_heap_sift_up (index);
+            event_heap_sift_down ((size_t) event_heap[index]->heap_index);
+        }
+    }
+}
+
+
+static sim_time_t next_event_time (void)
+{
+    return (event_heap_length > 0) ? event_heap[0]->when : UINT64_MAX;
+}
+
+
+/**
+ * @brief Call the handlers of all events which are due at the current time
+ */
+static void run_due_events (void)
+{
+    while ((event_heap_length > 0) && (event_heap[0]->when <= sim_now))
+    {
+        sim_event_t *const event = event_heap[0];
+
+        sim_event_cancel (event);
+        event->handler (event->context);
+    }
+}
+
+
+/*
+ * NVIC
+ */
+
+static void check_exception (const uint32_t exception)
+{
+    if (exception >= SIM_NUM_EXCEPTIONS)
+    {
+        sim_fail ("invalid exception number %u", exception);
+    }
+}
+
+
+static inline bool bitmap_test (const uint32_t *const bitmap, const uint32_t exception)
+{
+    return (bitmap[exception / 32] & (1u << (exception % 32))) != 0;
+}
+
+
+static inline void bitmap_assign (uint32_t *const bitmap, const uint32_t exception, const bool value)
+{
+    if (value)
+    {
+        bitmap[exception / 32] |= 1u << (exception % 32);
+    }
+    else
+    {
+        bitmap[exception / 32] &= ~(1u << (exception % 32));
+    }
+}
+
+
+/**
+ * @brief Make an exception pending, recording the time it became pending
+ */
+static void pend_exception (const uint32_t exception)
+{
+    if (!bitmap_test (exceptions_pending, exception))
+    {
+        exception_pended_at[exception] = sim_now;
+        bitmap_assign (exceptions_pending, exception, true);
+    }
+}
+
+
+/**
+ * @brief The current execution priority, with 0x100 meaning thread mode
+ * @details Only a strictly higher priority can preempt, so the innermost active exception has the highest
+ *          priority of those active.
+ */
+static uint32_t execution_priority (void)
+{
+    return (active_depth > 0) ? exception_priorities[active_stack[active_depth - 1]] : 0x100;
+}
+
+
+/**
+ * @brief Find the pending and enabled exception of highest priority, which is of higher priority than a limit
+ * @param[in] limit Only exceptions with a priority value less than this are considered
+ * @return The exception number, or -1 if none
+ */
+static int32_t highest_pending_exception (const uint32_t limit)
+{
+    int32_t best = -1;
+    uint32_t best_priority = limit;
+
+    for (uint32_t word = 0; word < SIM_EXCEPTION_WORDS; word++)
+    {
+        uint32_t candidates = exceptions_pending[word] & exceptions_enabled[word];
+
+        while (candidates != 0)
+        {
+            const uint32_t exception = (word * 32) + (uint32_t) __builtin_ctz (candidates);
+
+            candidates &= candidates - 1;
+            if (exception_priorities[exception] < best_priority)
+            {
+                best = (int32_t) exception;
+                best_priority = exception_priorities[exception];
+            }
+        }
+    }
+
+    return best;
+}
+
+
+/**
+ * @brief Take all the pending exceptions which can preempt the current execution priority
+ * @details Each handler is called as a nested function, and may itself be preempted when it calls into the
+ *          simulation. A level-sensitive interrupt whose line is still asserted when its handler returns is
+ *          pended again, as the NVIC does.
+ */
+static void dispatch_exceptions (void)
+{
+    int32_t exception;
+
+    while (!primask && ((exception = highest_pending_exception (execution_priority ())) >= 0))
+    {
+        void (*handler) (void) = sim_vector_table[exception];
+
+        if ((handler == NULL) || (handler == sim_unexpected_handler))
+        {
+            sim_fail ("exception %d taken with no handler in the vector table", exception);
+        }
+        if (active_depth == SIM_MAX_NESTING)
+        {
+            sim_fail ("exceptions nested too deeply");
+        }
+
+        bitmap_assign (exceptions_pending, (uint32_t) exception, false);
+        if ((sim_now - exception_pended_at[exception]) > sim_cpu_stats.worst_latency_cycles[exception])
+        {
+            sim_cpu_stats.worst_latency_cycles[exception] = sim_now - exception_pended_at[exception];
+        }
+        exceptions_active[exception] = true;
+        active_stack[active_depth] = (uint32_t) exception;
+        active_depth++;
+        sim_cpu_stats.num_exceptions[exception]++;
+        if (active_depth > sim_cpu_stats.max_nesting)
+        {
+            sim_cpu_stats.max_nesting = active_depth;
+        }
+
+        sim_consume (SIM_EXCEPTION_ENTRY_CYCLES);
+        handler ();
+
+        active_depth--;
+        exceptions_active[exception] = false;
+        if (exception_lines[exception])
+        {
+            pend_exception ((uint32_t) exception);
+        }
+    }
+}
+
+
+void sim_irq_pend (const uint32_t exception)
+{
+    check_exception (exception);
+    pend_exception (exception);
+}
+
+
+void sim_irq_unpend (const uint32_t exception)
+{
+    check_exception (exception);
+    bitmap_assign (exceptions_pending, exception, false);
+}
+
+
+/**
+ * @brief Set the level of the interrupt line from a peripheral
+ * @details An assertion pends the interrupt, unless the handler is active in which case it is pended on exit
+ *          from the handler if the line is still asserted.
+ */
+void sim_irq_line (const uint32_t exception, const bool asserted)
+{
+    check_exception (exception);
+    if (asserted && !exception_lines[exception] && !exceptions_active[exception])
+    {
+        pend_exception (exception);
+    }
+    exception_lines[exception] = asserted;
+}
+
+
+void sim_irq_enable (const uint32_t exception, const bool enabled)
+{
+    check_exception (exception);
+    bitmap_assign (exceptions_enabled, exception, enabled);
+}
+
+
+void sim_irq_priority_set (const uint32_t exception, const uint8_t priority)
+{
+    check_exception (exception);
+
+    /* The TM4C123 implements 3 bits of priority */
+    exception_priorities[exception] = priority & 0xE0;
+}
+
+
+uint8_t sim_irq_priority_get (const uint32_t exception)
+{
+    check_exception (exception);
+    return exception_priorities[exception];
+}
+
+
+bool sim_irq_is_pending (const uint32_t exception)
+{
+    check_exception (exception);
+    return bitmap_test (exceptions_pending, exception);
+}
+
+
+bool sim_irq_is_active (const uint32_t exception)
+{
+    check_exception (exception);
+    return exceptions_active[exception];
+}
+
+
+/**
+ * @brief Set PRIMASK, taking any pending exceptions when interrupts are unmasked
+ * @return The previous value of PRIMASK
+ */
+bool sim_primask_set (const bool masked)
+{
+    const bool previous = primask;
+
+    primask = masked;
+    if (in_firmware)
+    {
+        dispatch_exceptions ();
+    }
+
+    return previous;
+}
+
+
+/*
+ * Running the firmware
+ */
+
+/**
+ * @brief Determine if the current run of the firmware has to return to the test program
+ */
+static bool run_complete (void)
+{
+    if ((run_condition != NULL) && run_condition (run_arg))
+    {
+        run_result = true;
+        return true;
+    }
+    if (sim_now >= run_deadline)
+    {
+        run_result = false;
+        return true;
+    }
+
+    return false;
+}
+
+
+static void yield_to_driver (void)
+{
+    in_firmware = false;
+    swapcontext (&firmware_context, &driver_context);
+    in_firmware = true;
+}
+
+
+/**
+ * @brief Advance virtual time by the cycles taken by an operation of the firmware
+ * @details Events due during the cycles are run in order, and any exceptions they cause are taken at the time of the
+ *          event, which extends the operation by the time spent in the handlers. Once the cycles have elapsed
+ *          control is returned to the test program if the run is complete.
+ */
+void sim_consume (const uint32_t cycles)
+{
+    sim_time_t remaining = cycles;
+
+    progress_count++;
+    if (!in_firmware)
+    {
+        /* The test program calls some functions shared with the firmware, which take no time */
+        return;
+    }
+
+    for (;;)
+    {
+        const sim_time_t next = next_event_time ();
+
+        if ((next - sim_now) > remaining)
+        {
+            sim_now += remaining;
+            break;
+        }
+        if (next > sim_now)
+        {
+            remaining -= next - sim_now;
+            sim_now = next;
+        }
+        run_due_events ();
+        dispatch_exceptions ();
+    }
+
+    for (;;)
+    {
+        dispatch_exceptions ();
+        if (!run_complete ())
+        {
+            break;
+        }
+        yield_to_driver ();
+    }
+}
+
+
+/**
+ * @brief Determine if an exception is pending which will wake the CPU from sleep
+ * @details PRIMASK doesn't prevent waking, which is how the firmware sleeps without a race with its interrupts.
+ */
+static bool wakeup_pending (void)
+{
+    return highest_pending_exception (execution_priority ()) >= 0;
+}
+
+
+/**
+ * @brief Sleep until an exception is pending, advancing time to the next event while none are
+ * @param[in] deep True for deep sleep, which is only distinguished in the statistics
+ */
+void sim_sleep (const bool deep)
+{
+    if (deep)
+    {
+        sim_cpu_stats.num_deep_sleeps++;
+    }
+    else
+    {
+        sim_cpu_stats.num_sleeps++;
+    }
+
+    progress_count++;
+    while (!wakeup_pending ())
+    {
+        sim_time_t next;
+
+        if (run_complete ())
+        {
+            /* The test program may change the inputs to the models, which is re-checked before advancing time */
+            yield_to_driver ();
+            continue;
+        }
+
+        next = next_event_time ();
+        if (next > run_deadline)
+        {
+            next = run_deadline;
+        }
+        if (next > sim_now)
+        {
+            sim_cpu_stats.asleep_cycles += next - sim_now;
+            sim_now = next;
+        }
+        run_due_events ();
+    }
+}
+
+
+static void firmware_entry (void)
+{
+    in_firmware = true;
+    firmware_main ();
+    sim_fail ("the firmware main() returned");
+}
+
+
+/**
+ * @brief Determine if running in the context of the firmware, rather than the test program
+ */
+bool sim_in_firmware (void)
+{
+    return in_firmware;
+}
+
+
+/**
+ * @brief Run the firmware until a condition is true, or a timeout expires
+ * @details The first call resets the CPU, by starting the firmware at main(). The condition is polled each time
+ *          the firmware calls into the simulation and so must be cheap. It is called in the context of the firmware
+ *          so may only inspect the state of the models.
+ * @param[in] condition The condition which ends the run, or NULL to run until the timeout
+ * @param[in] arg Passed to the condition
+ * @param[in] timeout The maximum virtual time to run for
+ * @return Returns true if the condition became true, or false on the timeout
+ */
+bool sim_run_until (sim_condition_t condition, void *arg, const sim_time_t timeout)
+{
+    static uint8_t *firmware_stack;
+
+    if (in_firmware)
+    {
+        sim_fail ("sim_run_until() called from the firmware");
+    }
+
+    if ((condition != NULL) && condition (arg))
+    {
+        return true;
+    }
+
+    run_condition = condition;
+    run_arg = arg;
+    run_deadline = sim_now + timeout;
+
+    if (!firmware_started)
+    {
+        firmware_stack = malloc (SIM_FIRMWARE_STACK_SIZE);
+        if (firmware_stack == NULL)
+        {
+            sim_fail ("out of memory for the firmware stack");
+        }
+        getcontext (&firmware_context);
+        firmware_context.uc_stack.ss_sp = firmware_stack;
+        firmware_context.uc_stack.ss_size = SIM_FIRMWARE_STACK_SIZE;
+        firmware_context.uc_link = NULL;
+        makecontext (&firmware_context, firmware_entry, 0);
+        firmware_started = true;
+    }
+
+    swapcontext (&driver_context, &firmware_context);
+    run_condition = NULL;
+
+    return run_result;
+}
+
+
+void sim_run_for (const sim_time_t duration)
+{
+    (void) sim_run_until (NULL, NULL, duration);
+}
+
+
+/*
+ * Registers accessed directly with HWREG()
+ */
+
+volatile uint32_t *sim_hwreg (uint32_t address)
+{
+    static uint32_t live_value;
+
+    sim_consume (2);
+
+    if (address == SIM_DWT_CYCCNT)
+    {
+        /* The counter only counts once enabled, which the firmware is responsible for */
+        for (uint32_t index = 0; index < num_registers; index++)
+        {
+            if ((registers[index].address == SIM_DWT_CTRL) &&
+                ((registers[index].value & SIM_DWT_CTRL_CYCCNTENA) != 0))
+            {
+                live_value = (uint32_t) sim_now;
+                return &live_value;
+            }
+        }
+        live_value = 0;
+        return &live_value;
+    }
+    else if (address == SIM_NVIC_INT_CTRL)
+    {
+        live_value = sim_irq_is_pending (SIM_EXCEPTION_PENDSV) ? SIM_NVIC_PENDSVSET : 0;
+        return &live_value;
+    }
+    else if ((address >= SIM_NVIC_PEND0) && (address < (SIM_NVIC_PEND0 + 20)))
+    {
+        const uint32_t first_exception = 16 + (32 * ((address - SIM_NVIC_PEND0) / 4));
+
+        live_value = 0;
+        for (uint32_t bit = 0; bit < 32; bit++)
+        {
+            if (((first_exception + bit) < SIM_NUM_EXCEPTIONS) && sim_irq_is_pending (first_exception + bit))
+            {
+                live_value |= 1u << bit;
+            }
+        }
+        return &live_value;
+    }
+
+    for (uint32_t index = 0; index < num_registers; index++)
+    {
+        if (registers[index].address == address)
+        {
+            return &registers[index].value;
+        }
+    }
+    if (num_registers == SIM_MAX_REGISTERS)
+    {
+        sim_fail ("too many registers accessed with HWREG()");
+    }
+    registers[num_registers].address = address;
+    registers[num_registers].value = 0;
+    num_registers++;
+
+    return &registers[num_registers - 1].value;
+}
+
+
+/*
+ * Flash
+ */
+
+/**
+ * @brief Get a pointer to the simulated flash
+ * @details The flash is mapped at the address used by the firmware, so that the firmware can read it directly.
+ *          It is initially erased.
+ */
+uint8_t *sim_flash (const uint32_t address, const uint32_t length)
+{
+    if ((address < SIM_FLASH_BASE) || (length > SIM_FLASH_SIZE) ||
+        ((address - SIM_FLASH_BASE) > (SIM_FLASH_SIZE - length)))
+    {
+        sim_fail ("flash access at 0x%x length %u is outside of the simulated flash", address, length);
+    }
+
+    return (uint8_t *) (uintptr_t) address;
+}
+
+
+/*
+ * Byte queue
+ */
+
+void sim_queue_push (sim_queue_t *const queue, const void *const data, const size_t length)
+{
+    const uint8_t *const bytes = data;
+
+    if ((queue->length + length) > queue->capacity)
+    {
+        size_t new_capacity = (queue->capacity > 0) ? queue->capacity : 4096;
+        uint8_t *new_data;
+
+        while (new_capacity < (queue->length + length))
+        {
+            new_capacity *= 2;
+        }
+        new_data = malloc (new_capacity);
+        if (new_data == NULL)
+        {
+            sim_fail ("out of memory for queue");
+        }
+        (void) sim_queue_peek (queue, new_data, queue->length);
+        free (queue->data);
+        queue->data = new_data;
+        queue->capacity = new_capacity;
+        queue->head = 0;
+    }
+
+    for (size_t index = 0; index < length; index++)
+    {
+        queue->data[(queue->head + queue->length + index) % queue->capacity] = bytes[index];
+    }
+    queue->length += length;
+}
+
+
+size_t sim_queue_peek (const sim_queue_t *const queue, void *const data, const size_t max_length)
+{
+    uint8_t *const bytes = data;
+    const size_t length = (queue->length < max_length) ? queue->length : max_length;
+
+    for (size_t index = 0; index < length; index++)
+    {
+        bytes[index] = queue->data[(queue->head + index) % queue->capacity];
+    }
+
+    return length;
+}
+
+
+size_t sim_queue_pop (sim_queue_t *const queue, void *const data, const size_t max_length)
+{
+    const size_t length = (data != NULL) ? sim_queue_peek (queue, data, max_length) :
+            ((queue->length < max_length) ? queue->length : max_length);
+
+    if (length > 0)
+    {
+        queue->head = (queue->head + length) % queue->capacity;
+        queue->length -= length;
+    }
+
+    return length;
+}
+
+
+void sim_queue_clear (sim_queue_t *const queue)
+{
+    queue->head = 0;
+    queue->length = 0;
+}
+
+
+/*
+ * Initialisation, and the watchdog on the firmware
+ */
+
+/**
+ * @brief Detect the firmware spinning without calling into the simulation, which is how check_assert() fails
+ * @details Runs on a real-time interval, and reports the state of the LEDs so that an assertion can be identified.
+ */
+static void watchdog_handler (int signum)
+{
+    void *frames[64];
+    int num_frames;
+    char message[160];
+
+    (void) signum;
+    if (in_firmware && (progress_count == watchdog_progress_count))
+    {
+        const int length = snprintf (message, sizeof (message),
+                "SIM FAIL at %.6f s: firmware stopped making progress, LEDs %s (red on means check_assert() failed)\n",
+                (double) sim_now / SIM_CPU_HZ, sim_gpio_led_description ());
+
+        (void) write (STDERR_FILENO, message, (size_t) length);
+        num_frames = backtrace (frames, 64);
+        backtrace_symbols_fd (frames, num_frames, STDERR_FILENO);
+        _exit (EXIT_FAILURE);
+    }
+    watchdog_progress_count = progress_count;
+}
+
+
+__attribute__ ((constructor)) static void sim_initialise (void)
+{
+    struct sigaction action;
+    void *const flash = mmap ((void *) (uintptr_t) SIM_FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (flash != (void *) (uintptr_t) SIM_FLASH_BASE)
+    {
+        perror ("mmap of the simulated flash");
+        exit (EXIT_FAILURE);
+    }
+    memset (flash, 0xFF, SIM_FLASH_SIZE);
+
+    /* System exceptions can't be disabled */
+    bitmap_assign (exceptions_enabled, SIM_EXCEPTION_PENDSV, true);
+
+    memset (&action, 0, sizeof (action));
+    action.sa_handler = watchdog_handler;
+    action.sa_flags = SA_RESTART;
+    sigaction (SIGALRM, &action, NULL);
+    {
+        const struct itimerval interval =
+        {
+            .it_interval = {.tv_sec = 2, .tv_usec = 0},
+            .it_value = {.tv_sec = 2, .tv_usec = 0}
+        };
+
+        setitimer (ITIMER_REAL, &interval, NULL);
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * @file sim.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Core of the host simulation of the bridge: virtual time, events, the NVIC, and running the firmware
+ * @details
+ *  The unmodified firmware is compiled for the host against stand-ins for TivaWare driverlib and usblib, whose
+ *  functions are implemented by models of the TM4C123 peripherals and of a USB host. The firmware runs on its own
+ *  stack, switched to from the test program, and time only advances when the firmware calls a driverlib function
+ *  or sleeps. Each call consumes a few CPU cycles of an 80 MHz virtual clock, during which the peripheral models
+ *  run their scheduled events and any interrupt which is pending, enabled and of sufficient priority is taken
+ *  by calling its handler from the firmware's vector table as a nested function call.
+ *
+ *  A test program sets up the models attached to the bridge, then alternates between running the firmware with
+ *  sim_run_until() and acting as the USB host and CC3100 through the model APIs. The models must only be driven
+ *  from the test program between runs, and never call firmware functions other than through interrupt handlers.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** The frequency of the virtual CPU clock */
+#define SIM_CPU_HZ 80000000u
+
+/** Virtual time, in CPU cycles since reset */
+typedef uint64_t sim_time_t;
+
+#define SIM_US(us) ((sim_time_t) (us) * (SIM_CPU_HZ / 1000000u))
+#define SIM_MS(ms) ((sim_time_t) (ms) * (SIM_CPU_HZ / 1000u))
+
+/** The current virtual time, only advanced by the simulation core */
+extern sim_time_t sim_now;
+
+/** An action scheduled by a model at a virtual time */
+typedef struct
+{
+    /** When the handler is to be called, valid while scheduled */
+    sim_time_t when;
+    /** Called at the scheduled time, in the context of the firmware but without consuming any time */
+    void (*handler) (void *context);
+    void *context;
+    /** The position in the event heap, or -1 when not scheduled */
+    int32_t heap_index;
+} sim_event_t;
+
+void sim_event_init (sim_event_t *const event, void (*handler) (void *context), void *const context);
+void sim_event_schedule (sim_event_t *const event, const sim_time_t when);
+void sim_event_cancel (sim_event_t *const event);
+
+static inline bool sim_event_scheduled (const sim_event_t *const event)
+{
+    return event->heap_index >= 0;
+}
+
+/** Statistics for the virtual CPU, used to measure the load imposed by the firmware */
+typedef struct
+{
+    /** The cycles spent sleeping in CPUwfi() or SysCtlDeepSleep() */
+    sim_time_t asleep_cycles;
+    uint32_t num_sleeps;
+    uint32_t num_deep_sleeps;
+    /** The number of times each exception handler has been entered */
+    uint32_t num_exceptions[155];
+    /** The deepest nesting of exception handlers */
+    uint32_t max_nesting;
+    /** The worst case latency of each exception in CPU cycles, from becoming pending to entering its handler */
+    sim_time_t worst_latency_cycles[155];
+} sim_cpu_stats_t;
+
+extern sim_cpu_stats_t sim_cpu_stats;
+
+/* Called by the driverlib and usblib stand-ins, in the context of the firmware */
+void sim_consume (const uint32_t cycles);
+void sim_sleep (const bool deep);
+bool sim_primask_set (const bool masked);
+
+/* The NVIC, indexed by exception number */
+void sim_irq_pend (const uint32_t exception);
+void sim_irq_unpend (const uint32_t exception);
+void sim_irq_line (const uint32_t exception, const bool asserted);
+void sim_irq_enable (const uint32_t exception, const bool enabled);
+void sim_irq_priority_set (const uint32_t exception, const uint8_t priority);
+uint8_t sim_irq_priority_get (const uint32_t exception);
+bool sim_irq_is_pending (const uint32_t exception);
+bool sim_irq_is_active (const uint32_t exception);
+
+/** A condition polled while the firmware runs, which stops the run once true */
+typedef bool (*sim_condition_t) (void *arg);
+
+bool sim_run_until (sim_condition_t condition, void *arg, const sim_time_t timeout);
+void sim_run_for (const sim_time_t duration);
+bool sim_in_firmware (void);
+
+void sim_fail (const char *format, ...) __attribute__ ((noreturn, format (printf, 1, 2)));
+
+/* The simulated flash, which only covers the region holding the CC3100 programmer image */
+#define SIM_FLASH_BASE 0x00010000u
+#define SIM_FLASH_SIZE 0x00030000u
+
+uint8_t *sim_flash (const uint32_t address, const uint32_t length);
+void sim_flash_user_set (const uint32_t user0, const uint32_t user1);
+
+/* Access to the registers which the firmware accesses directly with HWREG(), rather than through driverlib */
+volatile uint32_t *sim_hwreg (uint32_t address);
+
+/* Tracking of the peripherals whose clocks have been enabled, checked by the models on each access */
+void sim_peripheral_check (const uint32_t peripheral, const char *const function);
+
+/** A growable byte queue, used by the models to hold the data passing through them */
+typedef struct
+{
+    uint8_t *data;
+    size_t capacity;
+    size_t head;
+    size_t length;
+} sim_queue_t;
+
+void sim_queue_push (sim_queue_t *const queue, const void *const data, const size_t length);
+size_t sim_queue_pop (sim_queue_t *const queue, void *const data, const size_t max_length);
+size_t sim_queue_peek (const sim_queue_t *const queue, void *const data, const size_t max_length);
+void sim_queue_clear (sim_queue_t *const queue);
+
+static inline size_t sim_queue_length (const sim_queue_t *const queue)
+{
+    return queue->length;
+}
+
+#endif /* SIM_H_ */
@@ -0,0 +1,265 @@
+/*
+ * @file sim_cc3100.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the CC3100BOOST attached to UART1 of the bridge, for the host simulation
+ */
+
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/uart.h"
+
+#include "sim.h"
+#include "sim_gpio.h"
+#include "sim_uart.h"
+#include "sim_cc3100.h"
+
+/* The CC3100BOOST signals, as defined in bridge_hal.h */
+#define SIM_CC3100_UART_BASE   UART1_BASE
+#define SIM_CC3100_PORT_BASE   GPIO_PORTE_BASE
+#define SIM_CC3100_NHIB_PIN    GPIO_PIN_4
+#define SIM_CC3100_NRESET_PIN  GPIO_PIN_1
+
+static sim_cc3100_mode_t cc3100_mode;
+static bool cc3100_powered;
+static bool cc3100_breaking;
+static sim_queue_t cc3100_received;
+static sim_cc3100_stats_t cc3100_stats;
+
+/** Set while the bootloader is running */
+static bool cc3100_bootloader;
+/** The state of the bootloader, which retains its file system between entries */
+static sim_cc3100_bootloader_t bootloader;
+/** While set, the command of the bootloader is being run */
+static sim_event_t bootloader_command_event;
+
+
+static void bootloader_send (void *context, const void *data, size_t length)
+{
+    (void) context;
+    sim_uart_peer_send (SIM_CC3100_UART_BASE, data, length);
+}
+
+
+/**
+ * @brief Run the command in a bootloader packet, once the time taken by the command has elapsed
+ */
+static void bootloader_command (void *context)
+{
+    (void) context;
+    sim_cc3100_bootloader_run_command (&bootloader);
+}
+
+
+/**
+ * @brief Pass a character received by the bootloader to the model, and schedule the command in a complete packet
+ */
+static void bootloader_receive (const uint8_t character)
+{
+    const uint32_t bad_packets = bootloader.num_bad_packets;
+    uint32_t command_time_us;
+
+    if (sim_cc3100_bootloader_receive (&bootloader, character, &command_time_us))
+    {
+        cc3100_stats.bootloader_commands++;
+        sim_event_schedule (&bootloader_command_event, sim_now + SIM_US (command_time_us));
+    }
+    cc3100_stats.bootloader_bad_packets += bootloader.num_bad_packets - bad_packets;
+}
+
+
+static void cc3100_receive (void *context, uint8_t character, bool error)
+{
+    (void) context;
+    if (!cc3100_powered)
+    {
+        cc3100_stats.rx_unpowered++;
+        return;
+    }
+
+    if (error)
+    {
+        cc3100_stats.rx_errors++;
+        return;
+    }
+
+    cc3100_stats.rx_characters++;
+    sim_queue_push (&cc3100_received, &character, sizeof (character));
+    if (cc3100_bootloader)
+    {
+        bootloader_receive (character);
+    }
+    else if (cc3100_mode == SIM_CC3100_ECHO)
+    {
+        sim_uart_peer_send (SIM_CC3100_UART_BASE, &character, sizeof (character));
+        cc3100_stats.echoed++;
+    }
+}
+
+
+static void cc3100_break_changed (void *context, bool active)
+{
+    (void) context;
+    if (active && !cc3100_breaking)
+    {
+        cc3100_stats.breaks++;
+    }
+    cc3100_breaking = active;
+}
+
+
+static void cc3100_signals_changed (void *context, uint32_t port_base, uint8_t levels)
+{
+    const uint8_t power_pins = SIM_CC3100_NHIB_PIN | SIM_CC3100_NRESET_PIN;
+    const bool powered = (levels & power_pins) == power_pins;
+
+    (void) context;
+    (void) port_base;
+    if (powered && !cc3100_powered)
+    {
+        cc3100_stats.power_ups++;
+
+        /* Enter the bootloader, which acknowledges the break once at its fixed baud rate */
+        if ((cc3100_mode == SIM_CC3100_BOOTLOADER) && cc3100_breaking)
+        {
+            cc3100_bootloader = true;
+            cc3100_stats.bootloader_entries++;
+            sim_uart_peer_config (SIM_CC3100_UART_BASE, SIM_CC3100_BOOTLOADER_BAUD,
+                                  UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE, true);
+            sim_cc3100_bootloader_enter (&bootloader);
+        }
+    }
+    else if (!powered && cc3100_powered)
+    {
+        cc3100_bootloader = false;
+        sim_event_cancel (&bootloader_command_event);
+    }
+    cc3100_powered = powered;
+}
+
+
+/**
+ * @brief Attach the CC3100 to UART1 and the nHIB and nRESET signals, with the default 115200 8N1 line settings and
+ *        hardware flow control
+ * @param[in] mode How the CC3100 responds to the characters it receives
+ */
+void sim_cc3100_attach (const sim_cc3100_mode_t mode)
+{
+    static const sim_uart_peer_t peer =
+    {
+        .receive = cc3100_receive,
+        .break_changed = cc3100_break_changed,
+        .context = NULL
+    };
+
+    cc3100_mode = mode;
+    sim_cc3100_bootloader_init (&bootloader, bootloader_send, NULL);
+    sim_event_init (&bootloader_command_event, bootloader_command, NULL);
+    sim_uart_attach (SIM_CC3100_UART_BASE, &peer);
+    sim_cc3100_line_config (115200, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    sim_gpio_observe (SIM_CC3100_PORT_BASE, SIM_CC3100_NHIB_PIN | SIM_CC3100_NRESET_PIN, cc3100_signals_changed,
+                      NULL);
+    cc3100_signals_changed (NULL, SIM_CC3100_PORT_BASE, sim_gpio_levels (SIM_CC3100_PORT_BASE));
+}
+
+
+/**
+ * @brief Change how the CC3100 responds to the characters it receives
+ * @details Leaves the bootloader if it is running, otherwise the bootloader is only entered at the next power up.
+ * @param[in] mode The new mode
+ */
+void sim_cc3100_set_mode (const sim_cc3100_mode_t mode)
+{
+    cc3100_mode = mode;
+    if (mode != SIM_CC3100_BOOTLOADER)
+    {
+        cc3100_bootloader = false;
+        sim_event_cancel (&bootloader_command_event);
+    }
+}
+
+
+/**
+ * @brief Change the line settings of the CC3100 UART, which must match those the host sets on the bridge
+ * @param[in] baud The baud rate
+ * @param[in] config The frame format, as UART_CONFIG_ flags
+ */
+void sim_cc3100_line_config (const uint32_t baud, const uint32_t config)
+{
+    sim_uart_peer_config (SIM_CC3100_UART_BASE, baud, config, true);
+}
+
+
+bool sim_cc3100_powered (void)
+{
+    return cc3100_powered;
+}
+
+
+bool sim_cc3100_break_active (void)
+{
+    return cc3100_breaking;
+}
+
+
+/**
+ * @brief Read the characters which the CC3100 has received
+ * @param[out] data Where to store the characters
+ * @param[in] max_length The maximum number of characters to read
+ * @return The number of characters read
+ */
+size_t sim_cc3100_read (void *const data, const size_t max_length)
+{
+    return sim_queue_pop (&cc3100_received, data, max_length);
+}
+
+
+size_t sim_cc3100_read_available (void)
+{
+    return sim_queue_length (&cc3100_received);
+}
+
+
+/**
+ * @brief Queue characters for the CC3100 to send to the bridge, subject to the RTS flow control of the bridge
+ */
+void sim_cc3100_send (const void *const data, const size_t length)
+{
+    sim_uart_peer_send (SIM_CC3100_UART_BASE, data, length);
+}
+
+
+const sim_cc3100_stats_t *sim_cc3100_stats (void)
+{
+    return &cc3100_stats;
+}
+
+
+bool sim_cc3100_bootloader_active (void)
+{
+    return cc3100_bootloader;
+}
+
+
+/**
+ * @brief Read back a file uploaded to the bootloader
+ * @param[in] name The name of the file
+ * @param[out] data Set to point at the file contents
+ * @param[out] length Set to the file length
+ * @return Returns true if the file exists and its upload was finished
+ */
+bool sim_cc3100_file_read (const char *const name, const uint8_t **const data, size_t *const length)
+{
+    const sim_cc3100_file_t *const file = sim_cc3100_bootloader_file (&bootloader, name);
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    *data = file->data;
+    *length = file->length;
+    return true;
+}
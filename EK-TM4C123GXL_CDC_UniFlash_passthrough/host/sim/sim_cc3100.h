@@ -0,0 +1,68 @@
+/*
+ * @file sim_cc3100.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the CC3100BOOST attached to UART1 of the bridge, for the host simulation
+ * @details
+ *  The CC3100 is powered while both nHIB and nRESET are high, and only then responds on its UART. Every character
+ *  it receives is captured for the test program, and in echo mode is also sent back, so that the USB host sees a
+ *  loopback through the bridge. The test program may also queue characters for the CC3100 to send.
+ *
+ *  In bootloader mode the CC3100 enters its bootloader when powered up while the bridge is sending a break, as for
+ *  the UniFlash break sequence. The bootloader acknowledges the break at SIM_CC3100_BOOTLOADER_BAUD, and then
+ *  runs the bootloader protocol of sim_cc3100_bootloader.h, to a file system which the test program can read back.
+ */
+
+#ifndef SIM_CC3100_H_
+#define SIM_CC3100_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+#include "sim_cc3100_bootloader.h"
+
+/** How the CC3100 responds to the characters it receives */
+typedef enum
+{
+    /** Only capture the characters */
+    SIM_CC3100_SINK,
+    /** Capture the characters, and send each one back */
+    SIM_CC3100_ECHO,
+    /** Capture the characters, and enter the bootloader on a power up during a break */
+    SIM_CC3100_BOOTLOADER
+} sim_cc3100_mode_t;
+
+/** The activity seen by the CC3100 */
+typedef struct
+{
+    /** Characters received without error, and with a framing error */
+    uint64_t rx_characters;
+    uint64_t rx_errors;
+    /** Characters sent back in echo mode, or dropped as the CC3100 wasn't powered */
+    uint64_t echoed;
+    uint64_t rx_unpowered;
+    /** The number of breaks started by the bridge, and of transitions from unpowered to powered */
+    uint32_t breaks;
+    uint32_t power_ups;
+    /** The number of times the bootloader was entered, and of the packets it received with a valid and an invalid
+     *  checksum */
+    uint32_t bootloader_entries;
+    uint32_t bootloader_commands;
+    uint32_t bootloader_bad_packets;
+} sim_cc3100_stats_t;
+
+void sim_cc3100_attach (const sim_cc3100_mode_t mode);
+void sim_cc3100_set_mode (const sim_cc3100_mode_t mode);
+void sim_cc3100_line_config (const uint32_t baud, const uint32_t config);
+bool sim_cc3100_powered (void);
+bool sim_cc3100_break_active (void);
+size_t sim_cc3100_read (void *const data, const size_t max_length);
+size_t sim_cc3100_read_available (void);
+void sim_cc3100_send (const void *const data, const size_t length);
+const sim_cc3100_stats_t *sim_cc3100_stats (void);
+bool sim_cc3100_bootloader_active (void);
+bool sim_cc3100_file_read (const char *const name, const uint8_t **const data, size_t *const length);
+
+#endif /* SIM_CC3100_H_ */
@@ -0,0 +1,288 @@
+/*
+ * @file sim_cc3100_bootloader.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the CC3100 bootloader protocol, shared by the CC3100 model of the host simulation and the
+ *        pty-backed CC3100 simulator in tools/
+ */
+
+#include <string.h>
+
+#include "sim_cc3100_bootloader.h"
+
+const uint8_t sim_cc3100_version[28] =
+{
+    0x00, 0x04, 0x00, 0x00, 0x01, 0x33, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x10, 0x11, 0x12, 0x13,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+
+static uint32_t get_be32 (const uint8_t *const data)
+{
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+}
+
+
+static sim_cc3100_file_t *find_file (sim_cc3100_bootloader_t *const bootloader, const char *const name)
+{
+    for (uint32_t file_index = 0; file_index < SIM_CC3100_MAX_FILES; file_index++)
+    {
+        if (bootloader->files[file_index].in_use && (strcmp (bootloader->files[file_index].name, name) == 0))
+        {
+            return &bootloader->files[file_index];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Send a bootloader response packet, of the big-endian length including the length, the checksum then the
+ *        data. The acknowledgement of the packet by the host is skipped before the next packet is received.
+ */
+static void send_response_packet (sim_cc3100_bootloader_t *const bootloader,
+                                  const uint8_t *const data, const size_t length)
+{
+    uint8_t header[3] = {(uint8_t) ((length + 2) >> 8), (uint8_t) (length + 2), 0};
+
+    for (size_t index = 0; index < length; index++)
+    {
+        header[2] += data[index];
+    }
+    bootloader->send (bootloader->context, header, sizeof (header));
+    bootloader->send (bootloader->context, data, length);
+    bootloader->response_ack_pending = 2;
+}
+
+
+/**
+ * @brief Start an upload, replacing any existing file of the same name
+ * @return Returns true if the file fits in the file system
+ */
+static bool start_upload (sim_cc3100_bootloader_t *const bootloader, const uint8_t *const data, const size_t length)
+{
+    const char *const name = (const char *) &data[4];
+    const size_t name_length = (length > 4) ? strnlen (name, length - 4) : 0;
+    sim_cc3100_file_t *file;
+
+    bootloader->upload = NULL;
+    if ((name_length == 0) || (name_length >= SIM_CC3100_MAX_FILE_NAME) || (name_length == (length - 4)) ||
+        (get_be32 (data) > SIM_CC3100_MAX_FILE_SIZE))
+    {
+        return false;
+    }
+
+    file = find_file (bootloader, name);
+    for (uint32_t file_index = 0; (file == NULL) && (file_index < SIM_CC3100_MAX_FILES); file_index++)
+    {
+        if (!bootloader->files[file_index].in_use)
+        {
+            file = &bootloader->files[file_index];
+        }
+    }
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    memset (file, 0, sizeof (*file));
+    file->in_use = true;
+    memcpy (file->name, name, name_length);
+    file->length = get_be32 (data);
+    bootloader->upload = file;
+
+    return true;
+}
+
+
+/**
+ * @brief Initialise a bootloader with an empty file system
+ * @param[out] bootloader The bootloader to initialise
+ * @param[in] send Called to send characters to the host
+ * @param[in] context Passed to send
+ */
+void sim_cc3100_bootloader_init (sim_cc3100_bootloader_t *const bootloader,
+                                 void (*send) (void *context, const void *data, size_t length), void *const context)
+{
+    memset (bootloader, 0, sizeof (*bootloader));
+    bootloader->send = send;
+    bootloader->context = context;
+}
+
+
+/**
+ * @brief Enter the bootloader, which acknowledges the break. The file system is retained.
+ */
+void sim_cc3100_bootloader_enter (sim_cc3100_bootloader_t *const bootloader)
+{
+    static const uint8_t ack[] = {SIM_CC3100_ACK_0, SIM_CC3100_ACK_1};
+
+    bootloader->packet_length = 0;
+    bootloader->command_pending = false;
+    bootloader->response_ack_pending = 0;
+    bootloader->last_status = SIM_CC3100_STATUS_SUCCESS;
+    bootloader->upload = NULL;
+    bootloader->send (bootloader->context, ack, sizeof (ack));
+}
+
+
+/**
+ * @brief Frame a character received by the bootloader into a packet
+ * @details The acknowledgement from the host of a response packet is discarded.
+ *          A packet with an invalid checksum isn't acknowledged.
+ *          Characters received while a command is pending are ignored.
+ * @param[in,out] bootloader The bootloader which received the character
+ * @param[in] character The received character
+ * @param[out] command_time_us When returns true, the time the command takes before it is acknowledged
+ * @return Returns true when a packet with a valid checksum is complete, after which the user must wait for
+ *         command_time_us and then call sim_cc3100_bootloader_run_command()
+ */
+bool sim_cc3100_bootloader_receive (sim_cc3100_bootloader_t *const bootloader, const uint8_t character,
+                                    uint32_t *const command_time_us)
+{
+    size_t packet_length;
+    uint8_t checksum;
+
+    if (bootloader->command_pending)
+    {
+        return false;
+    }
+
+    if (bootloader->response_ack_pending > 0)
+    {
+        bootloader->response_ack_pending--;
+        return false;
+    }
+
+    bootloader->packet[bootloader->packet_length++] = character;
+    if (bootloader->packet_length < 3)
+    {
+        return false;
+    }
+
+    packet_length = ((size_t) bootloader->packet[0] << 8) | bootloader->packet[1];
+    if ((packet_length < 3) || ((packet_length + 1) > SIM_CC3100_MAX_PACKET))
+    {
+        bootloader->num_bad_packets++;
+        bootloader->packet_length = 0;
+        return false;
+    }
+    if (bootloader->packet_length < (packet_length + 1))
+    {
+        return false;
+    }
+
+    checksum = 0;
+    for (size_t index = 3; index < bootloader->packet_length; index++)
+    {
+        checksum += bootloader->packet[index];
+    }
+    if (checksum != bootloader->packet[2])
+    {
+        bootloader->num_bad_packets++;
+        bootloader->packet_length = 0;
+        return false;
+    }
+
+    bootloader->num_commands++;
+    bootloader->command_pending = true;
+    *command_time_us = (bootloader->packet[3] == SIM_CC3100_OPCODE_FORMAT_FLASH) ?
+            SIM_CC3100_FORMAT_TIME_US : SIM_CC3100_COMMAND_TIME_US;
+
+    return true;
+}
+
+
+/**
+ * @brief Run the command in the complete packet, acknowledging it followed by any response packet
+ */
+void sim_cc3100_bootloader_run_command (sim_cc3100_bootloader_t *const bootloader)
+{
+    static const uint8_t ack[] = {SIM_CC3100_ACK_0, SIM_CC3100_ACK_1};
+    const uint8_t opcode = bootloader->packet[3];
+    const uint8_t *const data = &bootloader->packet[4];
+    const size_t data_length = bootloader->packet_length - 4;
+    sim_cc3100_file_t *const upload = bootloader->upload;
+    bool success = true;
+    uint32_t offset;
+
+    if (!bootloader->command_pending)
+    {
+        return;
+    }
+    bootloader->command_pending = false;
+    bootloader->packet_length = 0;
+
+    bootloader->send (bootloader->context, ack, sizeof (ack));
+    switch (opcode)
+    {
+    case SIM_CC3100_OPCODE_GET_VERSION_INFO:
+        send_response_packet (bootloader, sim_cc3100_version, sizeof (sim_cc3100_version));
+        break;
+
+    case SIM_CC3100_OPCODE_GET_LAST_STATUS:
+        send_response_packet (bootloader, &bootloader->last_status, sizeof (bootloader->last_status));
+        break;
+
+    case SIM_CC3100_OPCODE_FORMAT_FLASH:
+        memset (bootloader->files, 0, sizeof (bootloader->files));
+        bootloader->upload = NULL;
+        break;
+
+    case SIM_CC3100_OPCODE_START_UPLOAD:
+        success = start_upload (bootloader, data, data_length);
+        break;
+
+    case SIM_CC3100_OPCODE_FILE_CHUNK:
+        offset = (data_length >= 4) ? get_be32 (data) : 0;
+        success = (upload != NULL) && (data_length >= 4) && (offset <= upload->length) &&
+                ((data_length - 4) <= (upload->length - offset));
+        if (success)
+        {
+            memcpy (&upload->data[offset], &data[4], data_length - 4);
+        }
+        break;
+
+    case SIM_CC3100_OPCODE_FINISH_UPLOAD:
+        success = upload != NULL;
+        if (success)
+        {
+            upload->complete = true;
+            bootloader->upload = NULL;
+        }
+        break;
+
+    default:
+        success = false;
+        break;
+    }
+
+    if (opcode != SIM_CC3100_OPCODE_GET_LAST_STATUS)
+    {
+        bootloader->last_status = success ? SIM_CC3100_STATUS_SUCCESS : SIM_CC3100_STATUS_FAILED;
+    }
+}
+
+
+/**
+ * @brief Look up a file uploaded to the bootloader
+ * @param[in] bootloader The bootloader to search
+ * @param[in] name The name of the file
+ * @return The file, or NULL if it doesn't exist or its upload wasn't finished
+ */
+const sim_cc3100_file_t *sim_cc3100_bootloader_file (const sim_cc3100_bootloader_t *const bootloader,
+                                                     const char *const name)
+{
+    for (uint32_t file_index = 0; file_index < SIM_CC3100_MAX_FILES; file_index++)
+    {
+        const sim_cc3100_file_t *const file = &bootloader->files[file_index];
+
+        if (file->in_use && file->complete && (strcmp (file->name, name) == 0))
+        {
+            return file;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,106 @@
+/*
+ * @file sim_cc3100_bootloader.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the CC3100 bootloader protocol, shared by the CC3100 model of the host simulation and the
+ *        pty-backed CC3100 simulator in tools/
+ * @details
+ *  Once entered the bootloader acknowledges the break, then frames the characters it receives into packets of the
+ *  big-endian length including the length, the checksum of the command then the command. Each packet with a valid
+ *  checksum is acknowledged once the command has run, followed by any response packet, which the host must
+ *  acknowledge before sending the next packet. Only the commands used to upload files are modelled, to a file
+ *  system held in the model which can be read back.
+ *
+ *  The model doesn't keep time. The user feeds it the received characters, and when a packet is complete waits
+ *  for the time taken by the command before running it.
+ */
+
+#ifndef SIM_CC3100_BOOTLOADER_H_
+#define SIM_CC3100_BOOTLOADER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** The fixed baud rate of the bootloader */
+#define SIM_CC3100_BOOTLOADER_BAUD 921600
+
+/** The acknowledgement sent by the bootloader for the break and each valid packet */
+#define SIM_CC3100_ACK_0 0x00
+#define SIM_CC3100_ACK_1 0xCC
+
+/* The bootloader commands which are modelled. The command data is big-endian. */
+/** Data: the file length (4 bytes) and the NUL terminated file name. Replaces any existing file. */
+#define SIM_CC3100_OPCODE_START_UPLOAD     0x21
+/** No data. Completes the file being uploaded. */
+#define SIM_CC3100_OPCODE_FINISH_UPLOAD    0x22
+/** No data. The response packet is the 1 byte status of the previous command. */
+#define SIM_CC3100_OPCODE_GET_LAST_STATUS  0x23
+/** Data: the offset in the file (4 bytes) followed by the data to write at the offset */
+#define SIM_CC3100_OPCODE_FILE_CHUNK       0x24
+/** No data. Deletes all files, which takes SIM_CC3100_FORMAT_TIME_US before the command is acknowledged. */
+#define SIM_CC3100_OPCODE_FORMAT_FLASH     0x28
+/** No data. The response packet is the 28 bytes of sim_cc3100_version. */
+#define SIM_CC3100_OPCODE_GET_VERSION_INFO 0x2F
+
+/** The status returned by SIM_CC3100_OPCODE_GET_LAST_STATUS */
+#define SIM_CC3100_STATUS_SUCCESS 0x40
+#define SIM_CC3100_STATUS_FAILED  0x41
+
+/** The time taken to acknowledge a command, and to format the serial flash */
+#define SIM_CC3100_COMMAND_TIME_US 100
+#define SIM_CC3100_FORMAT_TIME_US  300000
+
+/** The limits of the modelled file system */
+#define SIM_CC3100_MAX_FILES     4
+#define SIM_CC3100_MAX_FILE_SIZE 16384
+#define SIM_CC3100_MAX_FILE_NAME 64
+
+/** The largest packet the bootloader accepts, as the length and checksum header plus the command */
+#define SIM_CC3100_MAX_PACKET (3 + 8 + SIM_CC3100_MAX_FILE_SIZE)
+
+extern const uint8_t sim_cc3100_version[28];
+
+/** A file in the modelled file system */
+typedef struct
+{
+    bool in_use;
+    /** Set once the upload has finished */
+    bool complete;
+    char name[SIM_CC3100_MAX_FILE_NAME];
+    size_t length;
+    uint8_t data[SIM_CC3100_MAX_FILE_SIZE];
+} sim_cc3100_file_t;
+
+/** The state of one bootloader */
+typedef struct
+{
+    /** Called to send characters to the host */
+    void (*send) (void *context, const void *data, size_t length);
+    void *context;
+    /** The packet being received, and once complete the command to run */
+    uint8_t packet[SIM_CC3100_MAX_PACKET];
+    size_t packet_length;
+    /** Set from when a packet is complete until its command has been run, while received characters are ignored */
+    bool command_pending;
+    /** The number of characters of the acknowledgement of a response packet yet to be received from the host */
+    uint32_t response_ack_pending;
+    uint8_t last_status;
+    sim_cc3100_file_t files[SIM_CC3100_MAX_FILES];
+    /** The file being uploaded, or NULL */
+    sim_cc3100_file_t *upload;
+    /** The number of packets received with a valid and an invalid checksum */
+    uint32_t num_commands;
+    uint32_t num_bad_packets;
+} sim_cc3100_bootloader_t;
+
+void sim_cc3100_bootloader_init (sim_cc3100_bootloader_t *const bootloader,
+                                 void (*send) (void *context, const void *data, size_t length), void *const context);
+void sim_cc3100_bootloader_enter (sim_cc3100_bootloader_t *const bootloader);
+bool sim_cc3100_bootloader_receive (sim_cc3100_bootloader_t *const bootloader, const uint8_t character,
+                                    uint32_t *const command_time_us);
+void sim_cc3100_bootloader_run_command (sim_cc3100_bootloader_t *const bootloader);
+const sim_cc3100_file_t *sim_cc3100_bootloader_file (const sim_cc3100_bootloader_t *const bootloader,
+                                                     const char *const name);
+
+#endif /* SIM_CC3100_BOOTLOADER_H_ */
@@ -0,0 +1,373 @@
+/*
+ * @file sim_gpio.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 GPIO ports, for the host simulation of the bridge
+ */
+
+#include <stdio.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
+#include "driverlib/gpio.h"
+#include "driverlib/sysctl.h"
+
+#include "sim.h"
+#include "sim_gpio.h"
+
+/** The pins of each port which are locked, and whose configuration can't be changed until committed */
+#define SIM_GPIO_PORTD_LOCKED_PINS GPIO_PIN_7
+#define SIM_GPIO_PORTF_LOCKED_PINS GPIO_PIN_0
+
+/** The maximum number of observers of each port */
+#define SIM_GPIO_MAX_OBSERVERS 4
+
+typedef struct
+{
+    uint8_t pins;
+    sim_gpio_observer_t observer;
+    void *context;
+} sim_gpio_observation_t;
+
+/** The state of one GPIO port */
+typedef struct
+{
+    uint32_t base;
+    uint32_t peripheral;
+    uint32_t interrupt;
+    uint8_t locked_pins;
+    /** Pins configured as outputs */
+    uint8_t direction;
+    /** Pins configured as open-drain outputs */
+    uint8_t open_drain;
+    /** Pins with the pull-up enabled */
+    uint8_t pull_up;
+    /** Pins assigned to a peripheral, rather than being a GPIO */
+    uint8_t alternate;
+    /** The output data register */
+    uint8_t data;
+    /** Pins driven by the test program, and the levels driven */
+    uint8_t external_driven;
+    uint8_t external_levels;
+    /** The current pin levels, used to detect edges */
+    uint8_t levels;
+    /** The interrupt configuration and status */
+    uint8_t int_both_edges;
+    uint8_t int_rising;
+    uint8_t int_mask;
+    uint8_t int_raw;
+    sim_gpio_observation_t observations[SIM_GPIO_MAX_OBSERVERS];
+    uint32_t num_observations;
+} sim_gpio_port_t;
+
+static sim_gpio_port_t ports[] =
+{
+    {.base = GPIO_PORTB_BASE, .peripheral = SYSCTL_PERIPH_GPIOB, .interrupt = INT_GPIOB},
+    {.base = GPIO_PORTC_BASE, .peripheral = SYSCTL_PERIPH_GPIOC, .interrupt = 18},
+    {.base = GPIO_PORTD_BASE, .peripheral = SYSCTL_PERIPH_GPIOD, .interrupt = 19,
+     .locked_pins = SIM_GPIO_PORTD_LOCKED_PINS},
+    {.base = GPIO_PORTE_BASE, .peripheral = SYSCTL_PERIPH_GPIOE, .interrupt = 20},
+    {.base = GPIO_PORTF_BASE, .peripheral = SYSCTL_PERIPH_GPIOF, .interrupt = 46,
+     .locked_pins = SIM_GPIO_PORTF_LOCKED_PINS}
+};
+
+#define SIM_GPIO_NUM_PORTS (sizeof (ports) / sizeof (ports[0]))
+
+
+static sim_gpio_port_t *find_port (const uint32_t port_base)
+{
+    for (uint32_t port_index = 0; port_index < SIM_GPIO_NUM_PORTS; port_index++)
+    {
+        if (ports[port_index].base == port_base)
+        {
+            return &ports[port_index];
+        }
+    }
+    sim_fail ("GPIO port 0x%x isn't modelled", port_base);
+}
+
+
+/**
+ * @brief Get a port accessed by the firmware, which consumes the cycles of the driverlib call
+ */
+static sim_gpio_port_t *access_port (const uint32_t port_base, const char *const function)
+{
+    sim_gpio_port_t *const port = find_port (port_base);
+
+    sim_consume (10);
+    sim_peripheral_check (port->peripheral, function);
+
+    return port;
+}
+
+
+/**
+ * @brief Get the pins whose configuration can be changed, which excludes locked pins which haven't been committed
+ *        by setting their bit in the commit register
+ */
+static uint8_t configurable_pins (sim_gpio_port_t *const port, const uint8_t pins)
+{
+    uint32_t commit = 0;
+
+    if ((pins & port->locked_pins) != 0)
+    {
+        commit = *sim_hwreg (port->base + GPIO_O_CR);
+    }
+
+    return pins & (uint8_t) ~(port->locked_pins & ~commit);
+}
+
+
+/**
+ * @brief Update the pin levels after a change, latching interrupts on edges and notifying observers
+ */
+static void update_levels (sim_gpio_port_t *const port)
+{
+    const uint8_t driven = (uint8_t) (port->direction & ~port->alternate);
+    const uint8_t driven_low = (uint8_t) (driven & ~port->data);
+    const uint8_t push_pull_high = (uint8_t) (driven & port->data & ~port->open_drain);
+    const uint8_t undriven = (uint8_t) ~(driven_low | push_pull_high);
+    const uint8_t external_high = (uint8_t) (port->external_driven & port->external_levels);
+    const uint8_t pulled_high = (uint8_t) (port->pull_up & ~port->external_driven);
+    uint8_t levels;
+    uint8_t changed;
+    uint8_t edges;
+
+    levels = (uint8_t) (push_pull_high | (undriven & (external_high | pulled_high)));
+    /* An open-drain output which is released floats high, as the CC3100BOOST has pull-ups on its inputs */
+    levels |= (uint8_t) (driven & port->data & port->open_drain & ~(port->external_driven & ~port->external_levels));
+
+    changed = levels ^ port->levels;
+    port->levels = levels;
+    if (changed == 0)
+    {
+        return;
+    }
+
+    edges = (uint8_t) (changed & (port->int_both_edges | (levels & port->int_rising) |
+                                  (~levels & ~port->int_rising)));
+    port->int_raw |= edges;
+    sim_irq_line (port->interrupt, (port->int_raw & port->int_mask) != 0);
+
+    for (uint32_t index = 0; index < port->num_observations; index++)
+    {
+        if ((changed & port->observations[index].pins) != 0)
+        {
+            port->observations[index].observer (port->observations[index].context, port->base, levels);
+        }
+    }
+}
+
+
+/**
+ * @brief Drive the level of pins from outside the device, as the CC3100BOOST or a push button
+ */
+void sim_gpio_drive (const uint32_t port_base, const uint8_t pins, const bool high)
+{
+    sim_gpio_port_t *const port = find_port (port_base);
+
+    port->external_driven |= pins;
+    if (high)
+    {
+        port->external_levels |= pins;
+    }
+    else
+    {
+        port->external_levels &= (uint8_t) ~pins;
+    }
+    update_levels (port);
+}
+
+
+void sim_gpio_release (const uint32_t port_base, const uint8_t pins)
+{
+    sim_gpio_port_t *const port = find_port (port_base);
+
+    port->external_driven &= (uint8_t) ~pins;
+    update_levels (port);
+}
+
+
+uint8_t sim_gpio_levels (const uint32_t port_base)
+{
+    return find_port (port_base)->levels;
+}
+
+
+void sim_gpio_observe (const uint32_t port_base, const uint8_t pins, sim_gpio_observer_t observer,
+                       void *const context)
+{
+    sim_gpio_port_t *const port = find_port (port_base);
+
+    if (port->num_observations == SIM_GPIO_MAX_OBSERVERS)
+    {
+        sim_fail ("too many observers of GPIO port 0x%x", port_base);
+    }
+    port->observations[port->num_observations].pins = pins;
+    port->observations[port->num_observations].observer = observer;
+    port->observations[port->num_observations].context = context;
+    port->num_observations++;
+}
+
+
+/**
+ * @brief Describe the state of the LaunchPad LEDs on PF1 to PF3, to identify how the firmware failed
+ */
+const char *sim_gpio_led_description (void)
+{
+    static char description[40];
+    const sim_gpio_port_t *const port = find_port (GPIO_PORTF_BASE);
+
+    snprintf (description, sizeof (description), "red=%s blue=%s green=%s",
+              (port->levels & GPIO_PIN_1) ? "on" : "off",
+              (port->levels & GPIO_PIN_2) ? "on" : "off",
+              (port->levels & GPIO_PIN_3) ? "on" : "off");
+
+    return description;
+}
+
+
+/*
+ * driverlib functions
+ */
+
+void GPIOPinConfigure (uint32_t ui32PinConfig)
+{
+    /* The pin mux isn't modelled, only the assignment of pins to peripherals by the GPIOPinType functions */
+    (void) ui32PinConfig;
+    sim_consume (10);
+}
+
+
+static void set_pin_type (const uint32_t port_base, const uint8_t pins, const bool output, const bool open_drain,
+                          const bool alternate, const char *const function)
+{
+    sim_gpio_port_t *const port = access_port (port_base, function);
+    const uint8_t configurable = configurable_pins (port, pins);
+
+    port->direction = output ? (port->direction | configurable) : (uint8_t) (port->direction & ~configurable);
+    port->open_drain = open_drain ? (port->open_drain | configurable) : (uint8_t) (port->open_drain & ~configurable);
+    port->alternate = alternate ? (port->alternate | configurable) : (uint8_t) (port->alternate & ~configurable);
+    port->pull_up &= (uint8_t) ~configurable;
+    update_levels (port);
+}
+
+
+void GPIOPinTypeGPIOInput (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, false, false, false, __func__);
+}
+
+
+void GPIOPinTypeGPIOOutput (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, true, false, false, __func__);
+}
+
+
+void GPIOPinTypeGPIOOutputOD (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, true, true, false, __func__);
+}
+
+
+void GPIOPinTypeUART (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, false, false, true, __func__);
+}
+
+
+void GPIOPinTypeSSI (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, false, false, true, __func__);
+}
+
+
+void GPIOPinTypeUSBAnalog (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    set_pin_type (ui32Port, ui8Pins, false, false, true, __func__);
+}
+
+
+void GPIOPadConfigSet (uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+    const uint8_t configurable = configurable_pins (port, ui8Pins);
+
+    (void) ui32Strength;
+    if (ui32PadType == GPIO_PIN_TYPE_STD_WPU)
+    {
+        port->pull_up |= configurable;
+    }
+    else
+    {
+        port->pull_up &= (uint8_t) ~configurable;
+    }
+    port->open_drain = (ui32PadType == GPIO_PIN_TYPE_OD) ?
+            (port->open_drain | configurable) : (uint8_t) (port->open_drain & ~configurable);
+    update_levels (port);
+}
+
+
+int32_t GPIOPinRead (uint32_t ui32Port, uint8_t ui8Pins)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    return port->levels & ui8Pins;
+}
+
+
+void GPIOPinWrite (uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    port->data = (uint8_t) ((port->data & ~ui8Pins) | (ui8Val & ui8Pins));
+    update_levels (port);
+}
+
+
+void GPIOIntTypeSet (uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    port->int_both_edges = (ui32IntType == GPIO_BOTH_EDGES) ?
+            (port->int_both_edges | ui8Pins) : (uint8_t) (port->int_both_edges & ~ui8Pins);
+    port->int_rising = (ui32IntType == GPIO_RISING_EDGE) ?
+            (port->int_rising | ui8Pins) : (uint8_t) (port->int_rising & ~ui8Pins);
+}
+
+
+void GPIOIntEnable (uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    port->int_mask |= (uint8_t) ui32IntFlags;
+    sim_irq_line (port->interrupt, (port->int_raw & port->int_mask) != 0);
+}
+
+
+void GPIOIntDisable (uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    port->int_mask &= (uint8_t) ~ui32IntFlags;
+    sim_irq_line (port->interrupt, (port->int_raw & port->int_mask) != 0);
+}
+
+
+uint32_t GPIOIntStatus (uint32_t ui32Port, bool bMasked)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    return bMasked ? (port->int_raw & port->int_mask) : port->int_raw;
+}
+
+
+void GPIOIntClear (uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    sim_gpio_port_t *const port = access_port (ui32Port, __func__);
+
+    port->int_raw &= (uint8_t) ~ui32IntFlags;
+    sim_irq_line (port->interrupt, (port->int_raw & port->int_mask) != 0);
+}
@@ -0,0 +1,28 @@
+/*
+ * @file sim_gpio.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 GPIO ports, for the host simulation of the bridge
+ * @details
+ *  The level of each pin is that driven by the firmware when configured as an output, otherwise that driven by
+ *  the test program, otherwise that set by the pad pull-up. The test program acts as the CC3100BOOST and the push
+ *  buttons of the LaunchPad, and may observe changes in the levels of pins driven by the firmware.
+ */
+
+#ifndef SIM_GPIO_H_
+#define SIM_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Called when the level of any of the observed pins of a port changes */
+typedef void (*sim_gpio_observer_t) (void *context, uint32_t port_base, uint8_t levels);
+
+void sim_gpio_drive (const uint32_t port_base, const uint8_t pins, const bool high);
+void sim_gpio_release (const uint32_t port_base, const uint8_t pins);
+uint8_t sim_gpio_levels (const uint32_t port_base);
+void sim_gpio_observe (const uint32_t port_base, const uint8_t pins, sim_gpio_observer_t observer,
+                       void *const context);
+const char *sim_gpio_led_description (void);
+
+#endif /* SIM_GPIO_H_ */
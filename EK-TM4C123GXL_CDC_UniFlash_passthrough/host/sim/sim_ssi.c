@@ -0,0 +1,436 @@
+/*
+ * @file sim_ssi.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 SSI used by the SPI passthrough, and of the SPI slave connected to it, for the host
+ *        simulation
+ */
+
+#include <stdlib.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_ssi.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/ssi.h"
+
+#include "sim.h"
+#include "sim_udma.h"
+#include "sim_ssi.h"
+
+/** The depth of the transmit and receive FIFOs */
+#define SIM_SSI_FIFO_DEPTH 8
+
+/** The FIFO level at which a burst uDMA request is made, which is half the FIFO depth */
+#define SIM_SSI_FIFO_BURST_LEVEL (SIM_SSI_FIFO_DEPTH / 2)
+
+/** The state of one SSI, and the SPI bus connected to it */
+typedef struct
+{
+    uint32_t base;
+    uint32_t peripheral;
+    uint32_t interrupt;
+    uint32_t rx_dma_channel;
+    uint32_t rx_dma_select;
+    uint32_t tx_dma_channel;
+    uint32_t tx_dma_select;
+    bool initialised;
+
+    /* The configuration set by the firmware */
+    bool configured;
+    bool enabled;
+    uint32_t bit_cycles;
+    uint32_t dma_enabled;
+
+    /* The FIFOs */
+    uint8_t rx_fifo[SIM_SSI_FIFO_DEPTH];
+    uint32_t rx_head;
+    uint32_t rx_count;
+    uint8_t tx_fifo[SIM_SSI_FIFO_DEPTH];
+    uint32_t tx_head;
+    uint32_t tx_count;
+
+    /* The character being shifted out */
+    bool shifting;
+    uint8_t tx_character;
+    sim_event_t shift_done;
+
+    uint32_t int_raw;
+    uint32_t int_mask;
+
+    sim_ssi_slave_t slave;
+    sim_ssi_stats_t stats;
+} sim_ssi_t;
+
+static sim_ssi_t ssis[] =
+{
+    {.base = SSI2_BASE, .peripheral = SYSCTL_PERIPH_SSI2, .interrupt = INT_SSI2,
+     .rx_dma_channel = 12, .rx_dma_select = 2, .tx_dma_channel = 13, .tx_dma_select = 2}
+};
+
+#define SIM_SSI_NUM_SSIS (sizeof (ssis) / sizeof (ssis[0]))
+
+static void shift_done_handler (void *context);
+static uint32_t rx_dma_requests (void *context);
+static uint32_t rx_dma_read (void *context);
+static void rx_dma_write (void *context, uint32_t value);
+static uint32_t tx_dma_requests (void *context);
+static uint32_t tx_dma_read (void *context);
+static void tx_dma_write (void *context, uint32_t value);
+
+static sim_udma_peripheral_t rx_dma_peripherals[SIM_SSI_NUM_SSIS];
+static sim_udma_peripheral_t tx_dma_peripherals[SIM_SSI_NUM_SSIS];
+
+
+static sim_ssi_t *find_ssi (const uint32_t ssi_base)
+{
+    for (uint32_t ssi_index = 0; ssi_index < SIM_SSI_NUM_SSIS; ssi_index++)
+    {
+        sim_ssi_t *const ssi = &ssis[ssi_index];
+
+        if (ssi->base == ssi_base)
+        {
+            if (!ssi->initialised)
+            {
+                sim_event_init (&ssi->shift_done, shift_done_handler, ssi);
+
+                rx_dma_peripherals[ssi_index] = (sim_udma_peripheral_t)
+                {
+                    .data_address = ssi->base + SSI_O_DR, .requests = rx_dma_requests,
+                    .read = rx_dma_read, .write = rx_dma_write, .done_interrupt = ssi->interrupt
+                };
+                tx_dma_peripherals[ssi_index] = (sim_udma_peripheral_t)
+                {
+                    .data_address = ssi->base + SSI_O_DR, .requests = tx_dma_requests,
+                    .read = tx_dma_read, .write = tx_dma_write, .done_interrupt = ssi->interrupt
+                };
+                sim_udma_register (ssi->rx_dma_channel, ssi->rx_dma_select, &rx_dma_peripherals[ssi_index], ssi);
+                sim_udma_register (ssi->tx_dma_channel, ssi->tx_dma_select, &tx_dma_peripherals[ssi_index], ssi);
+                ssi->initialised = true;
+            }
+            return ssi;
+        }
+    }
+    sim_fail ("SSI 0x%x isn't modelled", ssi_base);
+}
+
+
+static sim_ssi_t *access_ssi (const uint32_t ssi_base, const char *const function)
+{
+    sim_ssi_t *const ssi = find_ssi (ssi_base);
+
+    sim_consume (8);
+    sim_peripheral_check (ssi->peripheral, function);
+
+    return ssi;
+}
+
+
+static void update_interrupt (sim_ssi_t *const ssi)
+{
+    sim_irq_line (ssi->interrupt, (ssi->int_raw & ssi->int_mask) != 0);
+}
+
+
+static void service_dma (sim_ssi_t *const ssi)
+{
+    if ((ssi->dma_enabled & SSI_DMA_RX) != 0)
+    {
+        sim_udma_service (ssi->rx_dma_channel);
+    }
+    if ((ssi->dma_enabled & SSI_DMA_TX) != 0)
+    {
+        sim_udma_service (ssi->tx_dma_channel);
+    }
+}
+
+
+/**
+ * @brief Start shifting out the next character from the transmit FIFO, if not already shifting
+ */
+static void shift_start (sim_ssi_t *const ssi)
+{
+    const uint32_t character_cycles = 8 * ssi->bit_cycles;
+
+    if (!ssi->enabled || ssi->shifting || (ssi->tx_count == 0))
+    {
+        return;
+    }
+
+    ssi->tx_character = ssi->tx_fifo[ssi->tx_head];
+    ssi->tx_head = (ssi->tx_head + 1) % SIM_SSI_FIFO_DEPTH;
+    ssi->tx_count--;
+    ssi->shifting = true;
+    ssi->stats.busy_cycles += character_cycles;
+    sim_event_schedule (&ssi->shift_done, sim_now + character_cycles);
+    service_dma (ssi);
+}
+
+
+/**
+ * @brief Exchange the character shifted out with the slave, and place the character shifted in in the receive FIFO
+ */
+static void shift_done_handler (void *context)
+{
+    sim_ssi_t *const ssi = context;
+    const uint8_t miso = (ssi->slave.exchange != NULL) ?
+            ssi->slave.exchange (ssi->slave.context, ssi->tx_character) : 0xff;
+
+    ssi->shifting = false;
+    ssi->stats.characters++;
+    if (ssi->rx_count == SIM_SSI_FIFO_DEPTH)
+    {
+        ssi->stats.rx_overruns++;
+        ssi->int_raw |= SSI_RXOR;
+    }
+    else
+    {
+        ssi->rx_fifo[(ssi->rx_head + ssi->rx_count) % SIM_SSI_FIFO_DEPTH] = miso;
+        ssi->rx_count++;
+    }
+    if (ssi->rx_count >= SIM_SSI_FIFO_BURST_LEVEL)
+    {
+        ssi->int_raw |= SSI_RXFF;
+    }
+    update_interrupt (ssi);
+    service_dma (ssi);
+    shift_start (ssi);
+}
+
+
+static bool tx_push (sim_ssi_t *const ssi, const uint8_t character)
+{
+    if (ssi->tx_count == SIM_SSI_FIFO_DEPTH)
+    {
+        return false;
+    }
+
+    ssi->tx_fifo[(ssi->tx_head + ssi->tx_count) % SIM_SSI_FIFO_DEPTH] = character;
+    ssi->tx_count++;
+    shift_start (ssi);
+
+    return true;
+}
+
+
+/**
+ * @brief Remove a character from the receive FIFO
+ * @return The character, or -1 if the FIFO is empty
+ */
+static int32_t rx_pop (sim_ssi_t *const ssi)
+{
+    uint8_t character;
+
+    if (ssi->rx_count == 0)
+    {
+        return -1;
+    }
+
+    character = ssi->rx_fifo[ssi->rx_head];
+    ssi->rx_head = (ssi->rx_head + 1) % SIM_SSI_FIFO_DEPTH;
+    ssi->rx_count--;
+    if (ssi->rx_count < SIM_SSI_FIFO_BURST_LEVEL)
+    {
+        ssi->int_raw &= ~SSI_RXFF;
+        update_interrupt (ssi);
+    }
+
+    return character;
+}
+
+
+/**
+ * @brief Attach a SPI slave to a SSI, which exchanges a character for each character shifted out by the SSI
+ */
+void sim_ssi_attach (const uint32_t ssi_base, const sim_ssi_slave_t *const slave)
+{
+    find_ssi (ssi_base)->slave = *slave;
+}
+
+
+const sim_ssi_stats_t *sim_ssi_stats (const uint32_t ssi_base)
+{
+    return &find_ssi (ssi_base)->stats;
+}
+
+
+void sim_ssi_stats_clear (const uint32_t ssi_base)
+{
+    find_ssi (ssi_base)->stats = (sim_ssi_stats_t) {0};
+}
+
+
+/*
+ * uDMA requests
+ */
+
+static uint32_t rx_dma_requests (void *context)
+{
+    const sim_ssi_t *const ssi = context;
+    uint32_t requests = 0;
+
+    if ((ssi->dma_enabled & SSI_DMA_RX) != 0)
+    {
+        requests |= (ssi->rx_count > 0) ? SIM_UDMA_REQUEST_SINGLE : 0;
+        requests |= (ssi->rx_count >= SIM_SSI_FIFO_BURST_LEVEL) ? SIM_UDMA_REQUEST_BURST : 0;
+    }
+
+    return requests;
+}
+
+
+static uint32_t rx_dma_read (void *context)
+{
+    const int32_t value = rx_pop (context);
+
+    if (value < 0)
+    {
+        sim_fail ("uDMA read from an empty SSI receive FIFO");
+    }
+
+    return (uint32_t) value;
+}
+
+
+static void rx_dma_write (void *context, uint32_t value)
+{
+    (void) context;
+    (void) value;
+    sim_fail ("uDMA wrote to a SSI data register from the receive channel");
+}
+
+
+static uint32_t tx_dma_requests (void *context)
+{
+    const sim_ssi_t *const ssi = context;
+    uint32_t requests = 0;
+
+    if ((ssi->dma_enabled & SSI_DMA_TX) != 0)
+    {
+        requests |= (ssi->tx_count < SIM_SSI_FIFO_DEPTH) ? SIM_UDMA_REQUEST_SINGLE : 0;
+        requests |= (ssi->tx_count <= SIM_SSI_FIFO_BURST_LEVEL) ? SIM_UDMA_REQUEST_BURST : 0;
+    }
+
+    return requests;
+}
+
+
+static uint32_t tx_dma_read (void *context)
+{
+    (void) context;
+    sim_fail ("uDMA read from a SSI data register from the transmit channel");
+}
+
+
+static void tx_dma_write (void *context, uint32_t value)
+{
+    if (!tx_push (context, (uint8_t) value))
+    {
+        sim_fail ("uDMA wrote to a full SSI transmit FIFO");
+    }
+}
+
+
+/*
+ * driverlib functions
+ */
+
+void SSIConfigSetExpClk (uint32_t ui32Base, uint32_t ui32SSIClk, uint32_t ui32Protocol, uint32_t ui32Mode,
+                         uint32_t ui32BitRate, uint32_t ui32DataWidth)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+    uint32_t max_bit_rate;
+    uint32_t prescale;
+    uint32_t serial_clock_rate;
+
+    if (ssi->enabled)
+    {
+        sim_fail ("SSI 0x%x configured while enabled", ui32Base);
+    }
+    if ((ui32Protocol != SSI_FRF_MOTO_MODE_0) || (ui32Mode != SSI_MODE_MASTER) || (ui32DataWidth != 8))
+    {
+        sim_fail ("SSI 0x%x configured with an unmodelled protocol %u, mode %u or data width %u", ui32Base,
+                  ui32Protocol, ui32Mode, ui32DataWidth);
+    }
+    if ((ui32BitRate == 0) || ((ui32BitRate * 2) > ui32SSIClk))
+    {
+        sim_fail ("SSI bit rate %u is out of range for a master", ui32BitRate);
+    }
+
+    /* The same search for the clock prescale divisor and serial clock rate as driverlib */
+    max_bit_rate = ui32SSIClk / ui32BitRate;
+    prescale = 0;
+    do
+    {
+        prescale += 2;
+        serial_clock_rate = (max_bit_rate / prescale) - 1;
+    } while (serial_clock_rate > 255);
+
+    ssi->bit_cycles = prescale * (1 + serial_clock_rate);
+    ssi->configured = true;
+}
+
+
+void SSIEnable (uint32_t ui32Base)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+
+    if (!ssi->configured)
+    {
+        sim_fail ("SSI 0x%x enabled before being configured", ui32Base);
+    }
+    ssi->enabled = true;
+    shift_start (ssi);
+}
+
+
+void SSIDisable (uint32_t ui32Base)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+
+    ssi->enabled = false;
+}
+
+
+int32_t SSIDataGetNonBlocking (uint32_t ui32Base, uint32_t *pui32Data)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+    const int32_t value = rx_pop (ssi);
+
+    if (value < 0)
+    {
+        return 0;
+    }
+
+    *pui32Data = (uint32_t) value;
+    service_dma (ssi);
+
+    return 1;
+}
+
+
+void SSIDMAEnable (uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+
+    ssi->dma_enabled |= ui32DMAFlags & (SSI_DMA_RX | SSI_DMA_TX);
+    service_dma (ssi);
+}
+
+
+uint32_t SSIIntStatus (uint32_t ui32Base, bool bMasked)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+
+    return bMasked ? (ssi->int_raw & ssi->int_mask) : ssi->int_raw;
+}
+
+
+void SSIIntClear (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_ssi_t *const ssi = access_ssi (ui32Base, __func__);
+
+    /* Only the receive overrun and timeout interrupts are latched; the FIFO interrupts follow the FIFO levels */
+    ssi->int_raw &= ~(ui32IntFlags & (SSI_RXOR | SSI_RXTO));
+    update_interrupt (ssi);
+}
@@ -0,0 +1,45 @@
+/*
+ * @file sim_ssi.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 SSI used by the SPI passthrough, and of the SPI slave connected to it, for the host
+ *        simulation
+ * @details
+ *  The SSI is a SPI master with 8 entry transmit and receive FIFOs, and the uDMA requests of the hardware. Each
+ *  character written to the transmit FIFO takes the time given by the bit rate to be shifted out, during which the
+ *  slave shifts a character in, which is placed in the receive FIFO. When the receive FIFO is full the received
+ *  character is lost, and the receive overrun is flagged.
+ *
+ *  The chip select is a GPIO driven by the firmware, which the slave may observe with sim_gpio_observe().
+ */
+
+#ifndef SIM_SSI_H_
+#define SIM_SSI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** The callbacks to the SPI slave connected to a SSI */
+typedef struct
+{
+    /** Called when a character has been shifted out by the SSI, returning the character shifted in from the slave */
+    uint8_t (*exchange) (void *context, uint8_t mosi);
+    void *context;
+} sim_ssi_slave_t;
+
+/** Statistics of the SPI bus connected to a SSI */
+typedef struct
+{
+    /** Characters exchanged with the slave */
+    uint64_t characters;
+    /** Characters received from the slave which were lost as the receive FIFO was full */
+    uint64_t rx_overruns;
+    /** The cycles during which the SSI was shifting */
+    uint64_t busy_cycles;
+} sim_ssi_stats_t;
+
+void sim_ssi_attach (const uint32_t ssi_base, const sim_ssi_slave_t *const slave);
+const sim_ssi_stats_t *sim_ssi_stats (const uint32_t ssi_base);
+void sim_ssi_stats_clear (const uint32_t ssi_base);
+
+#endif /* SIM_SSI_H_ */
@@ -0,0 +1,286 @@
+/*
+ * @file sim_system.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Models of the TM4C123 system control, NVIC driverlib functions, CPU, FPU and flash controller
+ */
+
+#include <string.h>
+
+#include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/cpu.h"
+#include "driverlib/fpu.h"
+#include "driverlib/flash.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+
+#include "sim.h"
+
+/** The cycles taken by a flash erase of one block, and to program one word */
+#define SIM_FLASH_ERASE_CYCLES   SIM_MS (10)
+#define SIM_FLASH_PROGRAM_CYCLES SIM_US (30)
+
+/** The size of a flash erase block */
+#define SIM_FLASH_ERASE_SIZE 1024
+
+/** The maximum number of peripherals which can be enabled */
+#define SIM_MAX_PERIPHERALS 32
+
+static uint32_t enabled_peripherals[SIM_MAX_PERIPHERALS];
+static uint32_t num_enabled_peripherals;
+static bool clock_set;
+
+/** The values returned by FlashUserGet(), which default to unprogrammed */
+static uint32_t flash_user_registers[2] = {0xFFFFFFFF, 0xFFFFFFFF};
+
+
+/**
+ * @brief Check that the clock to a peripheral has been enabled, before the firmware accesses it
+ */
+void sim_peripheral_check (const uint32_t peripheral, const char *const function)
+{
+    for (uint32_t index = 0; index < num_enabled_peripherals; index++)
+    {
+        if (enabled_peripherals[index] == peripheral)
+        {
+            return;
+        }
+    }
+    sim_fail ("%s() accessed peripheral 0x%x before its clock was enabled", function, peripheral);
+}
+
+
+/**
+ * @brief Set the values of the flash user registers, used to set the USB serial number
+ * @details Must be called before the firmware is started.
+ */
+void sim_flash_user_set (const uint32_t user0, const uint32_t user1)
+{
+    flash_user_registers[0] = user0;
+    flash_user_registers[1] = user1;
+}
+
+
+void SysCtlClockSet (uint32_t ui32Config)
+{
+    sim_consume (100);
+    if (ui32Config != (SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN))
+    {
+        sim_fail ("only the 80 MHz PLL clock configuration is modelled");
+    }
+    clock_set = true;
+}
+
+
+uint32_t SysCtlClockGet (void)
+{
+    sim_consume (20);
+
+    /* Before the PLL is selected the CPU runs from the precision internal oscillator */
+    return clock_set ? SIM_CPU_HZ : 16000000;
+}
+
+
+/**
+ * @brief Delay for 3 CPU cycles per count, as the loop in TivaWare takes
+ */
+void SysCtlDelay (uint32_t ui32Count)
+{
+    sim_consume (3 * ui32Count);
+}
+
+
+void SysCtlPeripheralEnable (uint32_t ui32Peripheral)
+{
+    sim_consume (10);
+    for (uint32_t index = 0; index < num_enabled_peripherals; index++)
+    {
+        if (enabled_peripherals[index] == ui32Peripheral)
+        {
+            return;
+        }
+    }
+    if (num_enabled_peripherals == SIM_MAX_PERIPHERALS)
+    {
+        sim_fail ("too many peripherals enabled");
+    }
+    enabled_peripherals[num_enabled_peripherals] = ui32Peripheral;
+    num_enabled_peripherals++;
+}
+
+
+bool SysCtlPeripheralReady (uint32_t ui32Peripheral)
+{
+    sim_consume (10);
+    for (uint32_t index = 0; index < num_enabled_peripherals; index++)
+    {
+        if (enabled_peripherals[index] == ui32Peripheral)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void SysCtlPeripheralSleepEnable (uint32_t ui32Peripheral)
+{
+    (void) ui32Peripheral;
+    sim_consume (10);
+}
+
+
+void SysCtlPeripheralDeepSleepEnable (uint32_t ui32Peripheral)
+{
+    (void) ui32Peripheral;
+    sim_consume (10);
+}
+
+
+void SysCtlPeripheralClockGating (bool bEnable)
+{
+    (void) bEnable;
+    sim_consume (10);
+}
+
+
+void SysCtlDeepSleepClockSet (uint32_t ui32Config)
+{
+    (void) ui32Config;
+    sim_consume (10);
+}
+
+
+void SysCtlDeepSleep (void)
+{
+    sim_consume (10);
+    sim_sleep (true);
+}
+
+
+void CPUwfi (void)
+{
+    sim_consume (2);
+    sim_sleep (false);
+}
+
+
+void FPULazyStackingEnable (void)
+{
+    sim_consume (5);
+}
+
+
+/*
+ * NVIC
+ */
+
+bool IntMasterEnable (void)
+{
+    sim_consume (1);
+    return sim_primask_set (false);
+}
+
+
+bool IntMasterDisable (void)
+{
+    sim_consume (1);
+    return sim_primask_set (true);
+}
+
+
+void IntEnable (uint32_t ui32Interrupt)
+{
+    sim_irq_enable (ui32Interrupt, true);
+    sim_consume (5);
+}
+
+
+void IntDisable (uint32_t ui32Interrupt)
+{
+    sim_consume (5);
+    sim_irq_enable (ui32Interrupt, false);
+}
+
+
+void IntPendSet (uint32_t ui32Interrupt)
+{
+    sim_irq_pend (ui32Interrupt);
+    sim_consume (5);
+}
+
+
+void IntPendClear (uint32_t ui32Interrupt)
+{
+    sim_consume (5);
+    sim_irq_unpend (ui32Interrupt);
+}
+
+
+void IntPrioritySet (uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    sim_irq_priority_set (ui32Interrupt, ui8Priority);
+    sim_consume (5);
+}
+
+
+int32_t IntPriorityGet (uint32_t ui32Interrupt)
+{
+    sim_consume (5);
+    return sim_irq_priority_get (ui32Interrupt);
+}
+
+
+/*
+ * Flash
+ */
+
+int32_t FlashErase (uint32_t ui32Address)
+{
+    if ((ui32Address % SIM_FLASH_ERASE_SIZE) != 0)
+    {
+        sim_consume (10);
+        return -1;
+    }
+
+    memset (sim_flash (ui32Address, SIM_FLASH_ERASE_SIZE), 0xFF, SIM_FLASH_ERASE_SIZE);
+    sim_consume (SIM_FLASH_ERASE_CYCLES);
+
+    return 0;
+}
+
+
+/**
+ * @brief Program words of flash, which can only clear bits
+ */
+int32_t FlashProgram (uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t *words;
+
+    if (((ui32Address % 4) != 0) || ((ui32Count % 4) != 0))
+    {
+        sim_consume (10);
+        return -1;
+    }
+
+    words = (uint32_t *) sim_flash (ui32Address, ui32Count);
+    for (uint32_t index = 0; index < (ui32Count / 4); index++)
+    {
+        words[index] &= pui32Data[index];
+    }
+    sim_consume ((ui32Count / 4) * SIM_FLASH_PROGRAM_CYCLES);
+
+    return 0;
+}
+
+
+int32_t FlashUserGet (uint32_t *pui32User0, uint32_t *pui32User1)
+{
+    sim_consume (10);
+    *pui32User0 = flash_user_registers[0];
+    *pui32User1 = flash_user_registers[1];
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * @file sim_timer.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 general purpose timers used by the bridge, for the host simulation
+ * @details Only one-shot down counting and periodic up counting modes are modelled, which are those used.
+ */
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+
+#include "sim.h"
+
+/** The state of one subtimer, or of the concatenated timer when not split */
+typedef struct
+{
+    /** The TIMER_CFG_ mode field for this subtimer */
+    uint32_t mode;
+    /** The interval load value */
+    uint64_t load;
+    bool enabled;
+    /** When the counter was enabled, for up counting */
+    sim_time_t start;
+    /** The timeout of a one-shot timer */
+    sim_event_t timeout;
+    uint32_t timeout_flag;
+    struct sim_timer_s *timer;
+} sim_subtimer_t;
+
+/** The state of one timer module */
+typedef struct sim_timer_s
+{
+    uint32_t base;
+    uint32_t peripheral;
+    uint32_t interrupts[2];
+    bool split;
+    sim_subtimer_t subtimers[2];
+    uint32_t int_raw;
+    uint32_t int_mask;
+} sim_timer_t;
+
+static sim_timer_t timers[] =
+{
+    {.base = TIMER0_BASE, .peripheral = SYSCTL_PERIPH_TIMER0, .interrupts = {INT_TIMER0A, INT_TIMER0B}},
+    {.base = TIMER1_BASE, .peripheral = SYSCTL_PERIPH_TIMER1, .interrupts = {INT_TIMER1A, INT_TIMER1B}},
+    {.base = TIMER2_BASE, .peripheral = SYSCTL_PERIPH_TIMER2, .interrupts = {INT_TIMER2A, INT_TIMER2B}},
+    {.base = TIMER3_BASE, .peripheral = SYSCTL_PERIPH_TIMER3, .interrupts = {INT_TIMER3A, INT_TIMER3B}},
+    {.base = WTIMER0_BASE, .peripheral = SYSCTL_PERIPH_WTIMER0, .interrupts = {INT_WTIMER0A, INT_WTIMER0B}},
+    {.base = WTIMER1_BASE, .peripheral = SYSCTL_PERIPH_WTIMER1, .interrupts = {INT_WTIMER1A, INT_WTIMER1B}}
+};
+
+#define SIM_NUM_TIMERS (sizeof (timers) / sizeof (timers[0]))
+
+/** The interrupt status bits of each subtimer */
+#define SIM_TIMER_A_INTS 0x000000FF
+#define SIM_TIMER_B_INTS 0x0000FF00
+
+
+static void update_interrupts (sim_timer_t *const timer)
+{
+    const uint32_t active = timer->int_raw & timer->int_mask;
+
+    sim_irq_line (timer->interrupts[0], (active & SIM_TIMER_A_INTS) != 0);
+    sim_irq_line (timer->interrupts[1], (active & SIM_TIMER_B_INTS) != 0);
+}
+
+
+static void subtimer_timeout (void *context)
+{
+    sim_subtimer_t *const subtimer = context;
+
+    subtimer->enabled = false;
+    subtimer->timer->int_raw |= subtimer->timeout_flag;
+    update_interrupts (subtimer->timer);
+}
+
+
+static sim_timer_t *access_timer (const uint32_t base, const char *const function)
+{
+    sim_consume (10);
+    for (uint32_t timer_index = 0; timer_index < SIM_NUM_TIMERS; timer_index++)
+    {
+        sim_timer_t *const timer = &timers[timer_index];
+
+        if (timer->base == base)
+        {
+            sim_peripheral_check (timer->peripheral, function);
+            if (timer->subtimers[0].timer == NULL)
+            {
+                for (uint32_t sub_index = 0; sub_index < 2; sub_index++)
+                {
+                    timer->subtimers[sub_index].timer = timer;
+                    timer->subtimers[sub_index].timeout_flag = (sub_index == 0) ?
+                            TIMER_TIMA_TIMEOUT : TIMER_TIMB_TIMEOUT;
+                    sim_event_init (&timer->subtimers[sub_index].timeout, subtimer_timeout,
+                                    &timer->subtimers[sub_index]);
+                }
+            }
+            return timer;
+        }
+    }
+    sim_fail ("%s() on timer 0x%x which isn't modelled", function, base);
+}
+
+
+void TimerConfigure (uint32_t ui32Base, uint32_t ui32Config)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    for (uint32_t sub_index = 0; sub_index < 2; sub_index++)
+    {
+        timer->subtimers[sub_index].enabled = false;
+        sim_event_cancel (&timer->subtimers[sub_index].timeout);
+    }
+    timer->split = (ui32Config & TIMER_CFG_SPLIT_PAIR) != 0;
+    timer->subtimers[0].mode = ui32Config & 0xFF;
+    timer->subtimers[1].mode = (ui32Config >> 8) & 0xFF;
+    if (!timer->split && (timer->subtimers[0].mode != (TIMER_CFG_ONE_SHOT & 0xFF)) &&
+        (timer->subtimers[0].mode != (TIMER_CFG_PERIODIC_UP & 0xFF)))
+    {
+        sim_fail ("timer 0x%x configured in an unmodelled mode 0x%x", ui32Base, ui32Config);
+    }
+}
+
+
+void TimerLoadSet (uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    if (ui32Timer & TIMER_A)
+    {
+        timer->subtimers[0].load = ui32Value;
+    }
+    if (ui32Timer & TIMER_B)
+    {
+        timer->subtimers[1].load = ui32Value;
+    }
+}
+
+
+void TimerLoadSet64 (uint32_t ui32Base, uint64_t ui64Value)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    timer->subtimers[0].load = ui64Value;
+}
+
+
+static void subtimer_enable (sim_subtimer_t *const subtimer)
+{
+    if (subtimer->enabled)
+    {
+        return;
+    }
+    subtimer->enabled = true;
+    subtimer->start = sim_now;
+    if (subtimer->mode == (TIMER_CFG_ONE_SHOT & 0xFF))
+    {
+        sim_event_schedule (&subtimer->timeout, sim_now + subtimer->load);
+    }
+}
+
+
+static void subtimer_disable (sim_subtimer_t *const subtimer)
+{
+    subtimer->enabled = false;
+    sim_event_cancel (&subtimer->timeout);
+}
+
+
+void TimerEnable (uint32_t ui32Base, uint32_t ui32Timer)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    if (ui32Timer & TIMER_A)
+    {
+        subtimer_enable (&timer->subtimers[0]);
+    }
+    if ((ui32Timer & TIMER_B) && timer->split)
+    {
+        subtimer_enable (&timer->subtimers[1]);
+    }
+}
+
+
+void TimerDisable (uint32_t ui32Base, uint32_t ui32Timer)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    if (ui32Timer & TIMER_A)
+    {
+        subtimer_disable (&timer->subtimers[0]);
+    }
+    if (ui32Timer & TIMER_B)
+    {
+        subtimer_disable (&timer->subtimers[1]);
+    }
+}
+
+
+static uint64_t subtimer_value (const sim_subtimer_t *const subtimer)
+{
+    if (subtimer->mode == (TIMER_CFG_PERIODIC_UP & 0xFF))
+    {
+        const uint64_t elapsed = subtimer->enabled ? (sim_now - subtimer->start) : 0;
+
+        return (subtimer->load == UINT64_MAX) ? elapsed : (elapsed % (subtimer->load + 1));
+    }
+    else
+    {
+        return sim_event_scheduled (&subtimer->timeout) ? (subtimer->timeout.when - sim_now) : subtimer->load;
+    }
+}
+
+
+uint32_t TimerValueGet (uint32_t ui32Base, uint32_t ui32Timer)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    return (uint32_t) subtimer_value (&timer->subtimers[(ui32Timer == TIMER_B) ? 1 : 0]);
+}
+
+
+uint64_t TimerValueGet64 (uint32_t ui32Base)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    return subtimer_value (&timer->subtimers[0]);
+}
+
+
+void TimerIntEnable (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    timer->int_mask |= ui32IntFlags;
+    update_interrupts (timer);
+}
+
+
+void TimerIntDisable (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    timer->int_mask &= ~ui32IntFlags;
+    update_interrupts (timer);
+}
+
+
+uint32_t TimerIntStatus (uint32_t ui32Base, bool bMasked)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    return bMasked ? (timer->int_raw & timer->int_mask) : timer->int_raw;
+}
+
+
+void TimerIntClear (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_timer_t *const timer = access_timer (ui32Base, __func__);
+
+    timer->int_raw &= ~ui32IntFlags;
+    update_interrupts (timer);
+}
@@ -0,0 +1,984 @@
+/*
+ * @file sim_uart.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 UARTs used by the bridge, and of the serial line to a peer, for the host simulation
+ */
+
+#include <stdlib.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_uart.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+
+#include "sim.h"
+#include "sim_udma.h"
+#include "sim_uart.h"
+
+/** The depth of the transmit and receive FIFOs */
+#define SIM_UART_FIFO_DEPTH 16
+
+/** The number of bit times without a character being received which causes a receive timeout */
+#define SIM_UART_RX_TIMEOUT_BITS 32
+
+/** The maximum difference between the baud rates of the UART and peer before characters are corrupted, as a
+ *  fraction of the baud rate in parts per thousand */
+#define SIM_UART_BAUD_TOLERANCE_PPT 25
+
+/** The bits of the line control register set by the configuration */
+#define SIM_UART_CONFIG_MASK (UART_CONFIG_WLEN_MASK | UART_CONFIG_STOP_MASK | UART_CONFIG_PAR_MASK)
+
+/* The kinds of item queued by the peer */
+#define SIM_UART_PEER_CHARACTER 0
+#define SIM_UART_PEER_BREAK     1
+
+/** An item queued to be sent by the peer */
+typedef struct
+{
+    uint8_t kind;
+    uint8_t character;
+    /** UART_DR_ flags for a character injected with an error */
+    uint16_t dr_errors;
+    /** The duration of a break */
+    uint32_t duration_us;
+} sim_uart_peer_item_t;
+
+/** The state of one UART, and the serial line connected to it */
+typedef struct
+{
+    uint32_t base;
+    uint32_t peripheral;
+    uint32_t interrupt;
+    uint32_t rx_dma_channel;
+    uint32_t rx_dma_select;
+    uint32_t tx_dma_channel;
+    uint32_t tx_dma_select;
+    bool initialised;
+
+    /* The configuration set by the firmware */
+    bool enabled;
+    uint32_t divisor;
+    /** Set when the baud clock is divided by 8 rather than 16, for baud rates above the UART clock / 16 */
+    bool high_speed;
+    uint32_t config;
+    uint32_t tx_trigger;
+    uint32_t rx_trigger;
+    bool tx_eot_mode;
+    uint32_t dma_enabled;
+    uint32_t flow_control;
+    bool rts_software;
+    bool breaking;
+
+    /* The FIFOs, with the receive FIFO holding the character and the UART_DR_ error flags */
+    uint16_t rx_fifo[SIM_UART_FIFO_DEPTH];
+    uint32_t rx_head;
+    uint32_t rx_count;
+    bool overrun_pending;
+    uint8_t tx_fifo[SIM_UART_FIFO_DEPTH];
+    uint32_t tx_head;
+    uint32_t tx_count;
+
+    /* The character being shifted out by the transmitter */
+    bool tx_shifting;
+    uint8_t tx_character;
+    bool tx_garbled;
+    sim_event_t tx_done;
+
+    sim_event_t rx_timeout;
+    uint32_t int_raw;
+    uint32_t int_mask;
+
+    /* The peer */
+    sim_uart_peer_t peer;
+    uint32_t peer_baud;
+    uint32_t peer_config;
+    bool peer_flow_control;
+    bool peer_rts;
+    sim_queue_t peer_queue;
+    bool peer_sending;
+    sim_uart_peer_item_t peer_item;
+    sim_event_t peer_done;
+    bool peer_throttled;
+    sim_time_t peer_throttle_start;
+
+    sim_uart_stats_t stats;
+} sim_uart_t;
+
+static sim_uart_t uarts[] =
+{
+    {.base = UART1_BASE, .peripheral = SYSCTL_PERIPH_UART1, .interrupt = INT_UART1,
+     .rx_dma_channel = 22, .rx_dma_select = 0, .tx_dma_channel = 23, .tx_dma_select = 0},
+    {.base = UART2_BASE, .peripheral = SYSCTL_PERIPH_UART2, .interrupt = INT_UART2,
+     .rx_dma_channel = 0, .rx_dma_select = 1, .tx_dma_channel = 1, .tx_dma_select = 1},
+    {.base = UART3_BASE, .peripheral = SYSCTL_PERIPH_UART3, .interrupt = INT_UART3,
+     .rx_dma_channel = 16, .rx_dma_select = 2, .tx_dma_channel = 17, .tx_dma_select = 2}
+};
+
+#define SIM_UART_NUM_UARTS (sizeof (uarts) / sizeof (uarts[0]))
+
+static void tx_done_handler (void *context);
+static void rx_timeout_handler (void *context);
+static void peer_done_handler (void *context);
+static uint32_t rx_dma_requests (void *context);
+static uint32_t rx_dma_read (void *context);
+static void rx_dma_write (void *context, uint32_t value);
+static uint32_t tx_dma_requests (void *context);
+static uint32_t tx_dma_read (void *context);
+static void tx_dma_write (void *context, uint32_t value);
+
+static sim_udma_peripheral_t rx_dma_peripherals[SIM_UART_NUM_UARTS];
+static sim_udma_peripheral_t tx_dma_peripherals[SIM_UART_NUM_UARTS];
+
+
+static sim_uart_t *find_uart (const uint32_t uart_base)
+{
+    for (uint32_t uart_index = 0; uart_index < SIM_UART_NUM_UARTS; uart_index++)
+    {
+        sim_uart_t *const uart = &uarts[uart_index];
+
+        if (uart->base == uart_base)
+        {
+            if (!uart->initialised)
+            {
+                sim_event_init (&uart->tx_done, tx_done_handler, uart);
+                sim_event_init (&uart->rx_timeout, rx_timeout_handler, uart);
+                sim_event_init (&uart->peer_done, peer_done_handler, uart);
+                uart->peer_baud = 115200;
+                uart->peer_config = UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE;
+                uart->peer_rts = true;
+                uart->tx_trigger = 8;
+                uart->rx_trigger = 8;
+
+                rx_dma_peripherals[uart_index] = (sim_udma_peripheral_t)
+                {
+                    .data_address = uart->base + UART_O_DR, .requests = rx_dma_requests,
+                    .read = rx_dma_read, .write = rx_dma_write, .done_interrupt = uart->interrupt
+                };
+                tx_dma_peripherals[uart_index] = (sim_udma_peripheral_t)
+                {
+                    .data_address = uart->base + UART_O_DR, .requests = tx_dma_requests,
+                    .read = tx_dma_read, .write = tx_dma_write, .done_interrupt = uart->interrupt
+                };
+                sim_udma_register (uart->rx_dma_channel, uart->rx_dma_select, &rx_dma_peripherals[uart_index],
+                                   uart);
+                sim_udma_register (uart->tx_dma_channel, uart->tx_dma_select, &tx_dma_peripherals[uart_index],
+                                   uart);
+                uart->initialised = true;
+            }
+            return uart;
+        }
+    }
+    sim_fail ("UART 0x%x isn't modelled", uart_base);
+}
+
+
+static sim_uart_t *access_uart (const uint32_t uart_base, const char *const function)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+
+    sim_consume (8);
+    sim_peripheral_check (uart->peripheral, function);
+
+    return uart;
+}
+
+
+/**
+ * @brief The number of bits in a character, including the start, parity and stop bits
+ */
+static uint32_t character_bits (const uint32_t config)
+{
+    uint32_t num_bits = 1 + 5 + ((config & UART_CONFIG_WLEN_MASK) >> 5) + 1;
+
+    if ((config & UART_CONFIG_PAR_MASK) != UART_CONFIG_PAR_NONE)
+    {
+        num_bits++;
+    }
+    if ((config & UART_CONFIG_STOP_MASK) == UART_CONFIG_STOP_TWO)
+    {
+        num_bits++;
+    }
+
+    return num_bits;
+}
+
+
+/**
+ * @brief The number of CPU cycles per bit at the UART, in 1/64ths of a cycle, from the fractional baud divisor
+ */
+static uint64_t uart_bit_cycles_64 (const sim_uart_t *const uart)
+{
+    return (uint64_t) uart->divisor * (uart->high_speed ? 8 : 16);
+}
+
+
+static uint32_t uart_character_cycles (const sim_uart_t *const uart)
+{
+    return (uint32_t) ((character_bits (uart->config) * uart_bit_cycles_64 (uart) + 32) / 64);
+}
+
+
+static uint32_t peer_character_cycles (const sim_uart_t *const uart)
+{
+    return (uint32_t) (((uint64_t) character_bits (uart->peer_config) * SIM_CPU_HZ + (uart->peer_baud / 2)) /
+                       uart->peer_baud);
+}
+
+
+/**
+ * @brief Determine if the line settings of the UART and peer are compatible
+ */
+static bool line_settings_match (const sim_uart_t *const uart)
+{
+    const uint64_t uart_baud = ((uart->high_speed ? 8ull : 4ull) * SIM_CPU_HZ) / uart->divisor;
+    const uint64_t difference = (uart_baud > uart->peer_baud) ?
+            (uart_baud - uart->peer_baud) : (uart->peer_baud - uart_baud);
+
+    return (uart->divisor > 0) && ((uart->config & SIM_UART_CONFIG_MASK) == uart->peer_config) &&
+            ((difference * 1000) <= ((uint64_t) uart->peer_baud * SIM_UART_BAUD_TOLERANCE_PPT));
+}
+
+
+static void update_interrupt (sim_uart_t *const uart)
+{
+    sim_irq_line (uart->interrupt, (uart->int_raw & uart->int_mask) != 0);
+}
+
+
+/**
+ * @brief The state of the RTS output, which when asserted allows the peer to send
+ */
+static bool rts_asserted (const sim_uart_t *const uart)
+{
+    if ((uart->flow_control & UART_FLOWCONTROL_RX) != 0)
+    {
+        return uart->rx_count < uart->rx_trigger;
+    }
+
+    return uart->rts_software;
+}
+
+
+static void service_dma (sim_uart_t *const uart)
+{
+    if ((uart->dma_enabled & UART_DMA_RX) != 0)
+    {
+        sim_udma_service (uart->rx_dma_channel);
+    }
+    if ((uart->dma_enabled & UART_DMA_TX) != 0)
+    {
+        sim_udma_service (uart->tx_dma_channel);
+    }
+}
+
+
+/*
+ * Transmitter
+ */
+
+static void tx_start (sim_uart_t *const uart)
+{
+    const uint32_t previous_count = uart->tx_count;
+
+    if (!uart->enabled || uart->tx_shifting || uart->breaking || (uart->tx_count == 0))
+    {
+        return;
+    }
+    if (((uart->flow_control & UART_FLOWCONTROL_TX) != 0) && !uart->peer_rts)
+    {
+        return;
+    }
+
+    uart->tx_character = uart->tx_fifo[uart->tx_head];
+    uart->tx_garbled = !line_settings_match (uart);
+    uart->tx_head = (uart->tx_head + 1) % SIM_UART_FIFO_DEPTH;
+    uart->tx_count--;
+    uart->tx_shifting = true;
+    uart->stats.tx_busy_cycles += uart_character_cycles (uart);
+    sim_event_schedule (&uart->tx_done, sim_now + uart_character_cycles (uart));
+
+    if (!uart->tx_eot_mode && (previous_count > uart->tx_trigger) && (uart->tx_count <= uart->tx_trigger))
+    {
+        uart->int_raw |= UART_INT_TX;
+        update_interrupt (uart);
+    }
+    service_dma (uart);
+}
+
+
+static void tx_done_handler (void *context)
+{
+    sim_uart_t *const uart = context;
+
+    uart->tx_shifting = false;
+    uart->stats.tx_characters++;
+    if (uart->peer.receive != NULL)
+    {
+        uart->peer.receive (uart->peer.context, uart->tx_garbled ? (uint8_t) ~uart->tx_character :
+                            uart->tx_character, uart->tx_garbled);
+    }
+
+    tx_start (uart);
+    if (uart->tx_eot_mode && !uart->tx_shifting && (uart->tx_count == 0))
+    {
+        uart->int_raw |= UART_INT_TX;
+        update_interrupt (uart);
+    }
+}
+
+
+static bool tx_push (sim_uart_t *const uart, const uint8_t character)
+{
+    if (uart->tx_count == SIM_UART_FIFO_DEPTH)
+    {
+        return false;
+    }
+
+    uart->tx_fifo[(uart->tx_head + uart->tx_count) % SIM_UART_FIFO_DEPTH] = character;
+    uart->tx_count++;
+    if (!uart->tx_eot_mode && (uart->tx_count > uart->tx_trigger))
+    {
+        uart->int_raw &= ~UART_INT_TX;
+        update_interrupt (uart);
+    }
+    tx_start (uart);
+
+    return true;
+}
+
+
+/*
+ * Receiver
+ */
+
+static void peer_start (sim_uart_t *const uart);
+
+/**
+ * @brief Place a character sent by the peer in the receive FIFO, or record an overrun if full
+ */
+static void rx_push (sim_uart_t *const uart, uint16_t value)
+{
+    uart->stats.rx_characters++;
+    if (!uart->enabled)
+    {
+        return;
+    }
+    if (uart->rx_count == SIM_UART_FIFO_DEPTH)
+    {
+        uart->stats.rx_overruns++;
+        uart->overrun_pending = true;
+        uart->int_raw |= UART_INT_OE;
+        update_interrupt (uart);
+        return;
+    }
+
+    if (uart->overrun_pending)
+    {
+        value |= UART_DR_OE;
+        uart->overrun_pending = false;
+    }
+    if ((value & (UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE)) != 0)
+    {
+        uart->stats.rx_errors++;
+    }
+    uart->int_raw |= ((value & UART_DR_BE) ? UART_INT_BE : 0) | ((value & UART_DR_PE) ? UART_INT_PE : 0) |
+            ((value & UART_DR_FE) ? UART_INT_FE : 0);
+
+    uart->rx_fifo[(uart->rx_head + uart->rx_count) % SIM_UART_FIFO_DEPTH] = value;
+    uart->rx_count++;
+    if (uart->rx_count > uart->stats.rx_fifo_high_water)
+    {
+        uart->stats.rx_fifo_high_water = uart->rx_count;
+    }
+    if (uart->rx_count >= uart->rx_trigger)
+    {
+        uart->int_raw |= UART_INT_RX;
+    }
+    update_interrupt (uart);
+    sim_event_schedule (&uart->rx_timeout,
+                        sim_now + ((SIM_UART_RX_TIMEOUT_BITS * uart_bit_cycles_64 (uart)) / 64));
+    service_dma (uart);
+}
+
+
+/**
+ * @brief Remove a character from the receive FIFO
+ * @return The character and UART_DR_ error flags, or -1 if the FIFO is empty
+ */
+static int32_t rx_pop (sim_uart_t *const uart)
+{
+    const bool rts_was_asserted = rts_asserted (uart);
+    uint16_t value;
+
+    if (uart->rx_count == 0)
+    {
+        return -1;
+    }
+
+    value = uart->rx_fifo[uart->rx_head];
+    uart->rx_head = (uart->rx_head + 1) % SIM_UART_FIFO_DEPTH;
+    uart->rx_count--;
+    if (uart->rx_count < uart->rx_trigger)
+    {
+        uart->int_raw &= ~UART_INT_RX;
+    }
+    if (uart->rx_count == 0)
+    {
+        uart->int_raw &= ~UART_INT_RT;
+    }
+    update_interrupt (uart);
+    if (!rts_was_asserted && rts_asserted (uart))
+    {
+        peer_start (uart);
+    }
+
+    return value;
+}
+
+
+static void rx_timeout_handler (void *context)
+{
+    sim_uart_t *const uart = context;
+
+    if (uart->rx_count > 0)
+    {
+        uart->int_raw |= UART_INT_RT;
+        update_interrupt (uart);
+    }
+}
+
+
+static void rx_flush (sim_uart_t *const uart)
+{
+    uart->rx_count = 0;
+    uart->overrun_pending = false;
+    uart->int_raw &= ~(UART_INT_RX | UART_INT_RT);
+    sim_event_cancel (&uart->rx_timeout);
+    update_interrupt (uart);
+    peer_start (uart);
+}
+
+
+/*
+ * Peer
+ */
+
+static void peer_start (sim_uart_t *const uart)
+{
+    if (uart->peer_sending || (sim_queue_length (&uart->peer_queue) == 0))
+    {
+        return;
+    }
+    if (uart->peer_flow_control && !rts_asserted (uart))
+    {
+        if (!uart->peer_throttled)
+        {
+            uart->peer_throttled = true;
+            uart->peer_throttle_start = sim_now;
+        }
+        return;
+    }
+    if (uart->peer_throttled)
+    {
+        uart->peer_throttled = false;
+        uart->stats.rx_throttled_cycles += sim_now - uart->peer_throttle_start;
+    }
+
+    (void) sim_queue_pop (&uart->peer_queue, &uart->peer_item, sizeof (uart->peer_item));
+    uart->peer_sending = true;
+    if (uart->peer_item.kind == SIM_UART_PEER_BREAK)
+    {
+        const sim_time_t duration = SIM_US (uart->peer_item.duration_us);
+
+        sim_event_schedule (&uart->peer_done, sim_now +
+                            ((duration > peer_character_cycles (uart)) ? duration : peer_character_cycles (uart)));
+        uart->stats.rx_busy_cycles += duration;
+    }
+    else
+    {
+        sim_event_schedule (&uart->peer_done, sim_now + peer_character_cycles (uart));
+        uart->stats.rx_busy_cycles += peer_character_cycles (uart);
+    }
+}
+
+
+static void peer_done_handler (void *context)
+{
+    sim_uart_t *const uart = context;
+
+    uart->peer_sending = false;
+    if (uart->peer_item.kind == SIM_UART_PEER_BREAK)
+    {
+        rx_push (uart, UART_DR_BE | UART_DR_FE);
+    }
+    else if (!line_settings_match (uart))
+    {
+        rx_push (uart, (uint16_t) (((uint8_t) ~uart->peer_item.character) | UART_DR_FE));
+    }
+    else
+    {
+        rx_push (uart, uart->peer_item.character | uart->peer_item.dr_errors);
+    }
+    peer_start (uart);
+}
+
+
+/**
+ * @brief Attach a peer to the serial line of a UART, which is given the characters sent by the UART
+ */
+void sim_uart_attach (const uint32_t uart_base, const sim_uart_peer_t *const peer)
+{
+    find_uart (uart_base)->peer = *peer;
+}
+
+
+/**
+ * @brief Set the line settings of the peer
+ * @param[in] uart_base Identifies the UART
+ * @param[in] baud The baud rate used by the peer
+ * @param[in] config The frame format used by the peer, as UART_CONFIG_ values
+ * @param[in] flow_control When true the peer only starts sending a character while the UART asserts RTS
+ */
+void sim_uart_peer_config (const uint32_t uart_base, const uint32_t baud, const uint32_t config,
+                           const bool flow_control)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+
+    uart->peer_baud = baud;
+    uart->peer_config = config & SIM_UART_CONFIG_MASK;
+    uart->peer_flow_control = flow_control;
+    peer_start (uart);
+}
+
+
+static void peer_queue_item (sim_uart_t *const uart, const sim_uart_peer_item_t *const item)
+{
+    sim_queue_push (&uart->peer_queue, item, sizeof (*item));
+}
+
+
+/**
+ * @brief Queue characters to be sent by the peer to the UART
+ */
+void sim_uart_peer_send (const uint32_t uart_base, const void *const data, const size_t length)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+    const uint8_t *const characters = data;
+
+    for (size_t index = 0; index < length; index++)
+    {
+        const sim_uart_peer_item_t item = {.kind = SIM_UART_PEER_CHARACTER, .character = characters[index]};
+
+        peer_queue_item (uart, &item);
+    }
+    peer_start (uart);
+}
+
+
+/**
+ * @brief Queue a character to be sent by the peer, which the UART receives with error flags
+ * @param[in] uart_base Identifies the UART
+ * @param[in] character The character to send
+ * @param[in] dr_errors The UART_DR_PE or UART_DR_FE flags with which the character is received
+ */
+void sim_uart_peer_send_with_error (const uint32_t uart_base, const uint8_t character, const uint32_t dr_errors)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+    const sim_uart_peer_item_t item =
+    {
+        .kind = SIM_UART_PEER_CHARACTER, .character = character, .dr_errors = (uint16_t) dr_errors
+    };
+
+    peer_queue_item (uart, &item);
+    peer_start (uart);
+}
+
+
+/**
+ * @brief Queue a break to be sent by the peer, which the UART receives as a NUL character with BE and FE
+ */
+void sim_uart_peer_send_break (const uint32_t uart_base, const uint32_t duration_us)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+    const sim_uart_peer_item_t item = {.kind = SIM_UART_PEER_BREAK, .duration_us = duration_us};
+
+    peer_queue_item (uart, &item);
+    peer_start (uart);
+}
+
+
+/**
+ * @return The number of characters which the peer has yet to send, including any being sent
+ */
+size_t sim_uart_peer_pending (const uint32_t uart_base)
+{
+    const sim_uart_t *const uart = find_uart (uart_base);
+
+    return (sim_queue_length (&uart->peer_queue) / sizeof (sim_uart_peer_item_t)) + (uart->peer_sending ? 1 : 0);
+}
+
+
+/**
+ * @brief Set the RTS output of the peer, which is the CTS input of the UART
+ */
+void sim_uart_peer_set_rts (const uint32_t uart_base, const bool asserted)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+
+    uart->peer_rts = asserted;
+    tx_start (uart);
+}
+
+
+bool sim_uart_rts_asserted (const uint32_t uart_base)
+{
+    return rts_asserted (find_uart (uart_base));
+}
+
+
+bool sim_uart_breaking (const uint32_t uart_base)
+{
+    return find_uart (uart_base)->breaking;
+}
+
+
+/**
+ * @return The number of CPU cycles taken by one character at the line settings of the UART
+ */
+uint32_t sim_uart_character_cycles (const uint32_t uart_base)
+{
+    return uart_character_cycles (find_uart (uart_base));
+}
+
+
+/**
+ * @return The number of characters in the receive FIFO at the receive trigger level set by the firmware
+ */
+uint32_t sim_uart_rx_trigger_chars (const uint32_t uart_base)
+{
+    return find_uart (uart_base)->rx_trigger;
+}
+
+
+const sim_uart_stats_t *sim_uart_stats (const uint32_t uart_base)
+{
+    return &find_uart (uart_base)->stats;
+}
+
+
+void sim_uart_stats_clear (const uint32_t uart_base)
+{
+    sim_uart_t *const uart = find_uart (uart_base);
+
+    uart->stats = (sim_uart_stats_t) {0};
+    if (uart->peer_throttled)
+    {
+        uart->peer_throttle_start = sim_now;
+    }
+}
+
+
+/*
+ * uDMA requests
+ */
+
+static uint32_t rx_dma_requests (void *context)
+{
+    const sim_uart_t *const uart = context;
+    uint32_t requests = 0;
+
+    if ((uart->dma_enabled & UART_DMA_RX) != 0)
+    {
+        requests |= (uart->rx_count > 0) ? SIM_UDMA_REQUEST_SINGLE : 0;
+        requests |= (uart->rx_count >= uart->rx_trigger) ? SIM_UDMA_REQUEST_BURST : 0;
+    }
+
+    return requests;
+}
+
+
+static uint32_t rx_dma_read (void *context)
+{
+    sim_uart_t *const uart = context;
+    const int32_t value = rx_pop (uart);
+
+    if (value < 0)
+    {
+        sim_fail ("uDMA read from an empty UART receive FIFO");
+    }
+    uart->stats.rx_dma_characters++;
+
+    /* Only the character is transferred, as the uDMA item size is 8 bits */
+    return (uint32_t) value & UART_DR_DATA_M;
+}
+
+
+static void rx_dma_write (void *context, uint32_t value)
+{
+    (void) context;
+    (void) value;
+    sim_fail ("uDMA wrote to a UART data register from the receive channel");
+}
+
+
+static uint32_t tx_dma_requests (void *context)
+{
+    const sim_uart_t *const uart = context;
+    uint32_t requests = 0;
+
+    if ((uart->dma_enabled & UART_DMA_TX) != 0)
+    {
+        requests |= (uart->tx_count < SIM_UART_FIFO_DEPTH) ? SIM_UDMA_REQUEST_SINGLE : 0;
+        requests |= (uart->tx_count <= uart->tx_trigger) ? SIM_UDMA_REQUEST_BURST : 0;
+    }
+
+    return requests;
+}
+
+
+static uint32_t tx_dma_read (void *context)
+{
+    (void) context;
+    sim_fail ("uDMA read from a UART data register from the transmit channel");
+}
+
+
+static void tx_dma_write (void *context, uint32_t value)
+{
+    sim_uart_t *const uart = context;
+
+    if (!tx_push (uart, (uint8_t) value))
+    {
+        sim_fail ("uDMA wrote to a full UART transmit FIFO");
+    }
+    uart->stats.tx_dma_characters++;
+}
+
+
+/*
+ * driverlib functions
+ */
+
+static uint32_t fifo_trigger (const uint32_t level_code)
+{
+    static const uint32_t triggers[] = {2, 4, 8, 12, 14};
+
+    if (level_code >= (sizeof (triggers) / sizeof (triggers[0])))
+    {
+        sim_fail ("invalid UART FIFO level %u", level_code);
+    }
+
+    return triggers[level_code];
+}
+
+
+static void wait_not_busy (sim_uart_t *const uart)
+{
+    /* As UARTDisable() in driverlib, which spins on the busy flag */
+    while (uart->tx_shifting || (uart->tx_count > 0))
+    {
+        sim_consume (20);
+    }
+}
+
+
+void UARTConfigSetExpClk (uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud, uint32_t ui32Config)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    wait_not_busy (uart);
+    uart->enabled = false;
+    rx_flush (uart);
+
+    /* As driverlib, baud rates above the UART clock / 16 use the high speed mode which divides the clock by 8 */
+    uart->high_speed = (ui32Baud * 16) > ui32UARTClk;
+    if (uart->high_speed)
+    {
+        ui32Baud /= 2;
+    }
+    uart->divisor = (((ui32UARTClk * 8) / ui32Baud) + 1) / 2;
+    uart->config = ui32Config & SIM_UART_CONFIG_MASK;
+    uart->enabled = true;
+    tx_start (uart);
+}
+
+
+void UARTConfigGetExpClk (uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t *pui32Baud, uint32_t *pui32Config)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    *pui32Baud = (uart->divisor > 0) ? (((uart->high_speed ? 8 : 4) * ui32UARTClk) / uart->divisor) : 0;
+    *pui32Config = uart->config;
+}
+
+
+void UARTEnable (uint32_t ui32Base)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->enabled = true;
+    tx_start (uart);
+}
+
+
+void UARTDisable (uint32_t ui32Base)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    wait_not_busy (uart);
+    uart->enabled = false;
+    rx_flush (uart);
+}
+
+
+void UARTFIFOLevelSet (uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->tx_trigger = fifo_trigger (ui32TxLevel);
+    uart->rx_trigger = fifo_trigger (ui32RxLevel >> 3);
+    service_dma (uart);
+}
+
+
+void UARTTxIntModeSet (uint32_t ui32Base, uint32_t ui32Mode)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->tx_eot_mode = ui32Mode == UART_TXINT_MODE_EOT;
+}
+
+
+bool UARTCharsAvail (uint32_t ui32Base)
+{
+    return access_uart (ui32Base, __func__)->rx_count > 0;
+}
+
+
+bool UARTSpaceAvail (uint32_t ui32Base)
+{
+    return access_uart (ui32Base, __func__)->tx_count < SIM_UART_FIFO_DEPTH;
+}
+
+
+int32_t UARTCharGetNonBlocking (uint32_t ui32Base)
+{
+    return rx_pop (access_uart (ui32Base, __func__));
+}
+
+
+bool UARTCharPutNonBlocking (uint32_t ui32Base, unsigned char ucData)
+{
+    return tx_push (access_uart (ui32Base, __func__), ucData);
+}
+
+
+bool UARTBusy (uint32_t ui32Base)
+{
+    const sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    return uart->tx_shifting || (uart->tx_count > 0);
+}
+
+
+void UARTBreakCtl (uint32_t ui32Base, bool bBreakState)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    if (bBreakState != uart->breaking)
+    {
+        uart->breaking = bBreakState;
+        if (uart->peer.break_changed != NULL)
+        {
+            uart->peer.break_changed (uart->peer.context, bBreakState);
+        }
+        tx_start (uart);
+    }
+}
+
+
+void UARTIntEnable (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->int_mask |= ui32IntFlags;
+    update_interrupt (uart);
+}
+
+
+void UARTIntDisable (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->int_mask &= ~ui32IntFlags;
+    update_interrupt (uart);
+}
+
+
+uint32_t UARTIntStatus (uint32_t ui32Base, bool bMasked)
+{
+    const sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    return bMasked ? (uart->int_raw & uart->int_mask) : uart->int_raw;
+}
+
+
+void UARTIntClear (uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->int_raw &= ~ui32IntFlags;
+    update_interrupt (uart);
+}
+
+
+void UARTDMAEnable (uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->dma_enabled |= ui32DMAFlags;
+    service_dma (uart);
+}
+
+
+void UARTDMADisable (uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->dma_enabled &= ~ui32DMAFlags;
+}
+
+
+void UARTModemControlSet (uint32_t ui32Base, uint32_t ui32Control)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    if ((ui32Control & UART_OUTPUT_RTS) != 0)
+    {
+        uart->rts_software = true;
+        peer_start (uart);
+    }
+}
+
+
+void UARTModemControlClear (uint32_t ui32Base, uint32_t ui32Control)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    if ((ui32Control & UART_OUTPUT_RTS) != 0)
+    {
+        uart->rts_software = false;
+    }
+}
+
+
+void UARTFlowControlSet (uint32_t ui32Base, uint32_t ui32Mode)
+{
+    sim_uart_t *const uart = access_uart (ui32Base, __func__);
+
+    uart->flow_control = ui32Mode;
+    tx_start (uart);
+    peer_start (uart);
+}
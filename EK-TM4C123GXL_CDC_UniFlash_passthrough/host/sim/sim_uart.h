@@ -0,0 +1,74 @@
+/*
+ * @file sim_uart.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 UARTs used by the bridge, and of the serial line to a peer, for the host simulation
+ * @details
+ *  Each UART has 16 entry transmit and receive FIFOs, with the interrupts and uDMA requests of the hardware.
+ *  Characters take the time given by the baud rate and frame format to cross the serial line, in each direction.
+ *  The peer at the other end of the line, which is normally a model of the CC3100, is given each character sent
+ *  by the UART and queues characters to be sent to the UART. When the frame format or baud rate of the peer
+ *  doesn't match that of the UART, the characters are received with a framing error.
+ *
+ *  The peer observes the RTS output of the UART, and controls the CTS input of the UART, for flow control.
+ */
+
+#ifndef SIM_UART_H_
+#define SIM_UART_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** The callbacks to the peer at the other end of the serial line from a UART */
+typedef struct
+{
+    /** Called when a character sent by the UART has been received by the peer, with error true when the peer
+     *  detected a framing error due to a mismatch in the line settings */
+    void (*receive) (void *context, uint8_t character, bool error);
+    /** Called when the UART starts or stops sending a break */
+    void (*break_changed) (void *context, bool active);
+    void *context;
+} sim_uart_peer_t;
+
+/** Statistics of the serial line connected to a UART */
+typedef struct
+{
+    /** Characters sent by the UART, and received by the peer */
+    uint64_t tx_characters;
+    /** Characters sent by the peer, and received by the UART */
+    uint64_t rx_characters;
+    /** Characters sent by the peer which were lost as the UART receive FIFO was full */
+    uint64_t rx_overruns;
+    /** Characters received by the UART with an error flag */
+    uint64_t rx_errors;
+    /** The deepest the receive FIFO has been */
+    uint32_t rx_fifo_high_water;
+    /** The cycles during which the UART was transmitting */
+    uint64_t tx_busy_cycles;
+    /** The cycles during which the peer was transmitting */
+    uint64_t rx_busy_cycles;
+    /** The cycles during which the peer had data to send but was held off by the RTS output of the UART */
+    uint64_t rx_throttled_cycles;
+    /** Characters read from the receive FIFO by the uDMA */
+    uint64_t rx_dma_characters;
+    /** Characters written to the transmit FIFO by the uDMA */
+    uint64_t tx_dma_characters;
+} sim_uart_stats_t;
+
+void sim_uart_attach (const uint32_t uart_base, const sim_uart_peer_t *const peer);
+void sim_uart_peer_config (const uint32_t uart_base, const uint32_t baud, const uint32_t config,
+                           const bool flow_control);
+void sim_uart_peer_send (const uint32_t uart_base, const void *const data, const size_t length);
+void sim_uart_peer_send_with_error (const uint32_t uart_base, const uint8_t character, const uint32_t dr_errors);
+void sim_uart_peer_send_break (const uint32_t uart_base, const uint32_t duration_us);
+size_t sim_uart_peer_pending (const uint32_t uart_base);
+void sim_uart_peer_set_rts (const uint32_t uart_base, const bool asserted);
+bool sim_uart_rts_asserted (const uint32_t uart_base);
+bool sim_uart_breaking (const uint32_t uart_base);
+uint32_t sim_uart_character_cycles (const uint32_t uart_base);
+uint32_t sim_uart_rx_trigger_chars (const uint32_t uart_base);
+const sim_uart_stats_t *sim_uart_stats (const uint32_t uart_base);
+void sim_uart_stats_clear (const uint32_t uart_base);
+
+#endif /* SIM_UART_H_ */
@@ -0,0 +1,452 @@
+/*
+ * @file sim_udma.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 uDMA controller, for the host simulation of the bridge
+ */
+
+#include <stddef.h>
+
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+
+#include "sim.h"
+#include "sim_udma.h"
+
+#define SIM_UDMA_NUM_CHANNELS 32
+#define SIM_UDMA_NUM_SELECTS  5
+
+/* Fields of the channel control word, as defined by the hardware */
+#define SIM_UDMA_CHCTL_DSTINC_M      0xC0000000u
+#define SIM_UDMA_CHCTL_DSTINC_S      30
+#define SIM_UDMA_CHCTL_DSTSIZE_M     0x30000000u
+#define SIM_UDMA_CHCTL_SRCINC_M      0x0C000000u
+#define SIM_UDMA_CHCTL_SRCINC_S      26
+#define SIM_UDMA_CHCTL_SRCSIZE_M     0x03000000u
+#define SIM_UDMA_CHCTL_SRCSIZE_S     24
+#define SIM_UDMA_CHCTL_ARBSIZE_M     0x0003C000u
+#define SIM_UDMA_CHCTL_ARBSIZE_S     14
+#define SIM_UDMA_CHCTL_XFERSIZE_M    0x00003FF0u
+#define SIM_UDMA_CHCTL_XFERSIZE_S    4
+#define SIM_UDMA_CHCTL_NXTUSEBURST   0x00000008u
+#define SIM_UDMA_CHCTL_XFERMODE_M    0x00000007u
+
+/** The increment field value meaning no increment */
+#define SIM_UDMA_INC_NONE 3
+
+/** The lowest and highest addresses of the peripherals which the uDMA can access */
+#define SIM_UDMA_PERIPHERAL_START 0x40000000u
+#define SIM_UDMA_PERIPHERAL_END   0x400FFFFFu
+
+/** The peripheral registered for each channel assignment */
+typedef struct
+{
+    const sim_udma_peripheral_t *peripheral;
+    void *context;
+} sim_udma_registration_t;
+
+static sim_udma_registration_t registrations[SIM_UDMA_NUM_CHANNELS][SIM_UDMA_NUM_SELECTS];
+
+/** The state of the controller */
+static bool controller_enabled;
+static tDMAControlTable *control_table;
+static uint32_t channel_assignments[SIM_UDMA_NUM_CHANNELS];
+static uint32_t channels_enabled;
+static uint32_t channels_use_burst;
+static uint32_t channels_alternate;
+static uint32_t channels_high_priority;
+static uint32_t channels_request_masked;
+
+/** Set while servicing, since moving data can change the requests of the peripheral being serviced */
+static bool servicing;
+static uint32_t channels_to_service;
+
+
+/**
+ * @brief Register a peripheral which makes requests on a channel, when the channel is assigned to the select
+ */
+void sim_udma_register (const uint32_t channel, const uint32_t select, const sim_udma_peripheral_t *const peripheral,
+                        void *const context)
+{
+    registrations[channel][select].peripheral = peripheral;
+    registrations[channel][select].context = context;
+}
+
+
+static void access_controller (const char *const function)
+{
+    sim_consume (10);
+    sim_peripheral_check (SYSCTL_PERIPH_UDMA, function);
+}
+
+
+static uint32_t check_channel (const uint32_t channel, const char *const function)
+{
+    if (channel >= SIM_UDMA_NUM_CHANNELS)
+    {
+        sim_fail ("%s() on invalid uDMA channel %u", function, channel);
+    }
+
+    return channel;
+}
+
+
+/**
+ * @brief Get the control structure for a channel and select, from the index used by driverlib
+ */
+static tDMAControlTable *control_structure (const uint32_t channel_struct_index, const char *const function)
+{
+    if (control_table == NULL)
+    {
+        sim_fail ("%s() before uDMAControlBaseSet()", function);
+    }
+    if ((channel_struct_index & ~(UDMA_ALT_SELECT | 0x1Fu)) != 0)
+    {
+        sim_fail ("%s() on invalid uDMA channel structure index 0x%x", function, channel_struct_index);
+    }
+
+    return &control_table[channel_struct_index];
+}
+
+
+/**
+ * @brief Access an item of a transfer, in either memory or a peripheral data register
+ */
+static uint32_t read_item (const sim_udma_registration_t *const registration, const uintptr_t address,
+                           const uint32_t item_size)
+{
+    if ((address >= SIM_UDMA_PERIPHERAL_START) && (address <= SIM_UDMA_PERIPHERAL_END))
+    {
+        if (address != registration->peripheral->data_address)
+        {
+            sim_fail ("uDMA read from peripheral address 0x%lx which isn't the requesting peripheral",
+                      (unsigned long) address);
+        }
+        return registration->peripheral->read (registration->context);
+    }
+
+    switch (item_size)
+    {
+    case 1:
+        return *(const uint8_t *) address;
+    case 2:
+        return *(const uint16_t *) address;
+    default:
+        return *(const uint32_t *) address;
+    }
+}
+
+
+static void write_item (const sim_udma_registration_t *const registration, const uintptr_t address,
+                        const uint32_t item_size, const uint32_t value)
+{
+    if ((address >= SIM_UDMA_PERIPHERAL_START) && (address <= SIM_UDMA_PERIPHERAL_END))
+    {
+        if (address != registration->peripheral->data_address)
+        {
+            sim_fail ("uDMA write to peripheral address 0x%lx which isn't the requesting peripheral",
+                      (unsigned long) address);
+        }
+        registration->peripheral->write (registration->context, value);
+        return;
+    }
+
+    switch (item_size)
+    {
+    case 1:
+        *(uint8_t *) address = (uint8_t) value;
+        break;
+    case 2:
+        *(uint16_t *) address = (uint16_t) value;
+        break;
+    default:
+        *(uint32_t *) address = value;
+        break;
+    }
+}
+
+
+/**
+ * @brief Move one item of the transfer in a control structure, updating the transfer size written back
+ * @return Returns true if the transfer has completed
+ */
+static bool move_item (const sim_udma_registration_t *const registration, tDMAControlTable *const structure)
+{
+    const uint32_t control = structure->ui32Control;
+    const uint32_t item_size = 1u << ((control & SIM_UDMA_CHCTL_SRCSIZE_M) >> SIM_UDMA_CHCTL_SRCSIZE_S);
+    const uint32_t src_inc = (control & SIM_UDMA_CHCTL_SRCINC_M) >> SIM_UDMA_CHCTL_SRCINC_S;
+    const uint32_t dst_inc = (control & SIM_UDMA_CHCTL_DSTINC_M) >> SIM_UDMA_CHCTL_DSTINC_S;
+    const uint32_t remaining_minus_1 = (control & SIM_UDMA_CHCTL_XFERSIZE_M) >> SIM_UDMA_CHCTL_XFERSIZE_S;
+    const uintptr_t src = (uintptr_t) structure->pvSrcEndAddr -
+            ((src_inc == SIM_UDMA_INC_NONE) ? 0 : (remaining_minus_1 << src_inc));
+    const uintptr_t dst = (uintptr_t) structure->pvDstEndAddr -
+            ((dst_inc == SIM_UDMA_INC_NONE) ? 0 : (remaining_minus_1 << dst_inc));
+
+    write_item (registration, dst, item_size, read_item (registration, src, item_size));
+
+    if (remaining_minus_1 == 0)
+    {
+        /* On completion the hardware writes back the stop mode, leaving the transfer size field zero */
+        structure->ui32Control = control & ~(SIM_UDMA_CHCTL_XFERSIZE_M | SIM_UDMA_CHCTL_XFERMODE_M);
+        return true;
+    }
+
+    structure->ui32Control = (control & ~SIM_UDMA_CHCTL_XFERSIZE_M) |
+            ((remaining_minus_1 - 1) << SIM_UDMA_CHCTL_XFERSIZE_S);
+    return false;
+}
+
+
+/**
+ * @brief Move items for a channel while its peripheral is requesting, and the channel has a transfer
+ */
+static void service_channel (const uint32_t channel)
+{
+    const uint32_t mask = 1u << channel;
+    const uint32_t select = channel_assignments[channel];
+    const sim_udma_registration_t *const registration = &registrations[channel][select];
+
+    if ((registration->peripheral == NULL) || !controller_enabled || ((channels_enabled & mask) == 0) ||
+        ((channels_request_masked & mask) != 0))
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        const uint32_t requests = registration->peripheral->requests (registration->context);
+        const uint32_t structure_index = channel | (((channels_alternate & mask) != 0) ? UDMA_ALT_SELECT : 0);
+        tDMAControlTable *const structure = &control_table[structure_index];
+        const uint32_t mode = structure->ui32Control & SIM_UDMA_CHCTL_XFERMODE_M;
+        uint32_t num_items;
+        bool complete = false;
+
+        if (mode == UDMA_MODE_STOP)
+        {
+            /* A channel enabled with the stop mode in its current structure is disabled */
+            channels_enabled &= ~mask;
+            return;
+        }
+        if ((mode != UDMA_MODE_BASIC) && (mode != UDMA_MODE_PINGPONG))
+        {
+            sim_fail ("uDMA channel %u uses an unmodelled mode %u", channel, mode);
+        }
+
+        if ((requests & SIM_UDMA_REQUEST_BURST) != 0)
+        {
+            num_items = 1u << ((structure->ui32Control & SIM_UDMA_CHCTL_ARBSIZE_M) >> SIM_UDMA_CHCTL_ARBSIZE_S);
+        }
+        else if (((requests & SIM_UDMA_REQUEST_SINGLE) != 0) && ((channels_use_burst & mask) == 0))
+        {
+            num_items = 1;
+        }
+        else
+        {
+            return;
+        }
+
+        while ((num_items > 0) && !complete)
+        {
+            complete = move_item (registration, structure);
+            num_items--;
+        }
+
+        if (complete)
+        {
+            if (mode == UDMA_MODE_PINGPONG)
+            {
+                /* Continue with the other structure, which stops the channel if it is in the stop mode */
+                channels_alternate ^= mask;
+            }
+            else
+            {
+                channels_enabled &= ~mask;
+            }
+            sim_irq_pend (registration->peripheral->done_interrupt);
+            if ((channels_enabled & mask) == 0)
+            {
+                return;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Service a channel after the requests of its peripheral may have changed
+ * @details Called by the peripheral models, and after the firmware changes the channel. Servicing is deferred if
+ *          already servicing, which happens when moving an item changes the requests of a peripheral.
+ */
+void sim_udma_service (const uint32_t channel)
+{
+    channels_to_service |= 1u << channel;
+    if (servicing)
+    {
+        return;
+    }
+
+    servicing = true;
+    while (channels_to_service != 0)
+    {
+        const uint32_t next_channel = (uint32_t) __builtin_ctz (channels_to_service);
+
+        channels_to_service &= ~(1u << next_channel);
+        service_channel (next_channel);
+    }
+    servicing = false;
+}
+
+
+/*
+ * driverlib functions
+ */
+
+void uDMAEnable (void)
+{
+    access_controller (__func__);
+    controller_enabled = true;
+}
+
+
+void uDMAControlBaseSet (void *pControlTable)
+{
+    access_controller (__func__);
+    control_table = pControlTable;
+}
+
+
+void uDMAChannelAssign (uint32_t ui32Mapping)
+{
+    const uint32_t channel = check_channel (ui32Mapping & 0xFF, __func__);
+    const uint32_t select = ui32Mapping >> 16;
+
+    access_controller (__func__);
+    if (select >= SIM_UDMA_NUM_SELECTS)
+    {
+        sim_fail ("uDMA channel mapping 0x%x isn't modelled", ui32Mapping);
+    }
+    channel_assignments[channel] = select;
+}
+
+
+static void attribute_update (const uint32_t channel, const uint32_t attributes, const bool enable)
+{
+    const uint32_t mask = 1u << channel;
+    uint32_t *const attribute_masks[] =
+    {
+        &channels_use_burst, &channels_alternate, &channels_high_priority, &channels_request_masked
+    };
+    const uint32_t attribute_flags[] =
+    {
+        UDMA_ATTR_USEBURST, UDMA_ATTR_ALTSELECT, UDMA_ATTR_HIGH_PRIORITY, UDMA_ATTR_REQMASK
+    };
+
+    for (uint32_t index = 0; index < (sizeof (attribute_flags) / sizeof (attribute_flags[0])); index++)
+    {
+        if ((attributes & attribute_flags[index]) != 0)
+        {
+            *attribute_masks[index] = enable ? (*attribute_masks[index] | mask) : (*attribute_masks[index] & ~mask);
+        }
+    }
+}
+
+
+void uDMAChannelAttributeEnable (uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    access_controller (__func__);
+    attribute_update (check_channel (ui32ChannelNum, __func__), ui32Attr, true);
+    sim_udma_service (ui32ChannelNum);
+}
+
+
+void uDMAChannelAttributeDisable (uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    access_controller (__func__);
+    attribute_update (check_channel (ui32ChannelNum, __func__), ui32Attr, false);
+    sim_udma_service (ui32ChannelNum);
+}
+
+
+void uDMAChannelControlSet (uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    const uint32_t fields = SIM_UDMA_CHCTL_DSTINC_M | SIM_UDMA_CHCTL_DSTSIZE_M | SIM_UDMA_CHCTL_SRCINC_M |
+            SIM_UDMA_CHCTL_SRCSIZE_M | SIM_UDMA_CHCTL_ARBSIZE_M | SIM_UDMA_CHCTL_NXTUSEBURST;
+    tDMAControlTable *structure;
+
+    access_controller (__func__);
+    structure = control_structure (ui32ChannelStructIndex, __func__);
+    structure->ui32Control = (structure->ui32Control & ~fields) | (ui32Control & fields);
+}
+
+
+/**
+ * @brief Set the addresses, size and mode of a transfer, with the same encoding as driverlib
+ * @details The end addresses are the addresses of the last item, for an incrementing address.
+ */
+void uDMAChannelTransferSet (uint32_t ui32ChannelStructIndex, uint32_t ui32Mode, void *pvSrcAddr, void *pvDstAddr,
+                             uint32_t ui32TransferSize)
+{
+    tDMAControlTable *structure;
+    uint32_t control;
+    uint32_t src_inc;
+    uint32_t dst_inc;
+
+    access_controller (__func__);
+    structure = control_structure (ui32ChannelStructIndex, __func__);
+    control = structure->ui32Control;
+    src_inc = (control & SIM_UDMA_CHCTL_SRCINC_M) >> SIM_UDMA_CHCTL_SRCINC_S;
+    dst_inc = (control & SIM_UDMA_CHCTL_DSTINC_M) >> SIM_UDMA_CHCTL_DSTINC_S;
+    if ((ui32TransferSize == 0) || (ui32TransferSize > 1024))
+    {
+        sim_fail ("uDMAChannelTransferSet() with invalid transfer size %u", ui32TransferSize);
+    }
+
+    control &= ~(SIM_UDMA_CHCTL_XFERSIZE_M | SIM_UDMA_CHCTL_XFERMODE_M);
+    control |= ((ui32TransferSize - 1) << SIM_UDMA_CHCTL_XFERSIZE_S) | (ui32Mode & SIM_UDMA_CHCTL_XFERMODE_M);
+    structure->pvSrcEndAddr = (src_inc == SIM_UDMA_INC_NONE) ? pvSrcAddr :
+            (void *) ((uintptr_t) pvSrcAddr + ((ui32TransferSize - 1) << src_inc));
+    structure->pvDstEndAddr = (dst_inc == SIM_UDMA_INC_NONE) ? pvDstAddr :
+            (void *) ((uintptr_t) pvDstAddr + ((ui32TransferSize - 1) << dst_inc));
+    structure->ui32Control = control;
+    sim_udma_service (ui32ChannelStructIndex & 0x1F);
+}
+
+
+void uDMAChannelEnable (uint32_t ui32ChannelNum)
+{
+    access_controller (__func__);
+    channels_enabled |= 1u << check_channel (ui32ChannelNum, __func__);
+    sim_udma_service (ui32ChannelNum);
+}
+
+
+void uDMAChannelDisable (uint32_t ui32ChannelNum)
+{
+    access_controller (__func__);
+    channels_enabled &= ~(1u << check_channel (ui32ChannelNum, __func__));
+}
+
+
+bool uDMAChannelIsEnabled (uint32_t ui32ChannelNum)
+{
+    access_controller (__func__);
+    return (channels_enabled & (1u << check_channel (ui32ChannelNum, __func__))) != 0;
+}
+
+
+uint32_t uDMAChannelModeGet (uint32_t ui32ChannelStructIndex)
+{
+    access_controller (__func__);
+    return control_structure (ui32ChannelStructIndex, __func__)->ui32Control & SIM_UDMA_CHCTL_XFERMODE_M;
+}
+
+
+uint32_t uDMAChannelSizeGet (uint32_t ui32ChannelStructIndex)
+{
+    uint32_t control;
+
+    access_controller (__func__);
+    control = control_structure (ui32ChannelStructIndex, __func__)->ui32Control &
+            (SIM_UDMA_CHCTL_XFERSIZE_M | SIM_UDMA_CHCTL_XFERMODE_M);
+    return (control != 0) ? (((control & SIM_UDMA_CHCTL_XFERSIZE_M) >> SIM_UDMA_CHCTL_XFERSIZE_S) + 1) : 0;
+}
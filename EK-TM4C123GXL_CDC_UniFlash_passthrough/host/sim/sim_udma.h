@@ -0,0 +1,40 @@
+/*
+ * @file sim_udma.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 uDMA controller, for the host simulation of the bridge
+ * @details
+ *  The channel control structures are held in the control table in the firmware's memory, with the same encoding
+ *  as the hardware, so that the firmware sees the transfer size and mode written back as the uDMA progresses.
+ *  Transfers take no time; a peripheral calls sim_udma_service() when its requests may have changed, and the
+ *  uDMA then moves as many items as the requests allow.
+ */
+
+#ifndef SIM_UDMA_H_
+#define SIM_UDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The requests which a peripheral can make to the uDMA */
+#define SIM_UDMA_REQUEST_SINGLE 0x1
+#define SIM_UDMA_REQUEST_BURST  0x2
+
+/** A peripheral which can make uDMA requests on a channel */
+typedef struct
+{
+    /** The address of the peripheral data register, the only peripheral address the uDMA may access */
+    uint32_t data_address;
+    /** Return the current SIM_UDMA_REQUEST_ flags */
+    uint32_t (*requests) (void *context);
+    uint32_t (*read) (void *context);
+    void (*write) (void *context, uint32_t value);
+    /** The interrupt which is raised when a transfer completes */
+    uint32_t done_interrupt;
+} sim_udma_peripheral_t;
+
+void sim_udma_register (const uint32_t channel, const uint32_t select, const sim_udma_peripheral_t *const peripheral,
+                        void *const context);
+void sim_udma_service (const uint32_t channel);
+
+#endif /* SIM_UDMA_H_ */
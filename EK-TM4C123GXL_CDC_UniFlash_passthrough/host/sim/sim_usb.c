@@ -0,0 +1,1460 @@
+/*
+ * @file sim_usb.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 USB device controller and of the full-speed USB host, for the host simulation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/usb.h"
+#include "usblib/usbcdc.h"
+
+#include "sim.h"
+#include "sim_usb.h"
+
+/** The number of endpoints in each direction, including endpoint 0 */
+#define SIM_USB_NUM_EPS 8
+
+/** The size of the endpoint FIFO RAM */
+#define SIM_USB_FIFO_RAM_SIZE 2048
+
+/** The largest packet, which is also the largest FIFO */
+#define SIM_USB_MAX_PACKET 64
+
+/** The duration of a frame */
+#define SIM_USB_FRAME_CYCLES SIM_MS (1)
+
+/** The duration of a microframe, after which the host retries endpoints which have all been NAKed */
+#define SIM_USB_MICROFRAME_CYCLES SIM_US (125)
+
+/** The bytes on the bus of a transaction beyond the data, for the token, handshake, CRC, sync and gaps */
+#define SIM_USB_TRANSACTION_OVERHEAD 13
+
+/** The bytes on the bus of an IN transaction which is NAKed, for the token and handshake with sync and gaps */
+#define SIM_USB_NAK_BYTES 8
+
+/** The time from the device connecting to the host resetting it, and the duration of the reset */
+#define SIM_USB_CONNECT_DEBOUNCE_CYCLES SIM_MS (100)
+#define SIM_USB_RESET_CYCLES SIM_MS (10)
+
+/** The idle time after which the device detects the bus is suspended */
+#define SIM_USB_SUSPEND_DETECT_CYCLES SIM_MS (3)
+
+/** The largest data stage of a control transfer */
+#define SIM_USB_MAX_CONTROL_DATA 4096
+
+/** The time the host allows the device to complete a control transfer */
+#define SIM_USB_CONTROL_TIMEOUT SIM_MS (500)
+
+/** The state of one endpoint FIFO */
+typedef struct
+{
+    bool configured;
+    uint32_t max_packet_size;
+    uint32_t fifo_address;
+    /** The USB_FIFO_SZ_ value, including USB_FIFO_SIZE_DB_FLAG when double-buffered */
+    uint32_t fifo_size;
+    /** The packets in the FIFO, in order of arrival */
+    uint8_t packets[2][SIM_USB_MAX_PACKET];
+    uint32_t lengths[2];
+    uint32_t head;
+    uint32_t count;
+    /** For an OUT endpoint, the bytes of the first packet already read by the firmware */
+    uint32_t read_offset;
+    /** For an IN endpoint, the packet being written by the firmware before it is sent */
+    uint8_t loading[SIM_USB_MAX_PACKET];
+    uint32_t loading_length;
+    /** For an IN endpoint, set when a packet has been sent and the interrupt for it not yet raised */
+    bool send_pending;
+} sim_usb_endpoint_t;
+
+/** A function of the device with bulk endpoints, as found by the host from the configuration descriptor */
+typedef struct
+{
+    /** The interface to which class and vendor requests for the port are addressed */
+    uint8_t interface;
+    uint8_t in_ep;
+    uint8_t out_ep;
+    /** The interrupt endpoint for CDC notifications, or zero if none */
+    uint8_t notification_ep;
+    sim_queue_t to_device;
+    sim_queue_t from_device;
+    size_t read_limit;
+    uint16_t serial_state;
+    uint32_t in_frame_number;
+    uint32_t in_frame_packets;
+    uint32_t out_frame_number;
+    uint32_t out_frame_packets;
+    sim_usb_port_stats_t stats;
+} sim_usb_port_t;
+
+/** The phases of a control transfer, as seen by the host */
+typedef enum
+{
+    SIM_USB_CONTROL_IDLE,
+    /** The host is to send the setup packet */
+    SIM_USB_CONTROL_SETUP,
+    /** Waiting for the device to respond to the setup packet */
+    SIM_USB_CONTROL_WAIT_DEVICE,
+    /** The device is ready for the host to send the OUT data stage */
+    SIM_USB_CONTROL_OUT_DATA,
+    /** The host is to complete the transfer with the IN data stage or status stage */
+    SIM_USB_CONTROL_STATUS,
+    SIM_USB_CONTROL_DONE
+} sim_usb_control_phase_t;
+
+/** A control transfer from the host */
+typedef struct
+{
+    sim_usb_control_phase_t phase;
+    tUSBRequest request;
+    uint8_t data[SIM_USB_MAX_CONTROL_DATA];
+    /** The length of the data stage, once the device has responded */
+    uint32_t length;
+    /** The bytes of the data stage, or -1 if the device stalled the request */
+    int32_t result;
+    /** When set, called once the transfer has completed, to continue enumeration */
+    void (*done) (void);
+    /** Set when the setup packet is waiting to be read by the device */
+    bool setup_ready;
+    /** Set when the OUT data stage is waiting to be read by the device */
+    bool out_data_ready;
+} sim_usb_control_t;
+
+/** The states of the host */
+typedef enum
+{
+    SIM_USB_HOST_DETACHED,
+    SIM_USB_HOST_ENUMERATING,
+    SIM_USB_HOST_CONFIGURED
+} sim_usb_host_state_t;
+
+static sim_usb_endpoint_t in_endpoints[SIM_USB_NUM_EPS];
+static sim_usb_endpoint_t out_endpoints[SIM_USB_NUM_EPS];
+static uint32_t int_status;
+static uint32_t ep_int_status;
+
+static sim_usb_host_state_t host_state;
+static bool connected;
+static bool suspended;
+/** Set while the host is sending frames, which stops during the bus reset and while suspended */
+static bool frames_running;
+static uint32_t frame_number;
+static sim_time_t frame_start;
+static sim_event_t connect_event;
+static sim_event_t frame_event;
+static sim_event_t transaction_event;
+static sim_event_t suspend_event;
+static bool models_initialised;
+
+static sim_usb_port_t ports[SIM_USB_MAX_PORTS];
+static uint32_t num_ports;
+static uint32_t round_robin_index;
+static uint32_t consecutive_naks;
+static bool notifications_polled;
+
+/** The bulk transaction on the bus, whose packet is only moved into or out of the endpoint FIFO once the
+ *  transaction completes, so a single-buffered FIFO can't take part in the next transaction until the firmware
+ *  has handled the packet */
+static struct
+{
+    /** The port of the transaction, or NULL when none is in progress */
+    sim_usb_port_t *port;
+    bool in;
+    uint8_t packet[SIM_USB_MAX_PACKET];
+    uint32_t length;
+} bulk_transaction;
+
+static sim_usb_control_t control;
+static uint8_t config_descriptor[512];
+static uint32_t config_descriptor_length;
+
+
+static void frame_handler (void *context);
+static void transaction_handler (void *context);
+static void connect_handler (void *context);
+static void suspend_handler (void *context);
+static void complete_bulk_transaction (void);
+
+static void initialise_models (void)
+{
+    if (!models_initialised)
+    {
+        sim_event_init (&connect_event, connect_handler, NULL);
+        sim_event_init (&frame_event, frame_handler, NULL);
+        sim_event_init (&transaction_event, transaction_handler, NULL);
+        sim_event_init (&suspend_event, suspend_handler, NULL);
+        for (uint32_t port_index = 0; port_index < SIM_USB_MAX_PORTS; port_index++)
+        {
+            ports[port_index].read_limit = SIZE_MAX;
+        }
+        models_initialised = true;
+    }
+}
+
+
+static void update_interrupt (void)
+{
+    sim_irq_line (INT_USB0, (int_status | ep_int_status) != 0);
+}
+
+
+static void raise_ep_interrupt (const uint32_t flags)
+{
+    ep_int_status |= flags;
+    update_interrupt ();
+}
+
+
+static void raise_interrupt (const uint32_t flags)
+{
+    int_status |= flags;
+    update_interrupt ();
+}
+
+
+/**
+ * @brief The number of packets which an endpoint FIFO can hold
+ */
+static uint32_t fifo_slots (const sim_usb_endpoint_t *const endpoint)
+{
+    return ((endpoint->fifo_size & USB_FIFO_SIZE_DB_FLAG) != 0) ? 2 : 1;
+}
+
+
+static uint32_t fifo_bytes (const sim_usb_endpoint_t *const endpoint)
+{
+    return USBFIFOSizeToBytes (endpoint->fifo_size & ~USB_FIFO_SIZE_DB_FLAG) * fifo_slots (endpoint);
+}
+
+
+/**
+ * @brief The cycles on the bus of a transaction carrying a number of data bytes at 12 Mbit/s
+ */
+static sim_time_t transaction_cycles (const uint32_t data_bytes)
+{
+    return ((sim_time_t) (data_bytes + SIM_USB_TRANSACTION_OVERHEAD) * 8 * SIM_CPU_HZ) / 12000000u;
+}
+
+
+static sim_time_t nak_cycles (void)
+{
+    return ((sim_time_t) SIM_USB_NAK_BYTES * 8 * SIM_CPU_HZ) / 12000000u;
+}
+
+
+static sim_usb_port_t *find_port (const uint32_t port)
+{
+    initialise_models ();
+    if (port >= num_ports)
+    {
+        sim_fail ("USB port %u doesn't exist, the device has %u", port, num_ports);
+    }
+
+    return &ports[port];
+}
+
+
+/*
+ * The host
+ */
+
+/**
+ * @brief Start the host transactions, if not already waiting for the next transaction or frame
+ */
+static void kick_transactions (void)
+{
+    if (frames_running && !sim_event_scheduled (&transaction_event))
+    {
+        sim_event_schedule (&transaction_event, sim_now);
+    }
+}
+
+
+static void start_control (const tUSBRequest *const request, const void *const data, void (*done) (void))
+{
+    control.phase = SIM_USB_CONTROL_SETUP;
+    control.request = *request;
+    control.length = 0;
+    control.result = -1;
+    control.done = done;
+    control.setup_ready = false;
+    control.out_data_ready = false;
+    if (!(request->bmRequestType & USB_RTYPE_DIR_IN) && (request->wLength > 0) && (data != NULL))
+    {
+        memcpy (control.data, data, request->wLength);
+    }
+    kick_transactions ();
+}
+
+
+static void enumeration_configured (void);
+static void enumeration_set_configuration (void);
+static void enumeration_get_configuration (void);
+
+/**
+ * @brief Find the ports from the configuration descriptor
+ */
+static void parse_config_descriptor (void)
+{
+    uint32_t offset = 0;
+    uint8_t interface_number = 0;
+    uint8_t interface_class = 0;
+    uint8_t control_interface = 0;
+    uint8_t notification_ep = 0;
+
+    num_ports = 0;
+    while ((offset + 2) <= config_descriptor_length)
+    {
+        const uint8_t *const descriptor = &config_descriptor[offset];
+
+        if (descriptor[0] < 2)
+        {
+            sim_fail ("invalid descriptor length %u in the configuration descriptor", descriptor[0]);
+        }
+
+        if (descriptor[1] == USB_DTYPE_INTERFACE)
+        {
+            const tInterfaceDescriptor *const interface = (const tInterfaceDescriptor *) descriptor;
+
+            interface_number = interface->bInterfaceNumber;
+            interface_class = interface->bInterfaceClass;
+            if (interface_class == USB_CLASS_CDC)
+            {
+                control_interface = interface_number;
+            }
+            else if (interface_class != USB_CLASS_CDC_DATA)
+            {
+                control_interface = interface_number;
+                notification_ep = 0;
+            }
+        }
+        else if (descriptor[1] == USB_DTYPE_ENDPOINT)
+        {
+            const tEndpointDescriptor *const endpoint = (const tEndpointDescriptor *) descriptor;
+            const uint8_t ep_index = endpoint->bEndpointAddress & 0x0F;
+            sim_usb_port_t *port;
+
+            if ((endpoint->bmAttributes & 0x03) == USB_EP_ATTR_INT)
+            {
+                notification_ep = ep_index;
+            }
+            else if ((endpoint->bmAttributes & 0x03) == USB_EP_ATTR_BULK)
+            {
+                if ((num_ports == 0) || (ports[num_ports - 1].interface != control_interface) ||
+                    (((endpoint->bEndpointAddress & USB_EP_DESC_IN) != 0) ? ports[num_ports - 1].in_ep :
+                     ports[num_ports - 1].out_ep) != 0)
+                {
+                    if (num_ports == SIM_USB_MAX_PORTS)
+                    {
+                        sim_fail ("the device has more than %u ports", SIM_USB_MAX_PORTS);
+                    }
+                    port = &ports[num_ports++];
+                    port->interface = control_interface;
+                    port->in_ep = 0;
+                    port->out_ep = 0;
+                    port->notification_ep = (interface_class == USB_CLASS_CDC_DATA) ? notification_ep : 0;
+                    port->serial_state = 0;
+                    sim_queue_clear (&port->to_device);
+                    sim_queue_clear (&port->from_device);
+                }
+                port = &ports[num_ports - 1];
+                if ((endpoint->bEndpointAddress & USB_EP_DESC_IN) != 0)
+                {
+                    port->in_ep = ep_index;
+                }
+                else
+                {
+                    port->out_ep = ep_index;
+                }
+            }
+        }
+        offset += descriptor[0];
+    }
+}
+
+
+static void enumeration_get_device (void)
+{
+    const tUSBRequest request =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_GET_DESCRIPTOR, .wValue = USB_DTYPE_DEVICE << 8, .wIndex = 0, .wLength = 18
+    };
+
+    start_control (&request, NULL, enumeration_get_configuration);
+}
+
+
+static void enumeration_get_configuration (void)
+{
+    const tUSBRequest request =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_GET_DESCRIPTOR, .wValue = USB_DTYPE_CONFIGURATION << 8, .wIndex = 0,
+        .wLength = sizeof (config_descriptor)
+    };
+
+    if (control.result != 18)
+    {
+        sim_fail ("the device descriptor was %d bytes", control.result);
+    }
+    start_control (&request, NULL, enumeration_set_configuration);
+}
+
+
+static void enumeration_set_configuration (void)
+{
+    const tUSBRequest request =
+    {
+        .bmRequestType = USB_RTYPE_DIR_OUT | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_SET_CONFIG, .wValue = 1, .wIndex = 0, .wLength = 0
+    };
+    const tConfigDescriptor *const header = (const tConfigDescriptor *) control.data;
+
+    if ((control.result < (int32_t) sizeof (tConfigDescriptor)) || (header->wTotalLength != control.result))
+    {
+        sim_fail ("the configuration descriptor was %d bytes", control.result);
+    }
+    config_descriptor_length = (uint32_t) control.result;
+    memcpy (config_descriptor, control.data, config_descriptor_length);
+    parse_config_descriptor ();
+    start_control (&request, NULL, enumeration_configured);
+}
+
+
+static void enumeration_configured (void)
+{
+    if (control.result != 0)
+    {
+        sim_fail ("SET_CONFIGURATION failed");
+    }
+    host_state = SIM_USB_HOST_CONFIGURED;
+}
+
+
+static void connect_handler (void *context)
+{
+    (void) context;
+
+    /* Reset the device, then start sending frames and enumerate */
+    host_state = SIM_USB_HOST_ENUMERATING;
+    num_ports = 0;
+    raise_interrupt (SIM_USB_INT_RESET);
+    sim_event_schedule (&frame_event, sim_now + SIM_USB_RESET_CYCLES);
+    enumeration_get_device ();
+}
+
+
+static void frame_handler (void *context)
+{
+    (void) context;
+
+    /* A transaction which ends as the frame ends completes before the SOF */
+    complete_bulk_transaction ();
+    frame_number = (frame_number + 1) & 0x7FF;
+    frame_start = sim_now;
+    frames_running = true;
+    sim_event_schedule (&frame_event, sim_now + SIM_USB_FRAME_CYCLES);
+    raise_interrupt (SIM_USB_INT_SOF);
+    notifications_polled = false;
+    consecutive_naks = 0;
+
+    /* Transactions start once the SOF packet has been sent */
+    sim_event_schedule (&transaction_event, sim_now + transaction_cycles (3));
+}
+
+
+static void suspend_handler (void *context)
+{
+    (void) context;
+    raise_interrupt (SIM_USB_INT_SUSPEND);
+}
+
+
+/**
+ * @brief Perform the next phase of the control transfer
+ * @return The bus cycles used, or zero if the control transfer is waiting for the device
+ */
+static sim_time_t control_transaction (void)
+{
+    sim_time_t cycles = 0;
+    void (*done) (void);
+
+    switch (control.phase)
+    {
+    case SIM_USB_CONTROL_SETUP:
+        control.setup_ready = true;
+        control.phase = SIM_USB_CONTROL_WAIT_DEVICE;
+        raise_ep_interrupt (SIM_USB_INTEP_0);
+        cycles = transaction_cycles (sizeof (tUSBRequest));
+        break;
+
+    case SIM_USB_CONTROL_OUT_DATA:
+        if (!control.out_data_ready)
+        {
+            control.out_data_ready = true;
+            raise_ep_interrupt (SIM_USB_INTEP_0);
+            cycles = transaction_cycles (control.request.wLength);
+        }
+        break;
+
+    case SIM_USB_CONTROL_STATUS:
+        control.phase = SIM_USB_CONTROL_DONE;
+        cycles = transaction_cycles (control.length);
+        done = control.done;
+        control.done = NULL;
+        if (done != NULL)
+        {
+            done ();
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return cycles;
+}
+
+
+/**
+ * @brief Poll the CDC notification endpoints, once per frame
+ * @return The bus cycles used
+ */
+static sim_time_t notification_transactions (void)
+{
+    sim_time_t cycles = 0;
+
+    for (uint32_t port_index = 0; port_index < num_ports; port_index++)
+    {
+        sim_usb_port_t *const port = &ports[port_index];
+        sim_usb_endpoint_t *const endpoint = &in_endpoints[port->notification_ep];
+
+        if ((port->notification_ep != 0) && endpoint->configured)
+        {
+            if (endpoint->count > 0)
+            {
+                const uint8_t *const packet = endpoint->packets[endpoint->head];
+
+                if (endpoint->lengths[endpoint->head] >= 10)
+                {
+                    port->serial_state = packet[8] | (packet[9] << 8);
+                    port->stats.notifications++;
+                }
+                cycles += transaction_cycles (endpoint->lengths[endpoint->head]);
+                endpoint->head = (endpoint->head + 1) % 2;
+                endpoint->count--;
+                if (endpoint->send_pending)
+                {
+                    endpoint->send_pending = false;
+                    raise_ep_interrupt (USB_INTEP_DEV_IN (port->notification_ep));
+                }
+            }
+            else
+            {
+                cycles += nak_cycles ();
+            }
+        }
+    }
+
+    return cycles;
+}
+
+
+/**
+ * @brief Count a packet in the per-frame statistics of one direction
+ */
+static void count_frame_packet (uint32_t *const packet_frame_number, uint32_t *const frame_packets,
+                                uint64_t *const active_frames, uint32_t *const max_per_frame)
+{
+    if ((*frame_packets == 0) || (*packet_frame_number != frame_number))
+    {
+        *packet_frame_number = frame_number;
+        *frame_packets = 0;
+        (*active_frames)++;
+    }
+    (*frame_packets)++;
+    if (*frame_packets > *max_per_frame)
+    {
+        *max_per_frame = *frame_packets;
+    }
+}
+
+
+/**
+ * @brief Attempt an OUT transaction on the bulk endpoint of a port
+ * @details The packet is placed in the FIFO by complete_bulk_transaction() at the end of the transaction.
+ * @return The bus cycles used
+ */
+static sim_time_t out_transaction (sim_usb_port_t *const port)
+{
+    const sim_usb_endpoint_t *const endpoint = &out_endpoints[port->out_ep];
+
+    if (!endpoint->configured || (endpoint->count == fifo_slots (endpoint)))
+    {
+        port->stats.out_naks++;
+        consecutive_naks++;
+        return transaction_cycles (SIM_USB_MAX_PACKET);
+    }
+
+    bulk_transaction.port = port;
+    bulk_transaction.in = false;
+    bulk_transaction.length = (uint32_t) sim_queue_pop (&port->to_device, bulk_transaction.packet,
+                                                        endpoint->max_packet_size);
+    consecutive_naks = 0;
+
+    return transaction_cycles (bulk_transaction.length);
+}
+
+
+/**
+ * @brief Attempt an IN transaction on the bulk endpoint of a port
+ * @details The packet is removed from the FIFO by complete_bulk_transaction() at the end of the transaction.
+ * @return The bus cycles used
+ */
+static sim_time_t in_transaction (sim_usb_port_t *const port)
+{
+    const sim_usb_endpoint_t *const endpoint = &in_endpoints[port->in_ep];
+
+    if (!endpoint->configured || (endpoint->count == 0))
+    {
+        port->stats.in_naks++;
+        consecutive_naks++;
+        return nak_cycles ();
+    }
+
+    bulk_transaction.port = port;
+    bulk_transaction.in = true;
+    consecutive_naks = 0;
+
+    return transaction_cycles (endpoint->lengths[endpoint->head]);
+}
+
+
+/**
+ * @brief Move the packet of the bulk transaction which has just completed into or out of its endpoint FIFO, and
+ *        raise the endpoint interrupt
+ * @details The packet is discarded if the endpoint was reset during the transaction.
+ */
+static void complete_bulk_transaction (void)
+{
+    sim_usb_port_t *const port = bulk_transaction.port;
+    sim_usb_endpoint_t *endpoint;
+    uint32_t slot;
+
+    if (port == NULL)
+    {
+        return;
+    }
+    bulk_transaction.port = NULL;
+
+    if (!bulk_transaction.in)
+    {
+        endpoint = &out_endpoints[port->out_ep];
+        if (!endpoint->configured || (endpoint->count == fifo_slots (endpoint)))
+        {
+            return;
+        }
+        slot = (endpoint->head + endpoint->count) % 2;
+        memcpy (endpoint->packets[slot], bulk_transaction.packet, bulk_transaction.length);
+        endpoint->lengths[slot] = bulk_transaction.length;
+        endpoint->count++;
+        if (endpoint->count == 1)
+        {
+            endpoint->read_offset = 0;
+            raise_ep_interrupt (USB_INTEP_DEV_OUT (port->out_ep));
+        }
+        port->stats.out_packets++;
+        port->stats.out_bytes += bulk_transaction.length;
+        count_frame_packet (&port->out_frame_number, &port->out_frame_packets, &port->stats.out_active_frames,
+                            &port->stats.max_out_packets_per_frame);
+    }
+    else
+    {
+        endpoint = &in_endpoints[port->in_ep];
+        if (!endpoint->configured || (endpoint->count == 0))
+        {
+            return;
+        }
+        sim_queue_push (&port->from_device, endpoint->packets[endpoint->head], endpoint->lengths[endpoint->head]);
+        port->stats.in_packets++;
+        port->stats.in_bytes += endpoint->lengths[endpoint->head];
+        endpoint->head = (endpoint->head + 1) % 2;
+        endpoint->count--;
+        if (endpoint->send_pending)
+        {
+            endpoint->send_pending = false;
+            raise_ep_interrupt (USB_INTEP_DEV_IN (port->in_ep));
+        }
+        count_frame_packet (&port->in_frame_number, &port->in_frame_packets, &port->stats.in_active_frames,
+                            &port->stats.max_in_packets_per_frame);
+    }
+}
+
+
+/**
+ * @brief Determine if the host has a transfer outstanding on a bulk pipe, where even pipes are OUT and odd IN
+ */
+static bool pipe_active (const uint32_t pipe)
+{
+    const sim_usb_port_t *const port = &ports[pipe / 2];
+
+    if ((pipe % 2) == 0)
+    {
+        return sim_queue_length (&port->to_device) > 0;
+    }
+
+    return (sim_queue_length (&port->from_device) + SIM_USB_MAX_PACKET) <= port->read_limit;
+}
+
+
+/**
+ * @brief Perform the next transaction in the current frame
+ */
+static void transaction_handler (void *context)
+{
+    const sim_time_t frame_end = frame_start + SIM_USB_FRAME_CYCLES;
+    sim_time_t cycles = 0;
+    uint32_t num_active_pipes = 0;
+
+    (void) context;
+    complete_bulk_transaction ();
+    if (suspended)
+    {
+        return;
+    }
+
+    /* Control transfers and the notification endpoints take priority over the bulk endpoints */
+    if ((control.phase != SIM_USB_CONTROL_IDLE) && (control.phase != SIM_USB_CONTROL_DONE))
+    {
+        cycles = control_transaction ();
+    }
+    if ((cycles == 0) && !notifications_polled && (host_state == SIM_USB_HOST_CONFIGURED))
+    {
+        notifications_polled = true;
+        cycles = notification_transactions ();
+    }
+
+    if ((cycles == 0) && (host_state == SIM_USB_HOST_CONFIGURED))
+    {
+        for (uint32_t pipe = 0; pipe < (2 * num_ports); pipe++)
+        {
+            num_active_pipes += pipe_active (pipe) ? 1 : 0;
+        }
+        if (num_active_pipes > 0)
+        {
+            if (consecutive_naks >= num_active_pipes)
+            {
+                /* Every active pipe was NAKed, so retry in the next microframe */
+                consecutive_naks = 0;
+                if ((sim_now + SIM_USB_MICROFRAME_CYCLES) < frame_end)
+                {
+                    sim_event_schedule (&transaction_event, sim_now + SIM_USB_MICROFRAME_CYCLES);
+                }
+                return;
+            }
+
+            while (!pipe_active (round_robin_index))
+            {
+                round_robin_index = (round_robin_index + 1) % (2 * num_ports);
+            }
+            if ((sim_now + transaction_cycles (SIM_USB_MAX_PACKET)) > frame_end)
+            {
+                /* No time left in the frame for a maximum-sized packet */
+                return;
+            }
+            cycles = ((round_robin_index % 2) == 0) ? out_transaction (&ports[round_robin_index / 2]) :
+                    in_transaction (&ports[round_robin_index / 2]);
+            round_robin_index = (round_robin_index + 1) % (2 * num_ports);
+        }
+    }
+
+    if ((cycles > 0) && (((sim_now + cycles) < frame_end) || (bulk_transaction.port != NULL)))
+    {
+        sim_event_schedule (&transaction_event, sim_now + cycles);
+    }
+}
+
+
+bool sim_usb_host_configured (void)
+{
+    return host_state == SIM_USB_HOST_CONFIGURED;
+}
+
+
+uint32_t sim_usb_host_num_ports (void)
+{
+    return num_ports;
+}
+
+
+/**
+ * @return The interface number to use in wIndex for class or vendor requests to a port
+ */
+uint8_t sim_usb_host_port_interface (const uint32_t port)
+{
+    return find_port (port)->interface;
+}
+
+
+/**
+ * @brief Queue data to be sent by the host on the bulk OUT endpoint of a port, as maximum-sized packets
+ */
+void sim_usb_host_write (const uint32_t port, const void *const data, const size_t length)
+{
+    sim_queue_push (&find_port (port)->to_device, data, length);
+    kick_transactions ();
+}
+
+
+/**
+ * @return The bytes written by the host on a port which the device has yet to accept
+ */
+size_t sim_usb_host_write_pending (const uint32_t port)
+{
+    sim_usb_port_t *const host_port = find_port (port);
+    const bool in_transaction = (bulk_transaction.port == host_port) && !bulk_transaction.in;
+
+    return sim_queue_length (&host_port->to_device) + (in_transaction ? bulk_transaction.length : 0);
+}
+
+
+/**
+ * @brief Read the data the host has received on the bulk IN endpoint of a port
+ */
+size_t sim_usb_host_read (const uint32_t port, void *const data, const size_t max_length)
+{
+    const size_t length = sim_queue_pop (&find_port (port)->from_device, data, max_length);
+
+    kick_transactions ();
+    return length;
+}
+
+
+size_t sim_usb_host_read_available (const uint32_t port)
+{
+    return sim_queue_length (&find_port (port)->from_device);
+}
+
+
+/**
+ * @brief Limit the bytes the host buffers from a port, beyond which it stops reading the IN endpoint
+ * @details Models an application which isn't reading as fast as the device sends. SIZE_MAX removes the limit.
+ */
+void sim_usb_host_set_read_limit (const uint32_t port, const size_t limit)
+{
+    find_port (port)->read_limit = limit;
+    kick_transactions ();
+}
+
+
+/**
+ * @return The serial state from the last CDC SERIAL_STATE notification on a port
+ */
+uint16_t sim_usb_host_serial_state (const uint32_t port)
+{
+    return find_port (port)->serial_state;
+}
+
+
+static bool control_done (void *arg)
+{
+    (void) arg;
+    return control.phase == SIM_USB_CONTROL_DONE;
+}
+
+
+/**
+ * @brief Perform a control transfer, running the firmware until the device completes it
+ * @param[in] request The setup packet
+ * @param[in,out] data For a host-to-device request the wLength bytes of the data stage, or for a device-to-host
+ *                     request receives up to wLength bytes
+ * @return The number of bytes in the data stage, or -1 if the device stalled the request
+ */
+int32_t sim_usb_host_control (const tUSBRequest *const request, void *const data)
+{
+    if (host_state != SIM_USB_HOST_CONFIGURED)
+    {
+        sim_fail ("control request 0x%02x sent before the device was configured", request->bRequest);
+    }
+    if (request->wLength > SIM_USB_MAX_CONTROL_DATA)
+    {
+        sim_fail ("control request 0x%02x wLength %u is too long", request->bRequest, request->wLength);
+    }
+
+    start_control (request, data, NULL);
+    if (!sim_run_until (control_done, NULL, SIM_USB_CONTROL_TIMEOUT))
+    {
+        sim_fail ("control request 0x%02x wasn't completed by the device", request->bRequest);
+    }
+    control.phase = SIM_USB_CONTROL_IDLE;
+    if ((control.result > 0) && ((request->bmRequestType & USB_RTYPE_DIR_IN) != 0))
+    {
+        memcpy (data, control.data, (size_t) control.result);
+    }
+
+    return control.result;
+}
+
+
+/**
+ * @brief Suspend or resume the bus
+ * @details The device detects the suspend once the bus has been idle for 3 ms, and the resume signalling
+ *          interrupts it immediately, with frames restarting after the 20 ms of resume signalling.
+ */
+void sim_usb_host_suspend (const bool suspend)
+{
+    initialise_models ();
+    if (suspend == suspended)
+    {
+        return;
+    }
+
+    suspended = suspend;
+    if (suspend)
+    {
+        frames_running = false;
+        sim_event_cancel (&frame_event);
+        sim_event_cancel (&transaction_event);
+        complete_bulk_transaction ();
+        sim_event_schedule (&suspend_event, sim_now + SIM_USB_SUSPEND_DETECT_CYCLES);
+    }
+    else
+    {
+        if (sim_event_scheduled (&suspend_event))
+        {
+            sim_event_cancel (&suspend_event);
+        }
+        else
+        {
+            raise_interrupt (SIM_USB_INT_RESUME);
+        }
+        if (host_state != SIM_USB_HOST_DETACHED)
+        {
+            sim_event_schedule (&frame_event, sim_now + SIM_MS (20));
+        }
+    }
+}
+
+
+uint32_t sim_usb_host_frame_number (void)
+{
+    return frame_number;
+}
+
+
+const sim_usb_port_stats_t *sim_usb_host_port_stats (const uint32_t port)
+{
+    return &find_port (port)->stats;
+}
+
+
+void sim_usb_host_port_stats_clear (const uint32_t port)
+{
+    sim_usb_port_t *const usb_port = find_port (port);
+
+    usb_port->stats = (sim_usb_port_stats_t) {0};
+    usb_port->in_frame_packets = 0;
+    usb_port->out_frame_packets = 0;
+}
+
+
+/*
+ * The device controller, as used by the usblib stand-in
+ */
+
+static sim_usb_endpoint_t *find_endpoint (const uint32_t ep_index, const bool in)
+{
+    if ((ep_index == 0) || (ep_index >= SIM_USB_NUM_EPS))
+    {
+        sim_fail ("USB endpoint %u isn't a data endpoint", ep_index);
+    }
+
+    return in ? &in_endpoints[ep_index] : &out_endpoints[ep_index];
+}
+
+
+/**
+ * @brief Connect the device to the bus, after which the host resets and enumerates it
+ */
+void sim_usb_dev_connect (void)
+{
+    sim_consume (20);
+    sim_peripheral_check (SYSCTL_PERIPH_USB0, __func__);
+    initialise_models ();
+    if (!connected)
+    {
+        connected = true;
+        sim_event_schedule (&connect_event, sim_now + SIM_USB_CONNECT_DEBOUNCE_CYCLES);
+    }
+}
+
+
+/**
+ * @brief Read and clear the general interrupt status, as SIM_USB_INT_ flags
+ */
+uint32_t sim_usb_dev_int_status (void)
+{
+    const uint32_t status = int_status;
+
+    /* The read clears the register at once, so an interrupt raised by a handler which pre-empts the time taken by
+     * the read is kept */
+    int_status = 0;
+    update_interrupt ();
+    sim_consume (4);
+
+    return status;
+}
+
+
+/**
+ * @brief Read and clear the endpoint interrupt status, as USB_INTEP_DEV_IN() and USB_INTEP_DEV_OUT() flags
+ */
+uint32_t sim_usb_dev_ep_int_status (void)
+{
+    const uint32_t status = ep_int_status;
+
+    /* Cleared before the time taken by the read, as for sim_usb_dev_int_status() */
+    ep_int_status = 0;
+    update_interrupt ();
+    sim_consume (4);
+
+    return status;
+}
+
+
+/**
+ * @brief Configure an endpoint when the host sets the configuration, with a single-buffered FIFO
+ */
+void sim_usb_dev_ep_configure (const uint32_t ep_index, const bool in, const uint32_t max_packet_size,
+                               const uint32_t fifo_address)
+{
+    sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, in);
+    uint32_t size_code = 0;
+
+    sim_consume (8);
+    while ((uint32_t) USBFIFOSizeToBytes (size_code) < max_packet_size)
+    {
+        size_code++;
+    }
+    *endpoint = (sim_usb_endpoint_t) {0};
+    endpoint->configured = true;
+    endpoint->max_packet_size = max_packet_size;
+    endpoint->fifo_address = fifo_address;
+    endpoint->fifo_size = size_code;
+}
+
+
+/**
+ * @return The size of the packet waiting to be read from an OUT endpoint, or zero if none
+ */
+uint32_t sim_usb_dev_rx_available (const uint32_t ep_index)
+{
+    const sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, false);
+
+    sim_consume (4);
+    return (endpoint->count > 0) ? (endpoint->lengths[endpoint->head] - endpoint->read_offset) : 0;
+}
+
+
+/**
+ * @brief Read bytes of the packet waiting in an OUT endpoint FIFO
+ * @return The number of bytes read
+ */
+uint32_t sim_usb_dev_read (const uint32_t ep_index, uint8_t *const data, const uint32_t length)
+{
+    sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, false);
+    uint32_t num_read = 0;
+
+    if (endpoint->count > 0)
+    {
+        num_read = endpoint->lengths[endpoint->head] - endpoint->read_offset;
+        if (num_read > length)
+        {
+            num_read = length;
+        }
+        memcpy (data, &endpoint->packets[endpoint->head][endpoint->read_offset], num_read);
+        endpoint->read_offset += num_read;
+    }
+    /* The FIFO is read a word at a time */
+    sim_consume (4 + num_read);
+
+    return num_read;
+}
+
+
+/**
+ * @brief Release the packet read from an OUT endpoint FIFO, after which the next packet in a double-buffered FIFO
+ *        is ready to read
+ */
+void sim_usb_dev_rx_ack (const uint32_t ep_index)
+{
+    sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, false);
+
+    sim_consume (4);
+    if (endpoint->count > 0)
+    {
+        endpoint->head = (endpoint->head + 1) % 2;
+        endpoint->count--;
+        endpoint->read_offset = 0;
+        if (endpoint->count > 0)
+        {
+            raise_ep_interrupt (USB_INTEP_DEV_OUT (ep_index));
+        }
+    }
+    kick_transactions ();
+}
+
+
+/**
+ * @return True if the IN endpoint FIFO can accept a packet from the firmware
+ */
+bool sim_usb_dev_tx_ready (const uint32_t ep_index)
+{
+    const sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, true);
+
+    sim_consume (4);
+    return endpoint->configured && (endpoint->count < fifo_slots (endpoint));
+}
+
+
+/**
+ * @brief Write bytes of the next packet into an IN endpoint FIFO
+ * @return False if the FIFO is full, as the hardware refuses the write when the packet ready flag is set
+ */
+bool sim_usb_dev_write (const uint32_t ep_index, const uint8_t *const data, const uint32_t length)
+{
+    sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, true);
+
+    sim_consume (4 + length);
+    if (!endpoint->configured || (endpoint->count == fifo_slots (endpoint)))
+    {
+        return false;
+    }
+    if ((endpoint->loading_length + length) > endpoint->max_packet_size)
+    {
+        sim_fail ("wrote %u bytes to USB IN endpoint %u, which has a maximum packet size of %u",
+                  endpoint->loading_length + length, ep_index, endpoint->max_packet_size);
+    }
+
+    memcpy (&endpoint->loading[endpoint->loading_length], data, length);
+    endpoint->loading_length += length;
+
+    return true;
+}
+
+
+/**
+ * @brief Mark the packet written into an IN endpoint FIFO as ready to send
+ * @details The endpoint interrupts once the packet has left the half of the FIFO it was written to, which is
+ *          immediately when the other half of a double-buffered FIFO is free.
+ */
+void sim_usb_dev_tx_send (const uint32_t ep_index)
+{
+    sim_usb_endpoint_t *const endpoint = find_endpoint (ep_index, true);
+    const uint32_t slot = (endpoint->head + endpoint->count) % 2;
+
+    sim_consume (4);
+    if (endpoint->count == fifo_slots (endpoint))
+    {
+        sim_fail ("sent a packet on USB IN endpoint %u when its FIFO was full", ep_index);
+    }
+
+    memcpy (endpoint->packets[slot], endpoint->loading, endpoint->loading_length);
+    endpoint->lengths[slot] = endpoint->loading_length;
+    endpoint->loading_length = 0;
+    endpoint->count++;
+    if (endpoint->count < fifo_slots (endpoint))
+    {
+        raise_ep_interrupt (USB_INTEP_DEV_IN (ep_index));
+    }
+    else
+    {
+        endpoint->send_pending = true;
+    }
+    kick_transactions ();
+}
+
+
+/**
+ * @brief Read the setup packet received on endpoint 0
+ * @return True if a setup packet was waiting
+ */
+bool sim_usb_dev_setup_get (tUSBRequest *const request)
+{
+    sim_consume (8);
+    if (!control.setup_ready)
+    {
+        return false;
+    }
+
+    control.setup_ready = false;
+    *request = control.request;
+    return true;
+}
+
+
+/**
+ * @brief Send the data stage of a device-to-host control request, which completes the request
+ */
+void sim_usb_dev_ep0_send (const void *const data, const uint32_t length)
+{
+    sim_consume (8 + length);
+    if (control.phase != SIM_USB_CONTROL_WAIT_DEVICE)
+    {
+        sim_fail ("endpoint 0 data sent without a request");
+    }
+    if ((control.request.bmRequestType & USB_RTYPE_DIR_IN) == 0)
+    {
+        sim_fail ("endpoint 0 data sent for host-to-device request 0x%02x", control.request.bRequest);
+    }
+
+    control.length = (length < control.request.wLength) ? length : control.request.wLength;
+    memcpy (control.data, data, control.length);
+    control.result = (int32_t) control.length;
+    control.phase = SIM_USB_CONTROL_STATUS;
+    kick_transactions ();
+}
+
+
+/**
+ * @brief Accept the data stage of a host-to-device control request
+ */
+void sim_usb_dev_ep0_receive (const uint32_t length)
+{
+    sim_consume (8);
+    if ((control.phase != SIM_USB_CONTROL_WAIT_DEVICE) || ((control.request.bmRequestType & USB_RTYPE_DIR_IN) != 0))
+    {
+        sim_fail ("endpoint 0 data requested without a host-to-device request");
+    }
+    if (length != control.request.wLength)
+    {
+        sim_fail ("endpoint 0 data of %u bytes requested for wLength %u", length, control.request.wLength);
+    }
+
+    control.phase = SIM_USB_CONTROL_OUT_DATA;
+    kick_transactions ();
+}
+
+
+/**
+ * @brief Read the data stage of a host-to-device control request
+ * @return True if the data stage has been received
+ */
+bool sim_usb_dev_ep0_received (void *const data, uint32_t *const length)
+{
+    sim_consume (8);
+    if ((control.phase != SIM_USB_CONTROL_OUT_DATA) || !control.out_data_ready)
+    {
+        return false;
+    }
+
+    sim_consume (control.request.wLength);
+    memcpy (data, control.data, control.request.wLength);
+    *length = control.request.wLength;
+    control.length = control.request.wLength;
+    control.out_data_ready = false;
+    control.phase = SIM_USB_CONTROL_WAIT_DEVICE;
+    return true;
+}
+
+
+/**
+ * @brief Complete a control request without a device-to-host data stage
+ */
+void sim_usb_dev_ep0_ack (void)
+{
+    sim_consume (4);
+    if (control.phase != SIM_USB_CONTROL_WAIT_DEVICE)
+    {
+        sim_fail ("endpoint 0 acknowledged without a request");
+    }
+
+    control.result = (int32_t) control.length;
+    control.phase = SIM_USB_CONTROL_STATUS;
+    kick_transactions ();
+}
+
+
+void sim_usb_dev_ep0_stall (void)
+{
+    sim_consume (4);
+    if ((control.phase != SIM_USB_CONTROL_WAIT_DEVICE) && (control.phase != SIM_USB_CONTROL_OUT_DATA))
+    {
+        sim_fail ("endpoint 0 stalled without a request");
+    }
+
+    control.length = 0;
+    control.result = -1;
+    control.phase = SIM_USB_CONTROL_STATUS;
+    kick_transactions ();
+}
+
+
+/*
+ * driverlib functions
+ */
+
+static sim_usb_endpoint_t *access_endpoint (const uint32_t base, const uint32_t endpoint, const uint32_t flags,
+                                            const char *const function)
+{
+    if (base != USB0_BASE)
+    {
+        sim_fail ("%s: USB controller 0x%x isn't modelled", function, base);
+    }
+    sim_consume (8);
+    sim_peripheral_check (SYSCTL_PERIPH_USB0, function);
+
+    return find_endpoint (USBEPToIndex (endpoint), (flags & USB_EP_DEV_IN) != 0);
+}
+
+
+void USBFIFOConfigSet (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t ui32FIFOAddress, uint32_t ui32FIFOSize,
+                       uint32_t ui32Flags)
+{
+    sim_usb_endpoint_t *const endpoint = access_endpoint (ui32Base, ui32Endpoint, ui32Flags, __func__);
+
+    endpoint->fifo_address = ui32FIFOAddress;
+    endpoint->fifo_size = ui32FIFOSize;
+    if ((fifo_bytes (endpoint) < endpoint->max_packet_size) ||
+        ((endpoint->fifo_address + fifo_bytes (endpoint)) > SIM_USB_FIFO_RAM_SIZE))
+    {
+        sim_fail ("invalid FIFO at %u of size 0x%x for USB endpoint 0x%x", ui32FIFOAddress, ui32FIFOSize,
+                  ui32Endpoint);
+    }
+
+    /* Check the FIFO doesn't overlap that of another endpoint in use, or endpoint 0 at the start of the RAM */
+    if (endpoint->fifo_address < SIM_USB_MAX_PACKET)
+    {
+        sim_fail ("the FIFO of USB endpoint 0x%x overlaps endpoint 0", ui32Endpoint);
+    }
+    for (uint32_t ep_index = 1; ep_index < SIM_USB_NUM_EPS; ep_index++)
+    {
+        for (uint32_t direction = 0; direction < 2; direction++)
+        {
+            const sim_usb_endpoint_t *const other = (direction == 0) ? &in_endpoints[ep_index] :
+                    &out_endpoints[ep_index];
+
+            if ((other != endpoint) && other->configured &&
+                (other->fifo_address < (endpoint->fifo_address + fifo_bytes (endpoint))) &&
+                (endpoint->fifo_address < (other->fifo_address + fifo_bytes (other))))
+            {
+                sim_fail ("the FIFO of USB endpoint 0x%x overlaps that of %s endpoint %u", ui32Endpoint,
+                          (direction == 0) ? "IN" : "OUT", ep_index);
+            }
+        }
+    }
+}
+
+
+void USBFIFOConfigGet (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t *pui32FIFOAddress, uint32_t *pui32FIFOSize,
+                       uint32_t ui32Flags)
+{
+    const sim_usb_endpoint_t *endpoint;
+
+    /* driverlib allows for 16 endpoints, but those above the 8 of the TM4C123 have registers which read as zero */
+    if ((USBEPToIndex (ui32Endpoint) >= SIM_USB_NUM_EPS) && (USBEPToIndex (ui32Endpoint) < NUM_USB_EP))
+    {
+        sim_consume (8);
+        *pui32FIFOAddress = 0;
+        *pui32FIFOSize = 0;
+        return;
+    }
+
+    endpoint = access_endpoint (ui32Base, ui32Endpoint, ui32Flags, __func__);
+
+    *pui32FIFOAddress = endpoint->fifo_address;
+    *pui32FIFOSize = endpoint->fifo_size;
+}
+
+
+/**
+ * @brief Discard one packet from an endpoint FIFO, as the hardware flush does
+ */
+void USBFIFOFlush (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t ui32Flags)
+{
+    sim_usb_endpoint_t *const endpoint = access_endpoint (ui32Base, ui32Endpoint, ui32Flags, __func__);
+
+    if (endpoint->count > 0)
+    {
+        if ((ui32Flags & USB_EP_DEV_IN) != 0)
+        {
+            /* The most recently written packet is discarded */
+            endpoint->send_pending = false;
+        }
+        else
+        {
+            endpoint->head = (endpoint->head + 1) % 2;
+            endpoint->read_offset = 0;
+        }
+        endpoint->count--;
+    }
+    endpoint->loading_length = 0;
+}
+
+
+uint32_t USBFrameNumberGet (uint32_t ui32Base)
+{
+    (void) ui32Base;
+    sim_consume (4);
+    return frame_number;
+}
+
+
+void USBDevConnect (uint32_t ui32Base)
+{
+    (void) ui32Base;
+    sim_usb_dev_connect ();
+}
+
+
+/**
+ * @brief Disconnect the device from the bus
+ * @details Only modelled while the host is debouncing the connection, so the host never sees the device.
+ */
+void USBDevDisconnect (uint32_t ui32Base)
+{
+    (void) ui32Base;
+    sim_consume (20);
+    if (connected)
+    {
+        if (!sim_event_scheduled (&connect_event))
+        {
+            sim_fail ("USB device disconnected after the host saw the connection, which isn't modelled");
+        }
+        sim_event_cancel (&connect_event);
+        connected = false;
+    }
+}
+
+
+/**
+ * @brief Acknowledge the data received on an endpoint
+ * @details For endpoint 0 bIsLastPacket is set when the request has no data stage, which completes it.
+ *          Otherwise acknowledging the setup packet before the data stage has no effect in the model.
+ */
+void USBDevEndpointDataAck (uint32_t ui32Base, uint32_t ui32Endpoint, bool bIsLastPacket)
+{
+    (void) ui32Base;
+    if (ui32Endpoint == USB_EP_0)
+    {
+        if (bIsLastPacket)
+        {
+            sim_usb_dev_ep0_ack ();
+        }
+        else
+        {
+            sim_consume (4);
+        }
+    }
+    else
+    {
+        sim_usb_dev_rx_ack (USBEPToIndex (ui32Endpoint));
+    }
+}
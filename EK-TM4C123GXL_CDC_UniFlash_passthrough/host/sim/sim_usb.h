@@ -0,0 +1,105 @@
+/*
+ * @file sim_usb.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Model of the TM4C123 USB device controller and of the full-speed USB host, for the host simulation
+ * @details
+ *  The controller has endpoint 0 plus 7 IN and 7 OUT endpoints, each with a FIFO in 2 KB of endpoint FIFO RAM
+ *  which holds one packet, or two when double-buffered. A packet is only moved on the bus when the FIFO can
+ *  supply or accept it, otherwise the host is NAKed. A packet enters or leaves the FIFO at the end of its
+ *  transaction, so a single-buffered FIFO is NAKed by the next transaction on the endpoint unless the firmware has
+ *  handled the packet in between. The endpoint interrupts are raised as in the hardware:
+ *  - An OUT endpoint interrupts when a packet becomes ready to be read.
+ *  - An IN endpoint interrupts when the packet written by the firmware has left the FIFO, which with a
+ *    double-buffered FIFO is as soon as the other half is free.
+ *
+ *  The host enumerates the device once it connects to the bus, and then runs 1 ms frames of 12 Mbit/s
+ *  transactions. Each frame starts with a SOF and carries up to 19 maximum-sized bulk packets, with the bulk
+ *  endpoints served round-robin. When every bulk endpoint was NAKed in a pass, the host retries after one
+ *  125 us microframe, as a host controller behind a transaction translator does.
+ *
+ *  The functions with a bulk IN and OUT endpoint pair are numbered as ports in the order of their interfaces, so
+ *  port 0 is the CDC device for UART1 and the following ports are the SPI passthrough or extra UART channels.
+ *  The test program writes the data sent by the host on each port, and reads what the host has received.
+ *
+ *  The sim_usb_dev_ functions are the interface to the controller from the usblib stand-in in sim_usblib.c.
+ */
+
+#ifndef SIM_USB_H_
+#define SIM_USB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "usblib/usblib.h"
+#include "usblib/device/usbdevice.h"
+
+/** The maximum number of functions with bulk endpoints */
+#define SIM_USB_MAX_PORTS 4
+
+/** The statistics of one port, from the point of view of the host */
+typedef struct
+{
+    uint64_t out_packets;
+    uint64_t out_bytes;
+    /** OUT transactions NAKed by the device as the endpoint FIFO was full */
+    uint64_t out_naks;
+    uint64_t in_packets;
+    uint64_t in_bytes;
+    /** IN transactions NAKed by the device as it had no packet ready */
+    uint64_t in_naks;
+    /** The number of frames in which an IN packet was received, and the most IN packets received in one frame */
+    uint64_t in_active_frames;
+    uint32_t max_in_packets_per_frame;
+    uint64_t out_active_frames;
+    uint32_t max_out_packets_per_frame;
+    /** The CDC SERIAL_STATE notifications received on the interrupt endpoint */
+    uint32_t notifications;
+} sim_usb_port_stats_t;
+
+/* The test program's view, as the USB host */
+bool sim_usb_host_configured (void);
+uint32_t sim_usb_host_num_ports (void);
+uint8_t sim_usb_host_port_interface (const uint32_t port);
+void sim_usb_host_write (const uint32_t port, const void *const data, const size_t length);
+size_t sim_usb_host_write_pending (const uint32_t port);
+size_t sim_usb_host_read (const uint32_t port, void *const data, const size_t max_length);
+size_t sim_usb_host_read_available (const uint32_t port);
+void sim_usb_host_set_read_limit (const uint32_t port, const size_t limit);
+uint16_t sim_usb_host_serial_state (const uint32_t port);
+int32_t sim_usb_host_control (const tUSBRequest *const request, void *const data);
+void sim_usb_host_suspend (const bool suspended);
+uint32_t sim_usb_host_frame_number (void);
+const sim_usb_port_stats_t *sim_usb_host_port_stats (const uint32_t port);
+void sim_usb_host_port_stats_clear (const uint32_t port);
+
+/* The general interrupts returned by sim_usb_dev_int_status() */
+#define SIM_USB_INT_RESET   0x01
+#define SIM_USB_INT_SUSPEND 0x02
+#define SIM_USB_INT_RESUME  0x04
+#define SIM_USB_INT_SOF     0x08
+
+/* The endpoint 0 bit of the endpoint interrupt status, alongside USB_INTEP_DEV_IN() and USB_INTEP_DEV_OUT() */
+#define SIM_USB_INTEP_0 USB_INTEP_DEV_IN (0)
+
+/* The device controller, as used by the usblib stand-in in the context of the firmware */
+void sim_usb_dev_connect (void);
+uint32_t sim_usb_dev_int_status (void);
+uint32_t sim_usb_dev_ep_int_status (void);
+void sim_usb_dev_ep_configure (const uint32_t ep_index, const bool in, const uint32_t max_packet_size,
+                               const uint32_t fifo_address);
+uint32_t sim_usb_dev_rx_available (const uint32_t ep_index);
+uint32_t sim_usb_dev_read (const uint32_t ep_index, uint8_t *const data, const uint32_t length);
+void sim_usb_dev_rx_ack (const uint32_t ep_index);
+bool sim_usb_dev_tx_ready (const uint32_t ep_index);
+bool sim_usb_dev_write (const uint32_t ep_index, const uint8_t *const data, const uint32_t length);
+void sim_usb_dev_tx_send (const uint32_t ep_index);
+bool sim_usb_dev_setup_get (tUSBRequest *const request);
+void sim_usb_dev_ep0_send (const void *const data, const uint32_t length);
+void sim_usb_dev_ep0_receive (const uint32_t length);
+bool sim_usb_dev_ep0_received (void *const data, uint32_t *const length);
+void sim_usb_dev_ep0_ack (void);
+void sim_usb_dev_ep0_stall (void);
+
+#endif /* SIM_USB_H_ */
@@ -0,0 +1,1369 @@
+/*
+ * @file sim_usblib.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Stand-in for the parts of the TivaWare usblib device stack used by the bridge, for the host simulation
+ * @details
+ *  Implements the device core, the CDC ACM and generic bulk classes and the composite device on the model of the
+ *  USB controller, with the behaviour the firmware depends upon:
+ *  - The class and vendor requests are passed to the pfnRequestHandler in the tDeviceInfo of the class, which the
+ *    firmware replaces, and the data stage of host-to-device requests to its pfnDataReceived.
+ *  - A composite device passes requests with an interface recipient to the class owning the interface, and
+ *    renumbers the interfaces and endpoints of each class in order.
+ *  - The endpoints are given single-buffered FIFOs from the start of the FIFO RAM when the host sets the
+ *    configuration, before the CONNECTED event.
+ *  - A packet write makes the transmit channel busy until USB_EVENT_TX_COMPLETE, and a packet is left in the
+ *    OUT endpoint FIFO until read with bLast set.
+ *  - The CDC SET_LINE_CODING, SET_CONTROL_LINE_STATE and SEND_BREAK events are deferred while the receive
+ *    channel reports USB_EVENT_DATA_REMAINING, and retried on each SOF.
+ *  - Only USBDCDCInit() and USBDBulkInit() patch the VID, PID and power of the device into the descriptors. A
+ *    class initialised by its composite init function and connected directly with USBDCDInit() enumerates with the
+ *    zero VID and PID of the usblib templates.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdcdc.h"
+#include "usblib/device/usbdbulk.h"
+#include "usblib/device/usbdcomp.h"
+
+#include "sim.h"
+#include "sim_usb.h"
+
+/** The maximum packet sizes of the endpoints used by the classes */
+#define SIM_USBLIB_BULK_PACKET_SIZE         64
+#define SIM_USBLIB_NOTIFICATION_PACKET_SIZE 16
+
+/** The size of the configuration descriptor header */
+#define SIM_USBLIB_CONFIG_HEADER_SIZE 9
+
+/** The size of the interface association descriptor, which only precedes a CDC class in a composite device */
+#define SIM_USBLIB_IAD_SIZE 8
+
+/** The power of the configuration descriptor templates of the device classes in usblib, which only USBDCDCInit()
+ *  and USBDBulkInit() replace with the values from the device. The VID and PID of the templates are zero. */
+#define SIM_USBLIB_TEMPLATE_ATTRIBUTES   USB_CONF_ATTR_SELF_PWR
+#define SIM_USBLIB_TEMPLATE_MAX_POWER_MA 500
+
+/* The CDC operations deferred while the receive channel has data remaining, as bits of ui16DeferredOpFlags */
+#define SIM_USBLIB_CDC_DO_LINE_CODING  0x0001
+#define SIM_USBLIB_CDC_DO_LINE_STATE   0x0002
+#define SIM_USBLIB_CDC_DO_SEND_BREAK   0x0004
+#define SIM_USBLIB_CDC_DO_CLEAR_BREAK  0x0008
+#define SIM_USBLIB_CDC_DO_SERIAL_STATE 0x0010
+
+/** The CDC SEND_BREAK duration which sends a break until cleared */
+#define SIM_USBLIB_CDC_BREAK_UNTIL_CLEARED 0xFFFF
+
+/** The serial state bits which are only reported once */
+#define SIM_USBLIB_CDC_SERIAL_STATE_ONE_SHOT (USB_CDC_SERIAL_STATE_OVERRUN | USB_CDC_SERIAL_STATE_PARITY | \
+    USB_CDC_SERIAL_STATE_FRAMING | USB_CDC_SERIAL_STATE_RING_SIGNAL | USB_CDC_SERIAL_STATE_BREAK)
+
+/** The device classes */
+typedef enum
+{
+    SIM_USBLIB_CLASS_CDC,
+    SIM_USBLIB_CLASS_BULK
+} sim_usblib_class_type_t;
+
+/** A device class instance which has been initialised */
+typedef struct
+{
+    sim_usblib_class_type_t type;
+    /** The tUSBDCDCDevice or tUSBDBulkDevice, which is the instance passed to the class handlers */
+    void *device;
+    tDeviceInfo *info;
+    /** The bytes written in the current IN packet, reported with USB_EVENT_TX_COMPLETE */
+    uint32_t tx_size;
+    /** Set by USBDCDCInit() or USBDBulkInit(), which patch the VID, PID and power of the device into the
+     *  descriptors. The composite init functions leave the descriptor templates of usblib unpatched. */
+    bool descriptors_patched;
+} sim_usblib_class_t;
+
+static sim_usblib_class_t classes[SIM_USB_MAX_PORTS];
+static uint32_t num_classes;
+
+/* The device connected by USBDCDInit() */
+static tDeviceInfo *device_info;
+static void *device_instance;
+static tUSBDCompositeDevice *composite_device;
+static uint8_t configuration;
+
+/* The class which owns the current control request, and where its data stage is to be stored */
+static tDeviceInfo *ep0_owner_info;
+static void *ep0_owner_instance;
+static uint8_t *ep0_out_data;
+static bool ep0_out_pending;
+
+/** Used to build the descriptors returned to the host */
+static uint8_t descriptor_buffer[512];
+
+
+static sim_usblib_class_t *find_class (const void *const device)
+{
+    for (uint32_t class_index = 0; class_index < num_classes; class_index++)
+    {
+        if (classes[class_index].device == device)
+        {
+            return &classes[class_index];
+        }
+    }
+    sim_fail ("usblib called for a device instance which hasn't been initialised");
+}
+
+
+static sim_usblib_class_t *find_class_by_info (const tDeviceInfo *const info)
+{
+    for (uint32_t class_index = 0; class_index < num_classes; class_index++)
+    {
+        if (classes[class_index].info == info)
+        {
+            return &classes[class_index];
+        }
+    }
+    sim_fail ("composite entry for a device which hasn't been initialised");
+}
+
+
+static sim_usblib_class_t *register_class (const sim_usblib_class_type_t type, void *const device,
+                                           tDeviceInfo *const info)
+{
+    sim_usblib_class_t *usb_class;
+
+    for (uint32_t class_index = 0; class_index < num_classes; class_index++)
+    {
+        if (classes[class_index].device == device)
+        {
+            return &classes[class_index];
+        }
+    }
+    if (num_classes == SIM_USB_MAX_PORTS)
+    {
+        sim_fail ("too many usblib device classes");
+    }
+
+    usb_class = &classes[num_classes++];
+    usb_class->descriptors_patched = false;
+    usb_class->type = type;
+    usb_class->device = device;
+    usb_class->info = info;
+    return usb_class;
+}
+
+
+/*
+ * Descriptors
+ */
+
+static uint32_t put_interface (uint8_t *const descriptor, const uint8_t number, const uint8_t num_endpoints,
+                               const uint8_t class_code, const uint8_t subclass, const uint8_t protocol,
+                               const uint8_t string_index)
+{
+    const uint8_t interface[] =
+    {
+        9, USB_DTYPE_INTERFACE, number, 0, num_endpoints, class_code, subclass, protocol, string_index
+    };
+
+    memcpy (descriptor, interface, sizeof (interface));
+    return sizeof (interface);
+}
+
+
+static uint32_t put_endpoint (uint8_t *const descriptor, const uint8_t address, const uint8_t attributes,
+                              const uint16_t max_packet_size, const uint8_t interval)
+{
+    const uint8_t endpoint[] =
+    {
+        7, USB_DTYPE_ENDPOINT, address, attributes, USBShort (max_packet_size), interval
+    };
+
+    memcpy (descriptor, endpoint, sizeof (endpoint));
+    return sizeof (endpoint);
+}
+
+
+/**
+ * @brief Write the configuration descriptor section for a class, laid out as usblib does
+ * @return The length of the section
+ */
+static uint32_t put_class_section (uint8_t *const descriptor, const sim_usblib_class_t *const usb_class,
+                                   const bool composite)
+{
+    uint32_t length = 0;
+
+    if (usb_class->type == SIM_USBLIB_CLASS_CDC)
+    {
+        const tCDCSerInstance *const inst = &((tUSBDCDCDevice *) usb_class->device)->sPrivateData;
+        const uint8_t control = inst->ui8InterfaceControl;
+        const uint8_t data = inst->ui8InterfaceData;
+        const uint8_t functional[] =
+        {
+            /* Header, abstract control management, union and call management functional descriptors */
+            5, USB_DTYPE_CS_INTERFACE, 0x00, USBShort (0x0110),
+            4, USB_DTYPE_CS_INTERFACE, 0x02, 0x06,
+            5, USB_DTYPE_CS_INTERFACE, 0x06, control, data,
+            5, USB_DTYPE_CS_INTERFACE, 0x01, 0x01, data
+        };
+
+        if (composite)
+        {
+            const uint8_t iad[SIM_USBLIB_IAD_SIZE] =
+            {
+                SIM_USBLIB_IAD_SIZE, USB_DTYPE_INTERFACE_ASC, control, 2, USB_CLASS_CDC, 2, 1, 0
+            };
+
+            memcpy (&descriptor[length], iad, sizeof (iad));
+            length += sizeof (iad);
+        }
+        length += put_interface (&descriptor[length], control, 1, USB_CLASS_CDC, 2, 1, 4);
+        memcpy (&descriptor[length], functional, sizeof (functional));
+        length += sizeof (functional);
+        length += put_endpoint (&descriptor[length], USB_EP_DESC_IN | USBEPToIndex (inst->ui8ControlEndpoint),
+                                USB_EP_ATTR_INT, SIM_USBLIB_NOTIFICATION_PACKET_SIZE, 10);
+        length += put_interface (&descriptor[length], data, 2, USB_CLASS_CDC_DATA, 0, 0, 0);
+        length += put_endpoint (&descriptor[length], USB_EP_DESC_IN | USBEPToIndex (inst->ui8BulkINEndpoint),
+                                USB_EP_ATTR_BULK, SIM_USBLIB_BULK_PACKET_SIZE, 0);
+        length += put_endpoint (&descriptor[length], USBEPToIndex (inst->ui8BulkOUTEndpoint),
+                                USB_EP_ATTR_BULK, SIM_USBLIB_BULK_PACKET_SIZE, 0);
+    }
+    else
+    {
+        const tBulkInstance *const inst = &((tUSBDBulkDevice *) usb_class->device)->sPrivateData;
+
+        length += put_interface (&descriptor[length], inst->ui8Interface, 2, USB_CLASS_VEND_SPECIFIC, 0, 0, 4);
+        length += put_endpoint (&descriptor[length], USB_EP_DESC_IN | USBEPToIndex (inst->ui8INEndpoint),
+                                USB_EP_ATTR_BULK, SIM_USBLIB_BULK_PACKET_SIZE, 0);
+        length += put_endpoint (&descriptor[length], USBEPToIndex (inst->ui8OUTEndpoint),
+                                USB_EP_ATTR_BULK, SIM_USBLIB_BULK_PACKET_SIZE, 0);
+    }
+
+    return length;
+}
+
+
+static uint32_t class_section_size (const sim_usblib_class_t *const usb_class)
+{
+    return (usb_class->type == SIM_USBLIB_CLASS_CDC) ? COMPOSITE_DCDC_SIZE : COMPOSITE_DBULK_SIZE;
+}
+
+
+/**
+ * @brief Build the configuration descriptor of the device
+ * @return The total length
+ */
+static uint32_t build_config_descriptor (uint8_t *const descriptor)
+{
+    uint32_t length = SIM_USBLIB_CONFIG_HEADER_SIZE;
+    uint8_t num_interfaces = 0;
+    uint8_t attributes;
+    uint16_t max_power;
+
+    if (composite_device != NULL)
+    {
+        const tCompositeInstance *const inst = &composite_device->sPrivateData;
+
+        memcpy (&descriptor[length], inst->pui8Data, inst->ui32DataSize);
+        length += inst->ui32DataSize;
+        for (uint32_t entry = 0; entry < composite_device->ui32NumDevices; entry++)
+        {
+            num_interfaces +=
+                    (find_class_by_info (composite_device->psDevices[entry].psDevInfo)->type == SIM_USBLIB_CLASS_CDC) ?
+                            2 : 1;
+        }
+        attributes = composite_device->ui8PwrAttributes;
+        max_power = composite_device->ui16MaxPowermA;
+    }
+    else
+    {
+        const sim_usblib_class_t *const usb_class = find_class (device_instance);
+
+        length += put_class_section (&descriptor[length], usb_class, false);
+        num_interfaces = (usb_class->type == SIM_USBLIB_CLASS_CDC) ? 2 : 1;
+        if (!usb_class->descriptors_patched)
+        {
+            attributes = SIM_USBLIB_TEMPLATE_ATTRIBUTES;
+            max_power = SIM_USBLIB_TEMPLATE_MAX_POWER_MA;
+        }
+        else if (usb_class->type == SIM_USBLIB_CLASS_CDC)
+        {
+            attributes = ((tUSBDCDCDevice *) usb_class->device)->ui8PwrAttributes;
+            max_power = ((tUSBDCDCDevice *) usb_class->device)->ui16MaxPowermA;
+        }
+        else
+        {
+            attributes = ((tUSBDBulkDevice *) usb_class->device)->ui8PwrAttributes;
+            max_power = ((tUSBDBulkDevice *) usb_class->device)->ui16MaxPowermA;
+        }
+    }
+
+    const uint8_t header[SIM_USBLIB_CONFIG_HEADER_SIZE] =
+    {
+        SIM_USBLIB_CONFIG_HEADER_SIZE, USB_DTYPE_CONFIGURATION, USBShort (length), num_interfaces, 1, 5,
+        attributes, (uint8_t) (max_power / 2)
+    };
+    memcpy (descriptor, header, sizeof (header));
+
+    return length;
+}
+
+
+static uint32_t build_device_descriptor (uint8_t *const descriptor)
+{
+    uint16_t vid;
+    uint16_t pid;
+    uint8_t class_code = 0;
+    uint8_t subclass = 0;
+    uint8_t protocol = 0;
+
+    if (composite_device != NULL)
+    {
+        vid = composite_device->ui16VID;
+        pid = composite_device->ui16PID;
+        class_code = 0xEF;
+        subclass = 2;
+        protocol = 1;
+    }
+    else
+    {
+        const sim_usblib_class_t *const usb_class = find_class (device_instance);
+
+        if (usb_class->type == SIM_USBLIB_CLASS_CDC)
+        {
+            vid = ((tUSBDCDCDevice *) usb_class->device)->ui16VID;
+            pid = ((tUSBDCDCDevice *) usb_class->device)->ui16PID;
+            class_code = USB_CLASS_CDC;
+        }
+        else
+        {
+            vid = ((tUSBDBulkDevice *) usb_class->device)->ui16VID;
+            pid = ((tUSBDBulkDevice *) usb_class->device)->ui16PID;
+        }
+        if (!usb_class->descriptors_patched)
+        {
+            vid = 0;
+            pid = 0;
+        }
+    }
+
+    const uint8_t device[18] =
+    {
+        18, USB_DTYPE_DEVICE, USBShort (0x0110), class_code, subclass, protocol, 64,
+        USBShort (vid), USBShort (pid), USBShort (0x0100), 1, 2, 3, 1
+    };
+    memcpy (descriptor, device, sizeof (device));
+
+    return sizeof (device);
+}
+
+
+/*
+ * Device core
+ */
+
+/**
+ * @brief Give each endpoint in the configuration descriptor a single-buffered FIFO, allocated in order from after
+ *        the endpoint 0 FIFO
+ */
+static void configure_endpoints (void)
+{
+    const uint32_t length = build_config_descriptor (descriptor_buffer);
+    uint32_t fifo_address = 64;
+    uint32_t offset = 0;
+
+    while (offset < length)
+    {
+        const tEndpointDescriptor *const endpoint = (const tEndpointDescriptor *) &descriptor_buffer[offset];
+
+        if (endpoint->bDescriptorType == USB_DTYPE_ENDPOINT)
+        {
+            uint32_t fifo_size = 8;
+
+            sim_usb_dev_ep_configure (endpoint->bEndpointAddress & 0x0F,
+                                      (endpoint->bEndpointAddress & USB_EP_DESC_IN) != 0,
+                                      endpoint->wMaxPacketSize, fifo_address);
+            while (fifo_size < endpoint->wMaxPacketSize)
+            {
+                fifo_size *= 2;
+            }
+            fifo_address += fifo_size;
+        }
+        offset += endpoint->bLength;
+    }
+}
+
+
+static void handle_standard_request (const tUSBRequest *const request)
+{
+    switch (request->bRequest)
+    {
+    case USBREQ_GET_DESCRIPTOR:
+        switch (request->wValue >> 8)
+        {
+        case USB_DTYPE_DEVICE:
+            sim_usb_dev_ep0_send (descriptor_buffer, build_device_descriptor (descriptor_buffer));
+            break;
+
+        case USB_DTYPE_CONFIGURATION:
+            sim_usb_dev_ep0_send (descriptor_buffer, build_config_descriptor (descriptor_buffer));
+            break;
+
+        case USB_DTYPE_STRING:
+            if ((request->wValue & 0xFF) < device_info->ui32NumStringDescriptors)
+            {
+                const uint8_t *const string = device_info->ppui8StringDescriptors[request->wValue & 0xFF];
+
+                sim_usb_dev_ep0_send (string, string[0]);
+            }
+            else
+            {
+                sim_usb_dev_ep0_stall ();
+            }
+            break;
+
+        default:
+            sim_usb_dev_ep0_stall ();
+            break;
+        }
+        break;
+
+    case USBREQ_SET_CONFIG:
+        if (request->wValue == 1)
+        {
+            configuration = 1;
+            configure_endpoints ();
+            sim_usb_dev_ep0_ack ();
+            if (device_info->sCallbacks.pfnConfigChange != NULL)
+            {
+                device_info->sCallbacks.pfnConfigChange (device_instance, configuration);
+            }
+        }
+        else
+        {
+            sim_usb_dev_ep0_stall ();
+        }
+        break;
+
+    case USBREQ_SET_ADDRESS:
+        /* The model of the controller has no device address, so just complete the status stage */
+        sim_usb_dev_ep0_ack ();
+        break;
+
+    default:
+        sim_usb_dev_ep0_stall ();
+        break;
+    }
+}
+
+
+static void handle_ep0 (void)
+{
+    tUSBRequest request;
+    uint32_t length;
+
+    if (ep0_out_pending && sim_usb_dev_ep0_received (ep0_out_data, &length))
+    {
+        ep0_out_pending = false;
+        sim_usb_dev_ep0_ack ();
+        if (ep0_owner_info->sCallbacks.pfnDataReceived != NULL)
+        {
+            ep0_owner_info->sCallbacks.pfnDataReceived (ep0_owner_instance, length);
+        }
+    }
+    else if (sim_usb_dev_setup_get (&request))
+    {
+        ep0_owner_info = device_info;
+        ep0_owner_instance = device_instance;
+        ep0_out_pending = false;
+        if ((request.bmRequestType & USB_RTYPE_TYPE_M) == USB_RTYPE_STANDARD)
+        {
+            handle_standard_request (&request);
+        }
+        else if (device_info->sCallbacks.pfnRequestHandler != NULL)
+        {
+            device_info->sCallbacks.pfnRequestHandler (device_instance, &request);
+        }
+        else
+        {
+            sim_usb_dev_ep0_stall ();
+        }
+    }
+}
+
+
+static void cdc_tick (tUSBDCDCDevice *const cdc_device);
+
+void USB0DeviceIntHandler (void)
+{
+    const uint32_t status = sim_usb_dev_int_status ();
+    const uint32_t ep_status = sim_usb_dev_ep_int_status ();
+
+    if (device_info == NULL)
+    {
+        return;
+    }
+
+    if ((status & SIM_USB_INT_RESET) != 0)
+    {
+        configuration = 0;
+        ep0_out_pending = false;
+        if (device_info->sCallbacks.pfnResetHandler != NULL)
+        {
+            device_info->sCallbacks.pfnResetHandler (device_instance);
+        }
+    }
+    if (((status & SIM_USB_INT_SUSPEND) != 0) && (device_info->sCallbacks.pfnSuspendHandler != NULL))
+    {
+        device_info->sCallbacks.pfnSuspendHandler (device_instance);
+    }
+    if (((status & SIM_USB_INT_RESUME) != 0) && (device_info->sCallbacks.pfnResumeHandler != NULL))
+    {
+        device_info->sCallbacks.pfnResumeHandler (device_instance);
+    }
+    if ((ep_status & SIM_USB_INTEP_0) != 0)
+    {
+        handle_ep0 ();
+    }
+    if (((ep_status & ~SIM_USB_INTEP_0) != 0) && (configuration != 0) &&
+        (device_info->sCallbacks.pfnEndpointHandler != NULL))
+    {
+        device_info->sCallbacks.pfnEndpointHandler (device_instance, ep_status & ~SIM_USB_INTEP_0);
+    }
+    if (((status & SIM_USB_INT_SOF) != 0) && (configuration != 0))
+    {
+        for (uint32_t class_index = 0; class_index < num_classes; class_index++)
+        {
+            if (classes[class_index].type == SIM_USBLIB_CLASS_CDC)
+            {
+                cdc_tick (classes[class_index].device);
+            }
+        }
+    }
+}
+
+
+void USBStackModeSet (uint32_t ui32Index, tUSBMode iUSBMode, tUSBModeCallback pfnCallback)
+{
+    (void) ui32Index;
+    (void) pfnCallback;
+    sim_consume (4);
+    if (iUSBMode != eUSBModeForceDevice)
+    {
+        sim_fail ("only the forced device mode of the USB stack is modelled");
+    }
+}
+
+
+void USBDCDInit (uint32_t ui32Index, tDeviceInfo *psDevice, void *pvDCDCBData)
+{
+    (void) ui32Index;
+    device_info = psDevice;
+    device_instance = pvDCDCBData;
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_USB0);
+    IntEnable (INT_USB0);
+    sim_usb_dev_connect ();
+}
+
+
+void USBDCDStallEP0 (uint32_t ui32Index)
+{
+    (void) ui32Index;
+    ep0_out_pending = false;
+    sim_usb_dev_ep0_stall ();
+}
+
+
+void USBDCDSendDataEP0 (uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    (void) ui32Index;
+    sim_usb_dev_ep0_send (pui8Data, ui32Size);
+}
+
+
+void USBDCDRequestDataEP0 (uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    (void) ui32Index;
+    ep0_out_data = pui8Data;
+    ep0_out_pending = true;
+    sim_usb_dev_ep0_receive (ui32Size);
+}
+
+
+/*
+ * CDC class
+ */
+
+static uint32_t cdc_data_remaining (tUSBDCDCDevice *const cdc_device)
+{
+    return cdc_device->pfnRxCallback (cdc_device->pvRxCBData, USB_EVENT_DATA_REMAINING, 0, NULL);
+}
+
+
+static void cdc_send_serial_state (tUSBDCDCDevice *const cdc_device)
+{
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+    const uint8_t notification[10] =
+    {
+        USB_RTYPE_DIR_IN | USB_RTYPE_CLASS | USB_RTYPE_INTERFACE, USB_CDC_NOTIFY_SERIAL_STATE, 0, 0,
+        inst->ui8InterfaceControl, 0, 2, 0, USBShort (inst->ui16SerialState)
+    };
+    const uint32_t ep_index = USBEPToIndex (inst->ui8ControlEndpoint);
+
+    if ((inst->iCDCInterruptState == eCDCStateIdle) && sim_usb_dev_write (ep_index, notification,
+                                                                          sizeof (notification)))
+    {
+        sim_usb_dev_tx_send (ep_index);
+        inst->iCDCInterruptState = eCDCStateWaitData;
+        inst->ui16SerialState &= ~SIM_USBLIB_CDC_SERIAL_STATE_ONE_SHOT;
+        inst->ui16DeferredOpFlags &= ~SIM_USBLIB_CDC_DO_SERIAL_STATE;
+    }
+    else
+    {
+        inst->ui16DeferredOpFlags |= SIM_USBLIB_CDC_DO_SERIAL_STATE;
+    }
+}
+
+
+/**
+ * @brief Perform the deferred operations once the receive channel has no data remaining
+ */
+static void cdc_deferred_ops (tUSBDCDCDevice *const cdc_device)
+{
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+    const uint16_t control_ops = SIM_USBLIB_CDC_DO_LINE_CODING | SIM_USBLIB_CDC_DO_LINE_STATE |
+            SIM_USBLIB_CDC_DO_SEND_BREAK | SIM_USBLIB_CDC_DO_CLEAR_BREAK;
+    uint16_t ops;
+
+    if (((inst->ui16DeferredOpFlags & control_ops) == 0) || (cdc_data_remaining (cdc_device) != 0))
+    {
+        return;
+    }
+
+    ops = inst->ui16DeferredOpFlags;
+    inst->ui16DeferredOpFlags &= ~control_ops;
+    if ((ops & SIM_USBLIB_CDC_DO_LINE_CODING) != 0)
+    {
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USBD_CDC_EVENT_SET_LINE_CODING, 0,
+                                        &inst->sLineCoding);
+    }
+    if ((ops & SIM_USBLIB_CDC_DO_LINE_STATE) != 0)
+    {
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USBD_CDC_EVENT_SET_CONTROL_LINE_STATE,
+                                        inst->ui16ControlLineState, NULL);
+    }
+    if ((ops & SIM_USBLIB_CDC_DO_SEND_BREAK) != 0)
+    {
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USBD_CDC_EVENT_SEND_BREAK, 0, NULL);
+    }
+    if ((ops & SIM_USBLIB_CDC_DO_CLEAR_BREAK) != 0)
+    {
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USBD_CDC_EVENT_CLEAR_BREAK, 0, NULL);
+    }
+}
+
+
+/**
+ * @brief Called on each SOF, to retry deferred operations and time a break
+ */
+static void cdc_tick (tUSBDCDCDevice *const cdc_device)
+{
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+
+    if ((inst->ui16BreakDuration != 0) && (inst->ui16BreakDuration != SIM_USBLIB_CDC_BREAK_UNTIL_CLEARED))
+    {
+        inst->ui16BreakDuration--;
+        if (inst->ui16BreakDuration == 0)
+        {
+            inst->ui16DeferredOpFlags |= SIM_USBLIB_CDC_DO_CLEAR_BREAK;
+        }
+    }
+    cdc_deferred_ops (cdc_device);
+}
+
+
+static void cdc_request_handler (void *pvInstance, tUSBRequest *pUSBRequest)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+
+    switch (pUSBRequest->bRequest)
+    {
+    case USB_CDC_SET_LINE_CODING:
+        USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+        inst->ui8PendingRequest = USB_CDC_SET_LINE_CODING;
+        USBDCDRequestDataEP0 (0, (uint8_t *) &inst->sLineCoding, sizeof (inst->sLineCoding));
+        break;
+
+    case USB_CDC_GET_LINE_CODING:
+        USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USBD_CDC_EVENT_GET_LINE_CODING, 0,
+                                        &inst->sLineCoding);
+        USBDCDSendDataEP0 (0, (uint8_t *) &inst->sLineCoding, sizeof (inst->sLineCoding));
+        break;
+
+    case USB_CDC_SET_CONTROL_LINE_STATE:
+        USBDevEndpointDataAck (USB0_BASE, USB_EP_0, true);
+        inst->ui16ControlLineState = pUSBRequest->wValue;
+        inst->ui16DeferredOpFlags |= SIM_USBLIB_CDC_DO_LINE_STATE;
+        cdc_deferred_ops (cdc_device);
+        break;
+
+    case USB_CDC_SEND_BREAK:
+        USBDevEndpointDataAck (USB0_BASE, USB_EP_0, true);
+        inst->ui16BreakDuration = pUSBRequest->wValue;
+        inst->ui16DeferredOpFlags |= (pUSBRequest->wValue != 0) ?
+                SIM_USBLIB_CDC_DO_SEND_BREAK : SIM_USBLIB_CDC_DO_CLEAR_BREAK;
+        cdc_deferred_ops (cdc_device);
+        break;
+
+    default:
+        USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+        USBDCDStallEP0 (0);
+        break;
+    }
+}
+
+
+static void cdc_data_received (void *pvInstance, uint32_t ui32Info)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+
+    if ((inst->ui8PendingRequest == USB_CDC_SET_LINE_CODING) && (ui32Info == sizeof (inst->sLineCoding)))
+    {
+        inst->ui16DeferredOpFlags |= SIM_USBLIB_CDC_DO_LINE_CODING;
+        cdc_deferred_ops (cdc_device);
+    }
+    inst->ui8PendingRequest = 0;
+}
+
+
+static void cdc_config_change (void *pvInstance, uint32_t ui32Info)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+
+    (void) ui32Info;
+    inst->iCDCRxState = eCDCStateIdle;
+    inst->iCDCTxState = eCDCStateIdle;
+    inst->iCDCInterruptState = eCDCStateIdle;
+    inst->bConnected = true;
+    cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USB_EVENT_CONNECTED, 0, NULL);
+}
+
+
+static void cdc_reset (void *pvInstance)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+
+    inst->iCDCRxState = eCDCStateUnconfigured;
+    inst->iCDCTxState = eCDCStateUnconfigured;
+    inst->iCDCInterruptState = eCDCStateUnconfigured;
+    if (inst->bConnected)
+    {
+        inst->bConnected = false;
+        cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USB_EVENT_DISCONNECTED, 0, NULL);
+    }
+}
+
+
+static void cdc_suspend (void *pvInstance)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+
+    cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USB_EVENT_SUSPEND, 0, NULL);
+}
+
+
+static void cdc_resume (void *pvInstance)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+
+    cdc_device->pfnControlCallback (cdc_device->pvControlCBData, USB_EVENT_RESUME, 0, NULL);
+}
+
+
+static void cdc_endpoint_handler (void *pvInstance, uint32_t ui32Status)
+{
+    tUSBDCDCDevice *const cdc_device = pvInstance;
+    tCDCSerInstance *const inst = &cdc_device->sPrivateData;
+    const uint32_t out_index = USBEPToIndex (inst->ui8BulkOUTEndpoint);
+    const uint32_t in_index = USBEPToIndex (inst->ui8BulkINEndpoint);
+    const uint32_t control_index = USBEPToIndex (inst->ui8ControlEndpoint);
+    sim_usblib_class_t *const usb_class = find_class (cdc_device);
+    uint32_t size;
+
+    if ((ui32Status & USB_INTEP_DEV_OUT (out_index)) != 0)
+    {
+        size = sim_usb_dev_rx_available (out_index);
+        if (size > 0)
+        {
+            inst->iCDCRxState = eCDCStateWaitClient;
+            cdc_device->pfnRxCallback (cdc_device->pvRxCBData, USB_EVENT_RX_AVAILABLE, size, NULL);
+        }
+    }
+    if ((ui32Status & USB_INTEP_DEV_IN (in_index)) != 0)
+    {
+        size = usb_class->tx_size;
+        usb_class->tx_size = 0;
+        inst->iCDCTxState = eCDCStateIdle;
+        cdc_device->pfnTxCallback (cdc_device->pvTxCBData, USB_EVENT_TX_COMPLETE, size, NULL);
+    }
+    if ((ui32Status & USB_INTEP_DEV_IN (control_index)) != 0)
+    {
+        inst->iCDCInterruptState = eCDCStateIdle;
+        if ((inst->ui16DeferredOpFlags & SIM_USBLIB_CDC_DO_SERIAL_STATE) != 0)
+        {
+            cdc_send_serial_state (cdc_device);
+        }
+    }
+}
+
+
+void *USBDCDCCompositeInit (uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice, tCompositeEntry *psCompEntry)
+{
+    tCDCSerInstance *const inst = &psCDCDevice->sPrivateData;
+
+    (void) ui32Index;
+    sim_consume (100);
+    if ((psCDCDevice->pfnControlCallback == NULL) || (psCDCDevice->pfnRxCallback == NULL) ||
+        (psCDCDevice->pfnTxCallback == NULL))
+    {
+        return NULL;
+    }
+
+    memset (inst, 0, sizeof (*inst));
+    inst->ui32USBBase = USB0_BASE;
+    inst->ui8BulkINEndpoint = USB_EP_1;
+    inst->ui8BulkOUTEndpoint = USB_EP_1;
+    inst->ui8ControlEndpoint = USB_EP_2;
+    inst->ui8InterfaceControl = 0;
+    inst->ui8InterfaceData = 1;
+    inst->sLineCoding.ui32Rate = 115200;
+    inst->sLineCoding.ui8Databits = 8;
+    inst->sLineCoding.ui8Parity = USB_CDC_PARITY_NONE;
+    inst->sLineCoding.ui8Stop = USB_CDC_STOP_BITS_1;
+    inst->sDevInfo.sCallbacks.pfnRequestHandler = cdc_request_handler;
+    inst->sDevInfo.sCallbacks.pfnConfigChange = cdc_config_change;
+    inst->sDevInfo.sCallbacks.pfnDataReceived = cdc_data_received;
+    inst->sDevInfo.sCallbacks.pfnResetHandler = cdc_reset;
+    inst->sDevInfo.sCallbacks.pfnSuspendHandler = cdc_suspend;
+    inst->sDevInfo.sCallbacks.pfnResumeHandler = cdc_resume;
+    inst->sDevInfo.sCallbacks.pfnEndpointHandler = cdc_endpoint_handler;
+    inst->sDevInfo.ppui8StringDescriptors = psCDCDevice->ppui8StringDescriptors;
+    inst->sDevInfo.ui32NumStringDescriptors = psCDCDevice->ui32NumStringDescriptors;
+    (void) register_class (SIM_USBLIB_CLASS_CDC, psCDCDevice, &inst->sDevInfo);
+
+    if (psCompEntry != NULL)
+    {
+        psCompEntry->psDevInfo = &inst->sDevInfo;
+        psCompEntry->pvInstance = psCDCDevice;
+    }
+
+    return psCDCDevice;
+}
+
+
+void *USBDCDCInit (uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice)
+{
+    void *const instance = USBDCDCCompositeInit (ui32Index, psCDCDevice, NULL);
+
+    if (instance != NULL)
+    {
+        find_class (psCDCDevice)->descriptors_patched = true;
+        USBDCDInit (ui32Index, &psCDCDevice->sPrivateData.sDevInfo, psCDCDevice);
+    }
+
+    return instance;
+}
+
+
+uint32_t USBDCDCPacketWrite (void *pvCDCDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast)
+{
+    tCDCSerInstance *const inst = &((tUSBDCDCDevice *) pvCDCDevice)->sPrivateData;
+    const uint32_t ep_index = USBEPToIndex (inst->ui8BulkINEndpoint);
+    sim_usblib_class_t *const usb_class = find_class (pvCDCDevice);
+    const uint32_t length = (ui32Length > SIM_USBLIB_BULK_PACKET_SIZE) ? SIM_USBLIB_BULK_PACKET_SIZE : ui32Length;
+
+    sim_consume (20);
+    if (!inst->bConnected || (inst->iCDCTxState != eCDCStateIdle) || !sim_usb_dev_write (ep_index, pi8Data, length))
+    {
+        return 0;
+    }
+
+    usb_class->tx_size += length;
+    if (bLast)
+    {
+        inst->iCDCTxState = eCDCStateWaitData;
+        sim_usb_dev_tx_send (ep_index);
+    }
+
+    return length;
+}
+
+
+uint32_t USBDCDCPacketRead (void *pvCDCDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast)
+{
+    tCDCSerInstance *const inst = &((tUSBDCDCDevice *) pvCDCDevice)->sPrivateData;
+    const uint32_t ep_index = USBEPToIndex (inst->ui8BulkOUTEndpoint);
+    uint32_t num_read;
+
+    sim_consume (20);
+    if (!inst->bConnected)
+    {
+        return 0;
+    }
+
+    num_read = sim_usb_dev_read (ep_index, pi8Data, ui32Length);
+    if (bLast)
+    {
+        inst->iCDCRxState = eCDCStateIdle;
+        sim_usb_dev_rx_ack (ep_index);
+    }
+
+    return num_read;
+}
+
+
+uint32_t USBDCDCTxPacketAvailable (void *pvCDCDevice)
+{
+    const tCDCSerInstance *const inst = &((tUSBDCDCDevice *) pvCDCDevice)->sPrivateData;
+
+    sim_consume (10);
+    if (!inst->bConnected || (inst->iCDCTxState != eCDCStateIdle) ||
+        !sim_usb_dev_tx_ready (USBEPToIndex (inst->ui8BulkINEndpoint)))
+    {
+        return 0;
+    }
+
+    return SIM_USBLIB_BULK_PACKET_SIZE;
+}
+
+
+uint32_t USBDCDCRxPacketAvailable (void *pvCDCDevice)
+{
+    const tCDCSerInstance *const inst = &((tUSBDCDCDevice *) pvCDCDevice)->sPrivateData;
+
+    sim_consume (10);
+    return inst->bConnected ? sim_usb_dev_rx_available (USBEPToIndex (inst->ui8BulkOUTEndpoint)) : 0;
+}
+
+
+void USBDCDCSerialStateChange (void *pvCDCDevice, uint16_t ui16State)
+{
+    tUSBDCDCDevice *const cdc_device = pvCDCDevice;
+
+    sim_consume (20);
+    cdc_device->sPrivateData.ui16SerialState |= ui16State;
+    if (cdc_device->sPrivateData.bConnected)
+    {
+        cdc_send_serial_state (cdc_device);
+    }
+}
+
+
+/*
+ * Bulk class
+ */
+
+static void bulk_config_change (void *pvInstance, uint32_t ui32Info)
+{
+    tUSBDBulkDevice *const bulk_device = pvInstance;
+    tBulkInstance *const inst = &bulk_device->sPrivateData;
+
+    (void) ui32Info;
+    inst->iBulkRxState = eBulkStateIdle;
+    inst->iBulkTxState = eBulkStateIdle;
+    inst->bConnected = true;
+    bulk_device->pfnRxCallback (bulk_device->pvRxCBData, USB_EVENT_CONNECTED, 0, NULL);
+}
+
+
+static void bulk_reset (void *pvInstance)
+{
+    tUSBDBulkDevice *const bulk_device = pvInstance;
+    tBulkInstance *const inst = &bulk_device->sPrivateData;
+
+    inst->iBulkRxState = eBulkStateUnconfigured;
+    inst->iBulkTxState = eBulkStateUnconfigured;
+    if (inst->bConnected)
+    {
+        inst->bConnected = false;
+        bulk_device->pfnRxCallback (bulk_device->pvRxCBData, USB_EVENT_DISCONNECTED, 0, NULL);
+    }
+}
+
+
+static void bulk_suspend (void *pvInstance)
+{
+    tUSBDBulkDevice *const bulk_device = pvInstance;
+
+    bulk_device->pfnRxCallback (bulk_device->pvRxCBData, USB_EVENT_SUSPEND, 0, NULL);
+}
+
+
+static void bulk_resume (void *pvInstance)
+{
+    tUSBDBulkDevice *const bulk_device = pvInstance;
+
+    bulk_device->pfnRxCallback (bulk_device->pvRxCBData, USB_EVENT_RESUME, 0, NULL);
+}
+
+
+static void bulk_endpoint_handler (void *pvInstance, uint32_t ui32Status)
+{
+    tUSBDBulkDevice *const bulk_device = pvInstance;
+    tBulkInstance *const inst = &bulk_device->sPrivateData;
+    const uint32_t out_index = USBEPToIndex (inst->ui8OUTEndpoint);
+    const uint32_t in_index = USBEPToIndex (inst->ui8INEndpoint);
+    sim_usblib_class_t *const usb_class = find_class (bulk_device);
+    uint32_t size;
+
+    if ((ui32Status & USB_INTEP_DEV_OUT (out_index)) != 0)
+    {
+        size = sim_usb_dev_rx_available (out_index);
+        if (size > 0)
+        {
+            inst->iBulkRxState = eBulkStateWaitClient;
+            bulk_device->pfnRxCallback (bulk_device->pvRxCBData, USB_EVENT_RX_AVAILABLE, size, NULL);
+        }
+    }
+    if ((ui32Status & USB_INTEP_DEV_IN (in_index)) != 0)
+    {
+        size = usb_class->tx_size;
+        usb_class->tx_size = 0;
+        inst->iBulkTxState = eBulkStateIdle;
+        bulk_device->pfnTxCallback (bulk_device->pvTxCBData, USB_EVENT_TX_COMPLETE, size, NULL);
+    }
+}
+
+
+void *USBDBulkCompositeInit (uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice, tCompositeEntry *psCompEntry)
+{
+    tBulkInstance *const inst = &psBulkDevice->sPrivateData;
+
+    (void) ui32Index;
+    sim_consume (100);
+    if ((psBulkDevice->pfnRxCallback == NULL) || (psBulkDevice->pfnTxCallback == NULL))
+    {
+        return NULL;
+    }
+
+    memset (inst, 0, sizeof (*inst));
+    inst->ui32USBBase = USB0_BASE;
+    inst->ui8INEndpoint = USB_EP_1;
+    inst->ui8OUTEndpoint = USB_EP_1;
+    inst->ui8Interface = 0;
+    inst->sDevInfo.sCallbacks.pfnConfigChange = bulk_config_change;
+    inst->sDevInfo.sCallbacks.pfnResetHandler = bulk_reset;
+    inst->sDevInfo.sCallbacks.pfnSuspendHandler = bulk_suspend;
+    inst->sDevInfo.sCallbacks.pfnResumeHandler = bulk_resume;
+    inst->sDevInfo.sCallbacks.pfnEndpointHandler = bulk_endpoint_handler;
+    inst->sDevInfo.ppui8StringDescriptors = psBulkDevice->ppui8StringDescriptors;
+    inst->sDevInfo.ui32NumStringDescriptors = psBulkDevice->ui32NumStringDescriptors;
+    (void) register_class (SIM_USBLIB_CLASS_BULK, psBulkDevice, &inst->sDevInfo);
+
+    if (psCompEntry != NULL)
+    {
+        psCompEntry->psDevInfo = &inst->sDevInfo;
+        psCompEntry->pvInstance = psBulkDevice;
+    }
+
+    return psBulkDevice;
+}
+
+
+void *USBDBulkInit (uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice)
+{
+    void *const instance = USBDBulkCompositeInit (ui32Index, psBulkDevice, NULL);
+
+    if (instance != NULL)
+    {
+        find_class (psBulkDevice)->descriptors_patched = true;
+        USBDCDInit (ui32Index, &psBulkDevice->sPrivateData.sDevInfo, psBulkDevice);
+    }
+
+    return instance;
+}
+
+
+uint32_t USBDBulkPacketWrite (void *pvBulkDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast)
+{
+    tBulkInstance *const inst = &((tUSBDBulkDevice *) pvBulkDevice)->sPrivateData;
+    const uint32_t ep_index = USBEPToIndex (inst->ui8INEndpoint);
+    sim_usblib_class_t *const usb_class = find_class (pvBulkDevice);
+    const uint32_t length = (ui32Length > SIM_USBLIB_BULK_PACKET_SIZE) ? SIM_USBLIB_BULK_PACKET_SIZE : ui32Length;
+
+    sim_consume (20);
+    if (!inst->bConnected || (inst->iBulkTxState != eBulkStateIdle) || !sim_usb_dev_write (ep_index, pi8Data, length))
+    {
+        return 0;
+    }
+
+    usb_class->tx_size += length;
+    if (bLast)
+    {
+        inst->iBulkTxState = eBulkStateWaitData;
+        sim_usb_dev_tx_send (ep_index);
+    }
+
+    return length;
+}
+
+
+uint32_t USBDBulkPacketRead (void *pvBulkDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast)
+{
+    tBulkInstance *const inst = &((tUSBDBulkDevice *) pvBulkDevice)->sPrivateData;
+    const uint32_t ep_index = USBEPToIndex (inst->ui8OUTEndpoint);
+    uint32_t num_read;
+
+    sim_consume (20);
+    if (!inst->bConnected)
+    {
+        return 0;
+    }
+
+    num_read = sim_usb_dev_read (ep_index, pi8Data, ui32Length);
+    if (bLast)
+    {
+        inst->iBulkRxState = eBulkStateIdle;
+        sim_usb_dev_rx_ack (ep_index);
+    }
+
+    return num_read;
+}
+
+
+uint32_t USBDBulkTxPacketAvailable (void *pvBulkDevice)
+{
+    const tBulkInstance *const inst = &((tUSBDBulkDevice *) pvBulkDevice)->sPrivateData;
+
+    sim_consume (10);
+    if (!inst->bConnected || (inst->iBulkTxState != eBulkStateIdle) ||
+        !sim_usb_dev_tx_ready (USBEPToIndex (inst->ui8INEndpoint)))
+    {
+        return 0;
+    }
+
+    return SIM_USBLIB_BULK_PACKET_SIZE;
+}
+
+
+uint32_t USBDBulkRxPacketAvailable (void *pvBulkDevice)
+{
+    const tBulkInstance *const inst = &((tUSBDBulkDevice *) pvBulkDevice)->sPrivateData;
+
+    sim_consume (10);
+    return inst->bConnected ? sim_usb_dev_rx_available (USBEPToIndex (inst->ui8OUTEndpoint)) : 0;
+}
+
+
+/*
+ * Composite device
+ */
+
+/**
+ * @brief Find the composite entry which owns a request, from its interface or endpoint recipient
+ * @details Requests with a device recipient are passed to the first entry.
+ */
+static tCompositeEntry *composite_request_owner (const tUSBRequest *const request)
+{
+    const uint8_t recipient = request->bmRequestType & USB_RTYPE_RECIPIENT_M;
+    const uint8_t target = request->wIndex & 0xFF;
+
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+        const sim_usblib_class_t *const usb_class = find_class_by_info (entry->psDevInfo);
+
+        if (usb_class->type == SIM_USBLIB_CLASS_CDC)
+        {
+            const tCDCSerInstance *const inst = &((tUSBDCDCDevice *) usb_class->device)->sPrivateData;
+
+            if (((recipient == USB_RTYPE_INTERFACE) &&
+                 ((target == inst->ui8InterfaceControl) || (target == inst->ui8InterfaceData))) ||
+                ((recipient == USB_RTYPE_ENDPOINT) &&
+                 (((target & 0x0F) == USBEPToIndex (inst->ui8BulkINEndpoint)) ||
+                  ((target & 0x0F) == USBEPToIndex (inst->ui8ControlEndpoint)))))
+            {
+                return entry;
+            }
+        }
+        else
+        {
+            const tBulkInstance *const inst = &((tUSBDBulkDevice *) usb_class->device)->sPrivateData;
+
+            if (((recipient == USB_RTYPE_INTERFACE) && (target == inst->ui8Interface)) ||
+                ((recipient == USB_RTYPE_ENDPOINT) && ((target & 0x0F) == USBEPToIndex (inst->ui8INEndpoint))))
+            {
+                return entry;
+            }
+        }
+    }
+
+    return ((recipient == USB_RTYPE_DEVICE) && (composite_device->ui32NumDevices > 0)) ?
+            &composite_device->psDevices[0] : NULL;
+}
+
+
+static void composite_request_handler (void *pvInstance, tUSBRequest *pUSBRequest)
+{
+    tCompositeEntry *const entry = composite_request_owner (pUSBRequest);
+
+    (void) pvInstance;
+    if ((entry != NULL) && (entry->psDevInfo->sCallbacks.pfnRequestHandler != NULL))
+    {
+        ep0_owner_info = (tDeviceInfo *) entry->psDevInfo;
+        ep0_owner_instance = entry->pvInstance;
+        entry->psDevInfo->sCallbacks.pfnRequestHandler (entry->pvInstance, pUSBRequest);
+    }
+    else
+    {
+        USBDCDStallEP0 (0);
+    }
+}
+
+
+static void composite_config_change (void *pvInstance, uint32_t ui32Info)
+{
+    (void) pvInstance;
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        const tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+
+        entry->psDevInfo->sCallbacks.pfnConfigChange (entry->pvInstance, ui32Info);
+    }
+}
+
+
+static void composite_reset (void *pvInstance)
+{
+    (void) pvInstance;
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        const tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+
+        entry->psDevInfo->sCallbacks.pfnResetHandler (entry->pvInstance);
+    }
+}
+
+
+static void composite_suspend (void *pvInstance)
+{
+    (void) pvInstance;
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        const tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+
+        entry->psDevInfo->sCallbacks.pfnSuspendHandler (entry->pvInstance);
+    }
+}
+
+
+static void composite_resume (void *pvInstance)
+{
+    (void) pvInstance;
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        const tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+
+        entry->psDevInfo->sCallbacks.pfnResumeHandler (entry->pvInstance);
+    }
+}
+
+
+static void composite_endpoint_handler (void *pvInstance, uint32_t ui32Status)
+{
+    (void) pvInstance;
+    for (uint32_t entry_index = 0; entry_index < composite_device->ui32NumDevices; entry_index++)
+    {
+        const tCompositeEntry *const entry = &composite_device->psDevices[entry_index];
+
+        entry->psDevInfo->sCallbacks.pfnEndpointHandler (entry->pvInstance, ui32Status);
+    }
+}
+
+
+void *USBDCompositeInit (uint32_t ui32Index, tUSBDCompositeDevice *psCompDevice, uint32_t ui32Size,
+                         uint8_t *pui8Data)
+{
+    tCompositeInstance *const inst = &psCompDevice->sPrivateData;
+    uint32_t total_size = 0;
+    uint8_t next_interface = 0;
+    uint8_t next_endpoint = 1;
+
+    sim_consume (200);
+    for (uint32_t entry_index = 0; entry_index < psCompDevice->ui32NumDevices; entry_index++)
+    {
+        if (psCompDevice->psDevices[entry_index].psDevInfo == NULL)
+        {
+            return NULL;
+        }
+        total_size += class_section_size (find_class_by_info (psCompDevice->psDevices[entry_index].psDevInfo));
+    }
+    if (total_size > ui32Size)
+    {
+        return NULL;
+    }
+
+    /* Renumber the interfaces and endpoints of each class in order, and build their descriptor sections */
+    memset (pui8Data, 0, ui32Size);
+    total_size = 0;
+    for (uint32_t entry_index = 0; entry_index < psCompDevice->ui32NumDevices; entry_index++)
+    {
+        sim_usblib_class_t *const usb_class = find_class_by_info (psCompDevice->psDevices[entry_index].psDevInfo);
+
+        if (usb_class->type == SIM_USBLIB_CLASS_CDC)
+        {
+            tCDCSerInstance *const cdc_inst = &((tUSBDCDCDevice *) usb_class->device)->sPrivateData;
+
+            cdc_inst->ui8InterfaceControl = next_interface++;
+            cdc_inst->ui8InterfaceData = next_interface++;
+            cdc_inst->ui8BulkINEndpoint = IndexToUSBEP (next_endpoint);
+            cdc_inst->ui8BulkOUTEndpoint = IndexToUSBEP (next_endpoint);
+            cdc_inst->ui8ControlEndpoint = IndexToUSBEP (next_endpoint + 1);
+            next_endpoint += 2;
+        }
+        else
+        {
+            tBulkInstance *const bulk_inst = &((tUSBDBulkDevice *) usb_class->device)->sPrivateData;
+
+            bulk_inst->ui8Interface = next_interface++;
+            bulk_inst->ui8INEndpoint = IndexToUSBEP (next_endpoint);
+            bulk_inst->ui8OUTEndpoint = IndexToUSBEP (next_endpoint);
+            next_endpoint++;
+        }
+        if (next_endpoint > 8)
+        {
+            return NULL;
+        }
+        total_size += put_class_section (&pui8Data[total_size], usb_class, true);
+    }
+
+    memset (inst, 0, sizeof (*inst));
+    inst->ui32USBBase = USB0_BASE;
+    inst->pui8Data = pui8Data;
+    inst->ui32DataSize = total_size;
+    inst->sDevInfo.sCallbacks.pfnRequestHandler = composite_request_handler;
+    inst->sDevInfo.sCallbacks.pfnConfigChange = composite_config_change;
+    inst->sDevInfo.sCallbacks.pfnResetHandler = composite_reset;
+    inst->sDevInfo.sCallbacks.pfnSuspendHandler = composite_suspend;
+    inst->sDevInfo.sCallbacks.pfnResumeHandler = composite_resume;
+    inst->sDevInfo.sCallbacks.pfnEndpointHandler = composite_endpoint_handler;
+    inst->sDevInfo.ppui8StringDescriptors = psCompDevice->ppui8StringDescriptors;
+    inst->sDevInfo.ui32NumStringDescriptors = psCompDevice->ui32NumStringDescriptors;
+    composite_device = psCompDevice;
+
+    USBDCDInit (ui32Index, &inst->sDevInfo, psCompDevice);
+
+    return psCompDevice;
+}
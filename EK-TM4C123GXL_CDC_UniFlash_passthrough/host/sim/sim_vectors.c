@@ -0,0 +1,69 @@
+/*
+ * @file sim_vectors.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief The vector table of the firmware when run in the host simulation
+ * @details Only the exceptions used by the firmware are populated. Must be kept consistent with the vector table
+ *          in tm4c123gh6pm_startup_ccs.c, using the same preprocessor conditions.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+
+#include "sim.h"
+#include "sim_vectors.h"
+
+void usb_interrupt_handler (void);
+void uart_interrupt_handler (void);
+void nhib_timer_handler (void);
+void usb_in_flush_timer_handler (void);
+void deferred_work_handler (void);
+void spi_ssi_interrupt_handler (void);
+void spi_irq_interrupt_handler (void);
+void uart_channel_1_interrupt_handler (void);
+void uart_channel_2_interrupt_handler (void);
+void uart_channel_1_nhib_timer_handler (void);
+void uart_channel_2_nhib_timer_handler (void);
+void uart_channel_1_flush_timer_handler (void);
+void uart_channel_2_flush_timer_handler (void);
+
+
+/**
+ * @brief Equivalent of IntDefaultHandler, which is detected when the exception is taken
+ */
+void sim_unexpected_handler (void)
+{
+    sim_fail ("unexpected exception");
+}
+
+
+void (*const sim_vector_table[155]) (void) =
+{
+    [FAULT_PENDSV] = deferred_work_handler,
+#if SPI_PASSTHROUGH
+    [INT_GPIOB] = spi_irq_interrupt_handler,
+#endif
+    [INT_UART1] = uart_interrupt_handler,
+    [INT_TIMER0A] = nhib_timer_handler,
+    [INT_TIMER1A] = usb_in_flush_timer_handler,
+#if UART_EXTRA_CHANNELS > 0
+    [INT_TIMER2A] = uart_channel_1_flush_timer_handler,
+#endif
+#if UART_EXTRA_CHANNELS > 1
+    [INT_UART2] = uart_channel_2_interrupt_handler,
+    [INT_TIMER3A] = uart_channel_2_flush_timer_handler,
+#endif
+    [INT_USB0] = usb_interrupt_handler,
+#if SPI_PASSTHROUGH
+    [INT_SSI2] = spi_ssi_interrupt_handler,
+#endif
+#if UART_EXTRA_CHANNELS > 0
+    [INT_UART3] = uart_channel_1_interrupt_handler,
+    [INT_WTIMER1A] = uart_channel_1_nhib_timer_handler,
+#endif
+#if UART_EXTRA_CHANNELS > 1
+    [INT_WTIMER1B] = uart_channel_2_nhib_timer_handler,
+#endif
+};
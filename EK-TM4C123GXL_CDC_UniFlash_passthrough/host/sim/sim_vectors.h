@@ -0,0 +1,20 @@
+/*
+ * @file sim_vectors.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief The vector table of the firmware when run in the host simulation
+ */
+
+#ifndef SIM_VECTORS_H_
+#define SIM_VECTORS_H_
+
+/** Indexed by exception number, compiled for each variant of the firmware with the same conditions as the vector
+ *  table in tm4c123gh6pm_startup_ccs.c */
+extern void (*const sim_vector_table[155]) (void);
+
+void sim_unexpected_handler (void);
+
+/** The firmware main(), renamed when compiled for the host */
+int firmware_main (void);
+
+#endif /* SIM_VECTORS_H_ */
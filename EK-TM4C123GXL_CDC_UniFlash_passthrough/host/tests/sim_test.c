@@ -0,0 +1,314 @@
+/*
+ * @file sim_test.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Helpers shared by the test programs which run the firmware in the host simulation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+
+#include "line_coding.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The time allowed for the host to enumerate the bridge after reset */
+#define SIM_TEST_ENUMERATION_TIMEOUT SIM_MS (1000)
+
+/** The time allowed for the bridge to apply a line coding change, once queued transmit data has drained */
+#define SIM_TEST_LINE_CODING_TIMEOUT SIM_MS (500)
+
+
+static bool host_configured (void *arg)
+{
+    (void) arg;
+    return sim_usb_host_configured ();
+}
+
+
+/**
+ * @brief Attach the CC3100 model, start the firmware and wait for the host to configure the bridge
+ * @param[in] mode How the CC3100 model responds to the characters it receives
+ */
+void sim_test_boot (const sim_cc3100_mode_t mode)
+{
+    sim_cc3100_attach (mode);
+    SIM_TEST_CHECK (sim_run_until (host_configured, NULL, SIM_TEST_ENUMERATION_TIMEOUT),
+                    "the host didn't configure the bridge");
+}
+
+
+/**
+ * @brief Send a vendor request with an IN data stage
+ * @return The number of bytes returned, or -1 if the request was stalled
+ */
+int32_t sim_test_vendor_in (const uint8_t request, const uint16_t value, void *const data, const uint16_t length)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_VENDOR | USB_RTYPE_DEVICE,
+        .bRequest = request,
+        .wValue = value,
+        .wIndex = 0,
+        .wLength = length
+    };
+
+    return sim_usb_host_control (&setup, data);
+}
+
+
+/**
+ * @brief Send a vendor request with an optional OUT data stage
+ * @return The number of bytes sent in the data stage, or -1 if the request was stalled
+ */
+int32_t sim_test_vendor_out (const uint8_t request, const uint16_t value, const void *const data,
+                             const uint16_t length)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_VENDOR | USB_RTYPE_DEVICE,
+        .bRequest = request,
+        .wValue = value,
+        .wIndex = 0,
+        .wLength = length
+    };
+
+    return sim_usb_host_control (&setup, (void *) data);
+}
+
+
+/**
+ * @brief Check the identity and power the bridge enumerated with, from its device and configuration descriptors
+ * @param[in] vid The expected vendor ID
+ * @param[in] pid The expected product ID
+ * @param[in] attributes The expected bmAttributes of the configuration
+ * @param[in] max_power_ma The expected maximum power of the configuration in mA
+ */
+void sim_test_check_device_identity (const uint16_t vid, const uint16_t pid, const uint8_t attributes,
+                                     const uint16_t max_power_ma)
+{
+    const tUSBRequest device_setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_GET_DESCRIPTOR,
+        .wValue = USB_DTYPE_DEVICE << 8,
+        .wIndex = 0,
+        .wLength = sizeof (tDeviceDescriptor)
+    };
+    const tUSBRequest config_setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_GET_DESCRIPTOR,
+        .wValue = USB_DTYPE_CONFIGURATION << 8,
+        .wIndex = 0,
+        .wLength = sizeof (tConfigDescriptor)
+    };
+    tDeviceDescriptor device;
+    tConfigDescriptor config;
+
+    SIM_TEST_CHECK (sim_usb_host_control (&device_setup, &device) == sizeof (device),
+                    "GET_DESCRIPTOR of the device failed");
+    SIM_TEST_CHECK ((device.idVendor == vid) && (device.idProduct == pid),
+                    "enumerated as %04x:%04x, expected %04x:%04x", device.idVendor, device.idProduct, vid, pid);
+    SIM_TEST_CHECK (sim_usb_host_control (&config_setup, &config) == sizeof (config),
+                    "GET_DESCRIPTOR of the configuration failed");
+    SIM_TEST_CHECK ((config.bmAttributes == attributes) && (config.bMaxPower == (max_power_ma / 2)),
+                    "configuration bmAttributes 0x%02x bMaxPower %u, expected 0x%02x %u", config.bmAttributes,
+                    config.bMaxPower, attributes, max_power_ma / 2);
+}
+
+
+/**
+ * @brief Send SET_LINE_CODING on a CDC port, without waiting for the bridge to apply it
+ * @param[in] port The CDC port
+ * @param[in] baud The baud rate
+ * @param[in] uart_config The frame format, as UART_CONFIG_ flags
+ */
+void sim_test_request_line_coding (const uint32_t port, const uint32_t baud, const uint32_t uart_config)
+{
+    static const uint8_t cdc_parity[] =
+    {
+        [UART_CONFIG_PAR_NONE] = USB_CDC_PARITY_NONE,
+        [UART_CONFIG_PAR_ODD] = USB_CDC_PARITY_ODD,
+        [UART_CONFIG_PAR_EVEN] = USB_CDC_PARITY_EVEN,
+        [UART_CONFIG_PAR_ONE] = USB_CDC_PARITY_MARK,
+        [UART_CONFIG_PAR_ZERO] = USB_CDC_PARITY_SPACE
+    };
+    tLineCoding line_coding =
+    {
+        .ui32Rate = baud,
+        .ui8Stop = ((uart_config & UART_CONFIG_STOP_MASK) == UART_CONFIG_STOP_TWO) ?
+                USB_CDC_STOP_BITS_2 : USB_CDC_STOP_BITS_1,
+        .ui8Parity = cdc_parity[uart_config & UART_CONFIG_PAR_MASK],
+        .ui8Databits = (uint8_t) (5 + ((uart_config & UART_CONFIG_WLEN_MASK) >> 5))
+    };
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_SET_LINE_CODING,
+        .wValue = 0,
+        .wIndex = sim_usb_host_port_interface (port),
+        .wLength = sizeof (line_coding)
+    };
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, &line_coding) == sizeof (line_coding), "SET_LINE_CODING stalled");
+}
+
+
+/**
+ * @brief Set the line coding of a CDC port, and wait for the bridge to apply it to the UART
+ * @details The CC3100 model is changed to the same line settings once applied, when the port is for UART1.
+ * @param[in] port The CDC port
+ * @param[in] baud The baud rate
+ * @param[in] uart_config The frame format, as UART_CONFIG_ flags
+ */
+void sim_test_set_line_coding (const uint32_t port, const uint32_t baud, const uint32_t uart_config)
+{
+    line_coding_change_status_t status;
+    const sim_time_t deadline = sim_now + SIM_TEST_LINE_CODING_TIMEOUT;
+
+    sim_test_request_line_coding (port, baud, uart_config);
+    if (port != 0)
+    {
+        return;
+    }
+
+    do
+    {
+        sim_run_for (SIM_MS (1));
+        SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_LINE_CODING_STATUS, 0, &status, sizeof (status)) ==
+                        sizeof (status), "GET_LINE_CODING_STATUS failed");
+        SIM_TEST_CHECK (sim_now < deadline, "line coding change to %u baud not applied", baud);
+    } while (status.state == LINE_CODING_CHANGE_PENDING);
+    SIM_TEST_CHECK (status.state == LINE_CODING_CHANGE_APPLIED, "line coding change to %u baud rejected", baud);
+    sim_cc3100_line_config (baud, uart_config);
+}
+
+
+/**
+ * @brief Send SET_CONTROL_LINE_STATE on a CDC port
+ * @param[in] port The CDC port
+ * @param[in] state The USB_CDC_DTE_PRESENT and USB_CDC_ACTIVATE_CARRIER flags
+ */
+void sim_test_set_control_line_state (const uint32_t port, const uint16_t state)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_SET_CONTROL_LINE_STATE,
+        .wValue = state,
+        .wIndex = sim_usb_host_port_interface (port),
+        .wLength = 0
+    };
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, NULL) == 0, "SET_CONTROL_LINE_STATE stalled");
+}
+
+
+/**
+ * @brief Send SEND_BREAK on a CDC port
+ * @param[in] port The CDC port
+ * @param[in] duration 0xFFFF to send a break until cleared, or zero to clear the break
+ */
+void sim_test_send_break (const uint32_t port, const uint16_t duration)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_SEND_BREAK,
+        .wValue = duration,
+        .wIndex = sim_usb_host_port_interface (port),
+        .wLength = 0
+    };
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, NULL) == 0, "SEND_BREAK stalled");
+}
+
+
+typedef struct
+{
+    uint32_t port;
+    size_t length;
+} read_available_arg_t;
+
+
+static bool read_available (void *arg)
+{
+    const read_available_arg_t *const wait = arg;
+
+    return sim_usb_host_read_available (wait->port) >= wait->length;
+}
+
+
+/**
+ * @brief Run the firmware until the host has received at least a number of bytes on a port
+ * @return Returns true if the bytes were received before the timeout
+ */
+bool sim_test_wait_read_available (const uint32_t port, const size_t length, const sim_time_t timeout)
+{
+    read_available_arg_t wait = {.port = port, .length = length};
+
+    return sim_run_until (read_available, &wait, timeout);
+}
+
+
+/**
+ * @brief Fill a buffer with a repeatable pseudo-random pattern, so that lost or reordered bytes are detected
+ */
+void sim_test_fill_pattern (uint8_t *const data, const size_t length, const uint32_t seed)
+{
+    uint32_t state = seed | 1u;
+
+    for (size_t index = 0; index < length; index++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[index] = (uint8_t) state;
+    }
+}
+
+
+/**
+ * @brief Send data from the host through the bridge to the CC3100 in echo mode, and check it is received back
+ *        intact by the host
+ * @details Allows ten times the time to send the data on the serial line at the current line settings.
+ * @param[in] port The CDC port
+ * @param[in] length The number of bytes to send
+ * @param[in] chunk_size How many bytes the host writes at once, waiting for the echo of each write before the next
+ * @param[in] seed The seed for the data pattern
+ */
+void sim_test_loopback (const uint32_t port, const size_t length, const size_t chunk_size, const uint32_t seed)
+{
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    const sim_time_t timeout = 10u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (10);
+    size_t offset = 0;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_fill_pattern (sent, length, seed);
+    while (offset < length)
+    {
+        const size_t chunk = ((length - offset) < chunk_size) ? (length - offset) : chunk_size;
+
+        sim_usb_host_write (port, &sent[offset], chunk);
+        offset += chunk;
+        SIM_TEST_CHECK (sim_test_wait_read_available (port, offset, timeout),
+                        "only %zu of %zu looped back bytes received", sim_usb_host_read_available (port), offset);
+    }
+    SIM_TEST_CHECK (sim_usb_host_read (port, received, length) == length, "short read");
+    for (offset = 0; offset < length; offset++)
+    {
+        SIM_TEST_CHECK (sent[offset] == received[offset], "byte %zu looped back as 0x%02x, sent 0x%02x",
+                        offset, received[offset], sent[offset]);
+    }
+
+    free (sent);
+    free (received);
+}
@@ -0,0 +1,38 @@
+/*
+ * @file sim_test.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Helpers shared by the test programs which run the firmware in the host simulation
+ */
+
+#ifndef SIM_TEST_H_
+#define SIM_TEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+#include "sim_usb.h"
+#include "sim_uart.h"
+#include "sim_cc3100.h"
+
+/** Report a failed check, with the virtual time, and exit */
+#define SIM_TEST_CHECK(condition, ...) \
+    do { if (!(condition)) { sim_fail (__VA_ARGS__); } } while (0)
+
+void sim_test_boot (const sim_cc3100_mode_t mode);
+void sim_test_request_line_coding (const uint32_t port, const uint32_t baud, const uint32_t uart_config);
+void sim_test_set_line_coding (const uint32_t port, const uint32_t baud, const uint32_t uart_config);
+void sim_test_set_control_line_state (const uint32_t port, const uint16_t state);
+void sim_test_send_break (const uint32_t port, const uint16_t duration);
+int32_t sim_test_vendor_in (const uint8_t request, const uint16_t value, void *const data, const uint16_t length);
+int32_t sim_test_vendor_out (const uint8_t request, const uint16_t value, const void *const data,
+                             const uint16_t length);
+void sim_test_check_device_identity (const uint16_t vid, const uint16_t pid, const uint8_t attributes,
+                                     const uint16_t max_power_ma);
+bool sim_test_wait_read_available (const uint32_t port, const size_t length, const sim_time_t timeout);
+void sim_test_fill_pattern (uint8_t *const data, const size_t length, const uint32_t seed);
+void sim_test_loopback (const uint32_t port, const size_t length, const size_t chunk_size, const uint32_t seed);
+
+#endif /* SIM_TEST_H_ */
@@ -0,0 +1,45 @@
+/*
+ * @file test_bulk_loopback.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the raw vendor bulk UART interface of the bridge, selected by holding SW1 at reset
+ * @details The bulk interface has no CDC requests, so the control line state is set with a vendor request and the
+ *          UART keeps the default 115200 8N1 line coding. Checks the bulk device enumerates with its own identity.
+ */
+
+#include <stdio.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/usb-ids.h"
+
+#include "vendor_requests.h"
+
+#include "sim_gpio.h"
+#include "sim_test.h"
+
+
+int main (void)
+{
+    /* Hold SW1 (PF4), which is active low */
+    sim_gpio_drive (GPIO_PORTF_BASE, GPIO_PIN_4, false);
+    sim_test_boot (SIM_CC3100_ECHO);
+    sim_gpio_release (GPIO_PORTF_BASE, GPIO_PIN_4);
+    SIM_TEST_CHECK (sim_usb_host_num_ports () == 1, "expected one bulk port, found %u", sim_usb_host_num_ports ());
+    sim_test_check_device_identity (USB_VID_TI_1CBE, USB_PID_BULK, USB_CONF_ATTR_SELF_PWR, 0);
+
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_SET_CONTROL_LINE_STATE,
+                                         USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER, NULL, 0) == 0,
+                    "SET_CONTROL_LINE_STATE vendor request stalled");
+
+    sim_test_loopback (0, 64, 1, 1);
+    sim_test_loopback (0, 16384, 1024, 2);
+
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns == 0, "UART1 overran");
+    printf ("PASS test_bulk_loopback: %llu characters looped back in %.3f s of virtual time\n",
+            (unsigned long long) sim_cc3100_stats ()->echoed, (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
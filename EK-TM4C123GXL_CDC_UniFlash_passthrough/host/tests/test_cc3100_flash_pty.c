@@ -0,0 +1,296 @@
+/*
+ * @file test_cc3100_flash_pty.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the cc3100_flash client against the cc3100_pty_sim simulator of the bridge and CC3100
+ * @details The tools are run as separate processes, as they would be against the bridge, without the simulation.
+ *          An image is composed in the work directory in the format of cc3100_programmer.h. Checks that:
+ *  - An image which formats the serial flash and uploads a file passes both without pipelining and with a window
+ *    of queued commands, and the file uploaded matches.
+ *  - A response which doesn't match the expected bytes fails the client.
+ *  - The client fails when the bootloader doesn't acknowledge the break.
+ *
+ *          Usage: test_cc3100_flash_pty <cc3100_pty_sim> <cc3100_flash> <work directory>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "cc3100_programmer.h"
+#include "sim_cc3100_bootloader.h"
+
+/** The file uploaded by the image, larger than one command so is sent in chunks */
+#define FILE_NAME "/sys/servicepack.ucf"
+#define SAVED_FILE_NAME "sys_servicepack.ucf"
+#define FILE_LENGTH 12000
+#define FILE_CHUNK_LENGTH 1024
+
+/** The maximum size of the composed image */
+#define MAX_IMAGE_SIZE 65536
+
+#define CHECK(condition, ...) \
+    do { if (!(condition)) { fprintf (stderr, "FAIL line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); \
+                             fprintf (stderr, "\n"); exit (EXIT_FAILURE); } } while (0)
+
+static const char *pty_sim_path;
+static const char *flash_path;
+static const char *work_dir;
+
+/** The image being composed, as the header followed by the records */
+static uint8_t image[MAX_IMAGE_SIZE];
+static uint32_t image_length;
+static uint32_t image_num_records;
+
+/** The contents of the uploaded file */
+static uint8_t file_contents[FILE_LENGTH];
+
+
+static uint32_t crc32 (const uint8_t *const data, const size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t byte_index = 0; byte_index < length; byte_index++)
+    {
+        crc ^= data[byte_index];
+        for (uint32_t bit_index = 0; bit_index < 8; bit_index++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+
+static void put_be32 (uint8_t *const data, const uint32_t value)
+{
+    data[0] = (uint8_t) (value >> 24);
+    data[1] = (uint8_t) (value >> 16);
+    data[2] = (uint8_t) (value >> 8);
+    data[3] = (uint8_t) value;
+}
+
+
+static void image_start (void)
+{
+    memset (image, 0, sizeof (image));
+    image_length = sizeof (cc3100_programmer_image_header_t);
+    image_num_records = 0;
+}
+
+
+/**
+ * @brief Append a record to the image, in the same way as test_cc3100_programmer
+ */
+static void image_add_record (const uint8_t opcode, const void *const data, const uint16_t data_length,
+                              const cc3100_programmer_response_t response,
+                              const void *const expected, const uint8_t expected_length,
+                              const uint16_t response_length, const uint16_t timeout_ms)
+{
+    const cc3100_programmer_record_t record =
+    {
+        .command_length = (uint16_t) (1 + data_length),
+        .response = (uint8_t) response,
+        .expected_length = expected_length,
+        .response_length = response_length,
+        .timeout_ms = timeout_ms
+    };
+    uint8_t *const command = &image[image_length + sizeof (record)];
+
+    CHECK ((image_length + sizeof (record) + record.command_length + expected_length + 3) <= sizeof (image),
+           "image full");
+    memcpy (&image[image_length], &record, sizeof (record));
+    command[0] = opcode;
+    memcpy (&command[1], data, data_length);
+    memcpy (&command[record.command_length], expected, expected_length);
+    image_length += (uint32_t) (sizeof (record) + ((record.command_length + expected_length + 3u) & ~3u));
+    image_num_records++;
+}
+
+
+/**
+ * @brief Append a GET_LAST_STATUS record which expects the given status of the previous command
+ */
+static void image_add_status_check (const uint8_t expected_status)
+{
+    image_add_record (SIM_CC3100_OPCODE_GET_LAST_STATUS, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      &expected_status, 1, 1, 100);
+}
+
+
+/**
+ * @brief Complete the header of the image, and write it to a file in the work directory
+ * @param[in] name The name of the image file
+ * @param[out] path The path of the image file
+ * @param[in] path_size The size of path
+ */
+static void image_save (const char *const name, char *const path, const size_t path_size)
+{
+    const cc3100_programmer_image_header_t header =
+    {
+        .magic = CC3100_PROGRAMMER_IMAGE_MAGIC,
+        .num_records = image_num_records,
+        .records_length = image_length - (uint32_t) sizeof (header),
+        .records_crc = crc32 (&image[sizeof (header)], image_length - sizeof (header))
+    };
+    FILE *image_file;
+
+    memcpy (image, &header, sizeof (header));
+    snprintf (path, path_size, "%s/%s", work_dir, name);
+    image_file = fopen (path, "wb");
+    CHECK ((image_file != NULL) && (fwrite (image, 1, image_length, image_file) == image_length),
+           "can't write %s: %s", path, strerror (errno));
+    fclose (image_file);
+}
+
+
+/**
+ * @brief Compose an image which formats the serial flash, checks the bootloader version and uploads a file in
+ *        chunks, checking the status after each stage
+ */
+static void compose_upload_image (void)
+{
+    uint8_t start_upload[4 + sizeof (FILE_NAME)];
+    uint8_t chunk[4 + FILE_CHUNK_LENGTH];
+
+    for (uint32_t offset = 0; offset < FILE_LENGTH; offset++)
+    {
+        file_contents[offset] = (uint8_t) ((offset * 7) + (offset >> 8));
+    }
+
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_GET_VERSION_INFO, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      sim_cc3100_version, 4, sizeof (sim_cc3100_version), 100);
+    image_add_record (SIM_CC3100_OPCODE_FORMAT_FLASH, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 1000);
+    image_add_status_check (SIM_CC3100_STATUS_SUCCESS);
+
+    put_be32 (start_upload, FILE_LENGTH);
+    memcpy (&start_upload[4], FILE_NAME, sizeof (FILE_NAME));
+    image_add_record (SIM_CC3100_OPCODE_START_UPLOAD, start_upload, sizeof (start_upload),
+                      CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    for (uint32_t offset = 0; offset < FILE_LENGTH; offset += FILE_CHUNK_LENGTH)
+    {
+        const uint16_t length = (uint16_t) (((FILE_LENGTH - offset) < FILE_CHUNK_LENGTH) ?
+                                            (FILE_LENGTH - offset) : FILE_CHUNK_LENGTH);
+
+        put_be32 (chunk, offset);
+        memcpy (&chunk[4], &file_contents[offset], length);
+        image_add_record (SIM_CC3100_OPCODE_FILE_CHUNK, chunk, (uint16_t) (4 + length),
+                          CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    }
+    image_add_status_check (SIM_CC3100_STATUS_SUCCESS);
+    image_add_record (SIM_CC3100_OPCODE_FINISH_UPLOAD, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    image_add_status_check (SIM_CC3100_STATUS_SUCCESS);
+}
+
+
+/**
+ * @brief Run the client under the pty simulator
+ * @param[in] sim_options Options for the simulator
+ * @param[in] image_path The image for the client
+ * @param[in] window The window of queued commands for the client
+ * @param[in] entry_timeout_ms The time the client allows for entering the bootloader
+ * @return Returns true if the client exited with success
+ */
+static bool run_client (const char *const sim_options, const char *const image_path, const uint32_t window,
+                        const uint32_t entry_timeout_ms)
+{
+    char command[4096];
+    int status;
+
+    snprintf (command, sizeof (command), "'%s' %s -o '%s' -- '%s' -p -d @PTY@ -i '%s' -w %u -e %u",
+              pty_sim_path, sim_options, work_dir, flash_path, image_path, window, entry_timeout_ms);
+    printf ("%s\n", command);
+    fflush (stdout);
+    status = system (command);
+    CHECK (status != -1, "can't run %s", command);
+
+    return WIFEXITED (status) && (WEXITSTATUS (status) == 0);
+}
+
+
+/**
+ * @brief Upload the file with a window of queued commands, and check the file saved by the simulator
+ */
+static void test_upload (const char *const image_path, const uint32_t window)
+{
+    uint8_t saved[FILE_LENGTH + 1];
+    char saved_path[1024];
+    FILE *saved_file;
+    size_t saved_length;
+
+    snprintf (saved_path, sizeof (saved_path), "%s/%s", work_dir, SAVED_FILE_NAME);
+    remove (saved_path);
+    CHECK (run_client ("", image_path, window, 2000), "window %u: upload failed", window);
+
+    saved_file = fopen (saved_path, "rb");
+    CHECK (saved_file != NULL, "window %u: %s not saved", window, saved_path);
+    saved_length = fread (saved, 1, sizeof (saved), saved_file);
+    fclose (saved_file);
+    CHECK (saved_length == FILE_LENGTH, "window %u: saved %zu bytes, expected %u", window, saved_length,
+           FILE_LENGTH);
+    for (size_t offset = 0; offset < FILE_LENGTH; offset++)
+    {
+        CHECK (saved[offset] == file_contents[offset], "window %u: byte %zu saved as 0x%02x, uploaded 0x%02x",
+               window, offset, saved[offset], file_contents[offset]);
+    }
+}
+
+
+/**
+ * @brief Check the client fails when a later command in a window gets an unexpected response
+ */
+static void test_response_mismatch (void)
+{
+    char image_path[1024];
+
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_FORMAT_FLASH, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 1000);
+    image_add_record (SIM_CC3100_OPCODE_FINISH_UPLOAD, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    image_add_status_check (SIM_CC3100_STATUS_SUCCESS);
+    image_save ("mismatch.bin", image_path, sizeof (image_path));
+
+    CHECK (!run_client ("", image_path, 8, 2000), "FINISH_UPLOAD without an upload didn't fail");
+}
+
+
+/**
+ * @brief Check the client fails when the break isn't acknowledged, as the CC3100 only echoes
+ */
+static void test_no_bootloader (const char *const image_path)
+{
+    CHECK (!run_client ("-e", image_path, 8, 200), "entered the bootloader of an echoing CC3100");
+}
+
+
+int main (int argc, char *argv[])
+{
+    char image_path[1024];
+
+    if (argc != 4)
+    {
+        fprintf (stderr, "Usage: %s <cc3100_pty_sim> <cc3100_flash> <work directory>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    pty_sim_path = argv[1];
+    flash_path = argv[2];
+    work_dir = argv[3];
+    CHECK ((mkdir (work_dir, 0777) == 0) || (errno == EEXIST), "can't create %s: %s", work_dir, strerror (errno));
+
+    compose_upload_image ();
+    image_save ("upload.bin", image_path, sizeof (image_path));
+    test_upload (image_path, 1);
+    test_upload (image_path, 8);
+    test_response_mismatch ();
+    test_no_bootloader (image_path);
+
+    printf ("PASS test_cc3100_flash_pty\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+/*
+ * @file test_cc3100_programmer.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test standalone programming of the CC3100 against the bootloader mode of the CC3100 model
+ * @details The USB host writes an image of bootloader commands to the TM4C flash with vendor requests, starts a
+ *          programming run, and polls the status until the run completes. Checks that:
+ *  - An image which formats the serial flash and uploads a file passes, and the file uploaded matches.
+ *  - The UART is returned to the bridge at the line coding it was using.
+ *  - An image with an invalid CRC fails before the CC3100 is touched.
+ *  - Failures to enter the bootloader, a missing acknowledgement, and a response which doesn't match the expected
+ *    bytes are each reported with the record which failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/uart.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+
+#include "cc3100_programmer.h"
+#include "vendor_requests.h"
+
+#include "sim_gpio.h"
+#include "sim_test.h"
+
+/** The time allowed for a programming run which is expected to complete */
+#define RUN_TIMEOUT SIM_MS (5000)
+
+/** The file uploaded by the image, larger than one command so is sent in chunks */
+#define FILE_NAME "/sys/servicepack.ucf"
+#define FILE_LENGTH 10000
+#define FILE_CHUNK_LENGTH 1024
+
+/** The image being composed, as the header followed by the records */
+static uint8_t image[CC3100_PROGRAMMER_IMAGE_SIZE];
+static uint32_t image_length;
+static uint32_t image_num_records;
+
+
+static uint32_t crc32 (const uint8_t *const data, const size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t byte_index = 0; byte_index < length; byte_index++)
+    {
+        crc ^= data[byte_index];
+        for (uint32_t bit_index = 0; bit_index < 8; bit_index++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+
+static void put_be32 (uint8_t *const data, const uint32_t value)
+{
+    data[0] = (uint8_t) (value >> 24);
+    data[1] = (uint8_t) (value >> 16);
+    data[2] = (uint8_t) (value >> 8);
+    data[3] = (uint8_t) value;
+}
+
+
+static void image_start (void)
+{
+    memset (image, 0, sizeof (image));
+    image_length = sizeof (cc3100_programmer_image_header_t);
+    image_num_records = 0;
+}
+
+
+/**
+ * @brief Append a record to the image
+ * @param[in] opcode The bootloader command
+ * @param[in] data The data which follows the opcode in the command
+ * @param[in] data_length The number of bytes of data
+ * @param[in] response The cc3100_programmer_response_t
+ * @param[in] expected The bytes expected at the start of the response
+ * @param[in] expected_length The number of expected bytes
+ * @param[in] response_length The length, or maximum length, of the response
+ * @param[in] timeout_ms The time allowed for the acknowledgement and then the response
+ */
+static void image_add_record (const uint8_t opcode, const void *const data, const uint16_t data_length,
+                              const cc3100_programmer_response_t response,
+                              const void *const expected, const uint8_t expected_length,
+                              const uint16_t response_length, const uint16_t timeout_ms)
+{
+    const cc3100_programmer_record_t record =
+    {
+        .command_length = (uint16_t) (1 + data_length),
+        .response = (uint8_t) response,
+        .expected_length = expected_length,
+        .response_length = response_length,
+        .timeout_ms = timeout_ms
+    };
+    uint8_t *const command = &image[image_length + sizeof (record)];
+
+    SIM_TEST_CHECK ((image_length + sizeof (record) + record.command_length + expected_length + 3) <=
+                    sizeof (image), "image full");
+    memcpy (&image[image_length], &record, sizeof (record));
+    command[0] = opcode;
+    memcpy (&command[1], data, data_length);
+    memcpy (&command[record.command_length], expected, expected_length);
+    image_length += (uint32_t) (sizeof (record) + ((record.command_length + expected_length + 3u) & ~3u));
+    image_num_records++;
+}
+
+
+/**
+ * @brief Append a GET_LAST_STATUS record which expects the previous command to have succeeded
+ */
+static void image_add_status_check (void)
+{
+    static const uint8_t success = SIM_CC3100_STATUS_SUCCESS;
+
+    image_add_record (SIM_CC3100_OPCODE_GET_LAST_STATUS, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      &success, 1, 1, 100);
+}
+
+
+/**
+ * @brief Complete the header of the image, and write it to the bridge with vendor requests
+ * @param[in] corrupt_crc When true the CRC in the header is made invalid
+ */
+static void image_write (const bool corrupt_crc)
+{
+    const cc3100_programmer_image_header_t header =
+    {
+        .magic = CC3100_PROGRAMMER_IMAGE_MAGIC,
+        .num_records = image_num_records,
+        .records_length = image_length - (uint32_t) sizeof (header),
+        .records_crc = crc32 (&image[sizeof (header)], image_length - sizeof (header)) ^ (corrupt_crc ? 1u : 0u)
+    };
+
+    memcpy (image, &header, sizeof (header));
+    for (uint32_t offset = 0; offset < image_length; offset += 64)
+    {
+        const uint16_t length = (uint16_t) (((image_length - offset) < 64) ? (image_length - offset) : 64);
+        const tUSBRequest setup =
+        {
+            .bmRequestType = USB_RTYPE_VENDOR | USB_RTYPE_DEVICE,
+            .bRequest = VENDOR_REQUEST_PROGRAMMER_WRITE_IMAGE,
+            .wValue = (uint16_t) offset,
+            .wIndex = (uint16_t) (offset >> 16),
+            .wLength = length
+        };
+
+        SIM_TEST_CHECK (sim_usb_host_control (&setup, &image[offset]) == length,
+                        "PROGRAMMER_WRITE_IMAGE at offset %u stalled", offset);
+    }
+}
+
+
+static void get_status (cc3100_programmer_status_t *const status)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_PROGRAMMER_STATUS, 0, status, sizeof (*status)) ==
+                    sizeof (*status), "GET_PROGRAMMER_STATUS failed");
+}
+
+
+/**
+ * @brief Start a programming run, and poll the status until it completes as the USB host would
+ * @param[out] status The final status
+ * @param[in] timeout The time allowed for the run
+ */
+static void run_programmer (cc3100_programmer_status_t *const status, const sim_time_t timeout)
+{
+    const sim_time_t deadline = sim_now + timeout;
+
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_PROGRAMMER_RUN, 0, NULL, 0) == 0, "PROGRAMMER_RUN stalled");
+    do
+    {
+        sim_run_for (SIM_MS (10));
+        get_status (status);
+        SIM_TEST_CHECK (sim_now < deadline, "programming run didn't complete, state %u", status->state);
+    } while ((status->state == CC3100_PROGRAMMER_PENDING) || (status->state == CC3100_PROGRAMMER_RUNNING));
+}
+
+
+/**
+ * @brief Check that a run failed with the expected error on the expected record, and the red LED is lit
+ */
+static void check_failed (const char *const description, const cc3100_programmer_status_t *const status,
+                          const cc3100_programmer_error_t error, const uint32_t failed_record)
+{
+    SIM_TEST_CHECK (status->state == CC3100_PROGRAMMER_FAILED, "%s: state %u", description, status->state);
+    SIM_TEST_CHECK (status->error == error, "%s: error %u, expected %u", description, status->error, error);
+    SIM_TEST_CHECK (status->records_completed == failed_record, "%s: failed on record %u, expected %u",
+                    description, status->records_completed, failed_record);
+    SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTF_BASE) & (GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3)) == GPIO_PIN_1,
+                    "%s: LEDs %s", description, sim_gpio_led_description ());
+}
+
+
+/**
+ * @brief Program an image which formats the serial flash, then uploads a file in chunks
+ */
+static void test_upload (void)
+{
+    uint8_t contents[FILE_LENGTH];
+    uint8_t start[4 + sizeof (FILE_NAME)];
+    uint8_t chunk[4 + FILE_CHUNK_LENGTH];
+    cc3100_programmer_status_t status;
+    const uint8_t *uploaded;
+    size_t uploaded_length;
+    const uint32_t bootloader_entries = sim_cc3100_stats ()->bootloader_entries;
+
+    sim_test_fill_pattern (contents, sizeof (contents), 24);
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_GET_VERSION_INFO, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      sim_cc3100_version, 16, sizeof (sim_cc3100_version), 100);
+    image_add_record (SIM_CC3100_OPCODE_FORMAT_FLASH, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 1000);
+    image_add_status_check ();
+    put_be32 (start, FILE_LENGTH);
+    memcpy (&start[4], FILE_NAME, sizeof (FILE_NAME));
+    image_add_record (SIM_CC3100_OPCODE_START_UPLOAD, start, sizeof (start), CC3100_PROGRAMMER_RESPONSE_ACK,
+                      NULL, 0, 0, 100);
+    image_add_status_check ();
+    for (uint32_t offset = 0; offset < FILE_LENGTH; offset += FILE_CHUNK_LENGTH)
+    {
+        const uint16_t length = (uint16_t) (((FILE_LENGTH - offset) < FILE_CHUNK_LENGTH) ?
+                                            (FILE_LENGTH - offset) : FILE_CHUNK_LENGTH);
+
+        put_be32 (chunk, offset);
+        memcpy (&chunk[4], &contents[offset], length);
+        image_add_record (SIM_CC3100_OPCODE_FILE_CHUNK, chunk, (uint16_t) (4 + length),
+                          CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    }
+    image_add_record (SIM_CC3100_OPCODE_FINISH_UPLOAD, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    image_add_status_check ();
+    image_write (false);
+
+    run_programmer (&status, RUN_TIMEOUT);
+    SIM_TEST_CHECK ((status.state == CC3100_PROGRAMMER_PASSED) && (status.error == CC3100_PROGRAMMER_ERROR_NONE),
+                    "upload: state %u error %u on record %u", status.state, status.error, status.records_completed);
+    SIM_TEST_CHECK ((status.num_records == image_num_records) && (status.records_completed == image_num_records),
+                    "upload: completed %u of %u records, image has %u", status.records_completed,
+                    status.num_records, image_num_records);
+    SIM_TEST_CHECK ((status.response_length == 1) && (status.response[0] == SIM_CC3100_STATUS_SUCCESS),
+                    "upload: last response not the success status");
+    SIM_TEST_CHECK (status.elapsed_ms >= 300, "upload: took %u ms, less than the format time", status.elapsed_ms);
+    SIM_TEST_CHECK (status.num_image_write_failures == 0, "upload: %u image write failures",
+                    status.num_image_write_failures);
+    SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTF_BASE) & (GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3)) == GPIO_PIN_3,
+                    "upload: LEDs %s", sim_gpio_led_description ());
+
+    SIM_TEST_CHECK ((sim_cc3100_stats ()->bootloader_entries - bootloader_entries) == 1,
+                    "upload: bootloader entered %u times",
+                    sim_cc3100_stats ()->bootloader_entries - bootloader_entries);
+    SIM_TEST_CHECK (sim_cc3100_stats ()->bootloader_bad_packets == 0, "upload: %u bad packets",
+                    sim_cc3100_stats ()->bootloader_bad_packets);
+    SIM_TEST_CHECK (sim_cc3100_file_read (FILE_NAME, &uploaded, &uploaded_length), "upload: file not uploaded");
+    SIM_TEST_CHECK ((uploaded_length == FILE_LENGTH) && (memcmp (uploaded, contents, FILE_LENGTH) == 0),
+                    "upload: file contents differ");
+}
+
+
+/**
+ * @brief Check the UART has been returned to the bridge at the line coding used before the run
+ */
+static void test_bridge_restored (void)
+{
+    sim_cc3100_set_mode (SIM_CC3100_ECHO);
+    sim_cc3100_line_config (115200, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    sim_run_for (SIM_MS (1));
+    sim_test_loopback (0, 2000, 256, 7);
+    sim_cc3100_set_mode (SIM_CC3100_BOOTLOADER);
+}
+
+
+/**
+ * @brief Check that an image with an invalid CRC fails without sending a break to the CC3100
+ */
+static void test_invalid_image (void)
+{
+    const uint32_t breaks = sim_cc3100_stats ()->breaks;
+    cc3100_programmer_status_t status;
+
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_GET_VERSION_INFO, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      NULL, 0, sizeof (sim_cc3100_version), 100);
+    image_write (true);
+    run_programmer (&status, RUN_TIMEOUT);
+    check_failed ("invalid image", &status, CC3100_PROGRAMMER_ERROR_INVALID_IMAGE, 0);
+    SIM_TEST_CHECK (sim_cc3100_stats ()->breaks == breaks, "invalid image: a break was sent");
+}
+
+
+/**
+ * @brief Check the errors from the bootloader not responding as the image expects
+ */
+static void test_bootloader_errors (void)
+{
+    static const uint8_t wrong_version[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    static const uint8_t bad_chunk[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+    cc3100_programmer_status_t status;
+
+    /* The version doesn't match */
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_GET_VERSION_INFO, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      wrong_version, sizeof (wrong_version), sizeof (sim_cc3100_version), 100);
+    image_write (false);
+    run_programmer (&status, RUN_TIMEOUT);
+    check_failed ("wrong version", &status, CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH, 0);
+    SIM_TEST_CHECK ((status.response_length == sizeof (sim_cc3100_version)) &&
+                    (memcmp (status.response, sim_cc3100_version, sizeof (sim_cc3100_version)) == 0),
+                    "wrong version: response not reported");
+
+    /* A chunk without an upload is rejected, which is only seen in the following status */
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_FORMAT_FLASH, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 1000);
+    image_add_record (SIM_CC3100_OPCODE_FILE_CHUNK, bad_chunk, sizeof (bad_chunk), CC3100_PROGRAMMER_RESPONSE_ACK,
+                      NULL, 0, 0, 100);
+    image_add_status_check ();
+    image_write (false);
+    run_programmer (&status, RUN_TIMEOUT);
+    check_failed ("rejected chunk", &status, CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH, 2);
+    SIM_TEST_CHECK ((status.response_length == 1) && (status.response[0] == SIM_CC3100_STATUS_FAILED),
+                    "rejected chunk: status 0x%02x not reported", status.response[0]);
+
+    /* The format takes longer than the timeout of the record */
+    image_start ();
+    image_add_record (SIM_CC3100_OPCODE_GET_VERSION_INFO, NULL, 0, CC3100_PROGRAMMER_RESPONSE_PACKET,
+                      NULL, 0, sizeof (sim_cc3100_version), 100);
+    image_add_record (SIM_CC3100_OPCODE_FORMAT_FLASH, NULL, 0, CC3100_PROGRAMMER_RESPONSE_ACK, NULL, 0, 0, 100);
+    image_write (false);
+    run_programmer (&status, RUN_TIMEOUT);
+    check_failed ("format timeout", &status, CC3100_PROGRAMMER_ERROR_NO_ACK, 1);
+
+    /* The CC3100 boots its application rather than the bootloader */
+    sim_cc3100_set_mode (SIM_CC3100_SINK);
+    run_programmer (&status, RUN_TIMEOUT);
+    check_failed ("no bootloader", &status, CC3100_PROGRAMMER_ERROR_NO_BOOTLOADER, 0);
+    SIM_TEST_CHECK (!sim_cc3100_bootloader_active (), "no bootloader: the bootloader was entered");
+    sim_cc3100_set_mode (SIM_CC3100_BOOTLOADER);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_BOOTLOADER);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    SIM_TEST_CHECK (!sim_cc3100_bootloader_active (), "the bootloader was entered at reset");
+
+    test_upload ();
+    test_bridge_restored ();
+    test_invalid_image ();
+    test_bootloader_errors ();
+    test_upload ();
+    test_bridge_restored ();
+
+    printf ("PASS test_cc3100_programmer: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,335 @@
+/*
+ * @file test_cc3100_sequence.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the timed sequences on the CC3100BOOST nHIB and nRESET signals and the UART break
+ * @details The changes in nHIB and nRESET are recorded with their times, to check that:
+ *  - VENDOR_REQUEST_RUN_SEQUENCE applies each step after the delay of the previous step, and the sequence enters the
+ *    CC3100 bootloader. VENDOR_REQUEST_GET_SEQUENCE_STATUS reports the time the final step was applied, and the time
+ *    of the bootloader acknowledgement in response_us.
+ *  - Invalid sequences are rejected without changing any signal, either by stalling the request or with the
+ *    CC3100_SEQUENCE_REJECTED state.
+ *  - VENDOR_REQUEST_SET_BREAK_SEQUENCE changes the nHIB pulse on a CDC SEND_BREAK, an invalid sequence leaves the
+ *    previous sequence in place, and an empty sequence restores the default 100 ms pulse.
+ *  - A CDC CLEAR_BREAK during the break sequence aborts it, deasserting the signals at once.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "bridge_hal.h"
+#include "cc3100_sequence.h"
+#include "vendor_requests.h"
+
+#include "sim_gpio.h"
+#include "sim_test.h"
+
+/** The maximum error allowed in the time a step is applied, for the one-shot timer interrupt latency */
+#define STEP_TOLERANCE_US 20
+
+/** The maximum number of signal changes recorded */
+#define MAX_EDGES 32
+
+/** A change in nHIB or nRESET */
+typedef struct
+{
+    sim_time_t time;
+    /** CC3100_NHIB_PIN or CC3100_NRESET_PIN */
+    uint8_t pin;
+    bool high;
+} signal_edge_t;
+
+static signal_edge_t edges[MAX_EDGES];
+static uint32_t num_edges;
+static uint8_t previous_levels;
+
+
+static void signals_changed (void *context, uint32_t port_base, uint8_t levels)
+{
+    static const uint8_t pins[] = {CC3100_NHIB_PIN, CC3100_NRESET_PIN};
+
+    (void) context;
+    (void) port_base;
+    for (uint32_t pin_index = 0; pin_index < (sizeof (pins) / sizeof (pins[0])); pin_index++)
+    {
+        if (((levels ^ previous_levels) & pins[pin_index]) && (num_edges < MAX_EDGES))
+        {
+            edges[num_edges].time = sim_now;
+            edges[num_edges].pin = pins[pin_index];
+            edges[num_edges].high = (levels & pins[pin_index]) != 0;
+            num_edges++;
+        }
+    }
+    previous_levels = levels;
+}
+
+
+static void clear_edges (void)
+{
+    num_edges = 0;
+}
+
+
+static double edge_delay_us (const uint32_t from, const uint32_t to)
+{
+    return (double) (edges[to].time - edges[from].time) / (SIM_CPU_HZ / 1000000u);
+}
+
+
+static void check_edge (const uint32_t index, const uint8_t pin, const bool high, const double delay_us)
+{
+    SIM_TEST_CHECK (index < num_edges, "only %u signal changes, expected change %u", num_edges, index);
+    SIM_TEST_CHECK ((edges[index].pin == pin) && (edges[index].high == high),
+                    "change %u: %s went %s, expected %s %s", index,
+                    (edges[index].pin == CC3100_NHIB_PIN) ? "nHIB" : "nRESET", edges[index].high ? "high" : "low",
+                    (pin == CC3100_NHIB_PIN) ? "nHIB" : "nRESET", high ? "high" : "low");
+    SIM_TEST_CHECK ((edge_delay_us (0, index) >= delay_us) &&
+                    (edge_delay_us (0, index) <= (delay_us + STEP_TOLERANCE_US)),
+                    "change %u: at %.2f us, expected %.0f us", index, edge_delay_us (0, index), delay_us);
+}
+
+
+static void get_status (cc3100_sequence_status_t *const status)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_SEQUENCE_STATUS, 0, status, sizeof (*status)) ==
+                    sizeof (*status), "GET_SEQUENCE_STATUS failed");
+}
+
+
+static int32_t run_sequence (const cc3100_sequence_step_t *const steps, const uint32_t num_steps)
+{
+    return sim_test_vendor_out (VENDOR_REQUEST_RUN_SEQUENCE, 0, steps, (uint16_t) (num_steps * sizeof (steps[0])));
+}
+
+
+static void set_break_sequence (const cc3100_sequence_step_t *const steps, const uint32_t num_steps)
+{
+    const uint16_t length = (uint16_t) (num_steps * sizeof (steps[0]));
+
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_SET_BREAK_SEQUENCE, 0, steps, length) == length,
+                    "SET_BREAK_SEQUENCE stalled");
+}
+
+
+/**
+ * @brief Run a sequence which powers the CC3100 up during a break, and check the step timing and response time
+ */
+static void test_run_sequence (void)
+{
+    static const cc3100_sequence_step_t steps[] =
+    {
+        {CC3100_SEQUENCE_NRESET, CC3100_SEQUENCE_NRESET, 0, 2000},
+        {CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, 0, 3000},
+        {CC3100_SEQUENCE_NRESET, 0, 0, 5000},
+        {CC3100_SEQUENCE_NHIB, 0, 0, 0}
+    };
+    const uint32_t num_steps = sizeof (steps) / sizeof (steps[0]);
+    cc3100_sequence_status_t status;
+    uint8_t ack[2];
+
+    clear_edges ();
+    SIM_TEST_CHECK (run_sequence (steps, num_steps) == sizeof (steps), "RUN_SEQUENCE stalled");
+    get_status (&status);
+    SIM_TEST_CHECK ((status.state == CC3100_SEQUENCE_RUNNING) && (status.steps_applied == 1) &&
+                    (status.completed_us == 0) && (status.response_us == UINT32_MAX),
+                    "after the first step: state %u, %u steps applied, completed %u us, response %u us",
+                    status.state, status.steps_applied, status.completed_us, status.response_us);
+
+    sim_run_for (SIM_MS (20));
+    check_edge (0, CC3100_NRESET_PIN, false, 0);
+    check_edge (1, CC3100_NHIB_PIN, false, 2000);
+    check_edge (2, CC3100_NRESET_PIN, true, 5000);
+    check_edge (3, CC3100_NHIB_PIN, true, 10000);
+    SIM_TEST_CHECK (num_edges == 4, "%u signal changes, expected 4", num_edges);
+    SIM_TEST_CHECK (sim_uart_breaking (UART1_BASE), "break not held after the sequence");
+    SIM_TEST_CHECK (sim_cc3100_bootloader_active (), "the sequence didn't enter the bootloader");
+
+    get_status (&status);
+    printf ("run sequence: completed %u us, response %u us\n", status.completed_us, status.response_us);
+    SIM_TEST_CHECK ((status.state == CC3100_SEQUENCE_COMPLETE) && (status.num_steps == num_steps) &&
+                    (status.steps_applied == num_steps), "state %u with %u of %u steps applied", status.state,
+                    status.steps_applied, status.num_steps);
+    SIM_TEST_CHECK ((status.completed_us >= 10000) && (status.completed_us <= (10000 + STEP_TOLERANCE_US)),
+                    "completed at %u us, expected 10000 us", status.completed_us);
+    /* The acknowledgement is seen by the UART receive timeout, after two characters and 32 bit periods */
+    SIM_TEST_CHECK ((status.response_us > status.completed_us) && (status.response_us < (status.completed_us + 200)),
+                    "response at %u us, completed at %u us", status.response_us, status.completed_us);
+    SIM_TEST_CHECK (sim_test_wait_read_available (0, sizeof (ack), SIM_MS (10)) &&
+                    (sim_usb_host_read (0, ack, sizeof (ack)) == sizeof (ack)) &&
+                    (ack[0] == SIM_CC3100_ACK_0) && (ack[1] == SIM_CC3100_ACK_1), "no bootloader acknowledgement");
+
+    /* Clearing the break after the sequence has completed leaves the state */
+    sim_test_send_break (0, 0);
+    sim_run_for (SIM_MS (1));
+    get_status (&status);
+    SIM_TEST_CHECK (status.state == CC3100_SEQUENCE_COMPLETE, "CLEAR_BREAK changed the state to %u", status.state);
+    SIM_TEST_CHECK (!sim_uart_breaking (UART1_BASE), "break not cleared");
+    printf ("PASS run_sequence\n");
+}
+
+
+/**
+ * @brief Check that invalid sequences are rejected without changing any signal
+ */
+static void test_invalid_sequences (void)
+{
+    static const cc3100_sequence_step_t invalid_steps[][2] =
+    {
+        /* A signal which doesn't exist */
+        {{CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_NHIB, 0, 1000}, {0x08, 0, 0, 0}},
+        /* A signal asserted which isn't changed by the step */
+        {{CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_NHIB | CC3100_SEQUENCE_NRESET, 0, 1000},
+         {CC3100_SEQUENCE_NHIB, 0, 0, 0}},
+        /* The reserved field set */
+        {{CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_NHIB, 1, 1000}, {CC3100_SEQUENCE_NHIB, 0, 0, 0}},
+        /* A delay beyond the range of the timer */
+        {{CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_NHIB, 0, CC3100_SEQUENCE_MAX_DELAY_US + 1},
+         {CC3100_SEQUENCE_NHIB, 0, 0, 0}}
+    };
+    cc3100_sequence_step_t too_many_steps[CC3100_SEQUENCE_MAX_STEPS + 1];
+    cc3100_sequence_status_t status;
+
+    clear_edges ();
+    for (uint32_t sequence = 0; sequence < (sizeof (invalid_steps) / sizeof (invalid_steps[0])); sequence++)
+    {
+        SIM_TEST_CHECK (run_sequence (invalid_steps[sequence], 2) == sizeof (invalid_steps[sequence]),
+                        "invalid sequence %u: RUN_SEQUENCE stalled", sequence);
+        get_status (&status);
+        SIM_TEST_CHECK (status.state == CC3100_SEQUENCE_REJECTED, "invalid sequence %u: state %u", sequence,
+                        status.state);
+    }
+
+    /* Requests whose data stage isn't 1 to CC3100_SEQUENCE_MAX_STEPS whole steps are stalled */
+    memset (too_many_steps, 0, sizeof (too_many_steps));
+    SIM_TEST_CHECK (run_sequence (too_many_steps, CC3100_SEQUENCE_MAX_STEPS + 1) < 0, "too many steps accepted");
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_RUN_SEQUENCE, 0, too_many_steps,
+                                         sizeof (too_many_steps[0]) + 1) < 0, "a partial step accepted");
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_RUN_SEQUENCE, 0, NULL, 0) < 0, "an empty sequence accepted");
+
+    sim_run_for (SIM_MS (5));
+    SIM_TEST_CHECK (num_edges == 0, "invalid sequences changed the signals %u times", num_edges);
+    SIM_TEST_CHECK (!sim_uart_breaking (UART1_BASE), "an invalid sequence set break");
+    printf ("PASS invalid_sequences\n");
+}
+
+
+/**
+ * @brief Send a break, and check the width of the nHIB pulse
+ */
+static void check_break_pulse (const double expected_width_us)
+{
+    cc3100_sequence_status_t status;
+
+    clear_edges ();
+    sim_test_send_break (0, 0xFFFF);
+    sim_run_for (SIM_US (expected_width_us) + SIM_MS (5));
+    SIM_TEST_CHECK (num_edges == 2, "%u signal changes for a break, expected 2", num_edges);
+    check_edge (0, CC3100_NHIB_PIN, false, 0);
+    check_edge (1, CC3100_NHIB_PIN, true, expected_width_us);
+    SIM_TEST_CHECK (sim_uart_breaking (UART1_BASE), "break not held after the nHIB pulse");
+    get_status (&status);
+    SIM_TEST_CHECK ((status.state == CC3100_SEQUENCE_COMPLETE) &&
+                    (status.completed_us >= expected_width_us) &&
+                    (status.completed_us <= (expected_width_us + STEP_TOLERANCE_US)),
+                    "break sequence state %u completed at %u us, expected %.0f us", status.state,
+                    status.completed_us, expected_width_us);
+
+    sim_test_send_break (0, 0);
+    sim_run_for (SIM_MS (1));
+    SIM_TEST_CHECK (!sim_uart_breaking (UART1_BASE), "break not cleared");
+}
+
+
+/**
+ * @brief Replace the break sequence, and check it is run on a CDC SEND_BREAK
+ */
+static void test_break_sequence (void)
+{
+    static const cc3100_sequence_step_t short_pulse[] =
+    {
+        {CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB, 0, 20000},
+        {CC3100_SEQUENCE_NHIB, 0, 0, 0}
+    };
+    static const cc3100_sequence_step_t invalid[] =
+    {
+        {CC3100_SEQUENCE_NHIB, CC3100_SEQUENCE_BREAK, 0, 1000}
+    };
+
+    check_break_pulse (100000);
+
+    set_break_sequence (short_pulse, sizeof (short_pulse) / sizeof (short_pulse[0]));
+    check_break_pulse (20000);
+
+    /* An invalid break sequence is ignored */
+    set_break_sequence (invalid, sizeof (invalid) / sizeof (invalid[0]));
+    check_break_pulse (20000);
+
+    /* An empty break sequence restores the default */
+    set_break_sequence (NULL, 0);
+    check_break_pulse (100000);
+    printf ("PASS break_sequence\n");
+}
+
+
+/**
+ * @brief Clear the break during the break sequence, and check the sequence is aborted
+ */
+static void test_abort (void)
+{
+    static const cc3100_sequence_step_t long_pulse[] =
+    {
+        {CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB | CC3100_SEQUENCE_NRESET,
+         CC3100_SEQUENCE_BREAK | CC3100_SEQUENCE_NHIB | CC3100_SEQUENCE_NRESET, 0, 50000},
+        {CC3100_SEQUENCE_NRESET, 0, 0, 0},
+        {CC3100_SEQUENCE_NHIB, 0, 0, 0}
+    };
+    cc3100_sequence_status_t status;
+
+    set_break_sequence (long_pulse, sizeof (long_pulse) / sizeof (long_pulse[0]));
+    clear_edges ();
+    sim_test_send_break (0, 0xFFFF);
+    sim_run_for (SIM_MS (10));
+    sim_test_send_break (0, 0);
+    sim_run_for (SIM_MS (100));
+
+    SIM_TEST_CHECK (num_edges == 4, "%u signal changes, expected 4", num_edges);
+    SIM_TEST_CHECK (!edges[0].high && !edges[1].high && edges[2].high && edges[3].high,
+                    "signals not asserted then deasserted");
+    SIM_TEST_CHECK ((edge_delay_us (0, 2) >= 10000) && (edge_delay_us (0, 3) < 11000),
+                    "signals deasserted at %.2f and %.2f us, expected on CLEAR_BREAK at 10000 us",
+                    edge_delay_us (0, 2), edge_delay_us (0, 3));
+    SIM_TEST_CHECK (!sim_uart_breaking (UART1_BASE), "break not cleared");
+    get_status (&status);
+    SIM_TEST_CHECK ((status.state == CC3100_SEQUENCE_ABORTED) && (status.steps_applied == 1) &&
+                    (status.num_steps == 3) && (status.completed_us == 0),
+                    "state %u with %u of %u steps applied, completed %u us", status.state, status.steps_applied,
+                    status.num_steps, status.completed_us);
+
+    set_break_sequence (NULL, 0);
+    printf ("PASS abort\n");
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_BOOTLOADER);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, SIM_CC3100_BOOTLOADER_BAUD,
+                              UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    previous_levels = sim_gpio_levels (CC3100_NHIB_PORT_BASE);
+    sim_gpio_observe (CC3100_NHIB_PORT_BASE, CC3100_NHIB_PIN | CC3100_NRESET_PIN, signals_changed, NULL);
+
+    test_run_sequence ();
+    sim_cc3100_set_mode (SIM_CC3100_SINK);
+    test_invalid_sequences ();
+    test_break_sequence ();
+    test_abort ();
+
+    printf ("PASS test_cc3100_sequence\n");
+
+    return 0;
+}
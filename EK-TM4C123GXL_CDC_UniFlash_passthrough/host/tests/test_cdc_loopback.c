@@ -0,0 +1,77 @@
+/*
+ * @file test_cdc_loopback.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the CDC data path of the bridge, by looping data back through a CC3100 model which echoes
+ * @details Covers enumeration with the identity of the CDC device, the CDC line coding requests, and data integrity
+ *          across several line settings and host write sizes.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/usb-ids.h"
+
+#include "sim_test.h"
+
+
+/**
+ * @brief Check that GET_LINE_CODING returns what was last set
+ */
+static void check_line_coding (const uint32_t baud, const uint8_t stop, const uint8_t parity, const uint8_t data_bits)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_GET_LINE_CODING,
+        .wValue = 0,
+        .wIndex = sim_usb_host_port_interface (0),
+        .wLength = sizeof (tLineCoding)
+    };
+    tLineCoding line_coding;
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, &line_coding) == sizeof (line_coding), "GET_LINE_CODING failed");
+    SIM_TEST_CHECK ((line_coding.ui32Rate == baud) && (line_coding.ui8Stop == stop) &&
+                    (line_coding.ui8Parity == parity) && (line_coding.ui8Databits == data_bits),
+                    "GET_LINE_CODING returned %u %u %u %u", line_coding.ui32Rate, line_coding.ui8Stop,
+                    line_coding.ui8Parity, line_coding.ui8Databits);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_ECHO);
+    SIM_TEST_CHECK (sim_usb_host_num_ports () == 1, "expected one CDC port, found %u", sim_usb_host_num_ports ());
+    sim_test_check_device_identity (USB_VID_TI_1CBE, USB_PID_SERIAL, USB_CONF_ATTR_SELF_PWR, 0);
+    SIM_TEST_CHECK (sim_cc3100_powered (), "the CC3100 isn't powered after reset");
+    check_line_coding (115200, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    /* Single characters, which are only sent to the host by the receive timeout or flush policy */
+    sim_test_loopback (0, 64, 1, 1);
+
+    /* Bulk transfers at the default line coding */
+    sim_test_loopback (0, 8192, 512, 2);
+
+    /* The maximum baud rate used by UniFlash, with writes larger than the buffers of the bridge */
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    check_line_coding (921600, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8);
+    sim_test_loopback (0, 65536, 16384, 3);
+
+    /* A frame format with parity and two stop bits */
+    sim_test_set_line_coding (0, 230400, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_TWO | UART_CONFIG_PAR_ODD);
+    check_line_coding (230400, USB_CDC_STOP_BITS_2, USB_CDC_PARITY_ODD, 8);
+    sim_test_loopback (0, 4096, 256, 4);
+
+    SIM_TEST_CHECK (sim_cc3100_stats ()->rx_errors == 0, "the CC3100 received %llu characters with errors",
+                    (unsigned long long) sim_cc3100_stats ()->rx_errors);
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns == 0, "UART1 overran");
+    printf ("PASS test_cdc_loopback: %llu characters looped back in %.3f s of virtual time\n",
+            (unsigned long long) sim_cc3100_stats ()->echoed, (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * @file test_concurrent_streams.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test that the extra UART channels carry concurrent streams alongside the CC3100BOOST channel
+ * @details Run with UART_EXTRA_CHANNELS=2, where CDC port 0 is UART1 to the CC3100, port 1 is UART3 and port 2 is
+ *          UART2. Each extra UART has a peer which echoes the characters it receives. Checks that:
+ *  - Streams written to all ports at once are looped back intact, and that the extra channels moved the characters
+ *    with the uDMA in both directions, in the same way as channel 0.
+ *  - No line errors or overruns occur on any UART.
+ *  - A line coding change on an extra port only changes that UART.
+ *  - SEND_BREAK on an extra port sends a break on its UART and pulses its nHIB for 100ms, without disturbing the
+ *    CC3100.
+ *  - Each port is enumerated with its own interface string, set in the configuration descriptor before the device
+ *    connected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/uart.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+
+#include "sim_gpio.h"
+#include "sim_test.h"
+
+/** The number of CDC ports, one per UART channel */
+#define NUM_PORTS 3
+
+/** The UART of each port */
+static const uint32_t port_uart_bases[NUM_PORTS] = {UART1_BASE, UART3_BASE, UART2_BASE};
+
+/** The nHIB pin on GPIO port E of each extra port */
+static const uint8_t port_nhib_pins[NUM_PORTS] = {0, GPIO_PIN_2, GPIO_PIN_3};
+
+/** The string index of the interface string of each port, from PORT_STRING_INDEX() in uart_channels.h */
+#define PORT_STRING_INDEX(port) (6 + (port))
+
+/** The offset of iFunction in an interface association descriptor */
+#define IAD_IFUNCTION_OFFSET 7
+
+/** The line settings of the peers */
+#define UART_CONFIG (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE)
+
+
+/**
+ * @brief Peer of an extra UART, which echoes each character received without error
+ * @param[in] context The UART base of the peer
+ */
+static void echo_peer_receive (void *context, uint8_t character, bool error)
+{
+    if (!error)
+    {
+        sim_uart_peer_send ((uint32_t) (uintptr_t) context, &character, 1);
+    }
+}
+
+
+static const sim_uart_peer_t uart3_peer =
+{
+    .receive = echo_peer_receive,
+    .break_changed = NULL,
+    .context = (void *) (uintptr_t) UART3_BASE
+};
+
+static const sim_uart_peer_t uart2_peer =
+{
+    .receive = echo_peer_receive,
+    .break_changed = NULL,
+    .context = (void *) (uintptr_t) UART2_BASE
+};
+
+
+typedef struct
+{
+    size_t length;
+} all_received_arg_t;
+
+
+static bool all_received (void *arg)
+{
+    const all_received_arg_t *const wait = arg;
+
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        if (sim_usb_host_read_available (port) < wait->length)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Write a different pattern to every port at once, and check each is looped back intact
+ * @param[in] length The number of bytes written to each port
+ * @param[in] seed The seed for the patterns
+ */
+static void test_concurrent_loopback (const size_t length, const uint32_t seed)
+{
+    uint8_t *sent[NUM_PORTS];
+    uint8_t *const received = malloc (length);
+    all_received_arg_t wait = {.length = length};
+    uint64_t rx_dma_before[NUM_PORTS];
+    uint64_t tx_dma_before[NUM_PORTS];
+    const sim_time_t timeout = 10u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (10);
+
+    SIM_TEST_CHECK (received != NULL, "out of memory");
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        sent[port] = malloc (length);
+        SIM_TEST_CHECK (sent[port] != NULL, "out of memory");
+        sim_test_fill_pattern (sent[port], length, seed + port);
+        rx_dma_before[port] = sim_uart_stats (port_uart_bases[port])->rx_dma_characters;
+        tx_dma_before[port] = sim_uart_stats (port_uart_bases[port])->tx_dma_characters;
+        sim_usb_host_write (port, sent[port], length);
+    }
+
+    SIM_TEST_CHECK (sim_run_until (all_received, &wait, timeout),
+                    "%zu byte streams: only %zu %zu %zu bytes looped back", length,
+                    sim_usb_host_read_available (0), sim_usb_host_read_available (1),
+                    sim_usb_host_read_available (2));
+
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        const sim_uart_stats_t *const stats = sim_uart_stats (port_uart_bases[port]);
+
+        SIM_TEST_CHECK (sim_usb_host_read (port, received, length) == length, "port %u: short read", port);
+        for (size_t offset = 0; offset < length; offset++)
+        {
+            SIM_TEST_CHECK (received[offset] == sent[port][offset],
+                            "port %u: byte %zu looped back as 0x%02x, sent 0x%02x",
+                            port, offset, received[offset], sent[port][offset]);
+        }
+        SIM_TEST_CHECK (sim_usb_host_read_available (port) == 0, "port %u: %zu extra bytes", port,
+                        sim_usb_host_read_available (port));
+        SIM_TEST_CHECK ((stats->tx_dma_characters - tx_dma_before[port]) == length,
+                        "port %u: only %llu of %zu characters transmitted by the uDMA", port,
+                        (unsigned long long) (stats->tx_dma_characters - tx_dma_before[port]), length);
+        SIM_TEST_CHECK ((stats->rx_dma_characters - rx_dma_before[port]) > (length / 2),
+                        "port %u: only %llu of %zu characters received by the uDMA", port,
+                        (unsigned long long) (stats->rx_dma_characters - rx_dma_before[port]), length);
+        free (sent[port]);
+    }
+    free (received);
+}
+
+
+/**
+ * @brief Check that every UART has received its characters without errors or overruns
+ */
+static void check_no_line_errors (void)
+{
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        const sim_uart_stats_t *const stats = sim_uart_stats (port_uart_bases[port]);
+
+        SIM_TEST_CHECK (stats->rx_errors == 0, "port %u: %llu line errors", port,
+                        (unsigned long long) stats->rx_errors);
+        SIM_TEST_CHECK (stats->rx_overruns == 0, "port %u: %llu overruns", port,
+                        (unsigned long long) stats->rx_overruns);
+        SIM_TEST_CHECK (sim_usb_host_serial_state (port) == 0, "port %u: SERIAL_STATE 0x%04x", port,
+                        sim_usb_host_serial_state (port));
+    }
+}
+
+
+/**
+ * @brief Change the baud rate of one extra port, and check the others are unaffected by looping back again
+ */
+static void test_independent_line_coding (void)
+{
+    const uint32_t uart1_character_cycles = sim_uart_character_cycles (UART1_BASE);
+
+    sim_test_set_line_coding (1, 460800, UART_CONFIG);
+    sim_run_for (SIM_MS (2));
+    sim_uart_peer_config (UART3_BASE, 460800, UART_CONFIG, false);
+    SIM_TEST_CHECK (sim_uart_character_cycles (UART3_BASE) < sim_uart_character_cycles (UART2_BASE),
+                    "UART3 baud rate not changed");
+    SIM_TEST_CHECK (sim_uart_character_cycles (UART1_BASE) == uart1_character_cycles, "UART1 baud rate changed");
+    test_concurrent_loopback (4096, 99);
+}
+
+
+/**
+ * @brief Send a break on each extra port, and check only its UART and nHIB are affected
+ */
+static void test_extra_port_break (void)
+{
+    const uint32_t cc3100_breaks = sim_cc3100_stats ()->breaks;
+
+    for (uint32_t port = 1; port < NUM_PORTS; port++)
+    {
+        const uint8_t nhib_pin = port_nhib_pins[port];
+
+        SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTE_BASE) & nhib_pin) != 0, "port %u: nHIB initially asserted",
+                        port);
+        sim_test_send_break (port, 0xFFFF);
+        sim_run_for (SIM_MS (1));
+        SIM_TEST_CHECK (sim_uart_breaking (port_uart_bases[port]), "port %u: no break sent", port);
+        SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTE_BASE) & nhib_pin) == 0, "port %u: nHIB not asserted", port);
+        SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTE_BASE) & port_nhib_pins[NUM_PORTS - port]) != 0,
+                        "port %u: nHIB of the other extra port asserted", port);
+
+        /* nHIB is de-asserted at the end of the pulse, while the break continues until cleared */
+        sim_run_for (SIM_MS (110));
+        SIM_TEST_CHECK ((sim_gpio_levels (GPIO_PORTE_BASE) & nhib_pin) != 0, "port %u: nHIB pulse didn't end", port);
+        SIM_TEST_CHECK (sim_uart_breaking (port_uart_bases[port]), "port %u: break ended before cleared", port);
+
+        sim_test_send_break (port, 0);
+        sim_run_for (SIM_MS (1));
+        SIM_TEST_CHECK (!sim_uart_breaking (port_uart_bases[port]), "port %u: break not cleared", port);
+    }
+
+    SIM_TEST_CHECK (!sim_uart_breaking (UART1_BASE), "a break was sent to the CC3100");
+    SIM_TEST_CHECK (sim_cc3100_stats ()->breaks == cc3100_breaks, "the CC3100 saw a break");
+}
+
+
+static int32_t get_descriptor (const uint8_t type, const uint8_t index, uint8_t *const descriptor,
+                               const uint16_t length)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD | USB_RTYPE_DEVICE,
+        .bRequest = USBREQ_GET_DESCRIPTOR,
+        .wValue = (uint16_t) ((type << 8) | index),
+        .wIndex = 0,
+        .wLength = length
+    };
+
+    return sim_usb_host_control (&setup, descriptor);
+}
+
+
+/**
+ * @brief Check the interface association and communication interface of each port name the port's own string
+ */
+static void test_port_strings (void)
+{
+    uint8_t config[512];
+    uint8_t string[64];
+    const int32_t config_length = get_descriptor (USB_DTYPE_CONFIGURATION, 0, config, sizeof (config));
+    uint32_t iad_port = 0;
+    uint32_t interface_port = 0;
+
+    SIM_TEST_CHECK (config_length > 0, "GET_DESCRIPTOR for the configuration failed");
+    for (int32_t offset = 0; (offset + 2) <= config_length; offset += config[offset])
+    {
+        const uint8_t *const descriptor = &config[offset];
+
+        SIM_TEST_CHECK (descriptor[0] >= 2, "descriptor at offset %d has length %u", offset, descriptor[0]);
+        if ((descriptor[1] == USB_DTYPE_INTERFACE_ASC) && (descriptor[4] == USB_CLASS_CDC))
+        {
+            SIM_TEST_CHECK (descriptor[IAD_IFUNCTION_OFFSET] == PORT_STRING_INDEX (iad_port),
+                            "port %u: iFunction %u", iad_port, descriptor[IAD_IFUNCTION_OFFSET]);
+            iad_port++;
+        }
+        else if ((descriptor[1] == USB_DTYPE_INTERFACE) && (descriptor[5] == USB_CLASS_CDC))
+        {
+            const tInterfaceDescriptor *const interface = (const tInterfaceDescriptor *) descriptor;
+
+            SIM_TEST_CHECK (interface->iInterface == PORT_STRING_INDEX (interface_port), "port %u: iInterface %u",
+                            interface_port, interface->iInterface);
+            interface_port++;
+        }
+    }
+    SIM_TEST_CHECK ((iad_port == NUM_PORTS) && (interface_port == NUM_PORTS),
+                    "%u interface associations and %u communication interfaces of CDC ports", iad_port,
+                    interface_port);
+
+    /* The last character of each string is the port number */
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        const int32_t length = get_descriptor (USB_DTYPE_STRING, PORT_STRING_INDEX (port), string, sizeof (string));
+
+        SIM_TEST_CHECK ((length >= 4) && (string[1] == USB_DTYPE_STRING) && (string[length - 2] == ('0' + port)),
+                        "port %u: wrong interface string", port);
+    }
+    printf ("PASS port_strings\n");
+}
+
+
+int main (void)
+{
+    sim_uart_attach (UART3_BASE, &uart3_peer);
+    sim_uart_attach (UART2_BASE, &uart2_peer);
+    sim_uart_peer_config (UART3_BASE, 115200, UART_CONFIG, false);
+    sim_uart_peer_config (UART2_BASE, 115200, UART_CONFIG, false);
+    sim_test_boot (SIM_CC3100_ECHO);
+    SIM_TEST_CHECK (sim_usb_host_num_ports () == NUM_PORTS, "the bridge has %u CDC ports, expected %u",
+                    sim_usb_host_num_ports (), NUM_PORTS);
+    test_port_strings ();
+    for (uint32_t port = 0; port < NUM_PORTS; port++)
+    {
+        sim_test_set_control_line_state (port, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    }
+
+    test_concurrent_loopback (64, 1);
+    test_concurrent_loopback (1000, 2);
+    test_concurrent_loopback (20000, 3);
+    check_no_line_errors ();
+
+    test_independent_line_coding ();
+    test_extra_port_break ();
+    test_concurrent_loopback (1000, 4);
+    check_no_line_errors ();
+
+    printf ("PASS test_concurrent_streams: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * @file test_flow_control.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Overload test of the receive flow control from the CC3100, with a USB host which reads slower than the
+ *        serial line delivers
+ * @details The CC3100 streams at the highest baud rates while the host drains at most a fixed number of bytes each
+ *          millisecond. The transfer must be lossless. With UART_RX_FLOW_CONTROL_WATERMARK the CDC transmit buffer
+ *          must never fill, since RTS is deasserted at the stop watermark.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "usb_serial_structs.h"
+#include "uart_flow_control.h"
+#include "data_path_telemetry.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The bytes streamed by the CC3100 in each test */
+#define STREAM_LENGTH (64u * 1024u)
+
+
+static void get_telemetry (data_path_telemetry_t *const telemetry)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_TELEMETRY, 0, telemetry, sizeof (*telemetry)) ==
+                    sizeof (*telemetry), "GET_TELEMETRY failed");
+}
+
+
+/**
+ * @brief Stream from the CC3100 while the host reads at a limited rate, and check no data is lost
+ * @param[in] baud The baud rate
+ * @param[in] bytes_per_ms The most bytes the host reads each millisecond
+ */
+static void test_overload (const uint32_t baud, const size_t bytes_per_ms)
+{
+    const size_t length = STREAM_LENGTH;
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    sim_time_t deadline;
+    data_path_telemetry_t telemetry;
+    size_t num_received = 0;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_set_line_coding (0, baud, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    deadline = sim_now + SIM_MS (2 * length / bytes_per_ms) + SIM_MS (100);
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CLEAR_TELEMETRY, 0, NULL, 0) == 0, "CLEAR_TELEMETRY failed");
+    sim_uart_stats_clear (UART1_BASE);
+    sim_test_fill_pattern (sent, length, baud);
+
+    /* The host only holds bytes_per_ms received bytes, which are drained each millisecond */
+    sim_usb_host_set_read_limit (0, bytes_per_ms);
+    sim_cc3100_send (sent, length);
+    while (num_received < length)
+    {
+        SIM_TEST_CHECK (sim_now < deadline, "%u baud: only %zu of %zu bytes received", baud, num_received, length);
+        sim_run_for (SIM_MS (1));
+        num_received += sim_usb_host_read (0, &received[num_received], length - num_received);
+    }
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+
+    for (size_t offset = 0; offset < length; offset++)
+    {
+        SIM_TEST_CHECK (received[offset] == sent[offset], "%u baud: byte %zu received as 0x%02x, sent 0x%02x",
+                        baud, offset, received[offset], sent[offset]);
+    }
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns == 0, "%u baud: %llu characters overran", baud,
+                    (unsigned long long) sim_uart_stats (UART1_BASE)->rx_overruns);
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_throttled_cycles > 0, "%u baud: the CC3100 was never throttled",
+                    baud);
+
+    get_telemetry (&telemetry);
+    printf ("%u baud, host reading %zu bytes/ms: %u flow control episodes, cdc_tx_buffer peak %u of %u\n",
+            baud, bytes_per_ms, telemetry.num_flow_control_episodes, telemetry.uart_to_host_peak,
+            telemetry.uart_to_host_buffer_size);
+    if (UART_RX_FLOW_CONTROL == UART_RX_FLOW_CONTROL_WATERMARK)
+    {
+        SIM_TEST_CHECK (telemetry.num_flow_control_episodes > 0, "%u baud: RTS was never deasserted", baud);
+        SIM_TEST_CHECK (telemetry.num_uart_to_host_full_episodes == 0, "%u baud: cdc_tx_buffer filled %u times",
+                        baud, telemetry.num_uart_to_host_full_episodes);
+        SIM_TEST_CHECK (telemetry.uart_to_host_peak < telemetry.uart_to_host_buffer_size,
+                        "%u baud: cdc_tx_buffer peak occupancy reached its size", baud);
+    }
+
+    free (sent);
+    free (received);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    /* The host reads at 64 KB/s, slower than the serial line */
+    test_overload (921600, 64);
+    test_overload (2000000, 64);
+
+    /* The host reads several packets at once, but still slower than the serial line */
+    test_overload (2000000, 128);
+
+    printf ("PASS test_flow_control: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
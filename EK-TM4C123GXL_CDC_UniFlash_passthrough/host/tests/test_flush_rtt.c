@@ -0,0 +1,185 @@
+/*
+ * @file test_flush_rtt.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Measure the effect of the USB IN flush policy on the round-trip time of command/response exchanges
+ * @details Each exchange is timed from the host writing a command, through the CC3100 model receiving it and
+ *          sending its response, to the host having read the complete response. The responses are sent by the
+ *          CC3100 either as one burst, or as two bursts separated by a short gap as when the bootloader sends an
+ *          acknowledgement before its status. The round-trip percentiles and the USB IN packets per response are
+ *          reported for each policy set by VENDOR_REQUEST_SET_USB_IN_FLUSH, and checked against the policy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "uart_dma.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The number of exchanges timed for each policy */
+#define NUM_EXCHANGES 200
+
+/** The gap between the bursts of a response sent in two parts */
+#define BURST_GAP SIM_US (500)
+
+/** The round-trip time percentiles of the exchanges for one policy */
+typedef struct
+{
+    sim_time_t p50;
+    sim_time_t p99;
+    double in_packets_per_response;
+} rtt_result_t;
+
+
+static int compare_times (const void *a, const void *b)
+{
+    const sim_time_t time_a = *(const sim_time_t *) a;
+    const sim_time_t time_b = *(const sim_time_t *) b;
+
+    return (time_a > time_b) - (time_a < time_b);
+}
+
+
+static int32_t set_flush_policy (const uint16_t latency_ms, const uint16_t fill_threshold)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_VENDOR | USB_RTYPE_DEVICE,
+        .bRequest = VENDOR_REQUEST_SET_USB_IN_FLUSH,
+        .wValue = latency_ms,
+        .wIndex = fill_threshold,
+        .wLength = 0
+    };
+
+    return sim_usb_host_control (&setup, NULL);
+}
+
+
+static bool cc3100_received (void *arg)
+{
+    const size_t *const length = arg;
+
+    return sim_cc3100_read_available () >= *length;
+}
+
+
+/**
+ * @brief Time command/response exchanges with the current flush policy
+ * @param[in] response_length The total length of each response
+ * @param[in] num_bursts The number of bursts in which the CC3100 sends each response, 1 or 2
+ * @param[out] result The round-trip percentiles
+ */
+static void time_exchanges (const size_t response_length, const uint32_t num_bursts, rtt_result_t *const result)
+{
+    static const uint8_t command[] = {0x00, 0x0b, 0x33, 0x21, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00};
+    uint8_t response[256];
+    uint8_t received[256];
+    sim_time_t rtts[NUM_EXCHANGES];
+    size_t command_length = sizeof (command);
+    const sim_time_t timeout = SIM_MS (100);
+    uint64_t in_packets = sim_usb_host_port_stats (0)->in_packets;
+
+    for (uint32_t exchange = 0; exchange < NUM_EXCHANGES; exchange++)
+    {
+        const sim_time_t start = sim_now;
+
+        sim_usb_host_write (0, command, sizeof (command));
+        SIM_TEST_CHECK (sim_run_until (cc3100_received, &command_length, timeout), "the command wasn't received");
+        sim_cc3100_read (received, sizeof (command));
+
+        sim_test_fill_pattern (response, response_length, exchange);
+        if (num_bursts == 1)
+        {
+            sim_cc3100_send (response, response_length);
+        }
+        else
+        {
+            const size_t first_length = response_length / 2;
+
+            sim_cc3100_send (response, first_length);
+            sim_run_for ((sim_time_t) sim_uart_character_cycles (UART1_BASE) * first_length + BURST_GAP);
+            sim_cc3100_send (&response[first_length], response_length - first_length);
+        }
+        SIM_TEST_CHECK (sim_test_wait_read_available (0, response_length, timeout),
+                        "only %zu of a %zu byte response received", sim_usb_host_read_available (0),
+                        response_length);
+        rtts[exchange] = sim_now - start;
+        SIM_TEST_CHECK ((sim_usb_host_read (0, received, response_length) == response_length) &&
+                        (memcmp (received, response, response_length) == 0), "response corrupted");
+    }
+
+    qsort (rtts, NUM_EXCHANGES, sizeof (rtts[0]), compare_times);
+    result->p50 = rtts[NUM_EXCHANGES / 2];
+    result->p99 = rtts[(NUM_EXCHANGES * 99) / 100];
+    in_packets = sim_usb_host_port_stats (0)->in_packets - in_packets;
+    result->in_packets_per_response = (double) in_packets / NUM_EXCHANGES;
+}
+
+
+/**
+ * @brief Set a flush policy, and time exchanges with it
+ */
+static void measure_policy (const uint16_t latency_ms, const uint16_t fill_threshold, const size_t response_length,
+                            const uint32_t num_bursts, rtt_result_t *const result)
+{
+    SIM_TEST_CHECK (set_flush_policy (latency_ms, fill_threshold) == 0, "latency %u threshold %u stalled",
+                    latency_ms, fill_threshold);
+    time_exchanges (response_length, num_bursts, result);
+    printf ("latency %2u ms, fill threshold %2u, %3zu byte responses in %u bursts: RTT p50 %7.1f us p99 %7.1f us, "
+            "%.2f IN packets per response\n", latency_ms, fill_threshold, response_length, num_bursts,
+            (double) result->p50 / (SIM_CPU_HZ / 1000000u), (double) result->p99 / (SIM_CPU_HZ / 1000000u),
+            result->in_packets_per_response);
+}
+
+
+int main (void)
+{
+    rtt_result_t immediate;
+    rtt_result_t delayed;
+    rtt_result_t result;
+
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+
+    /* Invalid policies are stalled */
+    SIM_TEST_CHECK (set_flush_policy (0, 0) < 0, "a zero fill threshold was accepted");
+    SIM_TEST_CHECK (set_flush_policy (0, UART_RX_DMA_BLOCK_SIZE + 1) < 0, "an excessive fill threshold was accepted");
+    SIM_TEST_CHECK (set_flush_policy (256, UART_RX_DMA_BLOCK_SIZE) < 0, "an excessive latency was accepted");
+
+    /* Flushing on the receive timeout passes a short acknowledgement to the host within a few USB frames */
+    measure_policy (0, UART_RX_DMA_BLOCK_SIZE, 2, 1, &immediate);
+    SIM_TEST_CHECK (immediate.p99 < SIM_MS (3), "the acknowledgement wasn't flushed on the receive timeout");
+
+    /* A latency delays each response by about the latency */
+    measure_policy (4, UART_RX_DMA_BLOCK_SIZE, 2, 1, &delayed);
+    SIM_TEST_CHECK ((delayed.p50 >= (immediate.p50 + SIM_MS (3))) && (delayed.p50 <= (immediate.p50 + SIM_MS (6))),
+                    "a 4 ms latency didn't delay the response by about 4 ms");
+
+    /* A response in two bursts is sent as one packet when the latency spans the gap between the bursts */
+    measure_policy (0, UART_RX_DMA_BLOCK_SIZE, 40, 2, &immediate);
+    measure_policy (2, UART_RX_DMA_BLOCK_SIZE, 40, 2, &delayed);
+    SIM_TEST_CHECK (immediate.in_packets_per_response >= 2.0, "flushing on the receive timeout sent one packet");
+    SIM_TEST_CHECK (delayed.in_packets_per_response < immediate.in_packets_per_response,
+                    "the latency didn't combine the bursts");
+
+    /* A low fill threshold passes a long response to the host in smaller packets as it is received */
+    measure_policy (0, UART_RX_DMA_BLOCK_SIZE, 200, 1, &immediate);
+    measure_policy (0, 16, 200, 1, &result);
+    SIM_TEST_CHECK (result.in_packets_per_response > immediate.in_packets_per_response,
+                    "a 16 character fill threshold didn't send more packets");
+
+    /* Restore the default policy */
+    SIM_TEST_CHECK (set_flush_policy (0, UART_RX_DMA_BLOCK_SIZE) == 0, "the default policy was stalled");
+
+    printf ("PASS test_flush_rtt: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
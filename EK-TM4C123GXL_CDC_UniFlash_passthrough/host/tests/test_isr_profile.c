@@ -0,0 +1,151 @@
+/*
+ * @file test_isr_profile.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the interrupt handler profiles of an ISR_PROFILING build, read with VENDOR_REQUEST_GET_ISR_PROFILE
+ * @details Data is looped back through the bridge, and the profiles are checked against the exceptions taken by the
+ *          simulation:
+ *  - The number of calls of each handler matches the exceptions taken since the profiles were cleared, within the
+ *    exceptions taken by the control transfers which clear and read the profiles.
+ *  - Each call is either counted as unsampled or has a latency sample, so unsampled entries don't appear in the
+ *    latency histogram as zero latency.
+ *  - The worst entry latency doesn't exceed that measured by the simulation by more than the cycles taken by the
+ *    profiling to read the cycle counter.
+ *  - VENDOR_REQUEST_CLEAR_ISR_PROFILE resets the profiles.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "isr_profile.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The most cycles between an exception being taken, or seen pending, and the profiling reading the cycle counter */
+#define PROFILE_READ_CYCLES 32
+
+/** The exception of each profiled handler, as taken by the simulation */
+static const uint32_t profiled_exceptions[ISR_PROFILE_NUM_HANDLERS] =
+{
+    [ISR_PROFILE_UART] = INT_UART1,
+    [ISR_PROFILE_USB0] = INT_USB0,
+    [ISR_PROFILE_NHIB_TIMER] = INT_TIMER0A,
+    [ISR_PROFILE_USB_IN_FLUSH_TIMER] = INT_TIMER1A,
+    [ISR_PROFILE_DEFERRED_WORK] = FAULT_PENDSV
+};
+
+static const char *const handler_names[ISR_PROFILE_NUM_HANDLERS] =
+{
+    [ISR_PROFILE_UART] = "uart",
+    [ISR_PROFILE_USB0] = "usb0",
+    [ISR_PROFILE_NHIB_TIMER] = "nhib_timer",
+    [ISR_PROFILE_USB_IN_FLUSH_TIMER] = "usb_in_flush_timer",
+    [ISR_PROFILE_DEFERRED_WORK] = "deferred_work"
+};
+
+
+static uint32_t histogram_total (const uint32_t histogram[ISR_PROFILE_NUM_BUCKETS])
+{
+    uint32_t total = 0;
+
+    for (uint32_t bucket = 0; bucket < ISR_PROFILE_NUM_BUCKETS; bucket++)
+    {
+        total += histogram[bucket];
+    }
+
+    return total;
+}
+
+
+static void count_exceptions (uint32_t counts[ISR_PROFILE_NUM_HANDLERS])
+{
+    for (uint32_t handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        counts[handler] = sim_cpu_stats.num_exceptions[profiled_exceptions[handler]];
+    }
+}
+
+
+static void read_profiles (isr_profile_t profiles[ISR_PROFILE_NUM_HANDLERS])
+{
+    const int32_t length = sim_test_vendor_in (VENDOR_REQUEST_GET_ISR_PROFILE, 0, profiles,
+                                               sizeof (isr_profile_t) * ISR_PROFILE_NUM_HANDLERS);
+
+    SIM_TEST_CHECK (length == (int32_t) (sizeof (isr_profile_t) * ISR_PROFILE_NUM_HANDLERS),
+                    "GET_ISR_PROFILE returned %d bytes", length);
+}
+
+
+int main (void)
+{
+    uint32_t before_clear[ISR_PROFILE_NUM_HANDLERS];
+    uint32_t after_clear[ISR_PROFILE_NUM_HANDLERS];
+    uint32_t before_read[ISR_PROFILE_NUM_HANDLERS];
+    uint32_t after_read[ISR_PROFILE_NUM_HANDLERS];
+    isr_profile_t profiles[ISR_PROFILE_NUM_HANDLERS];
+
+    sim_test_boot (SIM_CC3100_ECHO);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+
+    count_exceptions (before_clear);
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CLEAR_ISR_PROFILE, 0, NULL, 0) == 0,
+                    "CLEAR_ISR_PROFILE stalled");
+    count_exceptions (after_clear);
+
+    sim_test_loopback (0, 32768, 4096, 1);
+    sim_test_loopback (0, 256, 1, 2);
+    count_exceptions (before_read);
+    read_profiles (profiles);
+    count_exceptions (after_read);
+
+    SIM_TEST_CHECK (profiles[ISR_PROFILE_UART].num_calls > 0, "no UART interrupts were profiled");
+    for (uint32_t handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        const isr_profile_t *const profile = &profiles[handler];
+        const uint32_t min_calls = before_read[handler] - after_clear[handler];
+        const uint32_t max_calls = after_read[handler] - before_clear[handler];
+
+        SIM_TEST_CHECK ((profile->num_calls >= min_calls) && (profile->num_calls <= max_calls),
+                        "%s: %u calls profiled, between %u and %u exceptions taken", handler_names[handler],
+                        profile->num_calls, min_calls, max_calls);
+        SIM_TEST_CHECK (profile->num_unsampled_entries <= profile->num_calls, "%s: %u unsampled of %u calls",
+                        handler_names[handler], profile->num_unsampled_entries, profile->num_calls);
+        SIM_TEST_CHECK (histogram_total (profile->latency_histogram) ==
+                        (profile->num_calls - profile->num_unsampled_entries),
+                        "%s: %u latency samples for %u calls of which %u unsampled", handler_names[handler],
+                        histogram_total (profile->latency_histogram), profile->num_calls,
+                        profile->num_unsampled_entries);
+        /* The exit of the USB handler call which cleared the profiles is counted, but that of the call which takes
+         * the snapshot isn't, so there is an execution sample for every call */
+        SIM_TEST_CHECK (histogram_total (profile->execution_histogram) == profile->num_calls,
+                        "%s: %u execution samples for %u calls", handler_names[handler],
+                        histogram_total (profile->execution_histogram), profile->num_calls);
+        SIM_TEST_CHECK (profile->worst_latency_cycles <=
+                        (sim_cpu_stats.worst_latency_cycles[profiled_exceptions[handler]] + PROFILE_READ_CYCLES),
+                        "%s: profiled worst latency %u cycles exceeds %llu measured by the simulation",
+                        handler_names[handler], profile->worst_latency_cycles,
+                        (unsigned long long) sim_cpu_stats.worst_latency_cycles[profiled_exceptions[handler]]);
+        printf ("%s: %u calls, %u unsampled, worst latency %u cycles, worst execution %u cycles\n",
+                handler_names[handler], profile->num_calls, profile->num_unsampled_entries,
+                profile->worst_latency_cycles, profile->worst_execution_cycles);
+    }
+
+    /* Only the USB handler which cleared the profiles, and that which reads them, are counted after clearing */
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CLEAR_ISR_PROFILE, 0, NULL, 0) == 0,
+                    "CLEAR_ISR_PROFILE stalled");
+    read_profiles (profiles);
+    SIM_TEST_CHECK ((profiles[ISR_PROFILE_UART].num_calls == 0) && (profiles[ISR_PROFILE_USB0].num_calls <= 2),
+                    "profiles not cleared: %u UART and %u USB calls", profiles[ISR_PROFILE_UART].num_calls,
+                    profiles[ISR_PROFILE_USB0].num_calls);
+
+    printf ("PASS test_isr_profile\n");
+
+    return 0;
+}
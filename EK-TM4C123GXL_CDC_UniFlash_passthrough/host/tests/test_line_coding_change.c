@@ -0,0 +1,140 @@
+/*
+ * @file test_line_coding_change.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test that a SET_LINE_CODING received mid-stream is only applied once the data queued before it was sent
+ * @details Data is queued from the host to the CC3100, and the line coding changed while the UART is still sending
+ *          it. The CC3100 model stays at the old line settings until the change is reported as applied, so any
+ *          character sent after the UART was reconfigured would be received with an error. Checks that:
+ *  - VENDOR_REQUEST_GET_LINE_CODING_STATUS reports the change as pending from the SET_LINE_CODING, including while
+ *    the CDC class defers the change, and meanwhile the UART stays at the old baud rate.
+ *  - When the change is applied every byte queued before the request has been received intact at the old rate.
+ *  - A second SET_LINE_CODING while a change is pending replaces the requested line coding, without changing the
+ *    data sent at the old rate, and only one change is applied.
+ *  - Data sent after the change is received intact at the new rate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "line_coding.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The length of the data queued before the line coding change, which fits in the host-to-UART buffer */
+#define QUEUED_LENGTH 4096
+
+#define LINE_CONFIG (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE)
+
+
+static void get_status (line_coding_change_status_t *const status)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_LINE_CODING_STATUS, 0, status, sizeof (*status)) ==
+                    sizeof (*status), "GET_LINE_CODING_STATUS failed");
+}
+
+
+static bool host_write_complete (void *arg)
+{
+    (void) arg;
+    return sim_usb_host_write_pending (0) == 0;
+}
+
+
+/**
+ * @brief Check data sent to the CC3100 arrives intact
+ */
+static void check_cc3100_received (const uint8_t *const sent, const size_t length, const char *const description)
+{
+    uint8_t received[QUEUED_LENGTH];
+    const size_t num_received = sim_cc3100_read (received, sizeof (received));
+
+    SIM_TEST_CHECK (num_received == length, "%s: %zu of %zu bytes received by the CC3100", description, num_received,
+                    length);
+    SIM_TEST_CHECK (memcmp (sent, received, length) == 0, "%s: bytes corrupted", description);
+    SIM_TEST_CHECK (sim_cc3100_stats ()->rx_errors == 0, "%s: %llu bytes received with errors", description,
+                    (unsigned long long) sim_cc3100_stats ()->rx_errors);
+}
+
+
+/**
+ * @brief Change the baud rate while data queued at the old rate is being sent
+ * @param[in] old_baud The baud rate the data is queued at
+ * @param[in] intermediate_baud When non-zero, a baud rate requested and then replaced before being applied
+ * @param[in] new_baud The baud rate changed to
+ */
+static void test_change (const uint32_t old_baud, const uint32_t intermediate_baud, const uint32_t new_baud)
+{
+    uint8_t sent[QUEUED_LENGTH];
+    uint32_t old_character_cycles;
+    uint32_t new_character_cycles;
+    line_coding_change_status_t before;
+    line_coding_change_status_t status;
+    uint32_t num_polls = 0;
+    const sim_time_t deadline = sim_now + SIM_MS (2000);
+
+    sim_test_set_line_coding (0, old_baud, LINE_CONFIG);
+    old_character_cycles = sim_uart_character_cycles (UART1_BASE);
+    get_status (&before);
+
+    /* Queue the data, and request the change while the CC3100 is still receiving it */
+    sim_test_fill_pattern (sent, sizeof (sent), old_baud);
+    sim_usb_host_write (0, sent, sizeof (sent));
+    SIM_TEST_CHECK (sim_run_until (host_write_complete, NULL, SIM_MS (100)), "data not accepted by the bridge");
+    SIM_TEST_CHECK (sim_cc3100_read_available () < (sizeof (sent) / 2),
+                    "%zu bytes already sent, so the change isn't mid-stream", sim_cc3100_read_available ());
+    if (intermediate_baud != 0)
+    {
+        sim_test_request_line_coding (0, intermediate_baud, LINE_CONFIG);
+        sim_run_for (SIM_MS (5));
+    }
+    sim_test_request_line_coding (0, new_baud, LINE_CONFIG);
+
+    for (get_status (&status); status.state == LINE_CODING_CHANGE_PENDING; get_status (&status))
+    {
+        SIM_TEST_CHECK (sim_uart_character_cycles (UART1_BASE) == old_character_cycles,
+                        "baud rate changed with the change pending, after %zu bytes", sim_cc3100_read_available ());
+        SIM_TEST_CHECK (sim_now < deadline, "change not applied");
+        num_polls++;
+        sim_run_for (SIM_US (500));
+    }
+    SIM_TEST_CHECK (num_polls > 0, "change applied before the queued data was sent");
+    SIM_TEST_CHECK ((status.state == LINE_CODING_CHANGE_APPLIED) && (status.num_applied == (before.num_applied + 1)),
+                    "state %u with %u changes applied, expected %u", status.state, status.num_applied,
+                    before.num_applied + 1);
+    new_character_cycles = sim_uart_character_cycles (UART1_BASE);
+    SIM_TEST_CHECK (llabs ((long long) new_character_cycles * new_baud - (long long) old_character_cycles * old_baud) <
+                    ((long long) old_character_cycles * old_baud / 100),
+                    "UART at %u cycles per character, expected the %u baud rate", new_character_cycles, new_baud);
+    check_cc3100_received (sent, sizeof (sent), "queued before the change");
+
+    /* Data sent once the change is applied is at the new rate */
+    sim_cc3100_line_config (new_baud, LINE_CONFIG);
+    sim_test_fill_pattern (sent, sizeof (sent), new_baud);
+    sim_usb_host_write (0, sent, sizeof (sent));
+    sim_run_for (4u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * sizeof (sent) + SIM_MS (10));
+    check_cc3100_received (sent, sizeof (sent), "sent after the change");
+
+    printf ("PASS change from %u to %u baud after %u polls\n", old_baud, new_baud, num_polls);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    test_change (115200, 0, 921600);
+    test_change (921600, 0, 230400);
+    test_change (115200, 460800, 921600);
+
+    printf ("PASS test_line_coding_change\n");
+
+    return 0;
+}
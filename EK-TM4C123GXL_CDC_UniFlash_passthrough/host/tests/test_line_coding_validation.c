@@ -0,0 +1,190 @@
+/*
+ * @file test_line_coding_validation.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the validation of the line coding requested by the USB host
+ * @details Checks that:
+ *  - Baud rates above the UART clock / 16, up to the UART clock / 8, are applied with the high-speed clock divisor,
+ *    and data is looped back through the CC3100 at those rates.
+ *  - Baud rates which the UART can't generate, below the range of the integer divisor or above the UART clock / 8,
+ *    and invalid frame formats are rejected with the UART configuration left unchanged.
+ *    At the 80 MHz system clock every baud rate within the range of the divisor is within UART_BAUD_TOLERANCE_PPM,
+ *    so the range limits are what is rejected.
+ *  - GET_LINE_CODING returns the line coding as requested for the last change applied, rather than the baud rate
+ *    read back from the UART divisor.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "line_coding.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+#define LINE_CONFIG (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE)
+
+/** The length of the data looped back at each applied baud rate */
+#define LOOPBACK_LENGTH 2048
+
+
+static void send_line_coding (tLineCoding *const line_coding)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_SET_LINE_CODING,
+        .wValue = 0,
+        .wIndex = sim_usb_host_port_interface (0),
+        .wLength = sizeof (*line_coding)
+    };
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, line_coding) == sizeof (*line_coding), "SET_LINE_CODING stalled");
+}
+
+
+static void get_line_coding (tLineCoding *const line_coding)
+{
+    const tUSBRequest setup =
+    {
+        .bmRequestType = USB_RTYPE_DIR_IN | USB_RTYPE_CLASS | USB_RTYPE_INTERFACE,
+        .bRequest = USB_CDC_GET_LINE_CODING,
+        .wValue = 0,
+        .wIndex = sim_usb_host_port_interface (0),
+        .wLength = sizeof (*line_coding)
+    };
+
+    SIM_TEST_CHECK (sim_usb_host_control (&setup, line_coding) == sizeof (*line_coding), "GET_LINE_CODING failed");
+}
+
+
+/**
+ * @brief Wait for a line coding change to leave the pending state
+ */
+static void wait_for_change (line_coding_change_status_t *const status)
+{
+    const sim_time_t deadline = sim_now + SIM_MS (100);
+
+    do
+    {
+        sim_run_for (SIM_MS (1));
+        SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_LINE_CODING_STATUS, 0, status, sizeof (*status)) ==
+                        sizeof (*status), "GET_LINE_CODING_STATUS failed");
+        SIM_TEST_CHECK (sim_now < deadline, "line coding change still pending");
+    } while (status->state == LINE_CODING_CHANGE_PENDING);
+}
+
+
+static void check_line_coding (const tLineCoding *const expected, const char *const description)
+{
+    tLineCoding line_coding;
+
+    get_line_coding (&line_coding);
+    SIM_TEST_CHECK ((line_coding.ui32Rate == expected->ui32Rate) && (line_coding.ui8Stop == expected->ui8Stop) &&
+                    (line_coding.ui8Parity == expected->ui8Parity) &&
+                    (line_coding.ui8Databits == expected->ui8Databits),
+                    "%s: GET_LINE_CODING returned %u baud %u data bits parity %u stop %u, expected %u %u %u %u",
+                    description, line_coding.ui32Rate, line_coding.ui8Databits, line_coding.ui8Parity,
+                    line_coding.ui8Stop, expected->ui32Rate, expected->ui8Databits, expected->ui8Parity,
+                    expected->ui8Stop);
+}
+
+
+/**
+ * @brief Check baud rates which need the high-speed clock divisor are applied, and carry data
+ */
+static void test_high_speed_rates (void)
+{
+    static const uint32_t bauds[] = {6000000, 6400000, 8000000, 10000000};
+    tLineCoding expected = {0, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8};
+    uint32_t uart_baud;
+    uint32_t uart_config;
+
+    for (uint32_t baud_index = 0; baud_index < (sizeof (bauds) / sizeof (bauds[0])); baud_index++)
+    {
+        const uint32_t baud = bauds[baud_index];
+        const uint32_t nominal_cycles = (10u * SIM_CPU_HZ) / baud;
+
+        sim_test_set_line_coding (0, baud, LINE_CONFIG);
+        UARTConfigGetExpClk (UART1_BASE, SIM_CPU_HZ, &uart_baud, &uart_config);
+        SIM_TEST_CHECK ((sim_uart_character_cycles (UART1_BASE) * 100u >= nominal_cycles * 98u) &&
+                        (sim_uart_character_cycles (UART1_BASE) * 100u <= nominal_cycles * 102u),
+                        "%u baud: %u cycles per character, expected %u", baud,
+                        sim_uart_character_cycles (UART1_BASE), nominal_cycles);
+        sim_test_loopback (0, LOOPBACK_LENGTH, 512, baud);
+
+        /* The line coding is returned as requested, even where the UART baud rate is rounded by the divisor */
+        expected.ui32Rate = baud;
+        check_line_coding (&expected, "high speed");
+        printf ("%u baud applied, UART at %u baud\n", baud, uart_baud);
+    }
+    printf ("PASS high_speed_rates\n");
+}
+
+
+/**
+ * @brief Check line codings which can't be generated are rejected, leaving the UART configuration unchanged
+ */
+static void test_rejected (void)
+{
+    static const tLineCoding invalid_line_codings[] =
+    {
+        /* Below the range of the integer divisor */
+        {0, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8},
+        {50, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8},
+        /* Above the UART clock / 8 */
+        {10000001, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8},
+        {20000000, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8},
+        /* Invalid frame formats at a valid baud rate */
+        {115200, USB_CDC_STOP_BITS_1_5, USB_CDC_PARITY_NONE, 8},
+        {115200, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 9},
+        {115200, USB_CDC_STOP_BITS_1, 5, 8}
+    };
+    const tLineCoding applied = {460800, USB_CDC_STOP_BITS_1, USB_CDC_PARITY_NONE, 8};
+    line_coding_change_status_t before;
+    line_coding_change_status_t status;
+    uint32_t character_cycles;
+
+    sim_test_set_line_coding (0, applied.ui32Rate, LINE_CONFIG);
+    character_cycles = sim_uart_character_cycles (UART1_BASE);
+    for (uint32_t index = 0; index < (sizeof (invalid_line_codings) / sizeof (invalid_line_codings[0])); index++)
+    {
+        tLineCoding line_coding = invalid_line_codings[index];
+
+        SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_LINE_CODING_STATUS, 0, &before, sizeof (before)) ==
+                        sizeof (before), "GET_LINE_CODING_STATUS failed");
+        send_line_coding (&line_coding);
+        wait_for_change (&status);
+        SIM_TEST_CHECK ((status.state == LINE_CODING_CHANGE_REJECTED) &&
+                        (status.num_rejected == (before.num_rejected + 1)) &&
+                        (status.num_applied == before.num_applied),
+                        "%u baud %u data bits parity %u stop %u: state %u, %u rejected", line_coding.ui32Rate,
+                        line_coding.ui8Databits, line_coding.ui8Parity, line_coding.ui8Stop, status.state,
+                        status.num_rejected);
+        SIM_TEST_CHECK (sim_uart_character_cycles (UART1_BASE) == character_cycles,
+                        "%u baud: the UART configuration was changed", line_coding.ui32Rate);
+        check_line_coding (&applied, "rejected");
+    }
+
+    /* The bridge still passes data at the line coding applied before the rejected changes */
+    sim_test_loopback (0, LOOPBACK_LENGTH, 512, 1);
+    printf ("PASS rejected\n");
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_ECHO);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    test_high_speed_rates ();
+    test_rejected ();
+
+    printf ("PASS test_line_coding_validation\n");
+
+    return 0;
+}
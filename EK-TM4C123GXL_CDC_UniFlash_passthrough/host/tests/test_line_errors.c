@@ -0,0 +1,193 @@
+/*
+ * @file test_line_errors.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test that line errors injected on the serial line from the CC3100 are counted and notified to the host
+ * @details Each type of error is injected in turn, and must increment only its own count in the
+ *          VENDOR_REQUEST_GET_LINE_ERRORS response, and set its bit in a CDC SERIAL_STATE notification. The error
+ *          free characters either side of an error must still be passed to the host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "usb_serial_structs.h"
+#include "uart_line_errors.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The time allowed for an error to be notified to the host, a few USB frames */
+#define NOTIFY_TIMEOUT SIM_MS (10)
+
+/** The counts expected after the errors injected so far */
+static uart_line_error_counts_t expected_counts;
+
+
+static void get_line_errors (uart_line_error_counts_t *const counts)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_LINE_ERRORS, 0, counts, sizeof (*counts)) ==
+                    sizeof (*counts), "GET_LINE_ERRORS failed");
+}
+
+
+typedef struct
+{
+    uint32_t notifications;
+} notified_arg_t;
+
+
+static bool notified (void *arg)
+{
+    const notified_arg_t *const wait = arg;
+
+    return sim_usb_host_port_stats (0)->notifications > wait->notifications;
+}
+
+
+/**
+ * @brief Check that an injected error was notified to the host and counted
+ * @param[in] description What was injected, for failure messages
+ * @param[in] previous_notifications The notifications received before the error was injected
+ * @param[in] serial_state The SERIAL_STATE bits which the notification must contain
+ */
+static void check_error_reported (const char *const description, const uint32_t previous_notifications,
+                                  const uint16_t serial_state)
+{
+    notified_arg_t wait = {.notifications = previous_notifications};
+    uart_line_error_counts_t counts;
+
+    SIM_TEST_CHECK (sim_run_until (notified, &wait, NOTIFY_TIMEOUT), "%s: no SERIAL_STATE notification", description);
+    SIM_TEST_CHECK ((sim_usb_host_serial_state (0) & serial_state) == serial_state,
+                    "%s: SERIAL_STATE 0x%04x doesn't contain 0x%04x", description, sim_usb_host_serial_state (0),
+                    serial_state);
+
+    get_line_errors (&counts);
+    SIM_TEST_CHECK (memcmp (&counts, &expected_counts, sizeof (counts)) == 0,
+                    "%s: counts overrun %u break %u parity %u framing %u, expected %u %u %u %u", description,
+                    counts.overrun, counts.break_condition, counts.parity, counts.framing,
+                    expected_counts.overrun, expected_counts.break_condition, expected_counts.parity,
+                    expected_counts.framing);
+}
+
+
+/**
+ * @brief Check the characters either side of an injected error reached the host, allowing for the character
+ *        received with the error being either discarded or passed on
+ */
+static void check_surrounding_data (const char *const description, const char *const before,
+                                    const char *const after)
+{
+    const size_t before_length = strlen (before);
+    const size_t after_length = strlen (after);
+    char received[64];
+    size_t num_received;
+
+    sim_test_wait_read_available (0, before_length + after_length + 1, SIM_MS (20));
+    num_received = sim_usb_host_read (0, received, sizeof (received));
+    SIM_TEST_CHECK ((num_received >= (before_length + after_length)) &&
+                    (num_received <= (before_length + after_length + 1)),
+                    "%s: %zu characters received", description, num_received);
+    SIM_TEST_CHECK ((memcmp (received, before, before_length) == 0) &&
+                    (memcmp (&received[num_received - after_length], after, after_length) == 0),
+                    "%s: the characters around the error weren't received", description);
+}
+
+
+/**
+ * @brief Inject a character received with a parity or framing error between error free characters
+ */
+static void test_character_error (const char *const description, const uint32_t dr_error,
+                                  const uint16_t serial_state)
+{
+    const uint32_t previous_notifications = sim_usb_host_port_stats (0)->notifications;
+
+    sim_cc3100_send ("before", 6);
+    sim_uart_peer_send_with_error (UART1_BASE, 0x55, dr_error);
+    sim_cc3100_send ("after", 5);
+    check_error_reported (description, previous_notifications, serial_state);
+    check_surrounding_data (description, "before", "after");
+}
+
+
+/**
+ * @brief Overrun the receive FIFO, by the CC3100 ignoring RTS while the host doesn't read
+ */
+static void test_overrun (void)
+{
+    const uint32_t uart_config = UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE;
+    const size_t length = spsc_ring_size (&cdc_tx_buffer) + 1024;
+    const uint32_t previous_notifications = sim_usb_host_port_stats (0)->notifications;
+    uint8_t *const data = malloc (length);
+    uart_line_error_counts_t counts;
+
+    SIM_TEST_CHECK (data != NULL, "out of memory");
+    sim_test_fill_pattern (data, length, 6);
+    sim_uart_peer_config (UART1_BASE, 115200, uart_config, false);
+    sim_usb_host_set_read_limit (0, 0);
+    sim_cc3100_send (data, length);
+    sim_run_for ((sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (1));
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns > 0, "the receive FIFO didn't overrun");
+
+    /* The overrun interrupt is raised for each character lost, so only check the count has increased */
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+    get_line_errors (&counts);
+    SIM_TEST_CHECK (counts.overrun > expected_counts.overrun, "no overruns counted");
+    expected_counts.overrun = counts.overrun;
+    check_error_reported ("overrun", previous_notifications, USB_CDC_SERIAL_STATE_OVERRUN);
+    sim_run_for (SIM_MS (20));
+    while (sim_usb_host_read (0, data, length) > 0)
+    {
+    }
+
+    sim_cc3100_line_config (115200, uart_config);
+    free (data);
+}
+
+
+int main (void)
+{
+    uint32_t previous_notifications;
+
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    get_line_errors (&expected_counts);
+    SIM_TEST_CHECK ((expected_counts.overrun == 0) && (expected_counts.break_condition == 0) &&
+                    (expected_counts.parity == 0) && (expected_counts.framing == 0), "line errors after reset");
+
+    expected_counts.parity++;
+    test_character_error ("parity", UART_DR_PE, USB_CDC_SERIAL_STATE_PARITY);
+    expected_counts.framing++;
+    test_character_error ("framing", UART_DR_FE, USB_CDC_SERIAL_STATE_FRAMING);
+
+    /* A break is received as a NUL character with both the break and framing error flags */
+    previous_notifications = sim_usb_host_port_stats (0)->notifications;
+    sim_cc3100_send ("before", 6);
+    sim_uart_peer_send_break (UART1_BASE, 1000);
+    sim_cc3100_send ("after", 5);
+    expected_counts.break_condition++;
+    expected_counts.framing++;
+    check_error_reported ("break", previous_notifications,
+                          USB_CDC_SERIAL_STATE_BREAK | USB_CDC_SERIAL_STATE_FRAMING);
+    check_surrounding_data ("break", "before", "after");
+
+    test_overrun ();
+
+    /* Error free data after the errors */
+    previous_notifications = sim_usb_host_port_stats (0)->notifications;
+    sim_cc3100_set_mode (SIM_CC3100_ECHO);
+    sim_test_loopback (0, 4096, 512, 7);
+    SIM_TEST_CHECK (sim_usb_host_port_stats (0)->notifications == previous_notifications,
+                    "a notification was sent without an error");
+
+    printf ("PASS test_line_errors: %u notifications in %.3f s of virtual time\n",
+            sim_usb_host_port_stats (0)->notifications, (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
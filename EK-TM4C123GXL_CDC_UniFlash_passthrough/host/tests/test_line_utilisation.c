@@ -0,0 +1,99 @@
+/*
+ * @file test_line_utilisation.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test that the download direction keeps the serial line to the CC3100 saturated
+ * @details The host writes an image-sized stream, which the CC3100 model sinks. The utilisation is the time UART1
+ *          spent transmitting as a fraction of the time from the host write until the last character was received
+ *          by the CC3100, which includes the latency of the first USB packet.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "sim_test.h"
+
+/** The minimum utilisation of the serial line while the host has data queued */
+#define MIN_LINE_UTILISATION 0.99
+
+/** The length of each stream, of the order of a service pack image */
+#define STREAM_LENGTH (256u * 1024u)
+
+
+static bool cc3100_received_all (void *arg)
+{
+    const size_t *const length = arg;
+
+    return sim_cc3100_read_available () >= *length;
+}
+
+
+/**
+ * @brief Stream from the host to the CC3100, and check the data and line utilisation
+ * @param[in] baud The baud rate
+ * @param[in] uart_config The frame format, as UART_CONFIG_ flags
+ * @param[in] write_size How many bytes the host writes at once
+ */
+static void test_utilisation (const uint32_t baud, const uint32_t uart_config, const size_t write_size)
+{
+    size_t length = STREAM_LENGTH;
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    const sim_time_t line_time = (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length;
+    sim_time_t start;
+    sim_time_t elapsed;
+    double utilisation;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_set_line_coding (0, baud, uart_config);
+    sim_test_fill_pattern (sent, length, baud);
+    sim_uart_stats_clear (UART1_BASE);
+
+    start = sim_now;
+    for (size_t offset = 0; offset < length; offset += write_size)
+    {
+        sim_usb_host_write (0, &sent[offset], ((length - offset) < write_size) ? (length - offset) : write_size);
+    }
+    SIM_TEST_CHECK (sim_run_until (cc3100_received_all, &length, 2 * line_time + SIM_MS (100)),
+                    "%u baud: the CC3100 only received %zu of %zu bytes", baud, sim_cc3100_read_available (), length);
+    elapsed = sim_now - start;
+
+    SIM_TEST_CHECK (sim_cc3100_read (received, length) == length, "%u baud: short read", baud);
+    for (size_t offset = 0; offset < length; offset++)
+    {
+        SIM_TEST_CHECK (received[offset] == sent[offset], "%u baud: byte %zu received as 0x%02x, sent 0x%02x",
+                        baud, offset, received[offset], sent[offset]);
+    }
+
+    utilisation = (double) sim_uart_stats (UART1_BASE)->tx_busy_cycles / (double) elapsed;
+    printf ("%u baud, %zu byte writes: %.2f%% line utilisation, %.1f KB/s\n", baud, write_size, utilisation * 100.0,
+            (length / 1024.0) / ((double) elapsed / SIM_CPU_HZ));
+    SIM_TEST_CHECK (utilisation >= MIN_LINE_UTILISATION, "%u baud: line utilisation only %.2f%%", baud,
+                    utilisation * 100.0);
+
+    free (sent);
+    free (received);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    test_utilisation (115200, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE, 4096);
+    test_utilisation (921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE, 4096);
+    test_utilisation (921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE, 64);
+    test_utilisation (2000000, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE, 16384);
+    test_utilisation (2000000, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_TWO | UART_CONFIG_PAR_EVEN, 16384);
+
+    SIM_TEST_CHECK (sim_cc3100_stats ()->rx_errors == 0, "the CC3100 received %llu characters with errors",
+                    (unsigned long long) sim_cc3100_stats ()->rx_errors);
+    printf ("PASS test_line_utilisation: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * @file test_low_power.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the deep sleep while the USB bus is suspended, and the one-shot timer which times the nHIB pulse
+ * @details Checks that:
+ *  - The firmware doesn't use the Sys Tick, which would wake the CPU every millisecond.
+ *  - The nHIB pulse on a CDC SEND_BREAK is 100 ms wide, timed by a single interrupt of the one-shot timer.
+ *  - Once the bus is suspended the CPU enters deep sleep, and stays there with no idle wakeups.
+ *  - On resume the CPU returns to the normal sleep mode, and data is passed through the bridge again.
+ */
+
+#include <stdio.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "bridge_hal.h"
+
+#include "sim_gpio.h"
+#include "sim_test.h"
+
+/** How long the bus is left suspended */
+#define SUSPEND_DURATION SIM_MS (500)
+
+/** The maximum error allowed in the nHIB pulse width, for the one-shot timer interrupt latency */
+#define PULSE_TOLERANCE_US 20
+
+/** The times nHIB was last asserted and deasserted */
+static sim_time_t nhib_asserted_at;
+static sim_time_t nhib_deasserted_at;
+
+
+static void nhib_changed (void *context, uint32_t port_base, uint8_t levels)
+{
+    (void) context;
+    (void) port_base;
+    if (levels & CC3100_NHIB_PIN)
+    {
+        nhib_deasserted_at = sim_now;
+    }
+    else
+    {
+        nhib_asserted_at = sim_now;
+    }
+}
+
+
+static bool nhib_pulse_ended (void *arg)
+{
+    const sim_time_t *const started_at = arg;
+
+    return nhib_deasserted_at > *started_at;
+}
+
+
+static uint32_t total_exceptions (void)
+{
+    uint32_t total = 0;
+
+    for (uint32_t exception = 0; exception < (sizeof (sim_cpu_stats.num_exceptions) /
+                                              sizeof (sim_cpu_stats.num_exceptions[0])); exception++)
+    {
+        total += sim_cpu_stats.num_exceptions[exception];
+    }
+
+    return total;
+}
+
+
+/**
+ * @brief Check the width of the nHIB pulse on a break, and that it is timed by one timer interrupt
+ */
+static void test_nhib_pulse (void)
+{
+    const sim_time_t started_at = sim_now;
+    const uint32_t timer_interrupts = sim_cpu_stats.num_exceptions[NHIB_TIMER_INT];
+    double width_us;
+
+    sim_test_send_break (0, 0xFFFF);
+    SIM_TEST_CHECK (sim_run_until (nhib_pulse_ended, (void *) &started_at, SIM_MS (200)), "nHIB pulse didn't end");
+    SIM_TEST_CHECK (nhib_asserted_at > started_at, "nHIB not asserted");
+    width_us = (double) (nhib_deasserted_at - nhib_asserted_at) / (SIM_CPU_HZ / 1000000u);
+    printf ("nHIB pulse %.2f us, %u timer interrupts\n", width_us,
+            sim_cpu_stats.num_exceptions[NHIB_TIMER_INT] - timer_interrupts);
+    SIM_TEST_CHECK ((width_us >= 100000.0) && (width_us <= (100000.0 + PULSE_TOLERANCE_US)),
+                    "nHIB pulse %.2f us, expected 100 ms", width_us);
+    SIM_TEST_CHECK (sim_cpu_stats.num_exceptions[NHIB_TIMER_INT] == (timer_interrupts + 1),
+                    "%u timer interrupts timed the nHIB pulse",
+                    sim_cpu_stats.num_exceptions[NHIB_TIMER_INT] - timer_interrupts);
+
+    sim_test_send_break (0, 0);
+    sim_run_for (SIM_MS (1));
+    printf ("PASS nhib_pulse\n");
+}
+
+
+/**
+ * @brief Suspend the bus, and check the CPU stays in deep sleep until resumed
+ */
+static void test_suspend (void)
+{
+    uint32_t deep_sleeps;
+    uint32_t sleeps;
+    uint32_t exceptions;
+    sim_time_t asleep_cycles;
+
+    /* The device detects the suspend after 3 ms of bus idle */
+    deep_sleeps = sim_cpu_stats.num_deep_sleeps;
+    sim_usb_host_suspend (true);
+    sim_run_for (SIM_MS (10));
+    SIM_TEST_CHECK (sim_cpu_stats.num_deep_sleeps > deep_sleeps, "deep sleep not entered on suspend");
+
+    deep_sleeps = sim_cpu_stats.num_deep_sleeps;
+    sleeps = sim_cpu_stats.num_sleeps;
+    exceptions = total_exceptions ();
+    asleep_cycles = sim_cpu_stats.asleep_cycles;
+    sim_run_for (SUSPEND_DURATION);
+    printf ("suspended: %u deep sleeps, %u sleeps, %u exceptions, asleep %.3f%%\n",
+            sim_cpu_stats.num_deep_sleeps - deep_sleeps, sim_cpu_stats.num_sleeps - sleeps,
+            total_exceptions () - exceptions,
+            (100.0 * (double) (sim_cpu_stats.asleep_cycles - asleep_cycles)) / SUSPEND_DURATION);
+    SIM_TEST_CHECK ((total_exceptions () == exceptions) && (sim_cpu_stats.num_deep_sleeps == deep_sleeps) &&
+                    (sim_cpu_stats.num_sleeps == sleeps), "%u wakeups while suspended",
+                    total_exceptions () - exceptions);
+    SIM_TEST_CHECK ((sim_cpu_stats.asleep_cycles - asleep_cycles) == SUSPEND_DURATION,
+                    "the CPU was awake while suspended");
+
+    /* On resume the CPU only uses the normal sleep mode */
+    sim_usb_host_suspend (false);
+    sim_run_for (SIM_MS (30));
+    deep_sleeps = sim_cpu_stats.num_deep_sleeps;
+    sleeps = sim_cpu_stats.num_sleeps;
+    sim_test_loopback (0, 4096, 512, 1);
+    sim_run_for (SIM_MS (10));
+    SIM_TEST_CHECK ((sim_cpu_stats.num_deep_sleeps == deep_sleeps) && (sim_cpu_stats.num_sleeps > sleeps),
+                    "after resume %u deep sleeps and %u sleeps", sim_cpu_stats.num_deep_sleeps - deep_sleeps,
+                    sim_cpu_stats.num_sleeps - sleeps);
+    printf ("PASS suspend\n");
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_ECHO);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_gpio_observe (CC3100_NHIB_PORT_BASE, CC3100_NHIB_PIN, nhib_changed, NULL);
+
+    test_nhib_pulse ();
+    test_suspend ();
+
+    SIM_TEST_CHECK (sim_cpu_stats.num_exceptions[FAULT_SYSTICK] == 0, "%u Sys Tick interrupts",
+                    sim_cpu_stats.num_exceptions[FAULT_SYSTICK]);
+    printf ("PASS test_low_power\n");
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+/*
+ * @file test_session_record.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Record a UniFlash-like session with the session mode of the traffic capture
+ * @details Runs a session shaped like UniFlash talking to the CC3100 bootloader through the bridge:
+ *          - The line coding and control line state are set.
+ *          - A break enters the bootloader, which acknowledges with 0x00 0xCC once nHIB is released, before the
+ *            host clears the break.
+ *          - Commands are exchanged, with the test acting as the bootloader which acknowledges each command after
+ *            a processing time and returns a response, including file chunks larger than a capture piece.
+ *
+ *          The host polls VENDOR_REQUEST_GET_CAPTURE while the session runs, as a recorder on a real bridge would.
+ *          The pcap is checked to hold every byte in each direction with no dropped records, and is written to the
+ *          file given on the command line so that replay_session can replay it against other firmware builds.
+ *
+ *          Usage: test_session_record <pcap file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "traffic_capture.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The maximum length of the pcap recorded */
+#define RECORDING_MAX_LENGTH (1024u * 1024u)
+
+/** The length of each VENDOR_REQUEST_GET_CAPTURE */
+#define CAPTURE_CHUNK_LENGTH 512u
+
+/** The size of the pcap file header, and of the header before each packet */
+#define PCAP_FILE_HEADER_SIZE 24u
+#define PCAP_RECORD_HEADER_SIZE 16u
+
+/** The bootloader acknowledgement to a break, and to each command */
+static const uint8_t bootloader_ack[] = {0x00, 0xCC};
+
+/** One command of the session, from the host, and the response from the bootloader which follows the ack */
+typedef struct
+{
+    size_t command_length;
+    size_t response_length;
+    /** The time the bootloader takes to process the command, before acknowledging it */
+    uint32_t processing_us;
+} session_command_t;
+
+/** The commands of the session, from getting the version through to writing and reading back a file */
+static const session_command_t session_commands[] =
+{
+    {3, 28, 200},
+    {4, 4, 100},
+    {12, 0, 5000},
+    {260, 0, 1500},
+    {4099, 0, 20000},
+    {4099, 0, 20000},
+    {1100, 0, 8000},
+    {8, 0, 300},
+    {12, 4096, 2000},
+    {3, 4, 100}
+};
+
+/** The recorded pcap */
+static uint8_t *recording;
+static size_t recording_length;
+
+/** The bytes sent in each direction, which the recording must hold */
+static size_t total_host_to_uart;
+static size_t total_uart_to_host;
+
+
+/**
+ * @brief Read the capture records returned so far, as the host of a real bridge polls the capture
+ * @param[in] rewind True for the first read, which starts with the pcap file header
+ */
+static void poll_capture (bool rewind)
+{
+    int32_t length;
+
+    do
+    {
+        SIM_TEST_CHECK ((recording_length + CAPTURE_CHUNK_LENGTH) <= RECORDING_MAX_LENGTH, "the recording is too long");
+        length = sim_test_vendor_in (VENDOR_REQUEST_GET_CAPTURE, rewind ? 1 : 0, &recording[recording_length],
+                                     CAPTURE_CHUNK_LENGTH);
+        SIM_TEST_CHECK (length >= 0, "GET_CAPTURE stalled");
+        recording_length += (size_t) length;
+        rewind = false;
+    } while (length > 0);
+}
+
+
+typedef struct
+{
+    size_t length;
+} wait_length_t;
+
+
+static bool cc3100_received (void *arg)
+{
+    const wait_length_t *const wait = arg;
+
+    return sim_cc3100_read_available () >= wait->length;
+}
+
+
+static bool cc3100_ready_for_ack (void *arg)
+{
+    (void) arg;
+    return sim_cc3100_powered () && sim_cc3100_break_active ();
+}
+
+
+/**
+ * @brief Receive data from the host as the bootloader, checking it matches what the host sent
+ */
+static void bootloader_receive (const uint8_t *const expected, const size_t length)
+{
+    uint8_t *const received = malloc (length);
+    wait_length_t wait = {.length = length};
+
+    SIM_TEST_CHECK (received != NULL, "out of memory");
+    SIM_TEST_CHECK (sim_run_until (cc3100_received, &wait,
+                                   2u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (100)),
+                    "the bootloader received %zu of %zu bytes", sim_cc3100_read_available (), length);
+    SIM_TEST_CHECK ((sim_cc3100_read (received, length) == length) && (memcmp (received, expected, length) == 0),
+                    "the bootloader received a corrupt command");
+    free (received);
+}
+
+
+/**
+ * @brief Read data from the bootloader as the host, checking it matches what the bootloader sent
+ */
+static void host_receive (const uint8_t *const expected, const size_t length)
+{
+    uint8_t *const received = malloc (length);
+
+    SIM_TEST_CHECK (received != NULL, "out of memory");
+    SIM_TEST_CHECK (sim_test_wait_read_available (0, length, 2u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) *
+                                                  length + SIM_MS (100)),
+                    "the host received %zu of %zu bytes", sim_usb_host_read_available (0), length);
+    SIM_TEST_CHECK ((sim_usb_host_read (0, received, length) == length) && (memcmp (received, expected, length) == 0),
+                    "the host received a corrupt response");
+    free (received);
+}
+
+
+/**
+ * @brief Enter the bootloader with a break, as UniFlash does
+ */
+static void enter_bootloader (void)
+{
+    sim_test_send_break (0, 0xFFFF);
+    SIM_TEST_CHECK (sim_run_until (cc3100_ready_for_ack, NULL, SIM_MS (500)),
+                    "the CC3100 wasn't released from hibernate with the break asserted");
+    sim_run_for (SIM_MS (5));
+    sim_cc3100_send (bootloader_ack, sizeof (bootloader_ack));
+    total_uart_to_host += sizeof (bootloader_ack);
+    host_receive (bootloader_ack, sizeof (bootloader_ack));
+    sim_test_send_break (0, 0);
+    poll_capture (false);
+}
+
+
+/**
+ * @brief Run one command exchange, the host waiting for the ack and response before the next command
+ */
+static void exchange_command (const session_command_t *const command, const uint32_t seed)
+{
+    uint8_t *const command_data = malloc (command->command_length);
+    uint8_t *const response = malloc (command->response_length + 1);
+
+    SIM_TEST_CHECK ((command_data != NULL) && (response != NULL), "out of memory");
+    sim_test_fill_pattern (command_data, command->command_length, seed);
+    sim_usb_host_write (0, command_data, command->command_length);
+    total_host_to_uart += command->command_length;
+    bootloader_receive (command_data, command->command_length);
+
+    sim_run_for (SIM_US (command->processing_us));
+    sim_cc3100_send (bootloader_ack, sizeof (bootloader_ack));
+    total_uart_to_host += sizeof (bootloader_ack);
+    host_receive (bootloader_ack, sizeof (bootloader_ack));
+    if (command->response_length > 0)
+    {
+        sim_test_fill_pattern (response, command->response_length, ~seed);
+        sim_cc3100_send (response, command->response_length);
+        total_uart_to_host += command->response_length;
+        host_receive (response, command->response_length);
+    }
+    poll_capture (false);
+
+    free (command_data);
+    free (response);
+}
+
+
+/**
+ * @brief Check the recording holds the whole session
+ */
+static void check_recording (void)
+{
+    size_t host_to_uart = 0;
+    size_t uart_to_host = 0;
+    uint32_t num_records[TRAFFIC_CAPTURE_NRESET_DEASSERT + 1] = {0};
+    size_t offset = PCAP_FILE_HEADER_SIZE;
+
+    SIM_TEST_CHECK (recording_length >= PCAP_FILE_HEADER_SIZE, "the recording has no pcap file header");
+    while (offset < recording_length)
+    {
+        uint32_t incl_len;
+        uint8_t type;
+
+        SIM_TEST_CHECK ((offset + PCAP_RECORD_HEADER_SIZE + 1) <= recording_length, "truncated record header");
+        memcpy (&incl_len, &recording[offset + 8], sizeof (incl_len));
+        SIM_TEST_CHECK ((incl_len >= 1) && ((offset + PCAP_RECORD_HEADER_SIZE + incl_len) <= recording_length),
+                        "invalid record length %u", incl_len);
+        type = recording[offset + PCAP_RECORD_HEADER_SIZE];
+        SIM_TEST_CHECK (type <= TRAFFIC_CAPTURE_NRESET_DEASSERT, "invalid record type %u", type);
+        num_records[type]++;
+        if (type == TRAFFIC_CAPTURE_UART_TX)
+        {
+            host_to_uart += incl_len - 1;
+        }
+        else if (type == TRAFFIC_CAPTURE_UART_RX)
+        {
+            uart_to_host += incl_len - 1;
+        }
+        offset += PCAP_RECORD_HEADER_SIZE + incl_len;
+    }
+
+    SIM_TEST_CHECK (num_records[TRAFFIC_CAPTURE_DROPPED] == 0, "the recording has %u dropped records",
+                    num_records[TRAFFIC_CAPTURE_DROPPED]);
+    SIM_TEST_CHECK (host_to_uart == total_host_to_uart, "%zu of %zu host to UART bytes recorded", host_to_uart,
+                    total_host_to_uart);
+    SIM_TEST_CHECK (uart_to_host == total_uart_to_host, "%zu of %zu UART to host bytes recorded", uart_to_host,
+                    total_uart_to_host);
+    SIM_TEST_CHECK ((num_records[TRAFFIC_CAPTURE_BREAK_SET] == 1) && (num_records[TRAFFIC_CAPTURE_BREAK_CLEAR] == 1),
+                    "%u breaks set and %u cleared recorded", num_records[TRAFFIC_CAPTURE_BREAK_SET],
+                    num_records[TRAFFIC_CAPTURE_BREAK_CLEAR]);
+    SIM_TEST_CHECK ((num_records[TRAFFIC_CAPTURE_LINE_CODING] == 1) &&
+                    (num_records[TRAFFIC_CAPTURE_CONTROL_LINE_STATE] == 1),
+                    "%u line codings and %u control line states recorded", num_records[TRAFFIC_CAPTURE_LINE_CODING],
+                    num_records[TRAFFIC_CAPTURE_CONTROL_LINE_STATE]);
+}
+
+
+int main (int argc, char *argv[])
+{
+    FILE *pcap_file;
+
+    SIM_TEST_CHECK (argc == 2, "Usage: %s <pcap file>", argv[0]);
+    recording = malloc (RECORDING_MAX_LENGTH);
+    SIM_TEST_CHECK (recording != NULL, "out of memory");
+    sim_test_boot (SIM_CC3100_SINK);
+
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CAPTURE_CONTROL, TRAFFIC_CAPTURE_SESSION, NULL, 0) == 0,
+                    "CAPTURE_CONTROL stalled");
+    poll_capture (true);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    enter_bootloader ();
+    for (uint32_t index = 0; index < (sizeof (session_commands) / sizeof (session_commands[0])); index++)
+    {
+        exchange_command (&session_commands[index], index + 1);
+    }
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CAPTURE_CONTROL, TRAFFIC_CAPTURE_STOPPED, NULL, 0) == 0,
+                    "CAPTURE_CONTROL stalled");
+    poll_capture (false);
+    check_recording ();
+
+    pcap_file = fopen (argv[1], "wb");
+    SIM_TEST_CHECK ((pcap_file != NULL) && (fwrite (recording, 1, recording_length, pcap_file) == recording_length) &&
+                    (fclose (pcap_file) == 0), "can't write %s", argv[1]);
+    free (recording);
+    printf ("PASS test_session_record: %zu bytes of pcap, %.3f s of virtual time\n", recording_length,
+            (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
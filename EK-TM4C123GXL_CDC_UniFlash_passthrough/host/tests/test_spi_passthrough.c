@@ -0,0 +1,284 @@
+/*
+ * @file test_spi_passthrough.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the framing of the SPI passthrough commands on the vendor-specific bulk interface
+ * @details A SPI slave model, standing in for the CC3100, records the characters it receives while selected and
+ *          returns a transform of each, so the response data shows the received data was aligned with the
+ *          transmitted data. Transfers which fit in one bulk packet, end on a packet boundary and span many packets
+ *          are checked, along with holding the chip select between commands, rejection of invalid commands, and
+ *          the reporting of the CC3100 IRQ line. The CDC port must keep working while SPI commands are executed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/uart.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdcdc.h"
+#include "usblib/device/usbdbulk.h"
+#include "usblib/device/usbdcomp.h"
+
+#include "bridge_hal.h"
+#include "spi_passthrough.h"
+
+#include "sim_gpio.h"
+#include "sim_ssi.h"
+#include "sim_test.h"
+
+/** The USB port of the SPI passthrough bulk interface, which follows the CDC device */
+#define SPI_PORT 1
+
+/** The size of a command or response header */
+#define HEADER_SIZE sizeof (spi_passthrough_header_t)
+
+/** The time allowed for a command to be executed and its response read by the host */
+#define RESPONSE_TIMEOUT SIM_MS (20)
+
+/** The value the slave exclusive-ORs each received character with to form the character it returns */
+#define SLAVE_MISO_XOR 0x5a
+
+/** The state of the SPI slave model */
+static struct
+{
+    /** The characters received while selected, since last cleared */
+    uint8_t received[SPI_PASSTHROUGH_MAX_LENGTH * 2];
+    size_t num_received;
+    /** The number of times the chip select has been deasserted */
+    uint32_t num_deselects;
+    bool selected;
+} slave;
+
+
+static uint8_t slave_exchange (void *context, uint8_t mosi)
+{
+    (void) context;
+    SIM_TEST_CHECK (slave.selected, "SPI character 0x%02x shifted without the chip select asserted", mosi);
+    SIM_TEST_CHECK (slave.num_received < sizeof (slave.received), "SPI slave received too many characters");
+    slave.received[slave.num_received++] = mosi;
+
+    return mosi ^ SLAVE_MISO_XOR;
+}
+
+
+static void slave_cs_changed (void *context, uint32_t port_base, uint8_t levels)
+{
+    const bool selected = (levels & CC3100_SPI_CS_PIN) == 0;
+
+    (void) context;
+    (void) port_base;
+    if (slave.selected && !selected)
+    {
+        slave.num_deselects++;
+    }
+    slave.selected = selected;
+}
+
+
+static void write_command (const uint8_t command, const uint8_t flags, const uint8_t *const data,
+                           const uint32_t length)
+{
+    uint8_t *const packet = malloc (HEADER_SIZE + length);
+
+    SIM_TEST_CHECK (packet != NULL, "out of memory");
+    packet[0] = command;
+    packet[1] = flags;
+    packet[2] = length & 0xff;
+    packet[3] = (length >> 8) & 0xff;
+    if (length > 0)
+    {
+        memcpy (&packet[HEADER_SIZE], data, length);
+    }
+    sim_usb_host_write (SPI_PORT, packet, HEADER_SIZE + length);
+    free (packet);
+}
+
+
+/**
+ * @brief Read a response or event header from the host, and check it has the expected values
+ */
+static void check_header (const char *const description, const uint8_t command, const uint8_t status,
+                          const uint32_t length)
+{
+    uint8_t header[HEADER_SIZE];
+
+    SIM_TEST_CHECK (sim_test_wait_read_available (SPI_PORT, HEADER_SIZE, RESPONSE_TIMEOUT),
+                    "%s: no response", description);
+    SIM_TEST_CHECK (sim_usb_host_read (SPI_PORT, header, HEADER_SIZE) == HEADER_SIZE, "%s: short header",
+                    description);
+    SIM_TEST_CHECK ((header[0] == command) && (header[1] == status) &&
+                    ((uint32_t) (header[2] | (header[3] << 8)) == length),
+                    "%s: header %02x %02x %02x %02x, expected command 0x%02x status %u length %u", description,
+                    header[0], header[1], header[2], header[3], command, status, length);
+}
+
+
+/**
+ * @brief Perform a SPI transfer, and check the slave received the command data and the response contains the
+ *        data returned by the slave
+ */
+static void test_transfer (const uint32_t length, const uint8_t flags, const uint32_t seed)
+{
+    uint8_t mosi[SPI_PASSTHROUGH_MAX_LENGTH];
+    uint8_t miso[SPI_PASSTHROUGH_MAX_LENGTH];
+    char description[64];
+
+    snprintf (description, sizeof (description), "%u byte transfer", length);
+    sim_test_fill_pattern (mosi, length, seed);
+    slave.num_received = 0;
+    write_command (SPI_PASSTHROUGH_CMD_TRANSFER, flags, mosi, length);
+    check_header (description, SPI_PASSTHROUGH_CMD_TRANSFER, SPI_PASSTHROUGH_STATUS_OK, length);
+    SIM_TEST_CHECK (sim_test_wait_read_available (SPI_PORT, length, RESPONSE_TIMEOUT), "%s: only %zu bytes of data",
+                    description, sim_usb_host_read_available (SPI_PORT));
+    SIM_TEST_CHECK (sim_usb_host_read (SPI_PORT, miso, length) == length, "%s: short data", description);
+    SIM_TEST_CHECK (sim_usb_host_read_available (SPI_PORT) == 0, "%s: data after the response", description);
+
+    SIM_TEST_CHECK ((slave.num_received == length) && (memcmp (slave.received, mosi, length) == 0),
+                    "%s: the slave received %zu bytes which differ from the command", description,
+                    slave.num_received);
+    for (uint32_t index = 0; index < length; index++)
+    {
+        SIM_TEST_CHECK (miso[index] == (mosi[index] ^ SLAVE_MISO_XOR),
+                        "%s: response byte %u is 0x%02x, expected 0x%02x", description, index, miso[index],
+                        mosi[index] ^ SLAVE_MISO_XOR);
+    }
+    SIM_TEST_CHECK (slave.selected == ((flags & SPI_PASSTHROUGH_FLAG_HOLD_CS) != 0),
+                    "%s: chip select %s after the transfer", description,
+                    slave.selected ? "asserted" : "deasserted");
+}
+
+
+/**
+ * @brief Send a command which must be rejected without a SPI transfer
+ */
+static void test_invalid_command (const char *const description, const uint8_t command, const uint32_t length)
+{
+    uint8_t *const data = calloc (1, length + 1);
+    const uint64_t characters = sim_ssi_stats (CC3100_SPI_BASE)->characters;
+
+    SIM_TEST_CHECK (data != NULL, "out of memory");
+    write_command (command, 0, data, length);
+    check_header (description, command, SPI_PASSTHROUGH_STATUS_INVALID, 0);
+    sim_run_for (SIM_MS (1));
+    SIM_TEST_CHECK (sim_usb_host_read_available (SPI_PORT) == 0, "%s: data after the response", description);
+    SIM_TEST_CHECK (sim_ssi_stats (CC3100_SPI_BASE)->characters == characters, "%s: a SPI transfer was performed",
+                    description);
+    free (data);
+}
+
+
+/**
+ * @brief Check the IRQ level is reported, and that a rising edge is reported as an event
+ */
+static void test_irq (void)
+{
+    sim_gpio_drive (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, false);
+    write_command (SPI_PASSTHROUGH_CMD_GET_IRQ, 0, NULL, 0);
+    check_header ("GET_IRQ low", SPI_PASSTHROUGH_CMD_GET_IRQ, 0, 0);
+
+    sim_gpio_drive (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, true);
+    check_header ("IRQ rising edge", SPI_PASSTHROUGH_EVENT_IRQ, 1, 0);
+    write_command (SPI_PASSTHROUGH_CMD_GET_IRQ, 0, NULL, 0);
+    check_header ("GET_IRQ high", SPI_PASSTHROUGH_CMD_GET_IRQ, 1, 0);
+
+    /* A falling edge isn't reported */
+    sim_gpio_drive (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, false);
+    sim_run_for (SIM_MS (5));
+    SIM_TEST_CHECK (sim_usb_host_read_available (SPI_PORT) == 0, "an IRQ falling edge was reported");
+
+    /* An event raised while a response is being written doesn't split the response */
+    slave.num_received = 0;
+    write_command (SPI_PASSTHROUGH_CMD_TRANSFER, 0, slave.received, 256);
+    check_header ("transfer with IRQ", SPI_PASSTHROUGH_CMD_TRANSFER, SPI_PASSTHROUGH_STATUS_OK, 256);
+    sim_gpio_drive (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, true);
+    SIM_TEST_CHECK (sim_test_wait_read_available (SPI_PORT, 256 + HEADER_SIZE, RESPONSE_TIMEOUT),
+                    "no IRQ event after the response");
+    SIM_TEST_CHECK (sim_usb_host_read (SPI_PORT, slave.received, 256) == 256, "short response data");
+    check_header ("IRQ during a transfer", SPI_PASSTHROUGH_EVENT_IRQ, 1, 0);
+    sim_gpio_drive (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, false);
+}
+
+
+/**
+ * @brief Execute SPI transfers while the CDC port is echoing a stream through the CC3100 model
+ */
+static void test_concurrent_cdc (void)
+{
+    const size_t length = 8192;
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    uint32_t num_transfers = 0;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    sim_cc3100_set_mode (SIM_CC3100_ECHO);
+    sim_test_fill_pattern (sent, length, 14);
+    sim_usb_host_write (0, sent, length);
+    while (sim_usb_host_read_available (0) < length)
+    {
+        test_transfer (SPI_PASSTHROUGH_MAX_LENGTH, 0, num_transfers);
+        num_transfers++;
+        SIM_TEST_CHECK (num_transfers < 1000, "only %zu of %zu CDC bytes echoed", sim_usb_host_read_available (0),
+                        length);
+    }
+    SIM_TEST_CHECK ((sim_usb_host_read (0, received, length) == length) && (memcmp (sent, received, length) == 0),
+                    "the CDC stream was corrupted");
+    printf ("%u SPI transfers while echoing %zu bytes on the CDC port\n", num_transfers, length);
+
+    free (sent);
+    free (received);
+}
+
+
+int main (void)
+{
+    static const uint32_t lengths[] = {1, 4, 59, 60, 61, 64, 124, 125, 500, SPI_PASSTHROUGH_MAX_LENGTH};
+    const sim_ssi_slave_t slave_callbacks = {.exchange = slave_exchange};
+    uint32_t num_deselects;
+
+    sim_ssi_attach (CC3100_SPI_BASE, &slave_callbacks);
+    sim_gpio_observe (CC3100_SPI_CS_PORT_BASE, CC3100_SPI_CS_PIN, slave_cs_changed, NULL);
+    sim_test_boot (SIM_CC3100_SINK);
+    SIM_TEST_CHECK (sim_usb_host_num_ports () == 2, "%u ports, expected the CDC and SPI passthrough",
+                    sim_usb_host_num_ports ());
+    SIM_TEST_CHECK (!slave.selected, "the chip select is asserted after reset");
+
+    /* Transfers within one packet, ending either side of a packet boundary with the header, and of many packets */
+    for (uint32_t index = 0; index < (sizeof (lengths) / sizeof (lengths[0])); index++)
+    {
+        num_deselects = slave.num_deselects;
+        test_transfer (lengths[index], 0, index);
+        SIM_TEST_CHECK (slave.num_deselects == (num_deselects + 1), "%u byte transfer: %u chip select pulses",
+                        lengths[index], slave.num_deselects - num_deselects);
+    }
+
+    /* The chip select is held between transfers until a transfer without HOLD_CS */
+    num_deselects = slave.num_deselects;
+    test_transfer (16, SPI_PASSTHROUGH_FLAG_HOLD_CS, 100);
+    test_transfer (200, SPI_PASSTHROUGH_FLAG_HOLD_CS, 101);
+    test_transfer (8, 0, 102);
+    SIM_TEST_CHECK (slave.num_deselects == (num_deselects + 1), "the chip select wasn't held between transfers");
+
+    test_invalid_command ("zero length transfer", SPI_PASSTHROUGH_CMD_TRANSFER, 0);
+    test_invalid_command ("too long transfer", SPI_PASSTHROUGH_CMD_TRANSFER, SPI_PASSTHROUGH_MAX_LENGTH + 1);
+    test_invalid_command ("unknown command", 0x7f, 0);
+    test_invalid_command ("unknown command with data", 0x7f, 100);
+
+    /* Commands are still framed correctly after the rejected commands */
+    test_transfer (64, 0, 103);
+
+    test_irq ();
+    test_concurrent_cdc ();
+    SIM_TEST_CHECK (sim_ssi_stats (CC3100_SPI_BASE)->rx_overruns == 0, "the SSI receive FIFO overran");
+
+    printf ("PASS test_spi_passthrough: %llu SPI characters in %.3f s of virtual time\n",
+            (unsigned long long) sim_ssi_stats (CC3100_SPI_BASE)->characters, (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * @file test_spsc_ring.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Unit and stress test of the lock-free single-producer / single-consumer ring buffer
+ * @details The ring is used directly, without the simulation, since spsc_ring.h only depends upon the compiler.
+ *          The unit tests check the empty and full conditions, the spans either side of the end of the buffer,
+ *          reserving spans beyond the head as the uDMA does, the free running counts wrapping and the high-water
+ *          mark. The stress test runs the producer and consumer on separate threads, each moving random length
+ *          spans, and checks every byte arrives in order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "spsc_ring.h"
+
+/** The size of the ring used by the unit tests */
+#define UNIT_RING_SIZE 8
+
+/** The size of the ring used by the stress test, small so the producer and consumer often wait for each other */
+#define STRESS_RING_SIZE 64
+
+/** The bytes moved through the ring by the stress test */
+#define STRESS_LENGTH (16u * 1024u * 1024u)
+
+#define CHECK(condition, ...) \
+    do { if (!(condition)) { fprintf (stderr, "FAIL line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); \
+                             fprintf (stderr, "\n"); exit (EXIT_FAILURE); } } while (0)
+
+
+/**
+ * @brief Write bytes at the head of a ring, which must fit in the contiguous span
+ */
+static void write_bytes (spsc_ring_t *const ring, const uint8_t first_value, const uint32_t length)
+{
+    uint32_t span_length;
+    uint8_t *const span = spsc_ring_write_span (ring, &span_length);
+
+    CHECK (span_length >= length, "write span of %u bytes, expected at least %u", span_length, length);
+    for (uint32_t index = 0; index < length; index++)
+    {
+        span[index] = (uint8_t) (first_value + index);
+    }
+    spsc_ring_write_commit (ring, length);
+}
+
+
+/**
+ * @brief Read bytes from the tail of a ring, checking the contiguous span has the expected length and values
+ */
+static void read_bytes (spsc_ring_t *const ring, const uint8_t first_value, const uint32_t expected_span_length,
+                        const uint32_t length)
+{
+    uint32_t span_length;
+    const uint8_t *const span = spsc_ring_read_span (ring, &span_length);
+
+    CHECK (span_length == expected_span_length, "read span of %u bytes, expected %u", span_length,
+           expected_span_length);
+    for (uint32_t index = 0; index < length; index++)
+    {
+        CHECK (span[index] == (uint8_t) (first_value + index), "read byte %u is 0x%02x, expected 0x%02x", index,
+               span[index], (uint8_t) (first_value + index));
+    }
+    spsc_ring_read_commit (ring, length);
+}
+
+
+static void test_empty_and_full (void)
+{
+    uint8_t buffer[UNIT_RING_SIZE];
+    spsc_ring_t ring;
+    uint32_t span_length;
+    uint8_t *span;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    CHECK (spsc_ring_size (&ring) == UNIT_RING_SIZE, "size %u", spsc_ring_size (&ring));
+    CHECK ((spsc_ring_used (&ring) == 0) && (spsc_ring_free (&ring) == UNIT_RING_SIZE), "not empty after init");
+    (void) spsc_ring_read_span (&ring, &span_length);
+    CHECK (span_length == 0, "empty ring has a read span of %u", span_length);
+    span = spsc_ring_write_span (&ring, &span_length);
+    CHECK ((span == buffer) && (span_length == UNIT_RING_SIZE), "empty ring write span of %u", span_length);
+
+    /* The ring can be completely filled, as the counts are free running */
+    write_bytes (&ring, 0x10, UNIT_RING_SIZE);
+    CHECK ((spsc_ring_used (&ring) == UNIT_RING_SIZE) && (spsc_ring_free (&ring) == 0), "not full");
+    (void) spsc_ring_write_span (&ring, &span_length);
+    CHECK (span_length == 0, "full ring has a write span of %u", span_length);
+    read_bytes (&ring, 0x10, UNIT_RING_SIZE, UNIT_RING_SIZE);
+    CHECK ((spsc_ring_used (&ring) == 0) && (spsc_ring_free (&ring) == UNIT_RING_SIZE), "not empty after drain");
+}
+
+
+static void test_wrap (void)
+{
+    uint8_t buffer[UNIT_RING_SIZE];
+    spsc_ring_t ring;
+    uint32_t span_length;
+    uint8_t *span;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    write_bytes (&ring, 0x20, 6);
+    read_bytes (&ring, 0x20, 6, 6);
+
+    /* The free space is two spans, the first up to the end of the buffer */
+    span = spsc_ring_write_span (&ring, &span_length);
+    CHECK ((span == &buffer[6]) && (span_length == 2), "first write span of %u at offset %td", span_length,
+           span - buffer);
+    write_bytes (&ring, 0x30, 2);
+    span = spsc_ring_write_span (&ring, &span_length);
+    CHECK ((span == buffer) && (span_length == 6), "second write span of %u at offset %td", span_length,
+           span - buffer);
+    write_bytes (&ring, 0x32, 5);
+    CHECK (spsc_ring_used (&ring) == 7, "%u bytes used after the wrap", spsc_ring_used (&ring));
+
+    /* The data is also two spans, read in order */
+    read_bytes (&ring, 0x30, 2, 2);
+    read_bytes (&ring, 0x32, 5, 5);
+
+    /* A span is only partially committed */
+    write_bytes (&ring, 0x40, 3);
+    read_bytes (&ring, 0x40, 3, 1);
+    read_bytes (&ring, 0x41, 2, 2);
+}
+
+
+/**
+ * @brief Reserve spans beyond the head before committing earlier ones, as the uDMA ping-pong receive does
+ */
+static void test_write_span_at (void)
+{
+    uint8_t buffer[UNIT_RING_SIZE];
+    spsc_ring_t ring;
+    uint32_t span_length;
+    uint8_t *span;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    span = spsc_ring_write_span_at (&ring, 4, &span_length);
+    CHECK ((span == &buffer[4]) && (span_length == 4), "span at 4 of %u at offset %td", span_length, span - buffer);
+    (void) spsc_ring_write_span_at (&ring, UNIT_RING_SIZE, &span_length);
+    CHECK (span_length == 0, "span beyond the free space of %u", span_length);
+
+    /* Once data is in the ring, a skipped span is limited by the tail */
+    write_bytes (&ring, 0x50, 3);
+    read_bytes (&ring, 0x50, 3, 2);
+    span = spsc_ring_write_span_at (&ring, 3, &span_length);
+    CHECK ((span == &buffer[6]) && (span_length == 2), "span at 3 of %u at offset %td", span_length, span - buffer);
+    span = spsc_ring_write_span_at (&ring, 5, &span_length);
+    CHECK ((span == &buffer[0]) && (span_length == 2), "span at 5 of %u at offset %td", span_length, span - buffer);
+}
+
+
+/**
+ * @brief The counts are free running, so used and free must stay correct as they wrap past 2^32
+ */
+static void test_count_wrap (void)
+{
+    uint8_t buffer[UNIT_RING_SIZE];
+    spsc_ring_t ring;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    ring.head = 0xFFFFFFFCu;
+    ring.tail = 0xFFFFFFFCu;
+    for (uint32_t iteration = 0; iteration < 4; iteration++)
+    {
+        uint32_t span_length;
+
+        (void) spsc_ring_write_span (&ring, &span_length);
+        write_bytes (&ring, (uint8_t) iteration, span_length);
+        CHECK (spsc_ring_used (&ring) == span_length, "%u used after the count wrapped, expected %u",
+               spsc_ring_used (&ring), span_length);
+        if (spsc_ring_free (&ring) > 0)
+        {
+            uint32_t second_length;
+
+            (void) spsc_ring_write_span (&ring, &second_length);
+            write_bytes (&ring, (uint8_t) (iteration + span_length), second_length);
+        }
+        CHECK (spsc_ring_free (&ring) == 0, "%u free after filling across the count wrap", spsc_ring_free (&ring));
+        read_bytes (&ring, (uint8_t) iteration, 4, 4);
+        read_bytes (&ring, (uint8_t) (iteration + 4), 4, 4);
+    }
+    CHECK (ring.head < 0x100, "the head count didn't wrap");
+}
+
+
+static void test_high_water (void)
+{
+    uint8_t buffer[UNIT_RING_SIZE];
+    spsc_ring_t ring;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    write_bytes (&ring, 0, 3);
+    write_bytes (&ring, 3, 2);
+    CHECK (ring.high_water == 5, "high-water %u, expected 5", ring.high_water);
+    read_bytes (&ring, 0, 5, 5);
+    write_bytes (&ring, 5, 3);
+    CHECK (ring.high_water == 5, "high-water %u fell, expected 5", ring.high_water);
+    write_bytes (&ring, 8, 3);
+    CHECK (ring.high_water == 6, "high-water %u, expected 6", ring.high_water);
+
+    /* The firmware clears the high-water mark by writing zero, after which it follows the next commit */
+    ring.high_water = 0;
+    write_bytes (&ring, 11, 1);
+    CHECK (ring.high_water == 7, "high-water %u after clearing, expected 7", ring.high_water);
+}
+
+
+/*
+ * Stress test
+ */
+
+typedef struct
+{
+    spsc_ring_t *ring;
+    uint32_t seed;
+} stress_thread_t;
+
+
+static uint32_t next_random (uint32_t *const state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+
+static void *stress_producer (void *arg)
+{
+    stress_thread_t *const thread = arg;
+    uint32_t sent = 0;
+
+    while (sent < STRESS_LENGTH)
+    {
+        uint32_t span_length;
+        uint8_t *const span = spsc_ring_write_span (thread->ring, &span_length);
+        uint32_t length = next_random (&thread->seed) % (span_length + 1);
+
+        if (span_length == 0)
+        {
+            /* Let the consumer run when the host has fewer CPUs than threads */
+            sched_yield ();
+        }
+
+        if (length > (STRESS_LENGTH - sent))
+        {
+            length = STRESS_LENGTH - sent;
+        }
+        for (uint32_t index = 0; index < length; index++)
+        {
+            span[index] = (uint8_t) ((sent + index) * 7u);
+        }
+        spsc_ring_write_commit (thread->ring, length);
+        sent += length;
+    }
+
+    return NULL;
+}
+
+
+static void *stress_consumer (void *arg)
+{
+    stress_thread_t *const thread = arg;
+    uint32_t received = 0;
+
+    while (received < STRESS_LENGTH)
+    {
+        uint32_t span_length;
+        const uint8_t *const span = spsc_ring_read_span (thread->ring, &span_length);
+        const uint32_t length = next_random (&thread->seed) % (span_length + 1);
+
+        if (span_length == 0)
+        {
+            sched_yield ();
+        }
+        for (uint32_t index = 0; index < length; index++)
+        {
+            CHECK (span[index] == (uint8_t) ((received + index) * 7u), "stress byte %u is 0x%02x, expected 0x%02x",
+                   received + index, span[index], (uint8_t) ((received + index) * 7u));
+        }
+        spsc_ring_read_commit (thread->ring, length);
+        received += length;
+    }
+
+    return NULL;
+}
+
+
+static void test_two_thread_stress (void)
+{
+    static uint8_t buffer[STRESS_RING_SIZE];
+    spsc_ring_t ring;
+    stress_thread_t producer = {.ring = &ring, .seed = 0x12345};
+    stress_thread_t consumer = {.ring = &ring, .seed = 0x6789};
+    pthread_t producer_thread;
+    pthread_t consumer_thread;
+
+    spsc_ring_init (&ring, buffer, sizeof (buffer));
+    CHECK ((pthread_create (&consumer_thread, NULL, stress_consumer, &consumer) == 0) &&
+           (pthread_create (&producer_thread, NULL, stress_producer, &producer) == 0), "pthread_create failed");
+    pthread_join (producer_thread, NULL);
+    pthread_join (consumer_thread, NULL);
+    CHECK ((spsc_ring_used (&ring) == 0) && (ring.head == STRESS_LENGTH), "%u bytes left in the ring",
+           spsc_ring_used (&ring));
+    CHECK (ring.high_water <= STRESS_RING_SIZE, "high-water %u exceeds the size", ring.high_water);
+    printf ("stress: %u bytes through a %u byte ring, high-water %u\n", STRESS_LENGTH, STRESS_RING_SIZE,
+            ring.high_water);
+}
+
+
+int main (void)
+{
+    test_empty_and_full ();
+    test_wrap ();
+    test_write_span_at ();
+    test_count_wrap ();
+    test_high_water ();
+    test_two_thread_stress ();
+
+    printf ("PASS test_spsc_ring\n");
+
+    return 0;
+}
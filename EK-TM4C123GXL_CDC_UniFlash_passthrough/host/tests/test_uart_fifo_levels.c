@@ -0,0 +1,141 @@
+/*
+ * @file test_uart_fifo_levels.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Test the adaptive selection of the UART receive FIFO trigger level, from interactive and bulk traffic
+ * @details The CC3100 model sends either short bursts separated by idle time, as for bootloader acknowledgements, or
+ *          a continuous stream, as for a file read. Checks that:
+ *  - Interactive bursts select the 2/8 receive trigger level, which is applied to the UART.
+ *  - A bulk stream selects the deepest receive trigger level which the baud rate allows, which is 7/8 at 115200
+ *    baud but limited to 6/8 at 921600 baud.
+ *  - The trigger level reported by VENDOR_REQUEST_GET_UART_FIFO_STATS matches that applied to the UART, and bulk
+ *    traffic takes fewer UART interrupts per byte than interactive traffic.
+ *  - Every byte arrives intact.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "uart_fifo_levels.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The length of each interactive burst, shorter than the UART FIFO */
+#define INTERACTIVE_BURST_LENGTH 4
+
+/** The number of interactive bursts, enough for the average burst length to decay from a bulk stream */
+#define NUM_INTERACTIVE_BURSTS 64
+
+/** The length of a bulk stream */
+#define BULK_LENGTH 8192
+
+/** The receive trigger levels, as characters in the FIFO */
+#define RX_TRIGGER_2_8_CHARS 4
+#define RX_TRIGGER_6_8_CHARS 12
+#define RX_TRIGGER_7_8_CHARS 14
+
+
+static void get_fifo_stats (uart_fifo_stats_t *const stats)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_UART_FIFO_STATS, 0, stats, sizeof (*stats)) ==
+                    sizeof (*stats), "GET_UART_FIFO_STATS failed");
+}
+
+
+/**
+ * @brief Send data from the CC3100 and check it arrives intact at the host
+ */
+static void receive_from_cc3100 (const size_t length, const uint32_t seed)
+{
+    uint8_t sent[BULK_LENGTH];
+    uint8_t received[BULK_LENGTH];
+    const sim_time_t timeout = 4u * (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length + SIM_MS (50);
+
+    sim_test_fill_pattern (sent, length, seed);
+    sim_cc3100_send (sent, length);
+    SIM_TEST_CHECK (sim_test_wait_read_available (0, length, timeout), "only %zu of %zu bytes received",
+                    sim_usb_host_read_available (0), length);
+    SIM_TEST_CHECK ((sim_usb_host_read (0, received, length) == length) && (memcmp (sent, received, length) == 0),
+                    "bytes corrupted from the CC3100");
+}
+
+
+/**
+ * @brief Receive a traffic pattern and check the receive trigger level which it selects
+ * @param[in] bulk When true a bulk stream is received, otherwise interactive bursts
+ * @param[in] expected_trigger_chars The receive trigger level expected to be applied
+ * @return Returns the UART interrupts per byte during the traffic
+ */
+static double check_traffic (const bool bulk, const uint32_t expected_trigger_chars)
+{
+    uart_fifo_stats_t before;
+    uart_fifo_stats_t after;
+    uint32_t num_bytes;
+    double interrupts_per_byte;
+
+    get_fifo_stats (&before);
+    if (bulk)
+    {
+        receive_from_cc3100 (BULK_LENGTH, 1);
+    }
+    else
+    {
+        for (uint32_t burst = 0; burst < NUM_INTERACTIVE_BURSTS; burst++)
+        {
+            receive_from_cc3100 (INTERACTIVE_BURST_LENGTH, burst);
+            sim_run_for (SIM_US (500));
+        }
+    }
+    /* Let the receive timeout at the end of the traffic apply the new trigger level */
+    sim_run_for (SIM_MS (2));
+    get_fifo_stats (&after);
+
+    num_bytes = (after.num_rx_bytes + after.num_tx_bytes) - (before.num_rx_bytes + before.num_tx_bytes);
+    interrupts_per_byte = (double) (after.num_interrupts - before.num_interrupts) / num_bytes;
+    printf ("%s: average burst %u, rx trigger %u chars, %.3f interrupts per byte\n",
+            bulk ? "bulk" : "interactive", after.average_burst_length, after.rx_trigger_chars, interrupts_per_byte);
+    SIM_TEST_CHECK (after.rx_trigger_chars == expected_trigger_chars, "%s traffic selected an rx trigger of %u chars, "
+                    "expected %u", bulk ? "bulk" : "interactive", after.rx_trigger_chars, expected_trigger_chars);
+    SIM_TEST_CHECK (sim_uart_rx_trigger_chars (UART1_BASE) == after.rx_trigger_chars,
+                    "the UART has an rx trigger of %u chars, but %u is reported",
+                    sim_uart_rx_trigger_chars (UART1_BASE), after.rx_trigger_chars);
+
+    return interrupts_per_byte;
+}
+
+
+int main (void)
+{
+    double interactive_per_byte;
+    double bulk_per_byte;
+
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    /* At 115200 baud every trigger level leaves enough time to service the FIFO */
+    sim_test_set_line_coding (0, 115200, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    interactive_per_byte = check_traffic (false, RX_TRIGGER_2_8_CHARS);
+    bulk_per_byte = check_traffic (true, RX_TRIGGER_7_8_CHARS);
+    SIM_TEST_CHECK (bulk_per_byte < interactive_per_byte,
+                    "bulk traffic took %.3f interrupts per byte, interactive %.3f", bulk_per_byte,
+                    interactive_per_byte);
+    interactive_per_byte = check_traffic (false, RX_TRIGGER_2_8_CHARS);
+
+    /* At 921600 baud the 7/8 level leaves less than UART_FIFO_SERVICE_LATENCY_NS to service the FIFO */
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    bulk_per_byte = check_traffic (true, RX_TRIGGER_6_8_CHARS);
+    interactive_per_byte = check_traffic (false, RX_TRIGGER_2_8_CHARS);
+    SIM_TEST_CHECK (bulk_per_byte < interactive_per_byte,
+                    "bulk traffic took %.3f interrupts per byte, interactive %.3f", bulk_per_byte,
+                    interactive_per_byte);
+
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns == 0, "UART1 overran");
+    printf ("PASS test_uart_fifo_levels\n");
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * @file test_udma_receive.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Regression tests for the ping-pong uDMA receive transfer from UART1 into the CDC transmit buffer
+ * @details Checks that:
+ *  - A burst from the CC3100 which is a multiple of the uDMA arbitration size is passed to the USB host on the
+ *    receive timeout, rather than being held in a partially filled half until more characters arrive.
+ *  - When the USB host stops reading, so that the uDMA stops with the CDC transmit buffer full, restarting the
+ *    transfer doesn't continue into a stale half and overwrite data yet to be sent to the host.
+ *  - Without flow control, the data which fitted in the CDC transmit buffer before it filled reaches the host
+ *    intact, when the transfer was restarted with space for only one half.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "usb_serial_structs.h"
+
+#include "sim_test.h"
+
+/** The burst lengths sent by the CC3100, covering multiples of each uDMA arbitration size and trigger level */
+static const size_t burst_lengths[] = {1, 2, 4, 6, 8, 12, 14, 16, 24, 32, 63, 64, 65, 96, 100, 128, 200};
+
+
+/**
+ * @brief Check that the host receives exactly the data sent by the CC3100
+ */
+static void check_received (const uint8_t *const sent, const size_t length, const char *const description)
+{
+    uint8_t *const received = malloc (length);
+
+    SIM_TEST_CHECK (received != NULL, "out of memory");
+    SIM_TEST_CHECK (sim_usb_host_read (0, received, length) == length, "%s: short read", description);
+    for (size_t offset = 0; offset < length; offset++)
+    {
+        SIM_TEST_CHECK (received[offset] == sent[offset], "%s: byte %zu received as 0x%02x, sent 0x%02x",
+                        description, offset, received[offset], sent[offset]);
+    }
+    SIM_TEST_CHECK (sim_usb_host_read_available (0) == 0, "%s: %zu extra bytes received", description,
+                    sim_usb_host_read_available (0));
+    free (received);
+}
+
+
+/**
+ * @brief Send bursts from the CC3100, and check each is passed to the host within the receive timeout plus a
+ *        few USB frames of the last character being received
+ */
+static void test_burst_residue (const uint32_t baud)
+{
+    uint8_t burst[256];
+    char description[64];
+
+    sim_test_set_line_coding (0, baud, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    for (size_t burst_index = 0; burst_index < (sizeof (burst_lengths) / sizeof (burst_lengths[0])); burst_index++)
+    {
+        const size_t length = burst_lengths[burst_index];
+        const sim_time_t timeout = (sim_time_t) sim_uart_character_cycles (UART1_BASE) * (length + 4) + SIM_MS (4);
+
+        snprintf (description, sizeof (description), "%u baud burst of %zu", baud, length);
+        sim_test_fill_pattern (burst, length, (uint32_t) (baud + length));
+        sim_cc3100_send (burst, length);
+        SIM_TEST_CHECK (sim_test_wait_read_available (0, length, timeout),
+                        "%s: only %zu bytes passed to the host", description, sim_usb_host_read_available (0));
+        check_received (burst, length, description);
+    }
+}
+
+
+/**
+ * @brief Stream from the CC3100 while the host only reads in spurts, so that the uDMA receive transfer repeatedly
+ *        stops with the CDC transmit buffer full and is restarted once the host reads
+ * @param[in] length The total bytes to stream
+ * @param[in] spurt How many bytes the host reads before stopping, or SIZE_MAX to stop until all have been sent
+ */
+static void test_stopped_transfer (const size_t length, const size_t spurt)
+{
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    const sim_time_t stream_time = (sim_time_t) sim_uart_character_cycles (UART1_BASE) * length;
+    size_t num_received = 0;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_fill_pattern (sent, length, (uint32_t) spurt);
+    sim_usb_host_set_read_limit (0, 0);
+    sim_cc3100_send (sent, length);
+    while (num_received < length)
+    {
+        /* Leave the host not reading for long enough to fill the CDC transmit buffer and throttle the CC3100 */
+        sim_run_for (SIM_MS (50));
+        SIM_TEST_CHECK (sim_usb_host_read_available (0) == 0, "the host read while stopped");
+        sim_usb_host_set_read_limit (0, spurt);
+        SIM_TEST_CHECK (sim_test_wait_read_available (0, (spurt < (length - num_received)) ?
+                                                      spurt - (spurt % 64) : (length - num_received),
+                                                      stream_time + SIM_MS (100)),
+                        "only %zu of %zu bytes received", num_received + sim_usb_host_read_available (0), length);
+        sim_usb_host_set_read_limit (0, 0);
+        num_received += sim_usb_host_read (0, &received[num_received], length - num_received);
+    }
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+
+    for (size_t offset = 0; offset < length; offset++)
+    {
+        SIM_TEST_CHECK (received[offset] == sent[offset], "spurts of %zu: byte %zu received as 0x%02x, sent 0x%02x",
+                        spurt, offset, received[offset], sent[offset]);
+    }
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_throttled_cycles > 0, "the CC3100 was never throttled");
+    free (sent);
+    free (received);
+}
+
+
+/**
+ * @brief Fill the CDC transmit buffer with bursts while the host isn't reading and the CC3100 ignores RTS
+ * @details Each burst ends with a receive timeout which restarts the uDMA transfer with less free space, until there
+ *          is only space to arm one half. The other half must not be left armed from before the receive timeout.
+ *          Characters sent once the buffer is full are lost, so only the data which fitted is checked.
+ * @param[in] burst_length The length of each burst from the CC3100
+ */
+static void test_fill_without_flow_control (const size_t burst_length)
+{
+    const uint32_t uart_config = UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE;
+    const size_t capacity = spsc_ring_size (&cdc_tx_buffer);
+    const size_t length = capacity + (4 * burst_length);
+    const sim_time_t burst_time = (sim_time_t) sim_uart_character_cycles (UART1_BASE) * burst_length + SIM_MS (1);
+    uint8_t *const sent = malloc (length);
+    uint8_t *const received = malloc (length);
+    size_t num_received;
+
+    SIM_TEST_CHECK ((sent != NULL) && (received != NULL), "out of memory");
+    sim_test_fill_pattern (sent, length, (uint32_t) burst_length);
+    sim_uart_peer_config (UART1_BASE, 115200, uart_config, false);
+    sim_usb_host_set_read_limit (0, 0);
+    for (size_t offset = 0; offset < length; offset += burst_length)
+    {
+        sim_cc3100_send (&sent[offset], ((length - offset) < burst_length) ? (length - offset) : burst_length);
+        sim_run_for (burst_time);
+    }
+
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+    SIM_TEST_CHECK (sim_test_wait_read_available (0, capacity, SIM_MS (100)),
+                    "bursts of %zu: only %zu bytes received", burst_length, sim_usb_host_read_available (0));
+    sim_run_for (SIM_MS (10));
+    num_received = sim_usb_host_read (0, received, length);
+    for (size_t offset = 0; offset < capacity; offset++)
+    {
+        SIM_TEST_CHECK (received[offset] == sent[offset], "bursts of %zu: byte %zu received as 0x%02x, sent 0x%02x",
+                        burst_length, offset, received[offset], sent[offset]);
+    }
+    SIM_TEST_CHECK (num_received < length, "bursts of %zu: the CDC transmit buffer never filled", burst_length);
+
+    sim_cc3100_line_config (115200, uart_config);
+    sim_uart_stats_clear (UART1_BASE);
+    free (sent);
+    free (received);
+}
+
+
+int main (void)
+{
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+
+    /* Baud rates which select different receive trigger levels, and so uDMA arbitration sizes */
+    test_burst_residue (115200);
+    test_burst_residue (460800);
+    test_burst_residue (921600);
+
+    test_stopped_transfer (40000, SIZE_MAX);
+    test_stopped_transfer (40000, 1000);
+    test_stopped_transfer (40000, 4096 + 64);
+
+    SIM_TEST_CHECK (sim_uart_stats (UART1_BASE)->rx_overruns == 0, "UART1 overran");
+
+    /* Last, as characters are lost */
+    sim_test_set_line_coding (0, 115200, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    test_fill_without_flow_control (40);
+    test_fill_without_flow_control (100);
+    test_fill_without_flow_control (24);
+
+    printf ("PASS test_udma_receive: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
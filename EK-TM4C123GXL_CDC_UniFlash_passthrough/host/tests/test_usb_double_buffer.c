@@ -0,0 +1,211 @@
+/*
+ * @file test_usb_double_buffer.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Measure the USB packets per frame on the bulk data endpoints, with and without double-buffered FIFOs
+ * @details The program is built against the default firmware, which has USB_DOUBLE_BUFFER enabled, and against
+ *          a build with single-buffered FIFOs, so the two results are the before and after of double buffering.
+ *          Each measures bursts limited only by the USB, rather than by the serial line:
+ *          - write: the host writes to the CDC receive buffer while the CC3100 holds CTS deasserted.
+ *          - read: the host reads the CDC transmit buffer once it has been filled from the CC3100.
+ *
+ *          The packets per frame are taken from both the host, and VENDOR_REQUEST_GET_USB_ENDPOINT_STATS of the
+ *          firmware, and written as one JSON object per line. With double buffering the device must accept and
+ *          supply more packets per frame than a single-buffered FIFO allows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "usblib/usbcdc.h"
+
+#include "usb_serial_structs.h"
+#include "usb_data_endpoints.h"
+#include "vendor_requests.h"
+
+#include "sim_test.h"
+
+/** The bytes left free in a CDC buffer by a burst, so the firmware never has to refuse a packet */
+#define BURST_MARGIN 512u
+
+/** The packets per frame above which a burst shows the FIFOs are double-buffered. A single-buffered FIFO is
+ *  NAKed after each packet until the firmware has handled it, so the host retries on the next microframe. */
+#define MIN_DOUBLE_BUFFERED_PACKETS_PER_FRAME 10.0
+
+/** The result of one burst */
+typedef struct
+{
+    size_t bytes;
+    sim_time_t elapsed;
+    uint64_t host_packets;
+    uint64_t host_naks;
+    uint64_t host_active_frames;
+    usb_data_endpoint_stats_t firmware;
+} burst_result_t;
+
+
+static void clear_stats (void)
+{
+    SIM_TEST_CHECK (sim_test_vendor_out (VENDOR_REQUEST_CLEAR_USB_ENDPOINT_STATS, 0, NULL, 0) == 0,
+                    "CLEAR_USB_ENDPOINT_STATS failed");
+    sim_usb_host_port_stats_clear (0);
+}
+
+
+static void get_stats (burst_result_t *const result)
+{
+    SIM_TEST_CHECK (sim_test_vendor_in (VENDOR_REQUEST_GET_USB_ENDPOINT_STATS, 0, &result->firmware,
+                                        sizeof (result->firmware)) == sizeof (result->firmware),
+                    "GET_USB_ENDPOINT_STATS failed");
+}
+
+
+static bool write_complete (void *arg)
+{
+    (void) arg;
+    return sim_usb_host_write_pending (0) == 0;
+}
+
+
+/**
+ * @brief Write a burst into the CDC receive buffer, while the UART is held off by CTS so can't drain it
+ */
+static void measure_write (burst_result_t *const result, uint8_t *const data)
+{
+    const size_t length = spsc_ring_size (&cdc_rx_buffer) - BURST_MARGIN;
+    const sim_usb_port_stats_t *const host_stats = sim_usb_host_port_stats (0);
+    sim_time_t start;
+
+    /* The host only writes, so the OUT endpoint is the only active bulk pipe */
+    sim_test_fill_pattern (data, length, 16);
+    sim_usb_host_set_read_limit (0, 0);
+    sim_uart_peer_set_rts (UART1_BASE, false);
+    clear_stats ();
+    start = sim_now;
+    sim_usb_host_write (0, data, length);
+    SIM_TEST_CHECK (sim_run_until (write_complete, NULL, SIM_MS (100)), "write: %zu bytes not accepted",
+                    sim_usb_host_write_pending (0));
+    result->elapsed = sim_now - start;
+    result->bytes = length;
+    result->host_packets = host_stats->out_packets;
+    result->host_naks = host_stats->out_naks;
+    result->host_active_frames = host_stats->out_active_frames;
+
+    /* Allow the firmware to read the last packet from the FIFO, which is when it is counted */
+    sim_run_for (SIM_MS (1));
+    get_stats (result);
+
+    /* Let the UART drain the burst to the CC3100 */
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+    sim_uart_peer_set_rts (UART1_BASE, true);
+    sim_run_for (sim_uart_character_cycles (UART1_BASE) * (sim_time_t) length + SIM_MS (10));
+    SIM_TEST_CHECK (sim_cc3100_read (data, length) == length, "write: the burst didn't reach the CC3100");
+}
+
+
+/**
+ * @brief Read a burst from the CDC transmit buffer, once the CC3100 has filled it while the host wasn't reading
+ */
+static void measure_read (burst_result_t *const result, uint8_t *const data)
+{
+    const size_t length = spsc_ring_size (&cdc_tx_buffer) - BURST_MARGIN;
+    const sim_usb_port_stats_t *const host_stats = sim_usb_host_port_stats (0);
+    sim_time_t start;
+
+    sim_test_fill_pattern (data, length, 17);
+    sim_usb_host_set_read_limit (0, 0);
+    sim_cc3100_send (data, length);
+    sim_run_for (sim_uart_character_cycles (UART1_BASE) * (sim_time_t) length + SIM_MS (10));
+    clear_stats ();
+    start = sim_now;
+    sim_usb_host_set_read_limit (0, SIZE_MAX);
+    SIM_TEST_CHECK (sim_test_wait_read_available (0, length, SIM_MS (100)), "read: only %zu of %zu bytes read",
+                    sim_usb_host_read_available (0), length);
+    result->elapsed = sim_now - start;
+    result->bytes = length;
+    result->host_packets = host_stats->in_packets;
+    result->host_naks = host_stats->in_naks;
+    result->host_active_frames = host_stats->in_active_frames;
+    get_stats (result);
+    SIM_TEST_CHECK (sim_usb_host_read (0, data, length) == length, "read: short read");
+}
+
+
+/**
+ * @brief Write the result of one burst as a JSON object on one line
+ * @return The average packets per active frame counted by the firmware
+ */
+static double report_result (const char *const direction, const burst_result_t *const result,
+                             const uint32_t firmware_packets, const uint32_t firmware_active_frames,
+                             const uint32_t firmware_max_per_frame)
+{
+    const double packets_per_frame = (firmware_active_frames > 0) ?
+            ((double) firmware_packets / firmware_active_frames) : 0.0;
+
+    printf ("{\"usb_double_buffer\": %u, \"direction\": \"%s\", \"bytes\": %zu, \"mb_per_s\": %.3f, "
+            "\"packets\": %u, \"packets_per_frame\": %.2f, \"max_packets_per_frame\": %u, "
+            "\"host_packets_per_frame\": %.2f, \"host_naks\": %llu}\n",
+            result->firmware.double_buffered, direction, result->bytes,
+            (double) result->bytes / ((double) result->elapsed / SIM_CPU_HZ) / 1e6,
+            firmware_packets, packets_per_frame, firmware_max_per_frame,
+            (double) result->host_packets / (double) result->host_active_frames,
+            (unsigned long long) result->host_naks);
+
+    return packets_per_frame;
+}
+
+
+int main (void)
+{
+    uint8_t *const data = malloc (UART_BUFFER_ARENA_SIZE);
+    burst_result_t write_result;
+    burst_result_t read_result;
+    double write_packets_per_frame;
+    double read_packets_per_frame;
+
+    SIM_TEST_CHECK (data != NULL, "out of memory");
+    sim_test_boot (SIM_CC3100_SINK);
+    sim_test_set_control_line_state (0, USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER);
+    sim_test_set_line_coding (0, 921600, UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+
+    measure_write (&write_result, data);
+    measure_read (&read_result, data);
+    write_packets_per_frame = report_result ("write", &write_result, write_result.firmware.num_out_packets,
+                                             write_result.firmware.num_out_active_frames,
+                                             write_result.firmware.max_out_packets_per_frame);
+    read_packets_per_frame = report_result ("read", &read_result, read_result.firmware.num_in_packets,
+                                            read_result.firmware.num_in_active_frames,
+                                            read_result.firmware.max_in_packets_per_frame);
+
+    SIM_TEST_CHECK (write_result.firmware.double_buffered == USB_DOUBLE_BUFFER,
+                    "the endpoint statistics report double_buffered %u", write_result.firmware.double_buffered);
+    SIM_TEST_CHECK (write_result.firmware.num_out_packets == write_result.host_packets,
+                    "the firmware counted %u OUT packets, the host sent %llu", write_result.firmware.num_out_packets,
+                    (unsigned long long) write_result.host_packets);
+    /* The host also received the packets which filled the IN endpoint FIFO before the statistics were cleared */
+    SIM_TEST_CHECK ((read_result.firmware.num_in_packets + (USB_DOUBLE_BUFFER ? 2u : 1u)) == read_result.host_packets,
+                    "the firmware counted %u IN packets, the host received %llu", read_result.firmware.num_in_packets,
+                    (unsigned long long) read_result.host_packets);
+    if (USB_DOUBLE_BUFFER)
+    {
+        SIM_TEST_CHECK (write_packets_per_frame >= MIN_DOUBLE_BUFFERED_PACKETS_PER_FRAME,
+                        "write: %.2f packets per frame with double-buffered FIFOs", write_packets_per_frame);
+        SIM_TEST_CHECK (read_packets_per_frame >= MIN_DOUBLE_BUFFERED_PACKETS_PER_FRAME,
+                        "read: %.2f packets per frame with double-buffered FIFOs", read_packets_per_frame);
+    }
+    else
+    {
+        SIM_TEST_CHECK (write_packets_per_frame < MIN_DOUBLE_BUFFERED_PACKETS_PER_FRAME,
+                        "write: %.2f packets per frame with single-buffered FIFOs", write_packets_per_frame);
+        SIM_TEST_CHECK (read_packets_per_frame < MIN_DOUBLE_BUFFERED_PACKETS_PER_FRAME,
+                        "read: %.2f packets per frame with single-buffered FIFOs", read_packets_per_frame);
+    }
+
+    free (data);
+    printf ("PASS test_usb_double_buffer: %.3f s of virtual time\n", (double) sim_now / SIM_CPU_HZ);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+/*
+ * @file driverlib/cpu.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib CPU functions
+ */
+
+#ifndef CPU_H_
+#define CPU_H_
+
+#include <stdint.h>
+
+void CPUwfi (void);
+
+#endif /* CPU_H_ */
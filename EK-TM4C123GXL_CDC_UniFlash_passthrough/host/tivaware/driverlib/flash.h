@@ -0,0 +1,17 @@
+/*
+ * @file driverlib/flash.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib flash functions, which operate on the simulated flash
+ */
+
+#ifndef FLASH_H_
+#define FLASH_H_
+
+#include <stdint.h>
+
+int32_t FlashErase (uint32_t ui32Address);
+int32_t FlashProgram (uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+int32_t FlashUserGet (uint32_t *pui32User0, uint32_t *pui32User1);
+
+#endif /* FLASH_H_ */
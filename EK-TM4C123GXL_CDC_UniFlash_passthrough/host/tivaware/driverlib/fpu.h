@@ -0,0 +1,13 @@
+/*
+ * @file driverlib/fpu.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib FPU functions
+ */
+
+#ifndef FPU_H_
+#define FPU_H_
+
+void FPULazyStackingEnable (void);
+
+#endif /* FPU_H_ */
@@ -0,0 +1,58 @@
+/*
+ * @file driverlib/gpio.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib GPIO functions, implemented by the GPIO model
+ */
+
+#ifndef GPIO_H_
+#define GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PIN_0 0x00000001
+#define GPIO_PIN_1 0x00000002
+#define GPIO_PIN_2 0x00000004
+#define GPIO_PIN_3 0x00000008
+#define GPIO_PIN_4 0x00000010
+#define GPIO_PIN_5 0x00000020
+#define GPIO_PIN_6 0x00000040
+#define GPIO_PIN_7 0x00000080
+
+#define GPIO_INT_PIN_0 0x00000001
+#define GPIO_INT_PIN_1 0x00000002
+#define GPIO_INT_PIN_2 0x00000004
+#define GPIO_INT_PIN_3 0x00000008
+#define GPIO_INT_PIN_4 0x00000010
+#define GPIO_INT_PIN_5 0x00000020
+#define GPIO_INT_PIN_6 0x00000040
+#define GPIO_INT_PIN_7 0x00000080
+
+#define GPIO_FALLING_EDGE 0x00000000
+#define GPIO_RISING_EDGE  0x00000004
+#define GPIO_BOTH_EDGES   0x00000001
+
+#define GPIO_STRENGTH_2MA 0x00000001
+
+#define GPIO_PIN_TYPE_STD     0x00000008
+#define GPIO_PIN_TYPE_STD_WPU 0x0000000A
+#define GPIO_PIN_TYPE_OD      0x00000009
+
+void GPIOPinConfigure (uint32_t ui32PinConfig);
+void GPIOPinTypeGPIOInput (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOOutput (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOOutputOD (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeUART (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeSSI (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeUSBAnalog (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPadConfigSet (uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType);
+int32_t GPIOPinRead (uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinWrite (uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+void GPIOIntTypeSet (uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType);
+void GPIOIntEnable (uint32_t ui32Port, uint32_t ui32IntFlags);
+void GPIOIntDisable (uint32_t ui32Port, uint32_t ui32IntFlags);
+uint32_t GPIOIntStatus (uint32_t ui32Port, bool bMasked);
+void GPIOIntClear (uint32_t ui32Port, uint32_t ui32IntFlags);
+
+#endif /* GPIO_H_ */
@@ -0,0 +1,23 @@
+/*
+ * @file driverlib/interrupt.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib NVIC functions
+ */
+
+#ifndef INTERRUPT_H_
+#define INTERRUPT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+bool IntMasterEnable (void);
+bool IntMasterDisable (void);
+void IntEnable (uint32_t ui32Interrupt);
+void IntDisable (uint32_t ui32Interrupt);
+void IntPendSet (uint32_t ui32Interrupt);
+void IntPendClear (uint32_t ui32Interrupt);
+void IntPrioritySet (uint32_t ui32Interrupt, uint8_t ui8Priority);
+int32_t IntPriorityGet (uint32_t ui32Interrupt);
+
+#endif /* INTERRUPT_H_ */
@@ -0,0 +1,23 @@
+/*
+ * @file driverlib/pin_map.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123GH6PM pin multiplexing values
+ */
+
+#ifndef PIN_MAP_H_
+#define PIN_MAP_H_
+
+#define GPIO_PB0_U1RX    0x00010001
+#define GPIO_PB1_U1TX    0x00010401
+#define GPIO_PB4_SSI2CLK 0x00011002
+#define GPIO_PB6_SSI2RX  0x00011802
+#define GPIO_PB7_SSI2TX  0x00011C02
+#define GPIO_PC4_U1RTS   0x00021008
+#define GPIO_PC5_U1CTS   0x00021408
+#define GPIO_PC6_U3RX    0x00021801
+#define GPIO_PC7_U3TX    0x00021C01
+#define GPIO_PD6_U2RX    0x00031801
+#define GPIO_PD7_U2TX    0x00031C01
+
+#endif /* PIN_MAP_H_ */
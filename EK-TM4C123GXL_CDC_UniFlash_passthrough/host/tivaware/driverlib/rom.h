@@ -0,0 +1,11 @@
+/*
+ * @file driverlib/rom.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare ROM function table, which isn't used
+ */
+
+#ifndef ROM_H_
+#define ROM_H_
+
+#endif /* ROM_H_ */
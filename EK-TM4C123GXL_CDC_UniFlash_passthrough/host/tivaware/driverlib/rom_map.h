@@ -0,0 +1,13 @@
+/*
+ * @file driverlib/rom_map.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare ROM mapping, which maps onto the flash functions
+ */
+
+#ifndef ROM_MAP_H_
+#define ROM_MAP_H_
+
+#define MAP_SysCtlClockGet SysCtlClockGet
+
+#endif /* ROM_MAP_H_ */
@@ -0,0 +1,34 @@
+/*
+ * @file driverlib/ssi.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib SSI functions, implemented by the SSI model
+ */
+
+#ifndef SSI_H_
+#define SSI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SSI_FRF_MOTO_MODE_0 0x00000000
+#define SSI_MODE_MASTER     0x00000000
+
+#define SSI_DMA_TX 0x00000002
+#define SSI_DMA_RX 0x00000001
+
+#define SSI_TXFF 0x00000008
+#define SSI_RXFF 0x00000004
+#define SSI_RXTO 0x00000002
+#define SSI_RXOR 0x00000001
+
+void SSIConfigSetExpClk (uint32_t ui32Base, uint32_t ui32SSIClk, uint32_t ui32Protocol, uint32_t ui32Mode,
+                         uint32_t ui32BitRate, uint32_t ui32DataWidth);
+void SSIEnable (uint32_t ui32Base);
+void SSIDisable (uint32_t ui32Base);
+int32_t SSIDataGetNonBlocking (uint32_t ui32Base, uint32_t *pui32Data);
+void SSIDMAEnable (uint32_t ui32Base, uint32_t ui32DMAFlags);
+uint32_t SSIIntStatus (uint32_t ui32Base, bool bMasked);
+void SSIIntClear (uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif /* SSI_H_ */
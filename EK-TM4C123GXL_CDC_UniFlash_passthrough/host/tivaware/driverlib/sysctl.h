@@ -0,0 +1,51 @@
+/*
+ * @file driverlib/sysctl.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib system control functions
+ */
+
+#ifndef SYSCTL_H_
+#define SYSCTL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSCTL_PERIPH_GPIOB  0xf0000801
+#define SYSCTL_PERIPH_GPIOC  0xf0000802
+#define SYSCTL_PERIPH_GPIOD  0xf0000803
+#define SYSCTL_PERIPH_GPIOE  0xf0000804
+#define SYSCTL_PERIPH_GPIOF  0xf0000805
+#define SYSCTL_PERIPH_TIMER0 0xf0000400
+#define SYSCTL_PERIPH_TIMER1 0xf0000401
+#define SYSCTL_PERIPH_TIMER2 0xf0000402
+#define SYSCTL_PERIPH_TIMER3 0xf0000403
+#define SYSCTL_PERIPH_UDMA   0xf0000c00
+#define SYSCTL_PERIPH_UART1  0xf0001801
+#define SYSCTL_PERIPH_UART2  0xf0001802
+#define SYSCTL_PERIPH_UART3  0xf0001803
+#define SYSCTL_PERIPH_SSI2   0xf0001c02
+#define SYSCTL_PERIPH_USB0   0xf0002800
+#define SYSCTL_PERIPH_WTIMER0 0xf0005c00
+#define SYSCTL_PERIPH_WTIMER1 0xf0005c01
+
+#define SYSCTL_SYSDIV_2_5 0xC1000000
+#define SYSCTL_USE_PLL    0x00000000
+#define SYSCTL_XTAL_16MHZ 0x00000540
+#define SYSCTL_OSC_MAIN   0x00000000
+
+#define SYSCTL_DSLP_DIV_1    0x00000000
+#define SYSCTL_DSLP_OSC_MAIN 0x00000000
+
+void SysCtlClockSet (uint32_t ui32Config);
+uint32_t SysCtlClockGet (void);
+void SysCtlDelay (uint32_t ui32Count);
+void SysCtlPeripheralEnable (uint32_t ui32Peripheral);
+bool SysCtlPeripheralReady (uint32_t ui32Peripheral);
+void SysCtlPeripheralSleepEnable (uint32_t ui32Peripheral);
+void SysCtlPeripheralDeepSleepEnable (uint32_t ui32Peripheral);
+void SysCtlPeripheralClockGating (bool bEnable);
+void SysCtlDeepSleepClockSet (uint32_t ui32Config);
+void SysCtlDeepSleep (void);
+
+#endif /* SYSCTL_H_ */
@@ -0,0 +1,40 @@
+/*
+ * @file driverlib/timer.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib general purpose timer functions
+ */
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_A    0x000000ff
+#define TIMER_B    0x0000ff00
+#define TIMER_BOTH 0x0000ffff
+
+#define TIMER_CFG_ONE_SHOT      0x00000021
+#define TIMER_CFG_PERIODIC      0x00000022
+#define TIMER_CFG_PERIODIC_UP   0x00000032
+#define TIMER_CFG_SPLIT_PAIR    0x04000000
+#define TIMER_CFG_A_ONE_SHOT    0x00000021
+#define TIMER_CFG_B_ONE_SHOT    0x00002100
+
+#define TIMER_TIMA_TIMEOUT 0x00000001
+#define TIMER_TIMB_TIMEOUT 0x00000100
+
+void TimerConfigure (uint32_t ui32Base, uint32_t ui32Config);
+void TimerEnable (uint32_t ui32Base, uint32_t ui32Timer);
+void TimerDisable (uint32_t ui32Base, uint32_t ui32Timer);
+void TimerLoadSet (uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value);
+void TimerLoadSet64 (uint32_t ui32Base, uint64_t ui64Value);
+uint32_t TimerValueGet (uint32_t ui32Base, uint32_t ui32Timer);
+uint64_t TimerValueGet64 (uint32_t ui32Base);
+void TimerIntEnable (uint32_t ui32Base, uint32_t ui32IntFlags);
+void TimerIntDisable (uint32_t ui32Base, uint32_t ui32IntFlags);
+uint32_t TimerIntStatus (uint32_t ui32Base, bool bMasked);
+void TimerIntClear (uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif /* TIMER_H_ */
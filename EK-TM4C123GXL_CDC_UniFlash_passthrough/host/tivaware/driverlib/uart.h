@@ -0,0 +1,82 @@
+/*
+ * @file driverlib/uart.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib UART functions, implemented by the UART model
+ */
+
+#ifndef UART_H_
+#define UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_INT_OE 0x400
+#define UART_INT_BE 0x200
+#define UART_INT_PE 0x100
+#define UART_INT_FE 0x080
+#define UART_INT_RT 0x040
+#define UART_INT_TX 0x020
+#define UART_INT_RX 0x010
+
+#define UART_CONFIG_WLEN_MASK 0x00000060
+#define UART_CONFIG_WLEN_8    0x00000060
+#define UART_CONFIG_WLEN_7    0x00000040
+#define UART_CONFIG_WLEN_6    0x00000020
+#define UART_CONFIG_WLEN_5    0x00000000
+#define UART_CONFIG_STOP_MASK 0x00000008
+#define UART_CONFIG_STOP_ONE  0x00000000
+#define UART_CONFIG_STOP_TWO  0x00000008
+#define UART_CONFIG_PAR_MASK  0x00000086
+#define UART_CONFIG_PAR_NONE  0x00000000
+#define UART_CONFIG_PAR_EVEN  0x00000006
+#define UART_CONFIG_PAR_ODD   0x00000002
+#define UART_CONFIG_PAR_ONE   0x00000082
+#define UART_CONFIG_PAR_ZERO  0x00000086
+
+#define UART_FIFO_TX1_8 0x00000000
+#define UART_FIFO_TX2_8 0x00000001
+#define UART_FIFO_TX4_8 0x00000002
+#define UART_FIFO_TX6_8 0x00000003
+#define UART_FIFO_TX7_8 0x00000004
+#define UART_FIFO_RX1_8 0x00000000
+#define UART_FIFO_RX2_8 0x00000008
+#define UART_FIFO_RX4_8 0x00000010
+#define UART_FIFO_RX6_8 0x00000018
+#define UART_FIFO_RX7_8 0x00000020
+
+#define UART_TXINT_MODE_FIFO 0x00000000
+#define UART_TXINT_MODE_EOT  0x00000010
+
+#define UART_DMA_RX 0x00000001
+#define UART_DMA_TX 0x00000002
+
+#define UART_OUTPUT_RTS 0x00000800
+
+#define UART_FLOWCONTROL_TX   0x00008000
+#define UART_FLOWCONTROL_RX   0x00004000
+#define UART_FLOWCONTROL_NONE 0x00000000
+
+void UARTConfigSetExpClk (uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud, uint32_t ui32Config);
+void UARTConfigGetExpClk (uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t *pui32Baud, uint32_t *pui32Config);
+void UARTEnable (uint32_t ui32Base);
+void UARTDisable (uint32_t ui32Base);
+void UARTFIFOLevelSet (uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel);
+void UARTTxIntModeSet (uint32_t ui32Base, uint32_t ui32Mode);
+bool UARTCharsAvail (uint32_t ui32Base);
+bool UARTSpaceAvail (uint32_t ui32Base);
+int32_t UARTCharGetNonBlocking (uint32_t ui32Base);
+bool UARTCharPutNonBlocking (uint32_t ui32Base, unsigned char ucData);
+bool UARTBusy (uint32_t ui32Base);
+void UARTBreakCtl (uint32_t ui32Base, bool bBreakState);
+void UARTIntEnable (uint32_t ui32Base, uint32_t ui32IntFlags);
+void UARTIntDisable (uint32_t ui32Base, uint32_t ui32IntFlags);
+uint32_t UARTIntStatus (uint32_t ui32Base, bool bMasked);
+void UARTIntClear (uint32_t ui32Base, uint32_t ui32IntFlags);
+void UARTDMAEnable (uint32_t ui32Base, uint32_t ui32DMAFlags);
+void UARTDMADisable (uint32_t ui32Base, uint32_t ui32DMAFlags);
+void UARTModemControlSet (uint32_t ui32Base, uint32_t ui32Control);
+void UARTModemControlClear (uint32_t ui32Base, uint32_t ui32Control);
+void UARTFlowControlSet (uint32_t ui32Base, uint32_t ui32Mode);
+
+#endif /* UART_H_ */
@@ -0,0 +1,78 @@
+/*
+ * @file driverlib/udma.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib uDMA functions, implemented by the uDMA model
+ */
+
+#ifndef UDMA_H_
+#define UDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** A channel control structure, which is written by the uDMA as a transfer progresses */
+typedef struct
+{
+    volatile void *pvSrcEndAddr;
+    volatile void *pvDstEndAddr;
+    volatile uint32_t ui32Control;
+    volatile uint32_t ui32Spare;
+} tDMAControlTable;
+
+#define UDMA_ATTR_USEBURST      0x00000001
+#define UDMA_ATTR_ALTSELECT     0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY 0x00000004
+#define UDMA_ATTR_REQMASK       0x00000008
+
+#define UDMA_MODE_STOP     0x00000000
+#define UDMA_MODE_BASIC    0x00000001
+#define UDMA_MODE_AUTO     0x00000002
+#define UDMA_MODE_PINGPONG 0x00000003
+
+#define UDMA_DST_INC_8    0x00000000
+#define UDMA_DST_INC_16   0x40000000
+#define UDMA_DST_INC_32   0x80000000
+#define UDMA_DST_INC_NONE 0xc0000000
+#define UDMA_SRC_INC_8    0x00000000
+#define UDMA_SRC_INC_16   0x04000000
+#define UDMA_SRC_INC_32   0x08000000
+#define UDMA_SRC_INC_NONE 0x0c000000
+#define UDMA_SIZE_8       0x00000000
+
+#define UDMA_ARB_1 0x00000000
+#define UDMA_ARB_2 0x00004000
+#define UDMA_ARB_4 0x00008000
+#define UDMA_ARB_8 0x0000c000
+#define UDMA_ARB_16 0x00010000
+
+#define UDMA_PRI_SELECT 0x00000000
+#define UDMA_ALT_SELECT 0x00000020
+
+#define UDMA_CHANNEL_UART1RX 22
+#define UDMA_CHANNEL_UART1TX 23
+
+#define UDMA_CH0_UART2RX  0x00010000
+#define UDMA_CH1_UART2TX  0x00010001
+#define UDMA_CH12_SSI2RX  0x0002000C
+#define UDMA_CH13_SSI2TX  0x0002000D
+#define UDMA_CH16_UART3RX 0x00020010
+#define UDMA_CH17_UART3TX 0x00020011
+#define UDMA_CH22_UART1RX 0x00000016
+#define UDMA_CH23_UART1TX 0x00000017
+
+void uDMAEnable (void);
+void uDMAControlBaseSet (void *pControlTable);
+void uDMAChannelAssign (uint32_t ui32Mapping);
+void uDMAChannelAttributeEnable (uint32_t ui32ChannelNum, uint32_t ui32Attr);
+void uDMAChannelAttributeDisable (uint32_t ui32ChannelNum, uint32_t ui32Attr);
+void uDMAChannelControlSet (uint32_t ui32ChannelStructIndex, uint32_t ui32Control);
+void uDMAChannelTransferSet (uint32_t ui32ChannelStructIndex, uint32_t ui32Mode, void *pvSrcAddr, void *pvDstAddr,
+                             uint32_t ui32TransferSize);
+void uDMAChannelEnable (uint32_t ui32ChannelNum);
+void uDMAChannelDisable (uint32_t ui32ChannelNum);
+bool uDMAChannelIsEnabled (uint32_t ui32ChannelNum);
+uint32_t uDMAChannelModeGet (uint32_t ui32ChannelStructIndex);
+uint32_t uDMAChannelSizeGet (uint32_t ui32ChannelStructIndex);
+
+#endif /* UDMA_H_ */
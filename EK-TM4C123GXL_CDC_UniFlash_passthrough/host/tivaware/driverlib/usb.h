@@ -0,0 +1,52 @@
+/*
+ * @file driverlib/usb.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare driverlib USB controller functions, implemented by the USB model
+ */
+
+#ifndef USB_H_
+#define USB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define USB_EP_0  0x00000000
+#define USB_EP_1  0x00000010
+#define USB_EP_2  0x00000020
+#define USB_EP_3  0x00000030
+#define USB_EP_4  0x00000040
+#define USB_EP_5  0x00000050
+#define USB_EP_6  0x00000060
+#define USB_EP_7  0x00000070
+#define NUM_USB_EP 16
+
+#define IndexToUSBEP(x) ((x) << 4)
+#define USBEPToIndex(x) ((x) >> 4)
+
+#define USB_EP_DEV_IN  0x00002000
+#define USB_EP_DEV_OUT 0x00000000
+
+#define USB_FIFO_SZ_8     0x00000000
+#define USB_FIFO_SZ_16    0x00000001
+#define USB_FIFO_SZ_32    0x00000002
+#define USB_FIFO_SZ_64    0x00000003
+#define USB_FIFO_SZ_8_DB  0x00000010
+#define USB_FIFO_SZ_16_DB 0x00000011
+#define USB_FIFO_SZ_32_DB 0x00000012
+#define USB_FIFO_SZ_64_DB 0x00000013
+#define USB_FIFO_SIZE_DB_FLAG 0x00000010
+
+#define USBFIFOSizeToBytes(x) (8 << (x))
+
+void USBFIFOConfigSet (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t ui32FIFOAddress, uint32_t ui32FIFOSize,
+                       uint32_t ui32Flags);
+void USBFIFOConfigGet (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t *pui32FIFOAddress, uint32_t *pui32FIFOSize,
+                       uint32_t ui32Flags);
+void USBFIFOFlush (uint32_t ui32Base, uint32_t ui32Endpoint, uint32_t ui32Flags);
+uint32_t USBFrameNumberGet (uint32_t ui32Base);
+void USBDevConnect (uint32_t ui32Base);
+void USBDevDisconnect (uint32_t ui32Base);
+void USBDevEndpointDataAck (uint32_t ui32Base, uint32_t ui32Endpoint, bool bIsLastPacket);
+
+#endif /* USB_H_ */
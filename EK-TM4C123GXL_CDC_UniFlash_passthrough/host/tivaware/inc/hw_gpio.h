@@ -0,0 +1,15 @@
+/*
+ * @file inc/hw_gpio.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123 GPIO register offsets
+ */
+
+#ifndef HW_GPIO_H_
+#define HW_GPIO_H_
+
+#define GPIO_O_LOCK   0x00000520
+#define GPIO_O_CR     0x00000524
+#define GPIO_LOCK_KEY 0x4C4F434B
+
+#endif /* HW_GPIO_H_ */
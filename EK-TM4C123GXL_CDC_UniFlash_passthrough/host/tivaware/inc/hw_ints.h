@@ -0,0 +1,35 @@
+/*
+ * @file inc/hw_ints.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123 interrupt assignments
+ */
+
+#ifndef HW_INTS_H_
+#define HW_INTS_H_
+
+#define FAULT_PENDSV    14
+#define FAULT_SYSTICK   15
+
+#define INT_GPIOB       17
+#define INT_UART1       22
+#define INT_TIMER0A     35
+#define INT_TIMER0B     36
+#define INT_TIMER1A     37
+#define INT_TIMER1B     38
+#define INT_TIMER2A     39
+#define INT_TIMER2B     40
+#define INT_UART2       49
+#define INT_TIMER3A     51
+#define INT_TIMER3B     52
+#define INT_USB0        60
+#define INT_SSI2        73
+#define INT_UART3       75
+#define INT_WTIMER0A    110
+#define INT_WTIMER0B    111
+#define INT_WTIMER1A    112
+#define INT_WTIMER1B    113
+
+#define NUM_INTERRUPTS  155
+
+#endif /* HW_INTS_H_ */
@@ -0,0 +1,33 @@
+/*
+ * @file inc/hw_memmap.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123 peripheral base addresses
+ */
+
+#ifndef HW_MEMMAP_H_
+#define HW_MEMMAP_H_
+
+#define GPIO_PORTA_BASE 0x40004000
+#define GPIO_PORTB_BASE 0x40005000
+#define GPIO_PORTC_BASE 0x40006000
+#define GPIO_PORTD_BASE 0x40007000
+#define SSI0_BASE       0x40008000
+#define SSI1_BASE       0x40009000
+#define SSI2_BASE       0x4000A000
+#define SSI3_BASE       0x4000B000
+#define UART0_BASE      0x4000C000
+#define UART1_BASE      0x4000D000
+#define UART2_BASE      0x4000E000
+#define UART3_BASE      0x4000F000
+#define GPIO_PORTE_BASE 0x40024000
+#define GPIO_PORTF_BASE 0x40025000
+#define TIMER0_BASE     0x40030000
+#define TIMER1_BASE     0x40031000
+#define TIMER2_BASE     0x40032000
+#define TIMER3_BASE     0x40033000
+#define WTIMER0_BASE    0x40036000
+#define WTIMER1_BASE    0x40037000
+#define USB0_BASE       0x40050000
+
+#endif /* HW_MEMMAP_H_ */
@@ -0,0 +1,15 @@
+/*
+ * @file inc/hw_nvic.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the Cortex-M4 NVIC register definitions
+ */
+
+#ifndef HW_NVIC_H_
+#define HW_NVIC_H_
+
+#define NVIC_PEND0            0xE000E200
+#define NVIC_INT_CTRL         0xE000ED04
+#define NVIC_INT_CTRL_PEND_SV 0x10000000
+
+#endif /* HW_NVIC_H_ */
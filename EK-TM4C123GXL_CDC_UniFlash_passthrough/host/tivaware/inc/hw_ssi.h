@@ -0,0 +1,13 @@
+/*
+ * @file inc/hw_ssi.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123 SSI register definitions
+ */
+
+#ifndef HW_SSI_H_
+#define HW_SSI_H_
+
+#define SSI_O_DR 0x00000008
+
+#endif /* HW_SSI_H_ */
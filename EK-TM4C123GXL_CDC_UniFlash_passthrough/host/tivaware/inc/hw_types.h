@@ -0,0 +1,20 @@
+/*
+ * @file inc/hw_types.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare register access macros
+ * @details Register accesses are passed to the simulation, which returns the live value of the registers the
+ *          firmware reads directly (the DWT cycle counter and the NVIC pending bits) and stores any others.
+ */
+
+#ifndef HW_TYPES_H_
+#define HW_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+volatile uint32_t *sim_hwreg (uint32_t address);
+
+#define HWREG(x) (*sim_hwreg ((uint32_t) (x)))
+
+#endif /* HW_TYPES_H_ */
@@ -0,0 +1,19 @@
+/*
+ * @file inc/hw_uart.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TM4C123 UART register definitions
+ */
+
+#ifndef HW_UART_H_
+#define HW_UART_H_
+
+#define UART_O_DR     0x00000000
+
+#define UART_DR_OE     0x00000800
+#define UART_DR_BE     0x00000400
+#define UART_DR_PE     0x00000200
+#define UART_DR_FE     0x00000100
+#define UART_DR_DATA_M 0x000000FF
+
+#endif /* HW_UART_H_ */
@@ -0,0 +1,62 @@
+/*
+ * @file usblib/device/usbdbulk.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare usblib generic bulk device class
+ */
+
+#ifndef USBDBULK_H_
+#define USBDBULK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../usblib.h"
+#include "usbdevice.h"
+#include "usbdcomp.h"
+
+/** The size of the configuration descriptor of a bulk device in a composite device */
+#define COMPOSITE_DBULK_SIZE (9 + 7 + 7)
+
+typedef enum
+{
+    eBulkStateUnconfigured,
+    eBulkStateIdle,
+    eBulkStateWaitData,
+    eBulkStateWaitClient
+} tBulkState;
+
+typedef struct
+{
+    uint32_t ui32USBBase;
+    tDeviceInfo sDevInfo;
+    volatile tBulkState iBulkRxState;
+    volatile tBulkState iBulkTxState;
+    volatile bool bConnected;
+    uint8_t ui8INEndpoint;
+    uint8_t ui8OUTEndpoint;
+    uint8_t ui8Interface;
+} tBulkInstance;
+
+typedef struct
+{
+    const uint16_t ui16VID;
+    const uint16_t ui16PID;
+    const uint16_t ui16MaxPowermA;
+    const uint8_t ui8PwrAttributes;
+    const tUSBCallback pfnRxCallback;
+    void *pvRxCBData;
+    const tUSBCallback pfnTxCallback;
+    void *pvTxCBData;
+    const uint8_t * const *ppui8StringDescriptors;
+    const uint32_t ui32NumStringDescriptors;
+    tBulkInstance sPrivateData;
+} tUSBDBulkDevice;
+
+void *USBDBulkInit (uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice);
+void *USBDBulkCompositeInit (uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice, tCompositeEntry *psCompEntry);
+uint32_t USBDBulkPacketWrite (void *pvBulkDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast);
+uint32_t USBDBulkPacketRead (void *pvBulkDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast);
+uint32_t USBDBulkTxPacketAvailable (void *pvBulkDevice);
+uint32_t USBDBulkRxPacketAvailable (void *pvBulkDevice);
+
+#endif /* USBDBULK_H_ */
@@ -0,0 +1,84 @@
+/*
+ * @file usblib/device/usbdcdc.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare usblib CDC ACM device class
+ */
+
+#ifndef USBDCDC_H_
+#define USBDCDC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../usblib.h"
+#include "../usbcdc.h"
+#include "usbdevice.h"
+#include "usbdcomp.h"
+
+#define USBD_CDC_EVENT_BASE                   (USB_CLASS_EVENT_BASE + 0)
+#define USBD_CDC_EVENT_SEND_BREAK             (USBD_CDC_EVENT_BASE + 0)
+#define USBD_CDC_EVENT_CLEAR_BREAK            (USBD_CDC_EVENT_BASE + 1)
+#define USBD_CDC_EVENT_SET_CONTROL_LINE_STATE (USBD_CDC_EVENT_BASE + 2)
+#define USBD_CDC_EVENT_SET_LINE_CODING        (USBD_CDC_EVENT_BASE + 3)
+#define USBD_CDC_EVENT_GET_LINE_CODING        (USBD_CDC_EVENT_BASE + 4)
+
+/** The size of the configuration descriptor of a CDC device in a composite device, including the interface
+ *  association descriptor */
+#define COMPOSITE_DCDC_SIZE (8 + 9 + 5 + 4 + 5 + 5 + 7 + 9 + 7 + 7)
+
+typedef enum
+{
+    eCDCStateUnconfigured,
+    eCDCStateIdle,
+    eCDCStateWaitData,
+    eCDCStateWaitClient
+} tCDCState;
+
+typedef struct
+{
+    uint32_t ui32USBBase;
+    tDeviceInfo sDevInfo;
+    volatile tCDCState iCDCRxState;
+    volatile tCDCState iCDCTxState;
+    volatile tCDCState iCDCRequestState;
+    volatile tCDCState iCDCInterruptState;
+    volatile uint8_t ui8PendingRequest;
+    uint16_t ui16BreakDuration;
+    uint16_t ui16ControlLineState;
+    uint16_t ui16SerialState;
+    volatile uint16_t ui16DeferredOpFlags;
+    tLineCoding sLineCoding;
+    volatile bool bConnected;
+    uint8_t ui8ControlEndpoint;
+    uint8_t ui8BulkINEndpoint;
+    uint8_t ui8BulkOUTEndpoint;
+    uint8_t ui8InterfaceControl;
+    uint8_t ui8InterfaceData;
+} tCDCSerInstance;
+
+typedef struct
+{
+    const uint16_t ui16VID;
+    const uint16_t ui16PID;
+    const uint16_t ui16MaxPowermA;
+    const uint8_t ui8PwrAttributes;
+    const tUSBCallback pfnControlCallback;
+    void *pvControlCBData;
+    const tUSBCallback pfnRxCallback;
+    void *pvRxCBData;
+    const tUSBCallback pfnTxCallback;
+    void *pvTxCBData;
+    const uint8_t * const *ppui8StringDescriptors;
+    const uint32_t ui32NumStringDescriptors;
+    tCDCSerInstance sPrivateData;
+} tUSBDCDCDevice;
+
+void *USBDCDCInit (uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice);
+void *USBDCDCCompositeInit (uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice, tCompositeEntry *psCompEntry);
+uint32_t USBDCDCPacketWrite (void *pvCDCDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast);
+uint32_t USBDCDCPacketRead (void *pvCDCDevice, uint8_t *pi8Data, uint32_t ui32Length, bool bLast);
+uint32_t USBDCDCTxPacketAvailable (void *pvCDCDevice);
+uint32_t USBDCDCRxPacketAvailable (void *pvCDCDevice);
+void USBDCDCSerialStateChange (void *pvCDCDevice, uint16_t ui16State);
+
+#endif /* USBDCDC_H_ */
@@ -0,0 +1,55 @@
+/*
+ * @file usblib/device/usbdcomp.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare usblib composite device class
+ */
+
+#ifndef USBDCOMP_H_
+#define USBDCOMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../usblib.h"
+#include "usbdevice.h"
+
+/** One device class of a composite device */
+typedef struct
+{
+    const tDeviceInfo *psDevInfo;
+    void *pvInstance;
+    uint32_t ui32DeviceWorkspace;
+} tCompositeEntry;
+
+typedef struct
+{
+    uint32_t ui32USBBase;
+    tDeviceInfo sDevInfo;
+    tConfigDescriptor sConfigDescriptor;
+    tConfigSection sConfigSections[2];
+    const tConfigSection *ppsConfigSections[2];
+    tConfigHeader sConfigHeader;
+    const tConfigHeader *ppsConfigHeaders[1];
+    uint8_t *pui8Data;
+    uint32_t ui32DataSize;
+    uint32_t ui32EP0Owner;
+} tCompositeInstance;
+
+typedef struct
+{
+    const uint16_t ui16VID;
+    const uint16_t ui16PID;
+    const uint16_t ui16MaxPowermA;
+    const uint8_t ui8PwrAttributes;
+    const tUSBCallback pfnCallback;
+    const uint8_t * const *ppui8StringDescriptors;
+    const uint32_t ui32NumStringDescriptors;
+    const uint32_t ui32NumDevices;
+    tCompositeEntry * const psDevices;
+    tCompositeInstance sPrivateData;
+} tUSBDCompositeDevice;
+
+void *USBDCompositeInit (uint32_t ui32Index, tUSBDCompositeDevice *psCompDevice, uint32_t ui32Size,
+                         uint8_t *pui8Data);
+
+#endif /* USBDCOMP_H_ */
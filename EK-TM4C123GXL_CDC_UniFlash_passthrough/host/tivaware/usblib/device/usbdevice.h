@@ -0,0 +1,58 @@
+/*
+ * @file usblib/device/usbdevice.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare usblib device core
+ */
+
+#ifndef USBDEVICE_H_
+#define USBDEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../usblib.h"
+
+typedef void (* tStdRequest) (void *pvInstance, tUSBRequest *pUSBRequest);
+typedef void (* tInfoCallback) (void *pvInstance, uint32_t ui32Info);
+typedef void (* tInterfaceCallback) (void *pvInstance, uint8_t ui8InterfaceNum, uint8_t ui8AlternateSetting);
+typedef void (* tUSBIntHandler) (void *pvInstance);
+typedef void (* tUSBEPIntHandler) (void *pvInstance, uint32_t ui32Status);
+typedef void (* tUSBDeviceHandler) (void *pvInstance, uint32_t ui32Request, void *pvRequestData);
+
+/** The handlers by which the device core passes requests and events to a device class */
+typedef struct
+{
+    tStdRequest pfnGetDescriptor;
+    tStdRequest pfnRequestHandler;
+    tInterfaceCallback pfnInterfaceChange;
+    tInfoCallback pfnConfigChange;
+    tInfoCallback pfnDataReceived;
+    tInfoCallback pfnDataSent;
+    tUSBIntHandler pfnResetHandler;
+    tUSBIntHandler pfnSuspendHandler;
+    tUSBIntHandler pfnResumeHandler;
+    tUSBIntHandler pfnDisconnectHandler;
+    tUSBEPIntHandler pfnEndpointHandler;
+    tUSBDeviceHandler pfnDeviceHandler;
+} tCustomHandlers;
+
+typedef struct
+{
+    tCustomHandlers sCallbacks;
+    const uint8_t *pui8DeviceDescriptor;
+    const tConfigHeader * const *ppsConfigDescriptors;
+    const uint8_t * const *ppui8StringDescriptors;
+    uint32_t ui32NumStringDescriptors;
+} tDeviceInfo;
+
+/* The endpoint interrupt status passed to pfnEndpointHandler, with a bit per IN endpoint in the lower half and a
+   bit per OUT endpoint in the upper half */
+#define USB_INTEP_DEV_IN(ep_index)  (1u << (ep_index))
+#define USB_INTEP_DEV_OUT(ep_index) (0x10000u << (ep_index))
+
+void USBDCDInit (uint32_t ui32Index, tDeviceInfo *psDevice, void *pvDCDCBData);
+void USBDCDStallEP0 (uint32_t ui32Index);
+void USBDCDSendDataEP0 (uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size);
+void USBDCDRequestDataEP0 (uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size);
+
+#endif /* USBDEVICE_H_ */
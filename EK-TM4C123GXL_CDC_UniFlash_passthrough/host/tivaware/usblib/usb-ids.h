@@ -0,0 +1,16 @@
+/*
+ * @file usblib/usb-ids.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare USB vendor and product IDs
+ */
+
+#ifndef USB_IDS_H_
+#define USB_IDS_H_
+
+#define USB_VID_TI_1CBE       0x1cbe
+#define USB_PID_SERIAL        0x0002
+#define USB_PID_BULK          0x0003
+#define USB_PID_COMP_SERIAL   0x0007
+
+#endif /* USB_IDS_H_ */
@@ -0,0 +1,52 @@
+/*
+ * @file usblib/usbcdc.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare USB CDC class definitions
+ */
+
+#ifndef USBCDC_H_
+#define USBCDC_H_
+
+#include <stdint.h>
+#include "usblib.h"
+
+/* CDC class requests */
+#define USB_CDC_SET_LINE_CODING         0x20
+#define USB_CDC_GET_LINE_CODING         0x21
+#define USB_CDC_SET_CONTROL_LINE_STATE  0x22
+#define USB_CDC_SEND_BREAK              0x23
+
+/* CDC notification sent on the interrupt endpoint */
+#define USB_CDC_NOTIFY_SERIAL_STATE 0x20
+
+#define USB_CDC_SERIAL_STATE_OVERRUN   0x0040
+#define USB_CDC_SERIAL_STATE_PARITY    0x0020
+#define USB_CDC_SERIAL_STATE_FRAMING   0x0010
+#define USB_CDC_SERIAL_STATE_RING_SIGNAL 0x0008
+#define USB_CDC_SERIAL_STATE_BREAK     0x0004
+#define USB_CDC_SERIAL_STATE_TXCARRIER 0x0002
+#define USB_CDC_SERIAL_STATE_RXCARRIER 0x0001
+
+#define USB_CDC_DTE_PRESENT      0x01
+#define USB_CDC_ACTIVATE_CARRIER 0x02
+
+#define USB_CDC_STOP_BITS_1   0x00
+#define USB_CDC_STOP_BITS_1_5 0x01
+#define USB_CDC_STOP_BITS_2   0x02
+
+#define USB_CDC_PARITY_NONE  0x00
+#define USB_CDC_PARITY_ODD   0x01
+#define USB_CDC_PARITY_EVEN  0x02
+#define USB_CDC_PARITY_MARK  0x03
+#define USB_CDC_PARITY_SPACE 0x04
+
+typedef struct
+{
+    uint32_t ui32Rate;
+    uint8_t ui8Stop;
+    uint8_t ui8Parity;
+    uint8_t ui8Databits;
+} PACKED tLineCoding;
+
+#endif /* USBCDC_H_ */
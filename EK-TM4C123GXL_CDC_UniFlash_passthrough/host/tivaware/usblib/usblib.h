@@ -0,0 +1,171 @@
+/*
+ * @file usblib/usblib.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Host simulation stand-in for the TivaWare usblib common definitions
+ * @details The types and event values match usblib, so that the firmware callbacks and the structures it declares
+ *          compile unchanged. The device stack behind them is the simulation's own, in sim_usblib.c.
+ */
+
+#ifndef USBLIB_H_
+#define USBLIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PACKED __attribute__ ((packed))
+
+#define USBShort(ui16Value) ((ui16Value) & 0xff), ((ui16Value) >> 8)
+
+#define USB_LANG_EN_US 0x0409
+#define USB_LANG_EN_UK 0x0809
+
+#define USB_DTYPE_DEVICE        1
+#define USB_DTYPE_CONFIGURATION 2
+#define USB_DTYPE_STRING        3
+#define USB_DTYPE_INTERFACE     4
+#define USB_DTYPE_ENDPOINT      5
+#define USB_DTYPE_INTERFACE_ASC 11
+#define USB_DTYPE_CS_INTERFACE  0x24
+
+#define USB_CLASS_CDC           0x02
+#define USB_CLASS_CDC_DATA      0x0a
+#define USB_CLASS_VEND_SPECIFIC 0xff
+
+#define USB_CONF_ATTR_SELF_PWR 0xC0
+#define USB_CONF_ATTR_BUS_PWR  0x80
+
+#define USB_RTYPE_DIR_IN      0x80
+#define USB_RTYPE_DIR_OUT     0x00
+#define USB_RTYPE_TYPE_M      0x60
+#define USB_RTYPE_VENDOR      0x40
+#define USB_RTYPE_CLASS       0x20
+#define USB_RTYPE_STANDARD    0x00
+#define USB_RTYPE_RECIPIENT_M 0x1f
+#define USB_RTYPE_DEVICE      0x00
+#define USB_RTYPE_INTERFACE   0x01
+#define USB_RTYPE_ENDPOINT    0x02
+
+#define USBREQ_SET_ADDRESS       0x05
+#define USBREQ_GET_DESCRIPTOR    0x06
+#define USBREQ_SET_CONFIG        0x09
+
+#define USB_EP_DESC_IN    0x80
+#define USB_EP_ATTR_BULK  0x02
+#define USB_EP_ATTR_INT   0x03
+
+/* The events passed to the device class callbacks */
+#define USB_EVENT_BASE          0x0000
+#define USB_CLASS_EVENT_BASE    0x8000
+#define USB_EVENT_CONNECTED     (USB_EVENT_BASE + 0)
+#define USB_EVENT_DISCONNECTED  (USB_EVENT_BASE + 1)
+#define USB_EVENT_RX_AVAILABLE  (USB_EVENT_BASE + 2)
+#define USB_EVENT_DATA_REMAINING (USB_EVENT_BASE + 3)
+#define USB_EVENT_REQUEST_BUFFER (USB_EVENT_BASE + 4)
+#define USB_EVENT_TX_COMPLETE   (USB_EVENT_BASE + 5)
+#define USB_EVENT_ERROR         (USB_EVENT_BASE + 6)
+#define USB_EVENT_SUSPEND       (USB_EVENT_BASE + 7)
+#define USB_EVENT_RESUME        (USB_EVENT_BASE + 8)
+#define USB_EVENT_COMP_IFACE_CHANGE (USB_EVENT_BASE + 17)
+#define USB_EVENT_COMP_EP_CHANGE    (USB_EVENT_BASE + 18)
+
+typedef struct
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+} PACKED tDescriptorHeader;
+
+typedef struct
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t bDeviceClass;
+    uint8_t bDeviceSubClass;
+    uint8_t bDeviceProtocol;
+    uint8_t bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t iManufacturer;
+    uint8_t iProduct;
+    uint8_t iSerialNumber;
+    uint8_t bNumConfigurations;
+} PACKED tDeviceDescriptor;
+
+typedef struct
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t bNumInterfaces;
+    uint8_t bConfigurationValue;
+    uint8_t iConfiguration;
+    uint8_t bmAttributes;
+    uint8_t bMaxPower;
+} PACKED tConfigDescriptor;
+
+typedef struct
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} PACKED tInterfaceDescriptor;
+
+typedef struct
+{
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bEndpointAddress;
+    uint8_t bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t bInterval;
+} PACKED tEndpointDescriptor;
+
+typedef struct
+{
+    uint8_t bmRequestType;
+    uint8_t bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} PACKED tUSBRequest;
+
+/** One contiguous section of a configuration descriptor */
+typedef struct
+{
+    uint16_t ui16Size;
+    const uint8_t *pui8Data;
+} tConfigSection;
+
+/** A configuration descriptor assembled from sections, the first of which is the configuration header */
+typedef struct
+{
+    uint8_t ui8NumSections;
+    const tConfigSection * const *psSections;
+} tConfigHeader;
+
+typedef uint32_t (* tUSBCallback) (void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgParam, void *pvMsgData);
+
+typedef enum
+{
+    eUSBModeHost,
+    eUSBModeDevice,
+    eUSBModeOTG,
+    eUSBModeNone,
+    eUSBModeForceHost,
+    eUSBModeForceDevice
+} tUSBMode;
+
+typedef void (* tUSBModeCallback) (uint32_t ui32Index, tUSBMode iMode);
+
+void USBStackModeSet (uint32_t ui32Index, tUSBMode iUSBMode, tUSBModeCallback pfnCallback);
+void USB0DeviceIntHandler (void);
+
+#endif /* USBLIB_H_ */
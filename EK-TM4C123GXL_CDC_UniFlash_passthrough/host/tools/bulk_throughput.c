@@ -0,0 +1,398 @@
+/*
+ * @file bulk_throughput.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Measure the throughput of the raw vendor bulk UART interface of the bridge, using libusb
+ * @details The bridge must have been started with the raw bulk interface selected, by holding SW1 at reset.
+ *          Sets the line coding with the vendor requests which replace the CDC class requests, then streams a
+ *          pattern to the bulk OUT endpoint and reads it back from the bulk IN endpoint, which requires the far
+ *          end to echo, e.g. with the TX and RX signals to the CC3100BOOST looped back.
+ *
+ *          A queue of asynchronous transfers is kept submitted in each direction, so that the host always has
+ *          a transfer waiting for the next packet without the tty layer in the path. The depth of the queues and
+ *          the length of each transfer are options, to find the depth needed to sustain the line rate.
+ *
+ *          The result is written as one JSON object on a line, with the throughput as a percentage of the line
+ *          rate for 10 bits per character.
+ *
+ *          Usage: bulk_throughput [-b <baud>] [-n <bytes>] [-q <queue depth>] [-s <transfer length>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libusb.h>
+
+/* Copied from usblib/usb-ids.h and vendor_requests.h, which can't be included as they depend upon usblib */
+#define USB_VID_TI_1CBE 0x1cbe
+#define USB_PID_BULK    0x0003
+#define VENDOR_REQUEST_SET_LINE_CODING        0x07
+#define VENDOR_REQUEST_SET_CONTROL_LINE_STATE 0x09
+
+/* The CDC control line state bits, from usbcdc.h */
+#define USB_CDC_DTE_PRESENT      0x01
+#define USB_CDC_ACTIVATE_CARRIER 0x02
+
+/** The timeout for the vendor requests */
+#define CONTROL_TIMEOUT_MS 1000
+
+/** The time without any data transferred before the stream is abandoned */
+#define STALL_TIMEOUT_S 2.0
+
+/** The maximum number of transfers queued in each direction */
+#define MAX_QUEUE_DEPTH 64
+
+/** The command line options */
+static uint32_t baud = 921600;
+static uint32_t num_bytes = 1024u * 1024u;
+static uint32_t queue_depth = 8;
+static uint32_t transfer_length = 4096;
+
+/** The state of the stream, updated by the transfer callbacks */
+typedef struct
+{
+    /** The bytes handed to OUT transfers */
+    uint32_t out_queued;
+    /** The bytes sent by completed OUT transfers */
+    uint32_t out_sent;
+    /** The bytes received by completed IN transfers */
+    uint32_t in_received;
+    /** The received bytes which didn't match the pattern sent */
+    uint32_t num_mismatches;
+    /** The number of transfers submitted and not yet completed */
+    uint32_t num_active;
+    /** The number of IN transfers submitted and not yet completed */
+    uint32_t num_in_active;
+    /** Set when a transfer fails, or the stream is abandoned, to stop resubmitting transfers */
+    bool stopping;
+    /** Set when a transfer failed */
+    bool failed;
+} stream_t;
+
+static stream_t stream;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s [-b <baud>] [-n <bytes>] [-q <queue depth>] [-s <transfer length>]\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "b:n:q:s:")) != -1)
+    {
+        switch (option)
+        {
+        case 'b':
+            baud = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'n':
+            num_bytes = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'q':
+            queue_depth = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 's':
+            transfer_length = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    if ((optind != argc) || (baud == 0) || (num_bytes == 0) || (queue_depth == 0) ||
+        (queue_depth > MAX_QUEUE_DEPTH) || (transfer_length == 0) || ((transfer_length % 64) != 0))
+    {
+        usage (argv[0]);
+    }
+}
+
+
+static double now_s (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+/**
+ * @return Returns the byte of the pattern at an offset in the stream
+ */
+static uint8_t pattern_byte (const uint32_t offset)
+{
+    return (uint8_t) (offset + (offset >> 8));
+}
+
+
+static void exit_on_error (const int status, const char *const operation)
+{
+    if (status < 0)
+    {
+        fprintf (stderr, "%s failed: %s\n", operation, libusb_error_name (status));
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/**
+ * @brief Fill an OUT transfer with the next part of the pattern and submit it, unless all bytes have been queued
+ */
+static void submit_out (struct libusb_transfer *const transfer)
+{
+    const uint32_t remaining = num_bytes - stream.out_queued;
+    const uint32_t length = (remaining < transfer_length) ? remaining : transfer_length;
+
+    if (stream.stopping || (length == 0))
+    {
+        return;
+    }
+    for (uint32_t index = 0; index < length; index++)
+    {
+        transfer->buffer[index] = pattern_byte (stream.out_queued + index);
+    }
+    transfer->length = (int) length;
+    exit_on_error (libusb_submit_transfer (transfer), "Submit OUT transfer");
+    stream.out_queued += length;
+    stream.num_active++;
+}
+
+
+/**
+ * @brief Submit an IN transfer, unless the transfers already active will receive all the bytes
+ */
+static void submit_in (struct libusb_transfer *const transfer)
+{
+    if (stream.stopping || ((stream.in_received + (stream.num_in_active * transfer_length)) >= num_bytes))
+    {
+        return;
+    }
+    transfer->length = (int) transfer_length;
+    exit_on_error (libusb_submit_transfer (transfer), "Submit IN transfer");
+    stream.num_active++;
+    stream.num_in_active++;
+}
+
+
+static void check_status (const struct libusb_transfer *const transfer, const char *const direction)
+{
+    if ((transfer->status != LIBUSB_TRANSFER_COMPLETED) && (transfer->status != LIBUSB_TRANSFER_CANCELLED))
+    {
+        fprintf (stderr, "%s transfer failed with status %d\n", direction, (int) transfer->status);
+        stream.failed = true;
+        stream.stopping = true;
+    }
+}
+
+
+static void LIBUSB_CALL out_complete (struct libusb_transfer *const transfer)
+{
+    stream.num_active--;
+    check_status (transfer, "OUT");
+    stream.out_sent += (uint32_t) transfer->actual_length;
+    submit_out (transfer);
+}
+
+
+static void LIBUSB_CALL in_complete (struct libusb_transfer *const transfer)
+{
+    stream.num_active--;
+    stream.num_in_active--;
+    check_status (transfer, "IN");
+    for (int index = 0; index < transfer->actual_length; index++)
+    {
+        if (transfer->buffer[index] != pattern_byte (stream.in_received + (uint32_t) index))
+        {
+            stream.num_mismatches++;
+        }
+    }
+    stream.in_received += (uint32_t) transfer->actual_length;
+    submit_in (transfer);
+}
+
+
+/**
+ * @brief Open the bridge, which must be presenting the raw bulk interface, and find its bulk endpoints
+ */
+static libusb_device_handle *open_bridge (uint8_t *const out_endpoint, uint8_t *const in_endpoint)
+{
+    libusb_device_handle *const handle = libusb_open_device_with_vid_pid (NULL, USB_VID_TI_1CBE, USB_PID_BULK);
+    struct libusb_config_descriptor *config;
+    const struct libusb_interface_descriptor *interface;
+
+    if (handle == NULL)
+    {
+        fprintf (stderr, "No bridge with the raw bulk interface found\n");
+        exit (EXIT_FAILURE);
+    }
+    exit_on_error (libusb_get_active_config_descriptor (libusb_get_device (handle), &config),
+                   "Get configuration descriptor");
+    interface = &config->interface[0].altsetting[0];
+    *out_endpoint = 0;
+    *in_endpoint = 0;
+    for (uint8_t index = 0; index < interface->bNumEndpoints; index++)
+    {
+        const struct libusb_endpoint_descriptor *const endpoint = &interface->endpoint[index];
+
+        if ((endpoint->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_BULK)
+        {
+            if (endpoint->bEndpointAddress & LIBUSB_ENDPOINT_IN)
+            {
+                *in_endpoint = endpoint->bEndpointAddress;
+            }
+            else
+            {
+                *out_endpoint = endpoint->bEndpointAddress;
+            }
+        }
+    }
+    libusb_free_config_descriptor (config);
+    if ((*out_endpoint == 0) || (*in_endpoint == 0))
+    {
+        fprintf (stderr, "The bridge doesn't have the bulk endpoints of the raw bulk interface\n");
+        exit (EXIT_FAILURE);
+    }
+    exit_on_error (libusb_claim_interface (handle, 0), "Claim interface");
+
+    return handle;
+}
+
+
+/**
+ * @brief Set 8 data bits, no parity and one stop bit at the baud rate, and set DTR and RTS
+ */
+static void set_line_coding (libusb_device_handle *const handle)
+{
+    /* A tLineCoding in the CDC format, which is packed little-endian */
+    uint8_t line_coding[7] =
+    {
+        (uint8_t) baud, (uint8_t) (baud >> 8), (uint8_t) (baud >> 16), (uint8_t) (baud >> 24),
+        0, /* One stop bit */
+        0, /* No parity */
+        8  /* Data bits */
+    };
+    const uint8_t request_type = LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE;
+
+    exit_on_error (libusb_control_transfer (handle, request_type, VENDOR_REQUEST_SET_LINE_CODING, 0, 0,
+                                            line_coding, sizeof (line_coding), CONTROL_TIMEOUT_MS),
+                   "SET_LINE_CODING");
+    exit_on_error (libusb_control_transfer (handle, request_type, VENDOR_REQUEST_SET_CONTROL_LINE_STATE,
+                                            USB_CDC_DTE_PRESENT | USB_CDC_ACTIVATE_CARRIER, 0, NULL, 0,
+                                            CONTROL_TIMEOUT_MS),
+                   "SET_CONTROL_LINE_STATE");
+}
+
+
+int main (int argc, char *argv[])
+{
+    struct libusb_transfer *out_transfers[MAX_QUEUE_DEPTH];
+    struct libusb_transfer *in_transfers[MAX_QUEUE_DEPTH];
+    libusb_device_handle *handle;
+    uint8_t out_endpoint;
+    uint8_t in_endpoint;
+    uint32_t last_progress;
+    double last_progress_at;
+    double start;
+    double seconds;
+
+    parse_command_line (argc, argv);
+    exit_on_error (libusb_init (NULL), "libusb_init");
+    handle = open_bridge (&out_endpoint, &in_endpoint);
+    set_line_coding (handle);
+
+    for (uint32_t index = 0; index < queue_depth; index++)
+    {
+        uint8_t *const out_buffer = malloc (transfer_length);
+        uint8_t *const in_buffer = malloc (transfer_length);
+
+        out_transfers[index] = libusb_alloc_transfer (0);
+        in_transfers[index] = libusb_alloc_transfer (0);
+        if ((out_buffer == NULL) || (in_buffer == NULL) || (out_transfers[index] == NULL) ||
+            (in_transfers[index] == NULL))
+        {
+            fprintf (stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        libusb_fill_bulk_transfer (out_transfers[index], handle, out_endpoint, out_buffer, (int) transfer_length,
+                                   out_complete, NULL, 0);
+        libusb_fill_bulk_transfer (in_transfers[index], handle, in_endpoint, in_buffer, (int) transfer_length,
+                                   in_complete, NULL, 0);
+    }
+
+    /* Queue the reads before the writes, so the echoed data is never left waiting for an IN transfer */
+    start = now_s ();
+    for (uint32_t index = 0; index < queue_depth; index++)
+    {
+        submit_in (in_transfers[index]);
+    }
+    for (uint32_t index = 0; index < queue_depth; index++)
+    {
+        submit_out (out_transfers[index]);
+    }
+
+    last_progress = 0;
+    last_progress_at = start;
+    while (!stream.stopping && (stream.in_received < num_bytes))
+    {
+        struct timeval timeout = {.tv_sec = 0, .tv_usec = 100000};
+
+        exit_on_error (libusb_handle_events_timeout (NULL, &timeout), "Handle events");
+        if ((stream.out_sent + stream.in_received) != last_progress)
+        {
+            last_progress = stream.out_sent + stream.in_received;
+            last_progress_at = now_s ();
+        }
+        else if ((now_s () - last_progress_at) > STALL_TIMEOUT_S)
+        {
+            fprintf (stderr, "No progress after %u bytes sent and %u received\n", stream.out_sent,
+                     stream.in_received);
+            stream.stopping = true;
+            stream.failed = true;
+        }
+    }
+    seconds = now_s () - start;
+
+    /* Cancel the transfers still queued, and wait for their callbacks before freeing them */
+    stream.stopping = true;
+    for (uint32_t index = 0; index < queue_depth; index++)
+    {
+        (void) libusb_cancel_transfer (out_transfers[index]);
+        (void) libusb_cancel_transfer (in_transfers[index]);
+    }
+    while (stream.num_active > 0)
+    {
+        exit_on_error (libusb_handle_events (NULL), "Handle events");
+    }
+    for (uint32_t index = 0; index < queue_depth; index++)
+    {
+        free (out_transfers[index]->buffer);
+        free (in_transfers[index]->buffer);
+        libusb_free_transfer (out_transfers[index]);
+        libusb_free_transfer (in_transfers[index]);
+    }
+    libusb_release_interface (handle, 0);
+    libusb_close (handle);
+    libusb_exit (NULL);
+
+    printf ("{\"interface\": \"raw_bulk\", \"baud\": %u, \"queue_depth\": %u, \"transfer_length\": %u, "
+            "\"bytes_sent\": %u, \"bytes_received\": %u, \"mismatches\": %u, \"seconds\": %.3f, "
+            "\"kb_per_s\": %.1f, \"line_rate_percent\": %.1f}\n",
+            baud, queue_depth, transfer_length, stream.out_sent, stream.in_received, stream.num_mismatches,
+            seconds, stream.in_received / seconds / 1e3, (100.0 * stream.in_received * 10.0) / (seconds * baud));
+
+    return (!stream.failed && (stream.num_mismatches == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,747 @@
+/*
+ * @file cc3100_flash.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Program the CC3100 through the CDC port of the bridge on Linux, with pipelined bootloader commands
+ * @details The commands are read from an image in the format of cc3100_programmer.h, as composed for the standalone
+ *          programmer, so the same image may be either written to the bridge or sent by this client.
+ *
+ *          The bootloader is entered with TIOCSBRK, which the cdc-acm driver sends to the bridge as SEND_BREAK. The
+ *          bridge then pulses nHIB while sending the break, as implemented by cdc_control_handler, and the break is
+ *          cleared with TIOCCBRK once the bootloader has acknowledged it.
+ *
+ *          Rather than waiting for the acknowledgement of each command before sending the next, as UniFlash does, up
+ *          to <window> commands are queued ahead and written to the tty as one burst. The bridge and CC3100 flow
+ *          control holds the queued commands until the bootloader is ready for them, so the USB round trip is only
+ *          paid once per window rather than once per command. A command whose response is a packet ends the burst,
+ *          since the bootloader requires the packet to be acknowledged before the next command is sent.
+ *
+ *          With -p the tty is a pty from cc3100_pty_sim, which can't send a break, so a NUL character is sent in
+ *          place of the break.
+ *
+ *          The result is written as one JSON object on a line. The exit status is EXIT_SUCCESS only if every command
+ *          completed with the expected response.
+ *
+ *          When -d is omitted the tty is found under /sys/class/tty, as the ttyACM device whose USB device has the
+ *          VID and PID of the CDC device of the bridge. Where the bridge presents several CDC ports, the port with the
+ *          lowest interface number is the one connected to the CC3100.
+ *
+ *          Usage: cc3100_flash [-d <tty>] -i <image> [-w <window>] [-e <entry timeout ms>] [-p]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/ioctl.h>
+
+#include "cc3100_programmer.h"
+
+/* Copied from usblib/usb-ids.h, which can't be included as it depends upon usblib. The VID and PID of CDC_device. */
+#define USB_VID_TI_1CBE 0x1cbe
+#define USB_PID_SERIAL  0x0002
+
+/** Where the ttys are found when not given on the command line */
+#define SYSFS_TTY_CLASS "/sys/class/tty"
+
+/** The acknowledgement sent by the CC3100 bootloader, and sent to it for a response packet */
+#define BOOTLOADER_ACK_0 0x00
+#define BOOTLOADER_ACK_1 0xCC
+
+/** The largest command which fits in the 16-bit length of a bootloader packet, which includes the length */
+#define MAX_COMMAND_LENGTH (0xFFFF - 2)
+
+/** The time allowed to write the final acknowledgement once all commands have completed */
+#define FINAL_WRITE_TIMEOUT_MS 1000
+
+/** The command line options */
+static const char *tty_path;
+static const char *image_path;
+
+/** The path of the tty found under SYSFS_TTY_CLASS, when not given on the command line */
+static char found_tty_path[PATH_MAX];
+static uint32_t window = 8;
+static uint32_t entry_timeout_ms = 2000;
+static bool pty_mode;
+
+/** The records of the image */
+static uint8_t *image;
+static const cc3100_programmer_record_t **records;
+static uint32_t num_records;
+static size_t command_bytes;
+
+/** The bytes queued to be written to the tty, which is sized to hold every packet and acknowledgement of the run
+ *  so is only appended to */
+static uint8_t *tx_buffer;
+static size_t tx_length;
+static size_t tx_written;
+
+/** Names of the cc3100_programmer_error_t values for the result */
+static const char *const error_names[] =
+{
+    [CC3100_PROGRAMMER_ERROR_NONE] = "none",
+    [CC3100_PROGRAMMER_ERROR_INVALID_IMAGE] = "invalid_image",
+    [CC3100_PROGRAMMER_ERROR_BRIDGE_BUSY] = "bridge_busy",
+    [CC3100_PROGRAMMER_ERROR_NO_BOOTLOADER] = "no_bootloader",
+    [CC3100_PROGRAMMER_ERROR_NO_ACK] = "no_ack",
+    [CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT] = "response_timeout",
+    [CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID] = "response_invalid",
+    [CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH] = "response_mismatch",
+    [CC3100_PROGRAMMER_ERROR_LINE_ERROR] = "line_error"
+};
+
+/** The phases of receiving the response to a command */
+typedef enum
+{
+    /** Waiting for the acknowledgement, skipping any other characters which precede it */
+    PHASE_ACK,
+    /** Receiving a response which isn't framed as a packet */
+    PHASE_RAW,
+    /** Receiving the length and checksum of a response packet */
+    PHASE_PACKET_HEADER,
+    /** Receiving the data of a response packet */
+    PHASE_PACKET_DATA
+} response_phase_t;
+
+/** The state of receiving the response to the oldest command which hasn't completed */
+typedef struct
+{
+    const cc3100_programmer_record_t *record;
+    const uint8_t *expected;
+    response_phase_t phase;
+    uint8_t previous;
+    uint8_t header[3];
+    uint32_t header_length;
+    uint32_t packet_length;
+    uint8_t checksum;
+    uint32_t response_length;
+    bool matched;
+} response_parser_t;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s [-d <tty>] -i <image> [-w <window>] [-e <entry timeout ms>] [-p]\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "d:i:w:e:p")) != -1)
+    {
+        switch (option)
+        {
+        case 'd':
+            tty_path = optarg;
+            break;
+
+        case 'i':
+            image_path = optarg;
+            break;
+
+        case 'w':
+            window = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'e':
+            entry_timeout_ms = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'p':
+            pty_mode = true;
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    /* A pty from cc3100_pty_sim has no USB device to be found by */
+    if (((tty_path == NULL) && pty_mode) || (image_path == NULL) || (optind != argc) || (window == 0))
+    {
+        usage (argv[0]);
+    }
+}
+
+
+/**
+ * @return Returns the IEEE 802.3 CRC-32 of the data, as calculated by zlib crc32()
+ */
+static uint32_t image_crc (const uint8_t *const data, const size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t byte_index = 0; byte_index < length; byte_index++)
+    {
+        crc ^= data[byte_index];
+        for (uint32_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+
+/**
+ * @return Returns the number of bytes which a record occupies in the image, including the padding
+ */
+static size_t record_size (const cc3100_programmer_record_t *const record)
+{
+    return sizeof (*record) + ((record->command_length + record->expected_length + 3u) & ~3u);
+}
+
+
+/**
+ * @brief Read the image, and check its header, CRC and the framing of all the records in the same way as the
+ *        standalone programmer, so that an invalid image can't leave the CC3100 partly programmed
+ */
+static void load_image (void)
+{
+    const cc3100_programmer_image_header_t *header;
+    const uint8_t *image_records;
+    FILE *const image_file = fopen (image_path, "rb");
+    size_t image_length = 0;
+    size_t offset = 0;
+    bool valid;
+
+    if (image_file != NULL)
+    {
+        fseek (image_file, 0, SEEK_END);
+        image_length = (size_t) ftell (image_file);
+        fseek (image_file, 0, SEEK_SET);
+        image = malloc (image_length + 1);
+    }
+    if ((image_file == NULL) || (image == NULL) || (fread (image, 1, image_length, image_file) != image_length))
+    {
+        fprintf (stderr, "Can't read %s: %s\n", image_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    fclose (image_file);
+
+    header = (const cc3100_programmer_image_header_t *) image;
+    image_records = (const uint8_t *) (header + 1);
+    valid = (image_length >= sizeof (*header)) && (header->magic == CC3100_PROGRAMMER_IMAGE_MAGIC) &&
+            (header->num_records > 0) && (header->records_length <= (image_length - sizeof (*header))) &&
+            ((header->records_length % 4) == 0);
+    if (valid)
+    {
+        valid = image_crc (image_records, header->records_length) == header->records_crc;
+        records = calloc (header->num_records, sizeof (records[0]));
+        if (records == NULL)
+        {
+            fprintf (stderr, "Out of memory\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    for (num_records = 0; valid && (num_records < header->num_records); num_records++)
+    {
+        const cc3100_programmer_record_t *const record = (const cc3100_programmer_record_t *) &image_records[offset];
+
+        valid = ((header->records_length - offset) >= sizeof (*record)) &&
+                (record->command_length > 0) && (record->command_length <= MAX_COMMAND_LENGTH) &&
+                (record->response <= CC3100_PROGRAMMER_RESPONSE_PACKET) &&
+                ((record->response != CC3100_PROGRAMMER_RESPONSE_ACK) || (record->expected_length == 0)) &&
+                (record->expected_length <= record->response_length);
+        if (valid)
+        {
+            valid = (header->records_length - offset) >= record_size (record);
+            offset += record_size (record);
+            records[num_records] = record;
+            command_bytes += record->command_length;
+        }
+    }
+
+    if (!valid || (offset != header->records_length))
+    {
+        fprintf (stderr, "%s isn't a valid CC3100 programmer image\n", image_path);
+        exit (EXIT_FAILURE);
+    }
+
+    /* Each command is framed with a 3 byte header, and each response packet is acknowledged with 2 bytes */
+    tx_buffer = malloc (command_bytes + (5 * (size_t) num_records));
+    if (tx_buffer == NULL)
+    {
+        fprintf (stderr, "Out of memory\n");
+        exit (EXIT_FAILURE);
+    }
+}
+
+
+/**
+ * @brief Read a hexadecimal sysfs attribute
+ * @return Returns true if the attribute was read
+ */
+static bool read_sysfs_hex (const char *const directory, const char *const attribute, unsigned int *const value)
+{
+    char path[PATH_MAX];
+    FILE *file;
+    bool read;
+
+    snprintf (path, sizeof (path), "%s/%s", directory, attribute);
+    file = fopen (path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    read = fscanf (file, "%x", value) == 1;
+    fclose (file);
+
+    return read;
+}
+
+
+/**
+ * @brief Find the tty of the bridge from the VID and PID of the USB device of each ttyACM device under sysfs
+ * @details The device link of a ttyACM device is the USB interface, whose parent directory is the USB device.
+ *          Exits if there isn't exactly one bridge, since the tty must then be given with -d.
+ */
+static void find_tty (void)
+{
+    DIR *const directory = opendir (SYSFS_TTY_CLASS);
+    const struct dirent *entry;
+    unsigned int lowest_interface = UINT_MAX;
+    char found_device[PATH_MAX] = "";
+    uint32_t num_devices = 0;
+
+    if (directory == NULL)
+    {
+        fprintf (stderr, "Can't open %s: %s\n", SYSFS_TTY_CLASS, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    while ((entry = readdir (directory)) != NULL)
+    {
+        char link_path[PATH_MAX];
+        char interface[PATH_MAX];
+        char parent[PATH_MAX];
+        char device[PATH_MAX];
+        unsigned int vid;
+        unsigned int pid;
+        unsigned int interface_number;
+
+        if (strncmp (entry->d_name, "ttyACM", strlen ("ttyACM")) != 0)
+        {
+            continue;
+        }
+        snprintf (link_path, sizeof (link_path), "%s/%s/device", SYSFS_TTY_CLASS, entry->d_name);
+        if (realpath (link_path, interface) == NULL)
+        {
+            continue;
+        }
+        snprintf (parent, sizeof (parent), "%s/%s/device/..", SYSFS_TTY_CLASS, entry->d_name);
+        if ((realpath (parent, device) == NULL) ||
+            !read_sysfs_hex (device, "idVendor", &vid) || !read_sysfs_hex (device, "idProduct", &pid) ||
+            (vid != USB_VID_TI_1CBE) || (pid != USB_PID_SERIAL) ||
+            !read_sysfs_hex (interface, "bInterfaceNumber", &interface_number))
+        {
+            continue;
+        }
+
+        /* Count each bridge once, however many CDC ports it presents */
+        if (num_devices == 0)
+        {
+            num_devices = 1;
+            snprintf (found_device, sizeof (found_device), "%s", device);
+        }
+        else if (strcmp (device, found_device) != 0)
+        {
+            num_devices = 2;
+        }
+        if ((strcmp (device, found_device) == 0) && (interface_number < lowest_interface))
+        {
+            lowest_interface = interface_number;
+            snprintf (found_tty_path, sizeof (found_tty_path), "/dev/%s", entry->d_name);
+        }
+    }
+    closedir (directory);
+
+    if (num_devices != 1)
+    {
+        fprintf (stderr, "%s bridge with VID 0x%04x PID 0x%04x found, so the tty must be given with -d\n",
+                 (num_devices == 0) ? "No" : "More than one", USB_VID_TI_1CBE, USB_PID_SERIAL);
+        exit (EXIT_FAILURE);
+    }
+    tty_path = found_tty_path;
+}
+
+
+/**
+ * @brief Open the tty in raw mode at the fixed baud rate of the bootloader, with hardware flow control so the
+ *        bridge holds back the queued commands while the CC3100 is busy
+ */
+static int open_tty (void)
+{
+    struct termios tio;
+    int fd;
+
+    fd = open (tty_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((fd < 0) || (tcgetattr (fd, &tio) != 0))
+    {
+        fprintf (stderr, "Can't open %s: %s\n", tty_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    cfmakeraw (&tio);
+    tio.c_cflag |= CLOCAL | CREAD | CRTSCTS;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed (&tio, B921600);
+    cfsetospeed (&tio, B921600);
+    if (tcsetattr (fd, TCSANOW, &tio) != 0)
+    {
+        fprintf (stderr, "Can't configure %s: %s\n", tty_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    tcflush (fd, TCIOFLUSH);
+
+    return fd;
+}
+
+
+static double now_us (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1e6) + (now.tv_nsec / 1e3);
+}
+
+
+/**
+ * @brief Wait until the tty is ready, or the deadline expires
+ * @return Returns the poll revents, or zero on timeout
+ */
+static short wait_for_tty (const int fd, const short events, const double deadline)
+{
+    struct pollfd poll_fd = {.fd = fd, .events = events};
+    const double remaining_us = deadline - now_us ();
+
+    if ((remaining_us <= 0) || (poll (&poll_fd, 1, (int) (remaining_us / 1e3) + 1) <= 0))
+    {
+        return 0;
+    }
+
+    return poll_fd.revents;
+}
+
+
+/**
+ * @brief Enter the bootloader, by sending a break while waiting for the acknowledgement
+ */
+static cc3100_programmer_error_t enter_bootloader (const int fd)
+{
+    static const uint8_t break_character = 0;
+    const double deadline = now_us () + (entry_timeout_ms * 1e3);
+    uint8_t previous = ~BOOTLOADER_ACK_0;
+    bool acknowledged = false;
+    uint8_t rx_byte;
+
+    if (pty_mode ? (write (fd, &break_character, 1) != 1) : (ioctl (fd, TIOCSBRK) != 0))
+    {
+        fprintf (stderr, "Can't send a break on %s: %s\n", tty_path, strerror (errno));
+        return CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+    }
+
+    while (!acknowledged && ((wait_for_tty (fd, POLLIN, deadline) & POLLIN) != 0))
+    {
+        while (!acknowledged && (read (fd, &rx_byte, 1) == 1))
+        {
+            acknowledged = (previous == BOOTLOADER_ACK_0) && (rx_byte == BOOTLOADER_ACK_1);
+            previous = rx_byte;
+        }
+    }
+
+    if (!pty_mode)
+    {
+        ioctl (fd, TIOCCBRK);
+    }
+
+    return acknowledged ? CC3100_PROGRAMMER_ERROR_NONE : CC3100_PROGRAMMER_ERROR_NO_BOOTLOADER;
+}
+
+
+/**
+ * @brief Append a command to the bytes to write, framed as a packet of the big-endian length including the length
+ *        itself, the checksum of the command, then the command
+ */
+static void queue_command (const cc3100_programmer_record_t *const record)
+{
+    const uint8_t *const command = (const uint8_t *) (record + 1);
+    uint8_t checksum = 0;
+
+    for (uint32_t byte_index = 0; byte_index < record->command_length; byte_index++)
+    {
+        checksum += command[byte_index];
+    }
+    tx_buffer[tx_length++] = (uint8_t) ((record->command_length + 2) >> 8);
+    tx_buffer[tx_length++] = (uint8_t) (record->command_length + 2);
+    tx_buffer[tx_length++] = checksum;
+    memcpy (&tx_buffer[tx_length], command, record->command_length);
+    tx_length += record->command_length;
+}
+
+
+/**
+ * @brief Write as many of the queued bytes as the tty accepts without blocking
+ * @return Returns false if the write failed
+ */
+static bool write_queued (const int fd)
+{
+    const ssize_t bytes = write (fd, &tx_buffer[tx_written], tx_length - tx_written);
+
+    if (bytes > 0)
+    {
+        tx_written += (size_t) bytes;
+    }
+
+    return (bytes >= 0) || (errno == EAGAIN);
+}
+
+
+static void parser_start (response_parser_t *const parser, const cc3100_programmer_record_t *const record)
+{
+    memset (parser, 0, sizeof (*parser));
+    parser->record = record;
+    parser->expected = ((const uint8_t *) (record + 1)) + record->command_length;
+    parser->phase = PHASE_ACK;
+    parser->previous = ~BOOTLOADER_ACK_0;
+    parser->matched = true;
+}
+
+
+/**
+ * @brief Record a character of the response to a command, and compare it against the expected response
+ */
+static void record_response_byte (response_parser_t *const parser, const uint8_t rx_byte)
+{
+    if (parser->response_length < parser->record->expected_length)
+    {
+        parser->matched &= rx_byte == parser->expected[parser->response_length];
+    }
+    parser->response_length++;
+}
+
+
+/**
+ * @brief Pass one received character to the response of the oldest command, in the same way as run_record() of the
+ *        standalone programmer
+ * @param[in,out] parser The response being received
+ * @param[in] rx_byte The received character
+ * @param[out] complete Set true when the response is complete
+ * @return Returns CC3100_PROGRAMMER_ERROR_NONE unless the response is invalid or doesn't match
+ */
+static cc3100_programmer_error_t parser_receive (response_parser_t *const parser, const uint8_t rx_byte,
+                                                 bool *const complete)
+{
+    const cc3100_programmer_record_t *const record = parser->record;
+
+    *complete = false;
+    switch (parser->phase)
+    {
+    case PHASE_ACK:
+        if ((parser->previous == BOOTLOADER_ACK_0) && (rx_byte == BOOTLOADER_ACK_1))
+        {
+            parser->phase = (record->response == CC3100_PROGRAMMER_RESPONSE_PACKET) ? PHASE_PACKET_HEADER : PHASE_RAW;
+            *complete = (record->response == CC3100_PROGRAMMER_RESPONSE_ACK) ||
+                    ((record->response == CC3100_PROGRAMMER_RESPONSE_RAW) && (record->response_length == 0));
+        }
+        parser->previous = rx_byte;
+        break;
+
+    case PHASE_RAW:
+        record_response_byte (parser, rx_byte);
+        *complete = parser->response_length == record->response_length;
+        break;
+
+    case PHASE_PACKET_HEADER:
+        parser->header[parser->header_length++] = rx_byte;
+        if (parser->header_length == sizeof (parser->header))
+        {
+            parser->packet_length = ((uint32_t) parser->header[0] << 8) | parser->header[1];
+            if ((parser->packet_length < 2) || ((parser->packet_length - 2) > record->response_length))
+            {
+                return CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID;
+            }
+            parser->phase = PHASE_PACKET_DATA;
+            *complete = parser->packet_length == 2;
+        }
+        break;
+
+    case PHASE_PACKET_DATA:
+        parser->checksum += rx_byte;
+        record_response_byte (parser, rx_byte);
+        *complete = parser->response_length == (parser->packet_length - 2);
+        break;
+    }
+
+    if (*complete && (record->response == CC3100_PROGRAMMER_RESPONSE_PACKET) && (parser->checksum != parser->header[2]))
+    {
+        return CC3100_PROGRAMMER_ERROR_RESPONSE_INVALID;
+    }
+    if (*complete && (!parser->matched || (parser->response_length < record->expected_length)))
+    {
+        return CC3100_PROGRAMMER_ERROR_RESPONSE_MISMATCH;
+    }
+
+    return CC3100_PROGRAMMER_ERROR_NONE;
+}
+
+
+/**
+ * @brief Send all the commands, keeping up to the window of commands queued ahead of the oldest which hasn't
+ *        completed
+ * @details The timeout of each record runs from when it becomes the oldest, and restarts once it is acknowledged.
+ * @param[in] fd The tty
+ * @param[out] num_completed The number of records which completed. On failure, the index of the record which failed.
+ * @return Returns CC3100_PROGRAMMER_ERROR_NONE if all the commands completed as expected
+ */
+static cc3100_programmer_error_t run_records (const int fd, uint32_t *const num_completed)
+{
+    cc3100_programmer_error_t error = CC3100_PROGRAMMER_ERROR_NONE;
+    response_parser_t parser;
+    uint32_t num_queued = 0;
+    double deadline = 0;
+    uint8_t rx_buffer[256];
+
+    *num_completed = 0;
+    while ((error == CC3100_PROGRAMMER_ERROR_NONE) && (*num_completed < num_records))
+    {
+        short revents;
+
+        /* Queue commands up to the window, ending the burst at a command with a response packet */
+        while ((num_queued < num_records) && ((num_queued - *num_completed) < window) &&
+               ((num_queued == *num_completed) ||
+                (records[num_queued - 1]->response != CC3100_PROGRAMMER_RESPONSE_PACKET)))
+        {
+            if (num_queued == *num_completed)
+            {
+                parser_start (&parser, records[num_queued]);
+                deadline = now_us () + (records[num_queued]->timeout_ms * 1e3);
+            }
+            queue_command (records[num_queued]);
+            num_queued++;
+        }
+
+        revents = wait_for_tty (fd, POLLIN | ((tx_written < tx_length) ? POLLOUT : 0), deadline);
+        if (revents == 0)
+        {
+            error = (parser.phase == PHASE_ACK) ?
+                    CC3100_PROGRAMMER_ERROR_NO_ACK : CC3100_PROGRAMMER_ERROR_RESPONSE_TIMEOUT;
+        }
+        else if ((revents & (POLLIN | POLLOUT)) == 0)
+        {
+            error = CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+        }
+        if (((revents & POLLOUT) != 0) && !write_queued (fd))
+        {
+            error = CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+        }
+
+        if ((error == CC3100_PROGRAMMER_ERROR_NONE) && ((revents & POLLIN) != 0))
+        {
+            const ssize_t num_read = read (fd, rx_buffer, sizeof (rx_buffer));
+
+            for (ssize_t rx_index = 0; (error == CC3100_PROGRAMMER_ERROR_NONE) && (rx_index < num_read) &&
+                 (*num_completed < num_queued); rx_index++)
+            {
+                const response_phase_t phase = parser.phase;
+                bool complete;
+
+                error = parser_receive (&parser, rx_buffer[rx_index], &complete);
+                if ((error == CC3100_PROGRAMMER_ERROR_NONE) && complete)
+                {
+                    if (parser.record->response == CC3100_PROGRAMMER_RESPONSE_PACKET)
+                    {
+                        tx_buffer[tx_length++] = BOOTLOADER_ACK_0;
+                        tx_buffer[tx_length++] = BOOTLOADER_ACK_1;
+                    }
+                    (*num_completed)++;
+                    if (*num_completed < num_queued)
+                    {
+                        parser_start (&parser, records[*num_completed]);
+                        deadline = now_us () + (records[*num_completed]->timeout_ms * 1e3);
+                    }
+                }
+                else if (parser.phase != phase)
+                {
+                    deadline = now_us () + (parser.record->timeout_ms * 1e3);
+                }
+            }
+            if (num_read <= 0)
+            {
+                error = CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+            }
+        }
+    }
+
+    /* Write the acknowledgement of a final response packet */
+    deadline = now_us () + (FINAL_WRITE_TIMEOUT_MS * 1e3);
+    while ((error == CC3100_PROGRAMMER_ERROR_NONE) && (tx_written < tx_length))
+    {
+        if (((wait_for_tty (fd, POLLOUT, deadline) & POLLOUT) == 0) || !write_queued (fd))
+        {
+            error = CC3100_PROGRAMMER_ERROR_LINE_ERROR;
+        }
+    }
+    if (error == CC3100_PROGRAMMER_ERROR_NONE)
+    {
+        tcdrain (fd);
+    }
+
+    return error;
+}
+
+
+int main (int argc, char *argv[])
+{
+    cc3100_programmer_error_t error;
+    uint32_t num_completed = 0;
+    double entry_us;
+    double elapsed_us = 0;
+    double start;
+    int fd;
+
+    parse_command_line (argc, argv);
+    load_image ();
+    if (tty_path == NULL)
+    {
+        find_tty ();
+    }
+    fd = open_tty ();
+
+    start = now_us ();
+    error = enter_bootloader (fd);
+    entry_us = now_us () - start;
+    if (error == CC3100_PROGRAMMER_ERROR_NONE)
+    {
+        start = now_us ();
+        error = run_records (fd, &num_completed);
+        elapsed_us = now_us () - start;
+    }
+    close (fd);
+
+    printf ("{\"tty\": \"%s\", \"image\": \"%s\", \"window\": %u, \"records\": %u, \"completed\": %u, "
+            "\"command_bytes\": %zu, \"entry_ms\": %.1f, \"elapsed_ms\": %.1f, \"command_kbytes_per_s\": %.1f, "
+            "\"result\": \"%s\", \"error\": \"%s\"}\n",
+            tty_path, image_path, window, num_records, num_completed, command_bytes, entry_us / 1e3,
+            elapsed_us / 1e3, (elapsed_us > 0) ? ((command_bytes * 1e3) / elapsed_us) : 0.0,
+            (error == CC3100_PROGRAMMER_ERROR_NONE) ? "passed" : "failed", error_names[error]);
+    free (tx_buffer);
+    free (records);
+    free (image);
+
+    return (error == CC3100_PROGRAMMER_ERROR_NONE) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
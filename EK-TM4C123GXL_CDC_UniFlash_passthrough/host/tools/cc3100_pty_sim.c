@@ -0,0 +1,335 @@
+/*
+ * @file cc3100_pty_sim.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Simulate the bridge with a CC3100 attached on a pty, to test the Linux tools without hardware
+ * @details The slave of the pty stands in for the CDC port of the bridge. The CC3100 is modelled with the same
+ *          bootloader model as the host simulation, but runs in real time, sleeping for the time each command takes
+ *          so that characters sent ahead by the client are held in the pty as they would be by the flow control of
+ *          the bridge.
+ *
+ *          A pty can't carry a break, so in the application state a NUL character is taken as the SEND_BREAK
+ *          sequence, which enters the bootloader. The application state is restored whenever the client closes the
+ *          pty, at which point the files which have been uploaded are saved to the output directory, named from the
+ *          file name with '/' replaced by '_'. With -e the CC3100 instead echoes every character, as for the loopback
+ *          used by cdc_rtt, and never enters the bootloader.
+ *
+ *          The path of the slave is written to stdout, and may also be published as a symbolic link with -l. When a
+ *          command is given it is run with each @PTY@ in its arguments replaced by the path of the slave, and the
+ *          simulator exits with the status of the command once it has finished.
+ *
+ *          Usage: cc3100_pty_sim [-e] [-l <link>] [-o <output directory>] [-- <command> [<args>]]
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "sim_cc3100_bootloader.h"
+
+/** The placeholder in the command arguments for the path of the slave */
+#define PTY_PLACEHOLDER "@PTY@"
+
+/** How often to check for the client opening the pty, or the command exiting */
+#define POLL_INTERVAL_MS 10
+
+/** The command line options */
+static bool echo_mode;
+static const char *link_path;
+static const char *output_dir;
+static char **command_argv;
+
+static int master_fd;
+static const char *slave_path;
+
+/** Set while the bootloader is running, rather than the CC3100 application */
+static bool in_bootloader;
+static sim_cc3100_bootloader_t bootloader;
+
+static volatile sig_atomic_t stop_requested;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s [-e] [-l <link>] [-o <output directory>] [-- <command> [<args>]]\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "el:o:")) != -1)
+    {
+        switch (option)
+        {
+        case 'e':
+            echo_mode = true;
+            break;
+
+        case 'l':
+            link_path = optarg;
+            break;
+
+        case 'o':
+            output_dir = optarg;
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    if (optind < argc)
+    {
+        command_argv = &argv[optind];
+    }
+}
+
+
+static void stop_handler (int signum)
+{
+    (void) signum;
+    stop_requested = true;
+}
+
+
+/**
+ * @brief Write characters from the CC3100 to the client
+ */
+static void send_to_client (void *context, const void *data, size_t length)
+{
+    const uint8_t *const bytes = data;
+    size_t num_written = 0;
+
+    (void) context;
+    while (num_written < length)
+    {
+        const ssize_t written = write (master_fd, &bytes[num_written], length - num_written);
+
+        if (written > 0)
+        {
+            num_written += (size_t) written;
+        }
+        else if ((written < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            /* The client has closed the pty */
+            return;
+        }
+        else
+        {
+            usleep (100);
+        }
+    }
+}
+
+
+/**
+ * @brief Create the pty, which remains until the simulator exits
+ */
+static void open_pty (void)
+{
+    master_fd = posix_openpt (O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((master_fd < 0) || (grantpt (master_fd) != 0) || (unlockpt (master_fd) != 0))
+    {
+        fprintf (stderr, "Can't create a pty: %s\n", strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    slave_path = ptsname (master_fd);
+    if ((link_path != NULL) && ((unlink (link_path) != 0) && (errno != ENOENT)))
+    {
+        fprintf (stderr, "Can't replace %s: %s\n", link_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    if ((link_path != NULL) && (symlink (slave_path, link_path) != 0))
+    {
+        fprintf (stderr, "Can't link %s to %s: %s\n", link_path, slave_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    printf ("%s\n", slave_path);
+    fflush (stdout);
+}
+
+
+/**
+ * @brief Save the files uploaded to the bootloader to the output directory
+ */
+static void save_files (void)
+{
+    for (uint32_t file_index = 0; (output_dir != NULL) && (file_index < SIM_CC3100_MAX_FILES); file_index++)
+    {
+        const sim_cc3100_file_t *const file = &bootloader.files[file_index];
+        char path[PATH_MAX];
+        FILE *output;
+        int path_length;
+
+        if (!file->in_use || !file->complete)
+        {
+            continue;
+        }
+
+        path_length = snprintf (path, sizeof (path), "%s/%s", output_dir,
+                                (file->name[0] == '/') ? &file->name[1] : file->name);
+        for (int index = (int) strlen (output_dir) + 1; index < path_length; index++)
+        {
+            if (path[index] == '/')
+            {
+                path[index] = '_';
+            }
+        }
+        output = fopen (path, "wb");
+        if ((output == NULL) || (fwrite (file->data, 1, file->length, output) != file->length))
+        {
+            fprintf (stderr, "Can't save %s: %s\n", path, strerror (errno));
+        }
+        if (output != NULL)
+        {
+            fclose (output);
+        }
+    }
+}
+
+
+/**
+ * @brief Pass a character sent by the client to the CC3100
+ */
+static void cc3100_receive (const uint8_t character)
+{
+    uint32_t command_time_us;
+
+    if (echo_mode)
+    {
+        send_to_client (NULL, &character, sizeof (character));
+    }
+    else if (in_bootloader)
+    {
+        if (sim_cc3100_bootloader_receive (&bootloader, character, &command_time_us))
+        {
+            usleep (command_time_us);
+            sim_cc3100_bootloader_run_command (&bootloader);
+        }
+    }
+    else if (character == 0)
+    {
+        in_bootloader = true;
+        sim_cc3100_bootloader_enter (&bootloader);
+    }
+}
+
+
+/**
+ * @brief Start the command with the path of the slave substituted for the placeholder
+ * @return Returns the process ID of the command
+ */
+static pid_t start_command (void)
+{
+    const pid_t pid = fork ();
+
+    if (pid < 0)
+    {
+        fprintf (stderr, "Can't fork: %s\n", strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    else if (pid == 0)
+    {
+        close (master_fd);
+        for (uint32_t arg_index = 0; command_argv[arg_index] != NULL; arg_index++)
+        {
+            if (strcmp (command_argv[arg_index], PTY_PLACEHOLDER) == 0)
+            {
+                command_argv[arg_index] = (char *) slave_path;
+            }
+        }
+        execvp (command_argv[0], command_argv);
+        fprintf (stderr, "Can't run %s: %s\n", command_argv[0], strerror (errno));
+        _exit (EXIT_FAILURE);
+    }
+
+    return pid;
+}
+
+
+int main (int argc, char *argv[])
+{
+    pid_t command_pid = 0;
+    int exit_status = EXIT_SUCCESS;
+    bool client_open = false;
+
+    parse_command_line (argc, argv);
+    signal (SIGINT, stop_handler);
+    signal (SIGTERM, stop_handler);
+    sim_cc3100_bootloader_init (&bootloader, send_to_client, NULL);
+    open_pty ();
+    if (command_argv != NULL)
+    {
+        command_pid = start_command ();
+    }
+
+    while (!stop_requested)
+    {
+        struct pollfd poll_fd = {.fd = master_fd, .events = POLLIN};
+        uint8_t rx_buffer[256];
+        ssize_t num_read = 0;
+        bool hung_up = false;
+        int status;
+
+        if ((command_pid > 0) && (waitpid (command_pid, &status, WNOHANG) == command_pid))
+        {
+            exit_status = (WIFEXITED (status) && (WEXITSTATUS (status) == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+            break;
+        }
+
+        if (poll (&poll_fd, 1, POLL_INTERVAL_MS) > 0)
+        {
+            if ((poll_fd.revents & POLLIN) != 0)
+            {
+                num_read = read (master_fd, rx_buffer, sizeof (rx_buffer));
+                hung_up = (num_read < 0) && (errno != EAGAIN) && (errno != EINTR);
+            }
+            else
+            {
+                hung_up = true;
+            }
+        }
+        if (num_read > 0)
+        {
+            client_open = true;
+            for (ssize_t rx_index = 0; rx_index < num_read; rx_index++)
+            {
+                cc3100_receive (rx_buffer[rx_index]);
+            }
+        }
+        else if (hung_up)
+        {
+            /* No client has the pty open, so return to the application for the next client */
+            if (client_open)
+            {
+                save_files ();
+                client_open = false;
+            }
+            in_bootloader = false;
+            usleep (POLL_INTERVAL_MS * 1000);
+        }
+    }
+
+    save_files ();
+    if (link_path != NULL)
+    {
+        unlink (link_path);
+    }
+    close (master_fd);
+
+    return exit_status;
+}
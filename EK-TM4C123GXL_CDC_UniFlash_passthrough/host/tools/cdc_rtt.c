@@ -0,0 +1,319 @@
+/*
+ * @file cdc_rtt.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Measure the round-trip time through the CDC port of the bridge on Linux
+ * @details Writes commands to a tty and times how long until the same number of bytes has been read back, which
+ *          requires the far end to echo, e.g. with the TX and RX signals to the CC3100BOOST looped back.
+ *          Optionally sets the USB IN flush policy first with VENDOR_REQUEST_SET_USB_IN_FLUSH, sent through usbfs,
+ *          so that the effect of the policy can be measured.
+ *
+ *          The result is written as one JSON object on a line, with the same percentile fields as the simulation
+ *          benchmark so that hardware and simulated results can be compared.
+ *
+ *          Usage: cdc_rtt -d <tty> [-b <baud>] [-n <exchanges>] [-s <command length>]
+ *                         [-u /dev/bus/usb/<bus>/<device> -l <latency ms> -t <fill threshold>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <linux/usbdevice_fs.h>
+
+/* Copied from vendor_requests.h, which can't be included as it depends upon usblib */
+#define VENDOR_REQUEST_SET_USB_IN_FLUSH 0x05
+
+/** The time allowed for each response before the exchange is counted as failed */
+#define RESPONSE_TIMEOUT_MS 1000
+
+/** The maximum command length */
+#define MAX_COMMAND_LENGTH 4096
+
+/** The command line options */
+static const char *tty_path;
+static uint32_t baud = 115200;
+static uint32_t num_exchanges = 1000;
+static size_t command_length = 8;
+static const char *usbfs_path;
+static uint32_t latency_ms = 0;
+static uint32_t fill_threshold = 64;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s -d <tty> [-b <baud>] [-n <exchanges>] [-s <command length>]\n"
+             "          [-u /dev/bus/usb/<bus>/<device> -l <latency ms> -t <fill threshold>]\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "d:b:n:s:u:l:t:")) != -1)
+    {
+        switch (option)
+        {
+        case 'd':
+            tty_path = optarg;
+            break;
+
+        case 'b':
+            baud = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'n':
+            num_exchanges = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 's':
+            command_length = strtoul (optarg, NULL, 0);
+            break;
+
+        case 'u':
+            usbfs_path = optarg;
+            break;
+
+        case 'l':
+            latency_ms = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 't':
+            fill_threshold = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    if ((tty_path == NULL) || (optind != argc) || (num_exchanges == 0) ||
+        (command_length == 0) || (command_length > MAX_COMMAND_LENGTH))
+    {
+        usage (argv[0]);
+    }
+}
+
+
+/**
+ * @return Returns the termios speed for a baud rate, or B0 if not supported
+ */
+static speed_t termios_speed (const uint32_t rate)
+{
+    static const struct
+    {
+        uint32_t rate;
+        speed_t speed;
+    } speeds[] =
+    {
+        {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+        {230400, B230400}, {460800, B460800}, {500000, B500000}, {921600, B921600}, {1000000, B1000000},
+        {2000000, B2000000}, {3000000, B3000000}
+    };
+
+    for (size_t index = 0; index < (sizeof (speeds) / sizeof (speeds[0])); index++)
+    {
+        if (speeds[index].rate == rate)
+        {
+            return speeds[index].speed;
+        }
+    }
+
+    return B0;
+}
+
+
+/**
+ * @brief Open the tty in raw mode at the baud rate, which the CDC driver sends to the bridge as SET_LINE_CODING
+ */
+static int open_tty (void)
+{
+    const speed_t speed = termios_speed (baud);
+    struct termios tio;
+    int fd;
+
+    if (speed == B0)
+    {
+        fprintf (stderr, "Unsupported baud rate %u\n", baud);
+        exit (EXIT_FAILURE);
+    }
+
+    fd = open (tty_path, O_RDWR | O_NOCTTY);
+    if ((fd < 0) || (tcgetattr (fd, &tio) != 0))
+    {
+        fprintf (stderr, "Can't open %s: %s\n", tty_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    cfmakeraw (&tio);
+    tio.c_cflag |= CLOCAL | CREAD | CRTSCTS;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed (&tio, speed);
+    cfsetospeed (&tio, speed);
+    if (tcsetattr (fd, TCSANOW, &tio) != 0)
+    {
+        fprintf (stderr, "Can't configure %s: %s\n", tty_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    tcflush (fd, TCIOFLUSH);
+
+    return fd;
+}
+
+
+/**
+ * @brief Set the USB IN flush policy of the bridge with a vendor request sent through usbfs
+ */
+static void set_flush_policy (void)
+{
+    struct usbdevfs_ctrltransfer transfer =
+    {
+        .bRequestType = 0x40, /* Host-to-device, vendor, device */
+        .bRequest = VENDOR_REQUEST_SET_USB_IN_FLUSH,
+        .wValue = (uint16_t) latency_ms,
+        .wIndex = (uint16_t) fill_threshold,
+        .wLength = 0,
+        .timeout = 1000,
+        .data = NULL
+    };
+    const int fd = open (usbfs_path, O_RDWR);
+
+    if ((fd < 0) || (ioctl (fd, USBDEVFS_CONTROL, &transfer) < 0))
+    {
+        fprintf (stderr, "SET_USB_IN_FLUSH latency %u fill threshold %u failed on %s: %s\n",
+                 latency_ms, fill_threshold, usbfs_path, strerror (errno));
+        exit (EXIT_FAILURE);
+    }
+    close (fd);
+}
+
+
+static double now_us (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1e6) + (now.tv_nsec / 1e3);
+}
+
+
+/**
+ * @brief Read until length bytes have been received or the response timeout expires
+ * @return Returns the number of bytes read
+ */
+static size_t read_response (const int fd, uint8_t *const data, const size_t length)
+{
+    const double deadline = now_us () + (RESPONSE_TIMEOUT_MS * 1e3);
+    size_t num_read = 0;
+
+    while (num_read < length)
+    {
+        struct pollfd poll_fd = {.fd = fd, .events = POLLIN};
+        const double remaining_us = deadline - now_us ();
+        ssize_t bytes;
+
+        if ((remaining_us <= 0) || (poll (&poll_fd, 1, (int) (remaining_us / 1e3) + 1) <= 0))
+        {
+            break;
+        }
+        bytes = read (fd, &data[num_read], length - num_read);
+        if (bytes > 0)
+        {
+            num_read += (size_t) bytes;
+        }
+    }
+
+    return num_read;
+}
+
+
+static int compare_doubles (const void *a, const void *b)
+{
+    const double value_a = *(const double *) a;
+    const double value_b = *(const double *) b;
+
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+
+int main (int argc, char *argv[])
+{
+    uint8_t command[MAX_COMMAND_LENGTH];
+    uint8_t response[MAX_COMMAND_LENGTH];
+    double *rtts;
+    uint32_t num_timed = 0;
+    uint32_t num_failed = 0;
+    double total_us = 0;
+    int fd;
+
+    parse_command_line (argc, argv);
+    rtts = calloc (num_exchanges, sizeof (rtts[0]));
+    if (rtts == NULL)
+    {
+        fprintf (stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    if (usbfs_path != NULL)
+    {
+        set_flush_policy ();
+    }
+    fd = open_tty ();
+
+    for (uint32_t exchange = 0; exchange < num_exchanges; exchange++)
+    {
+        double start;
+        size_t num_received;
+
+        for (size_t index = 0; index < command_length; index++)
+        {
+            command[index] = (uint8_t) (exchange + index);
+        }
+        start = now_us ();
+        if (write (fd, command, command_length) != (ssize_t) command_length)
+        {
+            fprintf (stderr, "Write to %s failed: %s\n", tty_path, strerror (errno));
+            return EXIT_FAILURE;
+        }
+        num_received = read_response (fd, response, command_length);
+        if ((num_received == command_length) && (memcmp (command, response, command_length) == 0))
+        {
+            rtts[num_timed] = now_us () - start;
+            total_us += rtts[num_timed];
+            num_timed++;
+        }
+        else
+        {
+            /* Discard any late response, so it isn't taken as the response to the next command */
+            num_failed++;
+            usleep (RESPONSE_TIMEOUT_MS * 1000);
+            tcflush (fd, TCIOFLUSH);
+        }
+    }
+    close (fd);
+
+    qsort (rtts, num_timed, sizeof (rtts[0]), compare_doubles);
+    printf ("{\"tty\": \"%s\", \"baud\": %u, \"command_length\": %zu, \"latency_ms\": %d, \"fill_threshold\": %d, "
+            "\"transactions\": %u, \"failed\": %u",
+            tty_path, baud, command_length, (usbfs_path != NULL) ? (int) latency_ms : -1,
+            (usbfs_path != NULL) ? (int) fill_threshold : -1, num_timed, num_failed);
+    if (num_timed > 0)
+    {
+        printf (", \"rtt_mean_us\": %.1f, \"rtt_p50_us\": %.1f, \"rtt_p90_us\": %.1f, \"rtt_p99_us\": %.1f, "
+                "\"rtt_max_us\": %.1f", total_us / num_timed, rtts[(num_timed - 1) / 2],
+                rtts[((num_timed - 1) * 90) / 100], rtts[((num_timed - 1) * 99) / 100], rtts[num_timed - 1]);
+    }
+    printf ("}\n");
+    free (rtts);
+
+    return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+/*
+ * @file telemetry_reader.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Read the data path telemetry of the bridge on Linux, while a flash session is running
+ * @details Periodically reads the data_path_telemetry_t with VENDOR_REQUEST_GET_TELEMETRY, sent through usbfs on
+ *          endpoint zero so the CDC data stream isn't interrupted, and writes one JSON object per line with the
+ *          change in the counters over the interval:
+ *          - The throughput in each direction.
+ *          - The peak occupancy of each buffer, as a fraction of its size.
+ *          - The interrupt handler call rates.
+ *          - The fraction of the interval for which RTS throttled the CC3100.
+ *          - The OUT NAK, transmit buffer full and endpoint zero stall episodes.
+ *
+ *          Each line also has a "bound" field, which is the reader's judgement of what limited the interval:
+ *          - "uart": the USB host was NAKed as cdc_rx_buffer was full, so the UART didn't keep up with the host.
+ *          - "usb": cdc_tx_buffer filled, or the CC3100 was throttled, so the USB host didn't keep up.
+ *          - "buffering": neither, but a buffer peak reached BUFFERING_BOUND_PERCENT of its size.
+ *          - "none": the data path had spare capacity.
+ *
+ *          The peaks are since the telemetry was last cleared, so -c should be used to measure a single session.
+ *
+ *          Usage: telemetry_reader -u /dev/bus/usb/<bus>/<device> [-i <interval ms>] [-n <reads>] [-c]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <endian.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/usbdevice_fs.h>
+
+#include "data_path_telemetry.h"
+
+/* Copied from vendor_requests.h, which can't be included as it depends upon usblib */
+#define VENDOR_REQUEST_GET_TELEMETRY 0x10
+#define VENDOR_REQUEST_CLEAR_TELEMETRY 0x11
+
+/** The buffer peak occupancy, as a percentage of the size, above which an interval is reported as buffering bound */
+#define BUFFERING_BOUND_PERCENT 75
+
+/** The names of the interrupt handlers in the JSON output, indexed by isr_profile_handler_t */
+static const char *const isr_names[ISR_PROFILE_NUM_HANDLERS] =
+{
+    [ISR_PROFILE_UART] = "uart",
+    [ISR_PROFILE_USB0] = "usb0",
+    [ISR_PROFILE_NHIB_TIMER] = "nhib_timer",
+    [ISR_PROFILE_USB_IN_FLUSH_TIMER] = "usb_in_flush_timer",
+    [ISR_PROFILE_DEFERRED_WORK] = "deferred_work"
+};
+
+/** The command line options */
+static const char *usbfs_path;
+static uint32_t interval_ms = 1000;
+static uint32_t num_reads = 0;
+static bool clear_first = false;
+
+
+static void usage (const char *const program)
+{
+    fprintf (stderr, "Usage: %s -u /dev/bus/usb/<bus>/<device> [-i <interval ms>] [-n <reads>] [-c]\n"
+             "  -n 0 reads until interrupted\n", program);
+    exit (EXIT_FAILURE);
+}
+
+
+static void parse_command_line (int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt (argc, argv, "u:i:n:c")) != -1)
+    {
+        switch (option)
+        {
+        case 'u':
+            usbfs_path = optarg;
+            break;
+
+        case 'i':
+            interval_ms = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'n':
+            num_reads = (uint32_t) strtoul (optarg, NULL, 0);
+            break;
+
+        case 'c':
+            clear_first = true;
+            break;
+
+        default:
+            usage (argv[0]);
+        }
+    }
+
+    if ((usbfs_path == NULL) || (optind != argc) || (interval_ms == 0))
+    {
+        usage (argv[0]);
+    }
+}
+
+
+/**
+ * @brief Send a vendor request through usbfs
+ * @return Returns the number of bytes transferred in the data stage, or -1 on error
+ */
+static int vendor_request (const int fd, const uint8_t request_type, const uint8_t request, void *const data,
+                           const uint16_t length)
+{
+    struct usbdevfs_ctrltransfer transfer =
+    {
+        .bRequestType = request_type,
+        .bRequest = request,
+        .wValue = 0,
+        .wIndex = 0,
+        .wLength = length,
+        .timeout = 1000,
+        .data = data
+    };
+
+    return ioctl (fd, USBDEVFS_CONTROL, &transfer);
+}
+
+
+/**
+ * @brief Read the telemetry block, converting the little-endian words to host order
+ */
+static void read_telemetry (const int fd, data_path_telemetry_t *const telemetry)
+{
+    uint32_t words[sizeof (*telemetry) / sizeof (uint32_t)];
+    const int length = vendor_request (fd, 0xC0, /* Device-to-host, vendor, device */
+                                       VENDOR_REQUEST_GET_TELEMETRY, words, sizeof (words));
+
+    if (length != (int) sizeof (words))
+    {
+        fprintf (stderr, "GET_TELEMETRY on %s returned %d of %zu bytes: %s\n", usbfs_path, length, sizeof (words),
+                 (length < 0) ? strerror (errno) : "short");
+        exit (EXIT_FAILURE);
+    }
+    for (size_t index = 0; index < (sizeof (words) / sizeof (words[0])); index++)
+    {
+        words[index] = le32toh (words[index]);
+    }
+    memcpy (telemetry, words, sizeof (*telemetry));
+}
+
+
+static double now_s (void)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+
+/**
+ * @return Returns the peak occupancy of a buffer as a percentage of its size
+ */
+static double peak_percent (const uint32_t peak, const uint32_t size)
+{
+    return (size > 0) ? ((100.0 * peak) / size) : 0.0;
+}
+
+
+/**
+ * @brief Write the change in the telemetry over one interval as a JSON object on one line.
+ * @details The counts wrap, so the unsigned differences are correct across a wrap.
+ */
+static void report_interval (const data_path_telemetry_t *const previous, const data_path_telemetry_t *const current,
+                             const double elapsed_s)
+{
+    const uint32_t host_to_uart_bytes = current->num_host_to_uart_bytes - previous->num_host_to_uart_bytes;
+    const uint32_t uart_to_host_bytes = current->num_uart_to_host_bytes - previous->num_uart_to_host_bytes;
+    const uint32_t flow_control_episodes = current->num_flow_control_episodes - previous->num_flow_control_episodes;
+    const uint32_t flow_control_ms = current->flow_control_asserted_ms - previous->flow_control_asserted_ms;
+    const uint32_t out_nak_episodes = current->num_out_nak_episodes - previous->num_out_nak_episodes;
+    const uint32_t uart_to_host_full_episodes =
+            current->num_uart_to_host_full_episodes - previous->num_uart_to_host_full_episodes;
+    const uint32_t ep0_stalls = current->num_ep0_stalls - previous->num_ep0_stalls;
+    const double host_to_uart_peak = peak_percent (current->host_to_uart_peak, current->host_to_uart_buffer_size);
+    const double uart_to_host_peak = peak_percent (current->uart_to_host_peak, current->uart_to_host_buffer_size);
+    const char *bound;
+
+    if (out_nak_episodes > 0)
+    {
+        bound = "uart";
+    }
+    else if ((uart_to_host_full_episodes > 0) || (flow_control_episodes > 0) || (flow_control_ms > 0))
+    {
+        bound = "usb";
+    }
+    else if ((host_to_uart_peak >= BUFFERING_BOUND_PERCENT) || (uart_to_host_peak >= BUFFERING_BOUND_PERCENT))
+    {
+        bound = "buffering";
+    }
+    else
+    {
+        bound = "none";
+    }
+
+    printf ("{\"interval_s\": %.3f, \"host_to_uart_kb_per_s\": %.1f, \"uart_to_host_kb_per_s\": %.1f, "
+            "\"host_to_uart_buffer_size\": %u, \"host_to_uart_peak_percent\": %.1f, "
+            "\"uart_to_host_buffer_size\": %u, \"uart_to_host_peak_percent\": %.1f, \"isr_calls_per_s\": {",
+            elapsed_s, host_to_uart_bytes / elapsed_s / 1e3, uart_to_host_bytes / elapsed_s / 1e3,
+            current->host_to_uart_buffer_size, host_to_uart_peak, current->uart_to_host_buffer_size,
+            uart_to_host_peak);
+    for (uint32_t handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        printf ("%s\"%s\": %.0f", (handler > 0) ? ", " : "", isr_names[handler],
+                (current->isr_counts[handler] - previous->isr_counts[handler]) / elapsed_s);
+    }
+    printf ("}, \"flow_control_episodes\": %u, \"flow_control_percent\": %.1f, \"out_nak_episodes\": %u, "
+            "\"uart_to_host_full_episodes\": %u, \"ep0_stalls\": %u, \"bound\": \"%s\"}\n",
+            flow_control_episodes, (flow_control_ms / 10.0) / elapsed_s, out_nak_episodes,
+            uart_to_host_full_episodes, ep0_stalls, bound);
+    fflush (stdout);
+}
+
+
+int main (int argc, char *argv[])
+{
+    data_path_telemetry_t previous;
+    data_path_telemetry_t current;
+    double previous_time;
+    int fd;
+
+    parse_command_line (argc, argv);
+    fd = open (usbfs_path, O_RDWR);
+    if (fd < 0)
+    {
+        fprintf (stderr, "Can't open %s: %s\n", usbfs_path, strerror (errno));
+        return EXIT_FAILURE;
+    }
+    if (clear_first && (vendor_request (fd, 0x40, /* Host-to-device, vendor, device */
+                                        VENDOR_REQUEST_CLEAR_TELEMETRY, NULL, 0) < 0))
+    {
+        fprintf (stderr, "CLEAR_TELEMETRY on %s failed: %s\n", usbfs_path, strerror (errno));
+        return EXIT_FAILURE;
+    }
+
+    read_telemetry (fd, &previous);
+    previous_time = now_s ();
+    for (uint32_t read_index = 0; (num_reads == 0) || (read_index < num_reads); read_index++)
+    {
+        double current_time;
+
+        usleep (interval_ms * 1000);
+        read_telemetry (fd, &current);
+        current_time = now_s ();
+        report_interval (&previous, &current, current_time - previous_time);
+        previous = current;
+        previous_time = current_time;
+    }
+    close (fd);
+
+    return EXIT_SUCCESS;
+}
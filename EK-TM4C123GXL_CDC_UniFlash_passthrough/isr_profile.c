@@ -0,0 +1,224 @@
+/*
+ * @file isr_profile.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Optional profiling of the interrupt handlers, using the DWT cycle counter
+ * @details
+ *  Each profiled handler calls isr_profile_entry() on entry and isr_profile_exit() on exit, which record
+ *  histograms of the entry latency and execution time into static storage. The worst case values identify
+ *  which handler causes UART overruns at high baud rates.
+ *
+ *  The number of calls to each handler is counted in all builds, for the data path telemetry.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_types.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_nvic.h>
+#include <driverlib/interrupt.h>
+
+#include "bridge_hal.h"
+#include "isr_profile.h"
+
+volatile uint32_t isr_call_counts[ISR_PROFILE_NUM_HANDLERS];
+
+#if ISR_PROFILING
+
+/** The interrupt number of each profiled handler, used to sample the pending state */
+static const uint32_t profiled_interrupts[ISR_PROFILE_NUM_HANDLERS] =
+{
+    [ISR_PROFILE_UART] = INT_UART1,
+    [ISR_PROFILE_USB0] = INT_USB0,
+    [ISR_PROFILE_NHIB_TIMER] = INT_TIMER0A,
+    [ISR_PROFILE_USB_IN_FLUSH_TIMER] = INT_TIMER1A,
+    [ISR_PROFILE_DEFERRED_WORK] = FAULT_PENDSV
+};
+
+/** The profiles being accumulated by the interrupt handlers */
+static isr_profile_t profiles[ISR_PROFILE_NUM_HANDLERS];
+
+/** A consistent copy of the profiles, which is sent to the USB host */
+static isr_profile_t profiles_snapshot[ISR_PROFILE_NUM_HANDLERS];
+
+/** The DWT cycle count on entry to each handler */
+static uint32_t entry_cycles[ISR_PROFILE_NUM_HANDLERS];
+
+/** The DWT cycle count at which each handler was first seen pending, valid when pending_seen[] is true */
+static uint32_t pending_cycles[ISR_PROFILE_NUM_HANDLERS];
+static bool pending_seen[ISR_PROFILE_NUM_HANDLERS];
+
+/**
+ * @param[in] interrupt The interrupt number to check
+ * @return Returns true if the interrupt is pending in the NVIC
+ */
+static bool interrupt_pending (const uint32_t interrupt)
+{
+    if (interrupt == FAULT_PENDSV)
+    {
+        return (HWREG (NVIC_INT_CTRL) & NVIC_INT_CTRL_PEND_SV) != 0;
+    }
+    else
+    {
+        const uint32_t irq = interrupt - 16;
+
+        return (HWREG (NVIC_PEND0 + ((irq / 32) * 4)) & (1u << (irq % 32))) != 0;
+    }
+}
+
+/**
+ * @brief Record the current cycle count for any other profiled handlers which have become pending
+ * @param[in] handler The handler which is currently running
+ * @param[in] now_cycles The current DWT cycle count
+ */
+static void sample_pending_handlers (const isr_profile_handler_t handler, const uint32_t now_cycles)
+{
+    uint32_t other;
+
+    for (other = 0; other < ISR_PROFILE_NUM_HANDLERS; other++)
+    {
+        if ((other != handler) && !pending_seen[other] && interrupt_pending (profiled_interrupts[other]))
+        {
+            pending_cycles[other] = now_cycles;
+            pending_seen[other] = true;
+        }
+    }
+}
+
+/**
+ * @brief Add a sample to a histogram
+ * @param[in,out] histogram The histogram to update
+ * @param[in,out] worst_cycles The worst case sample, updated if the sample is larger
+ * @param[in] cycles The sample to add
+ */
+static void add_sample (uint32_t histogram[ISR_PROFILE_NUM_BUCKETS], uint32_t *const worst_cycles,
+                        const uint32_t cycles)
+{
+    uint32_t bucket = 0;
+    uint32_t remaining = cycles;
+    uint32_t shift;
+
+    /* Binary search for the most significant bit set */
+    for (shift = 16; shift > 0; shift /= 2)
+    {
+        if (remaining >= (1u << shift))
+        {
+            remaining >>= shift;
+            bucket += shift;
+        }
+    }
+    if (bucket >= ISR_PROFILE_NUM_BUCKETS)
+    {
+        bucket = ISR_PROFILE_NUM_BUCKETS - 1;
+    }
+
+    histogram[bucket]++;
+    if (cycles > *worst_cycles)
+    {
+        *worst_cycles = cycles;
+    }
+}
+
+/**
+ * @brief Enable the DWT cycle counter used for profiling
+ */
+void isr_profile_init (void)
+{
+    hal_cycle_counter_enable ();
+}
+
+/**
+ * @brief Called on entry to a profiled interrupt handler, to record the entry latency when it is known
+ * @param[in] handler Which handler has been entered
+ */
+void isr_profile_entry (const isr_profile_handler_t handler)
+{
+    const uint32_t now_cycles = hal_cycle_count ();
+    isr_profile_t *const profile = &profiles[handler];
+
+    if (pending_seen[handler])
+    {
+        add_sample (profile->latency_histogram, &profile->worst_latency_cycles,
+                    now_cycles - pending_cycles[handler]);
+    }
+    else
+    {
+        /* Not seen pending by another handler, so the latency is unknown rather than zero */
+        profile->num_unsampled_entries++;
+    }
+    pending_seen[handler] = false;
+
+    entry_cycles[handler] = now_cycles;
+    isr_call_counts[handler]++;
+    profile->num_calls++;
+    sample_pending_handlers (handler, now_cycles);
+}
+
+/**
+ * @brief Called on exit from a profiled interrupt handler, to record the execution time
+ * @param[in] handler Which handler is exiting
+ */
+void isr_profile_exit (const isr_profile_handler_t handler)
+{
+    const uint32_t now_cycles = hal_cycle_count ();
+    isr_profile_t *const profile = &profiles[handler];
+
+    add_sample (profile->execution_histogram, &profile->worst_execution_cycles,
+                now_cycles - entry_cycles[handler]);
+    sample_pending_handlers (handler, now_cycles);
+}
+
+/**
+ * @brief Reset the profiles, to start a new measurement
+ */
+void isr_profile_clear (void)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+    uint32_t handler;
+    uint32_t bucket;
+
+    for (handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        profiles[handler].num_calls = 0;
+        profiles[handler].num_unsampled_entries = 0;
+        profiles[handler].worst_latency_cycles = 0;
+        profiles[handler].worst_execution_cycles = 0;
+        for (bucket = 0; bucket < ISR_PROFILE_NUM_BUCKETS; bucket++)
+        {
+            profiles[handler].latency_histogram[bucket] = 0;
+            profiles[handler].execution_histogram[bucket] = 0;
+        }
+    }
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+}
+
+/**
+ * @brief Take a consistent copy of the profiles
+ * @param[out] snapshot Set to point at the copy of the profiles, of which there is one per profiled handler
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t isr_profile_snapshot (const isr_profile_t **const snapshot)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+    uint32_t handler;
+
+    for (handler = 0; handler < ISR_PROFILE_NUM_HANDLERS; handler++)
+    {
+        profiles_snapshot[handler] = profiles[handler];
+    }
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    *snapshot = profiles_snapshot;
+    return sizeof (profiles_snapshot);
+}
+
+#endif /* ISR_PROFILING */
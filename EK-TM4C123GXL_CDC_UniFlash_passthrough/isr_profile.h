@@ -0,0 +1,68 @@
+/*
+ * @file isr_profile.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Optional profiling of the interrupt handlers, using the DWT cycle counter
+ */
+
+#ifndef ISR_PROFILE_H_
+#define ISR_PROFILE_H_
+
+/** When non-zero the interrupt handlers record entry latency and execution time histograms,
+ *  which may be read using VENDOR_REQUEST_GET_ISR_PROFILE */
+#ifndef ISR_PROFILING
+#define ISR_PROFILING 0
+#endif
+
+/** Identifies the interrupt handlers which are profiled */
+typedef enum
+{
+    ISR_PROFILE_UART,
+    ISR_PROFILE_USB0,
+    ISR_PROFILE_NHIB_TIMER,
+    ISR_PROFILE_USB_IN_FLUSH_TIMER,
+    ISR_PROFILE_DEFERRED_WORK,
+    ISR_PROFILE_NUM_HANDLERS
+} isr_profile_handler_t;
+
+/* The number of buckets in each histogram.
+   Bucket 0 counts samples of 0 or 1 CPU cycles, and bucket N counts samples of [2^N, 2^(N+1)) CPU cycles,
+   with the final bucket also counting all larger samples. */
+#define ISR_PROFILE_NUM_BUCKETS 24
+
+/** The profile for one interrupt handler, which is sent to the USB host as little-endian 32-bit words.
+ *  The entry latency is measured from when the interrupt was first seen pending. The pending state is only
+ *  sampled on entry to and exit from the other profiled handlers, and so is a lower bound for the time spent
+ *  waiting behind another handler. Calls for which the handler wasn't seen pending have no latency sample. */
+typedef struct
+{
+    /** The number of times the handler has been called */
+    uint32_t num_calls;
+    /** The number of calls with no entry latency sample, which aren't counted in latency_histogram */
+    uint32_t num_unsampled_entries;
+    /** The worst case entry latency in CPU cycles */
+    uint32_t worst_latency_cycles;
+    /** The worst case execution time in CPU cycles, including time pre-empted by higher priority handlers */
+    uint32_t worst_execution_cycles;
+    uint32_t latency_histogram[ISR_PROFILE_NUM_BUCKETS];
+    uint32_t execution_histogram[ISR_PROFILE_NUM_BUCKETS];
+} isr_profile_t;
+
+/** The number of times each handler has been called, which is counted whether or not ISR_PROFILING is enabled */
+extern volatile uint32_t isr_call_counts[ISR_PROFILE_NUM_HANDLERS];
+
+#if ISR_PROFILING
+#define ISR_PROFILE_ENTRY(handler) isr_profile_entry (handler)
+#define ISR_PROFILE_EXIT(handler) isr_profile_exit (handler)
+#else
+#define ISR_PROFILE_ENTRY(handler) (isr_call_counts[handler]++)
+#define ISR_PROFILE_EXIT(handler)
+#endif
+
+void isr_profile_init (void);
+void isr_profile_entry (const isr_profile_handler_t handler);
+void isr_profile_exit (const isr_profile_handler_t handler);
+void isr_profile_clear (void);
+uint32_t isr_profile_snapshot (const isr_profile_t **const snapshot);
+
+#endif /* ISR_PROFILE_H_ */
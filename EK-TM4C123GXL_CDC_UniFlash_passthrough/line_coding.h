@@ -0,0 +1,39 @@
+/*
+ * @file line_coding.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Reporting the progress of line coding changes requested by the USB host
+ */
+
+#ifndef LINE_CODING_H_
+#define LINE_CODING_H_
+
+/** The state of the most recent line coding change requested by the USB host */
+typedef enum
+{
+    /** The requested line coding has been applied to the UART */
+    LINE_CODING_CHANGE_APPLIED,
+    /** Waiting for the data queued before the request to be transmitted at the old line coding */
+    LINE_CODING_CHANGE_PENDING,
+    /** The requested line coding was invalid, so the UART configuration was left unchanged */
+    LINE_CODING_CHANGE_REJECTED
+} line_coding_change_state_t;
+
+/** The progress of line coding changes, which is sent to the USB host as little-endian 32-bit words.
+ *  After a SET_LINE_CODING the host should wait for the state to leave LINE_CODING_CHANGE_PENDING before
+ *  sending data which the CC3100BOOST will receive at the new line coding. */
+typedef struct
+{
+    /** A line_coding_change_state_t */
+    uint32_t state;
+    /** The number of line coding changes applied since power-up */
+    uint32_t num_applied;
+    /** The number of line coding changes rejected since power-up */
+    uint32_t num_rejected;
+} line_coding_change_status_t;
+
+void line_coding_change_requested (void);
+uint32_t line_coding_change_status_get (line_coding_change_status_t *const status);
+bool line_coding_to_uart_config (const tLineCoding *const line_coding, uint32_t *const config);
+
+#endif /* LINE_CODING_H_ */
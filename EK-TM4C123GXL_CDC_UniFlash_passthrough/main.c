@@ -11,6 +11,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <inc/hw_gpio.h>
 #include <inc/hw_uart.h>
 #include <inc/hw_ints.h>
 #include <driverlib/pin_map.h>
@@ -21,34 +23,110 @@
 #include <driverlib/rom.h>
 #include <driverlib/rom_map.h>
 #include <driverlib/cpu.h>
-#include <driverlib/systick.h>
+#include <driverlib/timer.h>
 #include <driverlib/interrupt.h>
+#include <driverlib/usb.h>
 #include <usblib/usblib.h>
 #include <usblib/usbcdc.h>
 #include <usblib/device/usbdevice.h>
 #include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
 
 #include "usb_serial_structs.h"
-
-/** When true the nHIB has been asserted following the break being asserted.
- *  When the timer expires the nHIB is de-asserted.
- */
-static volatile bool nHIB_timer_running;
-
-/** Millisecond count-down for timing now long to assert nHIB */
-static volatile uint32_t nHIB_timer_ms;
+#include "bridge_hal.h"
+#include "check_assert.h"
+#include "uart_dma.h"
+#include "isr_profile.h"
+#include "uart_line_errors.h"
+#include "vendor_requests.h"
+#include "line_coding.h"
+#include "uart_flow_control.h"
+#include "usb_in_flush.h"
+#include "uart_fifo_levels.h"
+#include "spi_passthrough.h"
+#include "usb_data_endpoints.h"
+#include "usb_data_path.h"
+#include "uart_buffer_arena.h"
+#include "data_path_telemetry.h"
+#include "traffic_capture.h"
+#include "cc3100_sequence.h"
+#include "uart_channels.h"
+#include "cc3100_programmer.h"
+
+/* The maximum error between the requested baud rate and that generated by the UART, in parts per million */
+#define UART_BAUD_TOLERANCE_PPM 20000
+
+/* The maximum value of the integer part of the UART baud rate divisor */
+#define UART_MAX_IBRD 0xFFFF
+
+/** The peripherals used, which are left clocked when the CPU sleeps waiting for an interrupt */
+static const uint32_t sleep_peripherals[] =
+{
+    SYSCTL_PERIPH_GPIOB,
+    SYSCTL_PERIPH_GPIOC,
+    SYSCTL_PERIPH_GPIOD,
+    SYSCTL_PERIPH_GPIOE,
+    SYSCTL_PERIPH_GPIOF,
+    SYSCTL_PERIPH_UART1,
+    SYSCTL_PERIPH_UDMA,
+    SYSCTL_PERIPH_USB0,
+    SYSCTL_PERIPH_TIMER0,
+    SYSCTL_PERIPH_TIMER1,
+#if TRAFFIC_CAPTURE
+    SYSCTL_PERIPH_WTIMER0,
+#endif
+#if SPI_PASSTHROUGH
+    SYSCTL_PERIPH_SSI2
+#endif
+};
+
+/** When true the USB host has suspended the bus, and so the device enters deep sleep when idle */
+static volatile bool usb_suspended;
+
+/** The UART line coding set at power-up */
+static const tLineCoding default_line_coding =
+{
+    115200,
+    USB_CDC_STOP_BITS_1,
+    USB_CDC_PARITY_NONE,
+    8
+};
+
+/** The line coding and control line state of one UART channel */
+typedef struct
+{
+    /** The line coding which has been applied to the UART, returned to the USB host on a GET_LINE_CODING request */
+    tLineCoding applied_line_coding;
+    /** When true the USB host has requested a line coding change, which is applied once the data queued before
+     *  the request has been transmitted at the old line coding */
+    bool line_coding_change_pending;
+    /** The line coding requested by the USB host, valid when line_coding_change_pending is true */
+    tLineCoding pending_line_coding;
+    /** While line_coding_change_pending is true, the number of bytes which were queued in the host_to_uart ring
+     *  when the change was requested which have yet to be written to the UART transmit FIFO */
+    uint32_t line_coding_drain_count;
+    /** The progress of line coding changes, reported to the USB host for channel 0 */
+    line_coding_change_status_t line_coding_change_status;
+    /** The last DTR state set by the USB host, used to detect the start of a session */
+    bool dte_present;
+} channel_line_state_t;
+
+static channel_line_state_t channel_line_states[UART_NUM_CHANNELS];
+
+static bool set_line_coding (const uart_channel_t *const channel, const tLineCoding *const line_coding);
 
 /**
  * @brief If a program assertion fails, light only the red LED and halt
  * @param[in] assertion Value which must be true to allow program execution to continue
  */
-static void check_assert (const bool assertion)
+void check_assert (const bool assertion)
 {
     if (!assertion)
     {
         SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOF);
-        GPIOPinTypeGPIOOutput (GPIO_PORTF_BASE, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
-        GPIOPinWrite (GPIO_PORTF_BASE, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3, GPIO_PIN_1);
+        GPIOPinTypeGPIOOutput (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN);
+        hal_gpio_pin_write (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN, LED_RED);
 
         for (;;)
         {
@@ -58,73 +136,187 @@ static void check_assert (const bool assertion)
 }
 
 /**
- * @brief Deassert the nHIB signal to the CC3100BOOST
+ * @brief Read as many characters from the UART FIFO as we can and move them into the uart_to_host ring.
+ * @details Characters received with an error are discarded.
+ *          The characters are written directly into the contiguous spans of free space in the uart_to_host ring,
+ *          and committed to be passed to the USB stack by the deferred work handler.
+ * @param[in] channel The channel to read the UART of
+ * @return Returns UART error flags read during receiption, as UART_INT_OE, UART_INT_BE, UART_INT_PE and
+ *         UART_INT_FE flags
  */
-static void deassert_nHIB (void)
+static uint32_t read_uart_data (const uart_channel_t *const channel)
 {
-    GPIOPinWrite (GPIO_PORTE_BASE, GPIO_PIN_4, GPIO_PIN_4);
+    uint8_t *span;
+    uint32_t span_length;
+    uint32_t rx_error_flags;
+    int32_t rx_data;
+    uint32_t num_written;
+    uint32_t total_written;
+    uint32_t span_index;
+
+    /* Read data from the UART FIFO until there is none left or we run out of space in our receive buffer.
+     * The free space can wrap the end of the ring, so fill up to two spans. */
+    rx_error_flags = 0;
+    total_written = 0;
+    for (span_index = 0; span_index < 2; span_index++)
+    {
+        span = spsc_ring_write_span (channel->uart_to_host, &span_length);
+        num_written = 0;
+        while ((num_written < span_length) && hal_uart_chars_avail (channel->uart_base))
+        {
+            rx_data = hal_uart_char_get_non_blocking (channel->uart_base);
+
+            if ((rx_data & UART_DR_ERRORS) == 0)
+            {
+                /* The character didn't contain any error notifications, so copy it to the output buffer */
+                span[num_written] = (uint8_t) rx_data;
+                num_written++;
+            }
+            else
+            {
+                /* Update our error accumulator. */
+                rx_error_flags |= rx_data;
+            }
+        }
+
+        usb_data_path_tx_produced (channel, num_written);
+        total_written += num_written;
+        if (num_written < span_length)
+        {
+            break;
+        }
+    }
+
+    uart_fifo_levels_count_rx (channel, total_written);
+
+    /* Convert the per-character error flags to the equivalent UART interrupt flags */
+    return ((rx_error_flags & UART_DR_OE) ? UART_INT_OE : 0) |
+           ((rx_error_flags & UART_DR_BE) ? UART_INT_BE : 0) |
+           ((rx_error_flags & UART_DR_PE) ? UART_INT_PE : 0) |
+           ((rx_error_flags & UART_DR_FE) ? UART_INT_FE : 0);
 }
 
+#if !UART_TX_USE_UDMA
 /**
- * @brief Assert the nHIB signal to the CC3100BOOST
+ * @brief Write as many characters from the host_to_uart ring into the UART transmit FIFO as it has space for.
+ * @details The characters are written directly from the contiguous span at the read position of the host_to_uart
+ *          ring, without copying. The UART transmit interrupt is enabled while there is data left to send.
+ * @param[in] channel The channel to write to the UART of
+ * @param[in] max_length The maximum number of characters to write, used to stop at a line coding change
+ * @return Returns the number of characters written to the UART transmit FIFO
  */
-static void assert_nHIB (void)
+static uint32_t fill_uart_tx_fifo (const uart_channel_t *const channel, const uint32_t max_length)
 {
-    GPIOPinWrite (GPIO_PORTE_BASE, GPIO_PIN_4, 0);
+    const uint8_t *span;
+    uint32_t num_contiguous;
+    uint32_t num_written;
+
+    span = spsc_ring_read_span (channel->host_to_uart, &num_contiguous);
+    if (num_contiguous > max_length)
+    {
+        num_contiguous = max_length;
+    }
+    num_written = 0;
+    while ((num_written < num_contiguous) && hal_uart_char_put_non_blocking (channel->uart_base, span[num_written]))
+    {
+        num_written++;
+    }
+
+    if (num_written > 0)
+    {
+        usb_data_path_rx_consumed (channel, num_written);
+    }
+
+    if (spsc_ring_used (channel->host_to_uart) > 0)
+    {
+        hal_uart_int_enable (channel->uart_base, UART_INT_TX);
+    }
+    else
+    {
+        hal_uart_int_disable (channel->uart_base, UART_INT_TX);
+    }
+
+    return num_written;
 }
+#endif
 
 /**
- * @brief Interrupt handler for Sys Tick which de-asserts nHIB after the timer expires
+ * @brief Transmit data from the host_to_uart ring on the UART, up to any pending line coding change
+ * @param[in] channel The channel to transmit on
  */
-void sys_tick_handler (void)
+static void transmit_uart_data (const uart_channel_t *const channel)
 {
-    if (nHIB_timer_running)
+    channel_line_state_t *const state = &channel_line_states[channel->index];
+    const uint32_t max_length = state->line_coding_change_pending ? state->line_coding_drain_count : UINT32_MAX;
+    uint32_t num_transmitted;
+
+#if UART_TX_USE_UDMA
+    /* Handle transmit uDMA completion, or the handler being triggered by data being received from the USB host */
+    num_transmitted = uart_tx_dma_complete (channel);
+    uart_tx_dma_start (channel, max_length - num_transmitted);
+#else
+    /* Refill the UART TX FIFO, either when the transmit interrupt indicates there is space available or the
+     * handler has been triggered by data being received from the USB host.
+     * The UART TX FIFO can hold a contiguous span which wraps the end of the host_to_uart ring, so fill twice. */
+    num_transmitted = fill_uart_tx_fifo (channel, max_length);
+    num_transmitted += fill_uart_tx_fifo (channel, max_length - num_transmitted);
+#endif
+
+    uart_fifo_levels_count_tx (channel, num_transmitted);
+    if (state->line_coding_change_pending)
     {
-        if (nHIB_timer_ms == 0)
-        {
-            nHIB_timer_running = false;
-            deassert_nHIB ();
-        }
-        else
-        {
-            nHIB_timer_ms--;
-        }
+        state->line_coding_drain_count -= num_transmitted;
     }
 }
 
 /**
- * @brief Read as many characters from the UART FIFO as we can and move them into the CDC transmit buffer.
- * @return Returns UART error flags read during receiption
+ * @brief Apply a pending line coding change, once the data queued before the change was requested has been sent
+ * @details The transmit interrupt is switched to end-of-transmission mode to wait for the last character queued
+ *          at the old line coding to leave the transmit shift register. The receiver is then quiesced by reading
+ *          the characters already received at the old line coding, before the UART is reconfigured which flushes
+ *          its FIFOs.
+ * @param[in] channel The channel to apply the change to
+ * @return Returns the UART error flags for the characters read while quiescing the receiver
  */
-static uint32_t read_uart_data (void)
+static uint32_t complete_line_coding_change (const uart_channel_t *const channel)
 {
-    uint32_t usb_available_space;
-    uint32_t rx_error_flags;
-    int32_t rx_data;
-    uint8_t rx_character;
-    uint32_t num_written;
+    channel_line_state_t *const state = &channel_line_states[channel->index];
+    uint32_t rx_error_flags = 0;
 
-    /* Find the available space to store characters in the USB buffer*/
-    usb_available_space = USBBufferSpaceAvailable (&cdc_tx_buffer);
-
-    /* Read data from the UART FIFO until there is none left or we run out of space in our receive buffer. */
-    rx_error_flags = 0;
-    while ((usb_available_space > 0) && UARTCharsAvail (UART1_BASE))
+    if (state->line_coding_change_pending && (state->line_coding_drain_count == 0))
     {
-        rx_data = UARTCharGetNonBlocking (UART1_BASE);
-
-        if ((rx_data & UART_DR_DATA_M) == 0)
+        /* Enable the end-of-transmission interrupt before checking if the transmitter is busy, so that the
+         * transmitter going idle can't be missed */
+        hal_uart_tx_int_mode_set (channel->uart_base, UART_TXINT_MODE_EOT);
+        hal_uart_int_enable (channel->uart_base, UART_INT_TX);
+        if (!hal_uart_busy (channel->uart_base))
         {
-            /* The character didn't contain any error notifications, so copy it to the output buffer */
-            rx_character = (uint8_t) rx_data;
-            num_written = USBBufferWrite (&cdc_tx_buffer, &rx_character, 1);
-            check_assert (num_written == 1);
-            usb_available_space--;
-        }
-        else
-        {
-            /* Update our error accumulator. */
-            rx_error_flags |= rx_data;
+#if UART_RX_USE_UDMA
+            uart_rx_dma_stop (channel);
+#endif
+            rx_error_flags = read_uart_data (channel);
+
+            if (set_line_coding (channel, &state->pending_line_coding))
+            {
+                state->line_coding_change_status.state = LINE_CODING_CHANGE_APPLIED;
+                state->line_coding_change_status.num_applied++;
+            }
+            else
+            {
+                state->line_coding_change_status.state = LINE_CODING_CHANGE_REJECTED;
+                state->line_coding_change_status.num_rejected++;
+            }
+            state->line_coding_change_pending = false;
+            uart_fifo_levels_apply (channel);
+
+#if UART_RX_USE_UDMA
+            uart_rx_dma_start (channel);
+#endif
+
+            /* Resume transmitting the data queued since the change was requested */
+            hal_uart_tx_int_mode_set (channel->uart_base, UART_TXINT_MODE_FIFO);
+            hal_uart_int_disable (channel->uart_base, UART_INT_TX);
+            transmit_uart_data (channel);
         }
     }
 
@@ -132,53 +324,176 @@ static uint32_t read_uart_data (void)
 }
 
 /**
- * @brief UART interrupt handler, to handle re-direction between USB and the CC3100BOOST
+ * @brief Handle an interrupt from the UART of a channel, to handle re-direction between USB and the CC3100
+ * @param[in] channel The channel whose UART interrupted
  */
-void uart_interrupt_handler (void)
+void uart_channel_interrupt_handler (const uart_channel_t *const channel)
 {
     uint32_t active_interrupts;
     uint32_t rx_error_flags;
+    bool flush_rx;
+
+    uart_fifo_levels_count_interrupt (channel);
 
     /* Get and clear the current interrupt source(s) */
-    active_interrupts = UARTIntStatus (UART1_BASE, true);
-    UARTIntClear (UART1_BASE, active_interrupts);
+    active_interrupts = hal_uart_int_status (channel->uart_base);
+    hal_uart_int_clear (channel->uart_base, active_interrupts);
+    rx_error_flags = active_interrupts & (UART_INT_OE | UART_INT_BE | UART_INT_PE | UART_INT_FE);
+
+    transmit_uart_data (channel);
 
-    /* Are we being interrupted because the UART TX FIFO has space available */
-    if (active_interrupts & UART_INT_TX)
+#if UART_RX_USE_UDMA
+    /* Handle receive uDMA completion, which doesn't have a UART interrupt status bit */
+    uart_rx_dma_complete (channel);
+
+    /* A receive timeout indicates the CC3100 has stopped transmitting. Unless the flush policy defers passing
+     * the characters received to the USB stack, read the characters left in the UART FIFO and restart the uDMA.
+     * Also restart the uDMA if it has stopped due to no free space in the uart_to_host ring. */
+    flush_rx = usb_in_flush_due (channel);
+    if (active_interrupts & UART_INT_RT)
     {
-        /* If the output buffer is empty, turn off the transmit interrupt. */
-        if(USBBufferDataAvailable (&cdc_rx_buffer) == 0)
+        uart_fifo_levels_burst_end (channel);
+        if (usb_in_flush_defer (channel))
         {
-            UARTIntDisable (UART1_BASE, UART_INT_TX);
+            hal_uart_int_disable (channel->uart_base, UART_INT_RT);
         }
+        else
+        {
+            flush_rx = true;
+        }
+    }
+    if (flush_rx || !uart_rx_dma_running (channel))
+    {
+        uart_rx_dma_stop (channel);
+        rx_error_flags |= read_uart_data (channel);
+        uart_fifo_levels_apply (channel);
+        uart_rx_dma_start (channel);
+    }
+#else
+    /* A receive timeout indicates the CC3100 has stopped transmitting. If the flush policy defers passing the
+     * characters left in the UART FIFO to the USB stack, mask the receive timeout until the latency expires. */
+    flush_rx = usb_in_flush_due (channel);
+    if (flush_rx)
+    {
+        hal_uart_int_enable (channel->uart_base, UART_INT_RT);
+    }
+    if (active_interrupts & UART_INT_RT)
+    {
+        uart_fifo_levels_burst_end (channel);
+    }
+    if ((active_interrupts & UART_INT_RT) && usb_in_flush_defer (channel))
+    {
+        hal_uart_int_disable (channel->uart_base, UART_INT_RT);
+        active_interrupts &= ~UART_INT_RT;
     }
 
     /* Handle receive interrupts */
-    if (active_interrupts & (UART_INT_OE | UART_INT_BE | UART_INT_PE |
-                             UART_INT_FE | UART_INT_RT | UART_INT_RX))
+    if (flush_rx || (active_interrupts & (UART_INT_OE | UART_INT_BE | UART_INT_PE |
+                                          UART_INT_FE | UART_INT_RT | UART_INT_RX)))
     {
         /* Read the UART's characters into the buffer. */
-        rx_error_flags = read_uart_data ();
+        rx_error_flags |= read_uart_data (channel);
     }
+    uart_fifo_levels_apply (channel);
+#endif
+
+    rx_error_flags |= complete_line_coding_change (channel);
+
+    /* Throttle the CC3100 if the received characters have nearly filled the uart_to_host ring */
+    uart_flow_control_update (channel);
+
+    /* Report any line errors, either signalled by an interrupt or found on the characters read */
+    uart_line_errors_report (channel, rx_error_flags);
+}
+
+/**
+ * @brief UART interrupt handler for channel 0, the CC3100BOOST
+ */
+void uart_interrupt_handler (void)
+{
+    ISR_PROFILE_ENTRY (ISR_PROFILE_UART);
+    uart_channel_interrupt_handler (&uart_channels[UART_CHANNEL_CC3100]);
+    ISR_PROFILE_EXIT (ISR_PROFILE_UART);
+}
+
+#if UART_EXTRA_CHANNELS
+/**
+ * @brief UART interrupt handlers for the extra channels
+ */
+void uart_channel_1_interrupt_handler (void)
+{
+    uart_channel_interrupt_handler (&uart_channels[1]);
+}
+
+#if UART_EXTRA_CHANNELS > 1
+void uart_channel_2_interrupt_handler (void)
+{
+    uart_channel_interrupt_handler (&uart_channels[2]);
+}
+#endif
+#endif /* UART_EXTRA_CHANNELS */
+
+/**
+ * @brief USB interrupt handler, which calls the usblib handler.
+ * @details Installed in the vector table in place of the usblib handler, to allow the usblib handler to be profiled.
+ */
+void usb_interrupt_handler (void)
+{
+    ISR_PROFILE_ENTRY (ISR_PROFILE_USB0);
+    USB0DeviceIntHandler ();
+    ISR_PROFILE_EXIT (ISR_PROFILE_USB0);
+}
+
+/**
+ * @brief Deferred work handler, which performs the USB stack operations requested by the UART interrupt handler
+ * @details Installed as the PendSV handler, at the USB interrupt priority so that the non re-entrant usblib
+ *          functions aren't called concurrently with the USB interrupt handler.
+ */
+void deferred_work_handler (void)
+{
+    ISR_PROFILE_ENTRY (ISR_PROFILE_DEFERRED_WORK);
+    usb_data_path_service ();
+    uart_buffer_arena_service ();
+    uart_line_errors_notify ();
+    ISR_PROFILE_EXIT (ISR_PROFILE_DEFERRED_WORK);
 }
 
 /**
  * @brief Handles CDC driver notifications related to the receive channel (data from the USB host).
+ * @details pvCBData is the uart_channel_t of the device.
  */
 uint32_t cdc_rx_handler(void *pvCBData, uint32_t ui32Event,
                         uint32_t ui32MsgValue, void *pvMsgData)
 {
+    const uart_channel_t *const channel = pvCBData;
     uint32_t return_value;
 
     switch (ui32Event)
     {
+    case USB_EVENT_RX_AVAILABLE:
+        /* Data from the USB host has been placed in the host_to_uart ring.
+         * Trigger the UART interrupt handler to start transmitting it, so that the host_to_uart ring
+         * is only read from the one interrupt handler. */
+        hal_uart_int_trigger (channel->uart_int);
+        return_value = 0;
+        break;
+
     case USB_EVENT_DATA_REMAINING:
         /* We are being asked how much unprocessed data we have still to
            process. We return 0 if the UART is currently idle or 1 if it is
            in the process of transmitting something. The actual number of
            bytes in the UART FIFO is not important here, merely whether or
            not everything previously sent to us has been transmitted. */
-        return_value = UARTBusy (UART1_BASE) ? 1 : 0;
+        return_value = hal_uart_busy (channel->uart_base) ? 1 : 0;
+        break;
+
+    case USB_EVENT_CONNECTED:
+    case USB_EVENT_DISCONNECTED:
+    case USB_EVENT_SUSPEND:
+    case USB_EVENT_RESUME:
+        /* The raw bulk UART device has no control callback, and signals the connection state on the receive
+         * channel instead. Handle the events in the same way as for the CDC device. */
+        return_value = cdc_control_handler (pvCBData, ui32Event, ui32MsgValue, pvMsgData);
         break;
 
     default:
@@ -188,13 +503,33 @@ uint32_t cdc_rx_handler(void *pvCBData, uint32_t ui32Event,
     return return_value;
 }
 
+/**
+ * @brief Handles CDC driver notifications related to the transmit channel (data to the USB host).
+ * @details pvCBData is the uart_channel_t of the device.
+ */
 uint32_t cdc_tx_handler(void *pvCBData, uint32_t ui32Event,
                         uint32_t ui32MsgValue, void *pvMsgData)
 {
+    const uart_channel_t *const channel = pvCBData;
+
     switch (ui32Event)
     {
     case USB_EVENT_TX_COMPLETE:
-        /* Since we are using the USBBuffer, we don't need to do anything here. */
+        /* The USB host has read data. If the CC3100 has been throttled trigger the UART interrupt handler to
+         * un-throttle it, since the flow control state is only changed by the UART interrupt handler. */
+        if (uart_flow_control_throttled (channel))
+        {
+            hal_uart_int_trigger (channel->uart_int);
+        }
+#if UART_RX_USE_UDMA
+        /* If the UART receive uDMA has stopped due to the uart_to_host ring being full, trigger
+         * the UART interrupt handler to restart it now that the USB host has read data. */
+        if (!uart_rx_dma_running (channel))
+        {
+            hal_uart_int_trigger (channel->uart_int);
+        }
+#endif
+        /* Otherwise, since the data path sends the next packet, we don't need to do anything here. */
         break;
 
     default:
@@ -206,111 +541,86 @@ uint32_t cdc_tx_handler(void *pvCBData, uint32_t ui32Event,
 }
 
 /**
- * @brief Get the current line coding for the UART
- * @param[out] line_coding Current values read from the UART, in the CDC format
+ * @brief Get the current line coding for the UART of a channel
+ * @details Returns the line coding cached when it was applied, rather than reading back the UART configuration
+ * @param[in] channel The channel to get the line coding for
+ * @param[out] line_coding Current values applied to the UART, in the CDC format
  */
-static void get_line_coding (tLineCoding *const line_coding)
+static void get_line_coding (const uart_channel_t *const channel, tLineCoding *const line_coding)
 {
-    uint32_t baud;
-    uint32_t config;
-
-    UARTConfigGetExpClk (UART1_BASE, MAP_SysCtlClockGet(), &baud, &config);
-    line_coding->ui32Rate = baud;
-
-    switch (config & UART_CONFIG_STOP_MASK)
-    {
-    case UART_CONFIG_STOP_ONE:
-        line_coding->ui8Stop = USB_CDC_STOP_BITS_1;
-        break;
-
-    case UART_CONFIG_STOP_TWO:
-        line_coding->ui8Stop = USB_CDC_STOP_BITS_2;
-        break;
-
-    default:
-        check_assert (false);
-        break;
-    }
+    *line_coding = channel_line_states[channel->index].applied_line_coding;
+}
 
-    switch (config & UART_CONFIG_PAR_MASK)
+/**
+ * @brief Check that the UART can generate a baud rate within tolerance of that requested
+ * @details Uses the same divisor calculation as UARTConfigSetExpClk(), which selects the high-speed (HSE)
+ *          clock divisor of 8 rather than 16 for baud rates above the UART clock / 16.
+ * @param[in] baud The requested baud rate
+ * @return Returns true if the baud rate can be generated by the UART
+ */
+static bool baud_rate_valid (const uint32_t baud)
+{
+    const uint32_t uart_clock = hal_system_clock_hz ();
+    bool valid = false;
+    uint32_t divisor_baud;
+    uint32_t clock_divider;
+    uint32_t divisor;
+    uint64_t actual_baud;
+    uint64_t error_ppm;
+
+    if ((baud > 0) && (baud <= (uart_clock / 8)))
     {
-    case UART_CONFIG_PAR_NONE:
-        line_coding->ui8Parity = USB_CDC_PARITY_NONE;
-        break;
-
-    case UART_CONFIG_PAR_EVEN:
-        line_coding->ui8Parity = USB_CDC_PARITY_EVEN;
-        break;
-
-    case UART_CONFIG_PAR_ODD:
-        line_coding->ui8Parity = USB_CDC_PARITY_ODD;
-        break;
-
-    case UART_CONFIG_PAR_ONE:
-        line_coding->ui8Parity = USB_CDC_PARITY_MARK;
-        break;
-
-    case UART_CONFIG_PAR_ZERO:
-        line_coding->ui8Parity = USB_CDC_PARITY_SPACE;
-        break;
+        if ((baud * 16) > uart_clock)
+        {
+            divisor_baud = baud / 2;
+            clock_divider = 8;
+        }
+        else
+        {
+            divisor_baud = baud;
+            clock_divider = 16;
+        }
 
-    default:
-        check_assert (false);
-        break;
+        /* The divisor is in units of 1/64, to give the IBRD integer part and FBRD fractional part */
+        divisor = (((uart_clock * 8) / divisor_baud) + 1) / 2;
+        if ((divisor >= 64) && ((divisor / 64) <= UART_MAX_IBRD))
+        {
+            actual_baud = ((uint64_t) uart_clock * 64) / ((uint64_t) clock_divider * divisor);
+            error_ppm = (((actual_baud > baud) ? (actual_baud - baud) : (baud - actual_baud)) * 1000000) / baud;
+            valid = error_ppm <= UART_BAUD_TOLERANCE_PPM;
+        }
     }
 
-    switch (config & UART_CONFIG_WLEN_MASK)
-    {
-    case UART_CONFIG_WLEN_5:
-        line_coding->ui8Databits = 5;
-        break;
-
-    case UART_CONFIG_WLEN_6:
-        line_coding->ui8Databits = 6;
-        break;
-
-    case UART_CONFIG_WLEN_7:
-        line_coding->ui8Databits = 7;
-        break;
-
-    case UART_CONFIG_WLEN_8:
-        line_coding->ui8Databits = 8;
-        break;
-
-    default:
-        check_assert (false);
-        break;
-    }
+    return valid;
 }
 
 /**
- * @brief Set the line coding for the UART
- * @todo If the line coding is invalid, the UART configuration is not changed.
- *       Unsure if can report the error to the USB bus.
- *       The Control Callback has a return value, which is always ignored by the USB stack.
- * @param[in] line_coding The values to set, in CDC format
+ * @brief Convert a line coding to the UART configuration
+ * @param[in] line_coding The values to convert, in CDC format
+ * @param[out] config The UART_CONFIG_ flags for UARTConfigSetExpClk()
+ * @return Returns true if the line coding is valid, and the baud rate can be generated within tolerance
  */
-static void set_line_coding (const tLineCoding *const line_coding)
+bool line_coding_to_uart_config (const tLineCoding *const line_coding, uint32_t *const config)
 {
-    bool config_valid = true;
-    uint32_t config = 0;
+    bool config_valid = baud_rate_valid (line_coding->ui32Rate);
 
+    *config = 0;
     switch (line_coding->ui8Databits)
     {
     case 5:
-        config |= UART_CONFIG_WLEN_5;
+        *config |= UART_CONFIG_WLEN_5;
         break;
 
     case 6:
-        config |= UART_CONFIG_WLEN_6;
+        *config |= UART_CONFIG_WLEN_6;
         break;
 
     case 7:
-        config |= UART_CONFIG_WLEN_7;
+        *config |= UART_CONFIG_WLEN_7;
         break;
 
     case 8:
-        config |= UART_CONFIG_WLEN_8;
+        *config |= UART_CONFIG_WLEN_8;
         break;
 
     default:
@@ -321,23 +631,23 @@ static void set_line_coding (const tLineCoding *const line_coding)
     switch (line_coding->ui8Parity)
     {
     case USB_CDC_PARITY_NONE:
-        config |= UART_CONFIG_PAR_NONE;
+        *config |= UART_CONFIG_PAR_NONE;
         break;
 
     case USB_CDC_PARITY_EVEN:
-        config |= UART_CONFIG_PAR_EVEN;
+        *config |= UART_CONFIG_PAR_EVEN;
         break;
 
     case USB_CDC_PARITY_ODD:
-        config |= UART_CONFIG_PAR_ODD;
+        *config |= UART_CONFIG_PAR_ODD;
         break;
 
     case USB_CDC_PARITY_MARK:
-        config |= UART_CONFIG_PAR_ONE;
+        *config |= UART_CONFIG_PAR_ONE;
         break;
 
     case USB_CDC_PARITY_SPACE:
-        config |= UART_CONFIG_PAR_ZERO;
+        *config |= UART_CONFIG_PAR_ZERO;
         break;
 
     default:
@@ -348,11 +658,11 @@ static void set_line_coding (const tLineCoding *const line_coding)
     switch (line_coding->ui8Stop)
     {
     case USB_CDC_STOP_BITS_1:
-        config|= UART_CONFIG_STOP_ONE;
+        *config |= UART_CONFIG_STOP_ONE;
         break;
 
     case USB_CDC_STOP_BITS_2:
-        config |= UART_CONFIG_STOP_TWO;
+        *config |= UART_CONFIG_STOP_TWO;
         break;
 
     default:
@@ -360,93 +670,202 @@ static void set_line_coding (const tLineCoding *const line_coding)
         break;
     }
 
+    return config_valid;
+}
+
+/**
+ * @brief Set the line coding for the UART of a channel
+ * @details If the line coding is invalid, or the baud rate can't be generated within tolerance, the UART
+ *          configuration is not changed. The Control Callback has a return value, which is always ignored by the
+ *          USB stack, so the error is reported to the USB host by VENDOR_REQUEST_GET_LINE_CODING_STATUS or by
+ *          the host reading back the line coding.
+ * @param[in] channel The channel to set the line coding for
+ * @param[in] line_coding The values to set, in CDC format
+ * @return Returns true if the line coding was applied
+ */
+static bool set_line_coding (const uart_channel_t *const channel, const tLineCoding *const line_coding)
+{
+    channel_line_state_t *const state = &channel_line_states[channel->index];
+    uint32_t config;
+    const bool config_valid = line_coding_to_uart_config (line_coding, &config);
+    uint32_t bits_per_char;
+
     if (config_valid)
     {
-        UARTConfigSetExpClk (UART1_BASE, MAP_SysCtlClockGet(), line_coding->ui8Databits, config);
+        hal_uart_config_set (channel->uart_base, line_coding->ui32Rate, config);
+        state->applied_line_coding = *line_coding;
+        if (channel->index == UART_CHANNEL_CC3100)
+        {
+            TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_LINE_CODING, &state->applied_line_coding,
+                                  sizeof (state->applied_line_coding));
+        }
+
+        /* Choose the FIFO trigger levels for the time taken by each character, including the start bit */
+        bits_per_char = 1 + line_coding->ui8Databits +
+                ((line_coding->ui8Parity != USB_CDC_PARITY_NONE) ? 1 : 0) +
+                ((line_coding->ui8Stop == USB_CDC_STOP_BITS_2) ? 2 : 1);
+        uart_fifo_levels_line_coding_set (channel, line_coding->ui32Rate, bits_per_char);
     }
+
+    return config_valid;
 }
 
 /**
- * @brief Set the UART RTS state to the requested value
- * @param[in] line_state The requested control line state, in CDC format
+ * @brief Request a change to the line coding for the UART of a channel
+ * @details The data from the USB host which is queued in the host_to_uart ring when the request is made is
+ *          transmitted at the old line coding, and the change is then applied by the UART interrupt handler.
+ *          If a change is already pending only the requested line coding is updated, so that the data queued
+ *          before the first request is still the amount transmitted at the old line coding.
+ * @param[in] channel The channel to change the line coding for
+ * @param[in] line_coding The values to set, in CDC format
  */
-static void set_control_line_state (const uint32_t line_state)
+static void request_line_coding_change (const uart_channel_t *const channel, const tLineCoding *const line_coding)
 {
-    if (line_state & USB_CDC_ACTIVATE_CARRIER)
+    channel_line_state_t *const state = &channel_line_states[channel->index];
+    /* Prevent the UART interrupt handler seeing a partially updated request */
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    state->pending_line_coding = *line_coding;
+    if (!state->line_coding_change_pending)
     {
-        UARTModemControlSet (UART1_BASE, UART_OUTPUT_RTS);
+        state->line_coding_drain_count = spsc_ring_used (channel->host_to_uart);
+        state->line_coding_change_pending = true;
     }
-    else
+    state->line_coding_change_status.state = LINE_CODING_CHANGE_PENDING;
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    /* Trigger the UART interrupt handler to apply the change if there is no data to drain */
+    hal_uart_int_trigger (channel->uart_int);
+}
+
+/**
+ * @brief Report a line coding change as pending from when the USB host sends a CDC SET_LINE_CODING on channel 0
+ * @details The CDC class defers passing the change to cdc_control_handler() while the receive channel reports data
+ *          remaining, so without this the host would see the state of the previous change until then.
+ */
+void line_coding_change_requested (void)
+{
+    channel_line_states[UART_CHANNEL_CC3100].line_coding_change_status.state = LINE_CODING_CHANGE_PENDING;
+}
+
+/**
+ * @brief Get the progress of line coding changes requested by the USB host for channel 0
+ * @param[out] status The current progress
+ * @return Returns the size of the status in bytes
+ */
+uint32_t line_coding_change_status_get (line_coding_change_status_t *const status)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    *status = channel_line_states[UART_CHANNEL_CC3100].line_coding_change_status;
+
+    if (!interrupts_were_disabled)
     {
-        UARTModemControlClear (UART1_BASE, UART_OUTPUT_RTS);
+        IntMasterEnable ();
     }
+
+    return sizeof (*status);
 }
 
 /**
- * @brief Set the break state on the UART connected to the CC3100BOOST
- * @param[in] break_state If true assert break.
+ * @brief Set the UART RTS state of a channel to the requested value
+ * @details Depending upon UART_RX_FLOW_CONTROL, RTS may also be deasserted while the uart_to_host ring is
+ *          nearly full, or be driven by the UART hardware.
+ *          DTR being asserted on channel 0 starts a session, at which the CDC buffers may be re-partitioned for
+ *          the workload.
+ * @param[in] channel The channel to set the control line state for
+ * @param[in] line_state The requested control line state, in CDC format
  */
-static void send_break (bool break_state)
+static void set_control_line_state (const uart_channel_t *const channel, const uint32_t line_state)
 {
-    UARTBreakCtl (UART1_BASE, break_state);
+    channel_line_state_t *const state = &channel_line_states[channel->index];
+    const bool dte_now_present = (line_state & USB_CDC_DTE_PRESENT) != 0;
+#if TRAFFIC_CAPTURE
+    const uint16_t captured_line_state = (uint16_t) line_state;
+
+    if (channel->index == UART_CHANNEL_CC3100)
+    {
+        TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_CONTROL_LINE_STATE, &captured_line_state,
+                              sizeof (captured_line_state));
+    }
+#endif
+
+    uart_flow_control_set_host_rts (channel, (line_state & USB_CDC_ACTIVATE_CARRIER) != 0);
+    if (dte_now_present && !state->dte_present && (channel->index == UART_CHANNEL_CC3100))
+    {
+        uart_buffer_arena_session_start ();
+    }
+    state->dte_present = dte_now_present;
 }
 
 /**
  * @brief Handles CDC driver notifications related to control and setup of the device.
+ * @details pvCBData is the uart_channel_t of the device.
  */
 uint32_t cdc_control_handler(void *pvCBData, uint32_t ui32Event,
                              uint32_t ui32MsgValue, void *pvMsgData)
 {
+    const uart_channel_t *const channel = pvCBData;
+
     switch (ui32Event)
     {
-    /* Ignore BUS suppend and resume */
+    /* While the bus is suspended the main loop uses deep sleep, in which only the USB controller is clocked */
     case USB_EVENT_SUSPEND:
+        usb_suspended = true;
+        break;
+
     case USB_EVENT_RESUME:
+        usb_suspended = false;
         break;
 
     case USB_EVENT_CONNECTED:
-        /* Light Green LED to indicate connected */
-        GPIOPinWrite (GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3);
+        /* The host has set the configuration, so the bulk endpoints can be given double-buffered FIFOs.
+         * Light Green LED to indicate connected */
+        if (channel->index == UART_CHANNEL_CC3100)
+        {
+            usb_data_endpoints_configure ();
+        }
+        usb_data_path_connected (channel);
+        hal_gpio_pin_write (LED_PORT_BASE, LED_GREEN, LED_GREEN);
         break;
 
     case USB_EVENT_DISCONNECTED:
         /* Turn off Green LED to indicate disconnected.
          * Note that since the USB stack is set to eUSBModeForceDevice, this event isn't received. */
-        GPIOPinWrite (GPIO_PORTF_BASE, GPIO_PIN_3, 0);
+        hal_gpio_pin_write (LED_PORT_BASE, LED_GREEN, 0);
         break;
 
     case USBD_CDC_EVENT_GET_LINE_CODING:
         /* Obtain the current UART configuration */
-        get_line_coding (pvMsgData);
+        get_line_coding (channel, pvMsgData);
         break;
 
     case USBD_CDC_EVENT_SET_CONTROL_LINE_STATE:
         /* Set the requested modem control line state */
-        set_control_line_state (ui32MsgValue);
+        set_control_line_state (channel, ui32MsgValue);
         break;
 
     case USBD_CDC_EVENT_SET_LINE_CODING:
-        /* Set the UART configuration */
-        set_line_coding (pvMsgData);
+        /* Change the UART configuration once the data already queued has been transmitted */
+        request_line_coding_change (channel, pvMsgData);
         break;
 
     case USBD_CDC_EVENT_SEND_BREAK:
-        /* Send a break condition on the serial line.
-         * The CC3100BOOST nHIB is asserted for 100ms.
-         * The de-assertion of nHIB triggers the CC3100BOOST to communicate with UniFlash. */
-        send_break (true);
-        assert_nHIB ();
-        nHIB_timer_ms = 100;
-        nHIB_timer_running = true;
+        /* Send a break condition on the serial line, using the break sequence of the channel.
+         * By default the CC3100 nHIB is asserted for 100ms.
+         * The de-assertion of nHIB triggers the CC3100 to communicate with UniFlash. */
+        cc3100_sequence_run_break (channel);
         break;
 
     case USBD_CDC_EVENT_CLEAR_BREAK:
         /* Clear the break condition on the serial line.
-         * Ensure nHIB is de-asserted (this should not be necessary as UniFlash
+         * Ensure nHIB and nRESET are de-asserted (this should not be necessary as UniFlash
          * only seems to clear the break condition after communication has been established) */
-        send_break (false);
-        deassert_nHIB ();
-        nHIB_timer_running = false;
+        cc3100_sequence_abort (channel);
         break;
 
     default:
@@ -457,9 +876,47 @@ uint32_t cdc_control_handler(void *pvCBData, uint32_t ui32Event,
     return 0;
 }
 
+/**
+ * @brief Perform a standalone programming run of the CC3100, with the UART taken from the bridge
+ * @details The UART interrupt is masked so the bridge doesn't access the UART, and the characters already received
+ *          are passed to the USB host. Data from the USB host which arrives during the run is queued in the CDC
+ *          receive buffer, and transmitted once the bridge resumes.
+ */
+static void run_cc3100_programmer (void)
+{
+    const uart_channel_t *const channel = &uart_channels[UART_CHANNEL_CC3100];
+    channel_line_state_t *const state = &channel_line_states[UART_CHANNEL_CC3100];
+    bool uart_available;
+
+    hal_uart_int_mask (channel->uart_int);
+#if UART_RX_USE_UDMA
+    uart_rx_dma_stop (channel);
+#endif
+    (void) read_uart_data (channel);
+    uart_available = (spsc_ring_used (channel->host_to_uart) == 0) && !state->line_coding_change_pending &&
+            !hal_uart_busy (channel->uart_base);
+
+    cc3100_programmer_run (uart_available);
+
+    /* Return the UART to the bridge with the line coding it was using, discarding the line errors and receive
+     * timeout from the programming run */
+    check_assert (set_line_coding (channel, &state->applied_line_coding));
+    uart_fifo_levels_apply (channel);
+    hal_uart_int_clear (channel->uart_base,
+                        UART_INT_OE | UART_INT_BE | UART_INT_PE | UART_INT_FE | UART_INT_RT | UART_INT_RX);
+#if UART_RX_USE_UDMA
+    uart_rx_dma_start (channel);
+#endif
+    hal_uart_int_unmask (channel->uart_int);
+    hal_uart_int_trigger (channel->uart_int);
+}
+
 int main (void)
 {
     uint32_t ui32SysClock;
+    uint32_t peripheral_index;
+    uint32_t channel_index;
+    const uart_channel_t *channel;
 
     FPULazyStackingEnable();
 
@@ -469,6 +926,14 @@ int main (void)
     ui32SysClock = MAP_SysCtlClockGet();
     check_assert (ui32SysClock == 80000000);
 
+#if ISR_PROFILING
+    isr_profile_init ();
+#endif
+    data_path_telemetry_init ();
+#if TRAFFIC_CAPTURE
+    traffic_capture_init ();
+#endif
+
     /* Configure the required pins for USB operation. */
     SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOD);
     GPIOPinTypeUSBAnalog (GPIO_PORTD_BASE, GPIO_PIN_5 | GPIO_PIN_4);
@@ -484,53 +949,186 @@ int main (void)
     GPIOPinTypeUART (GPIO_PORTB_BASE, GPIO_PIN_1 | GPIO_PIN_0);
     GPIOPinTypeUART (GPIO_PORTC_BASE, GPIO_PIN_5 | GPIO_PIN_4);
 
-    /* Set default UART configuration */
-    UARTConfigSetExpClk (UART1_BASE, MAP_SysCtlClockGet(), 115200,
-                         UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
-    UARTFIFOLevelSet (UART1_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
-
-    /* Enable hardware flow control (not sure if the CC3100BOOST uses it) */
-    UARTFlowControlSet (UART1_BASE, UART_FLOWCONTROL_TX);
+    /* Configure the GPIO pins for controlling the CC3100BOOST nHIB and nRESET, initially not asserted */
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOE);
+    cc3100_sequence_init ();
 
-    /* Configure and enable UART interrupts. */
-    UARTIntClear (UART1_BASE, UARTIntStatus (UART1_BASE, false));
-    UARTIntEnable (UART1_BASE, (UART_INT_OE | UART_INT_BE | UART_INT_PE |
-                                UART_INT_FE | UART_INT_RT | UART_INT_TX | UART_INT_RX));
+#if UART_EXTRA_CHANNELS
+    /* Configure the pins, rings and timers of the extra UART channels, which use GPIO ports already enabled */
+    uart_channels_init ();
+#endif
 
-    /* Configure the GPIO pin for controlling the CC3100BOOST nHIB, initially not asserted */
-    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOE);
-    GPIOPinTypeGPIOOutput (GPIO_PORTE_BASE, GPIO_PIN_4);
-    deassert_nHIB ();
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        channel = &uart_channels[channel_index];
+
+        /* Set default UART configuration */
+        check_assert (set_line_coding (channel, &default_line_coding));
+
+        /* Enable the flow control selected for the CC3100BOOST link, where the UART has the RTS/CTS pins */
+        uart_flow_control_init (channel);
+
+        /* Configure and enable UART interrupts.
+         * When using uDMA for receive the UART receive interrupt isn't used, as uDMA completion is signalled
+         * on the UART interrupt. The UART transmit interrupt is only enabled by fill_uart_tx_fifo() while there
+         * is data to send, or by complete_line_coding_change() while waiting for the transmitter to go idle. */
+        UARTIntClear (channel->uart_base, UARTIntStatus (channel->uart_base, false));
+#if UART_RX_USE_UDMA
+        UARTIntEnable (channel->uart_base, (UART_INT_OE | UART_INT_BE | UART_INT_PE |
+                                            UART_INT_FE | UART_INT_RT));
+#else
+        UARTIntEnable (channel->uart_base, (UART_INT_OE | UART_INT_BE | UART_INT_PE |
+                                            UART_INT_FE | UART_INT_RT | UART_INT_RX));
+#endif
+    }
 
     /* Configure the pins for status LEDs, initially all off */
     SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOF);
-    GPIOPinTypeGPIOOutput (GPIO_PORTF_BASE, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
-    GPIOPinWrite (GPIO_PORTF_BASE, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3, 0);
+    GPIOPinTypeGPIOOutput (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN);
+    hal_gpio_pin_write (LED_PORT_BASE, LED_RED | LED_BLUE | LED_GREEN, 0);
+
+    /* Request a standalone programming run of the CC3100 if SW2 is held at reset, which is performed once the
+     * main loop starts. The pull-up is given 1 ms to charge the pin before it is read. */
+    HWREG (PROGRAMMER_SWITCH_PORT_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+    HWREG (PROGRAMMER_SWITCH_PORT_BASE + GPIO_O_CR) |= PROGRAMMER_SWITCH_PIN;
+    HWREG (PROGRAMMER_SWITCH_PORT_BASE + GPIO_O_LOCK) = 0;
+    GPIOPinTypeGPIOInput (PROGRAMMER_SWITCH_PORT_BASE, PROGRAMMER_SWITCH_PIN);
+    GPIOPadConfigSet (PROGRAMMER_SWITCH_PORT_BASE, PROGRAMMER_SWITCH_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+    SysCtlDelay (hal_system_clock_hz () / 3000);
+    if (GPIOPinRead (PROGRAMMER_SWITCH_PORT_BASE, PROGRAMMER_SWITCH_PIN) == 0)
+    {
+        (void) cc3100_programmer_request_run ();
+    }
 
-    /* Set Sys Tick to generate a 1 millisecond tick */
-    SysTickPeriodSet (MAP_SysCtlClockGet() / 1000);
-    SysTickEnable ();
-    SysTickIntEnable ();
+#if !SPI_PASSTHROUGH && !UART_EXTRA_CHANNELS
+    /* Select the raw bulk UART interface if SW1 is held at reset, otherwise the CDC interface used by UniFlash.
+     * The pull-up is given 1 ms to charge the pin before it is read. */
+    GPIOPinTypeGPIOInput (MODE_SWITCH_PORT_BASE, MODE_SWITCH_PIN);
+    GPIOPadConfigSet (MODE_SWITCH_PORT_BASE, MODE_SWITCH_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+    SysCtlDelay (hal_system_clock_hz () / 3000);
+    usb_data_interface = (GPIOPinRead (MODE_SWITCH_PORT_BASE, MODE_SWITCH_PIN) == 0) ?
+            USB_DATA_INTERFACE_RAW_BULK : USB_DATA_INTERFACE_CDC;
+#endif
+
+    /* Configure the one-shot timers, which only run while timing the CC3100BOOST control line sequences or the
+     * USB IN flush latency. No periodic tick is used, so the CPU only wakes to handle events. */
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_TIMER0);
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_TIMER1);
+    TimerConfigure (NHIB_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+    TimerConfigure (USB_IN_FLUSH_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+    TimerIntEnable (NHIB_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    TimerIntEnable (USB_IN_FLUSH_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    IntPrioritySet (NHIB_TIMER_INT, USB_INT_PRIORITY);
+    IntPrioritySet (USB_IN_FLUSH_TIMER_INT, USB_INT_PRIORITY);
+    IntEnable (NHIB_TIMER_INT);
+    IntEnable (USB_IN_FLUSH_TIMER_INT);
+
+    /* Gate the clocks to unused peripherals when sleeping. In deep sleep, entered while the USB bus is suspended,
+     * only the USB controller is clocked so that it can detect resume signalling. The main oscillator is used in
+     * deep sleep, rather than the PLL. */
+    SysCtlPeripheralClockGating (true);
+    for (peripheral_index = 0;
+         peripheral_index < (sizeof (sleep_peripherals) / sizeof (sleep_peripherals[0]));
+         peripheral_index++)
+    {
+        SysCtlPeripheralSleepEnable (sleep_peripherals[peripheral_index]);
+    }
+    SysCtlPeripheralDeepSleepEnable (SYSCTL_PERIPH_USB0);
+    SysCtlDeepSleepClockSet (SYSCTL_DSLP_DIV_1 | SYSCTL_DSLP_OSC_MAIN);
 
-    /* Initialize the transmit and receive buffers. */
-    check_assert (USBBufferInit (&cdc_tx_buffer) != NULL);
-    check_assert (USBBufferInit (&cdc_rx_buffer) != NULL);
+    usb_in_flush_init ();
+    uart_buffer_arena_init ();
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        channel = &uart_channels[channel_index];
+#if UART_RX_USE_UDMA || UART_TX_USE_UDMA
+        uart_dma_init (channel);
+#endif
+        uart_fifo_levels_apply (channel);
+#if UART_RX_USE_UDMA
+        /* Start the UART receive uDMA, which writes into the uart_to_host ring */
+        uart_rx_dma_start (channel);
+#endif
+    }
 
     /* Set the USB stack mode to Device mode with no VBUS monitoring.
      * On the EK-TM4C123GXL the USB ID and USB VBUS signals are not connected to PB0 and PB1
      * and so must force Device mode. (PB0 and PB1 are used for the UART connection) */
     USBStackModeSet(0, eUSBModeForceDevice, 0);
 
-    /* Pass our device information to the USB library and place the device on the bus. */
-    check_assert (USBDCDCInit(0, &CDC_device) != NULL);
+    /* The UARTs have the highest interrupt priority. The USB interrupt handler, and the deferred work handler which
+     * calls usblib on behalf of the UART interrupt handlers, share a lower priority. */
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        IntPrioritySet (uart_channels[channel_index].uart_int, UART_INT_PRIORITY);
+    }
+    IntPrioritySet (INT_USB0, USB_INT_PRIORITY);
+    IntPrioritySet (FAULT_PENDSV, USB_INT_PRIORITY);
+
+    usb_serial_number_init ();
+#if SPI_PASSTHROUGH
+    /* Pass the information for the composite CDC and SPI passthrough device to the USB library and place the
+     * device on the bus. The CDC device is extended to handle vendor requests. */
+    check_assert (vendor_requests_cdc_init (0, &CDC_device, &composite_entries[COMPOSITE_ENTRY_CDC]) != NULL);
+    check_assert (spi_passthrough_init (0, &composite_entries[COMPOSITE_ENTRY_SPI]) != NULL);
+    check_assert (USBDCompositeInit (0, &composite_device, sizeof (composite_descriptor),
+                                     composite_descriptor) != NULL);
+#elif UART_EXTRA_CHANNELS
+    /* Pass the information for the composite of a CDC device for each UART channel to the USB library and place
+     * the device on the bus. Only the CDC device for the CC3100BOOST is extended to handle vendor requests.
+     * usblib has no hook between building the configuration descriptor and connecting the device, so the device is
+     * disconnected again as soon as USBDCompositeInit() returns, and only connected once the port strings have been
+     * set. The USB host debounces a connection for 100 ms, so never sees the first connection. */
+    check_assert (vendor_requests_cdc_init (0, &CDC_device, &composite_entries[COMPOSITE_ENTRY_CDC]) != NULL);
+    check_assert (uart_channels_usb_init (0) != NULL);
+    check_assert (USBDCompositeInit (0, &composite_device, sizeof (composite_descriptor),
+                                     composite_descriptor) != NULL);
+    USBDevDisconnect (USB0_BASE);
+    uart_channels_set_port_strings ();
+    USBDevConnect (USB0_BASE);
+#else
+    /* Pass our device information to the USB library and place the device on the bus.
+     * Either device is extended to handle vendor requests. */
+    if (usb_data_interface == USB_DATA_INTERFACE_RAW_BULK)
+    {
+        check_assert (vendor_requests_bulk_init (0, &uart_bulk_device) != NULL);
+    }
+    else
+    {
+        check_assert (vendor_requests_cdc_init (0, &CDC_device, NULL) != NULL);
+    }
+#endif
 
     /* Enable UART interrupts now that the application is ready to start. */
-    IntEnable (INT_UART1);
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        IntEnable (uart_channels[channel_index].uart_int);
+    }
 
-    /* Sleep, as all work is triggered from interrupt handlers */
+    /* Sleep, as all work is triggered from interrupt handlers, apart from a CC3100 programming run.
+     * Interrupts are masked while deciding whether to sleep and which sleep mode to use, so that a resume event or
+     * programming request can't be missed between testing for them and sleeping. A pending interrupt still wakes
+     * the CPU, and is handled once unmasked. */
     for (;;)
     {
-        CPUwfi ();
+        IntMasterDisable ();
+        if (cc3100_programmer_run_pending ())
+        {
+            IntMasterEnable ();
+            run_cc3100_programmer ();
+        }
+        else
+        {
+            if (usb_suspended)
+            {
+                SysCtlDeepSleep ();
+            }
+            else
+            {
+                CPUwfi ();
+            }
+            IntMasterEnable ();
+        }
     }
 
     return 0;
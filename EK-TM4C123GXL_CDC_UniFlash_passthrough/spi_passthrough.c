@@ -0,0 +1,455 @@
+/*
+ * @file spi_passthrough.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Passthrough of the CC3100 SPI host interface, over a vendor-specific USB bulk interface
+ * @details
+ *  The CC3100 host driver can use either the UART or SPI host interface. The SPI interface is faster, but
+ *  UniFlash only uses the UART. When SPI_PASSTHROUGH is enabled a vendor-specific bulk interface is added
+ *  alongside the CDC device, to allow a host application to exercise the SPI interface of the CC3100BOOST
+ *  while the CDC device remains available.
+ *
+ *  A command is read from the bulk OUT endpoint directly into a command buffer, and the SPI transfer is then
+ *  performed by uDMA between the command and response buffers with the SSI as master. The end of the transfer
+ *  is detected from the receive uDMA channel, signalled on the SSI interrupt, since the last receive character
+ *  is only written once the last transmit character has been shifted out. The response is then written to the
+ *  bulk IN endpoint one packet at a time.
+ *
+ *  Rising edges of the CC3100 IRQ line are reported to the USB host as SPI_PASSTHROUGH_EVENT_IRQ between
+ *  responses, so the host doesn't need to poll the IRQ level.
+ *
+ *  All handlers run at USB_INT_PRIORITY, so don't pre-empt each other and may call usblib.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_ssi.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/ssi.h>
+#include <driverlib/udma.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "check_assert.h"
+#include "udma_control.h"
+#include "spi_passthrough.h"
+
+#if SPI_PASSTHROUGH
+
+/* The uDMA channels assigned to SSI2 by UDMA_CH12_SSI2RX and UDMA_CH13_SSI2TX */
+#define SPI_RX_DMA_CHANNEL 12
+#define SPI_TX_DMA_CHANNEL 13
+
+/** The maximum packet size of the bulk endpoints */
+#define SPI_BULK_PACKET_SIZE 64
+
+/** The size of the command and response headers */
+#define SPI_HEADER_SIZE sizeof (spi_passthrough_header_t)
+
+/** The state of processing the current command */
+typedef enum
+{
+    /** Reading the command from the bulk OUT endpoint */
+    SPI_STATE_RECEIVING_COMMAND,
+    /** The uDMA is performing the SPI transfer */
+    SPI_STATE_TRANSFERRING,
+    /** The response is being written to the bulk IN endpoint */
+    SPI_STATE_RESPONDING
+} spi_state_t;
+
+static spi_state_t spi_state;
+
+/** The command being received, as the header followed by the data written to the CC3100 */
+static uint8_t command_buffer[SPI_HEADER_SIZE + SPI_PASSTHROUGH_MAX_LENGTH];
+
+/** Where the packets of an invalid command which don't fit in command_buffer are read to be discarded */
+static uint8_t discard_packet[SPI_BULK_PACKET_SIZE];
+
+/** The number of bytes of the current command which have been read */
+static uint32_t command_received;
+
+/** The response to the current command, as the header followed by the data read from the CC3100 */
+static uint8_t response_buffer[SPI_HEADER_SIZE + SPI_PASSTHROUGH_MAX_LENGTH];
+
+/** The number of bytes in response_buffer, valid in SPI_STATE_RESPONDING */
+static uint32_t response_length;
+
+/** The IRQ event sent to the USB host */
+static uint8_t event_buffer[SPI_HEADER_SIZE];
+
+/** The data remaining to be written to the bulk IN endpoint, for either the response or an event */
+static const uint8_t *in_data;
+static uint32_t in_remaining;
+
+/** True when in_data is the response, rather than an event */
+static bool in_is_response;
+
+/** Set when the CC3100 has asserted IRQ, and cleared once the event has been queued to the USB host */
+static bool irq_event_pending;
+
+/** True while the USB host is connected, to discard responses when the host disconnects */
+static bool usb_connected;
+
+/**
+ * @brief Set the chip select to the CC3100
+ * @param[in] asserted When true the CC3100 is selected
+ */
+static void spi_cs_set (const bool asserted)
+{
+    hal_gpio_pin_write (CC3100_SPI_CS_PORT_BASE, CC3100_SPI_CS_PIN, asserted ? 0 : CC3100_SPI_CS_PIN);
+}
+
+/**
+ * @return Returns true if the CC3100 IRQ line is asserted
+ */
+static bool spi_irq_asserted (void)
+{
+    return GPIOPinRead (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN) != 0;
+}
+
+/**
+ * @brief Write a command or response header
+ * @param[out] header Where to write the header, as little-endian bytes
+ * @param[in] command The command the header is for
+ * @param[in] status The status of the command
+ * @param[in] length The number of data bytes which follow the header
+ */
+static void write_header (uint8_t *const header, const uint8_t command, const uint8_t status,
+                          const uint32_t length)
+{
+    header[0] = command;
+    header[1] = status;
+    header[2] = length & 0xff;
+    header[3] = length >> 8;
+}
+
+/**
+ * @brief Complete the current command, by queueing its response to be written to the bulk IN endpoint
+ * @param[in] status The status of the command
+ * @param[in] data_length The number of data bytes in the response, which follow the header in response_buffer
+ */
+static void complete_command (const uint8_t status, const uint32_t data_length)
+{
+    write_header (response_buffer, command_buffer[0], status, data_length);
+    response_length = SPI_HEADER_SIZE + data_length;
+    spi_state = SPI_STATE_RESPONDING;
+}
+
+/**
+ * @brief Write the next packet of the response, or of a pending IRQ event, to the bulk IN endpoint
+ * @details The response takes priority over an IRQ event. Once the last packet of the response has been
+ *          written, the next command can be received since usblib has copied the packet to the endpoint FIFO.
+ * @return Returns true if the last packet of the response has been written
+ */
+static bool service_in_endpoint (void)
+{
+    bool response_sent = false;
+    uint32_t packet_length;
+
+    if (!usb_connected)
+    {
+        in_remaining = 0;
+        irq_event_pending = false;
+        response_sent = spi_state == SPI_STATE_RESPONDING;
+    }
+    else
+    {
+        if (in_remaining == 0)
+        {
+            if (spi_state == SPI_STATE_RESPONDING)
+            {
+                in_data = response_buffer;
+                in_remaining = response_length;
+                in_is_response = true;
+            }
+            else if (irq_event_pending)
+            {
+                write_header (event_buffer, SPI_PASSTHROUGH_EVENT_IRQ, spi_irq_asserted (), 0);
+                in_data = event_buffer;
+                in_remaining = sizeof (event_buffer);
+                in_is_response = false;
+                irq_event_pending = false;
+            }
+        }
+
+        if ((in_remaining > 0) && (USBDBulkTxPacketAvailable (&spi_bulk_device) > 0))
+        {
+            packet_length = (in_remaining < SPI_BULK_PACKET_SIZE) ? in_remaining : SPI_BULK_PACKET_SIZE;
+            check_assert (USBDBulkPacketWrite (&spi_bulk_device, (uint8_t *) in_data, packet_length, true) ==
+                          packet_length);
+            in_remaining -= packet_length;
+            response_sent = (in_remaining == 0) && in_is_response;
+            in_data += packet_length;
+        }
+    }
+
+    return response_sent;
+}
+
+/**
+ * @brief Start the SPI transfer for a SPI_PASSTHROUGH_CMD_TRANSFER command
+ * @param[in] length The number of bytes to transfer, which is in range
+ */
+static void start_spi_transfer (const uint32_t length)
+{
+    uint32_t rx_data;
+
+    /* Discard anything left in the receive FIFO, so the received data is aligned with the transmitted data */
+    while (SSIDataGetNonBlocking (CC3100_SPI_BASE, &rx_data) > 0)
+    {
+    }
+
+    uDMAChannelTransferSet (SPI_RX_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                            (void *) (CC3100_SPI_BASE + SSI_O_DR), &response_buffer[SPI_HEADER_SIZE], length);
+    uDMAChannelTransferSet (SPI_TX_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                            &command_buffer[SPI_HEADER_SIZE], (void *) (CC3100_SPI_BASE + SSI_O_DR), length);
+    spi_state = SPI_STATE_TRANSFERRING;
+    spi_cs_set (true);
+    uDMAChannelEnable (SPI_RX_DMA_CHANNEL);
+    uDMAChannelEnable (SPI_TX_DMA_CHANNEL);
+}
+
+/**
+ * @brief Execute a command which has been completely received
+ * @param[in] length The data length from the command header
+ */
+static void execute_command (const uint32_t length)
+{
+    switch (command_buffer[0])
+    {
+    case SPI_PASSTHROUGH_CMD_TRANSFER:
+        if ((length > 0) && (length <= SPI_PASSTHROUGH_MAX_LENGTH))
+        {
+            start_spi_transfer (length);
+        }
+        else
+        {
+            complete_command (SPI_PASSTHROUGH_STATUS_INVALID, 0);
+        }
+        break;
+
+    case SPI_PASSTHROUGH_CMD_GET_IRQ:
+        complete_command (spi_irq_asserted (), 0);
+        break;
+
+    default:
+        complete_command (SPI_PASSTHROUGH_STATUS_INVALID, 0);
+        break;
+    }
+}
+
+/**
+ * @brief Read packets from the bulk OUT endpoint until a command has been completely received
+ * @details The data of a command which is too long to fit in command_buffer is discarded, and the command
+ *          is then rejected by execute_command().
+ */
+static void receive_command (void)
+{
+    uint32_t packet_length;
+    uint32_t command_length;
+    uint8_t *destination;
+
+    while ((spi_state == SPI_STATE_RECEIVING_COMMAND) &&
+           ((packet_length = USBDBulkRxPacketAvailable (&spi_bulk_device)) > 0))
+    {
+        destination = ((command_received + packet_length) <= sizeof (command_buffer)) ?
+                &command_buffer[command_received] : discard_packet;
+        if (packet_length > SPI_BULK_PACKET_SIZE)
+        {
+            packet_length = SPI_BULK_PACKET_SIZE;
+        }
+        command_received += USBDBulkPacketRead (&spi_bulk_device, destination, packet_length, true);
+
+        if (command_received >= SPI_HEADER_SIZE)
+        {
+            command_length = command_buffer[2] | (command_buffer[3] << 8);
+            if (command_received >= (SPI_HEADER_SIZE + command_length))
+            {
+                /* Any bytes in the final packet beyond the command length are ignored */
+                command_received = 0;
+                execute_command (command_length);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Write the next packet to the bulk IN endpoint, and once the response has been written start
+ *        receiving the next command
+ */
+static void continue_commands (void)
+{
+    if (service_in_endpoint ())
+    {
+        spi_state = SPI_STATE_RECEIVING_COMMAND;
+        receive_command ();
+        if (spi_state == SPI_STATE_RESPONDING)
+        {
+            /* The next command completed without a SPI transfer */
+            (void) service_in_endpoint ();
+        }
+    }
+}
+
+/**
+ * @brief SSI interrupt handler, which completes a SPI transfer once the receive uDMA has stopped
+ * @details uDMA completion for the SSI channels is signalled on the SSI interrupt.
+ */
+void spi_ssi_interrupt_handler (void)
+{
+    const uint8_t hold_cs = command_buffer[1] & SPI_PASSTHROUGH_FLAG_HOLD_CS;
+
+    SSIIntClear (CC3100_SPI_BASE, SSIIntStatus (CC3100_SPI_BASE, true));
+    if ((spi_state == SPI_STATE_TRANSFERRING) &&
+        !uDMAChannelIsEnabled (SPI_RX_DMA_CHANNEL) &&
+        (uDMAChannelModeGet (SPI_RX_DMA_CHANNEL | UDMA_PRI_SELECT) == UDMA_MODE_STOP))
+    {
+        if (!hold_cs || !usb_connected)
+        {
+            spi_cs_set (false);
+        }
+        complete_command (SPI_PASSTHROUGH_STATUS_OK,
+                          (uint32_t) (command_buffer[2] | (command_buffer[3] << 8)));
+        continue_commands ();
+    }
+}
+
+/**
+ * @brief GPIO interrupt handler for a rising edge on the CC3100 IRQ line, which queues an event to the USB host
+ */
+void spi_irq_interrupt_handler (void)
+{
+    GPIOIntClear (CC3100_IRQ_PORT_BASE, CC3100_IRQ_INT_PIN);
+    if (usb_connected)
+    {
+        irq_event_pending = true;
+        continue_commands ();
+    }
+}
+
+/**
+ * @brief Handles bulk device notifications related to the receive channel (commands from the USB host)
+ */
+uint32_t spi_rx_handler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgValue, void *pvMsgData)
+{
+    switch (ui32Event)
+    {
+    case USB_EVENT_CONNECTED:
+        usb_connected = true;
+        break;
+
+    case USB_EVENT_DISCONNECTED:
+        /* Discard any partially received command and queued response. A transfer in progress is left to
+         * complete, since the uDMA can't be stopped part way through without losing the SSI FIFO alignment. */
+        usb_connected = false;
+        command_received = 0;
+        if (spi_state != SPI_STATE_TRANSFERRING)
+        {
+            spi_cs_set (false);
+        }
+        continue_commands ();
+        break;
+
+    case USB_EVENT_RX_AVAILABLE:
+        receive_command ();
+        continue_commands ();
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Handles bulk device notifications related to the transmit channel (responses to the USB host)
+ */
+uint32_t spi_tx_handler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgValue, void *pvMsgData)
+{
+    switch (ui32Event)
+    {
+    case USB_EVENT_TX_COMPLETE:
+        continue_commands ();
+        break;
+
+    default:
+        check_assert (false);
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Initialise the SPI passthrough, and add its bulk device to the composite device
+ * @param[in] index The USB controller to use
+ * @param[out] composite_entry The composite device entry for the bulk device
+ * @return Returns the bulk device instance, or NULL on error
+ */
+void *spi_passthrough_init (const uint32_t index, tCompositeEntry *const composite_entry)
+{
+    /* Configure the SSI as SPI master in mode 0, as required by the CC3100 */
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOB);
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_GPIOE);
+    SysCtlPeripheralEnable (SYSCTL_PERIPH_SSI2);
+    GPIOPinConfigure (GPIO_PB4_SSI2CLK);
+    GPIOPinConfigure (GPIO_PB6_SSI2RX);
+    GPIOPinConfigure (GPIO_PB7_SSI2TX);
+    GPIOPinTypeSSI (CC3100_SPI_PORT_BASE, CC3100_SPI_CLK_PIN | CC3100_SPI_MISO_PIN | CC3100_SPI_MOSI_PIN);
+    SSIConfigSetExpClk (CC3100_SPI_BASE, hal_system_clock_hz (), SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER,
+                        SPI_PASSTHROUGH_BIT_RATE, 8);
+    SSIEnable (CC3100_SPI_BASE);
+
+    /* The chip select is a GPIO, rather than the SSI frame signal, so that it remains asserted for the whole
+     * transfer and optionally between commands. Initially not asserted. */
+    GPIOPinTypeGPIOOutput (CC3100_SPI_CS_PORT_BASE, CC3100_SPI_CS_PIN);
+    spi_cs_set (false);
+
+    /* Both uDMA channels use single requests, with an arbitration size of half the SSI FIFO depth.
+     * The receive channel has high priority, so the receive FIFO is emptied before the transmit FIFO is
+     * refilled and can't overrun. */
+    udma_control_init ();
+    uDMAChannelAssign (UDMA_CH12_SSI2RX);
+    uDMAChannelAssign (UDMA_CH13_SSI2TX);
+    uDMAChannelAttributeDisable (SPI_RX_DMA_CHANNEL,
+                                 UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+    uDMAChannelAttributeEnable (SPI_RX_DMA_CHANNEL, UDMA_ATTR_HIGH_PRIORITY);
+    uDMAChannelAttributeDisable (SPI_TX_DMA_CHANNEL,
+                                 UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST | UDMA_ATTR_HIGH_PRIORITY |
+                                 UDMA_ATTR_REQMASK);
+    uDMAChannelControlSet (SPI_RX_DMA_CHANNEL | UDMA_PRI_SELECT,
+                           UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_4);
+    uDMAChannelControlSet (SPI_TX_DMA_CHANNEL | UDMA_PRI_SELECT,
+                           UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+    SSIDMAEnable (CC3100_SPI_BASE, SSI_DMA_RX | SSI_DMA_TX);
+    IntPrioritySet (CC3100_SPI_INT, USB_INT_PRIORITY);
+    IntEnable (CC3100_SPI_INT);
+
+    /* Configure the IRQ from the CC3100 to interrupt on a rising edge */
+    GPIOPinTypeGPIOInput (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN);
+    GPIOIntTypeSet (CC3100_IRQ_PORT_BASE, CC3100_IRQ_PIN, GPIO_RISING_EDGE);
+    GPIOIntClear (CC3100_IRQ_PORT_BASE, CC3100_IRQ_INT_PIN);
+    GPIOIntEnable (CC3100_IRQ_PORT_BASE, CC3100_IRQ_INT_PIN);
+    IntPrioritySet (CC3100_IRQ_INT, USB_INT_PRIORITY);
+    IntEnable (CC3100_IRQ_INT);
+
+    spi_state = SPI_STATE_RECEIVING_COMMAND;
+    return USBDBulkCompositeInit (index, &spi_bulk_device, composite_entry);
+}
+
+#endif /* SPI_PASSTHROUGH */
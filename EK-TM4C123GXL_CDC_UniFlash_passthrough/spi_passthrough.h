@@ -0,0 +1,85 @@
+/*
+ * @file spi_passthrough.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Passthrough of the CC3100 SPI host interface, over a vendor-specific USB bulk interface
+ */
+
+#ifndef SPI_PASSTHROUGH_H_
+#define SPI_PASSTHROUGH_H_
+
+/** When non-zero the USB device is a composite of the CDC device and a vendor-specific bulk interface which
+ *  passes SPI transfers through to the CC3100BOOST. When zero the USB device is only the CDC device,
+ *  as used by UniFlash. */
+#ifndef SPI_PASSTHROUGH
+#define SPI_PASSTHROUGH 0
+#endif
+
+/** The SPI bit rate, which the CC3100 supports up to 20 MHz */
+#ifndef SPI_PASSTHROUGH_BIT_RATE
+#define SPI_PASSTHROUGH_BIT_RATE 20000000
+#endif
+
+/** The maximum number of bytes in one SPI transfer command */
+#ifndef SPI_PASSTHROUGH_MAX_LENGTH
+#define SPI_PASSTHROUGH_MAX_LENGTH 1024
+#endif
+
+/* The commands sent by the USB host on the bulk OUT endpoint. Each command is a spi_passthrough_header_t
+   followed by any data, starting at the beginning of a USB packet. The device responds on the bulk IN endpoint
+   with a spi_passthrough_header_t for the same command followed by any data. Commands are processed in order,
+   one at a time, and further commands are NAKed until the response has been queued. */
+
+/** Full-duplex SPI transfer of length bytes with CS asserted. The command data is written to the CC3100, and
+ *  the response data is the bytes read from the CC3100. */
+#define SPI_PASSTHROUGH_CMD_TRANSFER 0x01
+/** No data. The response status is the level of the CC3100 IRQ line */
+#define SPI_PASSTHROUGH_CMD_GET_IRQ  0x02
+/** Sent by the device, between responses, when the CC3100 asserts the IRQ line. The status is the IRQ level. */
+#define SPI_PASSTHROUGH_EVENT_IRQ    0x03
+
+/** Command flag for SPI_PASSTHROUGH_CMD_TRANSFER which leaves CS asserted at the end of the transfer, so that
+ *  one SPI transaction can be split across multiple commands */
+#define SPI_PASSTHROUGH_FLAG_HOLD_CS 0x01
+
+/* Response status values */
+#define SPI_PASSTHROUGH_STATUS_OK      0x00
+#define SPI_PASSTHROUGH_STATUS_INVALID 0x01
+
+/** The header of commands and responses on the bulk endpoints */
+typedef struct
+{
+    /** One of the SPI_PASSTHROUGH_CMD_ or SPI_PASSTHROUGH_EVENT_ values */
+    uint8_t command;
+    /** For commands the SPI_PASSTHROUGH_FLAG_ flags, for responses the status */
+    uint8_t flags_or_status;
+    /** The number of data bytes which follow the header, little-endian */
+    uint16_t length;
+} spi_passthrough_header_t;
+
+#if SPI_PASSTHROUGH
+/* The devices which make up the composite device, in order of interface number */
+#define COMPOSITE_ENTRY_CDC 0
+#define COMPOSITE_ENTRY_SPI 1
+#define NUM_COMPOSITE_ENTRIES 2
+
+/** The size of the configuration descriptor built for the composite device */
+#define COMPOSITE_DESCRIPTOR_SIZE (COMPOSITE_DCDC_SIZE + COMPOSITE_DBULK_SIZE)
+
+extern tUSBDBulkDevice spi_bulk_device;
+extern tCompositeEntry composite_entries[NUM_COMPOSITE_ENTRIES];
+extern tUSBDCompositeDevice composite_device;
+extern uint8_t composite_descriptor[COMPOSITE_DESCRIPTOR_SIZE];
+#endif /* SPI_PASSTHROUGH */
+
+/** SPI passthrough bulk device callback function prototypes */
+uint32_t spi_rx_handler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgValue, void *pvMsgData);
+uint32_t spi_tx_handler(void *pvCBData, uint32_t ui32Event,
+                        uint32_t ui32MsgValue, void *pvMsgData);
+
+void *spi_passthrough_init (const uint32_t index, tCompositeEntry *const composite_entry);
+void spi_ssi_interrupt_handler (void);
+void spi_irq_interrupt_handler (void);
+
+#endif /* SPI_PASSTHROUGH_H_ */
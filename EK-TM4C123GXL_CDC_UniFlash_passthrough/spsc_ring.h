@@ -0,0 +1,172 @@
+/*
+ * @file spsc_ring.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Lock-free single-producer / single-consumer ring buffer for the UART data path
+ * @details
+ *  Each ring has exactly one producer and one consumer, which may run at different interrupt priorities.
+ *  The head is only written by the producer and the tail only by the consumer. Both are free running counts of
+ *  bytes, so their difference is the number of bytes in the ring and the ring can be completely filled.
+ *  The size must be a power of two, so that an index into the buffer is obtained by masking a count.
+ *
+ *  The producer reserves a contiguous span of free space, writes into it (with the CPU or uDMA) and then commits
+ *  the number of bytes written. The consumer similarly reserves a contiguous span of data, reads it and commits
+ *  the number of bytes read. Whole blocks are therefore moved without per-byte bookkeeping. A memory barrier
+ *  before each commit ensures the data accesses have completed before the other side can see the new count.
+ *
+ *  The producer also records the high-water mark of the bytes used, to size the ring from evidence.
+ *
+ *  The functions are inline, since they are called from the interrupt handlers on every transfer.
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Ensure the preceding memory accesses have completed before any following memory access.
+ * An acquire / release fence is sufficient for the ordering between the producer and consumer, and is a dmb on the
+ * Cortex-M4 but only a compiler barrier on an x86 host, so the host benchmark doesn't measure the cost of a full
+ * fence which the target doesn't have.
+ */
+#if defined (__TI_COMPILER_VERSION__)
+#define SPSC_RING_BARRIER() __asm (" dmb")
+#else
+#define SPSC_RING_BARRIER() __atomic_thread_fence (__ATOMIC_ACQ_REL)
+#endif
+
+/** A ring buffer */
+typedef struct
+{
+    /** The storage for the ring */
+    uint8_t *buffer;
+    /** The size of the buffer - 1 */
+    uint32_t mask;
+    /** The number of bytes committed by the producer */
+    volatile uint32_t head;
+    /** The number of bytes committed by the consumer */
+    volatile uint32_t tail;
+    /** The most bytes used since the ring was initialised, or the high-water mark was cleared */
+    volatile uint32_t high_water;
+} spsc_ring_t;
+
+/**
+ * @brief Initialise a ring as empty. Must be called while neither the producer nor consumer can access the ring.
+ * @param[out] ring The ring to initialise
+ * @param[in] buffer The storage for the ring
+ * @param[in] size The size of the buffer, which must be a power of 2
+ */
+static inline void spsc_ring_init (spsc_ring_t *const ring, uint8_t *const buffer, const uint32_t size)
+{
+    ring->buffer = buffer;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->high_water = 0;
+}
+
+/**
+ * @return Returns the size of the ring in bytes
+ */
+static inline uint32_t spsc_ring_size (const spsc_ring_t *const ring)
+{
+    return ring->mask + 1;
+}
+
+/**
+ * @return Returns the number of bytes committed by the producer which are yet to be committed by the consumer
+ */
+static inline uint32_t spsc_ring_used (const spsc_ring_t *const ring)
+{
+    return ring->head - ring->tail;
+}
+
+/**
+ * @return Returns the number of bytes of free space in the ring
+ */
+static inline uint32_t spsc_ring_free (const spsc_ring_t *const ring)
+{
+    return spsc_ring_size (ring) - spsc_ring_used (ring);
+}
+
+/**
+ * @brief Called by the producer to reserve a contiguous span of free space, which starts a number of bytes
+ *        beyond the head. This allows further spans to be reserved before earlier ones have been committed.
+ * @param[in] ring The ring to write
+ * @param[in] skip The number of bytes of free space following the head which have already been reserved
+ * @param[out] length The length of the contiguous span, which may be zero
+ * @return Returns the start of the span
+ */
+static inline uint8_t *spsc_ring_write_span_at (spsc_ring_t *const ring, const uint32_t skip,
+                                                uint32_t *const length)
+{
+    const uint32_t start = ring->head + skip;
+    const uint32_t offset = start & ring->mask;
+    const uint32_t free_space = spsc_ring_size (ring) - (start - ring->tail);
+    const uint32_t contiguous = spsc_ring_size (ring) - offset;
+
+    *length = (free_space < contiguous) ? free_space : contiguous;
+    return &ring->buffer[offset];
+}
+
+/**
+ * @brief Called by the producer to reserve the contiguous span of free space at the head
+ * @param[in] ring The ring to write
+ * @param[out] length The length of the contiguous span, which may be zero
+ * @return Returns the start of the span
+ */
+static inline uint8_t *spsc_ring_write_span (spsc_ring_t *const ring, uint32_t *const length)
+{
+    return spsc_ring_write_span_at (ring, 0, length);
+}
+
+/**
+ * @brief Called by the producer to make bytes written at the head visible to the consumer
+ * @param[in] ring The ring written
+ * @param[in] length The number of bytes written, which must not exceed the free space
+ */
+static inline void spsc_ring_write_commit (spsc_ring_t *const ring, const uint32_t length)
+{
+    uint32_t used;
+
+    SPSC_RING_BARRIER ();
+    ring->head += length;
+    used = spsc_ring_used (ring);
+    if (used > ring->high_water)
+    {
+        ring->high_water = used;
+    }
+}
+
+/**
+ * @brief Called by the consumer to reserve the contiguous span of data at the tail
+ * @param[in] ring The ring to read
+ * @param[out] length The length of the contiguous span, which may be zero
+ * @return Returns the start of the span
+ */
+static inline uint8_t *spsc_ring_read_span (spsc_ring_t *const ring, uint32_t *const length)
+{
+    const uint32_t offset = ring->tail & ring->mask;
+    const uint32_t used = spsc_ring_used (ring);
+    const uint32_t contiguous = spsc_ring_size (ring) - offset;
+
+    /* Don't read the data before the head which made it visible */
+    SPSC_RING_BARRIER ();
+    *length = (used < contiguous) ? used : contiguous;
+    return &ring->buffer[offset];
+}
+
+/**
+ * @brief Called by the consumer to release bytes read at the tail back to the producer
+ * @param[in] ring The ring read
+ * @param[in] length The number of bytes read, which must not exceed the bytes used
+ */
+static inline void spsc_ring_read_commit (spsc_ring_t *const ring, const uint32_t length)
+{
+    SPSC_RING_BARRIER ();
+    ring->tail += length;
+}
+
+#endif /* SPSC_RING_H_ */
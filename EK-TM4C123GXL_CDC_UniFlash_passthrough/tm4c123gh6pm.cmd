@@ -10,7 +10,9 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00040000
+    FLASH (RX) : origin = 0x00000000, length = 0x00010000
+    /* The upper part of the flash holds the CC3100 programmer image, written at run time (cc3100_programmer.h) */
+    CC3100_IMAGE (R) : origin = 0x00010000, length = 0x00030000
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
 
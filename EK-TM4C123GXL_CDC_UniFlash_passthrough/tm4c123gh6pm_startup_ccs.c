@@ -24,6 +24,8 @@
 
 #include <stdint.h>
 
+#include "uart_channels.h"
+
 //*****************************************************************************
 //
 // Forward declaration of the default fault handlers.
@@ -54,9 +56,19 @@ extern uint32_t __STACK_TOP;
 // External declarations for the interrupt handlers used by the application.
 //
 //*****************************************************************************
-void USB0DeviceIntHandler(void);
-void sys_tick_handler (void);
+void usb_interrupt_handler (void);
 void uart_interrupt_handler (void);
+void nhib_timer_handler (void);
+void usb_in_flush_timer_handler (void);
+void deferred_work_handler (void);
+void spi_ssi_interrupt_handler (void);
+void spi_irq_interrupt_handler (void);
+void uart_channel_1_interrupt_handler (void);
+void uart_channel_2_interrupt_handler (void);
+void uart_channel_1_nhib_timer_handler (void);
+void uart_channel_2_nhib_timer_handler (void);
+void uart_channel_1_flush_timer_handler (void);
+void uart_channel_2_flush_timer_handler (void);
 
 
 //*****************************************************************************
@@ -84,10 +96,14 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
-    sys_tick_handler,                       // The SysTick handler
+    deferred_work_handler,                  // The PendSV handler
+    IntDefaultHandler,                      // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
+#if SPI_PASSTHROUGH
+    spi_irq_interrupt_handler,              // GPIO Port B
+#else
     IntDefaultHandler,                      // GPIO Port B
+#endif
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
@@ -105,11 +121,15 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // ADC Sequence 2
     IntDefaultHandler,                      // ADC Sequence 3
     IntDefaultHandler,                      // Watchdog timer
-    IntDefaultHandler,                      // Timer 0 subtimer A
+    nhib_timer_handler,                     // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
-    IntDefaultHandler,                      // Timer 1 subtimer A
+    usb_in_flush_timer_handler,             // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
+#if UART_EXTRA_CHANNELS > 0
+    uart_channel_1_flush_timer_handler,     // Timer 2 subtimer A
+#else
     IntDefaultHandler,                      // Timer 2 subtimer A
+#endif
     IntDefaultHandler,                      // Timer 2 subtimer B
     IntDefaultHandler,                      // Analog Comparator 0
     IntDefaultHandler,                      // Analog Comparator 1
@@ -119,9 +139,17 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port F
     IntDefaultHandler,                      // GPIO Port G
     IntDefaultHandler,                      // GPIO Port H
+#if UART_EXTRA_CHANNELS > 1
+    uart_channel_2_interrupt_handler,       // UART2 Rx and Tx
+#else
     IntDefaultHandler,                      // UART2 Rx and Tx
+#endif
     IntDefaultHandler,                      // SSI1 Rx and Tx
+#if UART_EXTRA_CHANNELS > 1
+    uart_channel_2_flush_timer_handler,     // Timer 3 subtimer A
+#else
     IntDefaultHandler,                      // Timer 3 subtimer A
+#endif
     IntDefaultHandler,                      // Timer 3 subtimer B
     IntDefaultHandler,                      // I2C1 Master and Slave
     IntDefaultHandler,                      // Quadrature Encoder 1
@@ -130,7 +158,7 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     0,                                      // Reserved
     IntDefaultHandler,                      // Hibernate
-    USB0DeviceIntHandler,                   // USB0
+    usb_interrupt_handler,                  // USB0
     IntDefaultHandler,                      // PWM Generator 3
     IntDefaultHandler,                      // uDMA Software Transfer
     IntDefaultHandler,                      // uDMA Error
@@ -143,9 +171,17 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port J
     IntDefaultHandler,                      // GPIO Port K
     IntDefaultHandler,                      // GPIO Port L
+#if SPI_PASSTHROUGH
+    spi_ssi_interrupt_handler,              // SSI2 Rx and Tx
+#else
     IntDefaultHandler,                      // SSI2 Rx and Tx
+#endif
     IntDefaultHandler,                      // SSI3 Rx and Tx
+#if UART_EXTRA_CHANNELS > 0
+    uart_channel_1_interrupt_handler,       // UART3 Rx and Tx
+#else
     IntDefaultHandler,                      // UART3 Rx and Tx
+#endif
     IntDefaultHandler,                      // UART4 Rx and Tx
     IntDefaultHandler,                      // UART5 Rx and Tx
     IntDefaultHandler,                      // UART6 Rx and Tx
@@ -182,8 +218,16 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // Timer 5 subtimer B
     IntDefaultHandler,                      // Wide Timer 0 subtimer A
     IntDefaultHandler,                      // Wide Timer 0 subtimer B
+#if UART_EXTRA_CHANNELS > 0
+    uart_channel_1_nhib_timer_handler,      // Wide Timer 1 subtimer A
+#else
     IntDefaultHandler,                      // Wide Timer 1 subtimer A
+#endif
+#if UART_EXTRA_CHANNELS > 1
+    uart_channel_2_nhib_timer_handler,      // Wide Timer 1 subtimer B
+#else
     IntDefaultHandler,                      // Wide Timer 1 subtimer B
+#endif
     IntDefaultHandler,                      // Wide Timer 2 subtimer A
     IntDefaultHandler,                      // Wide Timer 2 subtimer B
     IntDefaultHandler,                      // Wide Timer 3 subtimer A
@@ -0,0 +1,383 @@
+/*
+ * @file traffic_capture.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Optional timestamped capture of the UART traffic and control events, dumped in pcap format
+ * @details
+ *  When a UniFlash session stalls the capture shows which of the USB host, the bridge or the CC3100 went quiet.
+ *  Each chunk of characters committed between the UART and the CDC buffers, each break and nHIB change and each
+ *  set of line errors is recorded with a timestamp into a circular trace in SRAM. When the trace is full the
+ *  oldest records are discarded, so the trace holds the traffic leading up to a stall.
+ *
+ *  To keep the overhead low enough to leave the capture running at the full line rate:
+ *  - Only the first TRAFFIC_CAPTURE_SNAP_LENGTH characters of each chunk are copied.
+ *  - The timestamp is the raw count of a free running 64-bit timer at the CPU clock, which is only converted to
+ *    seconds and microseconds when the trace is dumped.
+ *  Records are written from both the UART interrupt handler and at the USB interrupt priority, so a record is
+ *  written with interrupts disabled.
+ *
+ *  The trace is read by the USB host with VENDOR_REQUEST_GET_CAPTURE, which converts the records into a pcap
+ *  file with link type LINKTYPE_USER0. The first byte of each packet is the traffic_capture_type_t, followed
+ *  by any data. VENDOR_REQUEST_CAPTURE_CONTROL selects one of two modes:
+ *  - Ring mode, used from reset, keeps the most recent traffic for diagnosing a stall. Reading from the start of
+ *    the trace stops the capture, so that records aren't overwritten while the trace is dumped.
+ *  - Session mode records a complete session, as the input for replaying it. The data isn't truncated, and
+ *    the USB host reads the trace while capturing. Records are never overwritten; if the USB host falls behind
+ *    records are dropped and a TRAFFIC_CAPTURE_DROPPED record shows the gap. The line coding and control line
+ *    state are recorded, so a replay can derive the character times, along with the timestamp of each chunk.
+ *    Inter-character timing within a chunk is only preserved when the receive uDMA is disabled
+ *    (UART_RX_USE_UDMA=0), when a chunk is at most one UART FIFO trigger level.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <driverlib/interrupt.h>
+
+#include "bridge_hal.h"
+#include "traffic_capture.h"
+
+#if TRAFFIC_CAPTURE
+
+/** The size of the header which precedes the data in each record in the trace, which is:
+ *  - word 0 : Timestamp least significant 32-bits
+ *  - word 1 : Timestamp most significant 32-bits
+ *  - word 2 : Original data length in bits 31:16, recorded data length in bits 15:8 and type in bits 7:0 */
+#define RECORD_HEADER_SIZE 12
+
+/** In session mode the data is recorded in pieces of up to this length, which fits the recorded length field */
+#define SESSION_PIECE_LENGTH 252
+
+/** The maximum number of bytes returned by each VENDOR_REQUEST_GET_CAPTURE */
+#define DUMP_CHUNK_SIZE 512
+
+/* Each chunk must be able to hold the largest pcap record, and the trace at least one of the largest records */
+#if (DUMP_CHUNK_SIZE < (16 + 1 + TRAFFIC_CAPTURE_SNAP_LENGTH)) || (DUMP_CHUNK_SIZE < (16 + 1 + SESSION_PIECE_LENGTH))
+#error DUMP_CHUNK_SIZE must hold the largest pcap record
+#endif
+#if TRAFFIC_CAPTURE_SIZE < (2 * (RECORD_HEADER_SIZE + SESSION_PIECE_LENGTH))
+#error TRAFFIC_CAPTURE_SIZE is too small for session mode
+#endif
+
+/** The pcap link type for private use, used for the traffic_capture_type_t followed by the data */
+#define LINKTYPE_USER0 147
+
+/** The pcap file header */
+typedef struct
+{
+    uint32_t magic_number;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+} pcap_file_header_t;
+
+/** The pcap header which precedes each packet */
+typedef struct
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+} pcap_record_header_t;
+
+static const pcap_file_header_t pcap_file_header =
+{
+    .magic_number = 0xa1b2c3d4,
+    .version_major = 2,
+    .version_minor = 4,
+    .thiszone = 0,
+    .sigfigs = 0,
+    .snaplen = 1 + 255, /* The largest recorded length, for either mode */
+    .network = LINKTYPE_USER0
+};
+
+/** The circular trace, accessed as words for the record headers and as bytes for the data */
+static uint32_t trace[TRAFFIC_CAPTURE_SIZE / sizeof (uint32_t)];
+
+/** Free running byte counts of the end of the newest record and the start of the oldest record in the trace.
+ *  Records start on a word boundary. In session mode trace_head is only written when adding records, and
+ *  trace_tail only when reading the trace. */
+static volatile uint32_t trace_head;
+static volatile uint32_t trace_tail;
+
+/** How records are added to the trace */
+static volatile traffic_capture_mode_t capture_mode;
+
+/** In session mode, the number of pieces dropped since the trace was full which are yet to be recorded */
+static uint32_t num_dropped_pieces;
+
+/** The start of the next record to be dumped, and if the pcap file header is yet to be dumped */
+static uint32_t dump_cursor;
+static bool dump_file_header_pending;
+
+/** When true records are removed from the trace once dumped, which is set for session mode */
+static bool dump_consumes;
+
+/** Used to return the pcap data to the USB host */
+static uint8_t dump_buffer[DUMP_CHUNK_SIZE];
+
+/**
+ * @param[in] data_length The number of data bytes in the record
+ * @return Returns the number of bytes the record occupies in the trace, rounded up to a whole number of words
+ */
+static uint32_t record_size (const uint32_t data_length)
+{
+    return RECORD_HEADER_SIZE + ((data_length + 3) & ~3u);
+}
+
+/**
+ * @param[in] offset The free running byte count of a word in the trace
+ * @return Returns the word in the trace
+ */
+static uint32_t *trace_word (const uint32_t offset)
+{
+    return &trace[(offset & (TRAFFIC_CAPTURE_SIZE - 1)) / sizeof (uint32_t)];
+}
+
+/**
+ * @param[in] size The number of bytes for a new record
+ * @return Returns true if the trace has space for the record without discarding any records
+ */
+static bool trace_has_space (const uint32_t size)
+{
+    return (trace_head + size - trace_tail) <= TRAFFIC_CAPTURE_SIZE;
+}
+
+/**
+ * @brief Write a record at the head of the trace, which must have space for it
+ * @param[in] type The type of record
+ * @param[in] timestamp When the record was captured
+ * @param[in] data The data to record
+ * @param[in] recorded_length The number of data bytes to record
+ * @param[in] original_length The length of the data before it was truncated to recorded_length
+ */
+static void write_record (const traffic_capture_type_t type, const uint64_t timestamp,
+                          const uint8_t *const data, const uint32_t recorded_length, const uint32_t original_length)
+{
+    uint8_t *const trace_bytes = (uint8_t *) trace;
+    uint32_t index;
+
+    *trace_word (trace_head) = (uint32_t) timestamp;
+    *trace_word (trace_head + 4) = (uint32_t) (timestamp >> 32);
+    *trace_word (trace_head + 8) =
+            (((original_length < UINT16_MAX) ? original_length : UINT16_MAX) << 16) | (recorded_length << 8) | type;
+    for (index = 0; index < recorded_length; index++)
+    {
+        trace_bytes[(trace_head + RECORD_HEADER_SIZE + index) & (TRAFFIC_CAPTURE_SIZE - 1)] = data[index];
+    }
+    trace_head += record_size (recorded_length);
+}
+
+/**
+ * @brief Add a record in session mode, splitting the data into pieces so that none is truncated
+ * @details If the trace is full, because the USB host isn't reading it fast enough, the pieces are dropped.
+ *          The number of pieces dropped is recorded as a TRAFFIC_CAPTURE_DROPPED record once there is space.
+ * @param[in] type The type of record
+ * @param[in] timestamp When the record was captured
+ * @param[in] data The data to record
+ * @param[in] length The number of data bytes
+ */
+static void record_session (const traffic_capture_type_t type, const uint64_t timestamp,
+                            const uint8_t *const data, const uint32_t length)
+{
+    uint32_t offset = 0;
+    uint32_t piece_length;
+
+    do
+    {
+        piece_length = length - offset;
+        if (piece_length > SESSION_PIECE_LENGTH)
+        {
+            piece_length = SESSION_PIECE_LENGTH;
+        }
+
+        if ((num_dropped_pieces > 0) &&
+            trace_has_space (record_size (sizeof (num_dropped_pieces)) + record_size (piece_length)))
+        {
+            write_record (TRAFFIC_CAPTURE_DROPPED, timestamp, (const uint8_t *) &num_dropped_pieces,
+                          sizeof (num_dropped_pieces), sizeof (num_dropped_pieces));
+            num_dropped_pieces = 0;
+        }
+
+        if ((num_dropped_pieces == 0) && trace_has_space (record_size (piece_length)))
+        {
+            write_record (type, timestamp, &data[offset], piece_length, piece_length);
+        }
+        else
+        {
+            num_dropped_pieces++;
+        }
+        offset += piece_length;
+    } while (offset < length);
+}
+
+/**
+ * @brief Start the free running timer used to timestamp records, and start capturing in ring mode
+ */
+void traffic_capture_init (void)
+{
+    SysCtlPeripheralEnable (CAPTURE_TIMER_PERIPH);
+    TimerConfigure (CAPTURE_TIMER_BASE, TIMER_CFG_PERIODIC_UP);
+    TimerLoadSet64 (CAPTURE_TIMER_BASE, UINT64_MAX);
+    TimerEnable (CAPTURE_TIMER_BASE, TIMER_A);
+    traffic_capture_control (TRAFFIC_CAPTURE_RING);
+}
+
+/**
+ * @brief Add a record to the trace
+ * @details In ring mode the data is truncated to TRAFFIC_CAPTURE_SNAP_LENGTH, and the oldest records are
+ *          discarded to make space. In session mode the data is recorded in full.
+ * @param[in] type The type of record
+ * @param[in] data The data for the record, which may be NULL when length is zero
+ * @param[in] length The number of data bytes
+ */
+void traffic_capture_record (const traffic_capture_type_t type, const void *const data, const uint32_t length)
+{
+    const uint32_t recorded_length = (length < TRAFFIC_CAPTURE_SNAP_LENGTH) ? length : TRAFFIC_CAPTURE_SNAP_LENGTH;
+    bool interrupts_were_disabled;
+    uint64_t timestamp;
+
+    if (capture_mode != TRAFFIC_CAPTURE_STOPPED)
+    {
+        interrupts_were_disabled = IntMasterDisable ();
+
+        timestamp = hal_capture_timestamp ();
+        if (capture_mode == TRAFFIC_CAPTURE_SESSION)
+        {
+            record_session (type, timestamp, data, length);
+        }
+        else
+        {
+            while (!trace_has_space (record_size (recorded_length)))
+            {
+                trace_tail += record_size ((*trace_word (trace_tail + 8) >> 8) & 0xFF);
+            }
+            write_record (type, timestamp, data, recorded_length, length);
+        }
+
+        if (!interrupts_were_disabled)
+        {
+            IntMasterEnable ();
+        }
+    }
+}
+
+/**
+ * @brief Set the capture mode
+ * @param[in] mode Starting either ring or session mode empties the trace.
+ *                 Stopping leaves the trace to be dumped.
+ * @return Returns true if the mode is valid
+ */
+bool traffic_capture_control (const uint32_t mode)
+{
+    bool interrupts_were_disabled;
+
+    if (mode > TRAFFIC_CAPTURE_SESSION)
+    {
+        return false;
+    }
+
+    interrupts_were_disabled = IntMasterDisable ();
+    if (mode != TRAFFIC_CAPTURE_STOPPED)
+    {
+        trace_head = 0;
+        trace_tail = 0;
+        num_dropped_pieces = 0;
+        dump_cursor = 0;
+        dump_file_header_pending = false;
+        dump_consumes = mode == TRAFFIC_CAPTURE_SESSION;
+    }
+    capture_mode = (traffic_capture_mode_t) mode;
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the next part of the trace in pcap format
+ * @details Only whole pcap records are returned, so the USB host should keep reading until a zero length is
+ *          returned. In ring mode no data is returned while capturing, other than by rewinding which stops it.
+ *          In session mode the records are removed from the trace as they are returned, so the USB host reads
+ *          the trace while capturing to make space for new records.
+ * @param[in] rewind When true dump from the pcap file header. In ring mode this also stops capturing.
+ * @param[in] max_length The maximum number of bytes the USB host will accept
+ * @param[out] dump Set to point at the pcap data
+ * @return Returns the number of bytes of pcap data
+ */
+uint32_t traffic_capture_dump (const bool rewind, const uint32_t max_length, const uint8_t **const dump)
+{
+    const uint32_t limit = (max_length < DUMP_CHUNK_SIZE) ? max_length : DUMP_CHUNK_SIZE;
+    const uint32_t ticks_per_second = hal_system_clock_hz ();
+    const uint8_t *const trace_bytes = (const uint8_t *) trace;
+    pcap_record_header_t record_header;
+    uint32_t dump_length = 0;
+    uint32_t recorded_length;
+    uint32_t type_and_lengths;
+    uint64_t timestamp;
+    uint32_t index;
+
+    if (rewind)
+    {
+        if (capture_mode == TRAFFIC_CAPTURE_RING)
+        {
+            traffic_capture_control (TRAFFIC_CAPTURE_STOPPED);
+        }
+        dump_cursor = trace_tail;
+        dump_file_header_pending = true;
+    }
+
+    if (capture_mode != TRAFFIC_CAPTURE_RING)
+    {
+        if (dump_file_header_pending && (limit >= sizeof (pcap_file_header)))
+        {
+            memcpy (dump_buffer, &pcap_file_header, sizeof (pcap_file_header));
+            dump_length = sizeof (pcap_file_header);
+            dump_file_header_pending = false;
+        }
+
+        /* The UART interrupt handler may add records while the trace is read, but only beyond trace_head */
+        while (!dump_file_header_pending && (dump_cursor != trace_head))
+        {
+            type_and_lengths = *trace_word (dump_cursor + 8);
+            recorded_length = (type_and_lengths >> 8) & 0xFF;
+            if ((dump_length + sizeof (record_header) + 1 + recorded_length) > limit)
+            {
+                break;
+            }
+
+            timestamp = ((uint64_t) *trace_word (dump_cursor + 4) << 32) | *trace_word (dump_cursor);
+            record_header.ts_sec = (uint32_t) (timestamp / ticks_per_second);
+            record_header.ts_usec = (uint32_t) ((timestamp % ticks_per_second) / (ticks_per_second / 1000000));
+            record_header.incl_len = 1 + recorded_length;
+            record_header.orig_len = 1 + (type_and_lengths >> 16);
+            memcpy (&dump_buffer[dump_length], &record_header, sizeof (record_header));
+            dump_length += sizeof (record_header);
+            dump_buffer[dump_length] = (uint8_t) type_and_lengths;
+            dump_length++;
+            for (index = 0; index < recorded_length; index++)
+            {
+                dump_buffer[dump_length] =
+                        trace_bytes[(dump_cursor + RECORD_HEADER_SIZE + index) & (TRAFFIC_CAPTURE_SIZE - 1)];
+                dump_length++;
+            }
+
+            dump_cursor += record_size (recorded_length);
+            if (dump_consumes)
+            {
+                trace_tail = dump_cursor;
+            }
+        }
+    }
+
+    *dump = dump_buffer;
+    return dump_length;
+}
+
+#endif /* TRAFFIC_CAPTURE */
@@ -0,0 +1,91 @@
+/*
+ * @file traffic_capture.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Optional timestamped capture of the UART traffic and control events, dumped in pcap format
+ */
+
+#ifndef TRAFFIC_CAPTURE_H_
+#define TRAFFIC_CAPTURE_H_
+
+/** When non-zero the UART traffic and control events are recorded into a circular trace, which may be read
+ *  in pcap format using VENDOR_REQUEST_GET_CAPTURE */
+#ifndef TRAFFIC_CAPTURE
+#define TRAFFIC_CAPTURE 0
+#endif
+
+/** The size in bytes of the circular trace, which must be a power of 2 */
+#ifndef TRAFFIC_CAPTURE_SIZE
+#define TRAFFIC_CAPTURE_SIZE 4096
+#endif
+
+/** The maximum number of data bytes recorded for each chunk. The original length of the chunk is always
+ *  recorded, so the pcap shows how much was truncated. */
+#ifndef TRAFFIC_CAPTURE_SNAP_LENGTH
+#define TRAFFIC_CAPTURE_SNAP_LENGTH 16
+#endif
+
+#if (TRAFFIC_CAPTURE_SIZE & (TRAFFIC_CAPTURE_SIZE - 1)) != 0
+#error TRAFFIC_CAPTURE_SIZE must be a power of 2
+#endif
+
+#if TRAFFIC_CAPTURE_SNAP_LENGTH > 255
+#error TRAFFIC_CAPTURE_SNAP_LENGTH must fit in one byte
+#endif
+
+/** The type of each captured record, which is the first byte of the pcap packet data */
+typedef enum
+{
+    /** Characters received from the CC3100, as passed to the USB host. The data is the characters. */
+    TRAFFIC_CAPTURE_UART_RX,
+    /** Characters from the USB host written to the UART transmit FIFO. The data is the characters. */
+    TRAFFIC_CAPTURE_UART_TX,
+    /** Break asserted on the UART. No data. */
+    TRAFFIC_CAPTURE_BREAK_SET,
+    /** Break cleared on the UART. No data. */
+    TRAFFIC_CAPTURE_BREAK_CLEAR,
+    /** nHIB asserted to the CC3100. No data. */
+    TRAFFIC_CAPTURE_NHIB_ASSERT,
+    /** nHIB deasserted to the CC3100. No data. */
+    TRAFFIC_CAPTURE_NHIB_DEASSERT,
+    /** UART line errors. The data is the UART_INT_OE, UART_INT_BE, UART_INT_PE and UART_INT_FE flags as a
+     *  little-endian 32-bit word. */
+    TRAFFIC_CAPTURE_LINE_ERRORS,
+    /** A line coding has been applied to the UART. The data is the tLineCoding in the CDC format. */
+    TRAFFIC_CAPTURE_LINE_CODING,
+    /** The USB host has set the control line state. The data is the CDC line state as a little-endian 16-bit word. */
+    TRAFFIC_CAPTURE_CONTROL_LINE_STATE,
+    /** In session mode, records were dropped since the USB host didn't read the trace fast enough.
+     *  The data is the number of records dropped as a little-endian 32-bit word. */
+    TRAFFIC_CAPTURE_DROPPED,
+    /** nRESET asserted to the CC3100. No data. */
+    TRAFFIC_CAPTURE_NRESET_ASSERT,
+    /** nRESET deasserted to the CC3100. No data. */
+    TRAFFIC_CAPTURE_NRESET_DEASSERT
+} traffic_capture_type_t;
+
+/** The capture modes, set by VENDOR_REQUEST_CAPTURE_CONTROL */
+typedef enum
+{
+    /** Records are not added */
+    TRAFFIC_CAPTURE_STOPPED,
+    /** The data is truncated to TRAFFIC_CAPTURE_SNAP_LENGTH, and the oldest records overwritten */
+    TRAFFIC_CAPTURE_RING,
+    /** The data is recorded in full, and the USB host reads the trace while capturing */
+    TRAFFIC_CAPTURE_SESSION
+} traffic_capture_mode_t;
+
+#if TRAFFIC_CAPTURE
+#define TRAFFIC_CAPTURE_DATA(type, data, length) traffic_capture_record (type, data, length)
+#define TRAFFIC_CAPTURE_EVENT(type) traffic_capture_record (type, NULL, 0)
+#else
+#define TRAFFIC_CAPTURE_DATA(type, data, length)
+#define TRAFFIC_CAPTURE_EVENT(type)
+#endif
+
+void traffic_capture_init (void);
+void traffic_capture_record (const traffic_capture_type_t type, const void *const data, const uint32_t length);
+bool traffic_capture_control (const uint32_t mode);
+uint32_t traffic_capture_dump (const bool rewind, const uint32_t max_length, const uint8_t **const dump);
+
+#endif /* TRAFFIC_CAPTURE_H_ */
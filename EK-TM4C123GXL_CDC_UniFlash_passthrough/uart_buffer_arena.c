@@ -0,0 +1,258 @@
+/*
+ * @file uart_buffer_arena.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Run time partitioning of the CDC ring buffers from a static SRAM arena
+ * @details
+ *  Writing a flash image needs a deep buffer for data from the USB host to the UART, to absorb the time the
+ *  CC3100 spends writing its serial flash, whereas reading files needs a deep buffer for data from the UART to
+ *  the USB host, to absorb the gaps in USB scheduling. Rather than fixing both buffers at the same size, the
+ *  cdc_rx_buffer and cdc_tx_buffer rings are partitioned from one static arena at run time.
+ *
+ *  Each ring is a power of 2 in size, of at least UART_BUFFER_MIN_SIZE. The partition is either:
+ *  - Set explicitly by the USB host with VENDOR_REQUEST_SET_BUFFER_PARTITION.
+ *  - Chosen automatically at the start of each session, when the USB host asserts DTR. If during the previous
+ *    session one direction filled its ring while the other direction used no more than half of its ring, the
+ *    deep buffer is given to the direction which filled.
+ *
+ *  The producer of each ring records the high-water mark of the bytes queued, which is reported by
+ *  VENDOR_REQUEST_GET_BUFFER_STATS so that the buffer sizes can be chosen from evidence.
+ *
+ *  A ring can only be moved while it is empty, so a new partition is left pending until both rings are empty.
+ *  The partition is then applied at the USB interrupt priority with the UART interrupt masked and the receive
+ *  uDMA stopped, so that neither the UART interrupt handler nor the uDMA can access the rings.
+ *
+ *  Apart from uart_buffer_arena_repartition_pending() the functions are called at the USB interrupt priority.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/interrupt.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "uart_dma.h"
+#include "cc3100_programmer.h"
+#include "uart_buffer_arena.h"
+
+/** The storage partitioned between cdc_rx_buffer and cdc_tx_buffer */
+static uint8_t arena[UART_BUFFER_ARENA_SIZE];
+
+/** When true the partition is chosen automatically at the start of each session */
+static bool automatic_partition = true;
+
+/** When true a new partition is waiting for both rings to be empty */
+static volatile bool repartition_pending;
+
+/** The sizes of the new partition, valid when repartition_pending is true */
+static uint32_t pending_host_to_uart_size;
+static uint32_t pending_uart_to_host_size;
+
+/** The number of times the arena has been re-partitioned */
+static uint32_t num_repartitions;
+
+/** A copy of the statistics, which is sent to the USB host */
+static uart_buffer_arena_stats_t arena_stats_snapshot;
+
+/**
+ * @param[in] limit The maximum size
+ * @return Returns the largest power of 2 which doesn't exceed limit
+ */
+static uint32_t largest_power_of_2 (const uint32_t limit)
+{
+    uint32_t size = 1;
+
+    while ((size * 2) <= limit)
+    {
+        size *= 2;
+    }
+
+    return size;
+}
+
+/**
+ * @return Returns true if size is a valid size for a ring
+ */
+static bool ring_size_valid (const uint32_t size)
+{
+    return (size >= UART_BUFFER_MIN_SIZE) && ((size & (size - 1)) == 0);
+}
+
+/**
+ * @brief Partition the arena, giving the rings the specified sizes
+ * @details Must be called while neither ring can be accessed
+ * @param[in] host_to_uart_size The size for cdc_rx_buffer
+ * @param[in] uart_to_host_size The size for cdc_tx_buffer
+ */
+static void partition_arena (const uint32_t host_to_uart_size, const uint32_t uart_to_host_size)
+{
+    spsc_ring_init (&cdc_rx_buffer, &arena[0], host_to_uart_size);
+    spsc_ring_init (&cdc_tx_buffer, &arena[host_to_uart_size], uart_to_host_size);
+}
+
+/**
+ * @brief Request a new partition, which is applied once both rings are empty
+ * @param[in] host_to_uart_size The size for cdc_rx_buffer
+ * @param[in] uart_to_host_size The size for cdc_tx_buffer
+ */
+static void request_partition (const uint32_t host_to_uart_size, const uint32_t uart_to_host_size)
+{
+    if ((host_to_uart_size == spsc_ring_size (&cdc_rx_buffer)) &&
+        (uart_to_host_size == spsc_ring_size (&cdc_tx_buffer)))
+    {
+        /* Already partitioned as requested, which discards any different partition which was pending */
+        repartition_pending = false;
+    }
+    else
+    {
+        pending_host_to_uart_size = host_to_uart_size;
+        pending_uart_to_host_size = uart_to_host_size;
+        repartition_pending = true;
+        uart_buffer_arena_service ();
+    }
+}
+
+/**
+ * @brief Set the initial partition, which gives the deep buffer to data from the USB host to the UART.
+ * @details Called before the UART or USB interrupts are enabled.
+ */
+void uart_buffer_arena_init (void)
+{
+    const uint32_t host_to_uart_size = largest_power_of_2 (UART_BUFFER_ARENA_SIZE - UART_BUFFER_MIN_SIZE);
+
+    partition_arena (host_to_uart_size, largest_power_of_2 (UART_BUFFER_ARENA_SIZE - host_to_uart_size));
+}
+
+/**
+ * @brief Handle a request from the USB host to set the partition
+ * @param[in] host_to_uart_size The size for cdc_rx_buffer
+ * @param[in] uart_to_host_size The size for cdc_tx_buffer
+ * @return Returns true if the request is valid.
+ *         When both sizes are zero the partition is chosen automatically from the start of the next session.
+ */
+bool uart_buffer_arena_request (const uint32_t host_to_uart_size, const uint32_t uart_to_host_size)
+{
+    bool valid = false;
+
+    if ((host_to_uart_size == 0) && (uart_to_host_size == 0))
+    {
+        automatic_partition = true;
+        valid = true;
+    }
+    else if (ring_size_valid (host_to_uart_size) && ring_size_valid (uart_to_host_size) &&
+             ((host_to_uart_size + uart_to_host_size) <= UART_BUFFER_ARENA_SIZE))
+    {
+        automatic_partition = false;
+        request_partition (host_to_uart_size, uart_to_host_size);
+        valid = true;
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Called when the USB host asserts DTR, to choose the partition for the new session from the high-water
+ *        marks of the previous session, and then reset the high-water marks.
+ */
+void uart_buffer_arena_session_start (void)
+{
+    const uint32_t host_to_uart_size = spsc_ring_size (&cdc_rx_buffer);
+    const uint32_t uart_to_host_size = spsc_ring_size (&cdc_tx_buffer);
+    const uint32_t deep_size = largest_power_of_2 (UART_BUFFER_ARENA_SIZE - UART_BUFFER_MIN_SIZE);
+    const uint32_t shallow_size = largest_power_of_2 (UART_BUFFER_ARENA_SIZE - deep_size);
+
+    if (automatic_partition)
+    {
+        if ((cdc_rx_buffer.high_water >= host_to_uart_size) &&
+            (cdc_tx_buffer.high_water <= (uart_to_host_size / 2)))
+        {
+            request_partition (deep_size, shallow_size);
+        }
+        else if ((cdc_tx_buffer.high_water >= uart_to_host_size) &&
+                 (cdc_rx_buffer.high_water <= (host_to_uart_size / 2)))
+        {
+            request_partition (shallow_size, deep_size);
+        }
+    }
+
+    uart_buffer_arena_clear_high_water ();
+}
+
+/**
+ * @return Returns true if a new partition is waiting for both rings to be empty.
+ *         May be called from the UART interrupt handler.
+ */
+bool uart_buffer_arena_repartition_pending (void)
+{
+    return repartition_pending;
+}
+
+/**
+ * @brief Apply a pending partition, if both rings are empty
+ * @details Called from the deferred work handler, which is triggered when either ring may have become empty
+ *          while a partition is pending. Not applied during a CC3100 programming run, which has taken the UART
+ *          and receive uDMA from the bridge.
+ */
+void uart_buffer_arena_service (void)
+{
+    if (repartition_pending && !cc3100_programmer_active () &&
+        (spsc_ring_used (&cdc_rx_buffer) == 0) && (spsc_ring_used (&cdc_tx_buffer) == 0))
+    {
+        /* Stop the UART interrupt handler and receive uDMA from accessing the rings. Stopping the uDMA commits
+         * any characters already received, so the rings have to be checked again. */
+        hal_uart_int_mask (CC3100_UART_INT);
+#if UART_RX_USE_UDMA
+        uart_rx_dma_stop (&uart_channels[UART_CHANNEL_CC3100]);
+#endif
+        if ((spsc_ring_used (&cdc_rx_buffer) == 0) && (spsc_ring_used (&cdc_tx_buffer) == 0))
+        {
+            partition_arena (pending_host_to_uart_size, pending_uart_to_host_size);
+            num_repartitions++;
+            repartition_pending = false;
+        }
+#if UART_RX_USE_UDMA
+        uart_rx_dma_start (&uart_channels[UART_CHANNEL_CC3100]);
+#endif
+        hal_uart_int_unmask (CC3100_UART_INT);
+
+        /* Let the UART interrupt handler update the flow control for the new free space */
+        hal_uart_int_trigger (CC3100_UART_INT);
+    }
+}
+
+/**
+ * @brief Reset the high-water marks of both rings
+ */
+void uart_buffer_arena_clear_high_water (void)
+{
+    /* cdc_tx_buffer is written by the UART interrupt handler */
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    cdc_rx_buffer.high_water = spsc_ring_used (&cdc_rx_buffer);
+    cdc_tx_buffer.high_water = spsc_ring_used (&cdc_tx_buffer);
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+}
+
+/**
+ * @brief Take a copy of the buffer arena statistics
+ * @param[out] snapshot Set to point at the copy of the statistics
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t uart_buffer_arena_snapshot (const uart_buffer_arena_stats_t **const snapshot)
+{
+    arena_stats_snapshot.arena_size = UART_BUFFER_ARENA_SIZE;
+    arena_stats_snapshot.host_to_uart_size = spsc_ring_size (&cdc_rx_buffer);
+    arena_stats_snapshot.uart_to_host_size = spsc_ring_size (&cdc_tx_buffer);
+    arena_stats_snapshot.host_to_uart_high_water = cdc_rx_buffer.high_water;
+    arena_stats_snapshot.uart_to_host_high_water = cdc_tx_buffer.high_water;
+    arena_stats_snapshot.num_repartitions = num_repartitions;
+    arena_stats_snapshot.automatic = automatic_partition;
+    arena_stats_snapshot.repartition_pending = repartition_pending;
+    *snapshot = &arena_stats_snapshot;
+    return sizeof (arena_stats_snapshot);
+}
@@ -0,0 +1,41 @@
+/*
+ * @file uart_buffer_arena.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Run time partitioning of the CDC ring buffers from a static SRAM arena
+ */
+
+#ifndef UART_BUFFER_ARENA_H_
+#define UART_BUFFER_ARENA_H_
+
+/** Statistics about the partitioning of the buffer arena, which is sent to the USB host as
+ *  little-endian 32-bit words. */
+typedef struct
+{
+    /** The total size of the arena, which is UART_BUFFER_ARENA_SIZE */
+    uint32_t arena_size;
+    /** The current size of the buffer for data from the USB host to the UART (cdc_rx_buffer) */
+    uint32_t host_to_uart_size;
+    /** The current size of the buffer for data from the UART to the USB host (cdc_tx_buffer) */
+    uint32_t uart_to_host_size;
+    /** The most bytes queued from the USB host to the UART, since the last partition, clear or session start */
+    uint32_t host_to_uart_high_water;
+    /** The most bytes queued from the UART to the USB host, since the last partition, clear or session start */
+    uint32_t uart_to_host_high_water;
+    /** The number of times the arena has been re-partitioned */
+    uint32_t num_repartitions;
+    /** Non-zero if the partition is chosen automatically at the start of each session */
+    uint32_t automatic;
+    /** Non-zero if a new partition is waiting for both buffers to be empty */
+    uint32_t repartition_pending;
+} uart_buffer_arena_stats_t;
+
+void uart_buffer_arena_init (void);
+bool uart_buffer_arena_request (const uint32_t host_to_uart_size, const uint32_t uart_to_host_size);
+void uart_buffer_arena_session_start (void);
+bool uart_buffer_arena_repartition_pending (void);
+void uart_buffer_arena_service (void);
+void uart_buffer_arena_clear_high_water (void);
+uint32_t uart_buffer_arena_snapshot (const uart_buffer_arena_stats_t **const snapshot);
+
+#endif /* UART_BUFFER_ARENA_H_ */
@@ -0,0 +1,313 @@
+/*
+ * @file uart_channels.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief The UART channels, each bridged to its own CDC port, to flash several CC3100 modules in parallel
+ * @details
+ *  Each channel is described by an entry in uart_channels[], giving its UART, uDMA channels, ring buffers and
+ *  CDC device. Channel 0 is the CC3100BOOST on UART1. The data path, uDMA transfers, UART interrupt handler, flow
+ *  control, line error reporting and USB IN flush policy are shared by all channels, and are passed the
+ *  uart_channel_t of the channel being serviced, which is also the callback data of its CDC device.
+ *
+ *  When UART_EXTRA_CHANNELS is non-zero this module also configures the pins and timers of the extra channels.
+ *  A CDC SEND_BREAK on an extra channel runs the default break sequence of cc3100_sequence.c, timed by the
+ *  subtimer of UART_CHANNEL_NHIB_TIMER_BASE of the channel:
+ *  - Channel 1 is UART3 on PC6 (RX) and PC7 (TX) with nHIB on PE2.
+ *  - Channel 2 is UART2 on PD6 (RX) and PD7 (TX) with nHIB on PE3. PD7 is locked at reset as the NMI pin,
+ *    so is unlocked before being assigned to the UART.
+ *  The TM4C123 only has RTS and CTS pins on UART1, so the extra channels have no flow control.
+ *
+ *  The CDC ports are distinguished by their interface strings, which are set in the composite configuration
+ *  descriptor once built since the usblib CDC class uses fixed string indices.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_gpio.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/timer.h>
+#include <driverlib/udma.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdcomp.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "spi_passthrough.h"
+#include "uart_channels.h"
+
+#if UART_EXTRA_CHANNELS && SPI_PASSTHROUGH
+#error UART_EXTRA_CHANNELS and SPI_PASSTHROUGH both define the composite device, so are not supported together
+#endif
+
+/** The uDMA channel number of a uDMA channel assignment */
+#define UDMA_MAPPING_CHANNEL(mapping) ((mapping) & 0xFF)
+
+#if UART_EXTRA_CHANNELS
+/** The ring buffers of the extra channels */
+static spsc_ring_t channel_host_to_uart[UART_EXTRA_CHANNELS];
+static spsc_ring_t channel_uart_to_host[UART_EXTRA_CHANNELS];
+static uint8_t channel_host_to_uart_storage[UART_EXTRA_CHANNELS][UART_CHANNEL_BUFFER_SIZE];
+static uint8_t channel_uart_to_host_storage[UART_EXTRA_CHANNELS][UART_CHANNEL_BUFFER_SIZE];
+#endif
+
+const uart_channel_t uart_channels[UART_NUM_CHANNELS] =
+{
+    {
+        .index = UART_CHANNEL_CC3100,
+        .uart_base = CC3100_UART_BASE,
+        .uart_int = CC3100_UART_INT,
+        .udma_rx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH22_UART1RX),
+        .udma_tx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH23_UART1TX),
+        .udma_rx_mapping = UDMA_CH22_UART1RX,
+        .udma_tx_mapping = UDMA_CH23_UART1TX,
+        .modem_flow_control = true,
+        .nhib_port_base = CC3100_NHIB_PORT_BASE,
+        .nhib_pin = CC3100_NHIB_PIN,
+        .sequence_timer_base = NHIB_TIMER_BASE,
+        .sequence_timer = TIMER_A,
+        .flush_timer_base = USB_IN_FLUSH_TIMER_BASE,
+        .host_to_uart = &cdc_rx_buffer,
+        .uart_to_host = &cdc_tx_buffer,
+        .cdc_device = &CDC_device
+    },
+#if UART_EXTRA_CHANNELS > 0
+    {
+        .index = 1,
+        .uart_base = UART3_BASE,
+        .uart_int = INT_UART3,
+        .udma_rx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH16_UART3RX),
+        .udma_tx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH17_UART3TX),
+        .udma_rx_mapping = UDMA_CH16_UART3RX,
+        .udma_tx_mapping = UDMA_CH17_UART3TX,
+        .modem_flow_control = false,
+        .nhib_port_base = GPIO_PORTE_BASE,
+        .nhib_pin = GPIO_PIN_2,
+        .sequence_timer_base = UART_CHANNEL_NHIB_TIMER_BASE,
+        .sequence_timer = TIMER_A,
+        .flush_timer_base = TIMER2_BASE,
+        .host_to_uart = &channel_host_to_uart[0],
+        .uart_to_host = &channel_uart_to_host[0],
+        .cdc_device = &uart_channel_cdc_devices[0]
+    },
+#endif
+#if UART_EXTRA_CHANNELS > 1
+    {
+        .index = 2,
+        .uart_base = UART2_BASE,
+        .uart_int = INT_UART2,
+        .udma_rx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH0_UART2RX),
+        .udma_tx_channel = UDMA_MAPPING_CHANNEL (UDMA_CH1_UART2TX),
+        .udma_rx_mapping = UDMA_CH0_UART2RX,
+        .udma_tx_mapping = UDMA_CH1_UART2TX,
+        .modem_flow_control = false,
+        .nhib_port_base = GPIO_PORTE_BASE,
+        .nhib_pin = GPIO_PIN_3,
+        .sequence_timer_base = UART_CHANNEL_NHIB_TIMER_BASE,
+        .sequence_timer = TIMER_B,
+        .flush_timer_base = TIMER3_BASE,
+        .host_to_uart = &channel_host_to_uart[1],
+        .uart_to_host = &channel_uart_to_host[1],
+        .cdc_device = &uart_channel_cdc_devices[1]
+    }
+#endif
+};
+
+/**
+ * @brief Set the nHIB signal of the CC3100 on a channel
+ * @param[in] channel The channel to set nHIB for
+ * @param[in] asserted When true nHIB is asserted (driven low)
+ */
+void uart_channel_set_nhib (const uart_channel_t *const channel, const bool asserted)
+{
+    hal_gpio_pin_write (channel->nhib_port_base, channel->nhib_pin, asserted ? 0 : channel->nhib_pin);
+}
+
+#if UART_EXTRA_CHANNELS
+
+/* The offsets of the bFunctionClass and iFunction fields in an interface association descriptor */
+#define IAD_FUNCTION_CLASS_OFFSET 4
+#define IAD_IFUNCTION_OFFSET      7
+
+/** The pins and timer interrupts of an extra UART channel, which are only used to initialise the channel */
+typedef struct
+{
+    uint32_t uart_periph;
+    uint32_t gpio_port_base;
+    uint32_t rx_pin_config;
+    uint32_t tx_pin_config;
+    uint8_t pins;
+    /** When true the pins are locked at reset, so have to be unlocked before being re-assigned */
+    bool unlock_pins;
+    /** The interrupt of the uart_channel_t sequence_timer */
+    uint32_t nhib_timer_int;
+    /** The peripheral and interrupt of the uart_channel_t flush_timer_base */
+    uint32_t flush_timer_periph;
+    uint32_t flush_timer_int;
+} uart_channel_pins_t;
+
+static const uart_channel_pins_t channel_pins[UART_EXTRA_CHANNELS] =
+{
+    {
+        .uart_periph = SYSCTL_PERIPH_UART3,
+        .gpio_port_base = GPIO_PORTC_BASE,
+        .rx_pin_config = GPIO_PC6_U3RX,
+        .tx_pin_config = GPIO_PC7_U3TX,
+        .pins = GPIO_PIN_6 | GPIO_PIN_7,
+        .unlock_pins = false,
+        .nhib_timer_int = INT_WTIMER1A,
+        .flush_timer_periph = SYSCTL_PERIPH_TIMER2,
+        .flush_timer_int = INT_TIMER2A
+    },
+#if UART_EXTRA_CHANNELS > 1
+    {
+        .uart_periph = SYSCTL_PERIPH_UART2,
+        .gpio_port_base = GPIO_PORTD_BASE,
+        .rx_pin_config = GPIO_PD6_U2RX,
+        .tx_pin_config = GPIO_PD7_U2TX,
+        .pins = GPIO_PIN_6 | GPIO_PIN_7,
+        .unlock_pins = true,
+        .nhib_timer_int = INT_WTIMER1B,
+        .flush_timer_periph = SYSCTL_PERIPH_TIMER3,
+        .flush_timer_int = INT_TIMER3A
+    }
+#endif
+};
+
+/**
+ * @return Returns the pins and timer interrupts of an extra channel
+ */
+static const uart_channel_pins_t *pins_of (const uart_channel_t *const channel)
+{
+    return &channel_pins[channel->index - 1];
+}
+
+/**
+ * @brief Configure the pins, ring buffers and timers of the extra channels.
+ * @details The UARTs are then configured by main() in the same way as UART1.
+ */
+void uart_channels_init (void)
+{
+    uint32_t channel_index;
+    const uart_channel_t *channel;
+    const uart_channel_pins_t *pins;
+
+    SysCtlPeripheralEnable (UART_CHANNEL_NHIB_TIMER_PERIPH);
+    SysCtlPeripheralSleepEnable (UART_CHANNEL_NHIB_TIMER_PERIPH);
+    TimerConfigure (UART_CHANNEL_NHIB_TIMER_BASE,
+                    TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_ONE_SHOT | TIMER_CFG_B_ONE_SHOT);
+
+    for (channel_index = 1; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        channel = &uart_channels[channel_index];
+        pins = pins_of (channel);
+        spsc_ring_init (channel->host_to_uart, channel_host_to_uart_storage[channel_index - 1],
+                        UART_CHANNEL_BUFFER_SIZE);
+        spsc_ring_init (channel->uart_to_host, channel_uart_to_host_storage[channel_index - 1],
+                        UART_CHANNEL_BUFFER_SIZE);
+
+        /* The GPIO ports are already enabled for UART1 and the CC3100BOOST nHIB */
+        SysCtlPeripheralEnable (pins->uart_periph);
+        SysCtlPeripheralSleepEnable (pins->uart_periph);
+        if (pins->unlock_pins)
+        {
+            HWREG (pins->gpio_port_base + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+            HWREG (pins->gpio_port_base + GPIO_O_CR) |= pins->pins;
+            HWREG (pins->gpio_port_base + GPIO_O_LOCK) = 0;
+        }
+        GPIOPinConfigure (pins->rx_pin_config);
+        GPIOPinConfigure (pins->tx_pin_config);
+        GPIOPinTypeUART (pins->gpio_port_base, pins->pins);
+
+        GPIOPinTypeGPIOOutput (channel->nhib_port_base, channel->nhib_pin);
+        uart_channel_set_nhib (channel, false);
+
+        TimerIntEnable (channel->sequence_timer_base, hal_subtimer_timeout (channel->sequence_timer));
+        IntPrioritySet (pins->nhib_timer_int, USB_INT_PRIORITY);
+        IntEnable (pins->nhib_timer_int);
+
+        SysCtlPeripheralEnable (pins->flush_timer_periph);
+        SysCtlPeripheralSleepEnable (pins->flush_timer_periph);
+        TimerConfigure (channel->flush_timer_base, TIMER_CFG_ONE_SHOT);
+        TimerIntEnable (channel->flush_timer_base, TIMER_TIMA_TIMEOUT);
+        IntPrioritySet (pins->flush_timer_int, USB_INT_PRIORITY);
+        IntEnable (pins->flush_timer_int);
+    }
+}
+
+/**
+ * @brief Initialise the CDC devices for the extra channels, and add them to the composite device
+ * @param[in] index The USB controller to use
+ * @return Returns the CDC device instance of the final channel, or NULL on error
+ */
+void *uart_channels_usb_init (const uint32_t index)
+{
+    void *cdc_instance = NULL;
+    uint32_t channel_index;
+
+    for (channel_index = 1; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        cdc_instance = USBDCDCCompositeInit (index, uart_channels[channel_index].cdc_device,
+                                             &composite_entries[COMPOSITE_ENTRY_CHANNEL (channel_index)]);
+        if (cdc_instance == NULL)
+        {
+            break;
+        }
+    }
+
+    return cdc_instance;
+}
+
+/**
+ * @brief Give each CDC port its own interface string, by setting the string indices in the composite
+ *        configuration descriptor built by USBDCompositeInit().
+ * @details Must be called while the device is disconnected from the bus, so the USB host can't have read the
+ *          configuration descriptor. The CDC ports are found in the order of the composite entries, from their
+ *          interface association and communication interface descriptors.
+ */
+void uart_channels_set_port_strings (void)
+{
+    uint32_t offset = 0;
+    uint32_t iad_port = 0;
+    uint32_t interface_port = 0;
+    tDescriptorHeader *header;
+    tInterfaceDescriptor *interface;
+
+    while ((offset + sizeof (tDescriptorHeader)) <= sizeof (composite_descriptor))
+    {
+        header = (tDescriptorHeader *) &composite_descriptor[offset];
+        if (header->bLength == 0)
+        {
+            break;
+        }
+
+        if ((header->bDescriptorType == USB_DTYPE_INTERFACE_ASC) &&
+            (composite_descriptor[offset + IAD_FUNCTION_CLASS_OFFSET] == USB_CLASS_CDC) &&
+            (iad_port < NUM_COMPOSITE_ENTRIES))
+        {
+            composite_descriptor[offset + IAD_IFUNCTION_OFFSET] = PORT_STRING_INDEX (iad_port);
+            iad_port++;
+        }
+        else if ((header->bDescriptorType == USB_DTYPE_INTERFACE) && (interface_port < NUM_COMPOSITE_ENTRIES))
+        {
+            interface = (tInterfaceDescriptor *) header;
+            if (interface->bInterfaceClass == USB_CLASS_CDC)
+            {
+                interface->iInterface = PORT_STRING_INDEX (interface_port);
+                interface_port++;
+            }
+        }
+        offset += header->bLength;
+    }
+}
+
+#endif /* UART_EXTRA_CHANNELS */
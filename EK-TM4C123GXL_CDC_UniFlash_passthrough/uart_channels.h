@@ -0,0 +1,102 @@
+/*
+ * @file uart_channels.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief The UART channels, each bridged to its own CDC port, to flash several CC3100 modules in parallel
+ */
+
+#ifndef UART_CHANNELS_H_
+#define UART_CHANNELS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <usblib/usblib.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "spsc_ring.h"
+
+/** The number of extra UART channels. When non-zero the USB device is a composite of the CDC device for the
+ *  CC3100BOOST on UART1 followed by a CDC device for each extra channel. When zero the USB device is only the
+ *  CDC device for the CC3100BOOST. */
+#ifndef UART_EXTRA_CHANNELS
+#define UART_EXTRA_CHANNELS 0
+#endif
+
+/** The size of each of the buffers for an extra channel, which must be a power of 2 */
+#ifndef UART_CHANNEL_BUFFER_SIZE
+#define UART_CHANNEL_BUFFER_SIZE 1024
+#endif
+
+#if UART_EXTRA_CHANNELS > 2
+#error The pins are only allocated for two extra UART channels
+#endif
+
+#if (UART_CHANNEL_BUFFER_SIZE & (UART_CHANNEL_BUFFER_SIZE - 1)) != 0
+#error UART_CHANNEL_BUFFER_SIZE must be a power of 2
+#endif
+
+/** The total number of UART channels, of which channel 0 is the CC3100BOOST on UART1 */
+#define UART_NUM_CHANNELS (1 + UART_EXTRA_CHANNELS)
+
+/** The channel of the CC3100BOOST on UART1. Only this channel has the RTS/CTS pins, the nRESET, the sequences which
+ *  can be changed by the USB host, the traffic capture, the data path telemetry and the partitioned buffer arena.
+ *  The extra channels run the default break sequence. */
+#define UART_CHANNEL_CC3100 0
+
+/** The context of a UART channel, passed to the data path, uDMA and UART interrupt handler functions which are
+ *  shared by all channels. The state of each channel is held by each module, indexed by the channel index. */
+typedef struct
+{
+    /** The index of this channel in uart_channels[] */
+    uint32_t index;
+    uint32_t uart_base;
+    uint32_t uart_int;
+    /** The uDMA channels, and the channel assignments which map them to the UART */
+    uint32_t udma_rx_channel;
+    uint32_t udma_tx_channel;
+    uint32_t udma_rx_mapping;
+    uint32_t udma_tx_mapping;
+    /** When true the UART has RTS and CTS pins, for flow control */
+    bool modem_flow_control;
+    /** The GPIO for the nHIB signal of the CC3100 on this channel */
+    uint32_t nhib_port_base;
+    uint8_t nhib_pin;
+    /** The one-shot timer, and which of its subtimers, used to time the steps of the nHIB and break sequences */
+    uint32_t sequence_timer_base;
+    uint32_t sequence_timer;
+    /** The one-shot timer used to time the USB IN flush latency */
+    uint32_t flush_timer_base;
+    /** Written with packets from the USB host, and read by the UART interrupt handler */
+    spsc_ring_t *host_to_uart;
+    /** Written by the UART interrupt handler, and read to send packets to the USB host */
+    spsc_ring_t *uart_to_host;
+    /** The CDC device for the channel, whose callback data is this context */
+    tUSBDCDCDevice *cdc_device;
+} uart_channel_t;
+
+extern const uart_channel_t uart_channels[UART_NUM_CHANNELS];
+
+void uart_channel_set_nhib (const uart_channel_t *const channel, const bool asserted);
+void uart_channel_interrupt_handler (const uart_channel_t *const channel);
+
+#if UART_EXTRA_CHANNELS
+
+/** The index in the composite device string table of the interface string for each CDC port, where port 0 is
+ *  the CC3100BOOST on UART1 and port N is extra channel N */
+#define PORT_STRING_INDEX(port) (6 + (port))
+
+extern tUSBDCDCDevice uart_channel_cdc_devices[UART_EXTRA_CHANNELS];
+
+void uart_channels_init (void);
+void *uart_channels_usb_init (const uint32_t index);
+void uart_channels_set_port_strings (void);
+
+#endif /* UART_EXTRA_CHANNELS */
+
+void uart_channel_1_interrupt_handler (void);
+void uart_channel_2_interrupt_handler (void);
+void uart_channel_1_flush_timer_handler (void);
+void uart_channel_2_flush_timer_handler (void);
+
+#endif /* UART_CHANNELS_H_ */
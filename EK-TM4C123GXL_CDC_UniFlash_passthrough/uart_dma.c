@@ -0,0 +1,371 @@
+/*
+ * @file uart_dma.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief uDMA transfers between the UART of each channel and its ring buffers
+ * @details
+ *  The receive direction uses a ping-pong uDMA transfer, in which each half is programmed to write to the
+ *  next contiguous span of free space in the uart_to_host ring. When a half completes the data is
+ *  committed to be passed to the USB stack, without any copying.
+ *
+ *  The uDMA only responds to burst requests from the UART, which are raised when the receive FIFO reaches
+ *  its trigger level, and each burst is smaller than the trigger level. Therefore when the CC3100 stops
+ *  transmitting at least one of the final characters of a response is left in the UART FIFO, which causes a
+ *  receive timeout interrupt. On the receive timeout the partially
+ *  filled half is committed, the characters remaining in the FIFO are read by the CPU, and
+ *  the ping-pong transfer is restarted.
+ *
+ *  If there is no free space in uart_to_host the uDMA transfer is left stopped, and is restarted once
+ *  the USB host has read data.
+ *
+ *  The transmit direction uses a basic uDMA transfer from the longest contiguous span of data in the
+ *  host_to_uart ring to the UART transmit FIFO. The uDMA responds to single requests from the UART, so
+ *  keeps the transmit FIFO full. When the transfer completes the span is consumed from host_to_uart, and a
+ *  transfer is started for the next span. The next transfer is started
+ *  while the transmit FIFO still contains characters, so there are no gaps in transmission.
+ *
+ *  Each UART channel has its own pair of uDMA channels, given by its uart_channel_t, and the transfer state is
+ *  held for each channel.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_uart.h>
+#include <driverlib/uart.h>
+#include <driverlib/udma.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "usb_serial_structs.h"
+#include "check_assert.h"
+#include "udma_control.h"
+#include "uart_dma.h"
+#include "usb_in_flush.h"
+#include "uart_fifo_levels.h"
+#include "usb_data_path.h"
+#include "uart_channels.h"
+
+/** The maximum number of items in one uDMA transfer */
+#define UART_DMA_MAX_TRANSFER_SIZE 1024
+
+/** Defines one half of the ping-pong receive transfer, as a span of the uart_to_host ring */
+typedef struct
+{
+    /** The number of characters the uDMA was programmed to transfer, or zero if this half is not armed */
+    uint32_t length;
+} rx_dma_block_t;
+
+/** The uDMA transfer state of one UART channel */
+typedef struct
+{
+    /** The current state of the two halves of the ping-pong receive transfer */
+    rx_dma_block_t rx_dma_blocks[2];
+    /** The half of the ping-pong receive transfer which the uDMA will complete next */
+    uint32_t rx_dma_active_half;
+    /** The number of characters of free space following the head of the uart_to_host ring which have been given
+     *  to the uDMA, but not yet committed. The next half to be armed starts this far beyond the head. */
+    uint32_t rx_dma_reserved;
+    /** The number of characters in the current uDMA transmit transfer, or zero if no transfer is in progress */
+    uint32_t tx_dma_length;
+} channel_dma_t;
+
+/** The uDMA control structure selects for the two halves of the ping-pong receive transfer */
+static const uint32_t rx_dma_selects[2] = {UDMA_PRI_SELECT, UDMA_ALT_SELECT};
+
+static channel_dma_t channel_dma[UART_NUM_CHANNELS];
+
+/** The destination given to the uDMA for a disarmed half, which is never written since the mode is stop */
+static uint8_t rx_dma_disarmed_destination;
+
+/**
+ * @brief Set the uDMA control structure for one half of the ping-pong receive transfer to the stop mode
+ * @details Only zeroing the length recorded for the half would leave the control structure with the mode, destination
+ *          and count from when it was last armed. The uDMA would then continue into the stale half when the other
+ *          half completes, and overwrite data in uart_to_host which has yet to be sent to the USB host.
+ *          The transfer size is one as uDMAChannelTransferSet() can't encode a size of zero.
+ * @param[in] channel The channel of the receive transfer
+ * @param[in] half Which half of the ping-pong receive transfer to disarm
+ */
+static void disarm_rx_block (const uart_channel_t *const channel, const uint32_t half)
+{
+    uDMAChannelTransferSet (channel->udma_rx_channel | rx_dma_selects[half], UDMA_MODE_STOP,
+                            (void *) (channel->uart_base + UART_O_DR), &rx_dma_disarmed_destination, 1);
+}
+
+/**
+ * @brief Program one half of the ping-pong receive transfer with the next span of free space in uart_to_host
+ * @details If there is no free space the half is disarmed, by setting its control structure to the stop mode,
+ *          so that the uDMA stops once the other half has completed.
+ * @param[in] channel The channel of the receive transfer
+ * @param[in] half Which half of the ping-pong receive transfer to arm
+ */
+static void arm_rx_block (const uart_channel_t *const channel, const uint32_t half)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+    uint8_t *span;
+    uint32_t length;
+
+    span = spsc_ring_write_span_at (channel->uart_to_host, dma->rx_dma_reserved, &length);
+    if (length > usb_in_flush_fill_threshold ())
+    {
+        length = usb_in_flush_fill_threshold ();
+    }
+
+    dma->rx_dma_blocks[half].length = length;
+    if (length > 0)
+    {
+        uDMAChannelTransferSet (channel->udma_rx_channel | rx_dma_selects[half], UDMA_MODE_PINGPONG,
+                                (void *) (channel->uart_base + UART_O_DR), span, length);
+        dma->rx_dma_reserved += length;
+    }
+    else
+    {
+        disarm_rx_block (channel, half);
+    }
+}
+
+/**
+ * @brief Commit the characters written by the uDMA for one half of the ping-pong receive
+ * @details The halves are committed in the order they were armed, so the characters are at the head of the ring.
+ * @param[in] channel The channel of the receive transfer
+ * @param[in] half Which half of the ping-pong receive transfer to commit
+ * @param[in] num_received The number of characters which the uDMA has written
+ */
+static void commit_rx_block (const uart_channel_t *const channel, const uint32_t half, const uint32_t num_received)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+
+    dma->rx_dma_reserved -= dma->rx_dma_blocks[half].length;
+    if (num_received > 0)
+    {
+        usb_data_path_tx_produced (channel, num_received);
+        uart_fifo_levels_count_rx (channel, num_received);
+    }
+    dma->rx_dma_blocks[half].length = 0;
+}
+
+/**
+ * @param[in] rx_level The UART receive FIFO trigger level
+ * @return Returns the uDMA arbitration size for the UART receive channel, which is the largest burst which is
+ *         smaller than the trigger level. A burst equal to the trigger level would empty the FIFO whenever the
+ *         CC3100 sent a multiple of the trigger level, so no receive timeout would occur and the characters
+ *         written to the partially filled half would not be passed to the USB host until more were received.
+ */
+static uint32_t rx_dma_arbitration_size (const uint32_t rx_level)
+{
+    switch (rx_level)
+    {
+    case UART_FIFO_RX1_8:
+        return UDMA_ARB_1;
+
+    case UART_FIFO_RX2_8:
+        return UDMA_ARB_2;
+
+    case UART_FIFO_RX4_8:
+        return UDMA_ARB_4;
+
+    default:
+        return UDMA_ARB_8;
+    }
+}
+
+/**
+ * @brief Initialise the uDMA controller, and the uDMA channels of a UART channel which are configured to use uDMA
+ * @param[in] channel The UART channel to initialise the uDMA channels for
+ */
+void uart_dma_init (const uart_channel_t *const channel)
+{
+    udma_control_init ();
+
+#if UART_RX_USE_UDMA
+    /* The uDMA only responds to burst requests from the UART receive FIFO, with the arbitration size
+     * below the UART receive FIFO trigger level. This leaves at least one character in the FIFO, to generate a
+     * receive timeout when the CC3100 stops transmitting. */
+    uDMAChannelAssign (channel->udma_rx_mapping);
+    uDMAChannelAttributeDisable (channel->udma_rx_channel,
+                                 UDMA_ATTR_ALTSELECT | UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+    uDMAChannelAttributeEnable (channel->udma_rx_channel, UDMA_ATTR_USEBURST);
+    uart_rx_dma_trigger_level_set (channel, uart_fifo_levels_rx (channel));
+    UARTDMAEnable (channel->uart_base, UART_DMA_RX);
+#endif
+
+#if UART_TX_USE_UDMA
+    /* The uDMA responds to single requests from the UART transmit FIFO, so that the FIFO is kept full.
+     * The arbitration size is UART_TX_DMA_BURST_CHARS, for the burst requests at the transmit trigger level. */
+    uDMAChannelAssign (channel->udma_tx_mapping);
+    uDMAChannelAttributeDisable (channel->udma_tx_channel,
+                                 UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST | UDMA_ATTR_HIGH_PRIORITY |
+                                 UDMA_ATTR_REQMASK);
+    uDMAChannelControlSet (channel->udma_tx_channel | UDMA_PRI_SELECT,
+                           UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+    UARTDMAEnable (channel->uart_base, UART_DMA_TX);
+#endif
+}
+
+/**
+ * @brief Set the uDMA arbitration size for the receive channel to match the UART receive FIFO trigger level
+ * @details Must be called with the uDMA channel stopped.
+ * @param[in] channel The UART channel to set the arbitration size for
+ * @param[in] rx_level The UART receive FIFO trigger level
+ */
+void uart_rx_dma_trigger_level_set (const uart_channel_t *const channel, const uint32_t rx_level)
+{
+    uDMAChannelControlSet (channel->udma_rx_channel | UDMA_PRI_SELECT,
+                           UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | rx_dma_arbitration_size (rx_level));
+    uDMAChannelControlSet (channel->udma_rx_channel | UDMA_ALT_SELECT,
+                           UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | rx_dma_arbitration_size (rx_level));
+}
+
+/**
+ * @brief Start the ping-pong receive transfer, following the characters already committed
+ * @details Must be called with the uDMA channel stopped.
+ *          If there is no free space in uart_to_host the receive timeout interrupt is disabled, since the
+ *          characters in the UART FIFO can't be read. The caller is responsible for starting the transfer
+ *          again once the USB host has read data.
+ * @param[in] channel The UART channel to start the transfer for
+ */
+void uart_rx_dma_start (const uart_channel_t *const channel)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+
+    dma->rx_dma_active_half = 0;
+    uDMAChannelAttributeDisable (channel->udma_rx_channel, UDMA_ATTR_ALTSELECT);
+
+    arm_rx_block (channel, 0);
+    if (dma->rx_dma_blocks[0].length > 0)
+    {
+        arm_rx_block (channel, 1);
+        uDMAChannelEnable (channel->udma_rx_channel);
+        UARTIntEnable (channel->uart_base, UART_INT_RT);
+    }
+    else
+    {
+        UARTIntDisable (channel->uart_base, UART_INT_RT);
+    }
+}
+
+/**
+ * @brief Stop the ping-pong receive transfer, committing any characters written by the uDMA
+ * @details On return the uDMA channel is stopped, with all of the free space in uart_to_host available
+ *          to be written by the CPU.
+ * @param[in] channel The UART channel to stop the transfer for
+ */
+void uart_rx_dma_stop (const uart_channel_t *const channel)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+    uint32_t half;
+    uint32_t num_remaining;
+
+    uDMAChannelDisable (channel->udma_rx_channel);
+    uart_rx_dma_complete (channel);
+
+    /* The active half may have been partially written before the UART receive line went idle.
+     * If the other half has been armed it can't have started, and so is discarded. Both halves are disarmed,
+     * so that neither control structure is left with a stale destination in uart_to_host. */
+    half = dma->rx_dma_active_half;
+    if (dma->rx_dma_blocks[half].length > 0)
+    {
+        num_remaining = uDMAChannelSizeGet (channel->udma_rx_channel | rx_dma_selects[half]);
+        check_assert (num_remaining <= dma->rx_dma_blocks[half].length);
+        commit_rx_block (channel, half, dma->rx_dma_blocks[half].length - num_remaining);
+    }
+    commit_rx_block (channel, half ^ 1, 0);
+    disarm_rx_block (channel, half);
+    disarm_rx_block (channel, half ^ 1);
+    check_assert (dma->rx_dma_reserved == 0);
+}
+
+/**
+ * @brief Commit the halves of the ping-pong receive transfer which the uDMA has completed,
+ *        and re-arm them with the next span of free space in uart_to_host.
+ * @details Called from the UART interrupt handler, since uDMA completion is signalled on the UART interrupt.
+ * @param[in] channel The UART channel to complete the transfer for
+ */
+void uart_rx_dma_complete (const uart_channel_t *const channel)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+    uint32_t half;
+
+    half = dma->rx_dma_active_half;
+    while ((dma->rx_dma_blocks[half].length > 0) &&
+           (uDMAChannelModeGet (channel->udma_rx_channel | rx_dma_selects[half]) == UDMA_MODE_STOP))
+    {
+        commit_rx_block (channel, half, dma->rx_dma_blocks[half].length);
+        dma->rx_dma_active_half = half ^ 1;
+        if (uDMAChannelIsEnabled (channel->udma_rx_channel))
+        {
+            arm_rx_block (channel, half);
+        }
+        half = dma->rx_dma_active_half;
+    }
+}
+
+/**
+ * @return Returns true if the uDMA is able to receive characters from the UART of a channel.
+ *         When false uart_rx_dma_stop() and uart_rx_dma_start() need to be called to restart the transfer.
+ */
+bool uart_rx_dma_running (const uart_channel_t *const channel)
+{
+    return uDMAChannelIsEnabled (channel->udma_rx_channel);
+}
+
+/**
+ * @brief If no uDMA transmit transfer is in progress, start a transfer for the next contiguous span of data
+ *        in host_to_uart.
+ * @param[in] channel The UART channel to start the transfer for
+ * @param[in] max_length The maximum number of bytes to transfer, used to stop at a line coding change
+ */
+void uart_tx_dma_start (const uart_channel_t *const channel, const uint32_t max_length)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+    uint8_t *span;
+    uint32_t length;
+
+    if (dma->tx_dma_length == 0)
+    {
+        span = spsc_ring_read_span (channel->host_to_uart, &length);
+        if (length > UART_DMA_MAX_TRANSFER_SIZE)
+        {
+            length = UART_DMA_MAX_TRANSFER_SIZE;
+        }
+        if (length > max_length)
+        {
+            length = max_length;
+        }
+
+        if (length > 0)
+        {
+            dma->tx_dma_length = length;
+            uDMAChannelTransferSet (channel->udma_tx_channel | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                                    span, (void *) (channel->uart_base + UART_O_DR), length);
+            uDMAChannelEnable (channel->udma_tx_channel);
+        }
+    }
+}
+
+/**
+ * @brief If the uDMA transmit transfer has completed, consume the transmitted span from host_to_uart.
+ * @details Called from the UART interrupt handler, since uDMA completion is signalled on the UART interrupt.
+ *          The caller then uses uart_tx_dma_start() to start a transfer for the next span.
+ * @param[in] channel The UART channel to complete the transfer for
+ * @return Returns the number of bytes which the completed transfer wrote to the UART transmit FIFO
+ */
+uint32_t uart_tx_dma_complete (const uart_channel_t *const channel)
+{
+    channel_dma_t *const dma = &channel_dma[channel->index];
+    uint32_t num_transmitted = 0;
+
+    if ((dma->tx_dma_length > 0) &&
+        (uDMAChannelModeGet (channel->udma_tx_channel | UDMA_PRI_SELECT) == UDMA_MODE_STOP))
+    {
+        usb_data_path_rx_consumed (channel, dma->tx_dma_length);
+        num_transmitted = dma->tx_dma_length;
+        dma->tx_dma_length = 0;
+    }
+
+    return num_transmitted;
+}
@@ -0,0 +1,49 @@
+/*
+ * @file uart_dma.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief uDMA transfers between the UART of each channel and its ring buffers
+ */
+
+#ifndef UART_DMA_H_
+#define UART_DMA_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** When non-zero characters received on each UART are moved by uDMA ping-pong transfers straight into the
+ *  uart_to_host ring of the channel, and the CPU only runs at block boundaries or on a receive timeout.
+ *  When zero the UART receive FIFO is drained one character at a time by the CPU. */
+#ifndef UART_RX_USE_UDMA
+#define UART_RX_USE_UDMA 1
+#endif
+
+/** When non-zero characters from the USB host are moved by uDMA from contiguous spans of the host_to_uart
+ *  ring of each channel straight into the UART transmit FIFO, keeping the transmit FIFO full.
+ *  When zero the CPU refills the whole UART transmit FIFO on each transmit interrupt. */
+#ifndef UART_TX_USE_UDMA
+#define UART_TX_USE_UDMA 1
+#endif
+
+/* The maximum number of bytes in each half of the ping-pong receive.
+   A block completing is the only point at which received data is passed to the USB stack while the
+   UART is continuously receiving, so this should not be larger than a maximum-sized USB packet.
+   The length actually used is the fill threshold of the USB IN flush policy, which can be reduced at run time. */
+#define UART_RX_DMA_BLOCK_SIZE 64
+
+/** The number of characters the transmit uDMA writes to the UART transmit FIFO for each burst request, which the
+ *  transmit trigger level must leave space for */
+#define UART_TX_DMA_BURST_CHARS 4
+
+void uart_dma_init (const uart_channel_t *const channel);
+void uart_rx_dma_trigger_level_set (const uart_channel_t *const channel, const uint32_t rx_level);
+void uart_rx_dma_start (const uart_channel_t *const channel);
+void uart_rx_dma_stop (const uart_channel_t *const channel);
+void uart_rx_dma_complete (const uart_channel_t *const channel);
+bool uart_rx_dma_running (const uart_channel_t *const channel);
+void uart_tx_dma_start (const uart_channel_t *const channel, const uint32_t max_length);
+uint32_t uart_tx_dma_complete (const uart_channel_t *const channel);
+
+#endif /* UART_DMA_H_ */
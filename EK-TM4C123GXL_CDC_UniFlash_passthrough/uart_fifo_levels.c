@@ -0,0 +1,315 @@
+/*
+ * @file uart_fifo_levels.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Selection of the UART FIFO trigger levels from the line coding and the received burst pattern
+ * @details
+ *  A deep receive trigger level, and a shallow transmit trigger level, minimise the number of interrupts per
+ *  character but leave the least time to service the FIFO before it overruns or underruns. The time taken to
+ *  transfer one character is set by the line coding, so at low baud rates the deepest receive trigger level
+ *  can be used whereas at multi-megabaud rates only the shallowest leaves enough headroom.
+ *
+ *  Within the limit set by the baud rate, the receive trigger level is also chosen from the average length of
+ *  the bursts received from the CC3100, measured between receive timeouts. Bulk streams use a deep receive
+ *  trigger level. Interactive exchanges, with bursts shorter than the FIFO, use a shallow receive trigger level,
+ *  so that fewer characters are left in the FIFO to be read by the CPU on the receive timeout.
+ *
+ *  When UART_RX_USE_UDMA is non-zero the uDMA arbitration size is chosen from the receive trigger level, so a new
+ *  receive trigger level is only applied while the uDMA receive transfer is stopped.
+ *
+ *  The trigger levels are selected for each UART channel from its own line coding and bursts. The statistics sent
+ *  to the USB host are those of channel 0.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/uart.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "uart_dma.h"
+#include "uart_channels.h"
+#include "uart_fifo_levels.h"
+
+/** The depth of the UART FIFOs in characters */
+#define UART_FIFO_DEPTH 16
+
+/* The average burst length is an exponentially weighted moving average, with a weight of 1/2^BURST_AVERAGE_SHIFT
+   given to each new burst. The average is held scaled by 2^BURST_AVERAGE_SHIFT. */
+#define BURST_AVERAGE_SHIFT 3
+
+/** A UART FIFO trigger level, and the number of characters in the FIFO at that level */
+typedef struct
+{
+    uint32_t level;
+    uint32_t num_chars;
+} fifo_trigger_t;
+
+/** The receive trigger levels, from shallowest to deepest */
+static const fifo_trigger_t rx_triggers[] =
+{
+    {UART_FIFO_RX1_8,  2},
+    {UART_FIFO_RX2_8,  4},
+    {UART_FIFO_RX4_8,  8},
+    {UART_FIFO_RX6_8, 12},
+    {UART_FIFO_RX7_8, 14}
+};
+
+/** The transmit trigger levels, from the fewest characters left in the FIFO to the most */
+static const fifo_trigger_t tx_triggers[] =
+{
+    {UART_FIFO_TX1_8,  2},
+    {UART_FIFO_TX2_8,  4},
+    {UART_FIFO_TX4_8,  8},
+    {UART_FIFO_TX6_8, 12},
+    {UART_FIFO_TX7_8, 14}
+};
+
+#define NUM_TRIGGERS (sizeof (rx_triggers) / sizeof (rx_triggers[0]))
+
+/** The index into tx_triggers[] of the deepest transmit trigger level. With the transmit uDMA this is the 6/8 level,
+ *  since a burst of UART_TX_DMA_BURST_CHARS at the 7/8 level would overflow the FIFO. */
+#if UART_TX_USE_UDMA
+#define TX_TRIGGER_DEEPEST (NUM_TRIGGERS - 2)
+#else
+#define TX_TRIGGER_DEEPEST (NUM_TRIGGERS - 1)
+#endif
+
+/** The index into rx_triggers[] of the 2/8 receive trigger level used for interactive exchanges, one deeper than the
+ * shallowest 1/8 level. The end of a short burst is passed on by the receive timeout at any trigger level, so the 1/8
+ * level would only add interrupts within the burst */
+#define RX_TRIGGER_INTERACTIVE 1
+
+/** The trigger level selection for one UART channel */
+typedef struct
+{
+#if UART_FIFO_ADAPTIVE
+    /** The deepest receive trigger level which leaves enough headroom at the current line coding */
+    uint32_t rx_trigger_baud_limit;
+    /** The transmit trigger level which leaves enough characters to send at the current line coding */
+    uint32_t tx_trigger_selected;
+#endif
+    /** The trigger levels which have been applied to the UART, valid when levels_applied is true */
+    bool levels_applied;
+    uint32_t rx_level_applied;
+    uint32_t tx_level_applied;
+    /** The number of characters received since the end of the previous burst */
+    uint32_t burst_length;
+    /** The average burst length, scaled by 2^BURST_AVERAGE_SHIFT */
+    uint32_t scaled_average_burst_length;
+    /** The statistics accumulated by the UART interrupt handler */
+    uart_fifo_stats_t fifo_stats;
+} channel_fifo_levels_t;
+
+#if UART_FIFO_ADAPTIVE
+#define CHANNEL_FIFO_LEVELS_INIT {.rx_trigger_baud_limit = NUM_TRIGGERS - 1, .tx_trigger_selected = 2, \
+                                  .rx_level_applied = UART_FIFO_RX_LEVEL, .tx_level_applied = UART_FIFO_TX_LEVEL}
+#else
+#define CHANNEL_FIFO_LEVELS_INIT {.rx_level_applied = UART_FIFO_RX_LEVEL, .tx_level_applied = UART_FIFO_TX_LEVEL}
+#endif
+
+static channel_fifo_levels_t channel_fifo_levels[UART_NUM_CHANNELS] =
+{
+    CHANNEL_FIFO_LEVELS_INIT,
+#if UART_EXTRA_CHANNELS > 0
+    CHANNEL_FIFO_LEVELS_INIT,
+#endif
+#if UART_EXTRA_CHANNELS > 1
+    CHANNEL_FIFO_LEVELS_INIT
+#endif
+};
+
+/** A consistent copy of the statistics of channel 0, which is sent to the USB host */
+static uart_fifo_stats_t fifo_stats_snapshot;
+
+/**
+ * @param[in] triggers The table of trigger levels to search
+ * @param[in] level The trigger level to find
+ * @return Returns the number of characters in the FIFO at the trigger level
+ */
+static uint32_t trigger_chars (const fifo_trigger_t *const triggers, const uint32_t level)
+{
+    uint32_t index;
+    uint32_t num_chars = 0;
+
+    for (index = 0; index < NUM_TRIGGERS; index++)
+    {
+        if (triggers[index].level == level)
+        {
+            num_chars = triggers[index].num_chars;
+        }
+    }
+
+    return num_chars;
+}
+
+#if UART_FIFO_ADAPTIVE
+/**
+ * @return Returns the receive trigger level for the current line coding and average burst length of a channel
+ */
+static uint32_t select_rx_level (const channel_fifo_levels_t *const levels)
+{
+    uint32_t index = levels->rx_trigger_baud_limit;
+
+    if (((levels->scaled_average_burst_length >> BURST_AVERAGE_SHIFT) < UART_FIFO_DEPTH) &&
+        (index > RX_TRIGGER_INTERACTIVE))
+    {
+        index = RX_TRIGGER_INTERACTIVE;
+    }
+
+    return rx_triggers[index].level;
+}
+#endif
+
+/**
+ * @brief Choose the trigger level limits for a new line coding
+ * @details Takes effect at the next call to uart_fifo_levels_apply()
+ * @param[in] channel The channel the line coding has been applied to
+ * @param[in] baud The baud rate applied to the UART
+ * @param[in] bits_per_char The total number of bits in each character, including the start, parity and stop bits
+ */
+void uart_fifo_levels_line_coding_set (const uart_channel_t *const channel, const uint32_t baud,
+                                       const uint32_t bits_per_char)
+{
+#if UART_FIFO_ADAPTIVE
+    channel_fifo_levels_t *const levels = &channel_fifo_levels[channel->index];
+    const uint64_t char_time_ns = ((uint64_t) bits_per_char * 1000000000) / baud;
+    uint32_t index;
+
+    /* Use the deepest receive trigger level for which the remaining FIFO space takes at least the service latency
+     * to fill, and the shallowest transmit trigger level for which the characters left take at least the service
+     * latency to send. If none are long enough use the shallowest receive and deepest transmit trigger levels. */
+    levels->rx_trigger_baud_limit = 0;
+    levels->tx_trigger_selected = TX_TRIGGER_DEEPEST;
+    for (index = 0; index < NUM_TRIGGERS; index++)
+    {
+        if (((UART_FIFO_DEPTH - rx_triggers[index].num_chars) * char_time_ns) >= UART_FIFO_SERVICE_LATENCY_NS)
+        {
+            levels->rx_trigger_baud_limit = index;
+        }
+    }
+    for (index = TX_TRIGGER_DEEPEST + 1; index > 0; index--)
+    {
+        if ((tx_triggers[index - 1].num_chars * char_time_ns) >= UART_FIFO_SERVICE_LATENCY_NS)
+        {
+            levels->tx_trigger_selected = index - 1;
+        }
+    }
+#else
+    (void) channel;
+    (void) baud;
+    (void) bits_per_char;
+#endif
+}
+
+/**
+ * @brief Called by the UART interrupt handler on a receive timeout, to update the average burst length
+ * @details Takes effect at the next call to uart_fifo_levels_apply()
+ * @param[in] channel The channel which had the receive timeout
+ */
+void uart_fifo_levels_burst_end (const uart_channel_t *const channel)
+{
+    channel_fifo_levels_t *const levels = &channel_fifo_levels[channel->index];
+
+    levels->scaled_average_burst_length +=
+            levels->burst_length - (levels->scaled_average_burst_length >> BURST_AVERAGE_SHIFT);
+    levels->burst_length = 0;
+}
+
+/**
+ * @brief Apply the selected trigger levels to the UART of a channel, if they have changed
+ * @details When UART_RX_USE_UDMA is non-zero must be called with the uDMA receive transfer stopped, so that
+ *          the uDMA arbitration size can be changed for the receive trigger level.
+ * @param[in] channel The channel to apply the trigger levels to
+ */
+void uart_fifo_levels_apply (const uart_channel_t *const channel)
+{
+    channel_fifo_levels_t *const levels = &channel_fifo_levels[channel->index];
+#if UART_FIFO_ADAPTIVE
+    const uint32_t rx_level = select_rx_level (levels);
+    const uint32_t tx_level = tx_triggers[levels->tx_trigger_selected].level;
+#else
+    const uint32_t rx_level = UART_FIFO_RX_LEVEL;
+    const uint32_t tx_level = UART_FIFO_TX_LEVEL;
+#endif
+
+    if (!levels->levels_applied || (rx_level != levels->rx_level_applied) || (tx_level != levels->tx_level_applied))
+    {
+        UARTFIFOLevelSet (channel->uart_base, tx_level, rx_level);
+#if UART_RX_USE_UDMA
+        uart_rx_dma_trigger_level_set (channel, rx_level);
+#endif
+        levels->levels_applied = true;
+        levels->rx_level_applied = rx_level;
+        levels->tx_level_applied = tx_level;
+        levels->fifo_stats.rx_trigger_chars = trigger_chars (rx_triggers, rx_level);
+        levels->fifo_stats.tx_trigger_chars = trigger_chars (tx_triggers, tx_level);
+    }
+}
+
+/**
+ * @return Returns the receive trigger level applied to the UART of a channel
+ */
+uint32_t uart_fifo_levels_rx (const uart_channel_t *const channel)
+{
+    return channel_fifo_levels[channel->index].rx_level_applied;
+}
+
+/**
+ * @brief Called on each entry to the UART interrupt handler of a channel
+ */
+void uart_fifo_levels_count_interrupt (const uart_channel_t *const channel)
+{
+    channel_fifo_levels[channel->index].fifo_stats.num_interrupts++;
+}
+
+/**
+ * @brief Count characters received from the CC3100 which have been passed to the USB stack
+ * @param[in] channel The channel which received the characters
+ * @param[in] num_bytes The number of characters received
+ */
+void uart_fifo_levels_count_rx (const uart_channel_t *const channel, const uint32_t num_bytes)
+{
+    channel_fifo_levels_t *const levels = &channel_fifo_levels[channel->index];
+
+    levels->fifo_stats.num_rx_bytes += num_bytes;
+    levels->burst_length += num_bytes;
+}
+
+/**
+ * @brief Count characters written to the UART transmit FIFO
+ * @param[in] channel The channel which transmitted the characters
+ * @param[in] num_bytes The number of characters transmitted
+ */
+void uart_fifo_levels_count_tx (const uart_channel_t *const channel, const uint32_t num_bytes)
+{
+    channel_fifo_levels[channel->index].fifo_stats.num_tx_bytes += num_bytes;
+}
+
+/**
+ * @brief Take a consistent copy of the statistics of channel 0
+ * @param[out] snapshot Set to point at the copy of the statistics
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t uart_fifo_levels_snapshot (const uart_fifo_stats_t **const snapshot)
+{
+    channel_fifo_levels_t *const levels = &channel_fifo_levels[UART_CHANNEL_CC3100];
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    levels->fifo_stats.average_burst_length = levels->scaled_average_burst_length >> BURST_AVERAGE_SHIFT;
+    fifo_stats_snapshot = levels->fifo_stats;
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    *snapshot = &fifo_stats_snapshot;
+    return sizeof (fifo_stats_snapshot);
+}
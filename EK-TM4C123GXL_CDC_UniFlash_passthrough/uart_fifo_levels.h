@@ -0,0 +1,55 @@
+/*
+ * @file uart_fifo_levels.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Selection of the UART FIFO trigger levels from the line coding and the received burst pattern
+ */
+
+#ifndef UART_FIFO_LEVELS_H_
+#define UART_FIFO_LEVELS_H_
+
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** When non-zero the UART FIFO trigger levels are chosen from the line coding and the received burst pattern.
+ *  When zero the UART_FIFO_TX_LEVEL and UART_FIFO_RX_LEVEL trigger levels are always used. */
+#ifndef UART_FIFO_ADAPTIVE
+#define UART_FIFO_ADAPTIVE 1
+#endif
+
+/** The worst case time in nanoseconds to service a UART FIFO trigger, allowing for being delayed by other
+ *  interrupt handlers. The trigger levels are chosen so that the FIFOs can't overrun or underrun in this time. */
+#ifndef UART_FIFO_SERVICE_LATENCY_NS
+#define UART_FIFO_SERVICE_LATENCY_NS 25000
+#endif
+
+/** Statistics about the UART interrupt load, which is sent to the USB host as little-endian 32-bit words.
+ *  The interrupts per byte are given by num_interrupts / (num_rx_bytes + num_tx_bytes). */
+typedef struct
+{
+    /** The number of times the UART interrupt handler has run */
+    uint32_t num_interrupts;
+    /** The number of characters received from the CC3100 */
+    uint32_t num_rx_bytes;
+    /** The number of characters transmitted to the CC3100 */
+    uint32_t num_tx_bytes;
+    /** The number of characters in the receive FIFO at the current receive trigger level */
+    uint32_t rx_trigger_chars;
+    /** The number of characters in the transmit FIFO at the current transmit trigger level */
+    uint32_t tx_trigger_chars;
+    /** The average number of characters received in each burst from the CC3100 */
+    uint32_t average_burst_length;
+} uart_fifo_stats_t;
+
+void uart_fifo_levels_line_coding_set (const uart_channel_t *const channel, const uint32_t baud,
+                                       const uint32_t bits_per_char);
+void uart_fifo_levels_burst_end (const uart_channel_t *const channel);
+void uart_fifo_levels_apply (const uart_channel_t *const channel);
+uint32_t uart_fifo_levels_rx (const uart_channel_t *const channel);
+void uart_fifo_levels_count_interrupt (const uart_channel_t *const channel);
+void uart_fifo_levels_count_rx (const uart_channel_t *const channel, const uint32_t num_bytes);
+void uart_fifo_levels_count_tx (const uart_channel_t *const channel, const uint32_t num_bytes);
+uint32_t uart_fifo_levels_snapshot (const uart_fifo_stats_t **const snapshot);
+
+#endif /* UART_FIFO_LEVELS_H_ */
@@ -0,0 +1,162 @@
+/*
+ * @file uart_flow_control.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief RTS/CTS flow control on the UART connected to the CC3100BOOST
+ * @details
+ *  When the USB host stops reading data, characters received from the CC3100 accumulate in the uart_to_host
+ *  ring of the channel. Once it is full the UART receive FIFO is no longer read and overruns.
+ *
+ *  With watermark receive flow control RTS is deasserted while the uart_to_host ring is nearly full, so the
+ *  CC3100 stops transmitting before any characters are lost. Hysteresis between the stop and resume watermarks
+ *  prevents RTS toggling on every USB packet read by the host.
+ *
+ *  The watermarks are only evaluated by the UART interrupt handler, after received characters have been written
+ *  to the uart_to_host ring, or when triggered by the CDC transmit handler after the USB host has read data.
+ *  The RTS state requested by the USB host is set at a lower interrupt priority, so is applied with interrupts
+ *  disabled.
+ *
+ *  The throttle is tracked for every channel, but RTS and CTS are only driven for channels whose UART has the
+ *  modem flow control pins, which on the TM4C123 is only UART1.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "data_path_telemetry.h"
+#include "uart_channels.h"
+#include "uart_flow_control.h"
+
+/** The RTS state requested by the USB host for each channel, through the CDC carrier control */
+static bool host_rts_requested[UART_NUM_CHANNELS];
+
+/** When true RTS of a channel has been deasserted because its uart_to_host ring is nearly full */
+static volatile bool rx_throttled[UART_NUM_CHANNELS];
+
+/**
+ * @brief Drive RTS of a channel from the state requested by the USB host combined with the receive throttle
+ */
+static void drive_rts (const uart_channel_t *const channel)
+{
+#if UART_RX_FLOW_CONTROL != UART_RX_FLOW_CONTROL_HARDWARE
+    if (channel->modem_flow_control)
+    {
+        if (host_rts_requested[channel->index] && !rx_throttled[channel->index])
+        {
+            hal_uart_modem_control_set (channel->uart_base, UART_OUTPUT_RTS);
+        }
+        else
+        {
+            hal_uart_modem_control_clear (channel->uart_base, UART_OUTPUT_RTS);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Configure the UART hardware flow control selected by UART_RX_FLOW_CONTROL and UART_TX_FLOW_CONTROL
+ * @details RTS is initially deasserted, until the USB host requests the carrier is activated.
+ * @param[in] channel The channel to configure
+ */
+void uart_flow_control_init (const uart_channel_t *const channel)
+{
+    uint32_t flow_control = UART_FLOWCONTROL_NONE;
+
+    if (channel->modem_flow_control)
+    {
+#if UART_TX_FLOW_CONTROL
+        flow_control |= UART_FLOWCONTROL_TX;
+#endif
+#if UART_RX_FLOW_CONTROL == UART_RX_FLOW_CONTROL_HARDWARE
+        flow_control |= UART_FLOWCONTROL_RX;
+#endif
+        hal_uart_flow_control_set (channel->uart_base, flow_control);
+    }
+
+    host_rts_requested[channel->index] = false;
+    rx_throttled[channel->index] = false;
+    drive_rts (channel);
+}
+
+/**
+ * @brief Set the RTS state requested by the USB host
+ * @param[in] channel The channel the USB host has set the carrier state for
+ * @param[in] rts_requested When true the USB host has requested RTS be asserted
+ */
+void uart_flow_control_set_host_rts (const uart_channel_t *const channel, const bool rts_requested)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    host_rts_requested[channel->index] = rts_requested;
+    drive_rts (channel);
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+}
+
+/**
+ * @brief Drive RTS again from the flow control state, after the CC3100 programmer has overridden RTS
+ * @param[in] channel The channel to restore RTS for
+ */
+void uart_flow_control_restore (const uart_channel_t *const channel)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    drive_rts (channel);
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+}
+
+/**
+ * @return Returns true if RTS of a channel has been deasserted because its uart_to_host ring is nearly full
+ */
+bool uart_flow_control_throttled (const uart_channel_t *const channel)
+{
+    return rx_throttled[channel->index];
+}
+
+/**
+ * @brief Update the receive throttle of a channel from the free space in its uart_to_host ring
+ * @details Must be called from the UART interrupt handler.
+ * @param[in] channel The channel to update
+ */
+void uart_flow_control_update (const uart_channel_t *const channel)
+{
+#if UART_RX_FLOW_CONTROL == UART_RX_FLOW_CONTROL_WATERMARK
+    const uint32_t free_space = spsc_ring_free (channel->uart_to_host);
+    const uint32_t index = channel->index;
+
+    if (!rx_throttled[index] && (free_space < UART_RX_FLOW_STOP_SPACE))
+    {
+        rx_throttled[index] = true;
+        drive_rts (channel);
+        if (index == UART_CHANNEL_CC3100)
+        {
+            data_path_telemetry_flow_control_changed (true);
+        }
+    }
+    else if (rx_throttled[index] && (free_space >= UART_RX_FLOW_RESUME_SPACE))
+    {
+        rx_throttled[index] = false;
+        drive_rts (channel);
+        if (index == UART_CHANNEL_CC3100)
+        {
+            data_path_telemetry_flow_control_changed (false);
+        }
+    }
+#else
+    (void) channel;
+#endif
+}
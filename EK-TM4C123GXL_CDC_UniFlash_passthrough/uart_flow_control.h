@@ -0,0 +1,63 @@
+/*
+ * @file uart_flow_control.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief RTS/CTS flow control on the UART connected to the CC3100BOOST
+ */
+
+#ifndef UART_FLOW_CONTROL_H_
+#define UART_FLOW_CONTROL_H_
+
+#include <stdbool.h>
+
+#include "uart_channels.h"
+
+/* The possible methods of receive flow control, which set how RTS is driven to the CC3100 */
+/** RTS only follows the carrier state requested by the USB host */
+#define UART_RX_FLOW_CONTROL_NONE      0
+/** RTS follows the carrier state requested by the USB host, and is also deasserted while the free space in the
+ *  uart_to_host ring is below a watermark */
+#define UART_RX_FLOW_CONTROL_WATERMARK 1
+/** RTS is driven by the UART hardware from the receive FIFO level, ignoring the USB host */
+#define UART_RX_FLOW_CONTROL_HARDWARE  2
+
+/** Selects the method of receive flow control.
+ *  May be overridden on the compiler command line for CC3100 links which don't wire RTS. */
+#ifndef UART_RX_FLOW_CONTROL
+#define UART_RX_FLOW_CONTROL UART_RX_FLOW_CONTROL_WATERMARK
+#endif
+
+/** When non-zero the UART only transmits while CTS is asserted by the CC3100.
+ *  May be overridden on the compiler command line for CC3100 links which don't wire CTS. */
+#ifndef UART_TX_FLOW_CONTROL
+#define UART_TX_FLOW_CONTROL 1
+#endif
+
+/* For UART_RX_FLOW_CONTROL_WATERMARK, RTS is deasserted when the free space in the CDC transmit buffer falls
+   below UART_RX_FLOW_STOP_SPACE, and asserted again once the USB host has read enough data that the free space
+   has risen to UART_RX_FLOW_RESUME_SPACE.
+   The stop space has to allow for the characters the CC3100 sends after RTS is deasserted, the contents of the
+   UART receive FIFO, and characters written by a receive uDMA transfer but not yet passed to the USB stack.
+   The watermarks are in bytes rather than a fraction of the buffer, since the characters in flight don't depend
+   upon the size the buffer has been partitioned to. */
+#ifndef UART_RX_FLOW_STOP_SPACE
+#define UART_RX_FLOW_STOP_SPACE (UART_BUFFER_MIN_SIZE / 2)
+#endif
+#ifndef UART_RX_FLOW_RESUME_SPACE
+#define UART_RX_FLOW_RESUME_SPACE ((UART_BUFFER_MIN_SIZE * 3) / 4)
+#endif
+
+#if UART_RX_FLOW_STOP_SPACE >= UART_RX_FLOW_RESUME_SPACE
+#error UART_RX_FLOW_STOP_SPACE must be less than UART_RX_FLOW_RESUME_SPACE
+#endif
+#if UART_RX_FLOW_RESUME_SPACE > UART_BUFFER_MIN_SIZE
+#error UART_RX_FLOW_RESUME_SPACE must not exceed UART_BUFFER_MIN_SIZE
+#endif
+
+void uart_flow_control_init (const uart_channel_t *const channel);
+void uart_flow_control_set_host_rts (const uart_channel_t *const channel, const bool rts_requested);
+void uart_flow_control_update (const uart_channel_t *const channel);
+void uart_flow_control_restore (const uart_channel_t *const channel);
+bool uart_flow_control_throttled (const uart_channel_t *const channel);
+
+#endif /* UART_FLOW_CONTROL_H_ */
@@ -0,0 +1,138 @@
+/*
+ * @file uart_line_errors.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Counting and reporting of line errors on the UART connected to the CC3100BOOST
+ * @details
+ *  Line errors are counted by type, once per UART interrupt in which the type was detected, and forwarded to the
+ *  USB host as a CDC SERIAL_STATE notification.
+ *  This allows host tooling to retry as soon as an error occurs, rather than waiting for a protocol timeout.
+ *
+ *  Errors are counted by the UART interrupt handler, and the notification sent by the deferred work handler
+ *  since usblib can only be called at the USB interrupt priority.
+ *
+ *  Each channel notifies its own CDC device. The counts sent to the USB host by the vendor request are those of
+ *  channel 0.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/uart.h>
+#include <driverlib/interrupt.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "traffic_capture.h"
+#include "uart_channels.h"
+#include "uart_line_errors.h"
+
+/** The line errors counted by the UART interrupt handler of each channel */
+static uart_line_error_counts_t line_error_counts[UART_NUM_CHANNELS];
+
+/** The SERIAL_STATE bits for line errors of each channel which are yet to be notified to the USB host */
+static volatile uint32_t pending_serial_state[UART_NUM_CHANNELS];
+
+/** A consistent copy of the line error counts of channel 0, which is sent to the USB host */
+static uart_line_error_counts_t line_error_counts_snapshot;
+
+/**
+ * @brief Count the line errors detected by the UART, and request the deferred work handler notifies the USB host
+ * @param[in] channel The channel whose UART detected the errors
+ * @param[in] uart_int_flags The UART interrupt flags, of which the UART_INT_OE, UART_INT_BE, UART_INT_PE and
+ *                           UART_INT_FE error flags are reported
+ */
+void uart_line_errors_report (const uart_channel_t *const channel, const uint32_t uart_int_flags)
+{
+    uart_line_error_counts_t *const counts = &line_error_counts[channel->index];
+    uint32_t serial_state = 0;
+
+    if (uart_int_flags & UART_INT_OE)
+    {
+        counts->overrun++;
+        serial_state |= USB_CDC_SERIAL_STATE_OVERRUN;
+    }
+
+    if (uart_int_flags & UART_INT_BE)
+    {
+        counts->break_condition++;
+        serial_state |= USB_CDC_SERIAL_STATE_BREAK;
+    }
+
+    if (uart_int_flags & UART_INT_PE)
+    {
+        counts->parity++;
+        serial_state |= USB_CDC_SERIAL_STATE_PARITY;
+    }
+
+    if (uart_int_flags & UART_INT_FE)
+    {
+        counts->framing++;
+        serial_state |= USB_CDC_SERIAL_STATE_FRAMING;
+    }
+
+    if (serial_state != 0)
+    {
+        if (channel->index == UART_CHANNEL_CC3100)
+        {
+            TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_LINE_ERRORS, &uart_int_flags, sizeof (uart_int_flags));
+        }
+        pending_serial_state[channel->index] |= serial_state;
+        hal_deferred_work_trigger ();
+    }
+}
+
+/**
+ * @brief Called from the deferred work handler to notify the USB host of the line errors reported on each channel
+ */
+void uart_line_errors_notify (void)
+{
+    uint32_t serial_states[UART_NUM_CHANNELS];
+    uint32_t channel_index;
+    bool interrupts_were_disabled;
+
+    interrupts_were_disabled = IntMasterDisable ();
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        serial_states[channel_index] = pending_serial_state[channel_index];
+        pending_serial_state[channel_index] = 0;
+    }
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        /* The raw bulk UART device has no notification endpoint, so the host can only read the counts */
+        if ((serial_states[channel_index] != 0) &&
+            ((channel_index != UART_CHANNEL_CC3100) || (usb_data_interface == USB_DATA_INTERFACE_CDC)))
+        {
+            USBDCDCSerialStateChange (uart_channels[channel_index].cdc_device, serial_states[channel_index]);
+        }
+    }
+}
+
+/**
+ * @brief Take a consistent copy of the line error counts of channel 0
+ * @param[out] snapshot Set to point at the copy of the line error counts
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t uart_line_errors_snapshot (const uart_line_error_counts_t **const snapshot)
+{
+    const bool interrupts_were_disabled = IntMasterDisable ();
+
+    line_error_counts_snapshot = line_error_counts[UART_CHANNEL_CC3100];
+
+    if (!interrupts_were_disabled)
+    {
+        IntMasterEnable ();
+    }
+
+    *snapshot = &line_error_counts_snapshot;
+    return sizeof (line_error_counts_snapshot);
+}
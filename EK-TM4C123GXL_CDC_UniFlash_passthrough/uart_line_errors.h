@@ -0,0 +1,32 @@
+/*
+ * @file uart_line_errors.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Counting and reporting of line errors on the UART connected to the CC3100BOOST
+ */
+
+#ifndef UART_LINE_ERRORS_H_
+#define UART_LINE_ERRORS_H_
+
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** The number of each type of line error detected since power-up,
+ *  which is sent to the USB host as little-endian 32-bit words.
+ *  Each count is the number of UART interrupts in which that type of error was detected, not the number of
+ *  characters received with the error. Several errored characters handled by one interrupt count once, and
+ *  characters moved by the receive uDMA have their error flags discarded, so only the error interrupt is seen. */
+typedef struct
+{
+    uint32_t overrun;
+    uint32_t break_condition;
+    uint32_t parity;
+    uint32_t framing;
+} uart_line_error_counts_t;
+
+void uart_line_errors_report (const uart_channel_t *const channel, const uint32_t uart_int_flags);
+void uart_line_errors_notify (void);
+uint32_t uart_line_errors_snapshot (const uart_line_error_counts_t **const snapshot);
+
+#endif /* UART_LINE_ERRORS_H_ */
@@ -0,0 +1,35 @@
+/*
+ * @file udma_control.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Initialisation of the uDMA controller, shared by the peripherals which use uDMA
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/udma.h>
+
+#include "udma_control.h"
+
+/** The uDMA channel control table, which must be aligned on a 1024 byte boundary */
+#pragma DATA_ALIGN(dma_control_table, 1024)
+static tDMAControlTable dma_control_table[64];
+
+/** Set once the uDMA controller has been initialised */
+static bool udma_initialised;
+
+/**
+ * @brief Enable the uDMA controller, if not already enabled by another peripheral
+ */
+void udma_control_init (void)
+{
+    if (!udma_initialised)
+    {
+        SysCtlPeripheralEnable (SYSCTL_PERIPH_UDMA);
+        uDMAEnable ();
+        uDMAControlBaseSet (dma_control_table);
+        udma_initialised = true;
+    }
+}
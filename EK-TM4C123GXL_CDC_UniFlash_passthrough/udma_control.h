@@ -0,0 +1,13 @@
+/*
+ * @file udma_control.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Initialisation of the uDMA controller, shared by the peripherals which use uDMA
+ */
+
+#ifndef UDMA_CONTROL_H_
+#define UDMA_CONTROL_H_
+
+void udma_control_init (void);
+
+#endif /* UDMA_CONTROL_H_ */
@@ -0,0 +1,208 @@
+/*
+ * @file usb_data_endpoints.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief FIFO configuration and packet statistics for the bulk endpoints which carry the UART data
+ * @details
+ *  usblib allocates a single-buffered FIFO for each endpoint, so each 64-byte packet has to be handled by the
+ *  USB interrupt handler before the controller can accept the next, and the device NAKs during bursts.
+ *  With USB_DOUBLE_BUFFER non-zero the bulk IN and OUT endpoints are given double-buffered FIFOs once usblib
+ *  has configured the endpoints:
+ *  - For the OUT endpoint the controller receives the next packet while the previous one is read into the
+ *    CDC receive buffer.
+ *  - For the IN endpoint the next packet is written into the FIFO while the previous one is being sent, since
+ *    the transmit complete event is raised as soon as the FIFO has a free half.
+ *  The double-buffered FIFOs are placed in the upper half of the endpoint FIFO RAM, above the FIFOs allocated
+ *  by usblib from the start of the RAM.
+ *
+ *  usblib renumbers the endpoints of each device in a composite device, so the bulk endpoints are taken from the
+ *  device class instance which carries the UART data rather than assumed. A composite device with enough
+ *  endpoints for usblib to allocate FIFOs in the upper half of the RAM fails a check_assert(), rather than
+ *  having its FIFOs overlap the double-buffered FIFOs.
+ *
+ *  The packets moved on each endpoint are counted per USB frame, so that the gain can be measured by reading
+ *  the statistics with VENDOR_REQUEST_GET_USB_ENDPOINT_STATS after a sustained read or write, in builds with
+ *  and without USB_DOUBLE_BUFFER.
+ *
+ *  All functions are called at the USB interrupt priority, so don't need to mask interrupts.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/usb.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+
+#include "usb_serial_structs.h"
+#include "check_assert.h"
+#include "usb_data_endpoints.h"
+
+/* With double-buffered FIFOs the controller can hold two packets per direction, which the buffers must be able
+   to accept in one go to keep both halves of the FIFO in use. */
+#if USB_DOUBLE_BUFFER && (UART_BUFFER_MIN_SIZE < (2 * USB_DATA_MAX_PACKET_SIZE))
+#error UART_BUFFER_MIN_SIZE must hold at least two maximum-sized packets when USB_DOUBLE_BUFFER is non-zero
+#endif
+
+/** The addresses in the endpoint FIFO RAM of the double-buffered FIFOs, each of which is two packets */
+#define OUT_FIFO_ADDRESS 1024
+#define IN_FIFO_ADDRESS  (OUT_FIFO_ADDRESS + (2 * USB_DATA_MAX_PACKET_SIZE))
+
+/** The USB frame number is 11 bits */
+#define FRAME_NUMBER_MASK 0x7FF
+
+/** Used to count the packets moved in each USB frame, in one direction */
+typedef struct
+{
+    /** The frame number in which the last packet was moved */
+    uint32_t frame_number;
+    /** The number of packets moved in frame_number */
+    uint32_t frame_packets;
+} frame_count_t;
+
+/** The statistics for the bulk endpoints */
+static usb_data_endpoint_stats_t endpoint_stats;
+
+/** A copy of the statistics, which is sent to the USB host */
+static usb_data_endpoint_stats_t endpoint_stats_snapshot;
+
+static frame_count_t out_frame_count;
+static frame_count_t in_frame_count;
+
+#if USB_DOUBLE_BUFFER
+/**
+ * @param[in] endpoint The endpoint to get the FIFO for
+ * @param[in] flags USB_EP_DEV_IN or USB_EP_DEV_OUT to select the direction of the endpoint
+ * @return Returns the address in the endpoint FIFO RAM following the FIFO which is allocated to the endpoint
+ */
+static uint32_t fifo_end_address (const uint32_t endpoint, const uint32_t flags)
+{
+    uint32_t address;
+    uint32_t size;
+
+    USBFIFOConfigGet (USB0_BASE, endpoint, &address, &size, flags);
+    return address + (USBFIFOSizeToBytes (size & ~USB_FIFO_SIZE_DB_FLAG) * ((size & USB_FIFO_SIZE_DB_FLAG) ? 2 : 1));
+}
+#endif
+
+/**
+ * @brief Give the bulk endpoints double-buffered FIFOs, if enabled by USB_DOUBLE_BUFFER
+ * @details Called when the USB host has set the configuration, after which usblib has configured the endpoints
+ */
+void usb_data_endpoints_configure (void)
+{
+#if USB_DOUBLE_BUFFER
+    uint32_t in_endpoint;
+    uint32_t out_endpoint;
+    uint32_t endpoint_index;
+
+    if (usb_data_interface == USB_DATA_INTERFACE_RAW_BULK)
+    {
+        in_endpoint = uart_bulk_device.sPrivateData.ui8INEndpoint;
+        out_endpoint = uart_bulk_device.sPrivateData.ui8OUTEndpoint;
+    }
+    else
+    {
+        in_endpoint = CDC_device.sPrivateData.ui8BulkINEndpoint;
+        out_endpoint = CDC_device.sPrivateData.ui8BulkOUTEndpoint;
+    }
+
+    /* Check the FIFOs which usblib allocated to the other endpoints are below the double-buffered FIFOs */
+    for (endpoint_index = 1; endpoint_index < NUM_USB_EP; endpoint_index++)
+    {
+        if (IndexToUSBEP (endpoint_index) != out_endpoint)
+        {
+            check_assert (fifo_end_address (IndexToUSBEP (endpoint_index), USB_EP_DEV_OUT) <= OUT_FIFO_ADDRESS);
+        }
+        if (IndexToUSBEP (endpoint_index) != in_endpoint)
+        {
+            check_assert (fifo_end_address (IndexToUSBEP (endpoint_index), USB_EP_DEV_IN) <= OUT_FIFO_ADDRESS);
+        }
+    }
+
+    USBFIFOConfigSet (USB0_BASE, out_endpoint, OUT_FIFO_ADDRESS, USB_FIFO_SZ_64_DB, USB_EP_DEV_OUT);
+    USBFIFOConfigSet (USB0_BASE, in_endpoint, IN_FIFO_ADDRESS, USB_FIFO_SZ_64_DB, USB_EP_DEV_IN);
+
+    /* Each flush discards one packet, so flush twice to empty both halves of the FIFOs */
+    USBFIFOFlush (USB0_BASE, out_endpoint, USB_EP_DEV_OUT);
+    USBFIFOFlush (USB0_BASE, out_endpoint, USB_EP_DEV_OUT);
+    USBFIFOFlush (USB0_BASE, in_endpoint, USB_EP_DEV_IN);
+    USBFIFOFlush (USB0_BASE, in_endpoint, USB_EP_DEV_IN);
+#endif
+    endpoint_stats.double_buffered = USB_DOUBLE_BUFFER;
+}
+
+/**
+ * @brief Count one packet moved in the current USB frame
+ * @param[in,out] frame_count The per-frame count for the direction
+ * @param[in,out] num_packets The total packets for the direction
+ * @param[in,out] num_active_frames The frames in which packets were moved for the direction
+ * @param[in,out] max_packets_per_frame The most packets moved in one frame for the direction
+ */
+static void count_packet (frame_count_t *const frame_count, uint32_t *const num_packets,
+                          uint32_t *const num_active_frames, uint32_t *const max_packets_per_frame)
+{
+    const uint32_t frame_number = USBFrameNumberGet (USB0_BASE) & FRAME_NUMBER_MASK;
+
+    if ((frame_count->frame_packets == 0) || (frame_number != frame_count->frame_number))
+    {
+        frame_count->frame_number = frame_number;
+        frame_count->frame_packets = 0;
+        (*num_active_frames)++;
+    }
+    frame_count->frame_packets++;
+    (*num_packets)++;
+    if (frame_count->frame_packets > *max_packets_per_frame)
+    {
+        *max_packets_per_frame = frame_count->frame_packets;
+    }
+}
+
+/**
+ * @brief Called when a packet from the USB host has been read from the bulk OUT endpoint
+ */
+void usb_data_endpoints_count_out_packet (void)
+{
+    count_packet (&out_frame_count, &endpoint_stats.num_out_packets, &endpoint_stats.num_out_active_frames,
+                  &endpoint_stats.max_out_packets_per_frame);
+}
+
+/**
+ * @brief Called when a packet for the USB host has been written to the bulk IN endpoint
+ */
+void usb_data_endpoints_count_in_packet (void)
+{
+    count_packet (&in_frame_count, &endpoint_stats.num_in_packets, &endpoint_stats.num_in_active_frames,
+                  &endpoint_stats.max_in_packets_per_frame);
+}
+
+/**
+ * @brief Reset the packet statistics, to start a measurement
+ */
+void usb_data_endpoints_clear_stats (void)
+{
+    endpoint_stats.num_out_packets = 0;
+    endpoint_stats.num_out_active_frames = 0;
+    endpoint_stats.max_out_packets_per_frame = 0;
+    endpoint_stats.num_in_packets = 0;
+    endpoint_stats.num_in_active_frames = 0;
+    endpoint_stats.max_in_packets_per_frame = 0;
+    out_frame_count.frame_packets = 0;
+    in_frame_count.frame_packets = 0;
+}
+
+/**
+ * @brief Take a copy of the packet statistics
+ * @param[out] snapshot Set to point at the copy of the statistics
+ * @return Returns the size of the copy in bytes
+ */
+uint32_t usb_data_endpoints_snapshot (const usb_data_endpoint_stats_t **const snapshot)
+{
+    endpoint_stats_snapshot = endpoint_stats;
+    *snapshot = &endpoint_stats_snapshot;
+    return sizeof (endpoint_stats_snapshot);
+}
@@ -0,0 +1,47 @@
+/*
+ * @file usb_data_endpoints.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief FIFO configuration and packet statistics for the bulk endpoints which carry the UART data
+ */
+
+#ifndef USB_DATA_ENDPOINTS_H_
+#define USB_DATA_ENDPOINTS_H_
+
+/** When non-zero the bulk IN and OUT endpoints which carry the UART data use double-buffered FIFOs.
+ *  When zero the single-buffered FIFOs allocated by usblib are used. */
+#ifndef USB_DOUBLE_BUFFER
+#define USB_DOUBLE_BUFFER 1
+#endif
+
+/** The maximum packet size of the bulk endpoints */
+#define USB_DATA_MAX_PACKET_SIZE 64
+
+/** Statistics about the packets transferred on the bulk endpoints, which is sent to the USB host as
+ *  little-endian 32-bit words. The average packets per frame during a sustained transfer in one direction is
+ *  given by num_packets / num_active_frames. */
+typedef struct
+{
+    /** Non-zero if the endpoints use double-buffered FIFOs */
+    uint32_t double_buffered;
+    /** The number of packets received from the USB host on the bulk OUT endpoint */
+    uint32_t num_out_packets;
+    /** The number of USB frames in which at least one packet was received from the USB host */
+    uint32_t num_out_active_frames;
+    /** The most packets received from the USB host in one USB frame */
+    uint32_t max_out_packets_per_frame;
+    /** The number of packets sent to the USB host on the bulk IN endpoint */
+    uint32_t num_in_packets;
+    /** The number of USB frames in which at least one packet was sent to the USB host */
+    uint32_t num_in_active_frames;
+    /** The most packets sent to the USB host in one USB frame */
+    uint32_t max_in_packets_per_frame;
+} usb_data_endpoint_stats_t;
+
+void usb_data_endpoints_configure (void);
+void usb_data_endpoints_count_out_packet (void);
+void usb_data_endpoints_count_in_packet (void);
+void usb_data_endpoints_clear_stats (void);
+uint32_t usb_data_endpoints_snapshot (const usb_data_endpoint_stats_t **const snapshot);
+
+#endif /* USB_DATA_ENDPOINTS_H_ */
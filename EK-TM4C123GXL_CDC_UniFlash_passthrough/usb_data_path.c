@@ -0,0 +1,382 @@
+/*
+ * @file usb_data_path.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Moves packets between the USB data endpoints and the CDC ring buffers
+ * @details
+ *  Replaces the usblib USBBuffer, whose generic callbacks and per-call bookkeeping were on the hot path of every
+ *  packet. Packets are read from the OUT endpoint straight into the free space of the host_to_uart ring of the
+ *  channel, and written to the IN endpoint straight from the data in the uart_to_host ring. A packet which wraps
+ *  the end of uart_to_host is written to the endpoint as two spans. A packet which would wrap the end of
+ *  host_to_uart is read into a bounce buffer and copied, since a packet can only be read from the endpoint in one
+ *  call. With the default ring size a multiple of the maximum packet size, that only happens after the USB host has
+ *  sent a short packet.
+ *
+ *  Each UART channel has its own CDC device, whose callback data is the uart_channel_t. For channel 0 the packets
+ *  may instead be passed to the raw bulk device. The state of each channel is indexed by the channel index.
+ *
+ *  Apart from usb_data_path_tx_produced() and usb_data_path_rx_consumed() the functions are called at the USB
+ *  interrupt priority, either from the device class channel callbacks or from the deferred work handler.
+ *  The UART interrupt handler is the other side of both rings:
+ *  - It commits characters received from the CC3100 to uart_to_host, and triggers the deferred work handler to
+ *    send them if the IN endpoint is idle.
+ *  - It consumes characters from host_to_uart. When a packet from the USB host has been left in the OUT endpoint
+ *    FIFO for lack of space, so that the host is NAKed, the deferred work handler is triggered to read it once
+ *    space has been freed.
+ *
+ *  While a new partition of the buffer arena is pending, the deferred work handler is also triggered when either
+ *  ring of channel 0 becomes empty so that the partition can be applied.
+ *
+ *  The packets of channel 0 are passed to the device class selected by usb_data_interface, counted to measure the
+ *  packets per USB frame, and the bytes moved and the episodes in which either ring is full are counted for the
+ *  data path telemetry.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+
+#include "usb_serial_structs.h"
+#include "bridge_hal.h"
+#include "usb_data_endpoints.h"
+#include "uart_buffer_arena.h"
+#include "data_path_telemetry.h"
+#include "traffic_capture.h"
+#include "cc3100_sequence.h"
+#include "uart_channels.h"
+#include "usb_data_path.h"
+
+/** When true a packet sent on the IN endpoint of a channel is awaiting USB_EVENT_TX_COMPLETE */
+static bool in_packet_pending[UART_NUM_CHANNELS];
+
+/** Set when a packet has been left in the OUT endpoint FIFO of a channel since there wasn't space for it in the
+ *  host_to_uart ring. Cleared at the USB interrupt priority, and read by the UART interrupt handler. */
+static volatile bool out_packet_blocked[UART_NUM_CHANNELS];
+
+/** Used to read a packet which wraps the end of a host_to_uart ring. Only used at the USB interrupt priority,
+ *  so is shared by all channels. */
+static uint8_t out_bounce_buffer[USB_DATA_MAX_PACKET_SIZE];
+
+/**
+ * @return Returns true if the packets of a channel are passed to the raw bulk device, rather than its CDC device
+ */
+static inline bool raw_bulk (const uart_channel_t *const channel)
+{
+    return (channel->index == UART_CHANNEL_CC3100) && (usb_data_interface == USB_DATA_INTERFACE_RAW_BULK);
+}
+
+/**
+ * @brief Packet transfer functions, which pass the transfer to the device class of the channel
+ */
+static uint32_t packet_read (const uart_channel_t *const channel, uint8_t *const data, const uint32_t length,
+                             const bool last)
+{
+    return raw_bulk (channel) ?
+            USBDBulkPacketRead (&uart_bulk_device, data, length, last) :
+            USBDCDCPacketRead (channel->cdc_device, data, length, last);
+}
+
+static uint32_t rx_packet_available (const uart_channel_t *const channel)
+{
+    return raw_bulk (channel) ?
+            USBDBulkRxPacketAvailable (&uart_bulk_device) : USBDCDCRxPacketAvailable (channel->cdc_device);
+}
+
+static uint32_t packet_write (const uart_channel_t *const channel, uint8_t *const data, const uint32_t length,
+                              const bool last)
+{
+    return raw_bulk (channel) ?
+            USBDBulkPacketWrite (&uart_bulk_device, data, length, last) :
+            USBDCDCPacketWrite (channel->cdc_device, data, length, last);
+}
+
+static uint32_t tx_packet_available (const uart_channel_t *const channel)
+{
+    return raw_bulk (channel) ?
+            USBDBulkTxPacketAvailable (&uart_bulk_device) : USBDCDCTxPacketAvailable (channel->cdc_device);
+}
+
+/**
+ * @brief Read the packets waiting in the OUT endpoint of a channel into its host_to_uart ring, while there is
+ *        space for them
+ * @param[in] channel The channel to read the packets for
+ * @return Returns the number of bytes read
+ */
+static uint32_t read_out_packets (const uart_channel_t *const channel)
+{
+    const bool is_cc3100 = channel->index == UART_CHANNEL_CC3100;
+    spsc_ring_t *const ring = channel->host_to_uart;
+    const bool was_blocked = out_packet_blocked[channel->index];
+    uint32_t total_read = 0;
+    uint32_t packet_size;
+    uint32_t span_length;
+    uint32_t num_read;
+    uint32_t first_length;
+    uint8_t *span;
+
+    packet_size = rx_packet_available (channel);
+    while (packet_size > 0)
+    {
+        /* Mark the packet as blocked before checking for space, so that if the UART interrupt handler frees
+         * space after the check it sees the flag set and triggers another attempt */
+        out_packet_blocked[channel->index] = true;
+        SPSC_RING_BARRIER ();
+        if (spsc_ring_free (ring) < packet_size)
+        {
+            if (!was_blocked && is_cc3100)
+            {
+                data_path_telemetry_count_out_nak ();
+            }
+            break;
+        }
+        out_packet_blocked[channel->index] = false;
+
+        span = spsc_ring_write_span (ring, &span_length);
+        if (span_length >= packet_size)
+        {
+            num_read = packet_read (channel, span, packet_size, true);
+        }
+        else
+        {
+            num_read = packet_read (channel, out_bounce_buffer, packet_size, true);
+            first_length = (span_length < num_read) ? span_length : num_read;
+            memcpy (span, out_bounce_buffer, first_length);
+            span = spsc_ring_write_span_at (ring, first_length, &span_length);
+            memcpy (span, &out_bounce_buffer[first_length], num_read - first_length);
+        }
+        spsc_ring_write_commit (ring, num_read);
+        total_read += num_read;
+        if (is_cc3100)
+        {
+            usb_data_endpoints_count_out_packet ();
+            data_path_telemetry_count_host_to_uart (num_read);
+        }
+
+        packet_size = rx_packet_available (channel);
+    }
+
+    return total_read;
+}
+
+/**
+ * @brief If the IN endpoint of a channel is idle, send a packet of the data in its uart_to_host ring
+ * @details The data is released from uart_to_host once written to the endpoint FIFO, rather than when the
+ *          USB host has read it, so that the UART can re-use the space sooner.
+ *          The packet length is limited to the space reported as available in the endpoint FIFO, but the writes
+ *          are still checked since the USB host can reset the device, and data is only released from uart_to_host
+ *          once it has been written. If the second span of a packet which wraps can't be written, the first span
+ *          already in the endpoint FIFO is sent on its own.
+ * @param[in] channel The channel to send the packet for
+ */
+static void send_in_packet (const uart_channel_t *const channel)
+{
+    spsc_ring_t *const ring = channel->uart_to_host;
+    uint32_t max_length;
+    uint32_t span_length;
+    uint32_t length;
+    uint32_t first_length = 0;
+    uint8_t *span;
+
+    if (!in_packet_pending[channel->index])
+    {
+        max_length = tx_packet_available (channel);
+        span = spsc_ring_read_span (ring, &span_length);
+        if ((max_length > 0) && (span_length > 0))
+        {
+            length = (span_length < max_length) ? span_length : max_length;
+            if ((length < max_length) && (spsc_ring_used (ring) > length))
+            {
+                /* The packet wraps the end of the ring, so write it as two spans */
+                if (packet_write (channel, span, length, false) != length)
+                {
+                    return;
+                }
+                spsc_ring_read_commit (ring, length);
+                first_length = length;
+                span = spsc_ring_read_span (ring, &span_length);
+                max_length -= length;
+                length = (span_length < max_length) ? span_length : max_length;
+            }
+
+            if (packet_write (channel, span, length, true) != length)
+            {
+                if (first_length == 0)
+                {
+                    return;
+                }
+                length = 0;
+                (void) packet_write (channel, span, 0, true);
+            }
+            spsc_ring_read_commit (ring, length);
+            in_packet_pending[channel->index] = true;
+            if (channel->index == UART_CHANNEL_CC3100)
+            {
+                usb_data_endpoints_count_in_packet ();
+                data_path_telemetry_count_uart_to_host (first_length + length);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Called when the USB host has set the configuration of a channel, when no IN packet can be pending
+ * @param[in] channel The channel which has been connected
+ */
+void usb_data_path_connected (const uart_channel_t *const channel)
+{
+    in_packet_pending[channel->index] = false;
+}
+
+/**
+ * @brief Called from the deferred work handler to send data committed to the uart_to_host rings by the UART
+ *        interrupt handler, and to read packets which were blocked waiting for space in the host_to_uart rings.
+ */
+void usb_data_path_service (void)
+{
+    const uart_channel_t *channel;
+    uint32_t channel_index;
+    uint32_t num_read;
+
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        channel = &uart_channels[channel_index];
+        send_in_packet (channel);
+        if (out_packet_blocked[channel_index])
+        {
+            num_read = read_out_packets (channel);
+            if (num_read > 0)
+            {
+                cdc_rx_handler ((void *) channel, USB_EVENT_RX_AVAILABLE, num_read, NULL);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Called by the UART interrupt handler once received characters have been written into the uart_to_host
+ *        ring of a channel, to commit them and trigger the deferred work handler to send them
+ * @param[in] channel The channel which received the characters
+ * @param[in] num_bytes The number of characters written at the head of uart_to_host
+ */
+void usb_data_path_tx_produced (const uart_channel_t *const channel, const uint32_t num_bytes)
+{
+#if TRAFFIC_CAPTURE
+    uint8_t *span;
+    uint32_t span_length;
+#endif
+
+    if (num_bytes > 0)
+    {
+        if (channel->index == UART_CHANNEL_CC3100)
+        {
+#if TRAFFIC_CAPTURE
+            /* The characters are written as one contiguous span at the head */
+            span = spsc_ring_write_span (channel->uart_to_host, &span_length);
+            TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_UART_RX, span, num_bytes);
+#endif
+            spsc_ring_write_commit (channel->uart_to_host, num_bytes);
+            if (spsc_ring_free (channel->uart_to_host) == 0)
+            {
+                data_path_telemetry_count_uart_to_host_full ();
+            }
+        }
+        else
+        {
+            spsc_ring_write_commit (channel->uart_to_host, num_bytes);
+        }
+        cc3100_sequence_uart_rx (channel);
+        hal_deferred_work_trigger ();
+    }
+}
+
+/**
+ * @brief Called by the UART interrupt handler to release bytes it has consumed from the host_to_uart ring of a
+ *        channel
+ * @param[in] channel The channel which consumed the bytes
+ * @param[in] num_bytes The number of bytes consumed
+ */
+void usb_data_path_rx_consumed (const uart_channel_t *const channel, const uint32_t num_bytes)
+{
+    spsc_ring_t *const ring = channel->host_to_uart;
+#if TRAFFIC_CAPTURE
+    uint8_t *span;
+    uint32_t span_length;
+
+    if (channel->index == UART_CHANNEL_CC3100)
+    {
+        /* The characters are read as one contiguous span at the tail */
+        span = spsc_ring_read_span (ring, &span_length);
+        TRAFFIC_CAPTURE_DATA (TRAFFIC_CAPTURE_UART_TX, span, num_bytes);
+    }
+#endif
+    spsc_ring_read_commit (ring, num_bytes);
+    if (out_packet_blocked[channel->index] ||
+        ((channel->index == UART_CHANNEL_CC3100) && uart_buffer_arena_repartition_pending () &&
+         (spsc_ring_used (ring) == 0)))
+    {
+        hal_deferred_work_trigger ();
+    }
+}
+
+/**
+ * @brief Handles device class notifications related to the receive channel (data from the USB host),
+ *        passing the events on to cdc_rx_handler once the data has been placed in the host_to_uart ring.
+ * @details pvCBData is the uart_channel_t of the device.
+ */
+uint32_t usb_data_path_rx_handler (void *pvCBData, uint32_t ui32Event,
+                                   uint32_t ui32MsgValue, void *pvMsgData)
+{
+    const uart_channel_t *const channel = pvCBData;
+    uint32_t return_value;
+    uint32_t num_read;
+
+    switch (ui32Event)
+    {
+    case USB_EVENT_RX_AVAILABLE:
+        num_read = read_out_packets (channel);
+        return_value = (num_read > 0) ? cdc_rx_handler (pvCBData, ui32Event, num_read, NULL) : 0;
+        break;
+
+    case USB_EVENT_DATA_REMAINING:
+        /* Data is remaining if there is any in host_to_uart, or the UART is still transmitting */
+        return_value = (spsc_ring_used (channel->host_to_uart) > 0) ? 1 :
+                cdc_rx_handler (pvCBData, ui32Event, ui32MsgValue, pvMsgData);
+        break;
+
+    default:
+        return_value = cdc_rx_handler (pvCBData, ui32Event, ui32MsgValue, pvMsgData);
+        break;
+    }
+
+    return return_value;
+}
+
+/**
+ * @brief Handles device class notifications related to the transmit channel (data to the USB host),
+ *        sending the next packet once the previous one has completed.
+ * @details pvCBData is the uart_channel_t of the device.
+ */
+uint32_t usb_data_path_tx_handler (void *pvCBData, uint32_t ui32Event,
+                                   uint32_t ui32MsgValue, void *pvMsgData)
+{
+    const uart_channel_t *const channel = pvCBData;
+
+    if (ui32Event == USB_EVENT_TX_COMPLETE)
+    {
+        in_packet_pending[channel->index] = false;
+        send_in_packet (channel);
+        if ((channel->index == UART_CHANNEL_CC3100) && uart_buffer_arena_repartition_pending () &&
+            (spsc_ring_used (channel->uart_to_host) == 0))
+        {
+            hal_deferred_work_trigger ();
+        }
+    }
+
+    return cdc_tx_handler (pvCBData, ui32Event, ui32MsgValue, pvMsgData);
+}
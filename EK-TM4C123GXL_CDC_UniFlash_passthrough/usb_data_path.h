@@ -0,0 +1,26 @@
+/*
+ * @file usb_data_path.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Moves packets between the USB data endpoints and the CDC ring buffers
+ */
+
+#ifndef USB_DATA_PATH_H_
+#define USB_DATA_PATH_H_
+
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** Device class channel callbacks, installed in place of the usblib USBBuffer callbacks */
+uint32_t usb_data_path_rx_handler (void *pvCBData, uint32_t ui32Event,
+                                   uint32_t ui32MsgValue, void *pvMsgData);
+uint32_t usb_data_path_tx_handler (void *pvCBData, uint32_t ui32Event,
+                                   uint32_t ui32MsgValue, void *pvMsgData);
+
+void usb_data_path_connected (const uart_channel_t *const channel);
+void usb_data_path_service (void);
+void usb_data_path_tx_produced (const uart_channel_t *const channel, const uint32_t num_bytes);
+void usb_data_path_rx_consumed (const uart_channel_t *const channel, const uint32_t num_bytes);
+
+#endif /* USB_DATA_PATH_H_ */
@@ -0,0 +1,163 @@
+/*
+ * @file usb_in_flush.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Policy for when characters received from the CC3100 are passed to the USB stack to send to the host
+ * @details
+ *  The USB stack sends a packet as soon as characters are passed to it and the IN endpoint is idle.
+ *  Bootloader command/response traffic wants each response sent as soon as the CC3100 stops transmitting,
+ *  whereas bulk reads are more efficient when packets are full. Similar to the latency timer of a FTDI device,
+ *  the policy is set by two parameters:
+ *  - The latency is the time from the UART receive timeout, i.e. the CC3100 having stopped transmitting, to the
+ *    characters received so far being passed to the USB stack. A latency of zero passes the characters
+ *    on the receive timeout. A non-zero latency allows further bursts from the CC3100 to be combined into
+ *    the same packet.
+ *  - The fill threshold is the number of characters which are passed to the USB stack as soon as received,
+ *    regardless of the latency. This sets the length of each half of the uDMA receive transfer, so only
+ *    applies when UART_RX_USE_UDMA is non-zero.
+ *
+ *  The latency is timed by a one-shot timer, which triggers the UART interrupt handler to perform the flush.
+ *  The policy is shared by all UART channels, with each channel timing its own latency on its flush_timer_base.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bridge_hal.h"
+#include "uart_dma.h"
+#include "isr_profile.h"
+#include "uart_channels.h"
+#include "usb_in_flush.h"
+
+/** The time from the receive timeout to passing the characters to the USB stack, in milliseconds */
+static uint32_t flush_latency_ms;
+
+/** The number of characters passed to the USB stack as soon as received */
+static uint32_t flush_fill_threshold;
+
+/** When true the latency of a channel is being timed by its one-shot timer */
+static volatile bool flush_deferred[UART_NUM_CHANNELS];
+
+/** Set by the timer interrupt handler of a channel when the latency has expired, and cleared by the UART interrupt
+ *  handler */
+static volatile bool flush_expired[UART_NUM_CHANNELS];
+
+/**
+ * @brief Set the default policy, which passes characters to the USB stack on the receive timeout or
+ *        when a maximum-sized USB packet has been received
+ */
+void usb_in_flush_init (void)
+{
+    uint32_t channel_index;
+
+    flush_latency_ms = 0;
+    flush_fill_threshold = UART_RX_DMA_BLOCK_SIZE;
+    for (channel_index = 0; channel_index < UART_NUM_CHANNELS; channel_index++)
+    {
+        flush_deferred[channel_index] = false;
+        flush_expired[channel_index] = false;
+    }
+}
+
+/**
+ * @brief Change the flush policy, which takes effect for the next characters received
+ * @param[in] latency_ms The time from the receive timeout to passing characters to the USB stack
+ * @param[in] fill_threshold The number of characters passed to the USB stack as soon as received
+ * @return Returns true if the policy is valid and has been applied
+ */
+bool usb_in_flush_set_policy (const uint32_t latency_ms, const uint32_t fill_threshold)
+{
+    const bool policy_valid = (latency_ms <= USB_IN_FLUSH_MAX_LATENCY_MS) &&
+            (fill_threshold > 0) && (fill_threshold <= UART_RX_DMA_BLOCK_SIZE);
+
+    if (policy_valid)
+    {
+        flush_latency_ms = latency_ms;
+        flush_fill_threshold = fill_threshold;
+    }
+
+    return policy_valid;
+}
+
+/**
+ * @return Returns the maximum number of characters in each half of the uDMA receive transfer
+ */
+uint32_t usb_in_flush_fill_threshold (void)
+{
+    return flush_fill_threshold;
+}
+
+/**
+ * @brief Called by the UART interrupt handler on a receive timeout, to start timing the latency
+ * @details While the latency is being timed the caller masks the receive timeout interrupt, and leaves the
+ *          characters in the UART receive FIFO until usb_in_flush_due() returns true.
+ * @param[in] channel The channel which had the receive timeout
+ * @return Returns true if the flush has been deferred, or false if the characters should be passed to the USB
+ *         stack immediately
+ */
+bool usb_in_flush_defer (const uart_channel_t *const channel)
+{
+    if ((flush_latency_ms > 0) && !flush_deferred[channel->index])
+    {
+        flush_deferred[channel->index] = true;
+        hal_oneshot_timer_start_ms (channel->flush_timer_base, flush_latency_ms);
+    }
+
+    return flush_deferred[channel->index];
+}
+
+/**
+ * @brief Called by the UART interrupt handler to check if the latency has expired
+ * @param[in] channel The channel to check
+ * @return Returns true if the characters should now be passed to the USB stack, after which the caller unmasks the
+ *         receive timeout interrupt
+ */
+bool usb_in_flush_due (const uart_channel_t *const channel)
+{
+    const bool due = flush_expired[channel->index];
+
+    flush_expired[channel->index] = false;
+    return due;
+}
+
+/**
+ * @brief Called from the one-shot timer interrupt handler of a channel, to trigger the UART interrupt handler to
+ *        perform the flush once the latency has expired
+ */
+static void flush_timer_expired (const uart_channel_t *const channel)
+{
+    hal_oneshot_timer_int_clear (channel->flush_timer_base);
+    flush_deferred[channel->index] = false;
+    flush_expired[channel->index] = true;
+    hal_uart_int_trigger (channel->uart_int);
+}
+
+/**
+ * @brief Interrupt handler for the one-shot timer of channel 0
+ */
+void usb_in_flush_timer_handler (void)
+{
+    ISR_PROFILE_ENTRY (ISR_PROFILE_USB_IN_FLUSH_TIMER);
+
+    flush_timer_expired (&uart_channels[UART_CHANNEL_CC3100]);
+
+    ISR_PROFILE_EXIT (ISR_PROFILE_USB_IN_FLUSH_TIMER);
+}
+
+#if UART_EXTRA_CHANNELS
+/**
+ * @brief Interrupt handlers for the one-shot timers of the extra channels
+ */
+void uart_channel_1_flush_timer_handler (void)
+{
+    flush_timer_expired (&uart_channels[1]);
+}
+
+#if UART_EXTRA_CHANNELS > 1
+void uart_channel_2_flush_timer_handler (void)
+{
+    flush_timer_expired (&uart_channels[2]);
+}
+#endif
+#endif /* UART_EXTRA_CHANNELS */
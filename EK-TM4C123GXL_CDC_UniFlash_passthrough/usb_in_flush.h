@@ -0,0 +1,26 @@
+/*
+ * @file usb_in_flush.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Policy for when characters received from the CC3100 are passed to the USB stack to send to the host
+ */
+
+#ifndef USB_IN_FLUSH_H_
+#define USB_IN_FLUSH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "uart_channels.h"
+
+/** The maximum latency which can be set, in milliseconds */
+#define USB_IN_FLUSH_MAX_LATENCY_MS 255
+
+void usb_in_flush_init (void);
+bool usb_in_flush_set_policy (const uint32_t latency_ms, const uint32_t fill_threshold);
+uint32_t usb_in_flush_fill_threshold (void);
+bool usb_in_flush_defer (const uart_channel_t *const channel);
+bool usb_in_flush_due (const uart_channel_t *const channel);
+void usb_in_flush_timer_handler (void);
+
+#endif /* USB_IN_FLUSH_H_ */
@@ -12,8 +12,14 @@
 #include <usblib/usb-ids.h>
 #include <usblib/device/usbdevice.h>
 #include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
+#include <driverlib/flash.h>
 
 #include "usb_serial_structs.h"
+#include "spi_passthrough.h"
+#include "uart_channels.h"
+#include "usb_data_path.h"
 
 /** The languages supported by this device. */
 static const uint8_t language_descriptor[] =
@@ -43,8 +49,9 @@ static const uint8_t product_string[] =
     'P', 0, 'o', 0, 'r', 0, 't', 0
 };
 
-/** The serial number string */
-static const uint8_t serial_number_string[] =
+/** The serial number string. The default is replaced by usb_serial_number_init() when the flash user registers
+ *  have been programmed, so that several LaunchPads connected to one USB host have unique serial numbers. */
+static uint8_t serial_number_string[] =
 {
     2 + (32 * 2),
     USB_DTYPE_STRING,
@@ -75,6 +82,33 @@ static const uint8_t config_string[] =
     'o', 0, 'n', 0
 };
 
+#if UART_EXTRA_CHANNELS
+/** The interface strings of the CDC ports of the composite device, at PORT_STRING_INDEX() */
+static const uint8_t port_0_string[] =
+{
+    2 + (13 * 2),
+    USB_DTYPE_STRING,
+    'C', 0, 'C', 0, '3', 0, '1', 0, '0', 0, '0', 0, ' ', 0, 'P', 0,
+    'o', 0, 'r', 0, 't', 0, ' ', 0, '0', 0
+};
+
+static const uint8_t port_1_string[] =
+{
+    2 + (13 * 2),
+    USB_DTYPE_STRING,
+    'C', 0, 'C', 0, '3', 0, '1', 0, '0', 0, '0', 0, ' ', 0, 'P', 0,
+    'o', 0, 'r', 0, 't', 0, ' ', 0, '1', 0
+};
+
+static const uint8_t port_2_string[] =
+{
+    2 + (13 * 2),
+    USB_DTYPE_STRING,
+    'C', 0, 'C', 0, '3', 0, '1', 0, '0', 0, '0', 0, ' ', 0, 'P', 0,
+    'o', 0, 'r', 0, 't', 0, ' ', 0, '2', 0
+};
+#endif
+
 /** The descriptor string table */
 static const uint8_t * const string_descriptors[] =
 {
@@ -83,22 +117,73 @@ static const uint8_t * const string_descriptors[] =
     product_string,
     serial_number_string,
     control_interface_string,
-    config_string
+    config_string,
+#if UART_EXTRA_CHANNELS
+    port_0_string,
+    port_1_string,
+    port_2_string
+#endif
 };
 
 #define NUM_STRING_DESCRIPTORS (sizeof(string_descriptors) / sizeof(uint8_t *))
 
+/** The raw bulk UART interface description string */
+static const uint8_t uart_bulk_interface_string[] =
+{
+    2 + (21 * 2),
+    USB_DTYPE_STRING,
+    'C', 0, 'C', 0, '3', 0, '1', 0, '0', 0, '0', 0, ' ', 0, 'U', 0,
+    'A', 0, 'R', 0, 'T', 0, ' ', 0, 'I', 0, 'n', 0, 't', 0, 'e', 0,
+    'r', 0, 'f', 0, 'a', 0, 'c', 0, 'e', 0
+};
+
+/** The descriptor string table for the raw bulk UART device */
+static const uint8_t * const uart_bulk_string_descriptors[] =
+{
+    language_descriptor,
+    manufacturer_string,
+    product_string,
+    serial_number_string,
+    uart_bulk_interface_string,
+    config_string
+};
+
+#define NUM_UART_BULK_STRING_DESCRIPTORS (sizeof(uart_bulk_string_descriptors) / sizeof(uint8_t *))
 
 /**
-  The CDC device initialization and customization structures. In this case,
-  we are using USBBuffers between the CDC device class driver and the
-  application code. The function pointers and callback data values are set
-  to insert a buffer in each of the data channels, transmit and receive.
-
-   With the buffer in place, the CDC channel callback is set to the relevant
-   channel function and the callback data is set to point to the channel
-   instance data. The buffer, in turn, has its callback set to the application
-   function and the callback data set to our CDC instance structure.
+ * @brief Set the serial number string from the flash user registers USER_REG0 and USER_REG1, as 16 hex digits.
+ * @details If the user registers haven't been programmed, the default serial number is left.
+ *          Must be called before the USB device is initialised.
+ */
+void usb_serial_number_init (void)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    const uint32_t num_digits = 16;
+    uint32_t user_regs[2];
+    uint32_t digit_index;
+    uint32_t reg_value;
+
+    FlashUserGet (&user_regs[0], &user_regs[1]);
+    if ((user_regs[0] != 0xFFFFFFFF) || (user_regs[1] != 0xFFFFFFFF))
+    {
+        serial_number_string[0] = 2 + (num_digits * 2);
+        for (digit_index = 0; digit_index < num_digits; digit_index++)
+        {
+            reg_value = user_regs[digit_index / 8] >> (28 - (4 * (digit_index % 8)));
+            serial_number_string[2 + (digit_index * 2)] = hex_digits[reg_value & 0xF];
+        }
+    }
+}
+
+/** Selects which of CDC_device or uart_bulk_device is used, set at startup before the USB device is initialised */
+usb_data_interface_t usb_data_interface = USB_DATA_INTERFACE_CDC;
+
+/**
+  The CDC device initialization and customization structures. The receive
+  and transmit channel callbacks are set to the data path, which moves
+  packets between the CDC device class driver and the ring buffers, and in
+  turn calls the application channel functions. The callback data of each
+  callback is the UART channel bridged by the device.
 */
 tUSBDCDCDevice CDC_device =
 {
@@ -107,43 +192,154 @@ tUSBDCDCDevice CDC_device =
     0,
     USB_CONF_ATTR_SELF_PWR,
     cdc_control_handler,
-    (void *)&CDC_device,
-    USBBufferEventCallback,
-    (void *)&cdc_rx_buffer,
-    USBBufferEventCallback,
-    (void *)&cdc_tx_buffer,
+    (void *)&uart_channels[UART_CHANNEL_CC3100],
+    usb_data_path_rx_handler,
+    (void *)&uart_channels[UART_CHANNEL_CC3100],
+    usb_data_path_tx_handler,
+    (void *)&uart_channels[UART_CHANNEL_CC3100],
     string_descriptors,
     NUM_STRING_DESCRIPTORS
 };
 
-/** Receive buffer (from the USB perspective). */
-static uint8_t usb_rx_buffer[UART_BUFFER_SIZE];
-static uint8_t rx_buffer_workspace[USB_BUFFER_WORKSPACE_SIZE];
-const tUSBBuffer cdc_rx_buffer =
-{
-    false,                          /* This is a receive buffer. */
-    cdc_rx_handler,                 /* pfnCallback */
-    (void *)&CDC_device,            /* Callback data is our device pointer. */
-    USBDCDCPacketRead,              /* pfnTransfer */
-    USBDCDCRxPacketAvailable,       /* pfnAvailable */
-    (void *)&CDC_device,            /* pvHandle */
-    usb_rx_buffer,                  /* pui8Buffer */
-    UART_BUFFER_SIZE,               /* ui32BufferSize */
-    rx_buffer_workspace             /* pvWorkspace */
-};
-
-/* Transmit buffer (from the USB perspective). */
-static uint8_t usb_tx_buffer[UART_BUFFER_SIZE];
-static uint8_t tx_buffer_workspace[USB_BUFFER_WORKSPACE_SIZE];
-const tUSBBuffer cdc_tx_buffer =
-{
-    true,                           // This is a transmit buffer.
-    cdc_tx_handler,                 // pfnCallback
-    (void *)&CDC_device,            // Callback data is our device pointer.
-    USBDCDCPacketWrite,             // pfnTransfer
-    USBDCDCTxPacketAvailable,       // pfnAvailable
-    (void *)&CDC_device,            // pvHandle
-    usb_tx_buffer,                  // pui8Buffer
-    UART_BUFFER_SIZE,               // ui32BufferSize
-    tx_buffer_workspace             // pvWorkspace
+/**
+  The raw bulk UART device, which uses the same data path as the CDC device. Bulk devices have no control
+  callback, so the connection state events are passed through the data path to cdc_rx_handler.
+*/
+tUSBDBulkDevice uart_bulk_device =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_BULK,
+    0,
+    USB_CONF_ATTR_SELF_PWR,
+    usb_data_path_rx_handler,
+    (void *)&uart_channels[UART_CHANNEL_CC3100],
+    usb_data_path_tx_handler,
+    (void *)&uart_channels[UART_CHANNEL_CC3100],
+    uart_bulk_string_descriptors,
+    NUM_UART_BULK_STRING_DESCRIPTORS
+};
+
+/** Receive buffer (from the USB perspective), written by the data path and read by the UART.
+ *  The storage is partitioned from the buffer arena. */
+spsc_ring_t cdc_rx_buffer;
+
+/* Transmit buffer (from the USB perspective), written by the UART and read by the data path.
+ * The storage is partitioned from the buffer arena. */
+spsc_ring_t cdc_tx_buffer;
+
+#if UART_EXTRA_CHANNELS
+/** The CDC devices of the extra UART channels, which use the same callbacks as CDC_device */
+#define UART_CHANNEL_CDC_DEVICE(channel)          \
+{                                                 \
+    USB_VID_TI_1CBE,                              \
+    USB_PID_SERIAL,                               \
+    0,                                            \
+    USB_CONF_ATTR_SELF_PWR,                       \
+    cdc_control_handler,                          \
+    (void *)&uart_channels[channel],              \
+    usb_data_path_rx_handler,                     \
+    (void *)&uart_channels[channel],              \
+    usb_data_path_tx_handler,                     \
+    (void *)&uart_channels[channel],              \
+    string_descriptors,                           \
+    NUM_STRING_DESCRIPTORS                        \
+}
+
+tUSBDCDCDevice uart_channel_cdc_devices[UART_EXTRA_CHANNELS] =
+{
+    UART_CHANNEL_CDC_DEVICE (1),
+#if UART_EXTRA_CHANNELS > 1
+    UART_CHANNEL_CDC_DEVICE (2)
+#endif
+};
+
+/** The devices which make up the composite device, populated when each device is initialised */
+tCompositeEntry composite_entries[NUM_COMPOSITE_ENTRIES];
+
+/**
+  The composite device, which contains the CDC device for the CC3100BOOST on interfaces 0 and 1, followed by a
+  CDC device for each extra UART channel.
+*/
+tUSBDCompositeDevice composite_device =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_COMP_SERIAL,
+    0,
+    USB_CONF_ATTR_SELF_PWR,
+    0,
+    string_descriptors,
+    NUM_STRING_DESCRIPTORS,
+    NUM_COMPOSITE_ENTRIES,
+    composite_entries
 };
+
+/** The memory in which the composite configuration descriptor is built */
+uint8_t composite_descriptor[COMPOSITE_DESCRIPTOR_SIZE];
+#endif /* UART_EXTRA_CHANNELS */
+
+#if SPI_PASSTHROUGH
+/** The SPI passthrough interface description string */
+static const uint8_t spi_interface_string[] =
+{
+    2 + (20 * 2),
+    USB_DTYPE_STRING,
+    'C', 0, 'C', 0, '3', 0, '1', 0, '0', 0, '0', 0, ' ', 0, 'S', 0,
+    'P', 0, 'I', 0, ' ', 0, 'I', 0, 'n', 0, 't', 0, 'e', 0, 'r', 0,
+    'f', 0, 'a', 0, 'c', 0, 'e', 0
+};
+
+/** The descriptor string table for the SPI passthrough bulk device */
+static const uint8_t * const spi_string_descriptors[] =
+{
+    language_descriptor,
+    manufacturer_string,
+    product_string,
+    serial_number_string,
+    spi_interface_string,
+    config_string
+};
+
+#define NUM_SPI_STRING_DESCRIPTORS (sizeof(spi_string_descriptors) / sizeof(uint8_t *))
+
+/**
+  The vendor-specific bulk device used to pass SPI transfers through to the CC3100BOOST.
+  The bulk packets are read and written directly by the SPI passthrough, without USBBuffers,
+  since each command is transferred by uDMA from where it was read.
+*/
+tUSBDBulkDevice spi_bulk_device =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_BULK,
+    0,
+    USB_CONF_ATTR_SELF_PWR,
+    spi_rx_handler,
+    (void *)&spi_bulk_device,
+    spi_tx_handler,
+    (void *)&spi_bulk_device,
+    spi_string_descriptors,
+    NUM_SPI_STRING_DESCRIPTORS
+};
+
+/** The devices which make up the composite device, populated when each device is initialised */
+tCompositeEntry composite_entries[NUM_COMPOSITE_ENTRIES];
+
+/**
+  The composite device, which contains the CDC device on interfaces 0 and 1 and the SPI passthrough
+  bulk device on interface 2.
+*/
+tUSBDCompositeDevice composite_device =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_COMP_SERIAL,
+    0,
+    USB_CONF_ATTR_SELF_PWR,
+    0,
+    string_descriptors,
+    NUM_STRING_DESCRIPTORS,
+    NUM_COMPOSITE_ENTRIES,
+    composite_entries
+};
+
+/** The memory in which the composite configuration descriptor is built */
+uint8_t composite_descriptor[COMPOSITE_DESCRIPTOR_SIZE];
+#endif /* SPI_PASSTHROUGH */
@@ -8,6 +8,13 @@
 #ifndef USB_SERIAL_STRUCTS_H_
 #define USB_SERIAL_STRUCTS_H_
 
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
+
+#include "spsc_ring.h"
+#include "uart_channels.h"
+
 /** CDC device callback function prototypes */
 uint32_t cdc_rx_handler(void *pvCBData, uint32_t ui32Event,
                         uint32_t ui32MsgValue, void *pvMsgData);
@@ -16,15 +23,62 @@ uint32_t cdc_tx_handler(void *pvCBData, uint32_t ui32Event,
 uint32_t cdc_control_handler(void *pvCBData, uint32_t ui32Event,
                              uint32_t ui32MsgValue, void *pvMsgData);
 
-/* The size of the transmit and receive buffers used for the redirected UART.
-   This number should be a power of 2 for best performance.  256 is chosen
-   pretty much at random though the buffer should be at least twice the size of
-   a maxmum-sized USB packet.
+/* The transmit and receive buffers used for the redirected UART are partitioned at run time from an arena
+   of UART_BUFFER_ARENA_SIZE bytes, by uart_buffer_arena.c. Each buffer is a power of 2 in size, for the ring
+   buffer index masking, and at least UART_BUFFER_MIN_SIZE which is four maximum-sized USB packets.
+   The default arena allows either direction to have 8 KB with 4 KB for the other direction.
+   May be overridden on the compiler command line, to compare the throughput of different builds.
 */
-#define UART_BUFFER_SIZE 256
+#ifndef UART_BUFFER_ARENA_SIZE
+#define UART_BUFFER_ARENA_SIZE 12288
+#endif
+#define UART_BUFFER_MIN_SIZE 256
+
+#if UART_BUFFER_ARENA_SIZE < (2 * UART_BUFFER_MIN_SIZE)
+#error UART_BUFFER_ARENA_SIZE must hold two buffers of UART_BUFFER_MIN_SIZE
+#endif
+
+/* The UART FIFO trigger levels passed to UARTFIFOLevelSet() when UART_FIFO_ADAPTIVE is zero.
+   May be overridden on the compiler command line, to compare the throughput of different builds. */
+#ifndef UART_FIFO_TX_LEVEL
+#define UART_FIFO_TX_LEVEL UART_FIFO_TX4_8
+#endif
+#ifndef UART_FIFO_RX_LEVEL
+#define UART_FIFO_RX_LEVEL UART_FIFO_RX4_8
+#endif
+
+/** The USB interface through which UART1 is exposed to the USB host, selected at startup */
+typedef enum
+{
+    /** A CDC ACM device, as used by UniFlash through the host tty layer */
+    USB_DATA_INTERFACE_CDC,
+    /** A vendor-specific bulk device, for host applications using libusb such as host/tools/bulk_throughput.c.
+     *  The CDC class requests are replaced by vendor requests. */
+    USB_DATA_INTERFACE_RAW_BULK
+} usb_data_interface_t;
 
-extern const tUSBBuffer cdc_tx_buffer;
-extern const tUSBBuffer cdc_rx_buffer;
+extern usb_data_interface_t usb_data_interface;
+
+extern spsc_ring_t cdc_tx_buffer;
+extern spsc_ring_t cdc_rx_buffer;
 extern tUSBDCDCDevice CDC_device;
+extern tUSBDBulkDevice uart_bulk_device;
+
+#if UART_EXTRA_CHANNELS
+/* The devices which make up the composite device of the UART channels, in order of interface number.
+   The entry of each CDC device is its channel index. */
+#define COMPOSITE_ENTRY_CDC UART_CHANNEL_CC3100
+#define COMPOSITE_ENTRY_CHANNEL(channel) (channel)
+#define NUM_COMPOSITE_ENTRIES (1 + UART_EXTRA_CHANNELS)
+
+/** The size of the configuration descriptor built for the composite device */
+#define COMPOSITE_DESCRIPTOR_SIZE (NUM_COMPOSITE_ENTRIES * COMPOSITE_DCDC_SIZE)
+
+extern tCompositeEntry composite_entries[NUM_COMPOSITE_ENTRIES];
+extern tUSBDCompositeDevice composite_device;
+extern uint8_t composite_descriptor[COMPOSITE_DESCRIPTOR_SIZE];
+#endif
+
+void usb_serial_number_init (void);
 
 #endif /* USB_SERIAL_STRUCTS_H_ */
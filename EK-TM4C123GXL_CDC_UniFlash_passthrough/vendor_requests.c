@@ -0,0 +1,581 @@
+/*
+ * @file vendor_requests.c
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Vendor-specific control requests handled by the CDC or raw bulk UART device
+ * @details
+ *  The usblib CDC class stalls any request it doesn't recognise. To add vendor-specific requests the request
+ *  handler in the device information of the CDC device is replaced by one which handles vendor requests and
+ *  passes all other requests to the CDC class.
+ *
+ *  The usblib bulk class has no request handler, so for the raw bulk UART device the vendor requests which
+ *  replace the CDC class requests are passed to cdc_control_handler() as the equivalent CDC events.
+ *
+ *  Vendor requests are handled on endpoint zero, so can be used without interrupting the CDC data stream.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/usb.h>
+#include <usblib/usblib.h>
+#include <usblib/usbcdc.h>
+#include <usblib/device/usbdevice.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
+
+#include "isr_profile.h"
+#include "uart_line_errors.h"
+#include "line_coding.h"
+#include "usb_in_flush.h"
+#include "uart_fifo_levels.h"
+#include "usb_serial_structs.h"
+#include "usb_data_endpoints.h"
+#include "uart_buffer_arena.h"
+#include "data_path_telemetry.h"
+#include "traffic_capture.h"
+#include "cc3100_sequence.h"
+#include "cc3100_programmer.h"
+#include "vendor_requests.h"
+
+/** The callback data passed to cdc_control_handler(), selecting the channel of the CC3100BOOST */
+#define CC3100_CHANNEL ((void *) &uart_channels[UART_CHANNEL_CC3100])
+
+/** The USB controller index the device was initialised on */
+static uint32_t usb_index;
+
+/** The class request handler, to which non-vendor requests are passed. NULL for the bulk class. */
+static tStdRequest class_request_handler;
+
+/** The class handler for the data stage of class requests, to which the data stage of non-vendor requests is
+ *  passed. NULL for the bulk class. */
+static tInfoCallback class_data_received;
+
+/** The vendor request whose data stage is being received */
+static uint8_t pending_ep0_request;
+
+/** The data stage of VENDOR_REQUEST_SET_LINE_CODING */
+static tLineCoding requested_line_coding;
+
+/** The data stage of VENDOR_REQUEST_RUN_SEQUENCE and VENDOR_REQUEST_SET_BREAK_SEQUENCE */
+static cc3100_sequence_step_t requested_steps[CC3100_SEQUENCE_MAX_STEPS];
+
+/** The data stage of VENDOR_REQUEST_PROGRAMMER_WRITE_IMAGE, and the offset in the image to write it */
+static uint32_t requested_image_data[64 / sizeof (uint32_t)];
+static uint32_t requested_image_offset;
+
+/**
+ * @brief Send the data stage of a device-to-host vendor request
+ * @param[in] request The request being handled, which sets the maximum length the host will accept
+ * @param[in] data The data to send, which must remain valid until the transfer completes
+ * @param[in] data_length The number of bytes of data available
+ */
+static void send_vendor_data (const tUSBRequest *const request, const void *const data,
+                              const uint32_t data_length)
+{
+    USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+    USBDCDSendDataEP0 (usb_index, (uint8_t *) data,
+                       (data_length < request->wLength) ? data_length : request->wLength);
+}
+
+/**
+ * @brief Complete a vendor request which has no data stage
+ */
+static void ack_vendor_request (void)
+{
+    USBDevEndpointDataAck (USB0_BASE, USB_EP_0, true);
+}
+
+/**
+ * @brief Reject a vendor request which isn't supported
+ */
+static void stall_vendor_request (void)
+{
+    USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+    USBDCDStallEP0 (usb_index);
+    data_path_telemetry_count_ep0_stall ();
+}
+
+/**
+ * @brief Start receiving the data stage of a host-to-device vendor request, which is passed to handle_ep0_data()
+ * @param[in] request The request being handled
+ * @param[out] data Where to store the data stage, which is wLength bytes
+ */
+static void receive_vendor_data (const tUSBRequest *const request, void *const data)
+{
+    pending_ep0_request = request->bRequest;
+    USBDevEndpointDataAck (USB0_BASE, USB_EP_0, false);
+    USBDCDRequestDataEP0 (usb_index, (uint8_t *) data, request->wLength);
+}
+
+/**
+ * @brief Act on the data stage received for a host-to-device request
+ * @param[in] pvDevice The device instance
+ * @param[in] ui32DataSize The number of bytes received
+ */
+static void handle_ep0_data (void *pvDevice, uint32_t ui32DataSize)
+{
+    const uint8_t request = pending_ep0_request;
+
+    pending_ep0_request = 0;
+    switch (request)
+    {
+    case VENDOR_REQUEST_SET_LINE_CODING:
+        if (ui32DataSize == sizeof (requested_line_coding))
+        {
+            cdc_control_handler (CC3100_CHANNEL, USBD_CDC_EVENT_SET_LINE_CODING, 0, &requested_line_coding);
+        }
+        break;
+
+    case VENDOR_REQUEST_RUN_SEQUENCE:
+        (void) cc3100_sequence_run (&uart_channels[UART_CHANNEL_CC3100], requested_steps,
+                                    ui32DataSize / sizeof (requested_steps[0]));
+        break;
+
+    case VENDOR_REQUEST_SET_BREAK_SEQUENCE:
+        (void) cc3100_sequence_set_break (&uart_channels[UART_CHANNEL_CC3100], requested_steps,
+                                          ui32DataSize / sizeof (requested_steps[0]));
+        break;
+
+    case VENDOR_REQUEST_PROGRAMMER_WRITE_IMAGE:
+        (void) cc3100_programmer_write_image (requested_image_offset, requested_image_data, ui32DataSize);
+        break;
+
+    default:
+        if (class_data_received != NULL)
+        {
+            class_data_received (pvDevice, ui32DataSize);
+        }
+        break;
+    }
+}
+
+/**
+ * @return Returns true if the request has a host-to-device data stage of a whole number of sequence steps
+ */
+static bool sequence_request_valid (const tUSBRequest *const request)
+{
+    return !(request->bmRequestType & USB_RTYPE_DIR_IN) &&
+            (request->wLength > 0) && (request->wLength <= sizeof (requested_steps)) &&
+            ((request->wLength % sizeof (requested_steps[0])) == 0);
+}
+
+/**
+ * @brief Handle a non-standard request for the CDC or raw bulk UART device
+ * @param[in] pvDevice The device instance
+ * @param[in] pUSBRequest The request received from the USB host
+ */
+static void handle_requests (void *pvDevice, tUSBRequest *pUSBRequest)
+{
+    const bool raw_bulk = usb_data_interface == USB_DATA_INTERFACE_RAW_BULK;
+
+    if ((pUSBRequest->bmRequestType & USB_RTYPE_TYPE_M) != USB_RTYPE_VENDOR)
+    {
+        if (((pUSBRequest->bmRequestType & USB_RTYPE_TYPE_M) == USB_RTYPE_CLASS) &&
+            (pUSBRequest->bRequest == USB_CDC_SET_LINE_CODING))
+        {
+            line_coding_change_requested ();
+        }
+        if (class_request_handler != NULL)
+        {
+            class_request_handler (pvDevice, pUSBRequest);
+        }
+        else
+        {
+            stall_vendor_request ();
+        }
+    }
+    else
+    {
+        switch (pUSBRequest->bRequest)
+        {
+#if ISR_PROFILING
+        case VENDOR_REQUEST_GET_ISR_PROFILE:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const isr_profile_t *profiles;
+                const uint32_t profiles_length = isr_profile_snapshot (&profiles);
+
+                send_vendor_data (pUSBRequest, profiles, profiles_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_CLEAR_ISR_PROFILE:
+            isr_profile_clear ();
+            ack_vendor_request ();
+            break;
+#endif
+
+        case VENDOR_REQUEST_RUN_SEQUENCE:
+            if (sequence_request_valid (pUSBRequest))
+            {
+                /* The sequence is run by handle_ep0_data() once the data stage has been received */
+                receive_vendor_data (pUSBRequest, requested_steps);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_SET_BREAK_SEQUENCE:
+            if (pUSBRequest->wLength == 0)
+            {
+                (void) cc3100_sequence_set_break (&uart_channels[UART_CHANNEL_CC3100], NULL, 0);
+                ack_vendor_request ();
+            }
+            else if (sequence_request_valid (pUSBRequest))
+            {
+                receive_vendor_data (pUSBRequest, requested_steps);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_SEQUENCE_STATUS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const cc3100_sequence_status_t *status;
+                const uint32_t status_length =
+                        cc3100_sequence_status_get (&uart_channels[UART_CHANNEL_CC3100], &status);
+
+                send_vendor_data (pUSBRequest, status, status_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_PROGRAMMER_WRITE_IMAGE:
+            requested_image_offset = ((uint32_t) pUSBRequest->wIndex << 16) | pUSBRequest->wValue;
+            if (!(pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN) && !cc3100_programmer_active () &&
+                (pUSBRequest->wLength > 0) && (pUSBRequest->wLength <= sizeof (requested_image_data)) &&
+                ((pUSBRequest->wLength % sizeof (requested_image_data[0])) == 0) &&
+                ((requested_image_offset % sizeof (requested_image_data[0])) == 0) &&
+                (requested_image_offset < CC3100_PROGRAMMER_IMAGE_SIZE) &&
+                (pUSBRequest->wLength <= (CC3100_PROGRAMMER_IMAGE_SIZE - requested_image_offset)))
+            {
+                /* The flash is written by handle_ep0_data() once the data stage has been received */
+                receive_vendor_data (pUSBRequest, requested_image_data);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_PROGRAMMER_RUN:
+            if (cc3100_programmer_request_run ())
+            {
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_PROGRAMMER_STATUS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const cc3100_programmer_status_t *status;
+                const uint32_t status_length = cc3100_programmer_status_get (&status);
+
+                send_vendor_data (pUSBRequest, status, status_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+#if TRAFFIC_CAPTURE
+        case VENDOR_REQUEST_CAPTURE_CONTROL:
+            if (traffic_capture_control (pUSBRequest->wValue))
+            {
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_CAPTURE:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const uint8_t *dump;
+                const uint32_t dump_length =
+                        traffic_capture_dump (pUSBRequest->wValue != 0, pUSBRequest->wLength, &dump);
+
+                send_vendor_data (pUSBRequest, dump, dump_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+#endif
+
+        case VENDOR_REQUEST_GET_LINE_ERRORS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const uart_line_error_counts_t *counts;
+                const uint32_t counts_length = uart_line_errors_snapshot (&counts);
+
+                send_vendor_data (pUSBRequest, counts, counts_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_LINE_CODING_STATUS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                static line_coding_change_status_t status;
+                const uint32_t status_length = line_coding_change_status_get (&status);
+
+                send_vendor_data (pUSBRequest, &status, status_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_UART_FIFO_STATS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const uart_fifo_stats_t *stats;
+                const uint32_t stats_length = uart_fifo_levels_snapshot (&stats);
+
+                send_vendor_data (pUSBRequest, stats, stats_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_USB_ENDPOINT_STATS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const usb_data_endpoint_stats_t *stats;
+                const uint32_t stats_length = usb_data_endpoints_snapshot (&stats);
+
+                send_vendor_data (pUSBRequest, stats, stats_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_CLEAR_USB_ENDPOINT_STATS:
+            usb_data_endpoints_clear_stats ();
+            ack_vendor_request ();
+            break;
+
+        case VENDOR_REQUEST_SET_BUFFER_PARTITION:
+            if (uart_buffer_arena_request (pUSBRequest->wValue, pUSBRequest->wIndex))
+            {
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_BUFFER_STATS:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const uart_buffer_arena_stats_t *stats;
+                const uint32_t stats_length = uart_buffer_arena_snapshot (&stats);
+
+                send_vendor_data (pUSBRequest, stats, stats_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_CLEAR_BUFFER_HIGH_WATER:
+            uart_buffer_arena_clear_high_water ();
+            ack_vendor_request ();
+            break;
+
+        case VENDOR_REQUEST_GET_TELEMETRY:
+            if (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN)
+            {
+                const data_path_telemetry_t *telemetry;
+                const uint32_t telemetry_length = data_path_telemetry_snapshot (&telemetry);
+
+                send_vendor_data (pUSBRequest, telemetry, telemetry_length);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_CLEAR_TELEMETRY:
+            data_path_telemetry_clear ();
+            ack_vendor_request ();
+            break;
+
+        case VENDOR_REQUEST_SET_USB_IN_FLUSH:
+            if (usb_in_flush_set_policy (pUSBRequest->wValue, pUSBRequest->wIndex))
+            {
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_SET_LINE_CODING:
+            if (raw_bulk && !(pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN) &&
+                (pUSBRequest->wLength == sizeof (requested_line_coding)))
+            {
+                /* The line coding is applied by handle_ep0_data() once the data stage has been received */
+                receive_vendor_data (pUSBRequest, &requested_line_coding);
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_GET_LINE_CODING:
+            if (raw_bulk && (pUSBRequest->bmRequestType & USB_RTYPE_DIR_IN))
+            {
+                static tLineCoding line_coding;
+
+                cdc_control_handler (CC3100_CHANNEL, USBD_CDC_EVENT_GET_LINE_CODING, 0, &line_coding);
+                send_vendor_data (pUSBRequest, &line_coding, sizeof (line_coding));
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_SET_CONTROL_LINE_STATE:
+            if (raw_bulk)
+            {
+                cdc_control_handler (CC3100_CHANNEL, USBD_CDC_EVENT_SET_CONTROL_LINE_STATE, pUSBRequest->wValue,
+                                     NULL);
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        case VENDOR_REQUEST_SEND_BREAK:
+            if (raw_bulk)
+            {
+                cdc_control_handler (CC3100_CHANNEL, (pUSBRequest->wValue != 0) ?
+                                     USBD_CDC_EVENT_SEND_BREAK : USBD_CDC_EVENT_CLEAR_BREAK, 0, NULL);
+                ack_vendor_request ();
+            }
+            else
+            {
+                stall_vendor_request ();
+            }
+            break;
+
+        default:
+            stall_vendor_request ();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Replace the request and EP0 data handlers of a device class with those which handle vendor requests,
+ *        passing the requests which aren't vendor requests on to the class
+ * @param[in] index The USB controller used by the device
+ * @param[in,out] device_info The device information of the class
+ */
+static void hook_class_handlers (const uint32_t index, tDeviceInfo *const device_info)
+{
+    usb_index = index;
+    class_request_handler = device_info->sCallbacks.pfnRequestHandler;
+    device_info->sCallbacks.pfnRequestHandler = handle_requests;
+    class_data_received = device_info->sCallbacks.pfnDataReceived;
+    device_info->sCallbacks.pfnDataReceived = handle_ep0_data;
+}
+
+/**
+ * @brief Initialise a CDC device which also handles vendor requests
+ * @details When the CDC device is part of a composite device, the composite device passes vendor requests
+ *          with an interface recipient to the device which owns the interface. Therefore the USB host must
+ *          send vendor requests with an interface recipient and wIndex set to the CDC control interface.
+ *
+ *          A stand-alone CDC device is initialised with USBDCDCInit(), which patches the VID, PID and power of the
+ *          device into the descriptors before connecting. The handlers are replaced once connected, which is before
+ *          the host can have enumerated the device and so sent a vendor request.
+ * @param[in] index The USB controller to use
+ * @param[in,out] cdc_device The CDC device to initialise
+ * @param[out] composite_entry When NULL the CDC device is connected to the USB bus.
+ *                             Otherwise the entry is populated to add the CDC device to a composite device,
+ *                             which the caller connects to the USB bus.
+ * @return Returns the CDC device instance, or NULL on error
+ */
+void *vendor_requests_cdc_init (const uint32_t index, tUSBDCDCDevice *const cdc_device,
+                                tCompositeEntry *const composite_entry)
+{
+    void *cdc_instance;
+
+    if (composite_entry != NULL)
+    {
+        cdc_instance = USBDCDCCompositeInit (index, cdc_device, composite_entry);
+    }
+    else
+    {
+        cdc_instance = USBDCDCInit (index, cdc_device);
+    }
+    if (cdc_instance != NULL)
+    {
+        hook_class_handlers (index, &cdc_device->sPrivateData.sDevInfo);
+    }
+
+    return cdc_instance;
+}
+
+/**
+ * @brief Initialise the raw bulk UART device, extended to handle vendor requests, and connect it to the USB bus
+ * @details The USB host sends vendor requests with a device recipient. USBDBulkInit() patches the VID, PID and
+ *          power of the device into the descriptors, and the handlers are replaced before enumeration as for
+ *          vendor_requests_cdc_init().
+ * @param[in] index The USB controller to use
+ * @param[in,out] bulk_device The bulk device to initialise
+ * @return Returns the bulk device instance, or NULL on error
+ */
+void *vendor_requests_bulk_init (const uint32_t index, tUSBDBulkDevice *const bulk_device)
+{
+    void *const bulk_instance = USBDBulkInit (index, bulk_device);
+
+    if (bulk_instance != NULL)
+    {
+        hook_class_handlers (index, &bulk_device->sPrivateData.sDevInfo);
+    }
+
+    return bulk_instance;
+}
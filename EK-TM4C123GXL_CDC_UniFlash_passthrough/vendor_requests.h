@@ -0,0 +1,107 @@
+/*
+ * @file vendor_requests.h
+ * @date 16 Oct 2026
+ * @author Chester Gillon
+ * @brief Vendor-specific control requests handled by the CDC or raw bulk UART device
+ */
+
+#ifndef VENDOR_REQUESTS_H_
+#define VENDOR_REQUESTS_H_
+
+#include <stdint.h>
+#include <usblib/device/usbdcdc.h>
+#include <usblib/device/usbdbulk.h>
+#include <usblib/device/usbdcomp.h>
+
+/* The bRequest values of the vendor-specific control requests.
+   A request which isn't supported by the build is stalled. */
+
+/** Device-to-host. Returns an isr_profile_t for each of the isr_profile_handler_t handlers */
+#define VENDOR_REQUEST_GET_ISR_PROFILE   0x01
+/** No data. Resets the interrupt handler profiles */
+#define VENDOR_REQUEST_CLEAR_ISR_PROFILE 0x02
+/** Device-to-host. Returns the uart_line_error_counts_t for the UART connected to the CC3100BOOST */
+#define VENDOR_REQUEST_GET_LINE_ERRORS   0x03
+/** Device-to-host. Returns the line_coding_change_status_t, to determine when a SET_LINE_CODING has been applied */
+#define VENDOR_REQUEST_GET_LINE_CODING_STATUS 0x04
+/** No data. Sets the policy for passing characters received from the CC3100 to the USB host.
+ *  wValue is the latency in milliseconds from the receive timeout, where zero flushes on the receive timeout.
+ *  wIndex is the fill threshold in characters, from 1 to UART_RX_DMA_BLOCK_SIZE.
+ *  The request is stalled if the policy is invalid. */
+#define VENDOR_REQUEST_SET_USB_IN_FLUSH 0x05
+/** Device-to-host. Returns the uart_fifo_stats_t, to show the UART interrupts per byte and FIFO trigger levels */
+#define VENDOR_REQUEST_GET_UART_FIFO_STATS 0x06
+
+/* Requests which replace the CDC class requests when the raw bulk UART interface is selected.
+   They are stalled when the CDC interface is selected. */
+
+/** Host-to-device. The data stage is a tLineCoding in the CDC format, applied as for CDC SET_LINE_CODING */
+#define VENDOR_REQUEST_SET_LINE_CODING 0x07
+/** Device-to-host. Returns the tLineCoding applied to the UART */
+#define VENDOR_REQUEST_GET_LINE_CODING 0x08
+/** No data. wValue is the control line state in the CDC format, of which USB_CDC_ACTIVATE_CARRIER sets RTS */
+#define VENDOR_REQUEST_SET_CONTROL_LINE_STATE 0x09
+/** No data. A non-zero wValue asserts break and pulses nHIB, as for CDC SEND_BREAK.
+ *  A zero wValue clears break. Unlike CDC the break isn't timed, but is held until cleared. */
+#define VENDOR_REQUEST_SEND_BREAK 0x0A
+
+/* Requests supported for both the CDC and raw bulk UART interfaces */
+
+/** Device-to-host. Returns the usb_data_endpoint_stats_t, to show the packets per USB frame on the bulk endpoints */
+#define VENDOR_REQUEST_GET_USB_ENDPOINT_STATS 0x0B
+/** No data. Resets the usb_data_endpoint_stats_t, to start a measurement */
+#define VENDOR_REQUEST_CLEAR_USB_ENDPOINT_STATS 0x0C
+/** No data. Sets the partition of the buffer arena, which is applied once both buffers are empty.
+ *  wValue is the size of the buffer from the USB host to the UART, and wIndex the size of the buffer from the
+ *  UART to the USB host. Each must be a power of 2 of at least UART_BUFFER_MIN_SIZE, and together not exceed
+ *  UART_BUFFER_ARENA_SIZE. When both are zero the partition is chosen automatically at the start of each session.
+ *  The request is stalled if the partition is invalid. */
+#define VENDOR_REQUEST_SET_BUFFER_PARTITION 0x0D
+/** Device-to-host. Returns the uart_buffer_arena_stats_t, to show the buffer sizes and high-water marks */
+#define VENDOR_REQUEST_GET_BUFFER_STATS 0x0E
+/** No data. Resets the buffer high-water marks, to start a measurement */
+#define VENDOR_REQUEST_CLEAR_BUFFER_HIGH_WATER 0x0F
+/** Device-to-host. Returns the data_path_telemetry_t, to show whether the data path is bound by the UART,
+ *  the USB link or buffering */
+#define VENDOR_REQUEST_GET_TELEMETRY 0x10
+/** No data. Resets the data_path_telemetry_t, including the buffer high-water marks, to start a measurement */
+#define VENDOR_REQUEST_CLEAR_TELEMETRY 0x11
+/** No data. wValue is the traffic_capture_mode_t. Starting ring or session mode empties the trace, and stopping
+ *  leaves the trace to be read. The request is stalled if the mode is invalid.
+ *  Only supported when TRAFFIC_CAPTURE is enabled. */
+#define VENDOR_REQUEST_CAPTURE_CONTROL 0x12
+/** Device-to-host. Returns the next whole records of the traffic capture trace in pcap format, or zero bytes once
+ *  all the records have been returned. A non-zero wValue returns from the start of the pcap file, which in ring
+ *  mode also stops capturing. In session mode the USB host polls this request while capturing.
+ *  wLength should be at least 512. Only supported when TRAFFIC_CAPTURE is enabled. */
+#define VENDOR_REQUEST_GET_CAPTURE 0x13
+/** Host-to-device. The data stage is 1 to CC3100_SEQUENCE_MAX_STEPS cc3100_sequence_step_t, which are run as a
+ *  sequence on the CC3100BOOST nHIB, nRESET and break signals once received. The request is stalled if wLength
+ *  isn't a whole number of steps. A sequence with invalid steps is rejected, as shown by
+ *  VENDOR_REQUEST_GET_SEQUENCE_STATUS. */
+#define VENDOR_REQUEST_RUN_SEQUENCE 0x14
+/** Host-to-device. The data stage is 1 to CC3100_SEQUENCE_MAX_STEPS cc3100_sequence_step_t, which replace the
+ *  sequence run on a CDC SEND_BREAK. A sequence with invalid steps is ignored. With no data stage the default
+ *  sequence, which asserts break and nHIB and deasserts nHIB after 100 ms, is restored. */
+#define VENDOR_REQUEST_SET_BREAK_SEQUENCE 0x15
+/** Device-to-host. Returns the cc3100_sequence_status_t, to show the progress and response time of the most
+ *  recent sequence */
+#define VENDOR_REQUEST_GET_SEQUENCE_STATUS 0x16
+
+/** Host-to-device. The data stage is up to 64 bytes of the CC3100 programmer image, a multiple of 4 bytes, which
+ *  is written to the TM4C flash at the byte offset of (wIndex << 16) | wValue. The image must be written in
+ *  ascending order, as each flash erase block is erased by the first write into it. The request is stalled if the
+ *  write is outside the image region or a programming run is active. */
+#define VENDOR_REQUEST_PROGRAMMER_WRITE_IMAGE 0x17
+/** No data. Starts a standalone programming run of the CC3100 from the image, during which the UART isn't bridged
+ *  to the USB host. The request is stalled if a programming run is already active. */
+#define VENDOR_REQUEST_PROGRAMMER_RUN 0x18
+/** Device-to-host. Returns the cc3100_programmer_status_t, to show the progress and result of the most recent
+ *  programming run */
+#define VENDOR_REQUEST_GET_PROGRAMMER_STATUS 0x19
+
+void *vendor_requests_cdc_init (const uint32_t index, tUSBDCDCDevice *const cdc_device,
+                                tCompositeEntry *const composite_entry);
+void *vendor_requests_bulk_init (const uint32_t index, tUSBDBulkDevice *const bulk_device);
+
+#endif /* VENDOR_REQUESTS_H_ */